@@ -5,7 +5,9 @@
 
 #include "bestImages.hpp"
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/stl/hash.hpp>
 
+#include <fstream>
 #include <limits>
 #include <numeric>
 #include <iostream>
@@ -14,6 +16,106 @@
 namespace aliceVision{
 namespace calibration{
 
+std::size_t CellIndexesCache::computeKey(const std::vector<std::vector<cv::Point2f> >& imagePoints,
+                                         const cv::Size& imageSize,
+                                         const std::size_t calibGridSize)
+{
+  std::size_t key = 0;
+  stl::hash_combine(key, imageSize.width);
+  stl::hash_combine(key, imageSize.height);
+  stl::hash_combine(key, calibGridSize);
+  stl::hash_combine(key, imagePoints.size());
+  for (const auto& pointbuf : imagePoints)
+  {
+    stl::hash_combine(key, pointbuf.size());
+    for (const cv::Point2f& point : pointbuf)
+    {
+      stl::hash_combine(key, point.x);
+      stl::hash_combine(key, point.y);
+    }
+  }
+  return key;
+}
+
+bool CellIndexesCache::load(const std::string& filePath)
+{
+  _entries.clear();
+
+  std::ifstream stream(filePath.c_str());
+  if (!stream.is_open())
+    return false;
+
+  std::string magic;
+  std::size_t nbEntries = 0;
+  stream >> magic >> nbEntries;
+  if (magic != "cellIndexesCache_v1")
+  {
+    ALICEVISION_LOG_WARNING("Invalid cell indexes cache file: " << filePath);
+    return false;
+  }
+
+  for (std::size_t i = 0; i < nbEntries; ++i)
+  {
+    std::size_t key = 0;
+    std::size_t nbImages = 0;
+    stream >> key >> nbImages;
+
+    std::vector<std::vector<std::size_t> > cellIndexesPerImage(nbImages);
+    for (std::vector<std::size_t>& imageCellIndexes : cellIndexesPerImage)
+    {
+      std::size_t nbPoints = 0;
+      stream >> nbPoints;
+      imageCellIndexes.resize(nbPoints);
+      for (std::size_t& cellIndex : imageCellIndexes)
+        stream >> cellIndex;
+    }
+
+    if (!stream)
+    {
+      ALICEVISION_LOG_WARNING("Truncated cell indexes cache file: " << filePath);
+      _entries.clear();
+      return false;
+    }
+    _entries[key] = cellIndexesPerImage;
+  }
+  return true;
+}
+
+bool CellIndexesCache::save(const std::string& filePath) const
+{
+  std::ofstream stream(filePath.c_str());
+  if (!stream.is_open())
+    return false;
+
+  stream << "cellIndexesCache_v1 " << _entries.size() << "\n";
+  for (const auto& entry : _entries)
+  {
+    stream << entry.first << " " << entry.second.size() << "\n";
+    for (const std::vector<std::size_t>& imageCellIndexes : entry.second)
+    {
+      stream << imageCellIndexes.size();
+      for (const std::size_t cellIndex : imageCellIndexes)
+        stream << " " << cellIndex;
+      stream << "\n";
+    }
+  }
+  return bool(stream);
+}
+
+bool CellIndexesCache::get(const std::size_t key, std::vector<std::vector<std::size_t> >& cellIndexesPerImage) const
+{
+  const auto it = _entries.find(key);
+  if (it == _entries.end())
+    return false;
+  cellIndexesPerImage = it->second;
+  return true;
+}
+
+void CellIndexesCache::put(const std::size_t key, const std::vector<std::vector<std::size_t> >& cellIndexesPerImage)
+{
+  _entries[key] = cellIndexesPerImage;
+}
+
 void precomputeCellIndexes(const std::vector<std::vector<cv::Point2f> >& imagePoints,
                            const cv::Size& imageSize,
                            const std::size_t calibGridSize,
@@ -90,12 +192,26 @@ void selectBestImages(const std::vector<std::vector<cv::Point2f> >& imagePoints,
                       std::vector<float>& calibImageScore,
                       std::vector<std::size_t>& calibInputFrames,
                       std::vector<std::vector<cv::Point2f> >& calibImagePoints,
-                      std::vector<std::size_t>& remainingImagesIndexes)
+                      std::vector<std::size_t>& remainingImagesIndexes,
+                      CellIndexesCache* cache)
 {
   std::vector<std::vector<std::size_t> > cellIndexesPerImage;
 
-  // Precompute cell indexes per image
-  precomputeCellIndexes(imagePoints, imageSize, calibGridSize, cellIndexesPerImage);
+  // Precompute cell indexes per image, or reuse them from a previous run over
+  // the same detections
+  if (cache != nullptr)
+  {
+    const std::size_t key = CellIndexesCache::computeKey(imagePoints, imageSize, calibGridSize);
+    if (!cache->get(key, cellIndexesPerImage))
+    {
+      precomputeCellIndexes(imagePoints, imageSize, calibGridSize, cellIndexesPerImage);
+      cache->put(key, cellIndexesPerImage);
+    }
+  }
+  else
+  {
+    precomputeCellIndexes(imagePoints, imageSize, calibGridSize, cellIndexesPerImage);
+  }
 
   // Init with 0, 1, 2, ...
   remainingImagesIndexes.resize(imagePoints.size());
@@ -7,11 +7,72 @@
 
 #include <vector>
 #include <map>
+#include <string>
 #include <opencv2/opencv.hpp>
 
 namespace aliceVision{
 namespace calibration{
 
+/**
+ * @brief Cache of the per-image cell indexes computed by precomputeCellIndexes.
+ *
+ * Entries are keyed by a hash of the detection results and the grid parameters,
+ * so re-running the selection over identical detections (eg. while tuning
+ * maxCalibFrames) reuses the per-image computation instead of rebuilding it.
+ * The cache can be persisted to disk between runs.
+ */
+class CellIndexesCache
+{
+public:
+  /**
+   * @brief Compute the cache key of a set of detections and grid parameters.
+   *
+   * @param[in] imagePoints Vector of detected points for each image.
+   * @param[in] imageSize Image size (width, height).
+   * @param[in] calibGridSize The number of cells per each image dimension.
+   * @return Hash combining all the inputs the cell indexes depend on.
+   */
+  static std::size_t computeKey(const std::vector<std::vector<cv::Point2f> >& imagePoints,
+                                const cv::Size& imageSize,
+                                const std::size_t calibGridSize);
+
+  /**
+   * @brief Load cache entries from a file previously written by save.
+   *
+   * @param[in] filePath Path of the cache file.
+   * @return False if the file is missing or malformed, in which case the cache is left empty.
+   */
+  bool load(const std::string& filePath);
+
+  /**
+   * @brief Write all cache entries to a file.
+   *
+   * @param[in] filePath Path of the cache file.
+   * @return False if the file cannot be written.
+   */
+  bool save(const std::string& filePath) const;
+
+  /**
+   * @brief Retrieve the cell indexes stored for a key.
+   *
+   * @param[in] key Key returned by computeKey.
+   * @param[out] cellIndexesPerImage The id of the cell for each point of the image sequence.
+   * @return True if the key was found.
+   */
+  bool get(const std::size_t key, std::vector<std::vector<std::size_t> >& cellIndexesPerImage) const;
+
+  /**
+   * @brief Store the cell indexes of a key, replacing any previous entry.
+   *
+   * @param[in] key Key returned by computeKey.
+   * @param[in] cellIndexesPerImage The id of the cell for each point of the image sequence.
+   */
+  void put(const std::size_t key, const std::vector<std::vector<std::size_t> >& cellIndexesPerImage);
+
+private:
+  std::map<std::size_t, std::vector<std::vector<std::size_t> > > _entries;
+};
+
 /**
  * @brief This function computes cell indexes per image.
  *
@@ -62,6 +123,7 @@ void computeImageScores(const std::vector<std::size_t>& inputImagesIndexes,
  * @param[out] calibInputFrames Id of selected images.
  * @param[out] calibImagePoints Set of points for each selected image.
  * @param[out] remainingImagesIndexes Indexes of non-selected images from validFrames.
+ * @param[in,out] cache Optional cache of per-image cell indexes, filled on miss (nullptr to disable).
  */
 void selectBestImages(const std::vector<std::vector<cv::Point2f> >& imagePoints,
                       const cv::Size& imageSize,
@@ -70,7 +132,8 @@ void selectBestImages(const std::vector<std::vector<cv::Point2f> >& imagePoints,
                       std::vector<float>& calibImageScore,
                       std::vector<std::size_t>& calibInputFrames,
                       std::vector<std::vector<cv::Point2f> >& calibImagePoints,
-                      std::vector<std::size_t>& remainingImagesIndexes);
+                      std::vector<std::size_t>& remainingImagesIndexes,
+                      CellIndexesCache* cache = nullptr);
 
 }//namespace calibration
 }//namespace aliceVision
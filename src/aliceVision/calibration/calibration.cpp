@@ -7,6 +7,7 @@
 
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/Timer.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <ctime>
 #include <algorithm>
@@ -21,13 +22,16 @@ double computeReprojectionErrors(const std::vector<std::vector<cv::Point3f> >& o
                                  const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs,
                                  std::vector<float>& perViewErrors)
 {
-  std::vector<cv::Point2f> imagePoints2;
   int totalPoints = 0;
   double totalErr = 0;
   perViewErrors.resize(objectPoints.size());
 
-  for (std::size_t i = 0; i < (int) objectPoints.size(); i++)
+  // each view projection is independent, every iteration writes its own
+  // perViewErrors slot
+  #pragma omp parallel for reduction(+:totalErr,totalPoints)
+  for (int i = 0; i < (int) objectPoints.size(); i++)
   {
+    std::vector<cv::Point2f> imagePoints2;
     cv::projectPoints(cv::Mat(objectPoints[i]), rvecs[i], tvecs[i],
                       cameraMatrix, distCoeffs, imagePoints2);
     const double err = cv::norm(cv::Mat(imagePoints[i]), cv::Mat(imagePoints2), CV_L2);
@@ -171,6 +171,40 @@ bool findPattern(const Pattern& pattern, const cv::Mat& viewGray, const cv::Size
   return found;
 }
 
+bool precheckPattern(const Pattern& pattern, const cv::Mat& viewGray, const cv::Size& boardSize, std::size_t downscale)
+{
+  if(downscale <= 1)
+    return true;
+
+  switch(pattern)
+  {
+    case CHESSBOARD:
+    case CIRCLES_GRID:
+    case ASYMMETRIC_CIRCLES_GRID:
+      break;
+    default:
+      return true; // no cheap check for marker based patterns
+  }
+
+  cv::Mat viewGraySmall;
+  cv::resize(viewGray, viewGraySmall,
+             cv::Size(viewGray.cols / int(downscale), viewGray.rows / int(downscale)),
+             0, 0, cv::INTER_AREA);
+
+  std::vector<cv::Point2f> pointbuf;
+  switch(pattern)
+  {
+    case CHESSBOARD:
+      return cv::findChessboardCorners(viewGraySmall, boardSize, pointbuf, CV_CALIB_CB_FAST_CHECK);
+    case CIRCLES_GRID:
+      return cv::findCirclesGrid(viewGraySmall, boardSize, pointbuf);
+    case ASYMMETRIC_CIRCLES_GRID:
+      return cv::findCirclesGrid(viewGraySmall, boardSize, pointbuf, cv::CALIB_CB_ASYMMETRIC_GRID);
+    default:
+      return true;
+  }
+}
+
 void calcChessboardCorners(std::vector<cv::Point3f>& corners, const cv::Size& boardSize,
                            const float squareSize, Pattern pattern = Pattern::CHESSBOARD)
 {
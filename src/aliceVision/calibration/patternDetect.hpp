@@ -55,6 +55,21 @@ std::ostream& operator<<(std::ostream &stream, const Pattern pattern);
  */
 bool findPattern(const Pattern& pattern, const cv::Mat& viewGray, const cv::Size& boardSize, std::vector<int>& detectedId, std::vector<cv::Point2f>& pointbuf);
 
+/**
+ * @brief Cheap detection pre-pass on a downscaled image.
+ *
+ * Used to early-reject blurry or patternless frames before running the full
+ * resolution detection. Marker based patterns (ie. CCTag) have no cheap
+ * equivalent and always pass.
+ *
+ * @param[in] pattern The type of pattern used for the calibration.
+ * @param[in] viewGray The image in gray level.
+ * @param[in] boardSize The size of the calibration pattern.
+ * @param[in] downscale The downscale factor applied before the check (0 or 1 disables the check).
+ * @return False if the pattern is definitely not detectable, true if the full detection should run.
+ */
+bool precheckPattern(const Pattern& pattern, const cv::Mat& viewGray, const cv::Size& boardSize, std::size_t downscale);
+
 /**
  * @brief This function computes the points' coordinates of the checkerboard.
  *
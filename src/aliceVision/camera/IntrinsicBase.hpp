@@ -81,15 +81,29 @@ struct IntrinsicBase
   }
   
   Mat2X residuals(const geometry::Pose3 & pose, const Mat3X & X, const Mat2X & x) const
+  {
+    return this->residualsMany(pose, X, x);
+  }
+
+  /// Projection of a block of 3D points into the camera plane, in one virtual call
+  /// Default implementation loops over the scalar project(); derived classes can
+  /// override it to vectorize the pose and distortion math over the whole block
+  virtual Mat2X projectMany(
+    const geometry::Pose3 & pose,
+    const Mat3X & pts3D,
+    bool applyDistortion = true) const
+  {
+    Mat2X projections(2, pts3D.cols());
+    for(Mat3X::Index i = 0; i < pts3D.cols(); ++i)
+      projections.col(i) = this->project(pose, pts3D.col(i), applyDistortion);
+    return projections;
+  }
+
+  /// Compute the residuals between a block of 3D points X and their image observations x
+  virtual Mat2X residualsMany(const geometry::Pose3 & pose, const Mat3X & X, const Mat2X & x) const
   {
     assert(X.cols() == x.cols());
-    const std::size_t numPts = x.cols();
-    Mat2X residuals = Mat2X::Zero(2, numPts);
-    for(std::size_t i = 0; i < numPts; ++i)
-    {
-      residuals.col(i) = residual(pose, X.col(i), x.col(i));
-    }
-    return residuals;
+    return x - this->projectMany(pose, X);
   }
 
   // --
@@ -126,6 +140,17 @@ struct IntrinsicBase
   /// Return the un-distorted pixel (with removed distortion)
   virtual Vec2 get_ud_pixel(const Vec2& p) const = 0;
 
+  /// Un-distort a whole block of image points
+  /// Default implementation loops over the scalar get_ud_pixel; models with a
+  /// vectorized undistortion override it
+  virtual Mat2X get_ud_pixel_many(const Mat2X& pts) const
+  {
+    Mat2X out(2, pts.cols());
+    for(Mat2X::Index i = 0; i < pts.cols(); ++i)
+      out.col(i) = this->get_ud_pixel(pts.col(i));
+    return out;
+  }
+
   /// Return the distorted pixel (with added distortion)
   virtual Vec2 get_d_pixel(const Vec2& p) const = 0;
 
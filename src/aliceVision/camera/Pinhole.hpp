@@ -90,6 +90,59 @@ class Pinhole : public IntrinsicBase
 
   virtual Vec2 remove_disto(const Vec2& p) const  { return p; }
 
+  /// Add the distortion field to a block of camera plane points
+  /// Default implementation loops over the scalar add_disto; distortion models
+  /// override it to vectorize the distortion math
+  virtual Mat2X add_disto_many(const Mat2X& pts2D) const
+  {
+    Mat2X out(2, pts2D.cols());
+    for(Mat2X::Index i = 0; i < pts2D.cols(); ++i)
+      out.col(i) = this->add_disto(pts2D.col(i));
+    return out;
+  }
+
+  /// Remove the distortion field from a block of camera plane points
+  /// Default implementation loops over the scalar remove_disto; distortion
+  /// models override it to share the iterative inverse over the whole block
+  virtual Mat2X remove_disto_many(const Mat2X& pts2D) const
+  {
+    Mat2X out(2, pts2D.cols());
+    for(Mat2X::Index i = 0; i < pts2D.cols(); ++i)
+      out.col(i) = this->remove_disto(pts2D.col(i));
+    return out;
+  }
+
+  /// Un-distort a whole block of image points: the image/camera plane
+  /// transforms are applied to the full block and the distortion inversion
+  /// goes through a single virtual dispatch
+  virtual Mat2X get_ud_pixel_many(const Mat2X& pts) const
+  {
+    Mat2X cam = (pts.colwise() - principal_point()) / focal();
+    cam = this->remove_disto_many(cam);
+    return (focal() * cam).colwise() + principal_point();
+  }
+
+  /// Batched projection: the pose, distortion and intrinsics are applied to
+  /// the whole block, with a single virtual dispatch for the distortion
+  virtual Mat2X projectMany(
+    const geometry::Pose3 & pose,
+    const Mat3X & pts3D,
+    bool applyDistortion = true) const
+  {
+    const Mat3X X = pose(pts3D); // apply pose
+
+    Mat2X pts2D(2, X.cols());
+    pts2D.row(0) = X.row(0).array() / X.row(2).array();
+    pts2D.row(1) = X.row(1).array() / X.row(2).array();
+
+    if (applyDistortion && this->have_disto()) // apply disto
+      pts2D = this->add_disto_many(pts2D);
+
+    // apply intrinsics
+    pts2D = (focal() * pts2D).colwise() + principal_point();
+    return pts2D;
+  }
+
   virtual double imagePlane_toCameraPlaneError(double value) const
   {
     return value / focal();
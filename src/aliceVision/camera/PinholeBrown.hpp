@@ -16,7 +16,9 @@ namespace camera {
 /// Implement a Pinhole camera with a 3 radial distortion coefficients and 2 tangential distortion coefficients.
 /// x_d = x_u (1 + K_1 r^2 + K_2 r^4 + K_3 r^6) + (T_2 (r^2 + 2 x_u^2) + 2 T_1 x_u y_u)
 /// y_d = y_u (1 + K_1 r^2 + K_2 r^4 + K_3 r^6) + (T_1 (r^2 + 2 y_u^2) + 2 T_2 x_u y_u)
-class PinholeBrownT2 : public Pinhole
+// the class is final so the compiler can devirtualize the camera calls when
+// the concrete model is known (see cameraDispatch.hpp)
+class PinholeBrownT2 final : public Pinhole
 {
     public:
 
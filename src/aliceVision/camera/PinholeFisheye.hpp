@@ -19,7 +19,9 @@ namespace camera {
  * This is an adaptation of the Fisheye distortion model implemented in OpenCV:
  * https://github.com/Itseez/opencv/blob/master/modules/calib3d/src/fisheye.cpp
  */
-class PinholeFisheye : public Pinhole
+// the class is final so the compiler can devirtualize the camera calls when
+// the concrete model is known (see cameraDispatch.hpp)
+class PinholeFisheye final : public Pinhole
 {
   public:
 
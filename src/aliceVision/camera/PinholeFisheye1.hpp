@@ -21,7 +21,9 @@ namespace camera {
  * structured environments. Mach. Vision Appl. 13, 1 (August 2001), 14-24. 
  * DOI: 10.1007/PL00013269 https://hal.inria.fr/inria-00267247/document
  */
-class PinholeFisheye1 : public Pinhole
+// the class is final so the compiler can devirtualize the camera calls when
+// the concrete model is known (see cameraDispatch.hpp)
+class PinholeFisheye1 final : public Pinhole
 {
 public:
 
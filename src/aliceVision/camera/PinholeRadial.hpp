@@ -42,11 +42,59 @@ namespace radial_distortion{
     return .5*(lowerbound+upbound);
   }
 
+  /**
+   * @brief Invert the radial distortion over a whole block of radii with a
+   * Newton iteration shared between all the points: every step updates the
+   * full block with vectorized Eigen array expressions and a single
+   * convergence test on the worst step decides when to stop, instead of one
+   * scalar bisection per point.
+   *
+   * @param[in] rd The distorted radius of every point.
+   * @param[in] distoCoeff Functor returning the radial coefficient
+   * 1 + k1*r2 + ... for a block of squared radii.
+   * @param[in] distoDerivative Functor returning d(r*coeff(r^2))/dr for a
+   * block of squared radii.
+   * @param[in] epsilon Step magnitude under which the iteration stops.
+   * @return the undistorted radius of every point.
+   */
+  template <class CoeffFunctor, class DerivativeFunctor>
+  Eigen::Array<double, 1, Eigen::Dynamic> newton_Radius_Solve_many(
+    const Eigen::Array<double, 1, Eigen::Dynamic> & rd,
+    CoeffFunctor distoCoeff,
+    DerivativeFunctor distoDerivative,
+    double epsilon = 1e-10)
+  {
+    typedef Eigen::Array<double, 1, Eigen::Dynamic> RowArrayXd;
+
+    // the distorted radius is a good initial guess for the usual small
+    // distortions; severe ones just take a few more shared iterations
+    RowArrayXd r = rd;
+    const int maxIterations = 50;
+    for(int iteration = 0; iteration < maxIterations; ++iteration)
+    {
+      const RowArrayXd r2 = r.square();
+      const RowArrayXd residual = r * distoCoeff(r2) - rd;
+      // keep the step well defined where the distortion model folds over
+      // (derivative ~0 far outside the calibrated domain): bound the
+      // derivative magnitude away from zero, preserving its sign
+      const RowArrayXd derivative = distoDerivative(r2);
+      const RowArrayXd safeDerivative =
+        (derivative >= 0.0).select(derivative.max(0.1), derivative.min(-0.1));
+      const RowArrayXd step = residual / safeDerivative;
+      r -= step;
+      if((step.abs() < epsilon).all())
+        break;
+    }
+    return r;
+  }
+
 } // namespace radial_distortion
 
 /// Implement a Pinhole camera with a 1 radial distortion coefficient.
 /// x_d = x_u (1 + K_1 r^2)
-class PinholeRadialK1 : public Pinhole
+// the class is final so the compiler can devirtualize the camera calls when
+// the concrete model is known (see cameraDispatch.hpp)
+class PinholeRadialK1 final : public Pinhole
 {
   public:
 
@@ -77,6 +125,21 @@ class PinholeRadialK1 : public Pinhole
     return (p * r_coeff);
   }
 
+  /// Add distortion to a whole block of camera plane points (vectorized)
+  virtual Mat2X add_disto_many(const Mat2X& pts2D) const
+  {
+    const double k1 = _distortionParams.at(0);
+
+    typedef Eigen::Array<double, 1, Eigen::Dynamic> RowArrayXd;
+    const RowArrayXd r2 = pts2D.row(0).array().square() + pts2D.row(1).array().square();
+    const RowArrayXd r_coeff = 1. + k1*r2;
+
+    Mat2X out(2, pts2D.cols());
+    out.row(0) = pts2D.row(0).array() * r_coeff;
+    out.row(1) = pts2D.row(1).array() * r_coeff;
+    return out;
+  }
+
   /// Remove distortion (return p' such that disto(p') = p)
   virtual Vec2 remove_disto(const Vec2& p) const {
     // Compute the radius from which the point p comes from thanks to a bisection
@@ -89,6 +152,30 @@ class PinholeRadialK1 : public Pinhole
     return radius * p;
   }
 
+  /// Remove distortion from a whole block of camera plane points with a
+  /// Newton iteration shared between all the points (vectorized)
+  virtual Mat2X remove_disto_many(const Mat2X& pts2D) const
+  {
+    const double k1 = _distortionParams.at(0);
+
+    typedef Eigen::Array<double, 1, Eigen::Dynamic> RowArrayXd;
+    const RowArrayXd rd =
+      (pts2D.row(0).array().square() + pts2D.row(1).array().square()).sqrt();
+
+    const RowArrayXd ru = radial_distortion::newton_Radius_Solve_many(rd,
+      [k1](const RowArrayXd& r2) -> RowArrayXd { return 1. + k1*r2; },
+      [k1](const RowArrayXd& r2) -> RowArrayXd { return 1. + 3.*k1*r2; });
+
+    // radius scale per point; 1 where the point is on the optical axis
+    const RowArrayXd scale =
+      (rd > 0.0).select(ru / rd, RowArrayXd::Ones(rd.size()));
+
+    Mat2X out(2, pts2D.cols());
+    out.row(0) = pts2D.row(0).array() * scale;
+    out.row(1) = pts2D.row(1).array() * scale;
+    return out;
+  }
+
   /// Return the un-distorted pixel (with removed distortion)
   virtual Vec2 get_ud_pixel(const Vec2& p) const
   {
@@ -129,7 +216,8 @@ class PinholeRadialK1 : public Pinhole
 
 /// Implement a Pinhole camera with a 3 radial distortion coefficients.
 /// x_d = x_u (1 + K_1 r^2 + K_2 r^4 + K_3 r^6)
-class PinholeRadialK3 : public Pinhole
+// final, like PinholeRadialK1, to allow devirtualization
+class PinholeRadialK3 final : public Pinhole
 {
   public:
 
@@ -162,6 +250,23 @@ class PinholeRadialK3 : public Pinhole
     return (p * r_coeff);
   }
 
+  /// Add distortion to a whole block of camera plane points (vectorized)
+  virtual Mat2X add_disto_many(const Mat2X& pts2D) const
+  {
+    const double k1 = _distortionParams[0], k2 = _distortionParams[1], k3 = _distortionParams[2];
+
+    typedef Eigen::Array<double, 1, Eigen::Dynamic> RowArrayXd;
+    const RowArrayXd r2 = pts2D.row(0).array().square() + pts2D.row(1).array().square();
+    const RowArrayXd r4 = r2 * r2;
+    const RowArrayXd r6 = r4 * r2;
+    const RowArrayXd r_coeff = 1. + k1*r2 + k2*r4 + k3*r6;
+
+    Mat2X out(2, pts2D.cols());
+    out.row(0) = pts2D.row(0).array() * r_coeff;
+    out.row(1) = pts2D.row(1).array() * r_coeff;
+    return out;
+  }
+
   /// Remove distortion (return p' such that disto(p') = p)
   virtual Vec2 remove_disto(const Vec2& p) const {
     // Compute the radius from which the point p comes from thanks to a bisection
@@ -174,6 +279,32 @@ class PinholeRadialK3 : public Pinhole
     return radius * p;
   }
 
+  /// Remove distortion from a whole block of camera plane points with a
+  /// Newton iteration shared between all the points (vectorized)
+  virtual Mat2X remove_disto_many(const Mat2X& pts2D) const
+  {
+    const double k1 = _distortionParams[0], k2 = _distortionParams[1], k3 = _distortionParams[2];
+
+    typedef Eigen::Array<double, 1, Eigen::Dynamic> RowArrayXd;
+    const RowArrayXd rd =
+      (pts2D.row(0).array().square() + pts2D.row(1).array().square()).sqrt();
+
+    const RowArrayXd ru = radial_distortion::newton_Radius_Solve_many(rd,
+      [k1, k2, k3](const RowArrayXd& r2) -> RowArrayXd
+      { return 1. + r2*(k1 + r2*(k2 + r2*k3)); },
+      [k1, k2, k3](const RowArrayXd& r2) -> RowArrayXd
+      { return 1. + r2*(3.*k1 + r2*(5.*k2 + r2*(7.*k3))); });
+
+    // radius scale per point; 1 where the point is on the optical axis
+    const RowArrayXd scale =
+      (rd > 0.0).select(ru / rd, RowArrayXd::Ones(rd.size()));
+
+    Mat2X out(2, pts2D.cols());
+    out.row(0) = pts2D.row(0).array() * scale;
+    out.row(1) = pts2D.row(1).array() * scale;
+    return out;
+  }
+
   /// Return the un-distorted pixel (with removed distortion)
   virtual Vec2 get_ud_pixel(const Vec2& p) const
   {
@@ -12,6 +12,7 @@
 #include "aliceVision/camera/PinholeBrown.hpp"
 #include "aliceVision/camera/PinholeFisheye.hpp"
 #include "aliceVision/camera/PinholeFisheye1.hpp"
+#include "aliceVision/camera/cameraDispatch.hpp"
 #include "aliceVision/camera/cameraUndistortImage.hpp"
 
 namespace aliceVision {
@@ -0,0 +1,64 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include "aliceVision/camera/cameraCommon.hpp"
+#include "aliceVision/camera/IntrinsicBase.hpp"
+#include "aliceVision/camera/Pinhole.hpp"
+#include "aliceVision/camera/PinholeRadial.hpp"
+#include "aliceVision/camera/PinholeBrown.hpp"
+#include "aliceVision/camera/PinholeFisheye.hpp"
+#include "aliceVision/camera/PinholeFisheye1.hpp"
+
+namespace aliceVision {
+namespace camera {
+
+/// Dispatch once on the runtime camera model and hand the intrinsic to the
+/// visitor as its concrete class, so per-observation loops get stamped out
+/// per model with the camera calls resolved at compile time (and thus
+/// inlinable) instead of going through an IntrinsicBase virtual per call.
+///
+/// The visitor is any callable with a templated operator() taking the
+/// concrete camera by const reference:
+///
+///   struct ResidualsVisitor
+///   {
+///     template <class CameraT>
+///     void operator()(const CameraT& camera) const { /* inlined hot loop */ }
+///   };
+///
+/// Return false if the camera model is unknown, in which case the caller
+/// should fall back to the virtual interface.
+template <class Visitor>
+bool dispatchIntrinsic(const IntrinsicBase& intrinsic, Visitor& visitor)
+{
+  switch(intrinsic.getType())
+  {
+    case PINHOLE_CAMERA:
+      visitor(static_cast<const Pinhole&>(intrinsic));
+      return true;
+    case PINHOLE_CAMERA_RADIAL1:
+      visitor(static_cast<const PinholeRadialK1&>(intrinsic));
+      return true;
+    case PINHOLE_CAMERA_RADIAL3:
+      visitor(static_cast<const PinholeRadialK3&>(intrinsic));
+      return true;
+    case PINHOLE_CAMERA_BROWN:
+      visitor(static_cast<const PinholeBrownT2&>(intrinsic));
+      return true;
+    case PINHOLE_CAMERA_FISHEYE:
+      visitor(static_cast<const PinholeFisheye&>(intrinsic));
+      return true;
+    case PINHOLE_CAMERA_FISHEYE1:
+      visitor(static_cast<const PinholeFisheye1&>(intrinsic));
+      return true;
+    default:
+      return false;
+  }
+}
+
+} // namespace camera
+} // namespace aliceVision
@@ -0,0 +1,92 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "aliceVision/camera/camera.hpp"
+
+#define BOOST_TEST_MODULE cameraDispatch
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+#include <aliceVision/unitTest.hpp>
+
+#include <memory>
+#include <vector>
+
+using namespace aliceVision;
+using namespace aliceVision::camera;
+
+namespace {
+
+/// Record the model type seen by the visitor with a non-virtual (qualified)
+/// call, so the test proves the dispatch reached the concrete class.
+struct TypeRecorderVisitor
+{
+  EINTRINSIC type = PINHOLE_CAMERA_START;
+
+  template <class CameraT>
+  void operator()(const CameraT& camera)
+  {
+    type = camera.CameraT::getType();
+  }
+};
+
+/// Compute the batched residuals through the concrete model, as the sfm
+/// filters do.
+struct ResidualsVisitor
+{
+  const geometry::Pose3& pose;
+  const Mat3X& X;
+  const Mat2X& x;
+  Mat2X& residuals;
+
+  template <class CameraT>
+  void operator()(const CameraT& camera) const
+  {
+    residuals = camera.residualsMany(pose, X, x);
+  }
+};
+
+} // namespace
+
+//-----------------
+// Test summary:
+//-----------------
+// - Dispatch every known camera model and assert the visitor is called with
+//   the matching concrete class
+// - Assert the residuals computed through the dispatched path match the
+//   virtual interface
+//-----------------
+BOOST_AUTO_TEST_CASE(cameraDispatch_concrete_type_and_residuals)
+{
+  std::vector<std::shared_ptr<IntrinsicBase>> cameras;
+  cameras.push_back(std::make_shared<Pinhole>(1000, 1000, 1000, 500, 500));
+  cameras.push_back(std::make_shared<PinholeRadialK1>(1000, 1000, 1000, 500, 500, 0.1));
+  cameras.push_back(std::make_shared<PinholeRadialK3>(1000, 1000, 1000, 500, 500, -0.2, 0.01, 0.001));
+  cameras.push_back(std::make_shared<PinholeBrownT2>(1000, 1000, 1000, 500, 500, -0.054, 0.014, 0.006, 0.001, -0.001));
+  cameras.push_back(std::make_shared<PinholeFisheye>(1000, 1000, 1000, 500, 500, -0.054, 0.014, 0.006, 0.011));
+  cameras.push_back(std::make_shared<PinholeFisheye1>(1000, 1000, 1000, 500, 500, 0.1));
+
+  const geometry::Pose3 pose(Mat3::Identity(), Vec3(0.5, -0.3, -10.0));
+
+  const int nbPoints = 50;
+  Mat3X X(3, nbPoints);
+  Mat2X x(2, nbPoints);
+  for (int i = 0; i < nbPoints; ++i)
+  {
+    X.col(i) = Vec3::Random();
+    x.col(i) = (Vec2::Random() * 800./2.) + Vec2(500, 500);
+  }
+
+  for (const auto& camera : cameras)
+  {
+    TypeRecorderVisitor typeRecorder;
+    BOOST_CHECK(dispatchIntrinsic(*camera, typeRecorder));
+    BOOST_CHECK_EQUAL(camera->getType(), typeRecorder.type);
+
+    Mat2X residuals;
+    ResidualsVisitor residualsVisitor = {pose, X, x, residuals};
+    BOOST_CHECK(dispatchIntrinsic(*camera, residualsVisitor));
+    EXPECT_MATRIX_NEAR(camera->residualsMany(pose, X, x), residuals, 1e-12);
+  }
+}
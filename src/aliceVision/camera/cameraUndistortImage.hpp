@@ -13,11 +13,244 @@
 #include <aliceVision/camera/IntrinsicBase.hpp>
 #include <aliceVision/camera/Pinhole.hpp>
 
+#include <fstream>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <string>
 
 namespace aliceVision {
 namespace camera {
 
+/**
+ * @brief Precomputed undistortion look-up table for one intrinsic
+ * Stores, for every output pixel, the distorted source coordinates, so all the
+ * images sharing an intrinsic evaluate the distortion model only once instead
+ * of per pixel per image.
+ */
+class UndistortionMap
+{
+public:
+
+  UndistortionMap() = default;
+
+  /// Generate the map key from the intrinsic parameters and the image size
+  static std::size_t computeHash(const IntrinsicBase* intrinsicPtr, int width, int height, bool correctPrincipalPoint)
+  {
+    std::size_t seed = intrinsicPtr->hashValue();
+    stl::hash_combine(seed, width);
+    stl::hash_combine(seed, height);
+    stl::hash_combine(seed, correctPrincipalPoint);
+    return seed;
+  }
+
+  std::size_t hash() const { return _hash; }
+  int width() const { return _width; }
+  int height() const { return _height; }
+
+  /// Build the map for a given intrinsic and image size
+  void build(const IntrinsicBase* intrinsicPtr, int width, int height, bool correctPrincipalPoint = false)
+  {
+    _width = width;
+    _height = height;
+    _hash = computeHash(intrinsicPtr, width, height, correctPrincipalPoint);
+    _mapX.resize(width, height);
+    _mapY.resize(width, height);
+
+    const Vec2 center(width * 0.5, height * 0.5);
+    Vec2 ppCorrection(0.0, 0.0);
+
+    if(correctPrincipalPoint)
+    {
+      if(camera::isPinhole(intrinsicPtr->getType()))
+      {
+        const camera::Pinhole* pinholePtr = dynamic_cast<const camera::Pinhole*>(intrinsicPtr);
+        ppCorrection = pinholePtr->principal_point() - center;
+      }
+    }
+
+    #pragma omp parallel for
+    for (int j = 0; j < height; ++j)
+      for (int i = 0; i < width; ++i)
+      {
+        const Vec2 undisto_pix(i,j);
+
+        // compute coordinates with distortion
+        const Vec2 disto_pix = intrinsicPtr->get_d_pixel(undisto_pix) + ppCorrection;
+
+        _mapX(j, i) = static_cast<float>(disto_pix(0));
+        _mapY(j, i) = static_cast<float>(disto_pix(1));
+      }
+  }
+
+  /**
+   * @brief Undistort an image through the map with bilinear resampling
+   * Interior pixels run a branch-free four-tap loop in the same accumulation
+   * order as the generic sampler; pixels whose neighborhood touches the image
+   * border fall back on the generic sampler.
+   */
+  template <typename T>
+  void remap(const image::Image<T>& imageIn, image::Image<T>& image_ud, T fillcolor) const
+  {
+    assert(imageIn.Width() == _width);
+    assert(imageIn.Height() == _height);
+
+    image_ud.resize(_width, _height, true, fillcolor);
+    const image::Sampler2d<image::SamplerLinear> sampler;
+
+    const int in_width = _width;
+    const int in_height = _height;
+
+    #pragma omp parallel for
+    for (int j = 0; j < in_height; ++j)
+      for (int i = 0; i < in_width; ++i)
+      {
+        const float x = _mapX(j, i);
+        const float y = _mapY(j, i);
+
+        // pick pixel if it is in the image domain
+        if (!imageIn.Contains(y, x))
+          continue;
+
+        const int grid_x = static_cast<int>(floor(x));
+        const int grid_y = static_cast<int>(floor(y));
+
+        if (grid_x < 0 || grid_x + 1 >= in_width || grid_y < 0 || grid_y + 1 >= in_height)
+        {
+          // border: the generic sampler handles the out of range neighbors
+          image_ud(j, i) = sampler(imageIn, y, x);
+          continue;
+        }
+
+        const double dx = static_cast<double>(x) - floor(x);
+        const double dy = static_cast<double>(y) - floor(y);
+
+        const double w00 = (1.0 - dx) * (1.0 - dy);
+        const double w01 = dx * (1.0 - dy);
+        const double w10 = (1.0 - dx) * dy;
+        const double w11 = dx * dy;
+
+        const T* row0 = imageIn.data() + grid_y * in_width;
+        const T* row1 = row0 + in_width;
+
+        typename image::RealPixel<T>::real_type res(0);
+        res += image::RealPixel<T>::convert_to_real(row0[grid_x]) * w00;
+        res += image::RealPixel<T>::convert_to_real(row0[grid_x + 1]) * w01;
+        res += image::RealPixel<T>::convert_to_real(row1[grid_x]) * w10;
+        res += image::RealPixel<T>::convert_to_real(row1[grid_x + 1]) * w11;
+
+        const double total_weight = w00 + w01 + w10 + w11;
+        if (total_weight != 1.0)
+          res /= total_weight;
+
+        image_ud(j, i) = image::RealPixel<T>::convert_from_real(res);
+      }
+  }
+
+  /// Load the map from a file, returns false if the file is missing or truncated
+  bool load(const std::string& filepath)
+  {
+    std::ifstream file(filepath, std::ios::binary);
+    if(!file)
+      return false;
+
+    std::size_t hash = 0;
+    int width = 0;
+    int height = 0;
+    file.read(reinterpret_cast<char*>(&hash), sizeof(hash));
+    file.read(reinterpret_cast<char*>(&width), sizeof(width));
+    file.read(reinterpret_cast<char*>(&height), sizeof(height));
+
+    if(!file || width <= 0 || height <= 0)
+      return false;
+
+    _mapX.resize(width, height);
+    _mapY.resize(width, height);
+    file.read(reinterpret_cast<char*>(_mapX.data()), sizeof(float) * width * height);
+    file.read(reinterpret_cast<char*>(_mapY.data()), sizeof(float) * width * height);
+
+    if(!file)
+      return false;
+
+    _hash = hash;
+    _width = width;
+    _height = height;
+    return true;
+  }
+
+  /// Save the map to a file, returns false on write error
+  bool save(const std::string& filepath) const
+  {
+    std::ofstream file(filepath, std::ios::binary);
+    if(!file)
+      return false;
+
+    file.write(reinterpret_cast<const char*>(&_hash), sizeof(_hash));
+    file.write(reinterpret_cast<const char*>(&_width), sizeof(_width));
+    file.write(reinterpret_cast<const char*>(&_height), sizeof(_height));
+    file.write(reinterpret_cast<const char*>(_mapX.data()), sizeof(float) * _width * _height);
+    file.write(reinterpret_cast<const char*>(_mapY.data()), sizeof(float) * _width * _height);
+    return bool(file);
+  }
+
+private:
+
+  image::Image<float> _mapX;
+  image::Image<float> _mapY;
+  std::size_t _hash = 0;
+  int _width = 0;
+  int _height = 0;
+};
+
+/**
+ * @brief Thread-safe cache of undistortion maps, keyed by intrinsic hash
+ * With a cache directory set, built maps are persisted on disk as
+ * undistortionMap_<hash>.bin and reloaded across runs instead of rebuilt.
+ */
+class UndistortionMapCache
+{
+public:
+
+  explicit UndistortionMapCache(const std::string& cacheDirectory = "")
+    : _cacheDirectory(cacheDirectory)
+  {}
+
+  /// Get the map for the given intrinsic and image size, building it on first use
+  std::shared_ptr<const UndistortionMap> get(const IntrinsicBase* intrinsicPtr, int width, int height, bool correctPrincipalPoint = false)
+  {
+    const std::size_t hash = UndistortionMap::computeHash(intrinsicPtr, width, height, correctPrincipalPoint);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    const auto it = _maps.find(hash);
+    if(it != _maps.end())
+      return it->second;
+
+    auto map = std::make_shared<UndistortionMap>();
+
+    if(_cacheDirectory.empty() || !map->load(mapFilepath(hash)) || map->hash() != hash)
+    {
+      map->build(intrinsicPtr, width, height, correctPrincipalPoint);
+      if(!_cacheDirectory.empty())
+        map->save(mapFilepath(hash));
+    }
+
+    _maps.emplace(hash, map);
+    return map;
+  }
+
+private:
+
+  std::string mapFilepath(std::size_t hash) const
+  {
+    return _cacheDirectory + "/undistortionMap_" + std::to_string(hash) + ".bin";
+  }
+
+  std::mutex _mutex;
+  std::map<std::size_t, std::shared_ptr<const UndistortionMap>> _maps;
+  std::string _cacheDirectory;
+};
+
 /// Undistort an image according a given camera and its distortion model
 template <typename T>
 void UndistortImage(
@@ -64,6 +297,17 @@ void UndistortImage(
   }
 }
 
+/// Undistort an image through a precomputed undistortion map
+template <typename T>
+void UndistortImage(
+  const image::Image<T>& imageIn,
+  const UndistortionMap& undistortionMap,
+  image::Image<T>& image_ud,
+  T fillcolor)
+{
+  undistortionMap.remap(imageIn, image_ud, fillcolor);
+}
+
 } // namespace camera
 } // namespace aliceVision
 
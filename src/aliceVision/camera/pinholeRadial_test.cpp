@@ -76,3 +76,53 @@ BOOST_AUTO_TEST_CASE(cameraPinholeRadial_disto_undisto_K3) {
     BOOST_CHECK(! (cam.add_disto(ptCamera) == cam.remove_disto(cam.add_disto(ptCamera))) ) ;
   }
 }
+
+//-----------------
+// Test summary:
+//-----------------
+// - Create PinholeRadialK1 & K3 cameras
+// - Generate a block of random points inside the image domain
+// - Check that the batched remove_disto_many & get_ud_pixel_many agree with
+//   their scalar counterparts on every point of the block
+//-----------------
+BOOST_AUTO_TEST_CASE(cameraPinholeRadial_disto_undisto_many) {
+
+  const PinholeRadialK1 camK1(1000, 1000, 1000, 500, 500,
+    // K1
+    0.1);
+  const PinholeRadialK3 camK3(1000, 1000, 1000, 500, 500,
+    // K1, K2, K3
+    -0.245539, 0.255195, 0.163773);
+
+  const double epsilon = 1e-4;
+  const std::size_t nbPoints = 16;
+
+  Mat2X ptsImage(2, nbPoints);
+  for (std::size_t i = 0; i < nbPoints; ++i)
+  {
+    // generate random point inside the image domain (last random to avoid 0,0)
+    ptsImage.col(i) = (Vec2::Random() * 800./2.) + Vec2(500,500) + Vec2::Random();
+  }
+
+  const Pinhole * cameras[] = {&camK1, &camK3};
+  for (const Pinhole * cam : cameras)
+  {
+    Mat2X ptsCamera(2, nbPoints);
+    for (std::size_t i = 0; i < nbPoints; ++i)
+      ptsCamera.col(i) = cam->ima2cam(ptsImage.col(i));
+
+    const Mat2X distorted = cam->add_disto_many(ptsCamera);
+    const Mat2X undistorted = cam->remove_disto_many(distorted);
+    const Mat2X udPixels = cam->get_ud_pixel_many(ptsImage);
+
+    // The batched inverse must round-trip the batched forward distortion
+    EXPECT_MATRIX_NEAR(ptsCamera, undistorted, epsilon);
+
+    // The batched versions must agree with the scalar ones, point per point
+    for (std::size_t i = 0; i < nbPoints; ++i)
+    {
+      EXPECT_MATRIX_NEAR(Vec2(cam->remove_disto(distorted.col(i))), Vec2(undistorted.col(i)), epsilon);
+      EXPECT_MATRIX_NEAR(cam->get_ud_pixel(ptsImage.col(i)), Vec2(udPixels.col(i)), epsilon);
+    }
+  }
+}
@@ -8,6 +8,7 @@
 #include "aliceVision/image/all.hpp"
 #include "dependencies/histogram/histogram.hpp"
 #include <string>
+#include <type_traits>
 
 namespace aliceVision {
 namespace colorHarmonization {
@@ -40,6 +41,9 @@ public:
    * \param[in] mask Binary image to determine acceptable zones
    * \param[in] channelIndex selected channel : 0 = red; 1 = green; 2 = blue
    * \param[in] image Image with RGB or LAB type
+   * \param[in] step Sampling step: only one pixel out of step is visited in
+   *            both directions (1 visits every pixel). Gain/offset estimation
+   *            does not need the full resolution.
    * \param[out] histo  Histogram of the left image.
    *
    */
@@ -48,11 +52,56 @@ public:
     Histogram< double > & histo,
     const image::Image< unsigned char >& mask,
     size_t channelIndex,
-    const image::Image< ImageType >& image )
+    const image::Image< ImageType >& image,
+    size_t step = 1 )
   {
-    for(int j = 0; j < mask.Height(); ++j)
+    typedef typename std::decay<decltype(image(0,0)(channelIndex))>::type ChannelT;
+    accumulateHisto(histo, mask, channelIndex, image, step,
+      std::integral_constant<bool, std::is_same<ChannelT, unsigned char>::value>());
+  }
+
+  const std::string & getLeftImage()const{ return _sLeftImage; }
+  const std::string & getRightImage()const{ return _sRightImage; }
+
+private:
+  /// 8 bit channels: count the exact pixel values into a flat local array
+  /// (branchless mask test, no per-pixel histogram bookkeeping), then flush
+  /// each distinct value once with its multiplicity.
+  template< typename ImageType >
+  static void accumulateHisto(
+    Histogram< double > & histo,
+    const image::Image< unsigned char >& mask,
+    size_t channelIndex,
+    const image::Image< ImageType >& image,
+    size_t step,
+    std::true_type )
+  {
+    size_t counts[256] = {0};
+    for(int j = 0; j < mask.Height(); j += step)
+    {
+      for(int i = 0; i < mask.Width(); i += step)
+        counts[image(j,i)(channelIndex)] += (mask(j,i) != 0) ? 1 : 0;
+    }
+    for(size_t value = 0; value < 256; ++value)
     {
-      for(int i = 0; i < mask.Width(); ++i)
+      if(counts[value] != 0)
+        histo.Add(static_cast<double>(value), counts[value]);
+    }
+  }
+
+  /// Generic channels: per pixel insertion.
+  template< typename ImageType >
+  static void accumulateHisto(
+    Histogram< double > & histo,
+    const image::Image< unsigned char >& mask,
+    size_t channelIndex,
+    const image::Image< ImageType >& image,
+    size_t step,
+    std::false_type )
+  {
+    for(int j = 0; j < mask.Height(); j += step)
+    {
+      for(int i = 0; i < mask.Width(); i += step)
       {
         if((int)mask(j,i) != 0)
           histo.Add(image(j,i)(channelIndex));
@@ -60,9 +109,6 @@ public:
     }
   }
 
-  const std::string & getLeftImage()const{ return _sLeftImage; }
-  const std::string & getRightImage()const{ return _sRightImage; }
-
 protected:
   // Left and Right image filenames
   std::string _sLeftImage, _sRightImage;
@@ -18,6 +18,7 @@
 #include <exception>
 #include <regex>
 #include <iterator>
+#include <limits>
 #include <string>
 
 namespace aliceVision{
@@ -151,6 +152,75 @@ private:
 
 const std::vector<std::string> ImageFeed::FeederImpl::supportedExtensions = { ".jpg", ".jpeg", ".png", ".ppm" };
 
+namespace {
+
+// Name of the index file persisted next to the images. It stores the directory
+// modification time followed by the sorted list of supported image filenames,
+// so that later runs over an unchanged folder can skip the directory walk
+// (which can take minutes on large network folders).
+const char* imageIndexFilename = ".aliceVision_imageIndex.txt";
+
+/**
+ * @brief Try to load the list of image filenames from the index file of a folder.
+ * The index is only used if the directory has not been modified since it was
+ * written, otherwise the caller must walk the directory again.
+ *
+ * @param[in] folder The folder containing the images.
+ * @param[out] out_filenames The sorted image filenames stored in the index.
+ * @return True if a valid, up to date index has been loaded.
+ */
+bool loadDirectoryIndex(const std::string& folder, std::vector<std::string>& out_filenames)
+{
+  namespace bf = boost::filesystem;
+  const bf::path indexPath = bf::path(folder) / imageIndexFilename;
+  if(!bf::is_regular_file(indexPath))
+    return false;
+
+  std::ifstream fs(indexPath.string());
+  if(!fs.is_open())
+    return false;
+
+  std::time_t indexedTime = 0;
+  fs >> indexedTime;
+  fs.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+  // the index is stale if the directory changed after it was written
+  if(!fs.good() || indexedTime != bf::last_write_time(folder))
+    return false;
+
+  std::string line;
+  while(getline(fs, line))
+  {
+    if(!line.empty())
+      out_filenames.push_back(line);
+  }
+  ALICEVISION_LOG_DEBUG("Loaded " << out_filenames.size() << " filenames from the index of " << folder);
+  return true;
+}
+
+/**
+ * @brief Persist the sorted list of image filenames of a folder into its index file.
+ * Failures are not fatal (e.g. read-only folder), the directory will simply be
+ * walked again on the next run.
+ *
+ * @param[in] folder The folder containing the images.
+ * @param[in] filenames The sorted image filenames to store.
+ */
+void saveDirectoryIndex(const std::string& folder, const std::vector<std::string>& filenames)
+{
+  namespace bf = boost::filesystem;
+  const bf::path indexPath = bf::path(folder) / imageIndexFilename;
+  std::ofstream fs(indexPath.string());
+  if(!fs.is_open())
+    return;
+  // creating the index file itself updates the directory time, so it must be
+  // queried once the file already exists
+  fs << bf::last_write_time(folder) << "\n";
+  for(const std::string& filename : filenames)
+    fs << filename << "\n";
+}
+
+} // unnamed namespace
+
 bool ImageFeed::FeederImpl::isSupported(const std::string &ext)
 {
   const auto start = FeederImpl::supportedExtensions.begin();
@@ -236,34 +306,41 @@ ImageFeed::FeederImpl::FeederImpl(const std::string& imagePath, const std::strin
       ALICEVISION_LOG_DEBUG("folder without expression: " << imagePath);
     }
     ALICEVISION_LOG_DEBUG("directory feedImage");
-    // if it is a directory, list all the images and add them to the list
-    bf::directory_iterator iterator(folder);
-    // since some OS will provide the files in a random order, first store them
-    // in a priority queue and then fill the _image queue with the alphabetical
-    // order from the priority queue
-    std::priority_queue<std::string, 
-                    std::vector<std::string>, 
-                    std::greater<std::string> > tmpSorter;
-    for(; iterator != bf::directory_iterator(); ++iterator)
+    // if it is a directory, list all the images and add them to the list,
+    // using the persisted index of the folder when it is still up to date
+    std::vector<std::string> filenames;
+    if(!loadDirectoryIndex(folder, filenames))
     {
-      // get the extension of the current file to check whether it is an image
-      const std::string ext = iterator->path().extension().string();
-      if(FeederImpl::isSupported(ext))
+      bf::directory_iterator iterator(folder);
+      // since some OS will provide the files in a random order, first store them
+      // in a priority queue and then fill the filename list with the alphabetical
+      // order from the priority queue
+      std::priority_queue<std::string,
+                      std::vector<std::string>,
+                      std::greater<std::string> > tmpSorter;
+      for(; iterator != bf::directory_iterator(); ++iterator)
       {
-        const std::string filepath = iterator->path().string();
-        const std::string filename = iterator->path().filename().string();
-        // If we have a filePattern (a sequence of images), we have to match the regex.
-        if(filePattern.empty() || std::regex_match(filename, re))
-          tmpSorter.push(filepath);
+        // get the extension of the current file to check whether it is an image
+        const std::string ext = iterator->path().extension().string();
+        if(FeederImpl::isSupported(ext))
+          tmpSorter.push(iterator->path().filename().string());
       }
+      // put all the retrieved files inside the list
+      while(!tmpSorter.empty())
+      {
+        filenames.push_back(tmpSorter.top());
+        tmpSorter.pop();
+      }
+      // persist the sorted list so later runs over the same folder can skip the walk
+      saveDirectoryIndex(folder, filenames);
     }
-    // put all the retrieve files inside the queue
-    while(!tmpSorter.empty())
+    for(const std::string& filename : filenames)
     {
-      _images.push_back(tmpSorter.top());
-      tmpSorter.pop();
+      // If we have a filePattern (a sequence of images), we have to match the regex.
+      if(filePattern.empty() || std::regex_match(filename, re))
+        _images.push_back((bf::path(folder) / filename).string());
     }
-    
+
     _withCalibration = !calibPath.empty();
     _sfmMode = false;
     _isInit = true;
@@ -12,9 +12,14 @@
 #include <opencv2/imgproc.hpp>
 #include <opencv2/core/eigen.hpp>
 #include <opencv2/highgui.hpp>
+#include <opencv2/videoio.hpp>
 
+#include <condition_variable>
+#include <deque>
 #include <iostream>
 #include <exception>
+#include <mutex>
+#include <thread>
 
 namespace aliceVision{
 namespace dataio{
@@ -23,103 +28,248 @@ class VideoFeed::FeederImpl
 {
 public:
   FeederImpl() : _isInit(false) { }
-  
-  FeederImpl(const std::string &videoPath, const std::string &calibPath);
-  
-  FeederImpl(int videoDevice, const std::string &calibPath);
-  
+
+  FeederImpl(const std::string &videoPath, const std::string &calibPath, std::size_t prefetchDepth);
+
+  FeederImpl(int videoDevice, const std::string &calibPath, std::size_t prefetchDepth);
+
+  ~FeederImpl();
+
   bool isInit() const {return _isInit;}
-  
+
   bool readImage(image::Image<image::RGBColor> &imageRGB,
                    camera::PinholeRadialK3 &camIntrinsics,
                    std::string &mediaPath,
                    bool &hasIntrinsics);
-  
+
   bool readImage(image::Image<unsigned char> &imageGray,
                      camera::PinholeRadialK3 &camIntrinsics,
                      std::string &mediaPath,
                      bool &hasIntrinsics);
-  
+
   bool goToFrame(const unsigned int frame);
-  
+
   bool goToNextFrame();
-  
+
   std::size_t nbFrames() const;
-  
+
 private:
+  /// A decoded frame, already converted off the consumer thread
+  struct FrameEntry
+  {
+    bool valid = false;
+    cv::Mat rgb;
+    cv::Mat gray;
+    cv::Mat raw; // only filled for non 3-channel frames
+  };
+
+  /// Open the capture, requesting hardware accelerated decoding when the
+  /// OpenCV version exposes it (it falls back to software decoding otherwise)
+  template<typename SourceT>
+  void openCapture(const SourceT& source)
+  {
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 6)
+    _videoCapture.open(source, cv::CAP_ANY,
+      {cv::CAP_PROP_HW_ACCELERATION, cv::VIDEO_ACCELERATION_ANY});
+#else
+    _videoCapture.open(source);
+#endif
+  }
+
+  void startDecodeWorker();
+  void stopDecodeWorker();
+  /// Decode-ahead loop, runs on the worker thread
+  void decodeLoop();
+  /// Pop the next prefetched frame into the current slot
+  bool advance();
+
   bool _isInit;
   bool _isLive;
   bool _withIntrinsics;
   std::string _videoPath;
   cv::VideoCapture _videoCapture;
   camera::PinholeRadialK3 _camIntrinsics;
+
+  bool _isOpened = false;
+  std::size_t _nbFrames = 0;
+
+  // decode-ahead state: the worker thread decodes and converts the upcoming
+  // frames into a bounded queue, the consumer thread only pops them
+  std::size_t _prefetchDepth = 1;
+  std::deque<FrameEntry> _queue;
+  mutable std::mutex _queueMutex;
+  std::condition_variable _queueNotEmpty;
+  std::condition_variable _queueNotFull;
+  std::thread _worker;
+  bool _stopWorker = false;
+  bool _workerRunning = false;
+  /// The frame currently exposed by readImage
+  FrameEntry _current;
 };
 
 
-VideoFeed::FeederImpl::FeederImpl(const std::string &videoPath, const std::string &calibPath)
-: _isInit(false), _isLive(false), _withIntrinsics(false), _videoPath(videoPath)
+VideoFeed::FeederImpl::FeederImpl(const std::string &videoPath, const std::string &calibPath, std::size_t prefetchDepth)
+: _isInit(false), _isLive(false), _withIntrinsics(false), _videoPath(videoPath),
+  _prefetchDepth(std::max<std::size_t>(1, prefetchDepth))
 {
     // load the video
-  _videoCapture.open(videoPath);
+  openCapture(videoPath);
   if (!_videoCapture.isOpened())
   {
     ALICEVISION_LOG_WARNING("Unable to open the video : " << videoPath);
     throw std::invalid_argument("Unable to open the video : "+videoPath);
   }
-  // Grab frame 0, so we can call readImage.
-  goToFrame(0);
+  _isOpened = true;
+  _nbFrames = _videoCapture.get(cv::CAP_PROP_FRAME_COUNT);
+
+  // Decode ahead of frame 0, so we can call readImage.
+  startDecodeWorker();
+  advance();
 
   // load the calibration path
   _withIntrinsics = !calibPath.empty();
   if(_withIntrinsics)
     readCalibrationFromFile(calibPath, _camIntrinsics);
-  
+
   _isInit = true;
 }
 
-VideoFeed::FeederImpl::FeederImpl(int videoDevice, const std::string &calibPath)
-: _isInit(false), _isLive(true), _withIntrinsics(false), _videoPath(std::to_string(videoDevice))
+VideoFeed::FeederImpl::FeederImpl(int videoDevice, const std::string &calibPath, std::size_t prefetchDepth)
+: _isInit(false), _isLive(true), _withIntrinsics(false), _videoPath(std::to_string(videoDevice)),
+  _prefetchDepth(std::max<std::size_t>(1, prefetchDepth))
 {
     // load the video
-  _videoCapture.open(videoDevice);
+  openCapture(videoDevice);
   if (!_videoCapture.isOpened())
   {
     ALICEVISION_LOG_WARNING("Unable to open the video : " << _videoPath);
     throw std::invalid_argument("Unable to open the video : "+_videoPath);
   }
+  _isOpened = true;
+
+  startDecodeWorker();
+  advance();
 
-  goToNextFrame();
-  
   // load the calibration path
   _withIntrinsics = !calibPath.empty();
   if(_withIntrinsics)
     readCalibrationFromFile(calibPath, _camIntrinsics);
-  
+
   _isInit = true;
 }
 
+VideoFeed::FeederImpl::~FeederImpl()
+{
+  stopDecodeWorker();
+}
+
+void VideoFeed::FeederImpl::startDecodeWorker()
+{
+  _stopWorker = false;
+  _workerRunning = true;
+  _worker = std::thread(&FeederImpl::decodeLoop, this);
+}
+
+void VideoFeed::FeederImpl::stopDecodeWorker()
+{
+  {
+    std::lock_guard<std::mutex> lock(_queueMutex);
+    _stopWorker = true;
+  }
+  _queueNotFull.notify_all();
+  _queueNotEmpty.notify_all();
+  if(_worker.joinable())
+    _worker.join();
+  _queue.clear();
+}
+
+void VideoFeed::FeederImpl::decodeLoop()
+{
+  while(true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(_queueMutex);
+      while(!_stopWorker && _queue.size() >= _prefetchDepth)
+        _queueNotFull.wait(lock);
+      if(_stopWorker)
+        break;
+    }
+
+    // decode the next frame and convert it off the consumer thread
+    FrameEntry entry;
+    cv::Mat frame;
+    if(_videoCapture.grab() && _videoCapture.retrieve(frame) && frame.data)
+    {
+      entry.valid = true;
+      if(frame.channels() == 3)
+      {
+        cv::cvtColor(frame, entry.rgb, CV_BGR2RGB);
+        cv::cvtColor(frame, entry.gray, CV_BGR2GRAY);
+      }
+      else
+      {
+        // retrieve may reuse its internal buffer
+        entry.raw = frame.clone();
+      }
+    }
+
+    const bool endOfStream = !entry.valid;
+    {
+      std::lock_guard<std::mutex> lock(_queueMutex);
+      if(_stopWorker)
+        break;
+      _queue.push_back(entry);
+      if(endOfStream)
+        _workerRunning = false;
+    }
+    _queueNotEmpty.notify_one();
+
+    // the end of stream sentinel is pushed, nothing left to decode
+    if(endOfStream)
+      return;
+  }
+
+  std::lock_guard<std::mutex> lock(_queueMutex);
+  _workerRunning = false;
+}
+
+bool VideoFeed::FeederImpl::advance()
+{
+  std::unique_lock<std::mutex> lock(_queueMutex);
+  while(_queue.empty() && _workerRunning)
+    _queueNotEmpty.wait(lock);
+
+  if(_queue.empty())
+  {
+    // the stream ended and the sentinel was already consumed
+    _current = FrameEntry();
+    return false;
+  }
+
+  _current = _queue.front();
+  _queue.pop_front();
+  lock.unlock();
+  _queueNotFull.notify_one();
+  return _current.valid;
+}
+
 bool VideoFeed::FeederImpl::readImage(image::Image<image::RGBColor> &imageRGB,
           camera::PinholeRadialK3 &camIntrinsics,
           std::string &mediaPath,
           bool &hasIntrinsics)
 {
-  cv::Mat frame;
-  const bool grabStatus = _videoCapture.retrieve(frame);
-
-  if(!grabStatus || !frame.data)
+  if(!_current.valid)
   {
     return false;
   }
-  
-  if(frame.channels() == 3)
+
+  if(!_current.rgb.empty())
   {
-    cv::Mat color;
-    resize(frame, color, cv::Size(frame.cols, frame.rows));
-    
-    cv::cvtColor(frame, color, CV_BGR2RGB);
+    // the BGR to RGB conversion already ran on the decode worker
+    const cv::Mat& color = _current.rgb;
     imageRGB.resize(color.cols, color.rows);
-    
-    unsigned char* pixelPtr = (unsigned char*)color.data;
+
+    const unsigned char* pixelPtr = (const unsigned char*)color.data;
     for(int i = 0; i < color.rows; i++)
     {
       for(int j = 0; j < color.cols; j++)
@@ -134,7 +284,7 @@ bool VideoFeed::FeederImpl::readImage(image::Image<image::RGBColor> &imageRGB,
     ALICEVISION_LOG_WARNING("Error can't read RGB frame " << _videoPath);
     throw std::invalid_argument("Error can't read RGB frame " + _videoPath);
   }
-  
+
   hasIntrinsics = _withIntrinsics;
   if(_withIntrinsics)
     camIntrinsics = _camIntrinsics;
@@ -149,27 +299,20 @@ bool VideoFeed::FeederImpl::readImage(image::Image<unsigned char> &imageGray,
                    std::string &mediaPath,
                    bool &hasIntrinsics)
 {
-  cv::Mat frame;
-  const bool grabStatus = _videoCapture.retrieve(frame);
-
-  if(!grabStatus || !frame.data)
+  if(!_current.valid)
   {
     return false;
   }
-  
-  if(frame.channels() == 3)
+
+  if(!_current.gray.empty())
   {
-    // convert to gray
-    cv::Mat grey;
-    cv::cvtColor(frame, grey, CV_BGR2GRAY);
-    imageGray.resize(grey.cols, grey.rows);
-    cv::cv2eigen(grey, imageGray);
-//      ALICEVISION_LOG_DEBUG(grey.channels() << " " << grey.rows << " " << grey.cols);
-//      ALICEVISION_LOG_DEBUG(imageGray.Depth() << " " << imageGray.Height() << " " << imageGray.Width());
+    // the gray conversion already ran on the decode worker
+    imageGray.resize(_current.gray.cols, _current.gray.rows);
+    cv::cv2eigen(_current.gray, imageGray);
   }
   else
   {
-    cv::cv2eigen(frame, imageGray);
+    cv::cv2eigen(_current.raw, imageGray);
   }
 
   hasIntrinsics = _withIntrinsics;
@@ -182,39 +325,34 @@ bool VideoFeed::FeederImpl::readImage(image::Image<unsigned char> &imageGray,
 
 std::size_t VideoFeed::FeederImpl::nbFrames() const
 {
-  if (!_videoCapture.isOpened())
+  if (!_isOpened)
     return 0;
-  return _videoCapture.get(cv::CAP_PROP_FRAME_COUNT);
+  return _nbFrames;
 }
 
 bool VideoFeed::FeederImpl::goToFrame(const unsigned int frame)
 {
-  if (!_videoCapture.isOpened())
+  if (!_isOpened)
   {
     ALICEVISION_LOG_WARNING("We cannot open the video file.");
     return false;
   }
-  
+
   if(_isLive)
     return goToNextFrame();
-  
-  if(frame > 0)
-  {
-    _videoCapture.set(cv::CAP_PROP_POS_FRAMES, frame);
-    _videoCapture.grab();
-    return true;
-  }
-  else
-  {
-    _videoCapture.set(cv::CAP_PROP_POS_FRAMES, 0);
-    _videoCapture.grab();
-    return false;
-  }
+
+  // flush the prefetched frames and seek
+  stopDecodeWorker();
+  _videoCapture.set(cv::CAP_PROP_POS_FRAMES, frame);
+  startDecodeWorker();
+  advance();
+
+  return frame > 0;
 }
 
 bool VideoFeed::FeederImpl::goToNextFrame()
 {
-  return _videoCapture.grab();
+  return advance();
 }
 
 /*******************************************************************************/
@@ -223,12 +361,12 @@ bool VideoFeed::FeederImpl::goToNextFrame()
 
 VideoFeed::VideoFeed() : _feeder(new FeederImpl()) { }
 
-VideoFeed::VideoFeed(const std::string &videoPath, const std::string &calibPath) 
-  : _feeder(new FeederImpl(videoPath, calibPath))
+VideoFeed::VideoFeed(const std::string &videoPath, const std::string &calibPath, std::size_t prefetchDepth)
+  : _feeder(new FeederImpl(videoPath, calibPath, prefetchDepth))
 { }
 
-VideoFeed::VideoFeed(int videoDevice, const std::string &calibPath) 
-  : _feeder(new FeederImpl(videoDevice, calibPath))
+VideoFeed::VideoFeed(int videoDevice, const std::string &calibPath, std::size_t prefetchDepth)
+  : _feeder(new FeederImpl(videoDevice, calibPath, prefetchDepth))
 { }
 
 bool VideoFeed::readImage(image::Image<image::RGBColor> &imageRGB,
@@ -266,5 +404,5 @@ bool VideoFeed::isInit() const {return(_feeder->isInit()); }
 
 VideoFeed::~VideoFeed() { }
 
-}//namespace dataio 
+}//namespace dataio
 }//namespace aliceVision
@@ -7,6 +7,7 @@
 
 #include "IFeed.hpp"
 
+#include <cstddef>
 #include <string>
 #include <memory>
 
@@ -33,9 +34,12 @@ public:
    * double #k1
    * double #k2
    * 
+   * @param[in] prefetchDepth The number of frames the decode worker is allowed
+   * to decode and convert ahead of the consumer (at least 1).
+   *
    * @see readCalibrationFromFile()
-   */  
-  VideoFeed(const std::string &videoPath, const std::string &calibPath);
+   */
+  VideoFeed(const std::string &videoPath, const std::string &calibPath, std::size_t prefetchDepth = 8);
 
   /**
    * @brief Set up an image feed from a video
@@ -52,9 +56,12 @@ public:
    * double #k1
    * double #k2
    * 
+   * @param[in] prefetchDepth The number of frames the decode worker is allowed
+   * to decode and convert ahead of the consumer (at least 1).
+   *
    * @see readCalibrationFromFile()
-   */    
-  VideoFeed(int videoDevice, const std::string &calibPath);
+   */
+  VideoFeed(int videoDevice, const std::string &calibPath, std::size_t prefetchDepth = 8);
   
   /**
    * @brief Provide a new RGB image from the feed
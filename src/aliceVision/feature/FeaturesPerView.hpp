@@ -22,15 +22,22 @@ using MapFeaturesPerView = HashMap<IndexT, MapFeaturesPerDesc>;
 
 /**
  * @brief Container for all Features for each View.
+ *
+ * Read-mostly container: the const accessors never mutate the maps, so any
+ * number of threads can query features concurrently without locking once the
+ * container is filled. Concurrent filling is possible by pre-creating the
+ * (view, describerType) slots first and writing disjoint slots afterwards,
+ * as done by loadFeaturesPerView().
  */
 class FeaturesPerView
 {
 public:
 
   /**
-   * @brief Get the PointFeatures belonging to the View, 
+   * @brief Get the PointFeatures belonging to the View,
    * if the view does not exist it returns an empty PointFeatures.
-   * 
+   * Never inserts anything: safe to call concurrently.
+   *
    * @param viewId
    * @return PointFeatures or an empty PointFeatures.
    */
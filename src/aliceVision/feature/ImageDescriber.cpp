@@ -77,6 +77,7 @@ std::unique_ptr<ImageDescriber> createImageDescriber(EImageDescriberType imageDe
   {
     case EImageDescriberType::SIFT:        describerPtr.reset(new ImageDescriber_SIFT(SiftParams())); break;
     case EImageDescriberType::SIFT_FLOAT:  describerPtr.reset(new ImageDescriber_SIFT_vlfeatFloat(SiftParams())); break;
+    case EImageDescriberType::SIFT_UPRIGHT:describerPtr.reset(new ImageDescriber_SIFT(SiftParams(), false)); break;
     case EImageDescriberType::AKAZE:       describerPtr.reset(new ImageDescriber_AKAZE(AKAZEParams(AKAZEConfig(), feature::AKAZE_MSURF))); break;
     case EImageDescriberType::AKAZE_MLDB:  describerPtr.reset(new ImageDescriber_AKAZE(AKAZEParams(AKAZEConfig(), feature::AKAZE_MLDB))); break;
     case EImageDescriberType::AKAZE_LIOP:  describerPtr.reset(new ImageDescriber_AKAZE(AKAZEParams(AKAZEConfig(), feature::AKAZE_LIOP))); break;
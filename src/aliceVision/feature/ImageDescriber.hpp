@@ -13,6 +13,7 @@
 
 #include <string>
 #include <iostream>
+#include <vector>
 
 namespace aliceVision {
 namespace feature {
@@ -110,6 +111,14 @@ public:
    */
   virtual void setUpRight(bool upRight) {}
 
+  /**
+   * @brief Apply the keypoint grid filtering on a detection-only first pass,
+   * so descriptors are only computed for the keypoints that survive the
+   * selection. Ignored by the describers without grid filtering.
+   * @param[in] preFilterGrid
+   */
+  virtual void setPreFilterGrid(bool preFilterGrid) {}
+
   /**
    * @brief Detect regions on the 8-bit image and compute their attributes (description)
    * @param[in] image Image.
@@ -140,6 +149,44 @@ public:
     return false;
   }
 
+  /**
+   * @brief Detect regions on a batch of 8-bit images and compute their attributes.
+   * The default implementation describes the images one by one, GPU describers
+   * can override it to pipeline host-to-device transfers and kernels over the batch.
+   * @param[in] images The batch of images
+   * @param[out] regionsPerImage The detected regions and attributes for each image
+   */
+  virtual bool DescribeBatch(const std::vector<const image::Image<unsigned char>*>& images,
+    std::vector<std::unique_ptr<Regions>>& regionsPerImage)
+  {
+    regionsPerImage.resize(images.size());
+    for(std::size_t i = 0; i < images.size(); ++i)
+    {
+      if(!Describe(*images[i], regionsPerImage[i]))
+        return false;
+    }
+    return true;
+  }
+
+  /**
+   * @brief Detect regions on a batch of float images and compute their attributes.
+   * The default implementation describes the images one by one, GPU describers
+   * can override it to pipeline host-to-device transfers and kernels over the batch.
+   * @param[in] images The batch of images
+   * @param[out] regionsPerImage The detected regions and attributes for each image
+   */
+  virtual bool DescribeBatch(const std::vector<const image::Image<float>*>& images,
+    std::vector<std::unique_ptr<Regions>>& regionsPerImage)
+  {
+    regionsPerImage.resize(images.size());
+    for(std::size_t i = 0; i < images.size(); ++i)
+    {
+      if(!Describe(*images[i], regionsPerImage[i]))
+        return false;
+    }
+    return true;
+  }
+
   /**
    * @brief Allocate Regions type depending of the ImageDescriber
    * @param[in,out] regions
@@ -0,0 +1,212 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <cstddef>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define ALICEVISION_HAVE_MMAP_DESC
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace aliceVision {
+namespace feature {
+
+/**
+ * @brief Read-only view over a binary descriptor file (.desc).
+ *
+ * The on-disk layout is a std::size_t descriptor count followed by a flat
+ * array of fixed-size POD descriptors, so the payload can be used in-place.
+ * On POSIX systems the file is memory-mapped: loading is near-instant, the
+ * pages are shared through the OS page cache between concurrent processes
+ * and nothing is copied. On other systems the file content is read into an
+ * internal buffer, which still avoids any per-descriptor deserialization.
+ */
+class MappedDescriptorFile
+{
+public:
+  MappedDescriptorFile() = default;
+
+  MappedDescriptorFile(const MappedDescriptorFile&) = delete;
+  MappedDescriptorFile& operator=(const MappedDescriptorFile&) = delete;
+
+  ~MappedDescriptorFile()
+  {
+    close();
+  }
+
+  /**
+   * @brief Map the given descriptor file.
+   * @param[in] filePath The descriptor file (usually .desc)
+   * @param[in] descriptorSize The memory size of one descriptor, used to
+   * check the consistency of the file payload against its header.
+   */
+  void open(const std::string& filePath, std::size_t descriptorSize)
+  {
+    close();
+
+#ifdef ALICEVISION_HAVE_MMAP_DESC
+    const int fd = ::open(filePath.c_str(), O_RDONLY);
+    if(fd < 0)
+      throw std::runtime_error("Can't load descriptor binary file, can't open '" + filePath + "' !");
+
+    struct stat fileStat;
+    if(::fstat(fd, &fileStat) != 0 || static_cast<std::size_t>(fileStat.st_size) < sizeof(std::size_t))
+    {
+      ::close(fd);
+      throw std::runtime_error("Can't load descriptor binary file, '" + filePath + "' is incorrect !");
+    }
+
+    _mappedSize = static_cast<std::size_t>(fileStat.st_size);
+    _mappedData = ::mmap(nullptr, _mappedSize, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if(_mappedData == MAP_FAILED)
+    {
+      _mappedData = nullptr;
+      _mappedSize = 0;
+      throw std::runtime_error("Can't load descriptor binary file, mmap of '" + filePath + "' failed !");
+    }
+
+    _descCount = *reinterpret_cast<const std::size_t*>(_mappedData);
+#else
+    std::ifstream fileIn(filePath.c_str(), std::ios::in | std::ios::binary);
+    if(!fileIn.is_open())
+      throw std::runtime_error("Can't load descriptor binary file, can't open '" + filePath + "' !");
+
+    fileIn.seekg(0, std::ios::end);
+    const std::size_t fileSize = fileIn.tellg();
+    if(fileSize < sizeof(std::size_t))
+      throw std::runtime_error("Can't load descriptor binary file, '" + filePath + "' is incorrect !");
+
+    fileIn.seekg(0, std::ios::beg);
+    _buffer.resize(fileSize);
+    fileIn.read(_buffer.data(), fileSize);
+    if(!fileIn.good())
+      throw std::runtime_error("Can't load descriptor binary file, '" + filePath + "' is incorrect !");
+
+    _descCount = *reinterpret_cast<const std::size_t*>(_buffer.data());
+#endif
+
+    if(payloadSize() < _descCount * descriptorSize)
+    {
+      close();
+      throw std::runtime_error("Can't load descriptor binary file, '" + filePath + "' is truncated !");
+    }
+  }
+
+  /**
+   * @brief Map a POSIX shared memory segment holding a .desc payload (see
+   * SharedRegionsStore) instead of a file. Throws on non-POSIX systems.
+   * @param[in] shmName The shared memory segment name
+   * @param[in] payloadOffset Byte offset of the .desc payload in the segment
+   * @param[in] descriptorSize The memory size of one descriptor, used to
+   * check the consistency of the payload against its header.
+   */
+  void openSharedMemory(const std::string& shmName, std::size_t payloadOffset, std::size_t descriptorSize)
+  {
+    close();
+
+#ifdef ALICEVISION_HAVE_MMAP_DESC
+    const int fd = ::shm_open(shmName.c_str(), O_RDONLY, 0);
+    if(fd < 0)
+      throw std::runtime_error("Can't load shared memory descriptors, can't open segment '" + shmName + "' !");
+
+    struct stat segmentStat;
+    if(::fstat(fd, &segmentStat) != 0 ||
+       static_cast<std::size_t>(segmentStat.st_size) < payloadOffset + sizeof(std::size_t))
+    {
+      ::close(fd);
+      throw std::runtime_error("Can't load shared memory descriptors, segment '" + shmName + "' is incorrect !");
+    }
+
+    _mappedSize = static_cast<std::size_t>(segmentStat.st_size);
+    _mappedData = ::mmap(nullptr, _mappedSize, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if(_mappedData == MAP_FAILED)
+    {
+      _mappedData = nullptr;
+      _mappedSize = 0;
+      throw std::runtime_error("Can't load shared memory descriptors, mmap of '" + shmName + "' failed !");
+    }
+
+    _payloadOffset = payloadOffset;
+    _descCount = *reinterpret_cast<const std::size_t*>(static_cast<const char*>(_mappedData) + payloadOffset);
+
+    if(payloadSize() < _descCount * descriptorSize)
+    {
+      close();
+      throw std::runtime_error("Can't load shared memory descriptors, segment '" + shmName + "' is truncated !");
+    }
+#else
+    (void)payloadOffset;
+    (void)descriptorSize;
+    throw std::runtime_error("Can't load shared memory descriptors, segment '" + shmName + "' requires a POSIX system !");
+#endif
+  }
+
+  void close()
+  {
+#ifdef ALICEVISION_HAVE_MMAP_DESC
+    if(_mappedData != nullptr)
+      ::munmap(_mappedData, _mappedSize);
+    _mappedData = nullptr;
+    _mappedSize = 0;
+    _payloadOffset = 0;
+#else
+    _buffer.clear();
+    _buffer.shrink_to_fit();
+#endif
+    _descCount = 0;
+  }
+
+  /// Pointer to the first descriptor of the payload
+  const void* data() const
+  {
+#ifdef ALICEVISION_HAVE_MMAP_DESC
+    return static_cast<const char*>(_mappedData) + _payloadOffset + sizeof(std::size_t);
+#else
+    return _buffer.data() + sizeof(std::size_t);
+#endif
+  }
+
+  /// Number of descriptors stored in the file
+  std::size_t descriptorCount() const
+  {
+    return _descCount;
+  }
+
+private:
+  std::size_t payloadSize() const
+  {
+#ifdef ALICEVISION_HAVE_MMAP_DESC
+    return _mappedSize - _payloadOffset - sizeof(std::size_t);
+#else
+    return _buffer.size() - sizeof(std::size_t);
+#endif
+  }
+
+#ifdef ALICEVISION_HAVE_MMAP_DESC
+  void* _mappedData = nullptr;
+  std::size_t _mappedSize = 0;
+  /// Offset of the .desc payload in the mapping (0 for a whole .desc file)
+  std::size_t _payloadOffset = 0;
+#else
+  std::vector<char> _buffer;
+#endif
+  std::size_t _descCount = 0;
+};
+
+} // namespace feature
+} // namespace aliceVision
@@ -135,28 +135,56 @@ inline std::istream& operator>>(std::istream& in, SIOPointFeature& obj)
   return in >> *pf >> obj._scale >> obj._orientation;
 }
 
+/// Read feats from a stream (same text payload as the .feat file)
+template<typename FeaturesT >
+inline void loadFeatsFromStream(
+  std::istream & streamIn,
+  FeaturesT & vec_feat)
+{
+  vec_feat.clear();
+
+  std::copy(
+    std::istream_iterator<typename FeaturesT::value_type >(streamIn),
+    std::istream_iterator<typename FeaturesT::value_type >(),
+    std::back_inserter(vec_feat));
+  if(streamIn.bad())
+    throw std::runtime_error("Can't load features, the stream is incorrect !");
+}
+
 /// Read feats from file
 template<typename FeaturesT >
 inline void loadFeatsFromFile(
   const std::string & sfileNameFeats,
   FeaturesT & vec_feat)
 {
-  vec_feat.clear();
-
   std::ifstream fileIn(sfileNameFeats);
 
   if(!fileIn.is_open())
     throw std::runtime_error("Can't load features file, can't open '" + sfileNameFeats + "' !");
-  
-  std::copy(
-    std::istream_iterator<typename FeaturesT::value_type >(fileIn),
-    std::istream_iterator<typename FeaturesT::value_type >(),
-    std::back_inserter(vec_feat));
-  if(fileIn.bad())
+
+  try
+  {
+    loadFeatsFromStream(fileIn, vec_feat);
+  }
+  catch(const std::exception&)
+  {
     throw std::runtime_error("Can't load features file, '" + sfileNameFeats + "' is incorrect !");
+  }
   fileIn.close();
 }
 
+/// Write feats to a stream (same text payload as the .feat file)
+template<typename FeaturesT >
+inline void saveFeatsToStream(
+  std::ostream & streamOut,
+  const FeaturesT & vec_feat)
+{
+  std::copy(vec_feat.begin(), vec_feat.end(), std::ostream_iterator<typename FeaturesT::value_type >(streamOut,"\n"));
+
+  if(!streamOut.good())
+    throw std::runtime_error("Can't save features, the stream is incorrect !");
+}
+
 /// Write feats to file
 template<typename FeaturesT >
 inline void saveFeatsToFile(
@@ -168,7 +196,7 @@ inline void saveFeatsToFile(
   if (!file.is_open())
     throw std::runtime_error("Can't save features file, can't open '" + sfileNameFeats + "' !");
 
-  std::copy(vec_feat.begin(), vec_feat.end(), std::ostream_iterator<typename FeaturesT::value_type >(file,"\n"));
+  saveFeatsToStream(file, vec_feat);
 
   if(!file.good())
     throw std::runtime_error("Can't save features file, '" + sfileNameFeats + "' is incorrect !");
@@ -9,12 +9,15 @@
 #include "aliceVision/numeric/numeric.hpp"
 #include "aliceVision/feature/PointFeature.hpp"
 #include "aliceVision/feature/Descriptor.hpp"
+#include "aliceVision/feature/MappedDescriptorFile.hpp"
 #include "aliceVision/matching/metric.hpp"
 
 #include "cereal/types/vector.hpp"
 
+#include <algorithm>
 #include <string>
 #include <cstddef>
+#include <memory>
 #include <typeinfo>
 
 namespace aliceVision {
@@ -57,6 +60,22 @@ public:
     const std::string& sfileNameFeats,
     const std::string& sfileNameDescs) = 0;
 
+  /**
+   * @brief Like Load, but the descriptors stay in the .desc file and are
+   * memory-mapped instead of being copied into memory when the container
+   * supports it. The default implementation falls back to a regular Load.
+   *
+   * @warning In mapped mode the regions are read-only: descriptors are
+   * exposed through DescriptorRawData() but the descriptor container
+   * getters of the concrete type stay empty.
+   */
+  virtual void LoadMapped(
+    const std::string& sfileNameFeats,
+    const std::string& sfileNameDescs)
+  {
+    Load(sfileNameFeats, sfileNameDescs);
+  }
+
   virtual void Save(
     const std::string& sfileNameFeats,
     const std::string& sfileNameDescs) const = 0;
@@ -66,6 +85,43 @@ public:
   virtual void LoadFeatures(
     const std::string& sfileNameFeats) = 0;
 
+  //--
+  // IO - stream variants, used by the consolidated pack files (see RegionsPack.hpp).
+  // The payloads are byte-identical to the .feat and .desc file contents.
+  //--
+
+  virtual void LoadFromStreams(
+    std::istream& featStream,
+    std::istream& descStream) = 0;
+
+  virtual void SaveToStreams(
+    std::ostream& featStream,
+    std::ostream& descStream) const = 0;
+
+  virtual void LoadFeaturesFromStream(
+    std::istream& featStream) = 0;
+
+  /**
+   * @brief Read the features from the stream and map the descriptors
+   * in-place from a POSIX shared memory segment (see SharedRegionsStore).
+   * As with LoadMapped the regions are read-only. The default implementation
+   * reads both payloads from the streams instead.
+   * @param[in] featStream Stream over the .feat payload of the segment
+   * @param[in] descStream Stream over the .desc payload of the segment
+   * @param[in] shmName The shared memory segment name
+   * @param[in] descPayloadOffset Byte offset of the .desc payload in the segment
+   */
+  virtual void LoadFromSharedMemory(
+    std::istream& featStream,
+    std::istream& descStream,
+    const std::string& shmName,
+    std::size_t descPayloadOffset)
+  {
+    (void)shmName;
+    (void)descPayloadOffset;
+    LoadFromStreams(featStream, descStream);
+  }
+
   //--
   //- Basic description of a descriptor [Type, Length]
   //--
@@ -97,6 +153,9 @@ public:
    */
   virtual const void * DescriptorRawData() const = 0;
 
+  /// Rough memory footprint of the regions (features + descriptors) in bytes
+  virtual std::size_t getMemoryInBytes() const = 0;
+
   virtual void clearDescriptors() = 0;
 
   /// Return the squared distance between two descriptors
@@ -139,6 +198,11 @@ public:
     loadFeatsFromFile(sfileNameFeats, _vec_feats);
   }
 
+  void LoadFeaturesFromStream(std::istream& featStream) override
+  {
+    loadFeatsFromStream(featStream, _vec_feats);
+  }
+
   PointFeatures GetRegionsPositions() const
   {
     return PointFeatures(_vec_feats.begin(), _vec_feats.end());
@@ -152,6 +216,11 @@ public:
   /// Return the number of defined regions
   std::size_t RegionCount() const {return _vec_feats.size();}
 
+  std::size_t getMemoryInBytes() const override
+  {
+    return _vec_feats.capacity() * sizeof(FeatureT);
+  }
+
   /// Mutable and non-mutable FeatureT getters.
   inline std::vector<FeatureT> & Features() { return _vec_feats; }
   inline const std::vector<FeatureT> & Features() const { return _vec_feats; }
@@ -203,6 +272,9 @@ public:
 
 protected:
   std::vector<DescriptorT> _vec_descs; // region descriptions
+  /// Optional memory-mapped descriptor storage, shared between copies.
+  /// When set, it replaces _vec_descs as the descriptor source.
+  std::shared_ptr<MappedDescriptorFile> _mappedDescs;
 
 public:
   std::string Type_id() const override {return typeid(T).name();}
@@ -223,6 +295,19 @@ public:
   {
     loadFeatsFromFile(sfileNameFeats, this->_vec_feats);
     loadDescsFromBinFile(sfileNameDescs, _vec_descs);
+    _mappedDescs.reset();
+  }
+
+  /// Read the regions, the descriptors are memory-mapped from the file.
+  void LoadMapped(
+    const std::string& sfileNameFeats,
+    const std::string& sfileNameDescs) override
+  {
+    loadFeatsFromFile(sfileNameFeats, this->_vec_feats);
+    auto mappedDescs = std::make_shared<MappedDescriptorFile>();
+    mappedDescs->open(sfileNameDescs, sizeof(DescriptorT));
+    _vec_descs.clear();
+    _mappedDescs = mappedDescs;
   }
 
   /// Export in two separate files the regions and their corresponding descriptors.
@@ -239,32 +324,96 @@ public:
     saveDescsToBinFile(sfileNameDescs, _vec_descs);
   }
 
+  /// Read the regions and their descriptors from in-memory streams
+  /// (e.g. the slices of a pack file).
+  void LoadFromStreams(
+    std::istream& featStream,
+    std::istream& descStream) override
+  {
+    loadFeatsFromStream(featStream, this->_vec_feats);
+    loadDescsFromBinStream(descStream, _vec_descs);
+    _mappedDescs.reset();
+  }
+
+  /// Read the regions from shared memory streams, the descriptors are
+  /// mapped in-place from the segment (see SharedRegionsStore).
+  void LoadFromSharedMemory(
+    std::istream& featStream,
+    std::istream& /*descStream*/,
+    const std::string& shmName,
+    std::size_t descPayloadOffset) override
+  {
+    loadFeatsFromStream(featStream, this->_vec_feats);
+    auto mappedDescs = std::make_shared<MappedDescriptorFile>();
+    mappedDescs->openSharedMemory(shmName, descPayloadOffset, sizeof(DescriptorT));
+    _vec_descs.clear();
+    _mappedDescs = mappedDescs;
+  }
+
+  /// Export the regions and their descriptors to streams, with the same
+  /// payloads as the .feat and .desc files.
+  void SaveToStreams(
+    std::ostream& featStream,
+    std::ostream& descStream) const override
+  {
+    saveFeatsToStream(featStream, this->_vec_feats);
+    saveDescsToBinStream(descStream, _vec_descs);
+  }
+
   /// Mutable and non-mutable DescriptorT getters.
   inline std::vector<DescriptorT> & Descriptors() { return _vec_descs; }
   inline const std::vector<DescriptorT> & Descriptors() const { return _vec_descs; }
 
+  /// Pointer to the first descriptor, either in memory or in the mapped file.
+  inline const DescriptorT* descriptorData() const
+  {
+    if(_mappedDescs)
+      return reinterpret_cast<const DescriptorT*>(_mappedDescs->data());
+    return _vec_descs.data();
+  }
+
+  /// Number of descriptors, either in memory or in the mapped file.
+  inline std::size_t descriptorCount() const
+  {
+    if(_mappedDescs)
+      return _mappedDescs->descriptorCount();
+    return _vec_descs.size();
+  }
+
+  /// Memory-mapped descriptors are not counted: they live in the page cache.
+  std::size_t getMemoryInBytes() const override
+  {
+    return this->_vec_feats.capacity() * sizeof(FeatT)
+         + _vec_descs.capacity() * sizeof(DescriptorT);
+  }
+
   inline const void* blindDescriptors() const override { return &_vec_descs; }
 
-  inline const void* DescriptorRawData() const override { return &_vec_descs[0];}
+  inline const void* DescriptorRawData() const override { return descriptorData(); }
 
-  inline void clearDescriptors() override { _vec_descs.clear(); }
+  inline void clearDescriptors() override
+  {
+    _vec_descs.clear();
+    _mappedDescs.reset();
+  }
 
   inline void swap(This& other)
   {
     this->_vec_feats.swap(other._vec_feats);
     _vec_descs.swap(other._vec_descs);
+    _mappedDescs.swap(other._mappedDescs);
   }
 
   // Return the distance between two descriptors
   double SquaredDescriptorDistance(std::size_t i, const Regions * genericRegions, std::size_t j) const override
   {
-    assert(i < this->_vec_descs.size());
+    assert(i < descriptorCount());
     assert(genericRegions);
     assert(j < genericRegions->RegionCount());
 
     const This * regionsT = dynamic_cast<const This*>(genericRegions);
     static typename SquaredMetric<T, regionType>::Metric metric;
-    return metric(this->_vec_descs[i].getData(), regionsT->_vec_descs[j].getData(), DescriptorT::static_size);
+    return metric(descriptorData()[i].getData(), regionsT->descriptorData()[j].getData(), DescriptorT::static_size);
   }
 
   /**
@@ -274,9 +423,9 @@ public:
    */
   void CopyRegion(std::size_t i, Regions * outRegionContainer) const override
   {
-    assert(i < this->_vec_feats.size() && i < this->_vec_descs.size());
+    assert(i < this->_vec_feats.size() && i < descriptorCount());
     static_cast<This*>(outRegionContainer)->_vec_feats.push_back(this->_vec_feats[i]);
-    static_cast<This*>(outRegionContainer)->_vec_descs.push_back(this->_vec_descs[i]);
+    static_cast<This*>(outRegionContainer)->_vec_descs.push_back(descriptorData()[i]);
   }
 
   /**
@@ -302,7 +451,7 @@ public:
     {
       const FeatureInImage & feat = featuresInImage[i];
       regionsPtr->Features().push_back(this->_vec_feats[feat._featureIndex]);
-      regionsPtr->Descriptors().push_back(this->_vec_descs[feat._featureIndex]);
+      regionsPtr->Descriptors().push_back(descriptorData()[feat._featureIndex]);
 
       // This assert should be valid in theory, but in the context of CameraLocalization
       // we can have the same 2D feature associated to different 3D points (2 in practice).
@@ -331,6 +480,74 @@ using ScalarRegions = FeatDescRegions<FeatT, T, L, ERegionType::Scalar>;
 template<typename FeatT, std::size_t L>
 using BinaryRegions = FeatDescRegions<FeatT, unsigned char, L, ERegionType::Binary>;
 
+/**
+ * @brief Quantize float scalar regions to unsigned char regions.
+ *
+ * The values are clamped to [0, 255] without rescaling: the float SIFT
+ * descriptors use the classic 512 scaling where values above 255 are
+ * saturated by convention (like in the native unsigned char descriptors),
+ * so the quantized descriptors stay comparable with native ones.
+ * Matching quantized regions selects the unsigned char kernels, which read
+ * a quarter of the memory bandwidth of the float ones.
+ */
+template<typename FeatT, std::size_t L>
+std::unique_ptr<Regions> quantizeRegionsToUChar(const ScalarRegions<FeatT, float, L>& floatRegions)
+{
+  typedef ScalarRegions<FeatT, unsigned char, L> UCharRegions;
+
+  UCharRegions* quantizedPtr = new UCharRegions();
+  std::unique_ptr<Regions> quantized(quantizedPtr);
+
+  quantizedPtr->Features() = floatRegions.Features();
+
+  // works for in-memory and memory-mapped descriptors
+  const typename ScalarRegions<FeatT, float, L>::DescriptorT* descriptors = floatRegions.descriptorData();
+  const std::size_t count = floatRegions.descriptorCount();
+
+  quantizedPtr->Descriptors().resize(count);
+  for(std::size_t i = 0; i < count; ++i)
+  {
+    for(std::size_t k = 0; k < L; ++k)
+    {
+      const float value = descriptors[i][k];
+      quantizedPtr->Descriptors()[i][k] =
+          static_cast<unsigned char>(std::min(255.0f, std::max(0.0f, value)));
+    }
+  }
+  return quantized;
+}
+
+/**
+ * @brief Convert float scalar regions to half precision regions.
+ *
+ * Unlike quantizeRegionsToUChar the values keep their scale and a relative
+ * precision of about 3 decimal digits; the distance kernels widen them back
+ * to single precision in registers (see matching/metric.hpp), so matching
+ * half regions reads half the memory bandwidth of the float ones.
+ */
+template<typename FeatT, std::size_t L>
+std::unique_ptr<Regions> convertRegionsToHalf(const ScalarRegions<FeatT, float, L>& floatRegions)
+{
+  typedef ScalarRegions<FeatT, Eigen::half, L> HalfRegions;
+
+  HalfRegions* halfPtr = new HalfRegions();
+  std::unique_ptr<Regions> half(halfPtr);
+
+  halfPtr->Features() = floatRegions.Features();
+
+  // works for in-memory and memory-mapped descriptors
+  const typename ScalarRegions<FeatT, float, L>::DescriptorT* descriptors = floatRegions.descriptorData();
+  const std::size_t count = floatRegions.descriptorCount();
+
+  halfPtr->Descriptors().resize(count);
+  for(std::size_t i = 0; i < count; ++i)
+  {
+    for(std::size_t k = 0; k < L; ++k)
+      halfPtr->Descriptors()[i][k] = Eigen::half(descriptors[i][k]);
+  }
+  return half;
+}
+
 
 
 } // namespace feature
@@ -0,0 +1,248 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "RegionsPack.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+
+#include <dependencies/stlplus3/filesystemSimplified/file_system.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+namespace aliceVision {
+namespace feature {
+
+namespace {
+
+// Identifies an index file and its layout version.
+const char packIndexMagic[8] = {'A', 'V', 'P', 'K', 'I', 'D', 'X', '1'};
+
+// One fixed-size index record per view, appended to the index file.
+// The view id is widened to 64 bits to keep the record layout simple.
+struct PackIndexRecord
+{
+  std::uint64_t viewId;
+  std::uint64_t featOffset;
+  std::uint64_t featSize;
+  std::uint64_t descOffset;
+  std::uint64_t descSize;
+};
+
+std::string getIndexPath(const std::string& packPath)
+{
+  return packPath + ".idx";
+}
+
+std::uint64_t getFileSize(const std::string& path)
+{
+  std::ifstream stream(path, std::ios::in | std::ios::binary | std::ios::ate);
+  if(!stream.is_open())
+    return 0;
+  const std::ifstream::pos_type size = stream.tellg();
+  return (size < 0) ? 0 : static_cast<std::uint64_t>(size);
+}
+
+} // namespace
+
+std::string getRegionsPackFilename(const std::string& basename, const std::string& describerTypeName)
+{
+  return basename + "." + describerTypeName + ".pack";
+}
+
+RegionsPackWriter::RegionsPackWriter(const std::string& packPath)
+{
+  const std::string indexPath = getIndexPath(packPath);
+  const bool resume = (getFileSize(indexPath) >= sizeof(packIndexMagic));
+
+  if(resume)
+  {
+    // Appending to an existing pack: check that the index is really ours.
+    std::ifstream indexIn(indexPath, std::ios::in | std::ios::binary);
+    char magic[sizeof(packIndexMagic)];
+    indexIn.read(magic, sizeof(magic));
+    if(!indexIn || std::memcmp(magic, packIndexMagic, sizeof(magic)) != 0)
+      throw std::runtime_error("Invalid regions pack index file '" + indexPath + "' !");
+  }
+
+  _dataOffset = getFileSize(packPath);
+
+  _dataStream.open(packPath, std::ios::out | std::ios::binary | std::ios::app);
+  if(!_dataStream.is_open())
+    throw std::runtime_error("Can't open regions pack file '" + packPath + "' for writing !");
+
+  _indexStream.open(indexPath, std::ios::out | std::ios::binary | std::ios::app);
+  if(!_indexStream.is_open())
+    throw std::runtime_error("Can't open regions pack index file '" + indexPath + "' for writing !");
+
+  if(!resume)
+    _indexStream.write(packIndexMagic, sizeof(packIndexMagic));
+}
+
+void RegionsPackWriter::append(IndexT viewId, const Regions& regions)
+{
+  // Serialize outside the lock: only the file writes are exclusive.
+  std::ostringstream featOut;
+  std::ostringstream descOut(std::ios::out | std::ios::binary);
+  regions.SaveToStreams(featOut, descOut);
+
+  const std::string featBuffer = featOut.str();
+  const std::string descBuffer = descOut.str();
+
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  PackIndexRecord record;
+  record.viewId = viewId;
+  record.featOffset = _dataOffset;
+  record.featSize = featBuffer.size();
+  record.descOffset = _dataOffset + featBuffer.size();
+  record.descSize = descBuffer.size();
+
+  _dataStream.write(featBuffer.data(), featBuffer.size());
+  _dataStream.write(descBuffer.data(), descBuffer.size());
+  _dataStream.flush();
+
+  if(!_dataStream.good())
+    throw std::runtime_error("Can't append view " + std::to_string(viewId) + " regions to the pack file !");
+
+  // The record is written after its data, so a crash can only leave
+  // unindexed bytes at the end of the data file, never a dangling record.
+  _indexStream.write(reinterpret_cast<const char*>(&record), sizeof(record));
+  _indexStream.flush();
+
+  if(!_indexStream.good())
+    throw std::runtime_error("Can't append view " + std::to_string(viewId) + " record to the pack index file !");
+
+  _dataOffset += featBuffer.size() + descBuffer.size();
+}
+
+std::size_t RegionsPackSet::open(const std::vector<std::string>& folders, const std::string& describerTypeName)
+{
+  std::size_t nbPacks = 0;
+  for(const std::string& folder : folders)
+  {
+    if(!stlplus::folder_exists(folder))
+      continue;
+
+    std::vector<std::string> packFiles = stlplus::folder_wildcard(folder, "*." + describerTypeName + ".pack", false, true);
+    // folder_wildcard order is filesystem dependent: sort so that the
+    // "last pack wins" rule is deterministic.
+    std::sort(packFiles.begin(), packFiles.end());
+
+    for(const std::string& packFile : packFiles)
+    {
+      addPack(stlplus::create_filespec(folder, packFile));
+      ++nbPacks;
+    }
+  }
+  return nbPacks;
+}
+
+void RegionsPackSet::addPack(const std::string& packPath)
+{
+  const std::string indexPath = getIndexPath(packPath);
+
+  std::ifstream indexIn(indexPath, std::ios::in | std::ios::binary);
+  if(!indexIn.is_open())
+    throw std::runtime_error("Can't open regions pack index file '" + indexPath + "' !");
+
+  char magic[sizeof(packIndexMagic)];
+  indexIn.read(magic, sizeof(magic));
+  if(!indexIn || std::memcmp(magic, packIndexMagic, sizeof(magic)) != 0)
+    throw std::runtime_error("Invalid regions pack index file '" + indexPath + "' !");
+
+  std::unique_ptr<Pack> pack(new Pack());
+  pack->path = packPath;
+  pack->dataStream.open(packPath, std::ios::in | std::ios::binary);
+  if(!pack->dataStream.is_open())
+    throw std::runtime_error("Can't open regions pack file '" + packPath + "' !");
+
+  const std::size_t packIndex = _packs.size();
+  std::size_t nbViews = 0;
+
+  PackIndexRecord record;
+  while(indexIn.read(reinterpret_cast<char*>(&record), sizeof(record)))
+  {
+    Entry entry;
+    entry.packIndex = packIndex;
+    entry.featOffset = record.featOffset;
+    entry.featSize = record.featSize;
+    entry.descOffset = record.descOffset;
+    entry.descSize = record.descSize;
+    _entries[static_cast<IndexT>(record.viewId)] = entry;
+    ++nbViews;
+  }
+
+  // A partial trailing record (interrupted writer) is simply ignored.
+  _packs.push_back(std::move(pack));
+
+  ALICEVISION_LOG_DEBUG("Regions pack '" << packPath << "': " << nbViews << " views.");
+}
+
+std::vector<IndexT> RegionsPackSet::getViewIds() const
+{
+  std::vector<IndexT> viewIds;
+  viewIds.reserve(_entries.size());
+  for(const auto& entryPair : _entries)
+    viewIds.push_back(entryPair.first);
+  return viewIds;
+}
+
+void RegionsPackSet::readSlice(const Pack& pack, std::uint64_t offset, std::uint64_t size, std::string& buffer) const
+{
+  buffer.resize(size);
+
+  std::lock_guard<std::mutex> lock(pack.mutex);
+
+  pack.dataStream.clear();
+  pack.dataStream.seekg(offset);
+  pack.dataStream.read(&buffer[0], size);
+
+  if(!pack.dataStream.good())
+    throw std::runtime_error("Invalid regions pack file '" + pack.path + "': truncated payload !");
+}
+
+bool RegionsPackSet::loadRegions(IndexT viewId, Regions& regions) const
+{
+  const auto it = _entries.find(viewId);
+  if(it == _entries.end())
+    return false;
+
+  const Entry& entry = it->second;
+  const Pack& pack = *_packs.at(entry.packIndex);
+
+  std::string featBuffer;
+  std::string descBuffer;
+  readSlice(pack, entry.featOffset, entry.featSize, featBuffer);
+  readSlice(pack, entry.descOffset, entry.descSize, descBuffer);
+
+  // The payload parsing runs outside of the pack lock.
+  std::istringstream featIn(featBuffer);
+  std::istringstream descIn(descBuffer, std::ios::in | std::ios::binary);
+  regions.LoadFromStreams(featIn, descIn);
+  return true;
+}
+
+bool RegionsPackSet::loadFeatures(IndexT viewId, Regions& regions) const
+{
+  const auto it = _entries.find(viewId);
+  if(it == _entries.end())
+    return false;
+
+  const Entry& entry = it->second;
+  const Pack& pack = *_packs.at(entry.packIndex);
+
+  std::string featBuffer;
+  readSlice(pack, entry.featOffset, entry.featSize, featBuffer);
+
+  std::istringstream featIn(featBuffer);
+  regions.LoadFeaturesFromStream(featIn);
+  return true;
+}
+
+} // namespace feature
+} // namespace aliceVision
@@ -0,0 +1,146 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+#include <aliceVision/feature/Regions.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace feature {
+
+/**
+ * Consolidated regions storage: instead of one .feat and one .desc file per
+ * view, a pack groups the regions of many views into a single data file
+ * ("<name>.<describerType>.pack") plus a small index file
+ * ("<name>.<describerType>.pack.idx") mapping each view id to the byte range
+ * of its payloads. On large datasets this removes the per-view open() and
+ * directory-scan cost that dominates the regions loading time on shared
+ * filesystems.
+ *
+ * The per-view payloads are byte-identical to the .feat and .desc file
+ * contents, simply concatenated in the data file. Both files are append-only,
+ * so each extraction shard can write its own pack (or resume an interrupted
+ * one) without coordination; a folder can contain several packs and they are
+ * all considered at load time.
+ */
+
+/// Filename of the pack data file for the given describer type, e.g.
+/// "features_0" -> "features_0.SIFT.pack". The index file is the same name
+/// with an additional ".idx" extension.
+std::string getRegionsPackFilename(const std::string& basename, const std::string& describerTypeName);
+
+/**
+ * @brief Append-only writer for a regions pack.
+ *
+ * The writer can open an existing pack, in which case new views are appended
+ * after the ones already indexed. append() is thread-safe so it can be called
+ * directly from concurrent save tasks.
+ */
+class RegionsPackWriter
+{
+public:
+  /// @param[in] packPath The pack data file path (the ".pack.idx" index file
+  /// is derived from it). Parent folder must exist.
+  explicit RegionsPackWriter(const std::string& packPath);
+
+  RegionsPackWriter(const RegionsPackWriter&) = delete;
+  RegionsPackWriter& operator=(const RegionsPackWriter&) = delete;
+
+  /// Append the regions of one view to the pack and index it.
+  void append(IndexT viewId, const Regions& regions);
+
+private:
+  std::mutex _mutex;
+  std::ofstream _dataStream;
+  std::ofstream _indexStream;
+  std::uint64_t _dataOffset = 0;
+};
+
+/**
+ * @brief Read-only view over all the packs of a set of folders, for one
+ * describer type.
+ *
+ * The pack data files stay open between reads: loading the regions of a view
+ * costs one seek and two reads instead of a directory scan and two open().
+ * When the same view is present in several packs the last loaded one wins,
+ * mirroring the "last folder wins" rule of the per-view files.
+ *
+ * loadRegions()/loadFeatures() are thread-safe.
+ */
+class RegionsPackSet
+{
+public:
+  RegionsPackSet() = default;
+
+  RegionsPackSet(const RegionsPackSet&) = delete;
+  RegionsPackSet& operator=(const RegionsPackSet&) = delete;
+
+  /**
+   * @brief Scan the given folders for "*.<describerTypeName>.pack" files and
+   * load their indexes.
+   * @return The number of pack files found.
+   */
+  std::size_t open(const std::vector<std::string>& folders, const std::string& describerTypeName);
+
+  /// Load the index of a single pack file. Throw if the index is invalid.
+  void addPack(const std::string& packPath);
+
+  bool empty() const { return _entries.empty(); }
+
+  /// Number of indexed views.
+  std::size_t viewCount() const { return _entries.size(); }
+
+  bool hasView(IndexT viewId) const { return _entries.count(viewId) != 0; }
+
+  /// All the indexed view ids, e.g. to resume an interrupted extraction.
+  std::vector<IndexT> getViewIds() const;
+
+  /**
+   * @brief Load the regions (features & descriptors) of one view.
+   * @return false if the view is not indexed in any pack.
+   */
+  bool loadRegions(IndexT viewId, Regions& regions) const;
+
+  /**
+   * @brief Load only the features of one view.
+   * @return false if the view is not indexed in any pack.
+   */
+  bool loadFeatures(IndexT viewId, Regions& regions) const;
+
+private:
+  struct Pack
+  {
+    std::string path;
+    mutable std::ifstream dataStream;
+    mutable std::mutex mutex;
+  };
+
+  struct Entry
+  {
+    std::size_t packIndex;
+    std::uint64_t featOffset;
+    std::uint64_t featSize;
+    std::uint64_t descOffset;
+    std::uint64_t descSize;
+  };
+
+  /// Read [offset, offset + size) from the given pack into buffer.
+  void readSlice(const Pack& pack, std::uint64_t offset, std::uint64_t size, std::string& buffer) const;
+
+  std::vector<std::unique_ptr<Pack>> _packs;
+  std::map<IndexT, Entry> _entries;
+};
+
+} // namespace feature
+} // namespace aliceVision
@@ -10,7 +10,13 @@
 #include <aliceVision/feature/ImageDescriber.hpp>
 #include <aliceVision/feature/imageDescriberCommon.hpp>
 
+#include <condition_variable>
+#include <functional>
+#include <list>
 #include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
 
 namespace aliceVision {
 namespace feature {
@@ -51,12 +57,51 @@ inline std::vector<feature::EImageDescriberType> getCommonDescTypes(const MapFea
   return descTypes;
 }
 
+/// Shared handle on the regions of one view, as returned by the RegionsPerView
+/// accessors: in lazy-loading mode it keeps the view alive across concurrent
+/// evictions for as long as the caller holds it
+using RegionsPerDescHandle = std::shared_ptr<const MapRegionsPerDesc>;
+
+/// Shared handle on the regions of one describer type of one view; it shares
+/// ownership with the RegionsPerDescHandle of the view
+using RegionsHandle = std::shared_ptr<const feature::Regions>;
+
 /**
  * @brief Container for all Regions (Features and Descriptors) for each View.
  */
 class RegionsPerView
 {
 public:
+  /// Loader filling the regions of one view, used by the lazy-loading mode
+  using RegionsLoader = std::function<void(IndexT, MapRegionsPerDesc&)>;
+
+  /**
+   * @brief Enable the lazy-loading mode: regions are faulted in through the
+   * given loader on first access and the least-recently-used views are
+   * evicted to keep the loaded regions under the given byte budget.
+   *
+   * The lazy mode can be used concurrently: an access to a resident view only
+   * takes the internal lock for the map lookup, the loader runs outside the
+   * lock and two threads faulting the same view share a single load. The
+   * accessors return shared handles: an evicted view is only destroyed once
+   * no caller holds a handle on it anymore, so a handle stays valid for as
+   * long as it is kept in scope. Without lazy mode the container is immutable
+   * once filled and the accessors are lock-free.
+   *
+   * @param[in] loader Function loading the regions of one view
+   * @param[in] maxMemoryBytes Byte budget for the loaded regions
+   */
+  void setLazyLoader(RegionsLoader loader, std::size_t maxMemoryBytes)
+  {
+    _lazyLoader = loader;
+    _maxMemoryBytes = maxMemoryBytes;
+  }
+
+  bool isLazy() const
+  {
+    return static_cast<bool>(_lazyLoader);
+  }
+
   MapRegionsPerView& getData()
   {
     return _data;
@@ -74,51 +119,82 @@ public:
     return *(_data.begin()->second.at(descType).get());
   }
 
-  const feature::MapRegionsPerDesc& getRegionsPerDesc(IndexT viewId) const
+  RegionsPerDescHandle getRegionsPerDesc(IndexT viewId) const
   {
-    return _data.at(viewId);
+    return fetch(viewId);
   }
-  const feature::MapRegionsPerDesc& getDataPerDesc(IndexT viewId) const
+  RegionsPerDescHandle getDataPerDesc(IndexT viewId) const
   {
-    return _data.at(viewId);
+    return fetch(viewId);
   }
 
-  const feature::Regions& getRegions(IndexT viewId, feature::EImageDescriberType descType) const
+  RegionsHandle getRegions(IndexT viewId, feature::EImageDescriberType descType) const
   {
     assert(descType != feature::EImageDescriberType::UNINITIALIZED);
-    return *(_data.at(viewId).at(descType).get());
+    const RegionsPerDescHandle perDesc = fetch(viewId);
+    // share the ownership of the whole view with the returned handle
+    return RegionsHandle(perDesc, perDesc->at(descType).get());
   }
-  
-  const MapRegionsPerDesc& getAllRegions(IndexT viewId) const
+
+  RegionsPerDescHandle getAllRegions(IndexT viewId) const
   {
-    return _data.at(viewId);
+    return fetch(viewId);
   }
   
   bool viewExist(IndexT viewId) const
   {
+    if(isLazy())
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return _lazyData.count(viewId) > 0;
+    }
     return _data.count(viewId) > 0;
   }
-  
+
   bool isEmpty() const
   {
+    if(isLazy())
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return _lazyData.empty();
+    }
     return _data.empty();
   }
   
   void addRegions(IndexT viewId, feature::EImageDescriberType descType, feature::Regions* regionsPtr)
   {
     assert(descType != feature::EImageDescriberType::UNINITIALIZED);
+    if(isLazy())
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      RegionsPerDescPtr& regions = _lazyData[viewId];
+      if(!regions)
+        regions = std::make_shared<MapRegionsPerDesc>();
+      _memoryUsage += regionsPtr->getMemoryInBytes();
+      (*regions)[descType].reset(regionsPtr);
+      touchLru(viewId);
+      return;
+    }
     _data[viewId][descType].reset(regionsPtr);
   }
 
   std::vector<feature::EImageDescriberType> getCommonDescTypes(const Pair& pair) const
   {
-    const auto& regionsA = getAllRegions(pair.first);
-    const auto& regionsB = getAllRegions(pair.second);
-    return aliceVision::feature::getCommonDescTypes(regionsA, regionsB);
+    const RegionsPerDescHandle regionsA = getAllRegions(pair.first);
+    const RegionsPerDescHandle regionsB = getAllRegions(pair.second);
+    return aliceVision::feature::getCommonDescTypes(*regionsA, *regionsB);
   }
   
   void clearDescriptors()
   {
+    if(isLazy())
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      for(auto& itA: _lazyData)
+        for(auto& itB: *itA.second)
+          itB.second->clearDescriptors();
+      return;
+    }
     for(auto& itA: _data)
     {
       for(auto& itB: itA.second)
@@ -127,9 +203,118 @@ public:
       }
     }
   }
-  
+
 private:
-  MapRegionsPerView _data;
+  using RegionsPerDescPtr = std::shared_ptr<MapRegionsPerDesc>;
+
+  /// Return the regions of the given view, faulting them in and evicting
+  /// least-recently-used views when the lazy-loading mode is enabled.
+  /// The returned handle shares the ownership of the view, so it survives a
+  /// concurrent eviction for as long as the caller keeps it in scope.
+  RegionsPerDescHandle fetch(IndexT viewId) const
+  {
+    if(!isLazy())
+    {
+      // immutable container: a non-owning handle is enough
+      return RegionsPerDescHandle(RegionsPerDescHandle(), &_data.at(viewId)); // throw std::out_of_range as before
+    }
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    for(;;)
+    {
+      auto it = _lazyData.find(viewId);
+      if(it != _lazyData.end())
+      {
+        touchLru(viewId);
+        return it->second;
+      }
+      if(_loadingViews.count(viewId) == 0)
+        break;
+      // another thread is faulting this view in, share its load
+      _loadedCondition.wait(lock);
+    }
+
+    _loadingViews.insert(viewId);
+    lock.unlock();
+
+    // run the loader without the lock: accesses to resident views and faults
+    // of other views proceed while this one is read from disk
+    RegionsPerDescPtr regions = std::make_shared<MapRegionsPerDesc>();
+    try
+    {
+      _lazyLoader(viewId, *regions);
+    }
+    catch(...)
+    {
+      // the load failed (e.g. missing feature file): release the threads
+      // waiting on this view so they can fault it in themselves, and let the
+      // loader error reach the caller
+      lock.lock();
+      _loadingViews.erase(viewId);
+      _loadedCondition.notify_all();
+      throw;
+    }
+
+    lock.lock();
+    _loadingViews.erase(viewId);
+    _lazyData[viewId] = regions;
+    _memoryUsage += getViewMemoryUsage(*regions);
+    touchLru(viewId);
+    evict(viewId);
+    _loadedCondition.notify_all();
+    return regions;
+  }
+
+  static std::size_t getViewMemoryUsage(const MapRegionsPerDesc& regions)
+  {
+    std::size_t bytes = 0;
+    for(const auto& it : regions)
+      bytes += it.second->getMemoryInBytes();
+    return bytes;
+  }
+
+  /// Move the view at the front of the LRU order
+  void touchLru(IndexT viewId) const
+  {
+    auto lruIt = _lruIndex.find(viewId);
+    if(lruIt != _lruIndex.end())
+      _lruOrder.erase(lruIt->second);
+    _lruOrder.push_front(viewId);
+    _lruIndex[viewId] = _lruOrder.begin();
+  }
+
+  /// Evict least-recently-used views until the memory budget is respected.
+  /// Eviction only drops the owning pointer: handles still held by readers
+  /// keep the view alive until they go out of scope.
+  void evict(IndexT keepViewId) const
+  {
+    while(_memoryUsage > _maxMemoryBytes && _lruOrder.size() > 1)
+    {
+      const IndexT evictViewId = _lruOrder.back();
+      if(evictViewId == keepViewId)
+        break;
+      _memoryUsage -= getViewMemoryUsage(*_lazyData.at(evictViewId));
+      _lazyData.erase(evictViewId);
+      _lruIndex.erase(evictViewId);
+      _lruOrder.pop_back();
+    }
+  }
+
+  mutable MapRegionsPerView _data;
+
+  // lazy-loading mode
+  RegionsLoader _lazyLoader;
+  std::size_t _maxMemoryBytes = 0;
+  /// loaded views of the lazy mode; the values are shared with the handles
+  /// returned to the readers so an evicted view is never destroyed under one
+  mutable std::map<IndexT, RegionsPerDescPtr> _lazyData;
+  mutable std::size_t _memoryUsage = 0;
+  mutable std::list<IndexT> _lruOrder; // most recently used at front
+  mutable std::map<IndexT, std::list<IndexT>::iterator> _lruIndex;
+  /// views currently faulted in by a thread, other threads wait on the condition
+  mutable std::set<IndexT> _loadingViews;
+  mutable std::mutex _mutex;
+  mutable std::condition_variable _loadedCondition;
 };
 
 } // namespace feature
@@ -0,0 +1,231 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "SharedRegionsStore.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/stream.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define ALICEVISION_HAVE_SHM_REGIONS
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace aliceVision {
+namespace feature {
+
+namespace {
+
+/// Segment layout: this header, then the .feat payload, then the .desc
+/// payload (both byte-identical to the file contents).
+struct SegmentHeader
+{
+  std::uint64_t magic;
+  std::uint64_t ready; ///< written last, after the payloads
+  std::uint64_t featSize;
+  std::uint64_t descSize;
+};
+
+/// Arbitrary tag rejecting segments that are not regions segments.
+const std::uint64_t segmentMagic = 0x316765526D687341ULL;
+
+#ifdef ALICEVISION_HAVE_SHM_REGIONS
+
+/// Read-only mapping of a segment, unmapped on destruction.
+struct SegmentView
+{
+  ~SegmentView()
+  {
+    if(data != nullptr)
+      ::munmap(data, size);
+  }
+
+  const SegmentHeader* header() const { return static_cast<const SegmentHeader*>(data); }
+  const char* payload() const { return static_cast<const char*>(data) + sizeof(SegmentHeader); }
+
+  void* data = nullptr;
+  std::size_t size = 0;
+};
+
+/// Attach the given segment read-only.
+/// @return false if the segment is missing, not ready or inconsistent.
+bool attachSegment(const std::string& name, SegmentView& out)
+{
+  const int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+  if(fd < 0)
+    return false;
+
+  struct stat segmentStat;
+  if(::fstat(fd, &segmentStat) != 0 || static_cast<std::size_t>(segmentStat.st_size) < sizeof(SegmentHeader))
+  {
+    ::close(fd);
+    return false;
+  }
+
+  out.size = static_cast<std::size_t>(segmentStat.st_size);
+  out.data = ::mmap(nullptr, out.size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+
+  if(out.data == MAP_FAILED)
+  {
+    out.data = nullptr;
+    out.size = 0;
+    return false;
+  }
+
+  const SegmentHeader* header = out.header();
+  return header->magic == segmentMagic &&
+         header->ready == 1 &&
+         sizeof(SegmentHeader) + header->featSize + header->descSize <= out.size;
+}
+
+#endif // ALICEVISION_HAVE_SHM_REGIONS
+
+} // namespace
+
+SharedRegionsStore::SharedRegionsStore(const std::string& storeName)
+  : _storeName(storeName)
+{}
+
+bool SharedRegionsStore::isSupported()
+{
+#ifdef ALICEVISION_HAVE_SHM_REGIONS
+  return true;
+#else
+  return false;
+#endif
+}
+
+std::string SharedRegionsStore::segmentName(IndexT viewId, const std::string& describerTypeName) const
+{
+  return "/aliceVision." + _storeName + "." + std::to_string(viewId) + "." + describerTypeName;
+}
+
+void SharedRegionsStore::publish(IndexT viewId, const std::string& describerTypeName, const Regions& regions) const
+{
+#ifdef ALICEVISION_HAVE_SHM_REGIONS
+  std::ostringstream featStream;
+  std::ostringstream descStream;
+  regions.SaveToStreams(featStream, descStream);
+
+  const std::string featData = featStream.str();
+  const std::string descData = descStream.str();
+
+  const std::string name = segmentName(viewId, describerTypeName);
+  const std::size_t totalSize = sizeof(SegmentHeader) + featData.size() + descData.size();
+
+  const int fd = ::shm_open(name.c_str(), O_CREAT | O_RDWR, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+  if(fd < 0)
+  {
+    ALICEVISION_LOG_WARNING("Can't publish shared memory regions segment '" << name << "', view stays file-only.");
+    return;
+  }
+
+  if(::ftruncate(fd, totalSize) != 0)
+  {
+    ::close(fd);
+    ::shm_unlink(name.c_str());
+    ALICEVISION_LOG_WARNING("Can't size shared memory regions segment '" << name << "', view stays file-only.");
+    return;
+  }
+
+  void* data = ::mmap(nullptr, totalSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+
+  if(data == MAP_FAILED)
+  {
+    ::shm_unlink(name.c_str());
+    ALICEVISION_LOG_WARNING("Can't map shared memory regions segment '" << name << "', view stays file-only.");
+    return;
+  }
+
+  SegmentHeader* header = static_cast<SegmentHeader*>(data);
+  header->magic = segmentMagic;
+  header->ready = 0;
+  header->featSize = featData.size();
+  header->descSize = descData.size();
+
+  char* payload = static_cast<char*>(data) + sizeof(SegmentHeader);
+  std::memcpy(payload, featData.data(), featData.size());
+  std::memcpy(payload + featData.size(), descData.data(), descData.size());
+
+  // publish the payloads before the readiness flag
+  std::atomic_thread_fence(std::memory_order_release);
+  header->ready = 1;
+
+  ::munmap(data, totalSize);
+#else
+  (void)viewId;
+  (void)describerTypeName;
+  (void)regions;
+#endif
+}
+
+bool SharedRegionsStore::hasView(IndexT viewId, const std::string& describerTypeName) const
+{
+#ifdef ALICEVISION_HAVE_SHM_REGIONS
+  SegmentView segment;
+  return attachSegment(segmentName(viewId, describerTypeName), segment);
+#else
+  (void)viewId;
+  (void)describerTypeName;
+  return false;
+#endif
+}
+
+bool SharedRegionsStore::loadRegions(IndexT viewId, const std::string& describerTypeName, Regions& regions,
+                                     bool useMappedDescriptors) const
+{
+#ifdef ALICEVISION_HAVE_SHM_REGIONS
+  const std::string name = segmentName(viewId, describerTypeName);
+
+  SegmentView segment;
+  if(!attachSegment(name, segment))
+    return false;
+
+  const SegmentHeader* header = segment.header();
+  const char* payload = segment.payload();
+
+  // in-place istreams over the mapped payloads, nothing is copied here
+  boost::iostreams::stream<boost::iostreams::array_source> featStream(payload, header->featSize);
+  boost::iostreams::stream<boost::iostreams::array_source> descStream(payload + header->featSize, header->descSize);
+
+  if(useMappedDescriptors)
+    regions.LoadFromSharedMemory(featStream, descStream, name, sizeof(SegmentHeader) + header->featSize);
+  else
+    regions.LoadFromStreams(featStream, descStream);
+
+  return true;
+#else
+  (void)viewId;
+  (void)describerTypeName;
+  (void)regions;
+  (void)useMappedDescriptors;
+  return false;
+#endif
+}
+
+void SharedRegionsStore::removeView(IndexT viewId, const std::string& describerTypeName) const
+{
+#ifdef ALICEVISION_HAVE_SHM_REGIONS
+  ::shm_unlink(segmentName(viewId, describerTypeName).c_str());
+#else
+  (void)viewId;
+  (void)describerTypeName;
+#endif
+}
+
+} // namespace feature
+} // namespace aliceVision
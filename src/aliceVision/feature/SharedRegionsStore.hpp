@@ -0,0 +1,81 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+#include <aliceVision/feature/Regions.hpp>
+
+#include <string>
+
+namespace aliceVision {
+namespace feature {
+
+/**
+ * Shared-memory regions exchange between co-scheduled processes: when the
+ * feature extraction and the matcher run on the same node, the extraction can
+ * publish the regions of each finished view into a POSIX shared memory
+ * segment and the matcher attaches them without going through the filesystem.
+ *
+ * One segment per (view, describer type) holds a small header followed by the
+ * .feat and .desc payloads, byte-identical to the file contents. The header
+ * carries a readiness flag written after the payloads, so a reader never sees
+ * a half-written view: a missing or unready segment is reported as absent and
+ * the caller transparently falls back to the regular files (see
+ * sfm::loadRegions). The segments outlive the publishing process, so the two
+ * stages do not need to overlap in time; use removeView() to reclaim the
+ * memory once a view has been consumed.
+ *
+ * Shared memory segments are only available on POSIX systems: elsewhere
+ * publish() is ignored and hasView() is always false, so the callers simply
+ * use the file path.
+ */
+class SharedRegionsStore
+{
+public:
+  /**
+   * @param[in] storeName Identifier shared by the publisher and the readers,
+   * it namespaces the segments of one pipeline run (so concurrent runs on the
+   * same node do not read each other's regions).
+   */
+  explicit SharedRegionsStore(const std::string& storeName);
+
+  /// True if the platform supports shared memory segments.
+  static bool isSupported();
+
+  /**
+   * @brief Publish the regions of one view.
+   * Never throws: on failure (e.g. no shared memory left) a warning is logged
+   * and the view is simply not published, readers use the files instead.
+   */
+  void publish(IndexT viewId, const std::string& describerTypeName, const Regions& regions) const;
+
+  /// True if the view has been published and its payloads are complete.
+  bool hasView(IndexT viewId, const std::string& describerTypeName) const;
+
+  /**
+   * @brief Load the regions of one view from its segment.
+   * @param[in] useMappedDescriptors If true, the descriptors are mapped
+   * in-place from the segment instead of being copied in memory (read-only
+   * regions, same restrictions as Regions::LoadMapped).
+   * @return false if the view is not published or its segment is not ready,
+   * so the caller can fall back to the regular files.
+   */
+  bool loadRegions(IndexT viewId, const std::string& describerTypeName, Regions& regions,
+                   bool useMappedDescriptors = false) const;
+
+  /// Remove the segment of one view, if any (e.g. once it has been consumed).
+  void removeView(IndexT viewId, const std::string& describerTypeName) const;
+
+private:
+  /// Shared memory segment name of the given view, e.g.
+  /// "/aliceVision.<storeName>.<viewId>.<describerTypeName>".
+  std::string segmentName(IndexT viewId, const std::string& describerTypeName) const;
+
+  std::string _storeName;
+};
+
+} // namespace feature
+} // namespace aliceVision
@@ -4,10 +4,12 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "aliceVision/feature/feature.hpp"
+#include "aliceVision/feature/selection.hpp"
 
 #include <iostream>
 #include <fstream>
 #include <iterator>
+#include <set>
 #include <vector>
 
 #define BOOST_TEST_MODULE Feature
@@ -120,3 +122,64 @@ BOOST_AUTO_TEST_CASE(descriptorIO_BINARY) {
       BOOST_CHECK_EQUAL(vec_descs[i][j], vec_descs_read[i][j]);
   }
 }
+
+//Test the grid distributed selection of the strongest features
+BOOST_AUTO_TEST_CASE(features_GRID_DISTRIBUTED_SELECTION) {
+  // 10 features per cell of a 3x3 grid over a 90x90 extent, with a scale
+  // increasing with the in-cell rank
+  Feats_T vec_feats;
+  for(int cellY = 0; cellY < 3; ++cellY) {
+    for(int cellX = 0; cellX < 3; ++cellX) {
+      for(int k = 0; k < 10; ++k) {
+        vec_feats.push_back(Feature_T(cellX * 30 + 2 * k + 1, cellY * 30 + 2 * k + 1,
+                                      1.0f + k, 0.0f));
+      }
+    }
+  }
+
+  // one feature per cell: the strongest (last pushed) of each cell
+  std::vector<IndexT> indices;
+  selectGridDistributedFeatures(vec_feats, 9, indices);
+  BOOST_CHECK_EQUAL(indices.size(), 9);
+  for(const IndexT index: indices) {
+    BOOST_CHECK_EQUAL(vec_feats[index].scale(), 10.0f);
+  }
+  // every cell contributed one feature
+  const std::set<IndexT> uniqueIndices(indices.begin(), indices.end());
+  BOOST_CHECK_EQUAL(uniqueIndices.size(), 9);
+
+  // asking for more features than available returns all of them
+  selectGridDistributedFeatures(vec_feats, 1000, indices);
+  BOOST_CHECK_EQUAL(indices.size(), vec_feats.size());
+}
+
+//Test the descriptor quantization of float regions to unsigned char
+BOOST_AUTO_TEST_CASE(regions_QUANTIZATION) {
+  SIFT_Float_Regions floatRegions;
+  for(int i = 0; i < CARD; ++i)
+  {
+    floatRegions.Features().emplace_back(float(i), float(i * 2), 1.0f, 0.0f);
+
+    SIFT_Float_Regions::DescriptorT desc;
+    for(int j = 0; j < DESC_LENGTH; ++j)
+      desc[j] = float(i * DESC_LENGTH + j) - 10.0f; // covers < 0, [0;255] and > 255
+    floatRegions.Descriptors().push_back(desc);
+  }
+
+  std::unique_ptr<Regions> quantized = quantizeRegionsToUChar(floatRegions);
+  const SIFT_Regions* ucharRegions = dynamic_cast<const SIFT_Regions*>(quantized.get());
+  BOOST_REQUIRE(ucharRegions != nullptr);
+  BOOST_CHECK_EQUAL(ucharRegions->RegionCount(), CARD);
+
+  for(int i = 0; i < CARD; ++i)
+  {
+    BOOST_CHECK_EQUAL(ucharRegions->Features()[i].x(), floatRegions.Features()[i].x());
+    for(int j = 0; j < DESC_LENGTH; ++j)
+    {
+      const float value = floatRegions.Descriptors()[i][j];
+      const unsigned char expected =
+          static_cast<unsigned char>(std::min(255.0f, std::max(0.0f, value)));
+      BOOST_CHECK_EQUAL(ucharRegions->Descriptors()[i][j], expected);
+    }
+  }
+}
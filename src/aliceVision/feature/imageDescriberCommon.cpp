@@ -20,6 +20,7 @@ std::string EImageDescriberType_informations()
   return  "Describer types used to describe an image:\n"
           "* SIFT: Scale-invariant feature transform\n"
           "* SIFT_FLOAT: SIFT stored as float\n"
+          "* SIFT_UPRIGHT: SIFT without orientation estimation (faster, for upright imagery like aerial nadir shots)\n"
           "* AKAZE: A-KAZE with floating point descriptors\n"
           "* AKAZE_LIOP: A-KAZE with Local Intensity Order Pattern descriptors\n"
           "* AKAZE_MLDB: A-KAZE with Modified-Local Difference Binary descriptors\n"
@@ -42,6 +43,7 @@ std::string EImageDescriberType_enumToString(EImageDescriberType imageDescriberT
   {
     case EImageDescriberType::SIFT:          return "SIFT";
     case EImageDescriberType::SIFT_FLOAT:    return "SIFT_FLOAT";
+    case EImageDescriberType::SIFT_UPRIGHT:  return "SIFT_UPRIGHT";
     case EImageDescriberType::AKAZE:         return "AKAZE";
     case EImageDescriberType::AKAZE_LIOP:    return "AKAZE_LIOP";
     case EImageDescriberType::AKAZE_MLDB:    return "AKAZE_MLDB";
@@ -68,6 +70,7 @@ EImageDescriberType EImageDescriberType_stringToEnum(const std::string& imageDes
 {
   if(imageDescriberType == "SIFT")        return EImageDescriberType::SIFT;
   if(imageDescriberType == "SIFT_FLOAT")  return EImageDescriberType::SIFT_FLOAT;
+  if(imageDescriberType == "SIFT_UPRIGHT")return EImageDescriberType::SIFT_UPRIGHT;
   if(imageDescriberType == "AKAZE")       return EImageDescriberType::AKAZE;
   if(imageDescriberType == "AKAZE_LIOP")  return EImageDescriberType::AKAZE_LIOP;
   if(imageDescriberType == "AKAZE_MLDB")  return EImageDescriberType::AKAZE_MLDB;
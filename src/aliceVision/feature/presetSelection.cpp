@@ -0,0 +1,78 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "presetSelection.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace aliceVision {
+namespace feature {
+
+SaliencyProbe computeSaliencyProbe(const image::Image<float>& imageGrayFloat)
+{
+  SaliencyProbe probe;
+
+  const int width = imageGrayFloat.Width();
+  const int height = imageGrayFloat.Height();
+  if(width < 3 || height < 3)
+    return probe;
+
+  // sample on a coarse grid of about 256 pixels on the largest dimension
+  const int maxProbeSize = 256;
+  const int step = std::max(1, std::max(width, height) / maxProbeSize);
+
+  // gradient above this value counts as texture; the images are in [0;1] and
+  // the threshold matches the default peak threshold of the SIFT presets
+  const double textureThreshold = 0.04;
+
+  double gradientSum = 0.0;
+  std::size_t nbTextured = 0;
+  std::size_t nbSamples = 0;
+
+  for(int y = step; y < height - step; y += step)
+  {
+    for(int x = step; x < width - step; x += step)
+    {
+      // central finite differences at the probe scale
+      const double dx = (imageGrayFloat(y, x + step) - imageGrayFloat(y, x - step)) * 0.5;
+      const double dy = (imageGrayFloat(y + step, x) - imageGrayFloat(y - step, x)) * 0.5;
+      const double gradient = std::sqrt(dx * dx + dy * dy);
+
+      gradientSum += gradient;
+      if(gradient > textureThreshold)
+        ++nbTextured;
+      ++nbSamples;
+    }
+  }
+
+  if(nbSamples == 0)
+    return probe;
+
+  probe.meanGradient = gradientSum / nbSamples;
+  probe.textureCoverage = double(nbTextured) / double(nbSamples);
+  return probe;
+}
+
+EImageDescriberPreset selectDescriberPreset(const SaliencyProbe& probe, EImageDescriberPreset maxPreset)
+{
+  // coverage below which an image is considered texture-poor / intermediate;
+  // above the higher bound the requested preset is kept unchanged
+  const double poorTextureCoverage = 0.02;
+  const double mediumTextureCoverage = 0.10;
+
+  int nbDowngrades = 0;
+  if(probe.textureCoverage < poorTextureCoverage)
+    nbDowngrades = 2;
+  else if(probe.textureCoverage < mediumTextureCoverage)
+    nbDowngrades = 1;
+
+  const int selected = std::max(int(EImageDescriberPreset::LOW), int(maxPreset) - nbDowngrades);
+  return EImageDescriberPreset(selected);
+}
+
+} // namespace feature
+} // namespace aliceVision
@@ -0,0 +1,52 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/feature/ImageDescriber.hpp>
+#include <aliceVision/image/Image.hpp>
+
+namespace aliceVision {
+namespace feature {
+
+/**
+ * @brief Texture statistics of an image, measured on a downscaled probe.
+ */
+struct SaliencyProbe
+{
+  /// mean gradient magnitude over the probe pixels
+  double meanGradient = 0.0;
+  /// fraction of the probe pixels with a gradient above the texture threshold
+  double textureCoverage = 0.0;
+};
+
+/**
+ * @brief Measure the texture content of an image on a cheap downscaled probe.
+ *
+ * The image is sampled on a coarse grid (about 256 pixels on the largest
+ * dimension) and the gradient statistics are computed on the samples only,
+ * so the probe cost is negligible compared to the feature extraction itself.
+ *
+ * @param[in] imageGrayFloat Greyscale image with values in [0;1]
+ * @return the gradient statistics of the probe
+ */
+SaliencyProbe computeSaliencyProbe(const image::Image<float>& imageGrayFloat);
+
+/**
+ * @brief Select the describer preset of one image from its texture statistics.
+ *
+ * Texture-poor images hold few detectable features whatever the preset, so
+ * spending a demanding preset on them wastes time for no features: the probe
+ * downgrades the preset (and with it the keypoint budget of the describer)
+ * on such images. Texture-rich images keep the requested preset.
+ *
+ * @param[in] probe The texture statistics of the image
+ * @param[in] maxPreset The preset requested by the user, used as the ceiling
+ * @return the preset to use for this image, between LOW and \p maxPreset
+ */
+EImageDescriberPreset selectDescriberPreset(const SaliencyProbe& probe, EImageDescriberPreset maxPreset);
+
+} // namespace feature
+} // namespace aliceVision
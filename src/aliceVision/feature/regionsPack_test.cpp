@@ -0,0 +1,128 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "aliceVision/feature/RegionsPack.hpp"
+#include "aliceVision/feature/regionsFactory.hpp"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#define BOOST_TEST_MODULE RegionsPack
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::feature;
+
+// Build dummy SIFT regions whose values depend on the view id,
+// so that every view round-trips to distinguishable data.
+static SIFT_Regions makeRegions(IndexT viewId, std::size_t count)
+{
+  SIFT_Regions regions;
+  for(std::size_t i = 0; i < count; ++i)
+  {
+    regions.Features().emplace_back(float(viewId + i), float(i), 1.0f, 0.5f);
+
+    SIFT_Regions::DescriptorT desc;
+    for(std::size_t j = 0; j < desc.size(); ++j)
+      desc[j] = static_cast<unsigned char>((viewId + i + j) % 256);
+    regions.Descriptors().push_back(desc);
+  }
+  return regions;
+}
+
+static void checkRegions(const SIFT_Regions& loaded, const SIFT_Regions& expected)
+{
+  BOOST_CHECK_EQUAL(loaded.RegionCount(), expected.RegionCount());
+  for(std::size_t i = 0; i < expected.RegionCount(); ++i)
+  {
+    BOOST_CHECK_EQUAL(loaded.Features()[i].x(), expected.Features()[i].x());
+    BOOST_CHECK_EQUAL(loaded.Features()[i].y(), expected.Features()[i].y());
+    BOOST_CHECK(loaded.Descriptors()[i] == expected.Descriptors()[i]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(regionsPack_WriteAndReload)
+{
+  const std::string packPath = getRegionsPackFilename("testPack", "SIFT");
+  std::remove(packPath.c_str());
+  std::remove((packPath + ".idx").c_str());
+
+  // First writing session: two views.
+  {
+    RegionsPackWriter writer(packPath);
+    writer.append(10, makeRegions(10, 3));
+    writer.append(20, makeRegions(20, 5));
+  }
+
+  // Second session appends to the same pack, like a resumed job.
+  {
+    RegionsPackWriter writer(packPath);
+    writer.append(30, makeRegions(30, 0)); // a view without any feature
+    writer.append(40, makeRegions(40, 2));
+  }
+
+  RegionsPackSet packs;
+  BOOST_CHECK_EQUAL(packs.open({"."}, "SIFT"), 1);
+  BOOST_CHECK_EQUAL(packs.viewCount(), 4);
+  BOOST_CHECK(packs.hasView(10));
+  BOOST_CHECK(packs.hasView(30));
+  BOOST_CHECK(!packs.hasView(50));
+
+  for(const IndexT viewId : {IndexT(10), IndexT(20), IndexT(30), IndexT(40)})
+  {
+    const std::size_t count = (viewId == 30) ? 0 : ((viewId == 10) ? 3 : ((viewId == 20) ? 5 : 2));
+
+    SIFT_Regions loaded;
+    BOOST_CHECK(packs.loadRegions(viewId, loaded));
+    checkRegions(loaded, makeRegions(viewId, count));
+
+    SIFT_Regions features;
+    BOOST_CHECK(packs.loadFeatures(viewId, features));
+    BOOST_CHECK_EQUAL(features.RegionCount(), count);
+  }
+
+  SIFT_Regions notFound;
+  BOOST_CHECK(!packs.loadRegions(50, notFound));
+
+  std::remove(packPath.c_str());
+  std::remove((packPath + ".idx").c_str());
+}
+
+BOOST_AUTO_TEST_CASE(regionsPack_LastPackWins)
+{
+  const std::string packPathA = getRegionsPackFilename("testPackA", "SIFT");
+  const std::string packPathB = getRegionsPackFilename("testPackB", "SIFT");
+  for(const std::string& path : {packPathA, packPathB})
+  {
+    std::remove(path.c_str());
+    std::remove((path + ".idx").c_str());
+  }
+
+  {
+    RegionsPackWriter writerA(packPathA);
+    writerA.append(10, makeRegions(10, 3));
+  }
+  {
+    // re-extraction of view 10 in a later pack
+    RegionsPackWriter writerB(packPathB);
+    writerB.append(10, makeRegions(99, 4));
+  }
+
+  RegionsPackSet packs;
+  packs.addPack(packPathA);
+  packs.addPack(packPathB);
+  BOOST_CHECK_EQUAL(packs.viewCount(), 1);
+
+  SIFT_Regions loaded;
+  BOOST_CHECK(packs.loadRegions(10, loaded));
+  checkRegions(loaded, makeRegions(99, 4));
+
+  for(const std::string& path : {packPathA, packPathB})
+  {
+    std::remove(path.c_str());
+    std::remove((path + ".idx").c_str());
+  }
+}
@@ -0,0 +1,169 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "aliceVision/feature/RegionsPerView.hpp"
+#include "aliceVision/feature/regionsFactory.hpp"
+
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#define BOOST_TEST_MODULE RegionsPerView
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::feature;
+
+// Number of regions of a view, so that every view is distinguishable
+static std::size_t regionCount(IndexT viewId)
+{
+  return 3 + (viewId % 5);
+}
+
+static SIFT_Regions* makeRegions(IndexT viewId)
+{
+  SIFT_Regions* regions = new SIFT_Regions();
+  for(std::size_t i = 0; i < regionCount(viewId); ++i)
+  {
+    regions->Features().emplace_back(float(viewId + i), float(i), 1.0f, 0.5f);
+    regions->Descriptors().emplace_back();
+  }
+  return regions;
+}
+
+// Check that the regions of a view hold the data built by makeRegions
+static bool checkView(const Regions& regions, IndexT viewId)
+{
+  const SIFT_Regions& siftRegions = dynamic_cast<const SIFT_Regions&>(regions);
+  if(siftRegions.RegionCount() != regionCount(viewId))
+    return false;
+  for(std::size_t i = 0; i < siftRegions.RegionCount(); ++i)
+  {
+    if(siftRegions.Features()[i].x() != float(viewId + i))
+      return false;
+  }
+  return true;
+}
+
+BOOST_AUTO_TEST_CASE(RegionsPerView_LazyEviction)
+{
+  std::atomic<int> nbLoads(0);
+
+  RegionsPerView regionsPerView;
+  // budget of about 4 views
+  const std::size_t viewBytes = std::unique_ptr<SIFT_Regions>(makeRegions(0))->getMemoryInBytes();
+  regionsPerView.setLazyLoader(
+    [&nbLoads](IndexT viewId, MapRegionsPerDesc& outRegions)
+    {
+      ++nbLoads;
+      outRegions[EImageDescriberType::SIFT].reset(makeRegions(viewId));
+    },
+    4 * viewBytes);
+
+  // first accesses fault the views in
+  for(IndexT viewId = 0; viewId < 12; ++viewId)
+    BOOST_CHECK(checkView(*regionsPerView.getRegions(viewId, EImageDescriberType::SIFT), viewId));
+  BOOST_CHECK_EQUAL(nbLoads, 12);
+
+  // the working set exceeds the budget: early views have been evicted and are reloaded
+  BOOST_CHECK(!regionsPerView.viewExist(0));
+  BOOST_CHECK(checkView(*regionsPerView.getRegions(0, EImageDescriberType::SIFT), 0));
+  BOOST_CHECK_EQUAL(nbLoads, 13);
+
+  // a handle stays valid for as long as the caller holds it, even once the
+  // view itself has been evicted from the container
+  const RegionsHandle heldRegions = regionsPerView.getRegions(100, EImageDescriberType::SIFT);
+  for(IndexT viewId = 200; viewId < 210; ++viewId)
+    regionsPerView.getRegions(viewId, EImageDescriberType::SIFT);
+  BOOST_CHECK(!regionsPerView.viewExist(100));
+  BOOST_CHECK(checkView(*heldRegions, 100));
+}
+
+BOOST_AUTO_TEST_CASE(RegionsPerView_LazyConcurrentAccess)
+{
+  std::atomic<int> nbLoads(0);
+
+  RegionsPerView regionsPerView;
+  const std::size_t viewBytes = std::unique_ptr<SIFT_Regions>(makeRegions(0))->getMemoryInBytes();
+  regionsPerView.setLazyLoader(
+    [&nbLoads](IndexT viewId, MapRegionsPerDesc& outRegions)
+    {
+      ++nbLoads;
+      outRegions[EImageDescriberType::SIFT].reset(makeRegions(viewId));
+    },
+    4 * viewBytes);
+
+  // hammer a working set larger than the budget from several threads;
+  // every fetched view must hold its own data, whatever the evictions
+  const std::size_t nbThreads = 4;
+  const std::size_t nbIterations = 500;
+  const IndexT nbViews = 16;
+  std::atomic<int> nbFailures(0);
+
+  std::vector<std::thread> threads;
+  for(std::size_t t = 0; t < nbThreads; ++t)
+  {
+    threads.emplace_back([t, &regionsPerView, &nbFailures]
+    {
+      for(std::size_t i = 0; i < nbIterations; ++i)
+      {
+        const IndexT viewId = (t * 7919 + i * 31) % nbViews;
+        const RegionsHandle regions = regionsPerView.getRegions(viewId, EImageDescriberType::SIFT);
+        if(!checkView(*regions, viewId))
+          ++nbFailures;
+      }
+    });
+  }
+  for(std::thread& thread : threads)
+    thread.join();
+
+  BOOST_CHECK_EQUAL(nbFailures, 0);
+  // every view has been loaded at least once, possibly several times after evictions
+  BOOST_CHECK_GE(nbLoads, int(nbViews));
+}
+
+BOOST_AUTO_TEST_CASE(RegionsPerView_LazyLoaderFailure)
+{
+  std::atomic<int> nbLoads(0);
+  bool fail = true;
+
+  RegionsPerView regionsPerView;
+  regionsPerView.setLazyLoader(
+    [&nbLoads, &fail](IndexT viewId, MapRegionsPerDesc& outRegions)
+    {
+      ++nbLoads;
+      if(fail)
+        throw std::runtime_error("corrupt feature file");
+      outRegions[EImageDescriberType::SIFT].reset(makeRegions(viewId));
+    },
+    std::numeric_limits<std::size_t>::max());
+
+  // the loader error reaches the caller
+  BOOST_CHECK_THROW(regionsPerView.getRegions(0, EImageDescriberType::SIFT), std::runtime_error);
+  BOOST_CHECK_EQUAL(nbLoads, 1);
+
+  // the failed view is not left in a loading state: fetching it again
+  // re-runs the loader instead of waiting for the aborted load
+  fail = false;
+  BOOST_CHECK(checkView(*regionsPerView.getRegions(0, EImageDescriberType::SIFT), 0));
+  BOOST_CHECK_EQUAL(nbLoads, 2);
+}
+
+BOOST_AUTO_TEST_CASE(RegionsPerView_NonLazyUnchanged)
+{
+  RegionsPerView regionsPerView;
+  regionsPerView.addRegions(10, EImageDescriberType::SIFT, makeRegions(10));
+  regionsPerView.addRegions(20, EImageDescriberType::SIFT, makeRegions(20));
+
+  BOOST_CHECK(!regionsPerView.isLazy());
+  BOOST_CHECK(regionsPerView.viewExist(10));
+  BOOST_CHECK(!regionsPerView.viewExist(30));
+  BOOST_CHECK(checkView(*regionsPerView.getRegions(10, EImageDescriberType::SIFT), 10));
+  BOOST_CHECK(checkView(*regionsPerView.getRegions(20, EImageDescriberType::SIFT), 20));
+  BOOST_CHECK_THROW(regionsPerView.getRegions(30, EImageDescriberType::SIFT), std::out_of_range);
+}
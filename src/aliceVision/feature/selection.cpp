@@ -7,6 +7,8 @@
 
 #include <aliceVision/numeric/numeric.hpp>
 
+#include <numeric>
+
 namespace aliceVision {
 namespace feature {
 
@@ -157,5 +159,72 @@ void matchesGridFiltering(const aliceVision::feature::FeatRegions<aliceVision::f
   outMatches.swap(finalMatches);
 }
 
+/**
+ * @brief Select a subset of the strongest features, distributed over the image.
+ * @param[in] features The features of the image.
+ * @param[in] count The number of features to select.
+ * @param[out] outIndices Indices of the selected features in the input vector.
+ */
+void selectGridDistributedFeatures(const std::vector<aliceVision::feature::SIOPointFeature>& features,
+        std::size_t count,
+        std::vector<IndexT>& outIndices)
+{
+  outIndices.clear();
+  if(count >= features.size())
+  {
+    outIndices.resize(features.size());
+    std::iota(outIndices.begin(), outIndices.end(), 0);
+    return;
+  }
+  outIndices.reserve(count);
+
+  // The image extent is not available here: the grid is laid over the
+  // bounding box of the feature positions, which spans the frame in practice.
+  float maxX = 1.f, maxY = 1.f;
+  for(const auto& feature: features)
+  {
+    maxX = std::max(maxX, feature.x());
+    maxY = std::max(maxY, feature.y());
+  }
+  const float cellWidth = std::ceil(maxX / (float)gridSize);
+  const float cellHeight = std::ceil(maxY / (float)gridSize);
+
+  // Split the feature indices in grid cells
+  std::vector<std::vector<IndexT>> grid(gridSize * gridSize);
+  for(std::vector<IndexT>& cell: grid)
+  {
+    cell.reserve(features.size() / grid.size());
+  }
+  for(IndexT i = 0; i < features.size(); ++i)
+  {
+    const aliceVision::feature::SIOPointFeature& point = features[i];
+    // clamp the values if we have feature/marker centers outside the image size.
+    const std::size_t cellX = clamp(std::floor(point.x() / cellWidth), 0.f, float(gridSize - 1));
+    const std::size_t cellY = clamp(std::floor(point.y() / cellHeight), 0.f, float(gridSize - 1));
+    grid[cellY * gridSize + cellX].push_back(i);
+  }
+
+  // Rank each cell by decreasing feature scale
+  for(std::vector<IndexT>& cell: grid)
+  {
+    std::sort(cell.begin(), cell.end(),
+              [&features](IndexT a, IndexT b) { return features[a].scale() > features[b].scale(); });
+  }
+
+  // Consume the cells round-robin until the requested count is reached
+  for(std::size_t cmpt = 0; outIndices.size() < count; ++cmpt)
+  {
+    for(const std::vector<IndexT>& cell: grid)
+    {
+      if(cmpt < cell.size())
+      {
+        outIndices.push_back(cell[cmpt]);
+        if(outIndices.size() == count)
+          break;
+      }
+    }
+  }
+}
+
 }
 }
@@ -55,11 +55,28 @@ void thresholdMatches(aliceVision::matching::IndMatches& outputMatches, const st
  * @param[in] sfm_data The sfm data file
  * @param[out] outMatches The remaining matches
  */
-void matchesGridFiltering(const aliceVision::feature::FeatRegions<aliceVision::feature::SIOPointFeature>& lRegions, 
-        const aliceVision::feature::FeatRegions<aliceVision::feature::SIOPointFeature>& rRegions, 
+void matchesGridFiltering(const aliceVision::feature::FeatRegions<aliceVision::feature::SIOPointFeature>& lRegions,
+        const aliceVision::feature::FeatRegions<aliceVision::feature::SIOPointFeature>& rRegions,
         const aliceVision::Pair& indexImagePair,
-        const aliceVision::sfm::SfMData sfm_data, 
+        const aliceVision::sfm::SfMData sfm_data,
         aliceVision::matching::IndMatches& outMatches);
 
+/**
+ * @brief Select a subset of the strongest features, distributed over the image.
+ *
+ * The image extent is split into the same grid as matchesGridFiltering, the
+ * features of each cell are ranked by decreasing scale and the cells are
+ * consumed round-robin, so the subset covers the frame instead of clustering
+ * on the most textured area. Used by the cascade matching mode to build the
+ * reduced feature sets matched first.
+ *
+ * @param[in] features The features of the image.
+ * @param[in] count The number of features to select.
+ * @param[out] outIndices Indices of the selected features in the input vector.
+ */
+void selectGridDistributedFeatures(const std::vector<aliceVision::feature::SIOPointFeature>& features,
+        std::size_t count,
+        std::vector<IndexT>& outIndices);
+
 }
 }
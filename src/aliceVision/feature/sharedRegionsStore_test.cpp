@@ -0,0 +1,102 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "aliceVision/feature/SharedRegionsStore.hpp"
+#include "aliceVision/feature/regionsFactory.hpp"
+
+#include <cstring>
+#include <string>
+
+#define BOOST_TEST_MODULE SharedRegionsStore
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::feature;
+
+// Build dummy SIFT regions whose values depend on the view id,
+// so that every view round-trips to distinguishable data.
+static SIFT_Regions makeRegions(IndexT viewId, std::size_t count)
+{
+  SIFT_Regions regions;
+  for(std::size_t i = 0; i < count; ++i)
+  {
+    regions.Features().emplace_back(float(viewId + i), float(i), 1.0f, 0.5f);
+
+    SIFT_Regions::DescriptorT desc;
+    for(std::size_t j = 0; j < desc.size(); ++j)
+      desc[j] = static_cast<unsigned char>((viewId + i + j) % 256);
+    regions.Descriptors().push_back(desc);
+  }
+  return regions;
+}
+
+BOOST_AUTO_TEST_CASE(sharedRegionsStore_PublishAndLoad)
+{
+  if(!SharedRegionsStore::isSupported())
+    return;
+
+  const SharedRegionsStore store("testStore");
+  const SIFT_Regions published = makeRegions(10, 4);
+
+  BOOST_CHECK(!store.hasView(10, "SIFT"));
+
+  store.publish(10, "SIFT", published);
+  BOOST_CHECK(store.hasView(10, "SIFT"));
+
+  // regular load: the descriptors are copied in memory
+  {
+    SIFT_Regions loaded;
+    BOOST_CHECK(store.loadRegions(10, "SIFT", loaded));
+    BOOST_CHECK_EQUAL(loaded.RegionCount(), published.RegionCount());
+    for(std::size_t i = 0; i < published.RegionCount(); ++i)
+    {
+      BOOST_CHECK_EQUAL(loaded.Features()[i].x(), published.Features()[i].x());
+      BOOST_CHECK_EQUAL(loaded.Features()[i].y(), published.Features()[i].y());
+      BOOST_CHECK(loaded.Descriptors()[i] == published.Descriptors()[i]);
+    }
+  }
+
+  // mapped load: the descriptors are read in-place from the segment
+  {
+    SIFT_Regions loaded;
+    BOOST_CHECK(store.loadRegions(10, "SIFT", loaded, true));
+    BOOST_CHECK_EQUAL(loaded.RegionCount(), published.RegionCount());
+    BOOST_CHECK(loaded.Descriptors().empty()); // read-only regions
+    BOOST_CHECK_EQUAL(loaded.descriptorCount(), published.RegionCount());
+    BOOST_CHECK(std::memcmp(loaded.DescriptorRawData(), published.DescriptorRawData(),
+                            published.RegionCount() * sizeof(SIFT_Regions::DescriptorT)) == 0);
+  }
+
+  store.removeView(10, "SIFT");
+  BOOST_CHECK(!store.hasView(10, "SIFT"));
+}
+
+BOOST_AUTO_TEST_CASE(sharedRegionsStore_MissingView)
+{
+  const SharedRegionsStore store("testStore");
+  SIFT_Regions loaded;
+
+  // an unpublished view is reported as absent, never as an error
+  BOOST_CHECK(!store.hasView(99, "SIFT"));
+  BOOST_CHECK(!store.loadRegions(99, "SIFT", loaded));
+  BOOST_CHECK_EQUAL(loaded.RegionCount(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(sharedRegionsStore_StoreNamespaces)
+{
+  if(!SharedRegionsStore::isSupported())
+    return;
+
+  const SharedRegionsStore store("testStoreA");
+  const SharedRegionsStore otherStore("testStoreB");
+
+  store.publish(10, "SIFT", makeRegions(10, 2));
+
+  // another store name or describer type does not see the view
+  BOOST_CHECK(!otherStore.hasView(10, "SIFT"));
+  BOOST_CHECK(!store.hasView(10, "AKAZE"));
+
+  store.removeView(10, "SIFT");
+}
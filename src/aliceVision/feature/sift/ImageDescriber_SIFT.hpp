@@ -21,6 +21,7 @@ public:
   ImageDescriber_SIFT(const SiftParams& params = SiftParams(), bool isOriented = true)
     : _params(params)
   {
+    _isOriented = isOriented && !params._upright;
     // TODO: detect if CUDA is available on the computer
     setUseCuda(false);
   }
@@ -62,6 +63,20 @@ public:
   void setUpRight(bool upRight) override
   {
     _isOriented = !upRight;
+    // recreate the implementation so that it picks up the new orientation mode
+    setUseCuda(_useCuda);
+  }
+
+  /**
+   * @brief Apply the grid filtering before the descriptor computation
+   * (detection-only first pass), see SiftParams::_preFilterGrid.
+   * @param[in] preFilterGrid
+   */
+  void setPreFilterGrid(bool preFilterGrid) override
+  {
+    _params._preFilterGrid = preFilterGrid;
+    // recreate the implementation so that it picks up the new parameters
+    setUseCuda(_useCuda);
   }
 
   /**
@@ -11,23 +11,19 @@ namespace feature {
 
 std::unique_ptr<PopSift> ImageDescriber_SIFT_popSIFT::_popSift = nullptr;
 
-bool ImageDescriber_SIFT_popSIFT::Describe(const image::Image<unsigned char>& image,
-                                      std::unique_ptr<Regions>& regions,
-                                      const image::Image<unsigned char>* mask)
-{
-  std::unique_ptr<SiftJob> job(_popSift->enqueue(image.Width(), image.Height(), &image(0,0)));
-  std::unique_ptr<popsift::Features> popFeatures(job->get());
-
-  Allocate(regions);
+namespace {
 
+/// Convert the PopSift features of one job into SIFT regions
+void convertToRegions(popsift::Features& popFeatures, std::unique_ptr<Regions>& regions)
+{
   // Build alias to cached data
   SIFT_Regions * regionsCasted = dynamic_cast<SIFT_Regions*>(regions.get());
-  regionsCasted->Features().reserve(popFeatures->getDescriptorCount());
-  regionsCasted->Descriptors().reserve(popFeatures->getDescriptorCount());
+  regionsCasted->Features().reserve(popFeatures.getDescriptorCount());
+  regionsCasted->Descriptors().reserve(popFeatures.getDescriptorCount());
 
-  ALICEVISION_LOG_TRACE("PopSIFT features count: " << popFeatures->getFeatureCount() << ", descriptors count: " << popFeatures->getDescriptorCount() << std::endl);
+  ALICEVISION_LOG_TRACE("PopSIFT features count: " << popFeatures.getFeatureCount() << ", descriptors count: " << popFeatures.getDescriptorCount() << std::endl);
 
-  for(const auto& popFeat: *popFeatures)
+  for(const auto& popFeat: popFeatures)
   {
     for(int orientationIndex = 0; orientationIndex < popFeat.num_ori; ++orientationIndex)
     {
@@ -50,6 +46,44 @@ bool ImageDescriber_SIFT_popSIFT::Describe(const image::Image<unsigned char>& im
   }
 
   ALICEVISION_LOG_TRACE("aliceVision PopSIFT feature count : " << regionsCasted->RegionCount() << std::endl);
+}
+
+} // namespace
+
+bool ImageDescriber_SIFT_popSIFT::Describe(const image::Image<unsigned char>& image,
+                                      std::unique_ptr<Regions>& regions,
+                                      const image::Image<unsigned char>* mask)
+{
+  std::unique_ptr<SiftJob> job(_popSift->enqueue(image.Width(), image.Height(), &image(0,0)));
+  std::unique_ptr<popsift::Features> popFeatures(job->get());
+
+  Allocate(regions);
+  convertToRegions(*popFeatures, regions);
+
+  return true;
+}
+
+bool ImageDescriber_SIFT_popSIFT::DescribeBatch(const std::vector<const image::Image<unsigned char>*>& images,
+                                                std::vector<std::unique_ptr<Regions>>& regionsPerImage)
+{
+  // Enqueue the whole batch before collecting any result: PopSift pipelines
+  // the jobs over its internal CUDA streams, so host-to-device uploads of the
+  // next images overlap with the kernels of the current one.
+  std::vector<std::unique_ptr<SiftJob>> jobs;
+  jobs.reserve(images.size());
+
+  for(const image::Image<unsigned char>* image: images)
+    jobs.emplace_back(_popSift->enqueue(image->Width(), image->Height(), &(*image)(0,0)));
+
+  regionsPerImage.resize(images.size());
+
+  for(std::size_t i = 0; i < jobs.size(); ++i)
+  {
+    std::unique_ptr<popsift::Features> popFeatures(jobs[i]->get());
+
+    Allocate(regionsPerImage[i]);
+    convertToRegions(*popFeatures, regionsPerImage[i]);
+  }
 
   return true;
 }
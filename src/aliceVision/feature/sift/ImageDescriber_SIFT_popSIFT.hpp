@@ -31,7 +31,7 @@ public:
   ImageDescriber_SIFT_popSIFT(const SiftParams& params = SiftParams(), bool isOriented = true)
     : ImageDescriber()
     , _params(params)
-    , _isOriented(isOriented)
+    , _isOriented(isOriented && !params._upright)
   {
     // Process SIFT computation
     cudaDeviceReset();
@@ -68,7 +68,7 @@ public:
    */
   EImageDescriberType getDescriberType() const override
   {
-    return EImageDescriberType::SIFT;
+    return _isOriented ? EImageDescriberType::SIFT : EImageDescriberType::SIFT_UPRIGHT;
   }
 
   /**
@@ -102,6 +102,17 @@ public:
                 std::unique_ptr<Regions>& regions,
                 const image::Image<unsigned char>* mask = NULL) override;
 
+  /**
+   * @brief Detect regions on a batch of 8-bit images.
+   * All the jobs are enqueued before the first result is collected, so
+   * PopSift overlaps host-to-device transfers and kernel execution across
+   * its CUDA streams.
+   * @param[in] images The batch of images
+   * @param[out] regionsPerImage The detected regions and attributes for each image
+   */
+  bool DescribeBatch(const std::vector<const image::Image<unsigned char>*>& images,
+                     std::vector<std::unique_ptr<Regions>>& regionsPerImage) override;
+
   /**
    * @brief Allocate Regions type depending of the ImageDescriber
    * @param[in,out] regions
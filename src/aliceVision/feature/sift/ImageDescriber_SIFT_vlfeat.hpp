@@ -29,7 +29,7 @@ public:
   ImageDescriber_SIFT_vlfeat(const SiftParams& params = SiftParams(), bool isOriented = true)
     : ImageDescriber()
     , _params(params)
-    , _isOriented(isOriented)
+    , _isOriented(isOriented && !params._upright)
   {
     // Configure VLFeat
     vl_constructor();
@@ -55,9 +55,11 @@ public:
    */
   EImageDescriberType getDescriberType() const override
   {
-    return EImageDescriberType::SIFT;
+    // upright descriptors are a distinct type, so that the matching knows it
+    // only compares orientation-less features with each other
+    return _isOriented ? EImageDescriberType::SIFT : EImageDescriberType::SIFT_UPRIGHT;
   }
-  
+
   /**
    * @brief Use a preset to control the number of detected regions
    * @param[in] preset The preset configuration
@@ -89,7 +91,7 @@ public:
     std::unique_ptr<Regions>& regions,
     const image::Image<unsigned char>* mask = NULL) override
   {
-    return extractSIFT<unsigned char>(image, regions, _params, _isOriented, mask);
+    return extractSIFT<unsigned char>(image, regions, _params, _isOriented, mask, &_filterPool);
   }
 
 
@@ -101,10 +103,12 @@ public:
   {
     regions.reset(new SIFT_Regions);
   }
-  
+
 private:
   SiftParams _params;
   bool _isOriented;
+  /// scale space buffers reused across Describe calls
+  SiftFilterPool _filterPool;
 };
 
 } // namespace feature
@@ -90,7 +90,7 @@ public:
     std::unique_ptr<Regions>& regions,
     const image::Image<unsigned char>* mask = NULL) override
   {
-    return extractSIFT<float>(image, regions, _params, _isOriented, mask);
+    return extractSIFT<float>(image, regions, _params, _isOriented, mask, &_filterPool);
   }
 
   /**
@@ -105,6 +105,8 @@ public:
 private:
   SiftParams _params;
   bool _isOriented;
+  /// scale space buffers reused across Describe calls
+  SiftFilterPool _filterPool;
 };
 
 } // namespace feature
@@ -14,9 +14,12 @@ extern "C" {
 #include "nonFree/sift/vl/sift.h"
 }
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <numeric>
 #include <stdexcept>
+#include <vector>
 
 namespace aliceVision {
 namespace feature {
@@ -39,7 +42,9 @@ struct SiftParams
     std::size_t gridSize = 4,
     std::size_t maxTotalKeypoints = 1000,
     //
-    bool root_sift = true
+    bool root_sift = true,
+    bool upright = false,
+    bool preFilterGrid = false
   ):
     _first_octave(first_octave),
     _num_octaves(num_octaves),
@@ -50,7 +55,9 @@ struct SiftParams
     _gridSize(gridSize),
     _maxTotalKeypoints(maxTotalKeypoints),
     //
-    _root_sift(root_sift) {}
+    _root_sift(root_sift),
+    _upright(upright),
+    _preFilterGrid(preFilterGrid) {}
 
   // Parameters
   int _first_octave;      // Use original image, or perform an upscale if == -1
@@ -63,7 +70,12 @@ struct SiftParams
   std::size_t _maxTotalKeypoints;
   //
   bool _root_sift;        // see [1]
-  
+  bool _upright;          // skip the orientation estimation: every feature is
+                          // output once with angle 0 (for upright imagery)
+  bool _preFilterGrid;    // apply the grid filtering on a detection-only first
+                          // pass, so descriptors are only computed for the
+                          // keypoints that survive the selection
+
   bool setPreset(EImageDescriberPreset preset) // TODO: void
   {
     switch(preset)
@@ -158,14 +170,288 @@ inline void convertSIFT<unsigned char>(
   }
 }
 
+/**
+ * @brief Pool of the per-octave vlfeat filters, reused across extractions.
+ *
+ * Every extraction otherwise allocates and frees the whole scale space
+ * (octave, DoG and gradient planes) through vl_sift_new/vl_sift_delete,
+ * which dominates the allocation churn of the extraction threads on large
+ * images. The pool keeps the filters of the last extraction alive and reuses
+ * them as long as the image dimensions and the pyramid parameters do not
+ * change, the common case of a dataset of same-size images. It can be
+ * pre-sized with \p resize before the first extraction.
+ *
+ * The pool is not thread safe: it is meant to be owned by one describer,
+ * which describes one image at a time.
+ */
+class SiftFilterPool
+{
+public:
+  SiftFilterPool() {}
+  ~SiftFilterPool() { clear(); }
+
+  // non copyable: the pool owns the vlfeat filters
+  SiftFilterPool(const SiftFilterPool&) = delete;
+  SiftFilterPool& operator=(const SiftFilterPool&) = delete;
+
+  /// whether the pooled filters fit the given image dimensions and parameters
+  bool matches(int width, int height, const SiftParams& params) const
+  {
+    return width == _width
+        && height == _height
+        && params._num_octaves == _numOctaves
+        && params._num_scales == _numScales
+        && params._first_octave == _firstOctave;
+  }
+
+  /**
+   * @brief Allocate one filter per octave for the given image dimensions,
+   * releasing any previously pooled filters that do not fit.
+   */
+  void resize(int width, int height, const SiftParams& params)
+  {
+    if(matches(width, height, params))
+      return;
+    clear();
+
+    // mirrors the vl_sift_new automatic octave count
+    int nbOctaves = params._num_octaves;
+    if(nbOctaves < 0)
+      nbOctaves = std::max(int(std::floor(std::log2(std::min(width, height)))) - params._first_octave - 3, 1);
+
+    // The filters are created serially: vl_sift_new also initializes a lookup
+    // table shared by all the filters.
+    _filters.resize(nbOctaves);
+    for(int o = 0; o < nbOctaves; ++o)
+      _filters[o] = vl_sift_new(width, height, 1, params._num_scales, params._first_octave + o);
+
+    _width = width;
+    _height = height;
+    _numOctaves = params._num_octaves;
+    _numScales = params._num_scales;
+    _firstOctave = params._first_octave;
+  }
+
+  /// the pooled per-octave filters
+  const std::vector<VlSiftFilt*>& filters() const { return _filters; }
+
+  /// release the pooled filters
+  void clear()
+  {
+    for(VlSiftFilt* filt : _filters)
+      vl_sift_delete(filt);
+    _filters.clear();
+    _width = -1;
+    _height = -1;
+  }
+
+private:
+  int _width = -1;
+  int _height = -1;
+  int _numOctaves = 0;
+  int _numScales = 0;
+  int _firstOctave = 0;
+  std::vector<VlSiftFilt*> _filters;
+};
+
+/**
+ * @brief Run the detection of every octave in parallel, on one vlfeat filter
+ * per octave taken from the pool.
+ *
+ * A filter whose first octave is \p o builds that octave directly from the
+ * input image (downsampled internally by vlfeat), so the octaves do not
+ * depend on each other and large images no longer serialize the whole
+ * pyramid on one core. The base level of each octave is then rebuilt from
+ * the downsampled input instead of the previous octave's last level; vlfeat
+ * applies the same nominal smoothing compensation in both paths so the
+ * detections are equivalent. All the octaves are resident at the same time,
+ * which increases the peak memory by about a third of the first octave.
+ *
+ * The gradient of each octave is also computed here: it is computed lazily
+ * otherwise, which would race between the descriptor threads sharing an
+ * octave.
+ *
+ * @param[in] image Input image
+ * @param[in] params The Sift parameters
+ * @param[in,out] pool The filter pool, resized to the image if needed
+ * @return The per-octave filters of the pool, which keeps their ownership.
+ */
+inline const std::vector<VlSiftFilt*>& detectOctavesSIFT(const image::Image<float>& image,
+    const SiftParams& params,
+    SiftFilterPool& pool)
+{
+  pool.resize(image.Width(), image.Height(), params);
+  const std::vector<VlSiftFilt*>& octaveFilters = pool.filters();
+
+  // the thresholds are not part of the pool key: reapply them, they may have
+  // been changed by a preset between two extractions
+  for(VlSiftFilt* filt : octaveFilters)
+  {
+    if (params._edge_threshold >= 0)
+      vl_sift_set_edge_thresh(filt, params._edge_threshold);
+    if (params._peak_threshold >= 0)
+      vl_sift_set_peak_thresh(filt, params._peak_threshold/params._num_scales);
+  }
+
+  #pragma omp parallel for schedule(dynamic)
+  for(std::size_t o = 0; o < octaveFilters.size(); ++o)
+  {
+    VlSiftFilt* filt = octaveFilters[o];
+    vl_sift_process_first_octave(filt, image.data());
+    vl_sift_detect(filt);
+    // invalidate the gradient cache: on a reused filter it still refers to
+    // the octave of the previous image
+    filt->grad_o = filt->o_min - 1;
+    vl_sift_update_gradient(filt);
+  }
+  return octaveFilters;
+}
+
+/**
+ * @brief Run a detection-only pass and apply the grid filtering on the
+ * detected keypoints, ranked by their DoG response within each cell.
+ *
+ * The selection mirrors the grid filtering of extractSIFT, but it runs before
+ * any descriptor computation: orientations and descriptors are then only
+ * computed for the surviving keypoints, identified by their (octave, index)
+ * in the already detected \p octaveFilters.
+ *
+ * @param[in] octaveFilters The per-octave filters after detection
+ * @param[in] w,h Input image dimensions
+ * @param[in] params The Sift parameters (the grid settings must be enabled)
+ * @param[in] mask 8-bit gray image for keypoint filtering (optional)
+ * @param[out] selectedPerOctave For each octave, the sorted indexes of the
+ *        keypoints to describe; empty when no filtering is needed (i.e. the
+ *        detected count fits in params._maxTotalKeypoints).
+ * @return false when no filtering is needed
+ */
+inline bool preFilterGridSIFT(const std::vector<VlSiftFilt*>& octaveFilters,
+    int w, int h,
+    const SiftParams& params,
+    const image::Image<unsigned char>* mask,
+    std::vector<std::vector<int>>& selectedPerOctave)
+{
+  struct CandidateKeypoint
+  {
+    int octaveIndex;
+    int keyIndex;
+    float x, y;
+    float response;
+  };
+  std::vector<CandidateKeypoint> candidates;
+  candidates.reserve(2 * params._maxTotalKeypoints);
+
+  const int nbOctaves = octaveFilters.size();
+
+  for (int octaveIndex = 0; octaveIndex < nbOctaves; ++octaveIndex)
+  {
+    const VlSiftFilt* filt = octaveFilters[octaveIndex];
+    VlSiftKeypoint const *keys = vl_sift_get_keypoints(filt);
+    const int nkeys = vl_sift_get_nkeypoints(filt);
+
+    // The DoG pyramid of the current octave, laid out as
+    // [s_max - s_min] planes of octave_width x octave_height values.
+    const vl_sift_pix* dog = filt->dog;
+    const int octaveWidth = filt->octave_width;
+    const int octaveHeight = filt->octave_height;
+
+    for (int i = 0; i < nkeys; ++i)
+    {
+      // Feature masking, consistent with the descriptor pass
+      if (mask)
+      {
+        const image::Image<unsigned char> & maskIma = *mask;
+        if (maskIma(keys[i].y, keys[i].x) > 0)
+          continue;
+      }
+
+      CandidateKeypoint candidate;
+      candidate.octaveIndex = octaveIndex;
+      candidate.keyIndex = i;
+      candidate.x = keys[i].x;
+      candidate.y = keys[i].y;
+      // the contrast of the DoG extremum ranks the keypoint
+      candidate.response = std::abs(dog[keys[i].ix
+                                      + keys[i].iy * octaveWidth
+                                      + (keys[i].is - filt->s_min) * octaveWidth * octaveHeight]);
+      candidates.push_back(candidate);
+    }
+  }
+
+  if(candidates.size() <= params._maxTotalKeypoints)
+    return false; // everything fits: no filtering needed
+
+  const std::size_t sizeMat = params._gridSize * params._gridSize;
+  const std::size_t keypointsPerCell = params._maxTotalKeypoints / sizeMat;
+  const double regionWidth = w / double(params._gridSize);
+  const double regionHeight = h / double(params._gridSize);
+
+  // Bucket the candidates per grid cell and rank each cell by response
+  std::vector<std::vector<std::size_t>> cellCandidates(sizeMat);
+  for(std::size_t i = 0; i < candidates.size(); ++i)
+  {
+    const std::size_t cellX = std::min(std::size_t(candidates[i].x / regionWidth), params._gridSize - 1);
+    const std::size_t cellY = std::min(std::size_t(candidates[i].y / regionHeight), params._gridSize - 1);
+    cellCandidates[cellX * params._gridSize + cellY].push_back(i);
+  }
+
+  const auto byResponse = [&candidates](std::size_t a, std::size_t b)
+  {
+    if(candidates[a].response != candidates[b].response)
+      return candidates[a].response > candidates[b].response;
+    // deterministic tie-break
+    if(candidates[a].octaveIndex != candidates[b].octaveIndex)
+      return candidates[a].octaveIndex < candidates[b].octaveIndex;
+    return candidates[a].keyIndex < candidates[b].keyIndex;
+  };
+
+  std::vector<std::size_t> selected;
+  std::vector<std::size_t> rejected;
+  selected.reserve(params._maxTotalKeypoints);
+  rejected.reserve(candidates.size());
+
+  for(std::vector<std::size_t>& cell : cellCandidates)
+  {
+    std::sort(cell.begin(), cell.end(), byResponse);
+    const std::size_t nbKept = std::min(cell.size(), keypointsPerCell);
+    selected.insert(selected.end(), cell.begin(), cell.begin() + nbKept);
+    rejected.insert(rejected.end(), cell.begin() + nbKept, cell.end());
+  }
+
+  // If we don't have enough features (less than maxTotalKeypoints) after the
+  // grid filtering (empty regions in the grid for example).
+  // We add the best other ones, without repartition constraint.
+  if(selected.size() < params._maxTotalKeypoints)
+  {
+    const std::size_t remainingElements = std::min(rejected.size(), params._maxTotalKeypoints - selected.size());
+    std::sort(rejected.begin(), rejected.end(), byResponse);
+    selected.insert(selected.end(), rejected.begin(), rejected.begin() + remainingElements);
+  }
+
+  selectedPerOctave.clear();
+  selectedPerOctave.resize(nbOctaves);
+  for(const std::size_t i : selected)
+    selectedPerOctave[candidates[i].octaveIndex].push_back(candidates[i].keyIndex);
+  // sorted, so that the descriptor pass can use a binary search
+  for(std::vector<int>& octaveSelection : selectedPerOctave)
+    std::sort(octaveSelection.begin(), octaveSelection.end());
+
+  return true;
+}
+
 /**
  * @brief Extract SIFT regions (in float or unsigned char).
  *
  * @param image
  * @param regions
  * @param params
- * @param orientation
+ * @param orientation Estimate the keypoint orientations; disabled by
+ *        params._upright, which saves the per-keypoint orientation histogram
+ *        passes and the duplicated descriptors of multi-orientation keypoints.
  * @param mask
+ * @param pool Optional filter pool reused across calls, so that extracting
+ *        from a sequence of same-size images does not reallocate the scale
+ *        space every time; a transient pool is used when none is given.
  * @return
  */
 template <typename T>
@@ -173,21 +459,28 @@ bool extractSIFT(const image::Image<float>& image,
     std::unique_ptr<Regions>& regions,
     const SiftParams& params,
     bool orientation,
-    const image::Image<unsigned char>* mask)
+    const image::Image<unsigned char>* mask,
+    SiftFilterPool* pool = nullptr)
 {
   const int w = image.Width(), h = image.Height();
-  VlSiftFilt *filt = vl_sift_new(w, h, params._num_octaves, params._num_scales, params._first_octave);
-  if (params._edge_threshold >= 0)
-    vl_sift_set_edge_thresh(filt, params._edge_threshold);
-  if (params._peak_threshold >= 0)
-    vl_sift_set_peak_thresh(filt, params._peak_threshold/params._num_scales);
+
+  SiftFilterPool transientPool;
+  SiftFilterPool& filterPool = pool ? *pool : transientPool;
+
+  // Build the scale space and detect the keypoints of every octave in
+  // parallel, on one pooled filter per octave
+  const std::vector<VlSiftFilt*>& octaveFilters = detectOctavesSIFT(image, params, filterPool);
+
+  // Two-pass mode: grid selection by response on the detected keypoints, so
+  // that the descriptor pass below skips the keypoints we would discard anyway.
+  std::vector<std::vector<int>> selectedPerOctave;
+  bool preFiltered = false;
+  if(params._preFilterGrid && params._gridSize && params._maxTotalKeypoints)
+    preFiltered = preFilterGridSIFT(octaveFilters, w, h, params, mask, selectedPerOctave);
 
   Descriptor<vl_sift_pix, 128> vlFeatDescriptor;
   Descriptor<T, 128> descriptor;
 
-  // Process SIFT computation
-  vl_sift_process_first_octave(filt, image.data());
-
   typedef ScalarRegions<SIOPointFeature,T,128> SIFT_Region_T;
   regions.reset( new SIFT_Region_T );
   
@@ -198,56 +491,61 @@ bool extractSIFT(const image::Image<float>& image,
   regionsCasted->Features().reserve(reserveSize);
   regionsCasted->Descriptors().reserve(reserveSize);
 
-  while (true)
+  // Flatten the (octave, keypoint) pairs so that the orientation and
+  // descriptor computation is balanced across threads whatever the per-octave
+  // detection counts are
+  std::vector<std::pair<int, int> > keypointIds;
+  for (std::size_t octaveIndex = 0; octaveIndex < octaveFilters.size(); ++octaveIndex)
   {
-    vl_sift_detect(filt);
+    const int nkeys = vl_sift_get_nkeypoints(octaveFilters[octaveIndex]);
+    for (int i = 0; i < nkeys; ++i)
+      keypointIds.emplace_back(octaveIndex, i);
+  }
 
-    VlSiftKeypoint const *keys  = vl_sift_get_keypoints(filt);
-    const int nkeys = vl_sift_get_nkeypoints(filt);
+  #pragma omp parallel for schedule(dynamic) private(vlFeatDescriptor, descriptor)
+  for (std::size_t k = 0; k < keypointIds.size(); ++k)
+  {
+    const int octaveIndex = keypointIds[k].first;
+    const int i = keypointIds[k].second;
+    VlSiftFilt* filt = octaveFilters[octaveIndex];
+    VlSiftKeypoint const *keys = vl_sift_get_keypoints(filt);
+
+    // Keypoint discarded by the detection-only grid filtering pass
+    if (preFiltered &&
+        !std::binary_search(selectedPerOctave.at(octaveIndex).begin(), selectedPerOctave.at(octaveIndex).end(), i))
+      continue;
+
+    // Feature masking
+    if (mask)
+    {
+      const image::Image<unsigned char> & maskIma = *mask;
+      if (maskIma(keys[i].y, keys[i].x) > 0)
+        continue;
+    }
 
-    // Update gradient before launching parallel extraction
-    vl_sift_update_gradient(filt);
+    double angles [4] = {0.0, 0.0, 0.0, 0.0};
+    int nangles = 1; // by default (1 upright feature)
+    if (orientation && !params._upright)
+    { // compute from 1 to 4 orientations
+      nangles = vl_sift_calc_keypoint_orientations(filt, angles, keys+i);
+    }
 
-    #pragma omp parallel for private(vlFeatDescriptor, descriptor)
-    for (int i = 0; i < nkeys; ++i)
+    for (int q=0 ; q < nangles ; ++q)
     {
+      vl_sift_calc_keypoint_descriptor(filt, &vlFeatDescriptor[0], keys+i, angles[q]);
+      const SIOPointFeature fp(keys[i].x, keys[i].y,
+        keys[i].sigma, static_cast<float>(angles[q]));
 
-      // Feature masking
-      if (mask)
-      {
-        const image::Image<unsigned char> & maskIma = *mask;
-        if (maskIma(keys[i].y, keys[i].x) > 0)
-          continue;
-      }
+      convertSIFT<T>(&vlFeatDescriptor[0], descriptor, params._root_sift);
 
-      double angles [4] = {0.0, 0.0, 0.0, 0.0};
-      int nangles = 1; // by default (1 upright feature)
-      if (orientation)
-      { // compute from 1 to 4 orientations
-        nangles = vl_sift_calc_keypoint_orientations(filt, angles, keys+i);
-      }
-
-      for (int q=0 ; q < nangles ; ++q)
+      #pragma omp critical
       {
-        vl_sift_calc_keypoint_descriptor(filt, &vlFeatDescriptor[0], keys+i, angles[q]);
-        const SIOPointFeature fp(keys[i].x, keys[i].y,
-          keys[i].sigma, static_cast<float>(angles[q]));
-
-        convertSIFT<T>(&vlFeatDescriptor[0], descriptor, params._root_sift);
-        
-        #pragma omp critical
-        {
-          regionsCasted->Descriptors().push_back(descriptor);
-          regionsCasted->Features().push_back(fp);
-        }
-        
+        regionsCasted->Descriptors().push_back(descriptor);
+        regionsCasted->Features().push_back(fp);
       }
+
     }
-    
-    if (vl_sift_process_next_octave(filt))
-      break; // Last octave
   }
-  vl_sift_delete(filt);
 
   const auto& features = regionsCasted->Features();
   const auto& descriptors = regionsCasted->Descriptors();
@@ -271,7 +569,8 @@ bool extractSIFT(const image::Image<float>& image,
   }
 
   // Grid filtering of the keypoints to ensure a global repartition
-  if(params._gridSize && params._maxTotalKeypoints)
+  // (already applied before the descriptor computation in two-pass mode)
+  if(params._gridSize && params._maxTotalKeypoints && !preFiltered)
   {
     // Only filter features if we have more features than the maxTotalKeypoints
     if(features.size() > params._maxTotalKeypoints)
@@ -19,6 +19,7 @@ std::string describerTypeColor(const feature::EImageDescriberType descType )
   {
     case feature::EImageDescriberType::SIFT:           return "yellow";
     case feature::EImageDescriberType::SIFT_FLOAT:     return "yellow";
+    case feature::EImageDescriberType::SIFT_UPRIGHT:   return "yellow";
     case feature::EImageDescriberType::AKAZE:          return "purple";
     case feature::EImageDescriberType::AKAZE_LIOP:     return "purple";
     case feature::EImageDescriberType::AKAZE_MLDB:     return "purple";
@@ -19,12 +19,21 @@ using namespace aliceVision::geometry::halfPlane;
 ///  - This structure is used for testing frustum intersection (see if two cam can share visual content)
 struct Frustum
 {
+  /// Fixed-size storage of the plane equations (one column per half plane):
+  /// a batch of points is tested against all the planes with a single
+  /// fixed-size matrix product that Eigen can vectorize.
+  typedef Eigen::Matrix<double, 4, 6, Eigen::DontAlign> PlaneMatrix;
+
   Vec3 cones[5]; // camera centre and the 4 points that define the image plane
   Half_planes planes; // Define infinite frustum planes + 2 optional Near and Far Half Space
+  PlaneMatrix planeMatrix; // The planes stacked for batch containment tests
   double z_near, z_far;
   std::vector<Vec3> points;
 
-  Frustum() : z_near(-1.), z_far(-1.)  {}
+  Frustum() : z_near(-1.), z_far(-1.)
+  {
+    planeMatrix.setZero();
+  }
 
   // Build a frustum from the image size, camera intrinsic and pose
   Frustum(const int w, const int h, const Mat3 & K, const Mat3 & R, const Vec3 & C)
@@ -48,6 +57,8 @@ struct Frustum
 
     // supporting point for drawing is a normalized cone, since infinity cannot be represented
     points = std::vector<Vec3>(&cones[0], &cones[0]+5);
+
+    initPlaneMatrix();
   }
 
   Frustum(const int w, const int h, const Mat3 & K, const Mat3 & R, const Vec3 & C, const double zNear, const double zFar)
@@ -80,11 +91,56 @@ struct Frustum
     points.push_back( Rt * (z_far * (Kinv * Vec3(w,0,1.0))) + C);
     points.push_back( Rt * (z_far * (Kinv * Vec3(w,h,1.0))) + C);
     points.push_back( Rt * (z_far * (Kinv * Vec3(0,h,1.0))) + C);
+
+    initPlaneMatrix();
+  }
+
+  /// Stack the plane equations in the fixed-size matrix. The unused columns
+  /// of an infinite frustum are zero planes, which count any point as inside,
+  /// so the containment tests run branch-free whatever the frustum type.
+  void initPlaneMatrix()
+  {
+    planeMatrix.setZero();
+    for (std::size_t i = 0; i < planes.size(); ++i)
+      planeMatrix.col(i) = planes[i].coeffs();
+  }
+
+  /// Return true if the point lies inside the frustum
+  /// (on the positive side of every half plane)
+  bool contains(const Vec3 & X) const
+  {
+    const Eigen::Matrix<double, 6, 1> distances = planeMatrix.transpose() * X.homogeneous();
+    return (distances.array() >= 0.0).all();
+  }
+
+  /// Count how many of the given points (one per column) lie inside the
+  /// frustum; every point is evaluated against all the planes at once
+  std::size_t countContainedPoints(const Mat3X & points_) const
+  {
+    if (points_.cols() == 0)
+      return 0;
+    const Eigen::Matrix<double, 6, Eigen::Dynamic> distances =
+      planeMatrix.transpose() * points_.colwise().homogeneous();
+    return (distances.array() >= 0.0).colwise().all().count();
+  }
+
+  /// Return true if at least one of the given points lies inside the frustum
+  bool containsAnyPoint(const std::vector<Vec3> & points_) const
+  {
+    for (const Vec3 & pt : points_)
+      if (contains(pt))
+        return true;
+    return false;
   }
 
   /// Test if two frustums intersect or not
   bool intersect(const Frustum & f) const
   {
+    // Quick accept: if a supporting point of one frustum lies inside the
+    // other one the volumes overlap, no need to solve the linear program
+    if (containsAnyPoint(f.points) || f.containsAnyPoint(points))
+      return true;
+
     // Concatenate the Half Planes and see if an intersection exists
     std::vector<Half_plane> vec_planes(planes.size() + f.planes.size());
     std::copy(&planes[0], &planes[0]+planes.size(), &vec_planes[0]);
@@ -113,6 +169,21 @@ struct Frustum
 
 }; // struct Frustum
 
+/// Test one point against many frustums: append to out_indexes the index of
+/// every frustum of the collection that contains the point
+inline void findContainingFrustums(const std::vector<Frustum> & frustums,
+  const Vec3 & X,
+  std::vector<std::size_t> & out_indexes)
+{
+  out_indexes.clear();
+  const Vec4 Xh = X.homogeneous();
+  for (std::size_t i = 0; i < frustums.size(); ++i)
+  {
+    if (((frustums[i].planeMatrix.transpose() * Xh).array() >= 0.0).all())
+      out_indexes.push_back(i);
+  }
+}
+
 } // namespace geometry
 } // namespace aliceVision
 
@@ -39,7 +39,14 @@ class Pose3
     // Translation vector t = -RC
     inline Vec3 translation() const { return -(_rotation * _center); }
 
-    // Apply pose
+    // Apply pose to a single point, without going through the dynamic-size
+    // batched overload (which would allocate a one column matrix per call)
+    inline Vec3 operator () (const Vec3& p) const
+    {
+      return _rotation * (p - _center);
+    }
+
+    // Apply pose to a batch of points (one per column) in a single pass
     inline Mat3X operator () (const Mat3X& p) const
     {
       return _rotation * (p.colwise() - _center);
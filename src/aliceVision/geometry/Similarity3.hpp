@@ -25,6 +25,12 @@ struct Similarity3
     return _scale * _pose(point);
   }
 
+  // Apply the similarity to a batch of points (one per column) in a single pass
+  Mat3X operator () (const Mat3X & points) const
+  {
+    return _scale * _pose(points);
+  }
+
   Pose3 operator () (const Pose3 & pose) const
   {
     return Pose3( pose.rotation() * _pose.rotation().transpose(), this->operator()(pose.center()));
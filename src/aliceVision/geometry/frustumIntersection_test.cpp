@@ -167,3 +167,45 @@ BOOST_AUTO_TEST_CASE(empty_intersection)
     }
   }
 }
+
+BOOST_AUTO_TEST_CASE(point_containment)
+{
+  const int focal = 1000;
+  const int principal_Point = 500;
+  const int iNviews = 4;
+  const int iNbPoints = 6;
+  const NViewDataSet d =
+    NRealisticCamerasRing(
+    iNviews, iNbPoints,
+    NViewDatasetConfigurator(focal, focal, principal_Point, principal_Point, 5, 0));
+
+  std::vector<Frustum> vec_frustum;
+  for (int i=0; i < iNviews; ++i)
+  {
+    vec_frustum.push_back(
+      Frustum(principal_Point*2, principal_Point*2, d._K[i], d._R[i], d._C[i]));
+  }
+
+  // The scene points are seen by every camera: they must be inside every
+  // frustum, for the single point test as well as for the batch ones
+  for (int i=0; i < iNviews; ++i)
+  {
+    for (int j=0; j < iNbPoints; ++j)
+      BOOST_CHECK(vec_frustum[i].contains(d._X.col(j)));
+
+    BOOST_CHECK_EQUAL(iNbPoints, vec_frustum[i].countContainedPoints(d._X));
+  }
+
+  // One point against many frustums
+  std::vector<std::size_t> containingFrustums;
+  findContainingFrustums(vec_frustum, d._X.col(0), containingFrustums);
+  BOOST_CHECK_EQUAL(iNviews, containingFrustums.size());
+
+  // The cameras lie on a circle of the XZ plane and look at the origin:
+  // a point far along the Y axis is outside every field of view
+  const Vec3 outsidePoint = Vec3(0, 1000.0, 0);
+  for (int i=0; i < iNviews; ++i)
+    BOOST_CHECK(!vec_frustum[i].contains(outsidePoint));
+  findContainingFrustums(vec_frustum, outsidePoint, containingFrustums);
+  BOOST_CHECK(containingFrustums.empty());
+}
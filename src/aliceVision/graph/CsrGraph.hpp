@@ -0,0 +1,172 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <set>
+#include <vector>
+
+namespace aliceVision {
+namespace graph  {
+
+/**
+ * @brief Flat CSR (compressed sparse row) view of an undirected graph.
+ *
+ * The graph is built once from an iterable of (i, j) pairs and is immutable.
+ * The node ids are compacted: node k of the CSR arrays is the k-th referenced
+ * id in increasing order, nodeId() maps it back. Unlike a lemon ListGraph with
+ * per-node maps, the whole structure lives in three contiguous arrays (a few
+ * words per edge), so building and traversing the match graph of a large
+ * dataset stays cheap in time and memory.
+ */
+struct CsrGraph
+{
+  template <typename IterablePairs>
+  explicit CsrGraph(const IterablePairs& pairs)
+  {
+    // Compact the referenced node ids
+    for(typename IterablePairs::const_iterator iter = pairs.begin(); iter != pairs.end(); ++iter)
+    {
+      _nodeIds.push_back(iter->first);
+      _nodeIds.push_back(iter->second);
+    }
+    std::sort(_nodeIds.begin(), _nodeIds.end());
+    _nodeIds.erase(std::unique(_nodeIds.begin(), _nodeIds.end()), _nodeIds.end());
+
+    // Count the degrees, then fill the adjacency with a prefix sum on the rows
+    _rows.assign(_nodeIds.size() + 1, 0);
+    for(typename IterablePairs::const_iterator iter = pairs.begin(); iter != pairs.end(); ++iter)
+    {
+      ++_rows[nodeIndex(iter->first) + 1];
+      ++_rows[nodeIndex(iter->second) + 1];
+    }
+    std::partial_sum(_rows.begin(), _rows.end(), _rows.begin());
+    _cols.resize(_rows.back());
+    std::vector<std::size_t> insertPos(_rows.begin(), _rows.end() - 1);
+    for(typename IterablePairs::const_iterator iter = pairs.begin(); iter != pairs.end(); ++iter)
+    {
+      const std::uint32_t u = nodeIndex(iter->first);
+      const std::uint32_t v = nodeIndex(iter->second);
+      _cols[insertPos[u]++] = v;
+      _cols[insertPos[v]++] = u;
+    }
+    // Sort each adjacency row, so neighborhoods can be intersected and probed
+    // with binary searches
+    for(std::size_t k = 0; k < _nodeIds.size(); ++k)
+      std::sort(_cols.begin() + _rows[k], _cols.begin() + _rows[k + 1]);
+  }
+
+  std::size_t nbNodes() const { return _nodeIds.size(); }
+  std::size_t nbEdges() const { return _cols.size() / 2; }
+
+  /// Original id of the k-th node of the CSR arrays
+  IndexT nodeId(std::size_t k) const { return _nodeIds[k]; }
+
+  /// CSR index of an original node id (the id must be referenced by an edge)
+  std::uint32_t nodeIndex(IndexT id) const
+  {
+    return static_cast<std::uint32_t>(
+      std::lower_bound(_nodeIds.begin(), _nodeIds.end(), id) - _nodeIds.begin());
+  }
+
+  /// Sorted neighborhood of the k-th node: [neighborsBegin(k), neighborsEnd(k))
+  const std::uint32_t* neighborsBegin(std::size_t k) const { return _cols.data() + _rows[k]; }
+  const std::uint32_t* neighborsEnd(std::size_t k) const { return _cols.data() + _rows[k + 1]; }
+
+  /// Check the existence of the edge between two CSR node indexes
+  bool hasEdge(std::uint32_t u, std::uint32_t v) const
+  {
+    return std::binary_search(neighborsBegin(u), neighborsEnd(u), v);
+  }
+
+  /**
+   * @brief Label the connected components of the graph.
+   *
+   * Parallel label propagation: every node starts with its own index as
+   * label, then repeatedly adopts the smallest label of its neighborhood,
+   * with a pointer-jumping pass shortcutting the label chains between the
+   * sweeps. The races on the label array are benign (labels only decrease),
+   * so the sweeps run on all the cores.
+   *
+   * @param[out] outComponents per-node component label (the smallest CSR node index of the component)
+   * @return the number of connected components
+   */
+  std::size_t connectedComponents(std::vector<std::uint32_t>& outComponents) const
+  {
+    const std::size_t n = nbNodes();
+    outComponents.resize(n);
+    for(std::size_t i = 0; i < n; ++i)
+      outComponents[i] = static_cast<std::uint32_t>(i);
+
+    bool changed = (n != 0);
+    while(changed)
+    {
+      changed = false;
+      #pragma omp parallel for schedule(dynamic, 1024)
+      for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(n); ++i)
+      {
+        std::uint32_t best = outComponents[i];
+        for(std::size_t e = _rows[i]; e < _rows[i + 1]; ++e)
+          best = std::min(best, outComponents[_cols[e]]);
+        if(best < outComponents[i])
+        {
+          outComponents[i] = best;
+          changed = true;
+        }
+      }
+      // Shortcut the label chains: comp[i] <- comp[comp[i]] until stable
+      #pragma omp parallel for schedule(static)
+      for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(n); ++i)
+      {
+        std::uint32_t label = outComponents[i];
+        while(outComponents[label] != label)
+          label = outComponents[label];
+        outComponents[i] = label;
+      }
+    }
+
+    std::size_t nbComponents = 0;
+    for(std::size_t i = 0; i < n; ++i)
+      if(outComponents[i] == i)
+        ++nbComponents;
+    return nbComponents;
+  }
+
+  /// Original node ids of the largest connected component
+  std::set<IndexT> largestComponentIds() const
+  {
+    std::set<IndexT> out;
+    std::vector<std::uint32_t> components;
+    if(connectedComponents(components) == 0)
+      return out;
+
+    std::vector<std::size_t> componentSizes(nbNodes(), 0);
+    for(std::size_t i = 0; i < components.size(); ++i)
+      ++componentSizes[components[i]];
+    const std::uint32_t largest = static_cast<std::uint32_t>(
+      std::max_element(componentSizes.begin(), componentSizes.end()) - componentSizes.begin());
+
+    for(std::size_t i = 0; i < components.size(); ++i)
+      if(components[i] == largest)
+        out.insert(nodeId(i));
+    return out;
+  }
+
+private:
+  /// Referenced node ids, sorted: the position of an id is its CSR node index
+  std::vector<IndexT> _nodeIds;
+  /// Per-node range of the adjacency array: [_rows[k], _rows[k+1])
+  std::vector<std::size_t> _rows;
+  /// Adjacency array, each undirected edge stored in both directions
+  std::vector<std::uint32_t> _cols;
+};
+
+} // namespace graph
+} // namespace aliceVision
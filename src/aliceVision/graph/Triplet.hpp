@@ -7,6 +7,7 @@
 
 #include <aliceVision/types.hpp>
 #include <aliceVision/graph/graph.hpp>
+#include <aliceVision/graph/CsrGraph.hpp>
 
 #include <lemon/list_graph.h>
 
@@ -143,5 +144,68 @@ inline std::vector< graph::Triplet > tripletListing(
   return vec_triplets;
 }
 
+/**
+ * @brief Return triplets contained in the graph build from IterablePairs,
+ * enumerated in parallel over a CSR adjacency structure.
+ *
+ * Each triangle is reported once from its smallest node: for every edge
+ * (u, v) with u < v, the neighborhoods of u and v (sorted by the CSR build)
+ * are intersected for the nodes w > v. The per-node loops are independent, so
+ * they are spread on all the cores with thread-local triplet lists merged at
+ * the end; the output is then sorted to stay deterministic.
+ */
+template <typename IterablePairs>
+inline std::vector< graph::Triplet > tripletListingParallel(
+  const IterablePairs & pairs)
+{
+  const CsrGraph g(pairs);
+  const std::ptrdiff_t nbNodes = static_cast<std::ptrdiff_t>(g.nbNodes());
+
+  std::vector< graph::Triplet > vec_triplets;
+  #pragma omp parallel
+  {
+    std::vector< graph::Triplet > localTriplets;
+    #pragma omp for schedule(dynamic, 64) nowait
+    for (std::ptrdiff_t u = 0; u < nbNodes; ++u)
+    {
+      for (const std::uint32_t* itV = g.neighborsBegin(u); itV != g.neighborsEnd(u); ++itV)
+      {
+        const std::uint32_t v = *itV;
+        if (v <= static_cast<std::uint32_t>(u))
+          continue;
+        // Intersect the neighborhoods of u and v beyond v
+        const std::uint32_t* itU = std::upper_bound(itV, g.neighborsEnd(u), v);
+        const std::uint32_t* itW = std::upper_bound(g.neighborsBegin(v), g.neighborsEnd(v), v);
+        while (itU != g.neighborsEnd(u) && itW != g.neighborsEnd(v))
+        {
+          if (*itU < *itW)
+            ++itU;
+          else if (*itW < *itU)
+            ++itW;
+          else
+          {
+            // The node ids are sorted as the CSR indexes, the triplet is already ascending
+            localTriplets.push_back(Triplet(
+              g.nodeId(u), g.nodeId(v), g.nodeId(*itU)));
+            ++itU;
+            ++itW;
+          }
+        }
+      }
+    }
+    #pragma omp critical
+    vec_triplets.insert(vec_triplets.end(), localTriplets.begin(), localTriplets.end());
+  }
+
+  std::sort(vec_triplets.begin(), vec_triplets.end(),
+    [](const Triplet& a, const Triplet& b)
+    {
+      if (a.i != b.i) return a.i < b.i;
+      if (a.j != b.j) return a.j < b.j;
+      return a.k < b.k;
+    });
+  return vec_triplets;
+}
+
 } // namespace graph
 } // namespace aliceVision
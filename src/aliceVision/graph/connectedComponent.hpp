@@ -9,8 +9,11 @@
 #include <aliceVision/types.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/graph/graph.hpp>
+#include <aliceVision/graph/CsrGraph.hpp>
 
 #include <set>
+#include <utility>
+#include <vector>
 
 namespace aliceVision {
 namespace graph {
@@ -77,59 +80,23 @@ std::set<IndexT> CleanGraph_KeepLargestBiEdge_Nodes(
   }
 
   // Graph is bi-edge connected, but still many connected components can exist
-  // Keep only the largest one
-  const int connectedComponentCount = lemon::countConnectedComponents(putativeGraph.g);
-  ALICEVISION_LOG_DEBUG("CleanGraph_KeepLargestBiEdge_Nodes():: => connected Component: "
-    << connectedComponentCount);
-  if (connectedComponentCount >= 1)
+  // Keep only the largest one, on a flat CSR copy of the remaining edges: the
+  // labeling runs in parallel and does not touch the lemon node maps
   {
-    // Keep only the largest connected component
-    // - list all CC size
-    // - if the largest one is meet, keep all the edges that belong to this node
-
-    const std::map<IndexT, std::set<Graph::Node> > map_subgraphs = exportGraphToMapSubgraphs<Graph,IndexT>(putativeGraph.g);
-    size_t count = std::numeric_limits<size_t>::min();
-    typename std::map<IndexT, std::set<Graph::Node> >::const_iterator iterLargestCC = map_subgraphs.end();
-    for(typename std::map<IndexT, std::set<Graph::Node> >::const_iterator iter = map_subgraphs.begin();
-        iter != map_subgraphs.end(); ++iter)
+    std::vector<std::pair<IndexT, IndexT> > remainingEdges;
+    remainingEdges.reserve(lemon::countEdges(putativeGraph.g));
+    for (Graph::EdgeIt e(putativeGraph.g); e != lemon::INVALID; ++e)
     {
-      if (iter->second.size() > count)  {
-        count = iter->second.size();
-        iterLargestCC = iter;
-      }
-      ALICEVISION_LOG_DEBUG("Connected component of size: " << iter->second.size());
-    }
-
-    //-- Keep only the nodes that are in the largest CC
-    for(typename std::map<IndexT, std::set<lemon::ListGraph::Node> >::const_iterator iter = map_subgraphs.begin();
-        iter != map_subgraphs.end(); ++iter)
-    {
-      if (iter == iterLargestCC)
-      {
-        // list all nodes that belong to the current CC and update the Node Ids list
-        const std::set<lemon::ListGraph::Node> & ccSet = iter->second;
-        for (std::set<lemon::ListGraph::Node>::const_iterator iter2 = ccSet.begin();
-          iter2 != ccSet.end(); ++iter2)
-        {
-          const IndexT Id = (*putativeGraph.map_nodeMapIndex)[*iter2];
-          largestBiEdgeCC.insert(Id);
-        }
-      }
-      else
-      {
-        // remove the edges from the graph
-        const std::set<lemon::ListGraph::Node> & ccSet = iter->second;
-        for (std::set<lemon::ListGraph::Node>::const_iterator iter2 = ccSet.begin();
-          iter2 != ccSet.end(); ++iter2)
-        {
-          typedef Graph::OutArcIt OutArcIt;
-          for (OutArcIt e(putativeGraph.g, *iter2); e!=lemon::INVALID; ++e)
-          {
-            putativeGraph.g.erase(e);
-          }
-        }
-      }
+      remainingEdges.push_back(std::make_pair(
+        (*putativeGraph.map_nodeMapIndex)[putativeGraph.g.u(e)],
+        (*putativeGraph.map_nodeMapIndex)[putativeGraph.g.v(e)]));
     }
+    const CsrGraph csrGraph(remainingEdges);
+    std::vector<std::uint32_t> components;
+    const std::size_t connectedComponentCount = csrGraph.connectedComponents(components);
+    ALICEVISION_LOG_DEBUG("CleanGraph_KeepLargestBiEdge_Nodes():: => connected Component: "
+      << connectedComponentCount);
+    largestBiEdgeCC = csrGraph.largestComponentIds();
   }
 /*
   if (!_sOutDirectory.empty())
@@ -142,7 +109,8 @@ std::set<IndexT> CleanGraph_KeepLargestBiEdge_Nodes(
 
   ALICEVISION_LOG_DEBUG(
     "Cardinal of nodes: " << lemon::countNodes(putativeGraph.g) << "\n" <<
-    "Cardinal of edges: " << lemon::countEdges(putativeGraph.g)
+    "Cardinal of edges: " << lemon::countEdges(putativeGraph.g) << "\n" <<
+    "Cardinal of the largest bi-edge connected component: " << largestBiEdgeCC.size()
     );
 
   return largestBiEdgeCC;
@@ -108,3 +108,63 @@ BOOST_AUTO_TEST_CASE(exportGraphToMapSubgraphs_CC_Subgraph) {
   BOOST_CHECK_EQUAL(2, map_subgraphs.at(2).size());
   BOOST_CHECK_EQUAL(1, map_subgraphs.at(3).size());
 }
+
+/// CSR graph: three components
+// a-b
+//
+// c-d-e
+//
+// f-g-h-i (with non contiguous ids)
+BOOST_AUTO_TEST_CASE(CsrGraph_ConnectedComponents) {
+  using aliceVision::IndexT;
+  std::vector<std::pair<IndexT, IndexT> > edges;
+  edges.push_back(std::make_pair(0, 1));
+  edges.push_back(std::make_pair(2, 3));
+  edges.push_back(std::make_pair(3, 4));
+  edges.push_back(std::make_pair(10, 20));
+  edges.push_back(std::make_pair(20, 30));
+  edges.push_back(std::make_pair(30, 40));
+
+  const aliceVision::graph::CsrGraph graph(edges);
+  BOOST_CHECK_EQUAL(9, graph.nbNodes());
+  BOOST_CHECK_EQUAL(6, graph.nbEdges());
+
+  std::vector<std::uint32_t> components;
+  BOOST_CHECK_EQUAL(3, graph.connectedComponents(components));
+
+  // the two ends of each edge carry the same label
+  for (size_t i = 0; i < edges.size(); ++i)
+  {
+    BOOST_CHECK_EQUAL(
+      components[graph.nodeIndex(edges[i].first)],
+      components[graph.nodeIndex(edges[i].second)]);
+  }
+  // nodes of different components carry different labels
+  BOOST_CHECK_NE(components[graph.nodeIndex(0)], components[graph.nodeIndex(2)]);
+  BOOST_CHECK_NE(components[graph.nodeIndex(2)], components[graph.nodeIndex(10)]);
+
+  const std::set<IndexT> largestCC = graph.largestComponentIds();
+  BOOST_CHECK_EQUAL(4, largestCC.size());
+  BOOST_CHECK(largestCC.count(10) && largestCC.count(20) && largestCC.count(30) && largestCC.count(40));
+}
+
+/// The keep-largest-bi-edge pass on a graph made of a triangle pair sharing
+/// one node (bi-edge cut) plus a separate larger bi-edge connected square
+BOOST_AUTO_TEST_CASE(CsrGraph_CleanGraph_KeepLargestBiEdge) {
+  using aliceVision::IndexT;
+  typedef std::pair<IndexT, IndexT> P;
+  std::set<P> edges;
+  // triangle 0-1-2
+  edges.insert(P(0, 1)); edges.insert(P(1, 2)); edges.insert(P(0, 2));
+  // dangling edge (cut by the bi-edge condition)
+  edges.insert(P(2, 3));
+  // square 10-11-12-13 with a diagonal
+  edges.insert(P(10, 11)); edges.insert(P(11, 12)); edges.insert(P(12, 13));
+  edges.insert(P(13, 10)); edges.insert(P(10, 12));
+
+  const std::set<IndexT> largest =
+    aliceVision::graph::CleanGraph_KeepLargestBiEdge_Nodes<std::set<P>, IndexT>(edges);
+
+  BOOST_CHECK_EQUAL(4, largest.size());
+  BOOST_CHECK(largest.count(10) && largest.count(11) && largest.count(12) && largest.count(13));
+}
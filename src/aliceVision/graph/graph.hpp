@@ -7,6 +7,7 @@
 
 #include "aliceVision/types.hpp"
 #include "aliceVision/graph/IndexedGraph.hpp"
+#include "aliceVision/graph/CsrGraph.hpp"
 #include "aliceVision/graph/indexedGraphGraphvizExport.hpp"
 #include "aliceVision/graph/connectedComponent.hpp"
 #include "aliceVision/graph/Triplet.hpp"
@@ -266,3 +266,36 @@ BOOST_AUTO_TEST_CASE(test_for_triplet) {
     BOOST_CHECK_EQUAL(4, vec_triplets.size());
   }
 }
+
+BOOST_AUTO_TEST_CASE(test_triplet_listing_parallel) {
+
+  using aliceVision::IndexT;
+  typedef std::pair<IndexT, IndexT> P;
+
+  // Complete graph over {0,1,2,3,4} (10 triplets) plus a separate triangle
+  // with non contiguous ids and a dangling edge
+  std::set<P> pairs;
+  for (IndexT i = 0; i < 5; ++i)
+    for (IndexT j = i + 1; j < 5; ++j)
+      pairs.insert(P(i, j));
+  pairs.insert(P(10, 20));
+  pairs.insert(P(20, 30));
+  pairs.insert(P(10, 30));
+  pairs.insert(P(30, 40));
+
+  const std::vector<Triplet> serialTriplets = tripletListing(pairs);
+  const std::vector<Triplet> parallelTriplets = tripletListingParallel(pairs);
+
+  BOOST_CHECK_EQUAL(11, parallelTriplets.size());
+  BOOST_CHECK_EQUAL(serialTriplets.size(), parallelTriplets.size());
+
+  // Same triplet set as the lemon based listing
+  for (size_t t = 0; t < parallelTriplets.size(); ++t)
+  {
+    bool found = false;
+    for (size_t s = 0; s < serialTriplets.size(); ++s)
+      if (serialTriplets[s] == parallelTriplets[t])
+        found = true;
+    BOOST_CHECK(found);
+  }
+}
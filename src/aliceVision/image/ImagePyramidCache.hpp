@@ -0,0 +1,321 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/image/Image.hpp>
+#include <aliceVision/image/io.hpp>
+#include <aliceVision/image/resampling.hpp>
+#include <aliceVision/stl/hash.hpp>
+#include <aliceVision/system/MemoryGovernor.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace image {
+
+/**
+ ** Half-resolution image pyramid: level 0 is the base image, each further
+ ** level halves the previous one (see ImageHalfSample)
+ **/
+template <typename T>
+struct ImagePyramid
+{
+  std::vector<Image<T>> levels;
+
+  /// Memory held by the pyramid levels, in bytes
+  std::size_t memorySize() const
+  {
+    std::size_t size = 0;
+    for (std::size_t i = 0; i < levels.size(); ++i)
+      size += std::size_t(levels[i].Width()) * levels[i].Height() * sizeof(T);
+    return size;
+  }
+};
+
+/**
+ ** Cache of image pyramids shared between pipeline stages, keyed by the
+ ** source image path (or any caller-chosen key) and the build parameters.
+ ** A stage querying an image another stage already processed reuses the
+ ** pyramid levels instead of rebuilding them.
+ **
+ ** The cache is bounded by a memory budget with least-recently-used
+ ** eviction. When a spill directory is given, evicted pyramids are written
+ ** to disk and reloaded on the next query instead of being rebuilt.
+ ** The cache can also register with the process memory governor
+ ** (registerWithMemoryGovernor) so that other modules under memory pressure
+ ** can trigger its eviction.
+ ** All the accesses are thread-safe.
+ **/
+template <typename T>
+class ImagePyramidCache
+{
+public:
+  explicit ImagePyramidCache(std::size_t maxMemory = std::size_t(1024) * 1024 * 1024,
+                             const std::string& spillDirectory = "")
+    : _maxMemory(maxMemory)
+    , _spillDirectory(spillDirectory)
+  {}
+
+  ImagePyramidCache(const ImagePyramidCache&) = delete;
+  ImagePyramidCache& operator=(const ImagePyramidCache&) = delete;
+
+  ~ImagePyramidCache()
+  {
+    if (_governorClientId != system::MemoryGovernor::kNoClient)
+      system::MemoryGovernor::instance().unregisterClient(_governorClientId);
+  }
+
+  /**
+   ** Get the pyramid of an image already decoded by the caller,
+   ** building it on a cache miss
+   ** @param key source image path, or any string identifying the image
+   ** @param image the decoded base image (level 0 of the pyramid)
+   ** @param nbLevels number of pyramid levels, base image included
+   **/
+  std::shared_ptr<const ImagePyramid<T>> get(const std::string& key, const Image<T>& image, std::size_t nbLevels)
+  {
+    const std::size_t hash = computeHash(key, nbLevels);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    std::shared_ptr<const ImagePyramid<T>> pyramid = findLocked(hash);
+    if (pyramid)
+      return pyramid;
+
+    pyramid = buildPyramid(image, nbLevels);
+    insertLocked(hash, pyramid);
+    return pyramid;
+  }
+
+  /**
+   ** Get the pyramid of an image, decoding it from disk on a cache miss
+   ** @param imagePath path of the image to decode
+   ** @param nbLevels number of pyramid levels, base image included
+   **/
+  std::shared_ptr<const ImagePyramid<T>> get(const std::string& imagePath, std::size_t nbLevels)
+  {
+    const std::size_t hash = computeHash(imagePath, nbLevels);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    std::shared_ptr<const ImagePyramid<T>> pyramid = findLocked(hash);
+    if (pyramid)
+      return pyramid;
+
+    Image<T> image;
+    readImage(imagePath, image);
+    pyramid = buildPyramid(image, nbLevels);
+    insertLocked(hash, pyramid);
+    return pyramid;
+  }
+
+  /// Memory held by the cached pyramids, in bytes
+  std::size_t usedMemory() const
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _usedMemory;
+  }
+
+  /// Number of pyramids currently held in memory
+  std::size_t nbPyramids() const
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _entries.size();
+  }
+
+  /**
+   ** Evict least-recently-used pyramids until at least nbBytes are freed
+   ** (or the cache is empty), spilling them to disk when a spill directory
+   ** is set
+   ** @param nbBytes amount of memory to release
+   ** @return the number of bytes actually freed
+   **/
+  std::size_t reclaim(std::size_t nbBytes)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    std::size_t freed = 0;
+    while (freed < nbBytes && !_entries.empty())
+    {
+      const std::size_t evictedHash = _lru.back();
+      const typename std::map<std::size_t, Entry>::iterator it = _entries.find(evictedHash);
+      spill(evictedHash, *it->second.pyramid);
+      const std::size_t entrySize = it->second.pyramid->memorySize();
+      _usedMemory -= entrySize;
+      freed += entrySize;
+      _entries.erase(it);
+      _lru.pop_back();
+    }
+    return freed;
+  }
+
+  /**
+   ** Register the cache as a reclaimable client of the process memory
+   ** governor; it is unregistered in the destructor
+   ** @param name client name, used in the logs
+   **/
+  void registerWithMemoryGovernor(const std::string& name)
+  {
+    if (_governorClientId != system::MemoryGovernor::kNoClient)
+      return;
+
+    ImagePyramidCache<T>* self = this;
+    _governorClientId = system::MemoryGovernor::instance().registerClient(
+        name,
+        [self]() { return self->usedMemory(); },
+        [self](std::size_t nbBytes) { return self->reclaim(nbBytes); });
+  }
+
+private:
+  struct Entry
+  {
+    std::shared_ptr<const ImagePyramid<T>> pyramid;
+    std::list<std::size_t>::iterator lruIt;
+  };
+
+  static std::size_t computeHash(const std::string& key, std::size_t nbLevels)
+  {
+    std::size_t seed = 0;
+    stl::hash_combine(seed, key);
+    stl::hash_combine(seed, nbLevels);
+    return seed;
+  }
+
+  static std::shared_ptr<const ImagePyramid<T>> buildPyramid(const Image<T>& image, std::size_t nbLevels)
+  {
+    std::shared_ptr<ImagePyramid<T>> pyramid = std::make_shared<ImagePyramid<T>>();
+    pyramid->levels.resize(nbLevels);
+    pyramid->levels[0] = image;
+    for (std::size_t i = 1; i < nbLevels; ++i)
+      ImageHalfSample(pyramid->levels[i - 1], pyramid->levels[i]);
+    return pyramid;
+  }
+
+  /// Find a pyramid in memory or in the spill directory (the cache mutex must be held)
+  std::shared_ptr<const ImagePyramid<T>> findLocked(std::size_t hash)
+  {
+    const typename std::map<std::size_t, Entry>::iterator it = _entries.find(hash);
+    if (it != _entries.end())
+    {
+      // move the entry to the front of the LRU list
+      _lru.erase(it->second.lruIt);
+      _lru.push_front(hash);
+      it->second.lruIt = _lru.begin();
+      return it->second.pyramid;
+    }
+
+    std::shared_ptr<ImagePyramid<T>> spilled = loadSpilled(hash);
+    if (spilled)
+    {
+      insertLocked(hash, spilled);
+      return spilled;
+    }
+    return nullptr;
+  }
+
+  /// Insert a pyramid and evict back to the memory budget (the cache mutex must be held)
+  void insertLocked(std::size_t hash, const std::shared_ptr<const ImagePyramid<T>>& pyramid)
+  {
+    _lru.push_front(hash);
+    _entries[hash] = Entry{pyramid, _lru.begin()};
+    _usedMemory += pyramid->memorySize();
+
+    while (_usedMemory > _maxMemory && _entries.size() > 1)
+    {
+      const std::size_t evictedHash = _lru.back();
+      const typename std::map<std::size_t, Entry>::iterator it = _entries.find(evictedHash);
+      spill(evictedHash, *it->second.pyramid);
+      _usedMemory -= it->second.pyramid->memorySize();
+      _entries.erase(it);
+      _lru.pop_back();
+    }
+  }
+
+  std::string spillPath(std::size_t hash) const
+  {
+    return _spillDirectory + "/imagePyramid_" + std::to_string(hash) + ".bin";
+  }
+
+  /// Write an evicted pyramid to the spill directory, if any
+  void spill(std::size_t hash, const ImagePyramid<T>& pyramid) const
+  {
+    if (_spillDirectory.empty())
+      return;
+
+    std::ofstream file(spillPath(hash), std::ios::binary);
+    if (!file)
+      return;
+
+    const std::size_t nbLevels = pyramid.levels.size();
+    file.write(reinterpret_cast<const char*>(&hash), sizeof(hash));
+    file.write(reinterpret_cast<const char*>(&nbLevels), sizeof(nbLevels));
+    for (std::size_t i = 0; i < nbLevels; ++i)
+    {
+      const Image<T>& level = pyramid.levels[i];
+      const int width = level.Width();
+      const int height = level.Height();
+      file.write(reinterpret_cast<const char*>(&width), sizeof(width));
+      file.write(reinterpret_cast<const char*>(&height), sizeof(height));
+      file.write(reinterpret_cast<const char*>(level.data()), std::size_t(width) * height * sizeof(T));
+    }
+  }
+
+  /// Reload a spilled pyramid; the file is removed once loaded
+  std::shared_ptr<ImagePyramid<T>> loadSpilled(std::size_t hash) const
+  {
+    if (_spillDirectory.empty())
+      return nullptr;
+
+    std::ifstream file(spillPath(hash), std::ios::binary);
+    if (!file)
+      return nullptr;
+
+    std::size_t fileHash = 0;
+    std::size_t nbLevels = 0;
+    file.read(reinterpret_cast<char*>(&fileHash), sizeof(fileHash));
+    file.read(reinterpret_cast<char*>(&nbLevels), sizeof(nbLevels));
+    if (!file || fileHash != hash)
+      return nullptr;
+
+    std::shared_ptr<ImagePyramid<T>> pyramid = std::make_shared<ImagePyramid<T>>();
+    pyramid->levels.resize(nbLevels);
+    for (std::size_t i = 0; i < nbLevels; ++i)
+    {
+      int width = 0;
+      int height = 0;
+      file.read(reinterpret_cast<char*>(&width), sizeof(width));
+      file.read(reinterpret_cast<char*>(&height), sizeof(height));
+      if (!file || width < 0 || height < 0)
+        return nullptr;
+      pyramid->levels[i].resize(width, height);
+      file.read(reinterpret_cast<char*>(pyramid->levels[i].data()), std::size_t(width) * height * sizeof(T));
+    }
+    if (!file)
+      return nullptr;
+
+    file.close();
+    std::remove(spillPath(hash).c_str());
+    return pyramid;
+  }
+
+  mutable std::mutex _mutex;
+  std::size_t _maxMemory;
+  std::string _spillDirectory;
+  std::map<std::size_t, Entry> _entries;
+  std::list<std::size_t> _lru; // most recently used first
+  std::size_t _usedMemory = 0;
+  system::MemoryGovernor::ClientId _governorClientId = system::MemoryGovernor::kNoClient;
+};
+
+} // namespace image
+} // namespace aliceVision
@@ -5,9 +5,191 @@
 
 #include "convolution.hpp"
 
+#include <aliceVision/system/cpuDispatch.hpp>
+
+#include <algorithm>
+#include <cstddef>
+
+#if defined(ALICEVISION_CPU_DISPATCH_X86)
+#include <immintrin.h>
+#endif
+
 namespace aliceVision {
 namespace image {
 
+namespace {
+
+// Correlation of one padded row with the horizontal kernel:
+// out[x] = sum_k kernel[k] * in[x + k]
+
+void convolveRow_scalar(const float* in, const float* kernel, int kernelSize, float* out, int outSize)
+{
+  for(int x = 0; x < outSize; ++x)
+  {
+    float sum = kernel[0] * in[x];
+    for(int k = 1; k < kernelSize; ++k)
+      sum += kernel[k] * in[x + k];
+    out[x] = sum;
+  }
+}
+
+#if defined(ALICEVISION_CPU_DISPATCH_X86)
+
+ALICEVISION_TARGET_SSE4
+void convolveRow_sse4(const float* in, const float* kernel, int kernelSize, float* out, int outSize)
+{
+  int x = 0;
+  for(; x + 4 <= outSize; x += 4)
+  {
+    __m128 sum = _mm_mul_ps(_mm_set1_ps(kernel[0]), _mm_loadu_ps(in + x));
+    for(int k = 1; k < kernelSize; ++k)
+      sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(kernel[k]), _mm_loadu_ps(in + x + k)));
+    _mm_storeu_ps(out + x, sum);
+  }
+  if(x < outSize)
+    convolveRow_scalar(in + x, kernel, kernelSize, out + x, outSize - x);
+}
+
+ALICEVISION_TARGET_AVX2
+void convolveRow_avx2(const float* in, const float* kernel, int kernelSize, float* out, int outSize)
+{
+  int x = 0;
+  for(; x + 8 <= outSize; x += 8)
+  {
+    __m256 sum = _mm256_mul_ps(_mm256_set1_ps(kernel[0]), _mm256_loadu_ps(in + x));
+    for(int k = 1; k < kernelSize; ++k)
+      sum = _mm256_fmadd_ps(_mm256_set1_ps(kernel[k]), _mm256_loadu_ps(in + x + k), sum);
+    _mm256_storeu_ps(out + x, sum);
+  }
+  if(x < outSize)
+    convolveRow_scalar(in + x, kernel, kernelSize, out + x, outSize - x);
+}
+
+ALICEVISION_TARGET_AVX512
+void convolveRow_avx512(const float* in, const float* kernel, int kernelSize, float* out, int outSize)
+{
+  int x = 0;
+  for(; x + 16 <= outSize; x += 16)
+  {
+    __m512 sum = _mm512_mul_ps(_mm512_set1_ps(kernel[0]), _mm512_loadu_ps(in + x));
+    for(int k = 1; k < kernelSize; ++k)
+      sum = _mm512_fmadd_ps(_mm512_set1_ps(kernel[k]), _mm512_loadu_ps(in + x + k), sum);
+    _mm512_storeu_ps(out + x, sum);
+  }
+  if(x < outSize)
+    convolveRow_scalar(in + x, kernel, kernelSize, out + x, outSize - x);
+}
+
+#endif // ALICEVISION_CPU_DISPATCH_X86
+
+typedef void (*ConvolveRowKernel)(const float*, const float*, int, float*, int);
+
+void convolveRow(const float* in, const float* kernel, int kernelSize, float* out, int outSize)
+{
+#if defined(ALICEVISION_CPU_DISPATCH_X86)
+  static const ConvolveRowKernel kernelFn =
+    system::CpuDispatch<ConvolveRowKernel>(&convolveRow_scalar)
+      .sse4(&convolveRow_sse4)
+      .avx2(&convolveRow_avx2)
+      .avx512(&convolveRow_avx512)
+      .resolve();
+  kernelFn(in, kernel, kernelSize, out, outSize);
+#else
+  convolveRow_scalar(in, kernel, kernelSize, out, outSize);
+#endif
+}
+
+// Vertical combination of three rows with a 3-tap kernel:
+// out[x] = kernel[0] * top[x] + kernel[1] * mid[x] + kernel[2] * bot[x]
+
+void combineRows3_scalar(const float* top, const float* mid, const float* bot,
+                         const float* kernel, float* out, int size)
+{
+  for(int x = 0; x < size; ++x)
+    out[x] = kernel[0] * top[x] + kernel[1] * mid[x] + kernel[2] * bot[x];
+}
+
+#if defined(ALICEVISION_CPU_DISPATCH_X86)
+
+ALICEVISION_TARGET_SSE4
+void combineRows3_sse4(const float* top, const float* mid, const float* bot,
+                       const float* kernel, float* out, int size)
+{
+  const __m128 k0 = _mm_set1_ps(kernel[0]);
+  const __m128 k1 = _mm_set1_ps(kernel[1]);
+  const __m128 k2 = _mm_set1_ps(kernel[2]);
+  int x = 0;
+  for(; x + 4 <= size; x += 4)
+  {
+    __m128 sum = _mm_mul_ps(k0, _mm_loadu_ps(top + x));
+    sum = _mm_add_ps(sum, _mm_mul_ps(k1, _mm_loadu_ps(mid + x)));
+    sum = _mm_add_ps(sum, _mm_mul_ps(k2, _mm_loadu_ps(bot + x)));
+    _mm_storeu_ps(out + x, sum);
+  }
+  if(x < size)
+    combineRows3_scalar(top + x, mid + x, bot + x, kernel, out + x, size - x);
+}
+
+ALICEVISION_TARGET_AVX2
+void combineRows3_avx2(const float* top, const float* mid, const float* bot,
+                       const float* kernel, float* out, int size)
+{
+  const __m256 k0 = _mm256_set1_ps(kernel[0]);
+  const __m256 k1 = _mm256_set1_ps(kernel[1]);
+  const __m256 k2 = _mm256_set1_ps(kernel[2]);
+  int x = 0;
+  for(; x + 8 <= size; x += 8)
+  {
+    __m256 sum = _mm256_mul_ps(k0, _mm256_loadu_ps(top + x));
+    sum = _mm256_fmadd_ps(k1, _mm256_loadu_ps(mid + x), sum);
+    sum = _mm256_fmadd_ps(k2, _mm256_loadu_ps(bot + x), sum);
+    _mm256_storeu_ps(out + x, sum);
+  }
+  if(x < size)
+    combineRows3_scalar(top + x, mid + x, bot + x, kernel, out + x, size - x);
+}
+
+ALICEVISION_TARGET_AVX512
+void combineRows3_avx512(const float* top, const float* mid, const float* bot,
+                         const float* kernel, float* out, int size)
+{
+  const __m512 k0 = _mm512_set1_ps(kernel[0]);
+  const __m512 k1 = _mm512_set1_ps(kernel[1]);
+  const __m512 k2 = _mm512_set1_ps(kernel[2]);
+  int x = 0;
+  for(; x + 16 <= size; x += 16)
+  {
+    __m512 sum = _mm512_mul_ps(k0, _mm512_loadu_ps(top + x));
+    sum = _mm512_fmadd_ps(k1, _mm512_loadu_ps(mid + x), sum);
+    sum = _mm512_fmadd_ps(k2, _mm512_loadu_ps(bot + x), sum);
+    _mm512_storeu_ps(out + x, sum);
+  }
+  if(x < size)
+    combineRows3_scalar(top + x, mid + x, bot + x, kernel, out + x, size - x);
+}
+
+#endif // ALICEVISION_CPU_DISPATCH_X86
+
+typedef void (*CombineRows3Kernel)(const float*, const float*, const float*, const float*, float*, int);
+
+void combineRows3(const float* top, const float* mid, const float* bot,
+                  const float* kernel, float* out, int size)
+{
+#if defined(ALICEVISION_CPU_DISPATCH_X86)
+  static const CombineRows3Kernel kernelFn =
+    system::CpuDispatch<CombineRows3Kernel>(&combineRows3_scalar)
+      .sse4(&combineRows3_sse4)
+      .avx2(&combineRows3_avx2)
+      .avx512(&combineRows3_avx512)
+      .resolve();
+  kernelFn(top, mid, bot, kernel, out, size);
+#else
+  combineRows3_scalar(top, mid, bot, kernel, out, size);
+#endif
+}
+
+} // namespace
+
 void SeparableConvolution2d(const RowMatrixXf& image,
                             const Eigen::Matrix<float, 1, Eigen::Dynamic>& kernel_x,
                             const Eigen::Matrix<float, 1, Eigen::Dynamic>& kernel_y,
@@ -66,14 +248,92 @@ void SeparableConvolution2d(const RowMatrixXf& image,
       .segment(image.cols() - 2 - half_sigma_x, half_sigma_x)
       .reverse();
 
-    // Convolve the row. We perform the first step here explicitly so that we
-    // avoid setting the row equal to zero.
-    out->row(row) = kernel_x(0) * temp_row.head(image.cols());
-    for (int i = 1; i < sigma_x; i++) {
-      out->row(row) += kernel_x(i) * temp_row.segment(i, image.cols());
+    // Convolve the padded row, resolved once to the widest instruction set
+    // of the host (out is row major so the output row is contiguous).
+    convolveRow(temp_row.data(), kernel_x.data(), sigma_x,
+                out->data() + row * out->cols(), static_cast<int>(image.cols()));
+  }
+}
+
+void SeparableConvolution2d3x3(const RowMatrixXf& image,
+                               const float* kernel_x,
+                               const float* kernel_y,
+                               RowMatrixXf* out)
+{
+  const int rows = static_cast<int>(image.rows());
+  const int cols = static_cast<int>(image.cols());
+
+  if(rows < 2 || cols < 3)
+  {
+    // too small for the mirrored borders, go through the generic path
+    Eigen::Matrix<float, 1, Eigen::Dynamic> kx(3), ky(3);
+    for(int k = 0; k < 3; ++k)
+    {
+      kx(k) = kernel_x[k];
+      ky(k) = kernel_y[k];
+    }
+    SeparableConvolution2d(image, kx, ky, out);
+    return;
+  }
+
+  // Fused pass: each output row combines its three source rows with the
+  // vertical taps into a padded buffer and convolves it horizontally, so the
+  // vertically filtered intermediate image is never materialized.
+  #pragma omp parallel
+  {
+    Eigen::RowVectorXf paddedRow(cols + 2);
+
+    #pragma omp for schedule(dynamic, 64)
+    for(int row = 0; row < rows; ++row)
+    {
+      const float* mid = image.data() + std::ptrdiff_t(row) * cols;
+      const float* top = (row == 0) ? mid + cols : mid - cols;          // mirrored borders
+      const float* bot = (row == rows - 1) ? mid - cols : mid + cols;
+      combineRows3(top, mid, bot, kernel_y, paddedRow.data() + 1, cols);
+      paddedRow(0) = paddedRow(2);
+      paddedRow(cols + 1) = paddedRow(cols - 1);
+      convolveRow(paddedRow.data(), kernel_x, 3,
+                  out->data() + std::ptrdiff_t(row) * cols, cols);
     }
   }
 }
 
+void HorizontalConvolution3(const RowMatrixXf& image, const float* kernel, RowMatrixXf* out)
+{
+  const int rows = static_cast<int>(image.rows());
+  const int cols = static_cast<int>(image.cols());
+
+  #pragma omp parallel
+  {
+    Eigen::RowVectorXf paddedRow(cols + 2);
+
+    #pragma omp for schedule(dynamic, 64)
+    for(int row = 0; row < rows; ++row)
+    {
+      const float* in = image.data() + std::ptrdiff_t(row) * cols;
+      std::copy(in, in + cols, paddedRow.data() + 1);
+      paddedRow(0) = in[0];                                             // replicated borders
+      paddedRow(cols + 1) = in[cols - 1];
+      convolveRow(paddedRow.data(), kernel, 3,
+                  out->data() + std::ptrdiff_t(row) * cols, cols);
+    }
+  }
+}
+
+void VerticalConvolution3(const RowMatrixXf& image, const float* kernel, RowMatrixXf* out)
+{
+  const int rows = static_cast<int>(image.rows());
+  const int cols = static_cast<int>(image.cols());
+
+  #pragma omp parallel for schedule(dynamic, 64)
+  for(int row = 0; row < rows; ++row)
+  {
+    const float* mid = image.data() + std::ptrdiff_t(row) * cols;
+    const float* top = (row == 0) ? mid : mid - cols;                   // replicated borders
+    const float* bot = (row == rows - 1) ? mid : mid + cols;
+    combineRows3(top, mid, bot, kernel, out->data() + std::ptrdiff_t(row) * cols, cols);
+  }
+}
+
 } // namespace image
 } // namespace aliceVision
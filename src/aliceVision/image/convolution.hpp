@@ -44,6 +44,7 @@ void ImageConvolution( const Image & img , const Mat & kernel , Image & out)
 
   out.resize( img.Width() , img.Height() ) ;
 
+  #pragma omp parallel for schedule(dynamic)
   for( int row = 0 ; row < img.rows() ; ++row )
   {
     for( int col = 0 ; col < img.cols() ; ++col )
@@ -169,21 +170,118 @@ void ImageVerticalConvolution( const ImageTypeIn & img , const Kernel & kernel ,
  ** @param vert_k vertical kernel
  ** @param out output image
  **/
+/**
+ ** Separable 2D convolution processed in parallel horizontal bands
+ ** (nxm kernel is replaced by two 1D convolution of (size n then size m) )
+ ** Each band horizontally convolves the rows it needs into a small per-band
+ ** buffer and immediately convolves them vertically into the output, so the
+ ** working set stays cache-sized and the full intermediate image of the two
+ ** sequential passes is never written.
+ ** @param img source image
+ ** @param horiz_k horizontal kernel
+ ** @param vert_k vertical kernel
+ ** @param out output image
+ **/
+template< typename ImageType, typename Kernel >
+void ImageSeparableConvolutionTiled( const ImageType & img ,
+                                     const Kernel & horiz_k ,
+                                     const Kernel & vert_k ,
+                                     ImageType & out)
+{
+  // Cast the Kernel to the appropriate type
+  typedef typename ImageType::Tpixel pix_t;
+  typedef typename Accumulator< pix_t >::Type acc_pix_t ;
+  typedef Eigen::Matrix<acc_pix_t, Eigen::Dynamic, 1> VecKernel;
+  const VecKernel horiz_k_cast = horiz_k.template cast< acc_pix_t >();
+  const VecKernel vert_k_cast = vert_k.template cast< acc_pix_t >();
+
+  const int rows = img.rows() ;
+  const int cols = img.cols() ;
+  const int horiz_kernel_width = horiz_k_cast.size() ;
+  const int half_horiz_kernel_width = horiz_kernel_width / 2 ;
+  const int vert_kernel_width = vert_k_cast.size() ;
+  const int half_vert_kernel_width = vert_kernel_width / 2 ;
+
+  out.resize( cols , rows ) ;
+
+  if( rows == 0 || cols == 0 )
+    return ;
+
+  // Height of a band: the band buffer (band rows plus the vertical kernel
+  // margin, horizontally convolved) should stay cache resident
+  const int target_band_bytes = 256 * 1024 ;
+  int band_rows = target_band_bytes / (int) ( sizeof( pix_t ) * cols + 1 ) ;
+  band_rows = std::max( band_rows , vert_kernel_width ) ;
+  band_rows = std::min( band_rows , rows ) ;
+  const int num_bands = ( rows + band_rows - 1 ) / band_rows ;
+
+  #pragma omp parallel for schedule(dynamic)
+  for( int band = 0 ; band < num_bands ; ++band )
+  {
+    const int band_start = band * band_rows ;
+    const int band_end = std::min( band_start + band_rows , rows ) ;
+    const int buffer_rows = ( band_end - band_start ) + vert_kernel_width - 1 ;
+
+    std::vector<pix_t, Eigen::aligned_allocator<pix_t> > buffer( (size_t) buffer_rows * cols ) ;
+    std::vector<pix_t, Eigen::aligned_allocator<pix_t> > line( cols + horiz_kernel_width ) ;
+    std::vector<acc_pix_t, Eigen::aligned_allocator<acc_pix_t> > acc_row( cols ) ;
+
+    // Horizontally convolve the rows this band needs (border rows are clamped)
+    for( int k = 0 ; k < buffer_rows ; ++k )
+    {
+      int row = band_start + k - half_vert_kernel_width ;
+      row = row < 0 ? 0 : ( row >= rows ? rows - 1 : row ) ;
+
+      const pix_t start_pix = img.coeffRef( row , 0 ) ;
+      for( int i = 0 ; i < half_horiz_kernel_width ; ++i ) // pad before
+      {
+        line[ i ] = start_pix ;
+      }
+      memcpy(&line[0] + half_horiz_kernel_width, img.data() + row * cols, sizeof(pix_t) * cols);
+      const pix_t end_pix = img.coeffRef( row , cols - 1 ) ;
+      for( int i = 0 ; i < half_horiz_kernel_width ; ++i ) // pad after
+      {
+        line[ i + half_horiz_kernel_width + cols ] = end_pix ;
+      }
+
+      conv_buffer_( &line[0] , horiz_k_cast.data() , cols , horiz_kernel_width ) ;
+
+      memcpy(&buffer[ (size_t) k * cols ], &line[0], sizeof(pix_t) * cols);
+    }
+
+    // Vertically convolve the band into the output, tap by tap over contiguous
+    // rows so the inner loops vectorize
+    for( int row = band_start ; row < band_end ; ++row )
+    {
+      pix_t * out_row = out.data() + (size_t) row * cols ;
+      const pix_t * buf_row = &buffer[ (size_t) ( row - band_start ) * cols ] ;
+      for( int col = 0 ; col < cols ; ++col )
+      {
+        acc_row[ col ] = buf_row[ col ] * vert_k_cast( 0 ) ;
+      }
+      for( int t = 1 ; t < vert_kernel_width ; ++t )
+      {
+        buf_row = &buffer[ (size_t) ( row - band_start + t ) * cols ] ;
+        for( int col = 0 ; col < cols ; ++col )
+        {
+          acc_row[ col ] += buf_row[ col ] * vert_k_cast( t ) ;
+        }
+      }
+      for( int col = 0 ; col < cols ; ++col )
+      {
+        out_row[ col ] = acc_row[ col ] ;
+      }
+    }
+  }
+}
+
 template< typename ImageType, typename Kernel >
 void ImageSeparableConvolution( const ImageType & img ,
                                 const Kernel & horiz_k ,
                                 const Kernel & vert_k ,
                                 ImageType & out)
 {
-  // Cast the Kernel to the appropriate type
-  typedef typename ImageType::Tpixel pix_t;
-  typedef Eigen::Matrix<typename Accumulator<pix_t>::Type, Eigen::Dynamic, 1> VecKernel;
-  const VecKernel horiz_k_cast = horiz_k.template cast< typename Accumulator<pix_t>::Type >();
-  const VecKernel vert_k_cast = vert_k.template cast< typename Accumulator<pix_t>::Type >();
-
-  ImageType tmp ;
-  ImageHorizontalConvolution( img , horiz_k_cast , tmp ) ;
-  ImageVerticalConvolution( tmp , vert_k_cast , out ) ;
+  ImageSeparableConvolutionTiled( img , horiz_k , vert_k , out ) ;
 }
 
 typedef Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> RowMatrixXf;
@@ -194,6 +292,25 @@ void SeparableConvolution2d(const RowMatrixXf& image,
                             const Eigen::Matrix<float, 1, Eigen::Dynamic>& kernel_y,
                             RowMatrixXf* out);
 
+/// Fused 3x3 specialization of SeparableConvolution2d (the derivative
+/// stencils: Sobel, Scharr, ...): each output row combines its three source
+/// rows with the vertical taps and convolves the result horizontally in one
+/// multithreaded pass, with the row kernels resolved at runtime to the widest
+/// instruction set of the host. Borders are mirrored as in
+/// SeparableConvolution2d. The 3-tap kernels are given as arrays of 3 floats.
+void SeparableConvolution2d3x3(const RowMatrixXf& image,
+                               const float* kernel_x,
+                               const float* kernel_y,
+                               RowMatrixXf* out);
+
+/// 3-tap horizontal convolution of a float image with replicated borders,
+/// matching ImageHorizontalConvolution but multithreaded and vectorized
+void HorizontalConvolution3(const RowMatrixXf& image, const float* kernel, RowMatrixXf* out);
+
+/// 3-tap vertical convolution of a float image with replicated borders,
+/// matching ImageVerticalConvolution but multithreaded and vectorized
+void VerticalConvolution3(const RowMatrixXf& image, const float* kernel, RowMatrixXf* out);
+
 // Specialization for Image<float> in order to use SeparableConvolution2d
 template<typename Kernel>
 void ImageSeparableConvolution( const Image<float> & img ,
@@ -208,6 +325,15 @@ void ImageSeparableConvolution( const Image<float> & img ,
   const VecKernel vert_k_cast = vert_k.template cast< typename aliceVision::Accumulator<pix_t>::Type >();
 
   out.resize(img.Width(), img.Height());
+
+  // 3x3 stencils (derivative filters mostly) go through the fused one-pass kernel
+  if(horiz_k_cast.size() == 3 && vert_k_cast.size() == 3)
+  {
+    SeparableConvolution2d3x3(img.GetMat(), horiz_k_cast.data(), vert_k_cast.data(),
+                              &((Image<float>::Base&)out));
+    return;
+  }
+
   SeparableConvolution2d(img.GetMat(), horiz_k_cast, vert_k_cast, &((Image<float>::Base&)out));
 }
 
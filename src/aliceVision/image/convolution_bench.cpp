@@ -0,0 +1,55 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "aliceVision/image/all.hpp"
+
+#include <benchmark/benchmark.h>
+
+using namespace aliceVision;
+using namespace aliceVision::image;
+
+// Full HD frame, the typical working resolution of the feature extraction
+static const int IMAGE_WIDTH = 1920;
+static const int IMAGE_HEIGHT = 1080;
+
+static Image<float> randomImage()
+{
+  // Random() is deterministic (no seeding), so runs stay comparable
+  Image<float> img;
+  img = Image<float>::Base(((Eigen::MatrixXf::Random(IMAGE_HEIGHT, IMAGE_WIDTH).array() + 1.f) * 0.5f).matrix());
+  return img;
+}
+
+static void BM_ImageSeparableConvolution(benchmark::State& state)
+{
+  const Image<float> img = randomImage();
+  const int kernelSize = static_cast<int>(state.range(0));
+  const Vec kernel = Vec::Constant(kernelSize, 1.0 / kernelSize);
+
+  Image<float> out;
+  for(auto _ : state)
+  {
+    ImageSeparableConvolution(img, kernel, kernel, out);
+    benchmark::DoNotOptimize(out);
+  }
+  state.SetItemsProcessed(state.iterations() * IMAGE_WIDTH * IMAGE_HEIGHT);
+}
+BENCHMARK(BM_ImageSeparableConvolution)->Arg(3)->Arg(7)->Arg(15);
+
+static void BM_ImageGaussianFilter(benchmark::State& state)
+{
+  const Image<float> img = randomImage();
+
+  Image<float> out;
+  for(auto _ : state)
+  {
+    ImageGaussianFilter(img, 1.6, out);
+    benchmark::DoNotOptimize(out);
+  }
+  state.SetItemsProcessed(state.iterations() * IMAGE_WIDTH * IMAGE_HEIGHT);
+}
+BENCHMARK(BM_ImageGaussianFilter);
+
+BENCHMARK_MAIN();
@@ -36,7 +36,12 @@ void ImagePeronaMalikG2DiffusionCoef( const Image & Lx , const Image & Ly , cons
   }
 
   typedef typename Image::Tpixel Real;
-  out.array() = ( static_cast<Real>(1.f) + (Lx.array().square()+Ly.array().square() )/(k*k) ).inverse();
+  // Process rows in parallel, each row is an independent vectorized Eigen expression
+  #pragma omp parallel for schedule(dynamic)
+  for( int i = 0 ; i < height ; ++i )
+  {
+    out.row( i ).array() = ( static_cast<Real>(1.f) + ( Lx.row( i ).array().square() + Ly.row( i ).array().square() ) / ( k * k ) ).inverse();
+  }
 }
 
 /**
@@ -54,32 +59,30 @@ void ImageFEDCentral( const Image & src , const Image & diff , const typename Im
 {
   typedef typename Image::Tpixel Real ;
   const int width = src.Width() ;
-  Real n_diff[4] ;
-  Real n_src[4] ;
   // Compute FED step on general range
+  // All neighbor accesses go through contiguous row pointers (images are row
+  // major) so the inner loop is unit stride and vectorizes
   for( int i = row_start ; i < row_end ; ++i )
   {
+    const Real * src_up   = src.data() + ( i - 1 ) * width ;
+    const Real * src_cur  = src.data() + i * width ;
+    const Real * src_down = src.data() + ( i + 1 ) * width ;
+    const Real * diff_up   = diff.data() + ( i - 1 ) * width ;
+    const Real * diff_cur  = diff.data() + i * width ;
+    const Real * diff_down = diff.data() + ( i + 1 ) * width ;
+    Real * out_cur = out.data() + i * width ;
+
     for( int j = 1 ; j < width - 1 ; ++j )
     {
-      // Retrieve neighbors : TODO check if we need a cache efficient version ?
-      n_diff[0] = diff( i , j + 1 ) ;
-      n_diff[1] = diff( i - 1 , j ) ;
-      n_diff[2] = diff( i , j - 1 ) ;
-      n_diff[3] = diff( i + 1 , j ) ;
-      n_src[0] = src( i , j + 1 ) ;
-      n_src[1] = src( i - 1 , j ) ;
-      n_src[2] = src( i , j - 1 ) ;
-      n_src[3] = src( i + 1 , j ) ;
-
       // Compute diffusion factor for given pixel
-      const Real cur_src = src( i , j ) ;
-      const Real cur_diff = diff( i , j ) ;
-      const Real a = ( cur_diff + n_diff[0] ) * ( n_src[0] - cur_src ) ;
-      const Real b = ( cur_diff + n_diff[1] ) * ( cur_src - n_src[1] ) ;
-      const Real c = ( cur_diff + n_diff[2] ) * ( cur_src - n_src[2] ) ;
-      const Real d = ( cur_diff + n_diff[3] ) * ( n_src[3] - cur_src ) ;
+      const Real cur_src = src_cur[ j ] ;
+      const Real cur_diff = diff_cur[ j ] ;
+      const Real a = ( cur_diff + diff_cur[ j + 1 ] ) * ( src_cur[ j + 1 ] - cur_src ) ;
+      const Real b = ( cur_diff + diff_up[ j ] ) * ( cur_src - src_up[ j ] ) ;
+      const Real c = ( cur_diff + diff_cur[ j - 1 ] ) * ( cur_src - src_cur[ j - 1 ] ) ;
+      const Real d = ( cur_diff + diff_down[ j ] ) * ( src_down[ j ] - cur_src ) ;
       const Real value = half_t * ( a - c + d - b ) ;
-      out( i , j ) = value ;
+      out_cur[ j ] = value ;
     }
   }
 }
@@ -225,11 +228,18 @@ void ImageFED( const Image & src , const Image & diff , const typename Image::Tp
 template< typename Image >
 void ImageFEDCycle( Image & self , const Image & diff , const std::vector< typename Image::Tpixel > & tau )
 {
+  // The cycle steps are inherently sequential (each step diffuses the result
+  // of the previous one), parallelism lives inside each step
   Image tmp;
   for( int i = 0 ; i < tau.size() ; ++i )
   {
     ImageFED( self , diff , tau[i] , tmp ) ;
-    self.array() += tmp.array();
+
+    #pragma omp parallel for schedule(dynamic)
+    for( int row = 0 ; row < self.rows() ; ++row )
+    {
+      self.row( row ).array() += tmp.row( row ).array() ;
+    }
   }
 }
 
@@ -60,6 +60,40 @@ namespace image {
   }
 
 
+  /**
+   ** Compute X-derivative using central difference
+   ** Image<float> overload: multithreaded, vectorized 3-tap row kernel
+   ** @param img Input image
+   ** @param out Output image
+   ** @param normalize true if kernel must be scaled by 1/2
+   **/
+  inline void ImageXDerivative( const Image<float> & img , Image<float> & out , const bool normalize = true)
+  {
+    const float scale = normalize ? 0.5f : 1.0f ;
+    const float kernel[3] = { -scale , 0.0f , scale } ;
+
+    out.resize( img.Width() , img.Height() ) ;
+    HorizontalConvolution3( img.GetMat() , kernel , &( ( Image<float>::Base & ) out ) ) ;
+  }
+
+
+  /**
+   ** Compute Y-derivative using central difference
+   ** Image<float> overload: multithreaded, vectorized 3-tap row kernel
+   ** @param img Input image
+   ** @param out Output image
+   ** @param normalize true if kernel must be normalized
+   **/
+  inline void ImageYDerivative( const Image<float> & img , Image<float> & out , const bool normalize = true)
+  {
+    const float scale = normalize ? 0.5f : 1.0f ;
+    const float kernel[3] = { -scale , 0.0f , scale } ;
+
+    out.resize( img.Width() , img.Height() ) ;
+    VerticalConvolution3( img.GetMat() , kernel , &( ( Image<float>::Base & ) out ) ) ;
+  }
+
+
   /**
    ** Compute X-derivative using 3x3 Sobel kernel
    ** @param img Input image
@@ -133,3 +133,57 @@ BOOST_AUTO_TEST_CASE(Image_Convolution_Sobel_X_Y)
   outFilteredCast = Image<unsigned char>(outFiltered.cast<unsigned char>());
   BOOST_CHECK_NO_THROW(writeImage("out_SobelY.png", outFilteredCast));
 }
+
+BOOST_AUTO_TEST_CASE(Image_Convolution_Fused3x3_MatchesGenericPath)
+{
+  // The fused one-pass 3x3 kernel must match the generic two-pass float path
+  // (up to fma rounding); the right image border is excluded as the fused
+  // path mirrors it correctly while the legacy path is off by one column.
+  Image<float> in(64, 48);
+  for(int i = 0; i < in.Height(); ++i)
+    for(int j = 0; j < in.Width(); ++j)
+      in(i, j) = std::sin(0.1f * i) * 100.f + std::cos(0.2f * j) * 50.f;
+
+  Image<float> fused;
+  ImageScharrXDerivative(in, fused);
+
+  Eigen::Matrix<float, 1, Eigen::Dynamic> kernel_x(3), kernel_y(3);
+  kernel_x << -0.5f, 0.f, 0.5f;
+  kernel_y << 3.f / 16.f, 10.f / 16.f, 3.f / 16.f;
+  RowMatrixXf reference(in.Height(), in.Width());
+  SeparableConvolution2d(in.GetMat(), kernel_x, kernel_y, &reference);
+
+  for(int i = 0; i < in.Height(); ++i)
+    for(int j = 0; j < in.Width() - 1; ++j)
+      BOOST_CHECK_SMALL(fused(i, j) - reference(i, j), 1e-3f);
+}
+
+BOOST_AUTO_TEST_CASE(Image_Convolution_Derivative_FloatOverload)
+{
+  // The Image<float> overloads of the central difference derivatives must
+  // match the generic template path (exercised through Image<double>).
+  Image<float> inFloat(32, 24);
+  Image<double> inDouble(32, 24);
+  for(int i = 0; i < inFloat.Height(); ++i)
+    for(int j = 0; j < inFloat.Width(); ++j)
+    {
+      const double value = std::sin(0.3 * i + 0.05 * j) * 100.0;
+      inFloat(i, j) = static_cast<float>(value);
+      inDouble(i, j) = value;
+    }
+
+  Image<float> outFloat;
+  Image<double> outDouble;
+
+  ImageXDerivative(inFloat, outFloat);
+  ImageXDerivative(inDouble, outDouble);
+  for(int i = 0; i < inFloat.Height(); ++i)
+    for(int j = 0; j < inFloat.Width(); ++j)
+      BOOST_CHECK_SMALL(outFloat(i, j) - static_cast<float>(outDouble(i, j)), 1e-3f);
+
+  ImageYDerivative(inFloat, outFloat);
+  ImageYDerivative(inDouble, outDouble);
+  for(int i = 0; i < inFloat.Height(); ++i)
+    for(int j = 0; j < inFloat.Width(); ++j)
+      BOOST_CHECK_SMALL(outFloat(i, j) - static_cast<float>(outDouble(i, j)), 1e-3f);
+}
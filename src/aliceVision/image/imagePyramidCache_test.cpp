@@ -0,0 +1,103 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "aliceVision/image/ImagePyramidCache.hpp"
+#include "aliceVision/image/resampling.hpp"
+
+#define BOOST_TEST_MODULE imagePyramidCache
+#include <boost/test/included/unit_test.hpp>
+
+#include <cstdio>
+
+using namespace aliceVision;
+using namespace aliceVision::image;
+
+namespace {
+
+Image<unsigned char> makeTestImage(int width, int height, int seed)
+{
+  Image<unsigned char> image(width, height);
+  for (int i = 0; i < height; ++i)
+    for (int j = 0; j < width; ++j)
+      image(i, j) = static_cast<unsigned char>((i * 31 + j * 7 + seed) % 256);
+  return image;
+}
+
+bool sameImage(const Image<unsigned char>& a, const Image<unsigned char>& b)
+{
+  if (a.Width() != b.Width() || a.Height() != b.Height())
+    return false;
+  for (int i = 0; i < a.Height(); ++i)
+    for (int j = 0; j < a.Width(); ++j)
+      if (a(i, j) != b(i, j))
+        return false;
+  return true;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(ImagePyramidCache_buildAndHit)
+{
+  const Image<unsigned char> image = makeTestImage(64, 48, 0);
+
+  ImagePyramidCache<unsigned char> cache;
+  const std::shared_ptr<const ImagePyramid<unsigned char>> pyramid = cache.get("imageA", image, 3);
+
+  // the levels match the repeated half sampling of the base image
+  BOOST_CHECK_EQUAL(3, pyramid->levels.size());
+  Image<unsigned char> expected = image;
+  for (std::size_t level = 0; level < pyramid->levels.size(); ++level)
+  {
+    BOOST_CHECK_EQUAL(expected.Width(), pyramid->levels[level].Width());
+    BOOST_CHECK_EQUAL(expected.Height(), pyramid->levels[level].Height());
+    BOOST_CHECK(sameImage(expected, pyramid->levels[level]));
+    Image<unsigned char> half;
+    ImageHalfSample(expected, half);
+    expected = half;
+  }
+
+  // a second query for the same key reuses the cached pyramid
+  BOOST_CHECK(pyramid == cache.get("imageA", image, 3));
+  BOOST_CHECK_EQUAL(1, cache.nbPyramids());
+
+  // an other level count is an other pyramid
+  BOOST_CHECK(pyramid != cache.get("imageA", image, 2));
+  BOOST_CHECK_EQUAL(2, cache.nbPyramids());
+}
+
+BOOST_AUTO_TEST_CASE(ImagePyramidCache_memoryBudgetEviction)
+{
+  const Image<unsigned char> imageA = makeTestImage(64, 48, 0);
+  const Image<unsigned char> imageB = makeTestImage(64, 48, 1);
+
+  // budget holding a single pyramid: inserting the second evicts the first
+  ImagePyramidCache<unsigned char> cache(5 * 1024);
+  cache.get("imageA", imageA, 2);
+  BOOST_CHECK_EQUAL(1, cache.nbPyramids());
+  cache.get("imageB", imageB, 2);
+  BOOST_CHECK_EQUAL(1, cache.nbPyramids());
+  BOOST_CHECK(cache.usedMemory() <= 5 * 1024);
+
+  // without a spill directory the evicted pyramid is rebuilt
+  const std::shared_ptr<const ImagePyramid<unsigned char>> rebuilt = cache.get("imageA", imageA, 2);
+  BOOST_CHECK(sameImage(imageA, rebuilt->levels[0]));
+}
+
+BOOST_AUTO_TEST_CASE(ImagePyramidCache_diskSpill)
+{
+  const Image<unsigned char> imageA = makeTestImage(64, 48, 0);
+  const Image<unsigned char> imageB = makeTestImage(64, 48, 1);
+
+  ImagePyramidCache<unsigned char> cache(5 * 1024, ".");
+  const std::shared_ptr<const ImagePyramid<unsigned char>> pyramidA = cache.get("imageA", imageA, 3);
+  cache.get("imageB", imageB, 3); // evicts and spills imageA
+
+  // the spilled pyramid is reloaded from disk with the same content
+  const std::shared_ptr<const ImagePyramid<unsigned char>> reloaded = cache.get("imageA", imageA, 3);
+  BOOST_CHECK(reloaded != pyramidA);
+  BOOST_CHECK_EQUAL(pyramidA->levels.size(), reloaded->levels.size());
+  for (std::size_t level = 0; level < reloaded->levels.size(); ++level)
+    BOOST_CHECK(sameImage(pyramidA->levels[level], reloaded->levels[level]));
+}
@@ -84,3 +84,64 @@ BOOST_AUTO_TEST_CASE(Image_ImageConverter)
   imaColorRGBA.fill(RGBAColor(10,10,10, 255));
   ConvertPixelType(imaColorRGBA, &imaGray);
 }
+
+BOOST_AUTO_TEST_CASE(Image_BulkConverter)
+{
+  // the bulk ConvertPixelType overloads must match the per-pixel Convert
+  Image<RGBColor> imaColorRGB(17, 13);
+  Image<RGBAColor> imaColorRGBA(17, 13);
+  for(int j = 0; j < imaColorRGB.Height(); ++j)
+    for(int i = 0; i < imaColorRGB.Width(); ++i)
+    {
+      const unsigned char v = static_cast<unsigned char>((i * 19 + j * 7) % 256);
+      imaColorRGB(j, i) = RGBColor(v, static_cast<unsigned char>(255 - v), static_cast<unsigned char>(v / 2));
+      imaColorRGBA(j, i) = RGBAColor(v, static_cast<unsigned char>(255 - v), static_cast<unsigned char>(v / 2),
+                                     static_cast<unsigned char>((v * 3) % 256));
+    }
+
+  Image<unsigned char> imaGray;
+  ConvertPixelType(imaColorRGB, &imaGray);
+  for(int j = 0; j < imaColorRGB.Height(); ++j)
+    for(int i = 0; i < imaColorRGB.Width(); ++i)
+    {
+      unsigned char expected;
+      Convert(imaColorRGB(j, i), expected);
+      BOOST_CHECK_EQUAL(expected, imaGray(j, i));
+    }
+
+  ConvertPixelType(imaColorRGBA, &imaGray);
+  Image<RGBColor> imaRGB;
+  ConvertPixelType(imaColorRGBA, &imaRGB);
+  for(int j = 0; j < imaColorRGBA.Height(); ++j)
+    for(int i = 0; i < imaColorRGBA.Width(); ++i)
+    {
+      unsigned char expectedGray;
+      Convert(imaColorRGBA(j, i), expectedGray);
+      BOOST_CHECK_EQUAL(expectedGray, imaGray(j, i));
+      RGBColor expectedRGB;
+      Convert(imaColorRGBA(j, i), expectedRGB);
+      BOOST_CHECK(expectedRGB == imaRGB(j, i));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(Image_SrgbLinear)
+{
+  // linear -> sRGB -> linear must round trip
+  Image<RGBfColor> linear(9, 7);
+  for(int j = 0; j < linear.Height(); ++j)
+    for(int i = 0; i < linear.Width(); ++i)
+      linear(j, i) = RGBfColor((i + j * 9) / 62.f, i / 8.f, j / 6.f);
+
+  Image<RGBfColor> srgb, roundTrip;
+  convertLinear2Srgb(linear, &srgb);
+  convertSrgb2Linear(srgb, &roundTrip);
+
+  for(int j = 0; j < linear.Height(); ++j)
+    for(int i = 0; i < linear.Width(); ++i)
+      for(int channel = 0; channel < 3; ++channel)
+      {
+        BOOST_CHECK_SMALL(linear(j, i)(channel) - roundTrip(j, i)(channel), 1e-5f);
+        // the transfer function keeps [0;1] values inside [0;1]
+        BOOST_CHECK(srgb(j, i)(channel) >= 0.f && srgb(j, i)(channel) <= 1.f);
+      }
+}
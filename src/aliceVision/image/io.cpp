@@ -16,6 +16,7 @@
 #include <stdexcept>
 #include <iostream>
 #include <cmath>
+#include <memory>
 
 namespace oiio = OIIO;
 
@@ -87,12 +88,14 @@ void readImageMetadata(const std::string& path, int& width, int& height, std::ma
   in->close();
 }
 
-template<typename T>
-void readImage(const std::string& path, oiio::TypeDesc format, int nchannels, Image<T>& image)
-{
-  // check requested channels number
-  assert(nchannels == 1 || nchannels >= 3);
+namespace {
 
+/**
+ * @brief get the decode configuration shared by all the read paths
+ * @return The configuration ImageSpec
+ */
+oiio::ImageSpec readConfigSpec()
+{
   oiio::ImageSpec configSpec;
 
   // libRAW configuration
@@ -101,11 +104,20 @@ void readImage(const std::string& path, oiio::TypeDesc format, int nchannels, Im
   configSpec.attribute("raw:ColorSpace", "sRGB");   // want colorspace sRGB
   configSpec.attribute("raw:use_camera_matrix", 3); // want to use embeded color profile
 
-  oiio::ImageBuf inBuf(path, 0, 0, NULL, &configSpec);
-
-  if(!inBuf.initialized())
-    throw std::runtime_error("Can't find/open image file '" + path + "'.");
+  return configSpec;
+}
 
+/**
+ * @brief convert an ImageBuf to the requested channels number and copy it into an Image
+ * @param[in,out] inBuf The input buffer (modified by the channel convertions)
+ * @param[in] path The image path (for error messages)
+ * @param[in] format The requested pixel format
+ * @param[in] nchannels The requested channels number
+ * @param[out] image The output image buffer
+ */
+template<typename T>
+void convertImageBuf(oiio::ImageBuf& inBuf, const std::string& path, oiio::TypeDesc format, int nchannels, Image<T>& image)
+{
   const oiio::ImageSpec& inSpec = inBuf.spec();
 
   // check picture channels number
@@ -159,6 +171,177 @@ void readImage(const std::string& path, oiio::TypeDesc format, int nchannels, Im
   image = Eigen::Map<typename Image<T>::Base>(pixels.data(), inSpec.height, inSpec.width);
 }
 
+} // namespace
+
+template<typename T>
+void readImage(const std::string& path, oiio::TypeDesc format, int nchannels, Image<T>& image)
+{
+  // check requested channels number
+  assert(nchannels == 1 || nchannels >= 3);
+
+  const oiio::ImageSpec configSpec = readConfigSpec();
+
+  oiio::ImageBuf inBuf(path, 0, 0, NULL, &configSpec);
+
+  if(!inBuf.initialized())
+    throw std::runtime_error("Can't find/open image file '" + path + "'.");
+
+  convertImageBuf(inBuf, path, format, nchannels, image);
+}
+
+template<typename T>
+void readImageRegion(const std::string& path, oiio::TypeDesc format, int nchannels,
+                     int xbegin, int ybegin, int width, int height, Image<T>& image)
+{
+  // check requested channels number
+  assert(nchannels == 1 || nchannels >= 3);
+
+  const oiio::ImageSpec configSpec = readConfigSpec();
+
+  oiio::ImageBuf inBuf(path, 0, 0, NULL, &configSpec);
+
+  if(!inBuf.initialized())
+    throw std::runtime_error("Can't find/open image file '" + path + "'.");
+
+  const oiio::ImageSpec& inSpec = inBuf.spec();
+
+  // check requested region
+  if(xbegin < 0 || ybegin < 0 || width <= 0 || height <= 0 ||
+     xbegin + width > inSpec.width || ybegin + height > inSpec.height)
+    throw std::runtime_error("Invalid region requested in image file '" + path + "'.");
+
+  // cut only requests the tiles/scanlines covering the region from the decoder
+  const oiio::ROI regionROI(xbegin, xbegin + width, ybegin, ybegin + height, 0, 1, 0, inSpec.nchannels);
+  oiio::ImageBuf regionBuf;
+  oiio::ImageBufAlgo::cut(regionBuf, inBuf, regionROI);
+
+  convertImageBuf(regionBuf, path, format, nchannels, image);
+}
+
+template<typename T>
+void readImageScaled(const std::string& path, oiio::TypeDesc format, int nchannels,
+                     int maxSideLength, Image<T>& image)
+{
+  // check requested channels number
+  assert(nchannels == 1 || nchannels >= 3);
+  assert(maxSideLength > 0);
+
+  // choose the smallest stored MIP level still covering the requested
+  // resolution, so pre-mipmapped formats never decode full resolution
+  int miplevel = 0;
+  {
+    std::unique_ptr<oiio::ImageInput> in(oiio::ImageInput::open(path));
+
+    if(!in)
+      throw std::runtime_error("Can't find/open image file '" + path + "'.");
+
+    oiio::ImageSpec levelSpec = in->spec();
+
+    while(std::max(levelSpec.width, levelSpec.height) > maxSideLength)
+    {
+      oiio::ImageSpec nextSpec;
+      if(!in->seek_subimage(0, miplevel + 1, nextSpec))
+        break;
+      if(std::max(nextSpec.width, nextSpec.height) < maxSideLength)
+        break; // never decode below the requested resolution
+      ++miplevel;
+      levelSpec = nextSpec;
+    }
+
+    in->close();
+  }
+
+  const oiio::ImageSpec configSpec = readConfigSpec();
+
+  oiio::ImageBuf inBuf(path, 0, miplevel, NULL, &configSpec);
+
+  if(!inBuf.initialized())
+    throw std::runtime_error("Can't find/open image file '" + path + "'.");
+
+  const oiio::ImageSpec& inSpec = inBuf.spec();
+
+  // downsize the decoded level to the requested bound if needed
+  if(std::max(inSpec.width, inSpec.height) > maxSideLength)
+  {
+    const float scale = static_cast<float>(maxSideLength) / static_cast<float>(std::max(inSpec.width, inSpec.height));
+    const int outWidth  = std::max(1, static_cast<int>(inSpec.width  * scale + .5f));
+    const int outHeight = std::max(1, static_cast<int>(inSpec.height * scale + .5f));
+
+    oiio::ImageBuf resizedBuf;
+    oiio::ImageBufAlgo::resize(resizedBuf, inBuf, "", 0.f, oiio::ROI(0, outWidth, 0, outHeight, 0, 1, 0, inSpec.nchannels));
+    inBuf.copy(resizedBuf);
+  }
+
+  convertImageBuf(inBuf, path, format, nchannels, image);
+}
+
+template<typename T>
+void readImageScanlines(const std::string& path, oiio::TypeDesc format, int nchannels, int blockSize,
+                        const std::function<bool(int rowBegin, const Image<T>& rowBlock)>& processRows)
+{
+  // check requested channels number
+  assert(nchannels == 1 || nchannels >= 3);
+  assert(blockSize > 0);
+
+  std::unique_ptr<oiio::ImageInput> in(oiio::ImageInput::open(path));
+
+  if(!in)
+    throw std::runtime_error("Can't find/open image file '" + path + "'.");
+
+  const oiio::ImageSpec inSpec = in->spec();
+
+  if(inSpec.tile_width != 0)
+  {
+    // tiled file : stream through the image cache,
+    // only the tiles covering each block are decoded
+    in->close();
+
+    oiio::ImageBuf inBuf(path);
+
+    if(!inBuf.initialized())
+      throw std::runtime_error("Can't find/open image file '" + path + "'.");
+
+    Image<T> block;
+    for(int ybegin = 0; ybegin < inSpec.height; ybegin += blockSize)
+    {
+      const int yend = std::min(ybegin + blockSize, inSpec.height);
+
+      oiio::ImageBuf blockBuf;
+      oiio::ImageBufAlgo::cut(blockBuf, inBuf, oiio::ROI(0, inSpec.width, ybegin, yend, 0, 1, 0, inSpec.nchannels));
+      convertImageBuf(blockBuf, path, format, nchannels, block);
+
+      if(!processRows(ybegin, block))
+        return;
+    }
+    return;
+  }
+
+  // scanline file : decode one block of rows at a time in the native format,
+  // the full image is never resident
+  Image<T> block;
+  std::vector<unsigned char> rawBlock(static_cast<std::size_t>(inSpec.width) * blockSize * inSpec.nchannels * inSpec.format.size());
+
+  for(int ybegin = 0; ybegin < inSpec.height; ybegin += blockSize)
+  {
+    const int yend = std::min(ybegin + blockSize, inSpec.height);
+
+    if(!in->read_scanlines(ybegin, yend, 0, inSpec.format, rawBlock.data()))
+    {
+      in->close();
+      throw std::runtime_error("Can't read scanlines of image file '" + path + "'.");
+    }
+
+    const oiio::ImageSpec blockSpec(inSpec.width, yend - ybegin, inSpec.nchannels, inSpec.format);
+    oiio::ImageBuf blockBuf(blockSpec, rawBlock.data());
+    convertImageBuf(blockBuf, path, format, nchannels, block);
+
+    if(!processRows(ybegin, block))
+      break;
+  }
+
+  in->close();
+}
+
 template<typename T>
 void writeImage(const std::string& path, oiio::TypeDesc typeDesc, int nchannels, const Image<T>& image)
 {
@@ -220,6 +403,71 @@ void readImage(const std::string& path, Image<RGBColor>& image)
   readImage(path, oiio::TypeDesc::UINT8, 3, image);
 }
 
+void readImageRegion(const std::string& path, int xbegin, int ybegin, int width, int height, Image<float>& image)
+{
+  readImageRegion(path, oiio::TypeDesc::FLOAT, 1, xbegin, ybegin, width, height, image);
+}
+
+void readImageRegion(const std::string& path, int xbegin, int ybegin, int width, int height, Image<unsigned char>& image)
+{
+  readImageRegion(path, oiio::TypeDesc::UINT8, 1, xbegin, ybegin, width, height, image);
+}
+
+void readImageRegion(const std::string& path, int xbegin, int ybegin, int width, int height, Image<RGBAColor>& image)
+{
+  readImageRegion(path, oiio::TypeDesc::UINT8, 4, xbegin, ybegin, width, height, image);
+}
+
+void readImageRegion(const std::string& path, int xbegin, int ybegin, int width, int height, Image<RGBfColor>& image)
+{
+  readImageRegion(path, oiio::TypeDesc::FLOAT, 3, xbegin, ybegin, width, height, image);
+}
+
+void readImageRegion(const std::string& path, int xbegin, int ybegin, int width, int height, Image<RGBColor>& image)
+{
+  readImageRegion(path, oiio::TypeDesc::UINT8, 3, xbegin, ybegin, width, height, image);
+}
+
+void readImageScaled(const std::string& path, int maxSideLength, Image<float>& image)
+{
+  readImageScaled(path, oiio::TypeDesc::FLOAT, 1, maxSideLength, image);
+}
+
+void readImageScaled(const std::string& path, int maxSideLength, Image<unsigned char>& image)
+{
+  readImageScaled(path, oiio::TypeDesc::UINT8, 1, maxSideLength, image);
+}
+
+void readImageScaled(const std::string& path, int maxSideLength, Image<RGBAColor>& image)
+{
+  readImageScaled(path, oiio::TypeDesc::UINT8, 4, maxSideLength, image);
+}
+
+void readImageScaled(const std::string& path, int maxSideLength, Image<RGBfColor>& image)
+{
+  readImageScaled(path, oiio::TypeDesc::FLOAT, 3, maxSideLength, image);
+}
+
+void readImageScaled(const std::string& path, int maxSideLength, Image<RGBColor>& image)
+{
+  readImageScaled(path, oiio::TypeDesc::UINT8, 3, maxSideLength, image);
+}
+
+void readImageScanlines(const std::string& path, const std::function<bool(int rowBegin, const Image<float>& rowBlock)>& processRows, int blockSize)
+{
+  readImageScanlines(path, oiio::TypeDesc::FLOAT, 1, blockSize, processRows);
+}
+
+void readImageScanlines(const std::string& path, const std::function<bool(int rowBegin, const Image<unsigned char>& rowBlock)>& processRows, int blockSize)
+{
+  readImageScanlines(path, oiio::TypeDesc::UINT8, 1, blockSize, processRows);
+}
+
+void readImageScanlines(const std::string& path, const std::function<bool(int rowBegin, const Image<RGBColor>& rowBlock)>& processRows, int blockSize)
+{
+  readImageScanlines(path, oiio::TypeDesc::UINT8, 3, blockSize, processRows);
+}
+
 void writeImage(const std::string& path, const Image<unsigned char>& image)
 {
   writeImage(path, oiio::TypeDesc::UINT8, 1, image);
@@ -240,5 +488,117 @@ void writeImage(const std::string& path, const Image<RGBColor>& image)
   writeImage(path, oiio::TypeDesc::UINT8, 3, image);
 }
 
+AsyncImageWriter::AsyncImageWriter(std::size_t nbThreads, std::size_t maxQueueSize)
+  : _maxQueueSize(maxQueueSize)
+{
+  assert(nbThreads > 0);
+  assert(maxQueueSize > 0);
+
+  _threads.reserve(nbThreads);
+  for(std::size_t i = 0; i < nbThreads; ++i)
+    _threads.emplace_back(&AsyncImageWriter::workerLoop, this);
+}
+
+AsyncImageWriter::~AsyncImageWriter()
+{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _notEmpty.notify_all();
+
+  for(std::thread& thread : _threads)
+    thread.join();
+
+  if(!_firstError.empty())
+    ALICEVISION_LOG_ERROR("AsyncImageWriter: " << _firstError);
+}
+
+void AsyncImageWriter::write(const std::string& path, Image<unsigned char>&& image)
+{
+  const auto sharedImage = std::make_shared<Image<unsigned char>>(std::move(image));
+  enqueue([path, sharedImage]() { writeImage(path, *sharedImage); });
+}
+
+void AsyncImageWriter::write(const std::string& path, Image<RGBAColor>&& image)
+{
+  const auto sharedImage = std::make_shared<Image<RGBAColor>>(std::move(image));
+  enqueue([path, sharedImage]() { writeImage(path, *sharedImage); });
+}
+
+void AsyncImageWriter::write(const std::string& path, Image<RGBfColor>&& image)
+{
+  const auto sharedImage = std::make_shared<Image<RGBfColor>>(std::move(image));
+  enqueue([path, sharedImage]() { writeImage(path, *sharedImage); });
+}
+
+void AsyncImageWriter::write(const std::string& path, Image<RGBColor>&& image)
+{
+  const auto sharedImage = std::make_shared<Image<RGBColor>>(std::move(image));
+  enqueue([path, sharedImage]() { writeImage(path, *sharedImage); });
+}
+
+void AsyncImageWriter::waitAll()
+{
+  std::unique_lock<std::mutex> lock(_mutex);
+  _allDone.wait(lock, [this]() { return _tasks.empty() && _nbActive == 0; });
+
+  if(!_firstError.empty())
+  {
+    const std::string error = _firstError;
+    _firstError.clear();
+    throw std::runtime_error(error);
+  }
+}
+
+void AsyncImageWriter::enqueue(std::function<void()> task)
+{
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    // backpressure: block the producer while the queue is full
+    _notFull.wait(lock, [this]() { return _tasks.size() < _maxQueueSize; });
+    _tasks.push_back(std::move(task));
+  }
+  _notEmpty.notify_one();
+}
+
+void AsyncImageWriter::workerLoop()
+{
+  for(;;)
+  {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _notEmpty.wait(lock, [this]() { return _stop || !_tasks.empty(); });
+
+      if(_tasks.empty())
+        return; // stopped and drained
+
+      task = std::move(_tasks.front());
+      _tasks.pop_front();
+      ++_nbActive;
+    }
+    _notFull.notify_one();
+
+    std::string error;
+    try
+    {
+      task();
+    }
+    catch(const std::exception& e)
+    {
+      error = e.what();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      --_nbActive;
+      if(!error.empty() && _firstError.empty())
+        _firstError = error;
+    }
+    _allDone.notify_all();
+  }
+}
+
 }  // namespace image
 }  // namespace aliceVision
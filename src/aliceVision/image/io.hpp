@@ -8,7 +8,13 @@
 #include <aliceVision/image/Image.hpp>
 #include <aliceVision/image/pixelTypes.hpp>
 
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace aliceVision {
 namespace image {
@@ -80,6 +86,53 @@ void readImage(const std::string& path, Image<RGBAColor>& image);
 void readImage(const std::string& path, Image<RGBfColor>& image);
 void readImage(const std::string& path, Image<RGBColor>& image);
 
+/**
+ * @brief read a rectangular region of an image with a given path
+ * Only the tiles/scanlines covering the region are requested from the decoder,
+ * so tiled formats (EXR, TIFF) never decode the full image.
+ * @param[in] path The given path to the image
+ * @param[in] xbegin The region left column (in pixels)
+ * @param[in] ybegin The region top row (in pixels)
+ * @param[in] width The region width (in pixels)
+ * @param[in] height The region height (in pixels)
+ * @param[out] image The output image buffer, sized to the region
+ */
+void readImageRegion(const std::string& path, int xbegin, int ybegin, int width, int height, Image<float>& image);
+void readImageRegion(const std::string& path, int xbegin, int ybegin, int width, int height, Image<unsigned char>& image);
+void readImageRegion(const std::string& path, int xbegin, int ybegin, int width, int height, Image<RGBAColor>& image);
+void readImageRegion(const std::string& path, int xbegin, int ybegin, int width, int height, Image<RGBfColor>& image);
+void readImageRegion(const std::string& path, int xbegin, int ybegin, int width, int height, Image<RGBColor>& image);
+
+/**
+ * @brief read an image with a bounded output resolution
+ * The smallest stored MIP level still covering the requested resolution is
+ * decoded (for pre-mipmapped formats like tiled EXR/TIFF), then the result is
+ * downsized so its longest side is maxSideLength. Formats without MIP levels
+ * fall back to a full decode followed by the resize.
+ * @param[in] path The given path to the image
+ * @param[in] maxSideLength The maximum length of the output longest side (in pixels)
+ * @param[out] image The output image buffer
+ */
+void readImageScaled(const std::string& path, int maxSideLength, Image<float>& image);
+void readImageScaled(const std::string& path, int maxSideLength, Image<unsigned char>& image);
+void readImageScaled(const std::string& path, int maxSideLength, Image<RGBAColor>& image);
+void readImageScaled(const std::string& path, int maxSideLength, Image<RGBfColor>& image);
+void readImageScaled(const std::string& path, int maxSideLength, Image<RGBColor>& image);
+
+/**
+ * @brief read an image as consecutive blocks of scanlines for row-wise consumers
+ * Scanline formats are decoded one block of rows at a time, so the full image
+ * is never resident; tiled formats are streamed through the image cache with
+ * only the tiles covering each block decoded.
+ * @param[in] path The given path to the image
+ * @param[in] processRows Callback invoked per block with the first row index
+ *            and the block pixels, return false to stop reading early
+ * @param[in] blockSize The number of rows per block (except the last one)
+ */
+void readImageScanlines(const std::string& path, const std::function<bool(int rowBegin, const Image<float>& rowBlock)>& processRows, int blockSize = 64);
+void readImageScanlines(const std::string& path, const std::function<bool(int rowBegin, const Image<unsigned char>& rowBlock)>& processRows, int blockSize = 64);
+void readImageScanlines(const std::string& path, const std::function<bool(int rowBegin, const Image<RGBColor>& rowBlock)>& processRows, int blockSize = 64);
+
 /**
  * @brief write an image with a given path and buffer
  * @param[in] path The given path to the image
@@ -90,5 +143,68 @@ void writeImage(const std::string& path, const Image<RGBAColor>& image);
 void writeImage(const std::string& path, const Image<RGBfColor>& image);
 void writeImage(const std::string& path, const Image<RGBColor>& image);
 
+/**
+ * @brief write images asynchronously on dedicated I/O threads
+ * write() moves the image into a bounded queue and returns immediately, so the
+ * calling thread can start the next computation while encoding and disk write
+ * happen in the background. When the queue is full write() blocks until a slot
+ * is free, which bounds the memory held by pending images.
+ */
+class AsyncImageWriter
+{
+public:
+
+  /**
+   * @brief AsyncImageWriter constructor
+   * @param[in] nbThreads The number of I/O threads
+   * @param[in] maxQueueSize The maximum number of pending images
+   */
+  explicit AsyncImageWriter(std::size_t nbThreads = 1, std::size_t maxQueueSize = 4);
+
+  /**
+   * @brief AsyncImageWriter destructor, waits for all pending writes
+   */
+  ~AsyncImageWriter();
+
+  // non-copyable
+  AsyncImageWriter(const AsyncImageWriter&) = delete;
+  AsyncImageWriter& operator=(const AsyncImageWriter&) = delete;
+
+  /**
+   * @brief enqueue an image write, the image is taken by move
+   * @param[in] path The given path to the image
+   * @param[in] image The image buffer to write
+   */
+  void write(const std::string& path, Image<unsigned char>&& image);
+  void write(const std::string& path, Image<RGBAColor>&& image);
+  void write(const std::string& path, Image<RGBfColor>&& image);
+  void write(const std::string& path, Image<RGBColor>&& image);
+
+  /**
+   * @brief wait until all enqueued writes are done
+   * Throws the error of the first failed write, if any.
+   */
+  void waitAll();
+
+private:
+
+  /// enqueue a write task, blocks when the queue is full
+  void enqueue(std::function<void()> task);
+
+  /// I/O thread main loop
+  void workerLoop();
+
+  std::vector<std::thread> _threads;
+  std::deque<std::function<void()>> _tasks;
+  std::mutex _mutex;
+  std::condition_variable _notEmpty;
+  std::condition_variable _notFull;
+  std::condition_variable _allDone;
+  std::size_t _maxQueueSize;
+  std::size_t _nbActive = 0;
+  bool _stop = false;
+  std::string _firstError;
+};
+
 }  // namespace image
 }  // namespace aliceVision
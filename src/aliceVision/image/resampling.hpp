@@ -23,14 +23,114 @@ namespace image {
 
     out.resize( new_width , new_height ) ;
 
-    const Sampler2d<SamplerLinear> sampler;
-
+    // The generic sampler at the mid pixel positions ( 2 * ( i + .5 ) , 2 * ( j + .5 ) )
+    // lands exactly on pixel ( 2i + 1 , 2j + 1 ) with linear weights { 1 , 0 },
+    // so the resampling reduces to a strided copy of the odd rows/columns
+    // (same output, without the per-pixel weight computation)
     for( int i = 0 ; i < new_height ; ++i )
     {
+      const typename Image::Tpixel * src_row = src.data() + ( 2 * i + 1 ) * src.Width() ;
+      typename Image::Tpixel * out_row = out.data() + i * new_width ;
+
       for( int j = 0 ; j < new_width ; ++j )
       {
-        // Use .5f offset to ensure mid pixel and correct bilinear sampling
-        out( i , j ) =  sampler( src, 2.f * (i+.5f), 2.f * (j+.5f) );
+        out_row[ j ] = src_row[ 2 * j + 1 ] ;
+      }
+    }
+  }
+
+  /**
+   ** Resize an image to a given size using bilinear interpolation
+   ** Equivalent to GenericRessample with Sampler2d<SamplerLinear> at positions
+   ** ( scale_y * ( i + .5 ) , scale_x * ( j + .5 ) ) but with the sampling
+   ** positions and weights precomputed per row/column and no per-pixel
+   ** branching on the interior, so the inner loop stays tight
+   ** @param src input image
+   ** @param output_width Width of the output image
+   ** @param output_height Height of the output image
+   ** @param[out] out Output image
+   **/
+  template < typename Image >
+  void ImageBilinearResize( const Image & src , const int output_width , const int output_height , Image & out )
+  {
+    typedef typename Image::Tpixel pix_t ;
+
+    assert( output_width > 0 && output_height > 0 ) ;
+
+    const int in_width = src.Width() ;
+    const int in_height = src.Height() ;
+
+    out.resize( output_width , output_height ) ;
+
+    const float scale_x = static_cast<float>( in_width ) / static_cast<float>( output_width ) ;
+    const float scale_y = static_cast<float>( in_height ) / static_cast<float>( output_height ) ;
+
+    const Sampler2d<SamplerLinear> sampler ;
+
+    // Precompute column positions and weights
+    std::vector< int > grid_x( output_width ) ;
+    std::vector< double > wx0( output_width ) , wx1( output_width ) ;
+    for( int j = 0 ; j < output_width ; ++j )
+    {
+      const float x = scale_x * ( j + .5f ) ;
+      grid_x[ j ] = static_cast<int>( floor( x ) ) ;
+      const double dx = static_cast<double>( x ) - floor( x ) ;
+      wx0[ j ] = 1.0 - dx ;
+      wx1[ j ] = dx ;
+    }
+
+    // Columns whose two neighbors are inside the image (positions are
+    // monotonic, so this is a contiguous range)
+    int j_begin = 0 ;
+    while( j_begin < output_width && grid_x[ j_begin ] < 0 )
+      ++j_begin ;
+    int j_end = output_width ;
+    while( j_end > 0 && grid_x[ j_end - 1 ] + 1 >= in_width )
+      --j_end ;
+
+    #pragma omp parallel for schedule(dynamic)
+    for( int i = 0 ; i < output_height ; ++i )
+    {
+      const float y = scale_y * ( i + .5f ) ;
+      const int grid_y = static_cast<int>( floor( y ) ) ;
+      const double dy = static_cast<double>( y ) - floor( y ) ;
+      const double wy0 = 1.0 - dy ;
+      const double wy1 = dy ;
+
+      const bool interior_row = ( grid_y >= 0 ) && ( grid_y + 1 < in_height ) ;
+
+      for( int j = 0 ; j < output_width ; ++j )
+      {
+        if( !interior_row || j < j_begin || j >= j_end )
+        {
+          // Border: the generic sampler handles the out of range neighbors
+          out( i , j ) = sampler( src , y , scale_x * ( j + .5f ) ) ;
+          continue ;
+        }
+
+        const pix_t * row0 = src.data() + grid_y * in_width ;
+        const pix_t * row1 = row0 + in_width ;
+        const int x0 = grid_x[ j ] ;
+
+        // Same accumulation order as the generic sampler, so results are identical
+        const double w00 = wx0[ j ] * wy0 ;
+        const double w01 = wx1[ j ] * wy0 ;
+        const double w10 = wx0[ j ] * wy1 ;
+        const double w11 = wx1[ j ] * wy1 ;
+
+        typename RealPixel<pix_t>::real_type res(0) ;
+        res += RealPixel<pix_t>::convert_to_real( row0[ x0 ] ) * w00 ;
+        res += RealPixel<pix_t>::convert_to_real( row0[ x0 + 1 ] ) * w01 ;
+        res += RealPixel<pix_t>::convert_to_real( row1[ x0 ] ) * w10 ;
+        res += RealPixel<pix_t>::convert_to_real( row1[ x0 + 1 ] ) * w11 ;
+
+        const double total_weight = w00 + w01 + w10 + w11 ;
+        if( total_weight != 1.0 )
+        {
+          res /= total_weight ;
+        }
+
+        out( i , j ) = RealPixel<pix_t>::convert_from_real( res ) ;
       }
     }
   }
@@ -0,0 +1,261 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "warping.hpp"
+
+#include <aliceVision/system/cpuDispatch.hpp>
+
+#include <cmath>
+#include <vector>
+
+#if defined(ALICEVISION_CPU_DISPATCH_X86)
+#include <immintrin.h>
+#endif
+
+namespace aliceVision {
+namespace image {
+
+namespace {
+
+// Bilinear fetch of one row of sampling positions:
+// out[k] = src(ys[k], xs[k]) interpolated from the four surrounding pixels.
+// The caller guarantees xs[k] in [0, width-1) and ys[k] in [0, height-1), so
+// no border handling is needed here.
+
+void bilinearSampleRow_scalar(const float* src, int stride,
+                              const float* xs, const float* ys, float* out, int size)
+{
+  for(int k = 0; k < size; ++k)
+  {
+    const float fx = std::floor(xs[k]);
+    const float fy = std::floor(ys[k]);
+    const float dx = xs[k] - fx;
+    const float dy = ys[k] - fy;
+    const float* row0 = src + static_cast<int>(fy) * stride + static_cast<int>(fx);
+    const float* row1 = row0 + stride;
+    const float top = row0[0] + (row0[1] - row0[0]) * dx;
+    const float bot = row1[0] + (row1[1] - row1[0]) * dx;
+    out[k] = top + (bot - top) * dy;
+  }
+}
+
+#if defined(ALICEVISION_CPU_DISPATCH_X86)
+
+ALICEVISION_TARGET_AVX2
+void bilinearSampleRow_avx2(const float* src, int stride,
+                            const float* xs, const float* ys, float* out, int size)
+{
+  int k = 0;
+  for(; k + 8 <= size; k += 8)
+  {
+    const __m256 x = _mm256_loadu_ps(xs + k);
+    const __m256 y = _mm256_loadu_ps(ys + k);
+    const __m256 fx = _mm256_floor_ps(x);
+    const __m256 fy = _mm256_floor_ps(y);
+    const __m256 dx = _mm256_sub_ps(x, fx);
+    const __m256 dy = _mm256_sub_ps(y, fy);
+    const __m256i idx = _mm256_add_epi32(
+      _mm256_mullo_epi32(_mm256_cvttps_epi32(fy), _mm256_set1_epi32(stride)),
+      _mm256_cvttps_epi32(fx));
+    const __m256 p00 = _mm256_i32gather_ps(src, idx, 4);
+    const __m256 p01 = _mm256_i32gather_ps(src + 1, idx, 4);
+    const __m256 p10 = _mm256_i32gather_ps(src + stride, idx, 4);
+    const __m256 p11 = _mm256_i32gather_ps(src + stride + 1, idx, 4);
+    const __m256 top = _mm256_fmadd_ps(_mm256_sub_ps(p01, p00), dx, p00);
+    const __m256 bot = _mm256_fmadd_ps(_mm256_sub_ps(p11, p10), dx, p10);
+    _mm256_storeu_ps(out + k, _mm256_fmadd_ps(_mm256_sub_ps(bot, top), dy, top));
+  }
+  if(k < size)
+    bilinearSampleRow_scalar(src, stride, xs + k, ys + k, out + k, size - k);
+}
+
+ALICEVISION_TARGET_AVX512
+void bilinearSampleRow_avx512(const float* src, int stride,
+                              const float* xs, const float* ys, float* out, int size)
+{
+  int k = 0;
+  for(; k + 16 <= size; k += 16)
+  {
+    const __m512 x = _mm512_loadu_ps(xs + k);
+    const __m512 y = _mm512_loadu_ps(ys + k);
+    const __m512 fx = _mm512_roundscale_ps(x, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+    const __m512 fy = _mm512_roundscale_ps(y, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+    const __m512 dx = _mm512_sub_ps(x, fx);
+    const __m512 dy = _mm512_sub_ps(y, fy);
+    const __m512i idx = _mm512_add_epi32(
+      _mm512_mullo_epi32(_mm512_cvttps_epi32(fy), _mm512_set1_epi32(stride)),
+      _mm512_cvttps_epi32(fx));
+    const __m512 p00 = _mm512_i32gather_ps(idx, src, 4);
+    const __m512 p01 = _mm512_i32gather_ps(idx, src + 1, 4);
+    const __m512 p10 = _mm512_i32gather_ps(idx, src + stride, 4);
+    const __m512 p11 = _mm512_i32gather_ps(idx, src + stride + 1, 4);
+    const __m512 top = _mm512_fmadd_ps(_mm512_sub_ps(p01, p00), dx, p00);
+    const __m512 bot = _mm512_fmadd_ps(_mm512_sub_ps(p11, p10), dx, p10);
+    _mm512_storeu_ps(out + k, _mm512_fmadd_ps(_mm512_sub_ps(bot, top), dy, top));
+  }
+  if(k < size)
+    bilinearSampleRow_scalar(src, stride, xs + k, ys + k, out + k, size - k);
+}
+
+#endif // ALICEVISION_CPU_DISPATCH_X86
+
+typedef void (*BilinearSampleRowKernel)(const float*, int, const float*, const float*, float*, int);
+
+void bilinearSampleRow(const float* src, int stride,
+                       const float* xs, const float* ys, float* out, int size)
+{
+#if defined(ALICEVISION_CPU_DISPATCH_X86)
+  // no SSE4 variant: gathers only exist from AVX2 on
+  static const BilinearSampleRowKernel kernelFn =
+    system::CpuDispatch<BilinearSampleRowKernel>(&bilinearSampleRow_scalar)
+      .avx2(&bilinearSampleRow_avx2)
+      .avx512(&bilinearSampleRow_avx512)
+      .resolve();
+  kernelFn(src, stride, xs, ys, out, size);
+#else
+  bilinearSampleRow_scalar(src, stride, xs, ys, out, size);
+#endif
+}
+
+} // namespace
+
+void WarpTiled(const Image<float> &im, const Mat3 & H, Image<float> &out, const int tileSize)
+{
+  const int wOut = static_cast<int>(out.Width());
+  const int hOut = static_cast<int>(out.Height());
+  if(wOut <= 0 || hOut <= 0)
+    return;
+
+  const int wIn = static_cast<int>(im.Width());
+  const int hIn = static_cast<int>(im.Height());
+  const float* src = im.GetMat().data();
+  const int stride = wIn;
+
+  const int nbTilesX = (wOut + tileSize - 1) / tileSize;
+  const int nbTilesY = (hOut + tileSize - 1) / tileSize;
+  const int nbTiles = nbTilesX * nbTilesY;
+
+  const Sampler2d<SamplerLinear> sampler;
+
+#pragma omp parallel
+{
+  // per-thread row scratch: sampling positions, fetched values and the kind
+  // of handling each pixel needs (0: outside, 1: vectorized interior fetch,
+  // 2: exact scalar sampling at the image border)
+  std::vector<float> xs(tileSize);
+  std::vector<float> ys(tileSize);
+  std::vector<float> fetched(tileSize);
+  std::vector<unsigned char> status(tileSize);
+
+#pragma omp for schedule(dynamic)
+  for(int tile = 0; tile < nbTiles; ++tile)
+  {
+    const int tx = (tile % nbTilesX) * tileSize;
+    const int ty = (tile / nbTilesX) * tileSize;
+    const int tw = std::min(tileSize, wOut - tx);
+    const int th = std::min(tileSize, hOut - ty);
+
+    // map the tile corners exactly through the homography; a positive
+    // orientation at the four corners holds on the whole tile since the
+    // denominator is linear in the pixel position
+    double cornerX[4];
+    double cornerY[4];
+    bool degenerate = false;
+    for(int c = 0; c < 4; ++c)
+    {
+      const Vec3 X = H * Vec3(tx + (c & 1) * tw, ty + (c >> 1) * th, 1.0);
+      if(X(2) * H(2,2) <= std::numeric_limits<double>::epsilon())
+      {
+        degenerate = true;
+        break;
+      }
+      cornerX[c] = X(0) / X(2);
+      cornerY[c] = X(1) / X(2);
+    }
+
+    if(!degenerate)
+    {
+      // keep the approximation subpixel accurate: compare it against the
+      // exact mapping at the tile centre, where the error of the bilinear
+      // interpolation peaks, and give up on the tile when the projective
+      // curvature is too strong (e.g. close to the pole of the homography)
+      double cx = tx + 0.5 * tw, cy = ty + 0.5 * th;
+      ApplyH_AndCheckOrientation(H, cx, cy);
+      const double ex = 0.25 * (cornerX[0] + cornerX[1] + cornerX[2] + cornerX[3]) - cx;
+      const double ey = 0.25 * (cornerY[0] + cornerY[1] + cornerY[2] + cornerY[3]) - cy;
+      degenerate = (ex * ex + ey * ey > 0.25 * 0.25);
+    }
+
+    if(degenerate)
+    {
+      // exact per-pixel fallback, identical to Warp
+      for(int j = 0; j < th; ++j)
+        for(int i = 0; i < tw; ++i)
+        {
+          double xT = tx + i, yT = ty + j;
+          if(ApplyH_AndCheckOrientation(H, xT, yT)
+              && im.Contains(yT,xT))
+            out(ty + j, tx + i) = sampler(im, (float)yT, (float)xT);
+        }
+      continue;
+    }
+
+    for(int j = 0; j < th; ++j)
+    {
+      const double v = static_cast<double>(j) / th;
+      const double leftX  = cornerX[0] + (cornerX[2] - cornerX[0]) * v;
+      const double leftY  = cornerY[0] + (cornerY[2] - cornerY[0]) * v;
+      const double rightX = cornerX[1] + (cornerX[3] - cornerX[1]) * v;
+      const double rightY = cornerY[1] + (cornerY[3] - cornerY[1]) * v;
+      const double stepX = (rightX - leftX) / tw;
+      const double stepY = (rightY - leftY) / tw;
+
+      bool anyInterior = false;
+      double xT = leftX, yT = leftY;
+      for(int i = 0; i < tw; ++i, xT += stepX, yT += stepY)
+      {
+        const float xf = static_cast<float>(xT);
+        const float yf = static_cast<float>(yT);
+        // the interior test is done on the float positions so that the fetch
+        // kernel never addresses the last row or column of the source
+        if(xf >= 0.0f && xf < wIn - 1 && yf >= 0.0f && yf < hIn - 1)
+        {
+          status[i] = 1;
+          xs[i] = xf;
+          ys[i] = yf;
+          anyInterior = true;
+        }
+        else if(im.Contains(yT,xT))
+        {
+          status[i] = 2;
+          xs[i] = xf;
+          ys[i] = yf;
+        }
+        else
+        {
+          // keep the discarded lanes of the fetch kernel on a safe address
+          status[i] = 0;
+          xs[i] = 0.0f;
+          ys[i] = 0.0f;
+        }
+      }
+
+      if(anyInterior)
+        bilinearSampleRow(src, stride, &xs[0], &ys[0], &fetched[0], tw);
+
+      for(int i = 0; i < tw; ++i)
+      {
+        if(status[i] == 1)
+          out(ty + j, tx + i) = fetched[i];
+        else if(status[i] == 2)
+          out(ty + j, tx + i) = sampler(im, ys[i], xs[i]);
+      }
+    }
+  }
+}
+}
+
+} // namespace image
+} // namespace aliceVision
@@ -6,13 +6,19 @@
 #pragma once
 
 #include <aliceVision/config.hpp>
+#include <aliceVision/numeric/numeric.hpp>
+#include <aliceVision/image/Image.hpp>
+#include <aliceVision/image/Sampler.hpp>
+
+#include <algorithm>
+#include <limits>
 
 namespace aliceVision{
 namespace image{
 
 /// Apply inplace homography transform for the given point (x,y).
 /// Return true if H is orientation preserving around the point.
-bool ApplyH_AndCheckOrientation(const Mat3 &H, double &x, double &y)
+inline bool ApplyH_AndCheckOrientation(const Mat3 &H, double &x, double &y)
 {
   Vec3 X(x, y, 1.0);
   X = H*X;
@@ -42,5 +48,111 @@ void Warp(const Image &im, const Mat3 & H, Image &out)
     }
 }
 
+/// Warp an image im given a homography H with a backward approach, processed
+/// by square tiles in parallel.
+/// Inside a tile the source coordinates are the bilinear interpolation of the
+/// exact mapping of the four tile corners, which removes the per-pixel
+/// projective division; the approximation is exact at the corners and the
+/// error stays far below a pixel at the default tile size for the homographies
+/// found between overlapping views. Tiles where the homography denominator
+/// vanishes or changes sign, or where the interpolation drifts more than a
+/// quarter of a pixel from the exact mapping at the tile centre, fall back to
+/// the exact per-pixel mapping of Warp.
+template <class Image>
+void WarpTiled(const Image &im, const Mat3 & H, Image &out, const int tileSize = 32)
+{
+  const int wOut = static_cast<int>(out.Width());
+  const int hOut = static_cast<int>(out.Height());
+  if(wOut <= 0 || hOut <= 0)
+    return;
+
+  const int nbTilesX = (wOut + tileSize - 1) / tileSize;
+  const int nbTilesY = (hOut + tileSize - 1) / tileSize;
+  const int nbTiles = nbTilesX * nbTilesY;
+
+  const Sampler2d<SamplerLinear> sampler;
+
+  #pragma omp parallel for schedule(dynamic)
+  for(int tile = 0; tile < nbTiles; ++tile)
+  {
+    const int tx = (tile % nbTilesX) * tileSize;
+    const int ty = (tile / nbTilesX) * tileSize;
+    const int tw = std::min(tileSize, wOut - tx);
+    const int th = std::min(tileSize, hOut - ty);
+
+    // Map the tile corners exactly through the homography. The denominator of
+    // the mapping is linear in the pixel position, so if it keeps a positive
+    // orientation at the four corners it does so on the whole tile and the
+    // per-pixel orientation test can be dropped.
+    double cornerX[4];
+    double cornerY[4];
+    bool degenerate = false;
+    for(int c = 0; c < 4; ++c)
+    {
+      const Vec3 X = H * Vec3(tx + (c & 1) * tw, ty + (c >> 1) * th, 1.0);
+      if(X(2) * H(2,2) <= std::numeric_limits<double>::epsilon())
+      {
+        degenerate = true;
+        break;
+      }
+      cornerX[c] = X(0) / X(2);
+      cornerY[c] = X(1) / X(2);
+    }
+
+    if(!degenerate)
+    {
+      // keep the approximation subpixel accurate: compare it against the
+      // exact mapping at the tile centre, where the error of the bilinear
+      // interpolation peaks, and give up on the tile when the projective
+      // curvature is too strong (e.g. close to the pole of the homography)
+      double cx = tx + 0.5 * tw, cy = ty + 0.5 * th;
+      ApplyH_AndCheckOrientation(H, cx, cy);
+      const double ex = 0.25 * (cornerX[0] + cornerX[1] + cornerX[2] + cornerX[3]) - cx;
+      const double ey = 0.25 * (cornerY[0] + cornerY[1] + cornerY[2] + cornerY[3]) - cy;
+      degenerate = (ex * ex + ey * ey > 0.25 * 0.25);
+    }
+
+    if(degenerate)
+    {
+      // exact per-pixel fallback, identical to Warp
+      for(int j = 0; j < th; ++j)
+        for(int i = 0; i < tw; ++i)
+        {
+          double xT = tx + i, yT = ty + j;
+          if(ApplyH_AndCheckOrientation(H, xT, yT)
+              && im.Contains(yT,xT))
+            out(ty + j, tx + i) = sampler(im, (float)yT, (float)xT);
+        }
+      continue;
+    }
+
+    for(int j = 0; j < th; ++j)
+    {
+      const double v = static_cast<double>(j) / th;
+      const double leftX  = cornerX[0] + (cornerX[2] - cornerX[0]) * v;
+      const double leftY  = cornerY[0] + (cornerY[2] - cornerY[0]) * v;
+      const double rightX = cornerX[1] + (cornerX[3] - cornerX[1]) * v;
+      const double rightY = cornerY[1] + (cornerY[3] - cornerY[1]) * v;
+      const double stepX = (rightX - leftX) / tw;
+      const double stepY = (rightY - leftY) / tw;
+
+      double xT = leftX, yT = leftY;
+      for(int i = 0; i < tw; ++i, xT += stepX, yT += stepY)
+      {
+        if(im.Contains(yT,xT))
+          out(ty + j, tx + i) = sampler(im, (float)yT, (float)xT);
+      }
+    }
+  }
+}
+
+/**
+ * @brief WarpTiled overload for Image<float>: same tiled affine approximation,
+ * with the interior pixels of each row resampled by a bilinear fetch kernel
+ * resolved at runtime to the widest instruction set of the host.
+ * Border pixels and degenerate tiles go through the exact scalar sampler.
+ */
+void WarpTiled(const Image<float> &im, const Mat3 & H, Image<float> &out, const int tileSize = 32);
+
 }; // namespace image
 }; // namespace aliceVision
@@ -0,0 +1,152 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "aliceVision/image/warping.hpp"
+
+#include <iostream>
+
+#define BOOST_TEST_MODULE ImageWarping
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::image;
+using namespace std;
+
+namespace {
+
+// smooth test pattern: bilinear resampling of a ramp is exact, so any
+// difference between the warps comes from the mapping itself
+template <typename ImageT>
+void fillRamp(ImageT& img)
+{
+  for(int j = 0; j < img.Height(); ++j)
+    for(int i = 0; i < img.Width(); ++i)
+      img(j,i) = static_cast<typename ImageT::Tpixel>(0.3 * i + 0.7 * j);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(Image_Warping_TiledMatchesExact_Affine)
+{
+  Image<float> in(120, 90);
+  fillRamp(in);
+
+  Mat3 H;
+  // rotation + anisotropic scale + translation, no perspective: the per-tile
+  // affine interpolation of the mapping is exact
+  H << 0.95, -0.15, 8.0,
+       0.15,  1.05, -4.0,
+       0.0,   0.0,   1.0;
+
+  Image<float> outExact(120, 90);
+  Image<float> outTiled(120, 90);
+  outExact.fill(-1.0f);
+  outTiled.fill(-1.0f);
+
+  Warp(in, H, outExact);
+  WarpTiled(in, H, outTiled);
+
+  // rounding of the incremental coordinate stepping may flip the
+  // inside/outside decision on isolated pixels of the region boundary
+  int nbBoundaryMismatch = 0;
+  for(int j = 0; j < outExact.Height(); ++j)
+    for(int i = 0; i < outExact.Width(); ++i)
+    {
+      if((outExact(j,i) == -1.0f) != (outTiled(j,i) == -1.0f))
+        ++nbBoundaryMismatch;
+      else if(outExact(j,i) != -1.0f)
+        BOOST_CHECK_SMALL(outTiled(j,i) - outExact(j,i), 1e-3f);
+    }
+  BOOST_CHECK_LT(nbBoundaryMismatch, outExact.Width() * outExact.Height() / 100);
+}
+
+BOOST_AUTO_TEST_CASE(Image_Warping_TiledMatchesExact_Projective)
+{
+  Image<float> in(120, 90);
+  fillRamp(in);
+
+  Mat3 H;
+  H << 1.02,  -0.08,  5.0,
+       0.06,   0.97, -2.0,
+       2e-4,  -1e-4,  1.0;
+
+  Image<float> outExact(120, 90);
+  Image<float> outTiled(120, 90);
+  outExact.fill(-1.0f);
+  outTiled.fill(-1.0f);
+
+  Warp(in, H, outExact);
+  WarpTiled(in, H, outTiled);
+
+  // the subpixel coordinate drift of the approximation may flip the
+  // inside/outside decision right at the boundary of the warped region, so
+  // only a marginal amount of pixels may disagree on being written at all
+  int nbBoundaryMismatch = 0;
+  for(int j = 0; j < outExact.Height(); ++j)
+    for(int i = 0; i < outExact.Width(); ++i)
+    {
+      if((outExact(j,i) == -1.0f) != (outTiled(j,i) == -1.0f))
+        ++nbBoundaryMismatch;
+      else if(outExact(j,i) != -1.0f)
+        BOOST_CHECK_SMALL(outTiled(j,i) - outExact(j,i), 0.5f);
+    }
+  BOOST_CHECK_LT(nbBoundaryMismatch, outExact.Width() * outExact.Height() / 100);
+}
+
+BOOST_AUTO_TEST_CASE(Image_Warping_TiledDegenerateTileFallback)
+{
+  Image<float> in(120, 90);
+  fillRamp(in);
+
+  Mat3 H;
+  // the denominator 1 - 0.02 x changes sign inside the output: the affected
+  // tiles must fall back to the exact per-pixel mapping
+  H << 1.0,   0.0,   0.0,
+       0.0,   1.0,   0.0,
+      -0.02,  0.0,   1.0;
+
+  Image<float> outExact(120, 90);
+  Image<float> outTiled(120, 90);
+  outExact.fill(-1.0f);
+  outTiled.fill(-1.0f);
+
+  Warp(in, H, outExact);
+  WarpTiled(in, H, outTiled);
+
+  int nbBoundaryMismatch = 0;
+  for(int j = 0; j < outExact.Height(); ++j)
+    for(int i = 0; i < outExact.Width(); ++i)
+    {
+      if((outExact(j,i) == -1.0f) != (outTiled(j,i) == -1.0f))
+        ++nbBoundaryMismatch;
+      else if(outExact(j,i) != -1.0f)
+        BOOST_CHECK_SMALL(outTiled(j,i) - outExact(j,i), 0.5f);
+    }
+  BOOST_CHECK_LT(nbBoundaryMismatch, outExact.Width() * outExact.Height() / 100);
+}
+
+BOOST_AUTO_TEST_CASE(Image_Warping_TiledTemplatePath)
+{
+  Image<unsigned char> in(120, 90);
+  fillRamp(in);
+
+  Mat3 H;
+  H << 1.02,  -0.08,  5.0,
+       0.06,   0.97, -2.0,
+       2e-4,  -1e-4,  1.0;
+
+  Image<unsigned char> outExact(120, 90);
+  Image<unsigned char> outTiled(120, 90);
+  outExact.fill(0);
+  outTiled.fill(0);
+
+  Warp(in, H, outExact);
+  WarpTiled(in, H, outTiled);
+
+  for(int j = 0; j < outExact.Height(); ++j)
+    for(int i = 0; i < outExact.Width(); ++i)
+      BOOST_CHECK_SMALL(int(outTiled(j,i)) - int(outExact(j,i)), 2);
+}
@@ -8,9 +8,17 @@
 #include <aliceVision/sensorDB/parseDatabase.hpp>
 #include <aliceVision/feature/sift/ImageDescriber_SIFT.hpp>
 #include <aliceVision/system/Logger.hpp>
-
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <thread>
 #include <tuple>
 #include <cassert>
+#include <cmath>
 
 namespace aliceVision {
 namespace keyframe {
@@ -72,9 +80,6 @@ KeyframeSelector::KeyframeSelector(const std::vector<std::string>& mediaPaths,
 
   // resize selection data vector
   _framesData.resize(nbFrames);
-
-  // create SIFT image describer
-  _imageDescriber.reset(new feature::ImageDescriber_SIFT());
 }
 
 void KeyframeSelector::process()
@@ -117,52 +122,232 @@ void KeyframeSelector::process()
     mediaInfo.spec.attribute("Exif:FocalLength", _cameraInfos[mediaIndex].focalLength);
   }
 
+  // pre-size the per-frame data so the scoring workers can write their slots
+  // without synchronization
+  for(auto& frameData : _framesData)
+  {
+    frameData.mediasData.resize(_feeds.size());
+  }
+
+  // scoring pipeline : one reader thread per media walks its feed in order and
+  // pushes the decoded frames into a queue bounded by the memory budget, a pool
+  // of workers computes the sharpness and histogram scores, while the selection
+  // below stays sequential since the distance score depends on the previous
+  // keyframe choices
+  struct ScoringJob
+  {
+    std::size_t frameIndex = 0;
+    std::size_t mediaIndex = 0;
+    image::Image<image::RGBColor> image;
+  };
+
+  const std::size_t nbMedias = _feeds.size();
+  const std::size_t nbWorkers = std::max(1, omp_get_max_threads());
+
+  std::size_t maxFrameBytes = 0;
+  for(const auto& mediaInfo : _mediasInfo)
+  {
+    maxFrameBytes = std::max(maxFrameBytes, std::size_t(mediaInfo.spec.width) * std::size_t(mediaInfo.spec.height) * 3);
+  }
+
+  // bound the queue by the memory budget, but keep enough room for one frame
+  // of each media and for every worker
+  const std::size_t queueCapacity = std::max(std::max(nbMedias, 2 * nbWorkers), _scoringMemoryBudget / maxFrameBytes);
+  // bound the decoding window ahead of the selection stage, so the histograms
+  // of the scored frames do not pile up faster than they are evaluated
+  const std::size_t maxFramesAhead = std::max(2 * std::size_t(_maxFrameStep), queueCapacity);
+
+  std::deque<ScoringJob> jobQueue;
+  std::mutex queueMutex;
+  std::condition_variable queueNotEmpty;
+  std::condition_variable queueNotFull;
+  std::size_t activeReaders = nbMedias;
+
+  std::vector<std::size_t> nbScoredMedias(_framesData.size(), 0);
+  std::size_t selectionFrontier = 0;
+  std::mutex scoreMutex;
+  std::condition_variable frameScored;
+  std::condition_variable frontierMoved;
+
+  std::atomic<bool> abortFlag(false);
+  std::string abortMessage;
+
+  // record the first error and wake up every pipeline thread
+  auto failPipeline = [&](const std::string& message)
+  {
+    {
+      std::lock_guard<std::mutex> lockQueue(queueMutex);
+      std::lock_guard<std::mutex> lockScore(scoreMutex);
+      if(abortMessage.empty())
+      {
+        abortMessage = message;
+      }
+      abortFlag = true;
+    }
+    queueNotEmpty.notify_all();
+    queueNotFull.notify_all();
+    frameScored.notify_all();
+    frontierMoved.notify_all();
+  };
+
+  auto readerTask = [&](std::size_t mediaIndex)
+  {
+    image::Image<image::RGBColor> frame;
+    camera::PinholeRadialK3 intrinsics;
+    bool withIntrinsics = false;
+    std::string imgName;
+    auto& feed = *_feeds.at(mediaIndex);
+
+    for(std::size_t frameIndex = 0; frameIndex < _framesData.size(); ++frameIndex)
+    {
+      // keep the decoding bounded to a window ahead of the selection stage
+      {
+        std::unique_lock<std::mutex> lock(scoreMutex);
+        while(!abortFlag && (frameIndex >= selectionFrontier + maxFramesAhead))
+          frontierMoved.wait(lock);
+      }
+      if(abortFlag)
+        break;
+
+      if(!feed.readImage(frame, intrinsics, imgName, withIntrinsics))
+      {
+        ALICEVISION_LOG_ERROR("ERROR  : can't read frame '" << imgName << "' !");
+        failPipeline("ERROR : can't read frame '" + imgName + "' !");
+        break;
+      }
+
+      {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        while(!abortFlag && (jobQueue.size() >= queueCapacity))
+          queueNotFull.wait(lock);
+        if(abortFlag)
+          break;
+
+        ScoringJob job;
+        job.frameIndex = frameIndex;
+        job.mediaIndex = mediaIndex;
+        job.image = frame;
+        jobQueue.push_back(std::move(job));
+      }
+      queueNotEmpty.notify_one();
+
+      feed.goToNextFrame();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(queueMutex);
+      --activeReaders;
+    }
+    queueNotEmpty.notify_all();
+  };
+
+  auto workerTask = [&]()
+  {
+    // Describe is not guaranteed to be re-entrant, one describer per worker
+    feature::ImageDescriber_SIFT imageDescriber;
+
+    while(true)
+    {
+      ScoringJob job;
+      {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        while(!abortFlag && jobQueue.empty() && (activeReaders > 0))
+          queueNotEmpty.wait(lock);
+        if(abortFlag || jobQueue.empty())
+          break;
+
+        job = std::move(jobQueue.front());
+        jobQueue.pop_front();
+      }
+      queueNotFull.notify_one();
+
+      try
+      {
+        computeFrameScores(job.image, job.frameIndex, job.mediaIndex, tileSharpSubset, imageDescriber);
+      }
+      catch(const std::exception& e)
+      {
+        failPipeline(e.what());
+        break;
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(scoreMutex);
+        ++nbScoredMedias.at(job.frameIndex);
+      }
+      frameScored.notify_all();
+    }
+  };
+
+  std::vector<std::thread> readers;
+  std::vector<std::thread> workers;
+  for(std::size_t mediaIndex = 0; mediaIndex < nbMedias; ++mediaIndex)
+    readers.emplace_back(readerTask, mediaIndex);
+  for(std::size_t i = 0; i < nbWorkers; ++i)
+    workers.emplace_back(workerTask);
+
   // iteration process
   _keyframeIndexes.clear();
   std::size_t currentFrameStep = _minFrameStep; // start directly (dont skip minFrameStep first frames)
-  
+  std::size_t clearedUpTo = 0;
+
   for(std::size_t frameIndex = 0; frameIndex < _framesData.size(); ++frameIndex)
   {
     ALICEVISION_LOG_TRACE("frame : " << frameIndex);
-    bool frameSelected = true;
-    auto& frameData = _framesData.at(frameIndex);
-    frameData.mediasData.resize(_feeds.size());
 
-    for(std::size_t mediaIndex = 0; mediaIndex < _feeds.size(); ++mediaIndex)
+    // wait until the scoring workers processed every media of this frame
     {
-      ALICEVISION_LOG_TRACE("media : " << _mediaPaths.at(mediaIndex));
-      auto& feed = *_feeds.at(mediaIndex);
-
-      if(frameSelected) // false if a camera of a rig is not selected
+      std::unique_lock<std::mutex> lock(scoreMutex);
+      if(frameIndex > selectionFrontier)
       {
-        if(!feed.readImage(image, queryIntrinsics, currentImgName, hasIntrinsics))
-        {
-          ALICEVISION_LOG_ERROR("ERROR  : can't read frame '" << currentImgName << "' !");
-          throw std::invalid_argument("ERROR : can't read frame '" + currentImgName + "' !");
-        }
+        selectionFrontier = frameIndex;
+        frontierMoved.notify_all();
+      }
+      while(!abortFlag && (nbScoredMedias.at(frameIndex) < nbMedias))
+        frameScored.wait(lock);
+    }
+    if(abortFlag)
+      break;
 
-        // compute sharpness and sparse distance
-        if(!computeFrameData(image, frameIndex, mediaIndex, tileSharpSubset))
-        {
-          frameSelected = false;
-        }
+    // estimate the optical flow from the previous frame on the coarse pyramid
+    // levels kept by the scoring stage (first visit only, a revisited frame
+    // keeps its estimate)
+    if(_flowEstimationMode && (frameIndex > 0))
+    {
+      const auto& previousMediasData = _framesData.at(frameIndex - 1).mediasData;
+      for(std::size_t mediaIndex = 0; mediaIndex < nbMedias; ++mediaIndex)
+      {
+        auto& currMediaData = _framesData.at(frameIndex).mediasData.at(mediaIndex);
+        if((currMediaData.flow < 0) && (previousMediasData.size() == nbMedias))
+          currMediaData.flow = estimateFlow(previousMediasData.at(mediaIndex).flowLevels, currMediaData.flowLevels);
       }
+    }
 
-      feed.goToNextFrame();
+    if(evaluateFrame(frameIndex))
+    {
+      ALICEVISION_LOG_TRACE(" > selected" << std::endl);
+    }
+    else
+    {
+      ALICEVISION_LOG_TRACE(" > skipped" << std::endl);
     }
 
+    // remove the unselected mediasData, only once the frame can no longer be
+    // re-evaluated after a keyframe selection jump
+    while(clearedUpTo + frameStep < frameIndex)
     {
-      if(frameSelected)
+      auto& oldFrameData = _framesData.at(clearedUpTo);
+      if(!oldFrameData.keyframe)
       {
-        ALICEVISION_LOG_TRACE(" > selected" << std::endl);
-        frameData.selected = true;
-        frameData.computeAvgSharpness();
+        oldFrameData.mediasData.clear();
       }
       else
       {
-        ALICEVISION_LOG_TRACE(" > skipped" << std::endl);
-        frameData.mediasData.clear(); // remove unselected mediasData
+        // only the histogram of a keyframe is needed for the distance score
+        for(auto& mediaData : oldFrameData.mediasData)
+          mediaData.flowLevels.clear();
       }
+      ++clearedUpTo;
     }
 
     // selection process
@@ -189,19 +374,6 @@ void KeyframeSelector::process()
       {
         ALICEVISION_LOG_INFO("keyframe choice : " << keyframeIndex << std::endl);
 
-        // write keyframe
-        for(std::size_t mediaIndex = 0; mediaIndex < _feeds.size(); ++mediaIndex)
-        {
-          auto& feed = *_feeds.at(mediaIndex);
-
-          feed.goToFrame(keyframeIndex);
-
-          if(_maxOutFrame == 0) // no limit of keyframes (direct evaluation)
-          {
-            feed.readImage(image, queryIntrinsics, currentImgName, hasIntrinsics);
-            writeKeyframe(image, keyframeIndex, mediaIndex);
-          }
-        }
         _framesData[keyframeIndex].keyframe = true;
         _keyframeIndexes.push_back(keyframeIndex);
 
@@ -215,8 +387,36 @@ void KeyframeSelector::process()
     ++currentFrameStep;
   }
 
-  if(_maxOutFrame == 0) // no limit of keyframes (evaluation and write already done)
+  // release the readers still waiting on the decoding window
+  {
+    std::lock_guard<std::mutex> lock(scoreMutex);
+    selectionFrontier = _framesData.size();
+  }
+  frontierMoved.notify_all();
+
+  for(auto& reader : readers)
+    reader.join();
+  for(auto& worker : workers)
+    worker.join();
+
+  if(abortFlag)
   {
+    throw std::invalid_argument(abortMessage);
+  }
+
+  if(_maxOutFrame == 0) // no limit of keyframes
+  {
+    // write the keyframes, the feeds are only available once the readers are done
+    for(const std::size_t keyframeIndex : _keyframeIndexes)
+    {
+      for(std::size_t mediaIndex = 0; mediaIndex < nbMedias; ++mediaIndex)
+      {
+        auto& feed = *_feeds.at(mediaIndex);
+        feed.goToFrame(keyframeIndex);
+        feed.readImage(image, queryIntrinsics, currentImgName, hasIntrinsics);
+        writeKeyframe(image, keyframeIndex, mediaIndex);
+      }
+    }
     return;
   }
 
@@ -262,8 +462,27 @@ float KeyframeSelector::computeSharpness(const image::Image<unsigned char>& imag
   image::ImageScharrXDerivative(image, scharrXDer); // normalized
   image::ImageScharrYDerivative(image, scharrYDer); // normalized
 
-  scharrXDer = scharrXDer.cwiseAbs(); // absolute value
-  scharrYDer = scharrYDer.cwiseAbs(); // absolute value
+  // integral image of the gradient magnitude, the sum of any window is then
+  // four lookups whatever its size
+  const std::size_t width = image.Width();
+  const std::size_t height = image.Height();
+  Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> integral(height + 1, width + 1);
+  integral.row(0).setZero();
+  integral.col(0).setZero();
+  Eigen::VectorXf magnitudeRow(width);
+
+  for(std::size_t y = 0; y < height; ++y)
+  {
+    magnitudeRow = scharrXDer.GetMat().row(y).cwiseAbs() + scharrYDer.GetMat().row(y).cwiseAbs();
+    const double* above = integral.row(y).data();
+    double* below = integral.row(y + 1).data();
+    double rowSum = 0;
+    for(std::size_t x = 0; x < width; ++x)
+    {
+      rowSum += magnitudeRow(x);
+      below[x + 1] = above[x + 1] + rowSum;
+    }
+  }
 
   // image tiles
   std::vector<float> averageTileIntensity;
@@ -273,8 +492,9 @@ float KeyframeSelector::computeSharpness(const image::Image<unsigned char>& imag
   {
     for(std::size_t x =  0; x < (_nbTileSide * tileWidth); x += tileWidth)
     {
-      const auto sum = scharrXDer.block(y, x, tileHeight, tileWidth).sum() + scharrYDer.block(y, x, tileHeight, tileWidth).sum();
-      averageTileIntensity.push_back(sum * tileSizeInv);
+      const double sum = integral(y + tileHeight, x + tileWidth) - integral(y, x + tileWidth)
+                       - integral(y + tileHeight, x) + integral(y, x);
+      averageTileIntensity.push_back(static_cast<float>(sum) * tileSizeInv);
     }
   }
 
@@ -285,22 +505,120 @@ float KeyframeSelector::computeSharpness(const image::Image<unsigned char>& imag
   return std::accumulate(averageTileIntensity.end() - tileSharpSubset, averageTileIntensity.end(), 0.0f) / tileSharpSubset;
 }
 
+float KeyframeSelector::estimateFlow(const std::vector<image::Image<unsigned char>>& previousLevels,
+                                     const std::vector<image::Image<unsigned char>>& currentLevels) const
+{
+  if(previousLevels.empty() || (previousLevels.size() != currentLevels.size()))
+  {
+    return -1.0f;
+  }
+
+  // mean absolute difference between the previous frame and the current frame
+  // shifted by (shiftX, shiftY)
+  auto shiftCost = [](const image::Image<unsigned char>& previous,
+                      const image::Image<unsigned char>& current,
+                      int shiftX,
+                      int shiftY) -> double
+  {
+    const int width = current.Width();
+    const int height = current.Height();
+    const int xBegin = std::max(0, -shiftX);
+    const int xEnd = std::min(width, width - shiftX);
+    const int yBegin = std::max(0, -shiftY);
+    const int yEnd = std::min(height, height - shiftY);
+
+    if(((xEnd - xBegin) < 8) || ((yEnd - yBegin) < 8))
+    {
+      return std::numeric_limits<double>::max(); // not enough overlap
+    }
+
+    double sum = 0;
+    for(int y = yBegin; y < yEnd; ++y)
+      for(int x = xBegin; x < xEnd; ++x)
+        sum += std::abs(int(previous(y, x)) - int(current(y + shiftY, x + shiftX)));
+
+    return sum / (double(xEnd - xBegin) * double(yEnd - yBegin));
+  };
+
+  int dx = 0;
+  int dy = 0;
+
+  // refine a global translation from the coarsest level to the finest
+  for(std::size_t level = previousLevels.size(); level-- > 0;)
+  {
+    const auto& previous = previousLevels.at(level);
+    const auto& current = currentLevels.at(level);
+
+    if((previous.Width() != current.Width()) || (previous.Height() != current.Height()))
+    {
+      return -1.0f;
+    }
+
+    dx *= 2;
+    dy *= 2;
+
+    // exhaustive search at the coarsest level, small refinement at the others
+    const int searchRadius = (level == previousLevels.size() - 1) ? 8 : 2;
+
+    double bestCost = std::numeric_limits<double>::max();
+    int bestDx = dx;
+    int bestDy = dy;
+
+    for(int sy = -searchRadius; sy <= searchRadius; ++sy)
+    {
+      for(int sx = -searchRadius; sx <= searchRadius; ++sx)
+      {
+        const double cost = shiftCost(previous, current, dx + sx, dy + sy);
+        if(cost < bestCost)
+        {
+          bestCost = cost;
+          bestDx = dx + sx;
+          bestDy = dy + sy;
+        }
+      }
+    }
+
+    if(bestCost == std::numeric_limits<double>::max())
+    {
+      return -1.0f; // levels too small for a meaningful estimate
+    }
+
+    dx = bestDx;
+    dy = bestDy;
+  }
+
+  // the finest kept level is the quarter resolution pyramid level
+  return 4.0f * std::sqrt(float(dx * dx + dy * dy));
+}
+
 
-bool KeyframeSelector::computeFrameData(const image::Image<image::RGBColor>& image,
-                                        std::size_t frameIndex,
-                                        std::size_t mediaIndex,
-                                        unsigned int tileSharpSubset)
+void KeyframeSelector::computeFrameScores(const image::Image<image::RGBColor>& image,
+                                          std::size_t frameIndex,
+                                          std::size_t mediaIndex,
+                                          unsigned int tileSharpSubset,
+                                          feature::ImageDescriber& imageDescriber)
 {
   image::Image<unsigned char> imageGray;                // grayscale image
-  image::Image<unsigned char> imageGrayHalfSample;      // half resolution grayscale image
-  
+
   const auto& currMediaInfo = _mediasInfo.at(mediaIndex);
-  auto& currframeData = _framesData.at(frameIndex);
-  auto& currMediaData = currframeData.mediasData.at(mediaIndex);
+  auto& currMediaData = _framesData.at(frameIndex).mediasData.at(mediaIndex);
+
+  ALICEVISION_LOG_TRACE("media : " << _mediaPaths.at(mediaIndex) << " - frame : " << frameIndex);
 
-  // get grayscale image and resize
+  // get grayscale image and its half resolution level through the shared
+  // pyramid cache, so the sharpness and description stages reuse the same levels
   image::ConvertPixelType(image, &imageGray);
-  image::ImageHalfSample(imageGray, imageGrayHalfSample);
+  const std::size_t nbPyramidLevels = _flowEstimationMode ? 4 : 2;
+  const std::shared_ptr<const image::ImagePyramid<unsigned char>> pyramid =
+      _pyramidCache.get(_mediaPaths.at(mediaIndex) + "#" + std::to_string(frameIndex), imageGray, nbPyramidLevels);
+  const image::Image<unsigned char>& imageGrayHalfSample = pyramid->levels.at(1);
+
+  if(_flowEstimationMode)
+  {
+    // keep the coarsest levels for the flow estimation stage
+    for(std::size_t level = 2; level < pyramid->levels.size(); ++level)
+      currMediaData.flowLevels.push_back(pyramid->levels.at(level));
+  }
 
   // compute sharpness
   currMediaData.sharpness = computeSharpness(imageGrayHalfSample,
@@ -312,35 +630,74 @@ bool KeyframeSelector::computeFrameData(const image::Image<image::RGBColor>& ima
 
   if(currMediaData.sharpness > _sharpnessThreshold)
   {
-    bool noKeyframe = (_keyframeIndexes.empty());
-
-    // compute current frame sparse histogram
+    // compute current frame sparse histogram, the sparse distance to the
+    // keyframes is computed later by the sequential selection stage
     std::unique_ptr<feature::Regions> regions;
-    _imageDescriber->Describe(imageGrayHalfSample, regions);
+    imageDescriber.Describe(imageGrayHalfSample, regions);
     currMediaData.histogram = voctree::SparseHistogram(_voctree->quantizeToSparse(dynamic_cast<feature::SIFT_Regions*>(regions.get())->Descriptors()));
+  }
+}
 
-    // compute sparseDistance
-    if(!noKeyframe)
+bool KeyframeSelector::evaluateFrame(std::size_t frameIndex)
+{
+  auto& currframeData = _framesData.at(frameIndex);
+
+  // a frame can be re-evaluated after a keyframe selection jump, reset the
+  // values of a previous evaluation
+  currframeData.selected = false;
+  currframeData.avgSharpness = 0;
+  currframeData.maxDistScore = 0;
+
+  bool frameSelected = true;
+
+  for(std::size_t mediaIndex = 0; (mediaIndex < currframeData.mediasData.size()) && frameSelected; ++mediaIndex)
+  {
+    auto& currMediaData = currframeData.mediasData.at(mediaIndex);
+    currMediaData.distScore = 0;
+
+    // in flow estimation mode, reject frames with too little estimated motion
+    if(_flowEstimationMode && (currMediaData.flow >= 0) && (currMediaData.flow < _flowMinMagnitude))
     {
-      unsigned int nbKeyframetoCompare = (_keyframeIndexes.size() < _nbKeyFrameDist)? _keyframeIndexes.size() : _nbKeyFrameDist;
+      frameSelected = false; // near static frame
+    }
+    else if(currMediaData.sharpness > _sharpnessThreshold)
+    {
+      const bool noKeyframe = (_keyframeIndexes.empty());
 
-      for(std::size_t i = _keyframeIndexes.size() - nbKeyframetoCompare; i < _keyframeIndexes.size(); ++i)
+      // compute sparseDistance
+      if(!noKeyframe)
       {
-        for(auto& media : _framesData.at(_keyframeIndexes.at(i)).mediasData)
+        unsigned int nbKeyframetoCompare = (_keyframeIndexes.size() < _nbKeyFrameDist)? _keyframeIndexes.size() : _nbKeyFrameDist;
+
+        for(std::size_t i = _keyframeIndexes.size() - nbKeyframetoCompare; i < _keyframeIndexes.size(); ++i)
         {
-          currMediaData.distScore = std::max(currMediaData.distScore, std::abs(voctree::sparseDistance(media.histogram, currMediaData.histogram, "strongCommonPoints")));
+          for(auto& media : _framesData.at(_keyframeIndexes.at(i)).mediasData)
+          {
+            currMediaData.distScore = std::max(currMediaData.distScore, std::abs(voctree::sparseDistance(media.histogram, currMediaData.histogram, "strongCommonPoints")));
+          }
         }
+        currframeData.maxDistScore = std::max(currframeData.maxDistScore, currMediaData.distScore);
+        ALICEVISION_LOG_TRACE(" - distScore : " << currMediaData.distScore);
       }
-      currframeData.maxDistScore = std::max(currframeData.maxDistScore, currMediaData.distScore);
-      ALICEVISION_LOG_TRACE(" - distScore : " << currMediaData.distScore);
-    }
 
-    if(noKeyframe || (currMediaData.distScore < _distScoreMax))
+      if(!noKeyframe && !(currMediaData.distScore < _distScoreMax))
+      {
+        frameSelected = false; // too close to an existing keyframe
+      }
+    }
+    else
     {
-      return true;
+      frameSelected = false; // not sharp enough
     }
-  } 
-  return false;
+  }
+
+  if(frameSelected)
+  {
+    currframeData.selected = true;
+    currframeData.computeAvgSharpness();
+  }
+
+  return frameSelected;
 }
 
 void KeyframeSelector::writeKeyframe(const image::Image<image::RGBColor>& image, 
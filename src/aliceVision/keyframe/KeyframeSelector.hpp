@@ -6,6 +6,7 @@
 #pragma once
 #include <aliceVision/keyframe/SharpnessSelectionPreset.hpp>
 #include <aliceVision/feature/feature.hpp>
+#include <aliceVision/image/ImagePyramidCache.hpp>
 #include <aliceVision/dataio/FeedProvider.hpp>
 #include <aliceVision/voctree/VocabularyTree.hpp>
 
@@ -140,6 +141,33 @@ public:
       _maxOutFrame = nbFrame;
   }
 
+  /**
+   * @brief Set the memory budget of the frame scoring queue
+   * @param[in] memoryBudget maximum memory in bytes used by decoded frames waiting to be scored
+   */
+  void setScoringMemoryBudget(std::size_t memoryBudget)
+  {
+      _scoringMemoryBudget = memoryBudget;
+  }
+
+  /**
+   * @brief Enable or disable the optical flow estimation mode
+   * @param[in] flowEstimationMode if true, frames with too little estimated motion are rejected
+   */
+  void setFlowEstimationMode(bool flowEstimationMode)
+  {
+      _flowEstimationMode = flowEstimationMode;
+  }
+
+  /**
+   * @brief Set the minimum optical flow magnitude of the flow estimation mode
+   * @param[in] flowMinMagnitude minimum mean displacement in pixels between two consecutive frames
+   */
+  void setFlowMinMagnitude(float flowMinMagnitude)
+  {
+      _flowMinMagnitude = flowMinMagnitude;
+  }
+
   /**
    * @brief Get sharp subset size for process algorithm
    * @return sharp part of the image (1 = all, 2 = size/2, ...)
@@ -171,10 +199,37 @@ public:
    * @brief Get max output frame number for process algorithm
    * @return maximum number of output frames (if 0, no limit)
    */
-  unsigned int getMaxOutFrame() const 
+  unsigned int getMaxOutFrame() const
   {
       return _maxOutFrame;
   }
+
+  /**
+   * @brief Get the memory budget of the frame scoring queue
+   * @return maximum memory in bytes used by decoded frames waiting to be scored
+   */
+  std::size_t getScoringMemoryBudget() const
+  {
+      return _scoringMemoryBudget;
+  }
+
+  /**
+   * @brief Get the optical flow estimation mode
+   * @return true if frames with too little estimated motion are rejected
+   */
+  bool getFlowEstimationMode() const
+  {
+      return _flowEstimationMode;
+  }
+
+  /**
+   * @brief Get the minimum optical flow magnitude of the flow estimation mode
+   * @return minimum mean displacement in pixels between two consecutive frames
+   */
+  float getFlowMinMagnitude() const
+  {
+      return _flowMinMagnitude;
+  }
     
 private:
 
@@ -207,18 +262,24 @@ private:
   float _sharpnessThreshold = 15.0f;
   /// Distance max score (image with smallest distance from the last keyframe will be selected)
   float _distScoreMax = 100.0f;
+  /// Memory budget in bytes for the decoded frames waiting in the scoring queue
+  std::size_t _scoringMemoryBudget = std::size_t(1024) * 1024 * 1024;
+  /// If true, frames with an estimated optical flow below _flowMinMagnitude are rejected
+  bool _flowEstimationMode = false;
+  /// Minimum estimated optical flow magnitude in pixels between two consecutive frames
+  float _flowMinMagnitude = 2.0f;
 
   /// Camera metadatas
   std::vector<CameraInfo> _cameraInfos;
 
   // Tools
 
-  /// Image describer in order to extract describer
-  std::unique_ptr<feature::ImageDescriber> _imageDescriber;
   /// Voctree in order to compute sparseHistogram
   std::unique_ptr< aliceVision::voctree::VocabularyTree<DescriptorFloat> > _voctree;
   /// Feed provider for media paths images extraction
   std::vector< std::unique_ptr<dataio::FeedProvider> > _feeds;
+  /// Pyramid cache shared between the sharpness and description stages
+  image::ImagePyramidCache<unsigned char> _pyramidCache{std::size_t(512) * 1024 * 1024};
 
   // Process structures
 
@@ -244,8 +305,12 @@ private:
     float sharpness = 0;
     /// maximum distance score with keyframe media histograms
     float distScore = 0;
+    /// estimated optical flow magnitude from the previous frame (-1 = not computed)
+    float flow = -1;
     /// sparseHistogram
     voctree::SparseHistogram histogram;
+    /// coarse pyramid levels kept for the flow estimation stage
+    std::vector<image::Image<unsigned char>> flowLevels;
   };
 
   /**
@@ -296,17 +361,46 @@ private:
                          const unsigned int tileSharpSubset) const;
 
   /**
-   * @brief Compute sharpness and distance score for a given image
+   * @brief Estimate a global optical flow magnitude between two frames
+   *
+   * Coarse-to-fine translational estimate on the downscaled pyramid levels
+   * kept by the scoring stage.
+   *
+   * @param[in] previousLevels coarse pyramid levels of the previous frame
+   * @param[in] currentLevels coarse pyramid levels of the current frame
+   * @return mean displacement in pixels at full resolution (-1 if not computable)
+   */
+  float estimateFlow(const std::vector<image::Image<unsigned char>>& previousLevels,
+                     const std::vector<image::Image<unsigned char>>& currentLevels) const;
+
+  /**
+   * @brief Compute the sharpness score and sparse histogram of a given image
+   *
+   * Called concurrently by the scoring workers, each worker writes its own
+   * frame / media slot of _framesData.
+   *
    * @param[in] image an image of the media
    * @param[in] frameIndex the image index in the media sequence
    * @param[in] mediaIndex the media index
    * @param[in] tileSharpSubset number of sharp tiles
+   * @param[in,out] imageDescriber the image describer owned by the calling worker
+   */
+  void computeFrameScores(const image::Image<image::RGBColor>& image,
+                          std::size_t frameIndex,
+                          std::size_t mediaIndex,
+                          unsigned int tileSharpSubset,
+                          feature::ImageDescriber& imageDescriber);
+
+  /**
+   * @brief Evaluate a fully scored frame against the keyframes selected so far
+   *
+   * Sequential selection stage, the distance score depends on the previous
+   * keyframe choices.
+   *
+   * @param[in] frameIndex the frame index in the media sequences
    * @return true if the frame is selected
    */
-  bool computeFrameData(const image::Image<image::RGBColor>& image,
-                        std::size_t frameIndex,
-                        std::size_t mediaIndex,
-                        unsigned int tileSharpSubset);
+  bool evaluateFrame(std::size_t frameIndex);
 
   /**
    * @brief Write a keyframe and metadata
@@ -0,0 +1,325 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include "aliceVision/numeric/numeric.hpp"
+#include "aliceVision/linearProgramming/ISolver.hpp"
+
+#include <Eigen/SparseCholesky>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace aliceVision   {
+namespace linearProgramming  {
+
+/**
+ * @brief First-order operator-splitting LP solver (ADMM, OSQP-style).
+ *
+ * The problem is put in the form min c^t x s.t. l <= Ax <= u (the variable
+ * bounds become identity rows of A) and solved with the alternating direction
+ * method of multipliers: a quasi-definite linear solve against
+ * (sigma I + rho A^t A), a projection on the [l, u] box and a dual update,
+ * with the over-relaxation and the primal/dual infeasibility certificates of
+ * the OSQP formulation.
+ *
+ * The problem is equilibrated with Ruiz diagonal scaling and the step rho is
+ * adapted from the primal/dual residual balance, which keeps the iteration
+ * count stable on the badly scaled constraint blocks of the L-infinity
+ * formulations.
+ *
+ * Unlike the simplex of the OSI-CLP backend, an iteration costs one sparse
+ * back-substitution, and the solver warm starts itself: the primal/dual
+ * iterates are kept between the setup() calls and the factorization is reused
+ * whenever the constraint matrix does not change. Inside BisectionLP, where
+ * only gamma moves between two solves, each bisection step restarts from the
+ * previous solution and converges in a few iterations.
+ */
+class ADMMSolver : public ISolver
+{
+public:
+
+  explicit ADMMSolver(int nbParams)
+    : ISolver(nbParams)
+    , _maxIterations(20000)
+    , _epsConvergence(1e-7)
+    , _epsInfeasible(1e-5)
+    , _rho(0.1)
+    , _sigma(1e-6)
+    , _alpha(1.6)
+    , _statusSolved(false)
+  {}
+
+  /// Stop criteria of the iterations (infinity norm of the primal and dual residuals)
+  void setTolerance(double epsConvergence) { _epsConvergence = epsConvergence; }
+  void setMaxIterations(int maxIterations) { _maxIterations = maxIterations; }
+
+  bool setup(const LPConstraints & cstraints)
+  {
+    assert(_nbParams == cstraints._constraintMat.cols());
+    const Mat & A = cstraints._constraintMat;
+    std::vector<Eigen::Triplet<double> > triplets;
+    triplets.reserve(A.rows() * A.cols());
+    for (int i = 0; i < A.rows(); ++i)
+      for (int j = 0; j < A.cols(); ++j)
+        if (A(i, j) != 0.0)
+          triplets.push_back(Eigen::Triplet<double>(i, j, A(i, j)));
+    return setupProblem(triplets, static_cast<int>(A.rows()), cstraints._Cst_objective,
+                        cstraints._vec_sign, cstraints._vec_bounds,
+                        cstraints._vec_cost, cstraints._bminimize);
+  }
+
+  bool setup(const LPConstraintsSparse & cstraints)
+  {
+    assert(_nbParams == cstraints._nbParams);
+    std::vector<Eigen::Triplet<double> > triplets;
+    triplets.reserve(cstraints._constraintMat.nonZeros());
+    for (int i = 0; i < cstraints._constraintMat.outerSize(); ++i)
+      for (sRMat::InnerIterator it(cstraints._constraintMat, i); it; ++it)
+        triplets.push_back(Eigen::Triplet<double>(it.row(), it.col(), it.value()));
+    return setupProblem(triplets, static_cast<int>(cstraints._constraintMat.rows()),
+                        cstraints._Cst_objective, cstraints._vec_sign,
+                        cstraints._vec_bounds, cstraints._vec_cost, cstraints._bminimize);
+  }
+
+  bool solve()
+  {
+    _statusSolved = false;
+    const int m = static_cast<int>(_A.rows());
+
+    Vec deltaY = Vec::Zero(m);
+    for (int iteration = 0; iteration < _maxIterations; ++iteration)
+    {
+      // x update: (sigma I + rho A^t A) x = sigma x - c + A^t (rho z - y)
+      const Vec rhs = _sigma * _x - _c + _At * (_rho * _z - _y);
+      const Vec xNext = _ldlt.solve(rhs);
+      const Vec zHat = _A * xNext;
+
+      // Over-relaxation, box projection and dual update
+      _x = _alpha * xNext + (1.0 - _alpha) * _x;
+      const Vec zRelaxed = _alpha * zHat + (1.0 - _alpha) * _z;
+      const Vec zNext = (zRelaxed + _y / _rho).cwiseMax(_l).cwiseMin(_u);
+      deltaY = _rho * (zRelaxed - zNext);
+      _y += deltaY;
+      _z = zNext;
+
+      if ((iteration % 25) != 0)
+        continue;
+
+      // Convergence on the unscaled residuals: primal Ax - z, dual c + A^t y
+      const Vec scaledPrimal = _A * _x - _z;
+      const Vec scaledDual = _c + _At * _y;
+      const double primalResidual = (scaledPrimal.cwiseQuotient(_E)).lpNorm<Eigen::Infinity>();
+      const double dualResidual = (scaledDual.cwiseQuotient(_D)).lpNorm<Eigen::Infinity>();
+      if (primalResidual < _epsConvergence && dualResidual < _epsConvergence)
+      {
+        _statusSolved = true;
+        return true;
+      }
+
+      // Primal infeasibility certificate on the dual update direction:
+      // A^t dy ~ 0 and the support function of the [l, u] box at dy is negative
+      const double deltaYNorm = deltaY.lpNorm<Eigen::Infinity>();
+      if (deltaYNorm > 0.0 &&
+          (_At * deltaY).lpNorm<Eigen::Infinity>() < _epsInfeasible * deltaYNorm &&
+          boxSupport(deltaY) < -_epsInfeasible * deltaYNorm)
+        return false;
+
+      // Balance the residuals by adapting rho, refactorize on a large change
+      if ((iteration % 200) == 0 && iteration > 0 && dualResidual > 0.0)
+      {
+        const double scaledPrimalNorm = scaledPrimal.lpNorm<Eigen::Infinity>() /
+          std::max(1e-10, std::max(_z.lpNorm<Eigen::Infinity>(), (_A * _x).lpNorm<Eigen::Infinity>()));
+        const double scaledDualNorm = scaledDual.lpNorm<Eigen::Infinity>() /
+          std::max(1e-10, std::max(_c.lpNorm<Eigen::Infinity>(), (_At * _y).lpNorm<Eigen::Infinity>()));
+        const double rhoNext = std::min(1e6, std::max(1e-6,
+          _rho * std::sqrt(scaledPrimalNorm / std::max(1e-10, scaledDualNorm))));
+        if (rhoNext > 5.0 * _rho || rhoNext < _rho / 5.0)
+        {
+          _rho = rhoNext;
+          if (!factorize())
+            return false;
+        }
+      }
+    }
+    // No certificate found: report the iterate only if it is almost feasible
+    _statusSolved = ((_A * _x - _z).cwiseQuotient(_E)).lpNorm<Eigen::Infinity>() < 1e2 * _epsConvergence;
+    return _statusSolved;
+  }
+
+  bool getSolution(std::vector<double> & estimatedParams)
+  {
+    if (!_statusSolved)
+      return false;
+    estimatedParams.resize(_nbParams);
+    for (int i = 0; i < _nbParams; ++i)
+      estimatedParams[i] = _D(i) * _x(i); // undo the equilibration
+    return true;
+  }
+
+private:
+
+  /// Infinity of the [l, u] box (same convention as the OSI backend)
+  static double infinity() { return 1e30; }
+
+  /// Support function of the [l, u] box in the given direction; +inf bounds
+  /// make the support infinite unless the matching component is (almost) zero
+  double boxSupport(const Vec & direction) const
+  {
+    const double tolerance = 1e-12 * direction.lpNorm<Eigen::Infinity>();
+    double support = 0.0;
+    for (int i = 0; i < direction.size(); ++i)
+    {
+      if (direction(i) > tolerance)
+      {
+        if (_u(i) >= infinity())
+          return std::numeric_limits<double>::infinity();
+        support += _u(i) * direction(i);
+      }
+      else if (direction(i) < -tolerance)
+      {
+        if (_l(i) <= -infinity())
+          return std::numeric_limits<double>::infinity();
+        support += _l(i) * direction(i);
+      }
+    }
+    return support;
+  }
+
+  bool setupProblem(const std::vector<Eigen::Triplet<double> > & constraintTriplets,
+                    int nbConstraints,
+                    const Vec & Cst_objective,
+                    const std::vector<LPConstraints::eLP_SIGN> & vec_sign,
+                    const std::vector< std::pair<double, double> > & vec_bounds,
+                    const std::vector<double> & vec_cost,
+                    bool bminimize)
+  {
+    const int n = _nbParams;
+    const int m = nbConstraints + n; // constraint rows + variable bounds rows
+
+    // min c^t x (an empty cost is a pure feasibility problem)
+    _c = Vec::Zero(n);
+    for (size_t i = 0; i < vec_cost.size(); ++i)
+      _c(i) = bminimize ? vec_cost[i] : -vec_cost[i];
+
+    // l <= Ax <= u
+    std::vector<Eigen::Triplet<double> > triplets = constraintTriplets;
+    triplets.reserve(triplets.size() + n);
+    _l = Vec::Constant(m, -infinity());
+    _u = Vec::Constant(m, infinity());
+    for (int i = 0; i < nbConstraints; ++i)
+    {
+      switch (vec_sign[i])
+      {
+        case LPConstraints::LP_LESS_OR_EQUAL:    _u(i) = Cst_objective(i); break;
+        case LPConstraints::LP_GREATER_OR_EQUAL: _l(i) = Cst_objective(i); break;
+        case LPConstraints::LP_EQUAL:            _l(i) = _u(i) = Cst_objective(i); break;
+        case LPConstraints::LP_FREE: break;
+      }
+    }
+    for (int i = 0; i < n; ++i)
+    {
+      triplets.push_back(Eigen::Triplet<double>(nbConstraints + i, i, 1.0));
+      const std::pair<double, double> & bounds =
+        (vec_bounds.size() == 1) ? vec_bounds[0] : vec_bounds[i];
+      _l(nbConstraints + i) = bounds.first;
+      _u(nbConstraints + i) = bounds.second;
+    }
+
+    sMat A(m, n);
+    A.setFromTriplets(triplets.begin(), triplets.end());
+
+    // Warm start: keep the iterates of the previous solve when the problem
+    // keeps its shape (the bisection moves gamma, not the unknowns), and the
+    // factorization when the constraint matrix itself is unchanged
+    const bool sameShape = (_unscaledA.rows() == m && _unscaledA.cols() == n);
+    const bool sameMatrix = sameShape && (_unscaledA.nonZeros() == A.nonZeros()) &&
+      Eigen::Map<const Vec>(_unscaledA.valuePtr(), _unscaledA.nonZeros())
+        .isApprox(Eigen::Map<const Vec>(A.valuePtr(), A.nonZeros()));
+    if (!sameShape)
+    {
+      _x = Vec::Zero(n);
+      _z = Vec::Zero(m);
+      _y = Vec::Zero(m);
+    }
+    if (!sameMatrix)
+    {
+      _unscaledA = A;
+      equilibrate(A);
+      _A = A;
+      _At = _A.transpose();
+      if (!factorize())
+        return false;
+    }
+
+    // Apply the equilibration on the cost and the box
+    _c = _D.cwiseProduct(_c);
+    for (int i = 0; i < m; ++i)
+    {
+      if (_l(i) > -infinity())
+        _l(i) *= _E(i);
+      if (_u(i) < infinity())
+        _u(i) *= _E(i);
+    }
+    _statusSolved = false;
+    return true;
+  }
+
+  /// Ruiz equilibration: iteratively normalize the infinity norm of the rows
+  /// and columns, A is scaled in place and the diagonals are kept in _D / _E
+  void equilibrate(sMat & A)
+  {
+    const int m = static_cast<int>(A.rows());
+    const int n = static_cast<int>(A.cols());
+    _D = Vec::Ones(n);
+    _E = Vec::Ones(m);
+    for (int pass = 0; pass < 10; ++pass)
+    {
+      Vec rowNorm = Vec::Zero(m);
+      Vec colNorm = Vec::Zero(n);
+      for (int k = 0; k < A.outerSize(); ++k)
+        for (sMat::InnerIterator it(A, k); it; ++it)
+        {
+          rowNorm(it.row()) = std::max(rowNorm(it.row()), std::abs(it.value()));
+          colNorm(it.col()) = std::max(colNorm(it.col()), std::abs(it.value()));
+        }
+      const Vec rowScale = rowNorm.cwiseMax(1e-12).cwiseSqrt().cwiseInverse();
+      const Vec colScale = colNorm.cwiseMax(1e-12).cwiseSqrt().cwiseInverse();
+      for (int k = 0; k < A.outerSize(); ++k)
+        for (sMat::InnerIterator it(A, k); it; ++it)
+          it.valueRef() *= rowScale(it.row()) * colScale(it.col());
+      _E = _E.cwiseProduct(rowScale);
+      _D = _D.cwiseProduct(colScale);
+    }
+  }
+
+  /// (Re)factorize sigma I + rho A^t A with the current rho
+  bool factorize()
+  {
+    sMat normalMat = (_At * _A) * _rho;
+    for (int i = 0; i < _nbParams; ++i)
+      normalMat.coeffRef(i, i) += _sigma;
+    _ldlt.compute(normalMat);
+    return _ldlt.info() == Eigen::Success;
+  }
+
+  int _maxIterations;
+  double _epsConvergence;
+  double _epsInfeasible;
+  double _rho, _sigma, _alpha; // ADMM step, regularization and over-relaxation
+
+  sMat _unscaledA; // box constraints matrix as given, to detect matrix reuse
+  sMat _A, _At; // equilibrated constraints matrix and its transpose
+  Vec _D, _E; // column / row equilibration diagonals
+  Vec _l, _u, _c; // equilibrated box and cost
+  Vec _x, _z, _y; // primal, auxiliary and dual iterates, kept across the solves
+  Eigen::SimplicialLDLT<sMat> _ldlt; // factorization of sigma I + rho A^t A
+  bool _statusSolved;
+};
+
+} // namespace linearProgramming
+} // namespace aliceVision
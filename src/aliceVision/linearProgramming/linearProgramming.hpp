@@ -9,6 +9,7 @@
 #include <aliceVision/linearProgramming/bisectionLP.hpp>
 #include <aliceVision/linearProgramming/ISolver.hpp>
 #include <aliceVision/linearProgramming/OSIXSolver.hpp>
+#include <aliceVision/linearProgramming/ADMMSolver.hpp>
 
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_MOSEK)
 #include <aliceVision/linearProgramming/MOSEKSolver.hpp>
@@ -12,6 +12,7 @@
 #include "aliceVision/linearProgramming/MOSEKSolver.hpp"
 #endif
 #include "aliceVision/linearProgramming/OSIXSolver.hpp"
+#include "aliceVision/linearProgramming/ADMMSolver.hpp"
 
 #define BOOST_TEST_MODULE linearProgramming
 #include <boost/test/included/unit_test.hpp>
@@ -216,3 +217,61 @@ BOOST_AUTO_TEST_CASE(linearProgramming_osi_mosek_sparse_sample) {
   BOOST_CHECK_SMALL( 8.33-vec_solution[3], 1e-2);
 }
 #endif // #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_MOSEK)
+
+BOOST_AUTO_TEST_CASE(linearProgramming_admm_dense_sample) {
+
+  LPConstraints cstraint;
+  BuildLinearProblem(cstraint);
+
+  //Solve
+  std::vector<double> vec_solution(2);
+  ADMMSolver solver(2);
+  solver.setup(cstraint);
+
+  BOOST_CHECK(solver.solve());
+  solver.getSolution(vec_solution);
+
+  // First order solver: looser tolerance than the simplex backends
+  BOOST_CHECK_SMALL( 21.875000-vec_solution[0], 1e-3);
+  BOOST_CHECK_SMALL( 53.125000-vec_solution[1], 1e-3);
+}
+
+BOOST_AUTO_TEST_CASE(linearProgramming_admm_sparse_sample) {
+
+  LPConstraintsSparse cstraint;
+  BuildSparseLinearProblem(cstraint);
+
+  //Solve
+  std::vector<double> vec_solution(4);
+  ADMMSolver solver(4);
+  solver.setup(cstraint);
+
+  BOOST_CHECK(solver.solve());
+  solver.getSolution(vec_solution);
+
+  BOOST_CHECK_SMALL(vec_solution[0], 1e-2);
+  BOOST_CHECK_SMALL(vec_solution[1], 1e-2);
+  BOOST_CHECK_SMALL( 15-vec_solution[2], 1e-2);
+  BOOST_CHECK_SMALL( 8.33-vec_solution[3], 1e-2);
+}
+
+BOOST_AUTO_TEST_CASE(linearProgramming_admm_infeasible) {
+
+  // x >= 2 and x <= 1 cannot hold together
+  LPConstraints cstraint;
+  cstraint._nbParams = 1;
+  cstraint._bminimize = true;
+  cstraint._constraintMat = Mat(2,1);
+  cstraint._constraintMat << 1, 1;
+  cstraint._Cst_objective = Vec(2);
+  cstraint._Cst_objective << 2, 1;
+  cstraint._vec_sign.resize(2);
+  cstraint._vec_sign[0] = LPConstraints::LP_GREATER_OR_EQUAL;
+  cstraint._vec_sign[1] = LPConstraints::LP_LESS_OR_EQUAL;
+  cstraint._vec_bounds = std::vector< std::pair<double,double> >(1,
+    std::make_pair((double)-1e+30, (double)1e+30));
+
+  ADMMSolver solver(1);
+  solver.setup(cstraint);
+  BOOST_CHECK(!solver.solve());
+}
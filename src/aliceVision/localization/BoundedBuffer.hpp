@@ -7,6 +7,11 @@
 
 #include <deque>
 #include <assert.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace aliceVision {
 namespace localization {
@@ -88,6 +93,189 @@ public:
     _buffer.emplace_back(args...);
   }
 
+  /**
+   * @brief Remove all the elements of the buffer; its maximum size is kept.
+   */
+  void clear()
+  {
+    _buffer.clear();
+  }
+
+};
+
+/**
+ * @brief A fixed-capacity FIFO queue handing elements from a producer thread
+ * to a consumer thread. Unlike BoundedBuffer, which silently drops its oldest
+ * element on overflow, a full queue blocks the producer and an empty queue
+ * blocks the consumer, so it can connect pipeline stages without losing any
+ * element.
+ */
+template<class T>
+class ConcurrentBoundedQueue
+{
+
+private:
+
+  std::deque<T> _buffer;
+
+  /// The fixed maximum size of the queue
+  std::size_t _maxSize;
+
+  /// Set by close(), no further element will be pushed
+  bool _closed;
+
+  std::mutex _mutex;
+  std::condition_variable _notFull;
+  std::condition_variable _notEmpty;
+
+public:
+
+  /**
+   * @brief Build a concurrent bounded queue of the given capacity.
+   * @param[in] maxSize The maximum number of elements the queue can hold
+   * before push() blocks the producer.
+   */
+  ConcurrentBoundedQueue(std::size_t maxSize) : _maxSize(maxSize), _closed(false) { }
+
+  /**
+   * @brief Append an element at the end of the queue, blocking while the
+   * queue is full.
+   * @param[in] element The element to add.
+   */
+  void push(T element)
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _notFull.wait(lock, [this]{ return _buffer.size() < _maxSize; });
+    _buffer.push_back(std::move(element));
+    _notEmpty.notify_one();
+  }
+
+  /**
+   * @brief Remove the first element of the queue, blocking while the queue
+   * is empty and not yet closed.
+   * @param[out] element The removed element.
+   * @return false when the queue has been closed and drained, true otherwise.
+   */
+  bool pop(T& element)
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _notEmpty.wait(lock, [this]{ return !_buffer.empty() || _closed; });
+    if(_buffer.empty())
+    {
+      return false;
+    }
+    element = std::move(_buffer.front());
+    _buffer.pop_front();
+    _notFull.notify_one();
+    return true;
+  }
+
+  /**
+   * @brief Signal that no further element will be pushed; pending elements
+   * can still be popped, then pop() returns false.
+   */
+  void close()
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _closed = true;
+    _notEmpty.notify_all();
+  }
+
+};
+
+/**
+ * @brief A lock-free single-producer/single-consumer ring buffer with the same
+ * push/pop/close interface as ConcurrentBoundedQueue. Producer and consumer
+ * only synchronize through two atomic indices, so an element handoff costs a
+ * couple of atomic operations instead of a mutex round trip; a full or empty
+ * queue is waited out by yielding instead of sleeping on a condition variable.
+ *
+ * Exactly one thread may push and exactly one thread may pop; when several
+ * producers or consumers share the queue, use ConcurrentBoundedQueue instead.
+ */
+template<class T>
+class LockFreeSpscQueue
+{
+
+private:
+
+  /// Storage for maxSize elements plus the sentinel slot separating head from tail
+  std::vector<T> _buffer;
+
+  /// Index of the next element to pop, written by the consumer only
+  std::atomic<std::size_t> _head;
+
+  /// Index of the next free slot, written by the producer only
+  std::atomic<std::size_t> _tail;
+
+  /// Set by close(), no further element will be pushed
+  std::atomic<bool> _closed;
+
+  std::size_t increment(std::size_t index) const
+  {
+    return (index + 1) % _buffer.size();
+  }
+
+public:
+
+  /**
+   * @brief Build a lock-free queue of the given capacity.
+   * @param[in] maxSize The maximum number of elements the queue can hold
+   * before push() waits for the consumer.
+   */
+  LockFreeSpscQueue(std::size_t maxSize) : _buffer(maxSize + 1), _head(0), _tail(0), _closed(false) { }
+
+  /**
+   * @brief Append an element at the end of the queue, yielding while the
+   * queue is full. Must be called from a single producer thread.
+   * @param[in] element The element to add.
+   */
+  void push(T element)
+  {
+    const std::size_t tail = _tail.load(std::memory_order_relaxed);
+    const std::size_t next = increment(tail);
+    while(next == _head.load(std::memory_order_acquire))
+    {
+      std::this_thread::yield();
+    }
+    _buffer[tail] = std::move(element);
+    _tail.store(next, std::memory_order_release);
+  }
+
+  /**
+   * @brief Remove the first element of the queue, yielding while the queue
+   * is empty and not yet closed. Must be called from a single consumer thread.
+   * @param[out] element The removed element.
+   * @return false when the queue has been closed and drained, true otherwise.
+   */
+  bool pop(T& element)
+  {
+    const std::size_t head = _head.load(std::memory_order_relaxed);
+    while(head == _tail.load(std::memory_order_acquire))
+    {
+      // re-check the tail after the closed flag so an element pushed right
+      // before close() is still popped
+      if(_closed.load(std::memory_order_acquire) &&
+         head == _tail.load(std::memory_order_acquire))
+      {
+        return false;
+      }
+      std::this_thread::yield();
+    }
+    element = std::move(_buffer[head]);
+    _head.store(increment(head), std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Signal that no further element will be pushed; pending elements
+   * can still be popped, then pop() returns false.
+   */
+  void close()
+  {
+    _closed.store(true, std::memory_order_release);
+  }
+
 };
 
 }
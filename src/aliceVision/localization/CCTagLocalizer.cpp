@@ -125,6 +125,33 @@ bool CCTagLocalizer::loadReconstructionDescriptors(const sfm::SfMData & sfm_data
     }
   }
 
+  // Build the marker visibility index: for each reconstructed marker id, the
+  // views observing it and the 3D point associated to the marker in each view,
+  // along with the per-view visibility descriptors. This makes the per-frame
+  // association a lookup instead of a scan over all the region sets.
+  for(const auto &iter : _regionsPerView.getData())
+  {
+    const IndexT id_view = iter.first;
+    const feature::CCTAG_Regions& cctagRegions = iter.second.getRegions<feature::CCTAG_Regions>(_cctagDescType);
+
+    _markerViewDescriptors[id_view] = constructCCTagViewDescriptor(cctagRegions.Descriptors());
+
+    if(cctagRegions.Descriptors().empty())
+      continue;
+
+    const ReconstructedRegionsMapping& regionsMapping = _reconstructedRegionsMappingPerView.at(id_view).at(_cctagDescType);
+    for(std::size_t i = 0; i < cctagRegions.Descriptors().size(); ++i)
+    {
+      const IndexT markerId = feature::getCCTagId(cctagRegions.Descriptors()[i]);
+      if(markerId == UndefinedIndexT)
+        continue;
+
+      CCTagObservation observation;
+      observation.viewId = id_view;
+      observation.landmarkId = regionsMapping._associated3dPoint[i];
+      _markerVisibility[markerId].push_back(observation);
+    }
+  }
 
   {
     std::set<int> presentCCtagIds;
@@ -134,7 +161,8 @@ bool CCTagLocalizer::loadReconstructionDescriptors(const sfm::SfMData & sfm_data
     for(const auto &iter : sfm_data.GetViews())
     {
       const IndexT id_view = iter.second->getViewId();
-      const feature::Regions& regions = _regionsPerView.getRegions(id_view, _cctagDescType);
+      const feature::RegionsHandle regionsHandle = _regionsPerView.getRegions(id_view, _cctagDescType);
+      const feature::Regions& regions = *regionsHandle;
       const std::string &sImageName = iter.second.get()->getImagePath();
       std::stringstream ss;
 
@@ -383,6 +411,30 @@ bool CCTagLocalizer::localizeRig(const std::vector<image::Image<unsigned char> >
                                  const std::vector<geometry::Pose3 > &vec_subPoses,
                                  geometry::Pose3 &rigPose,
                                  std::vector<localization::LocalizationResult> & vec_locResults)
+{
+  const size_t numCams = vec_imageGrey.size();
+  assert(numCams == vec_queryIntrinsics.size());
+  assert(numCams == vec_subPoses.size() + 1);
+
+  std::vector<feature::MapRegionsPerDesc> vec_queryRegions;
+  std::vector<std::pair<std::size_t, std::size_t> > vec_imageSize;
+
+  if(!extractRigRegions(vec_imageGrey, parameters, vec_queryRegions, vec_imageSize))
+    return false;
+
+  return localizeRig(vec_queryRegions,
+                     vec_imageSize,
+                     parameters,
+                     vec_queryIntrinsics,
+                     vec_subPoses,
+                     rigPose,
+                     vec_locResults);
+}
+
+bool CCTagLocalizer::extractRigRegions(const std::vector<image::Image<unsigned char> > & vec_imageGrey,
+                                       const LocalizerParameters *parameters,
+                                       std::vector<feature::MapRegionsPerDesc> & vec_queryRegions,
+                                       std::vector<std::pair<std::size_t, std::size_t> > & vec_imageSize)
 {
   const CCTagLocalizer::Parameters *param = static_cast<const CCTagLocalizer::Parameters *>(parameters);
   if(!param)
@@ -390,13 +442,11 @@ bool CCTagLocalizer::localizeRig(const std::vector<image::Image<unsigned char> >
     throw std::invalid_argument("The CCTag localizer parameters are not in the right format.");
   }
   const size_t numCams = vec_imageGrey.size();
-  assert(numCams == vec_queryIntrinsics.size());
-  assert(numCams == vec_subPoses.size() + 1);
 
-  std::vector<feature::MapRegionsPerDesc> vec_queryRegions(numCams);
-  std::vector<std::pair<std::size_t, std::size_t> > vec_imageSize;
-  
-  //@todo parallelize?
+  vec_queryRegions.clear();
+  vec_queryRegions.resize(numCams);
+  vec_imageSize.clear();
+
   for(size_t i = 0; i < numCams; ++i)
   {
     // extract descriptors and features from each image
@@ -408,14 +458,8 @@ bool CCTagLocalizer::localizeRig(const std::vector<image::Image<unsigned char> >
     vec_imageSize.emplace_back(vec_imageGrey[i].Width(), vec_imageGrey[i].Height());
   }
   assert(vec_imageSize.size() == vec_queryRegions.size());
-          
-  return localizeRig(vec_queryRegions,
-                     vec_imageSize,
-                     parameters,
-                     vec_queryIntrinsics,
-                     vec_subPoses,
-                     rigPose,
-                     vec_locResults);
+
+  return true;
 }
 
 bool CCTagLocalizer::localizeRig(const std::vector<feature::MapRegionsPerDesc> & vec_queryRegions,
@@ -754,35 +798,67 @@ void CCTagLocalizer::getAllAssociations(const feature::CCTAG_Regions &queryRegio
 {
   std::vector<IndexT> nearestKeyFrames;
   nearestKeyFrames.reserve(param._nNearestKeyFrames);
-  
-  kNearestKeyFrames(queryRegions,
-                    _cctagDescType,
-                    _regionsPerView,
+
+  // the visibility descriptor of the query
+  const std::bitset<128> queryViewDescriptor = constructCCTagViewDescriptor(queryRegions.Descriptors());
+
+  kNearestKeyFrames(queryViewDescriptor,
                     param._nNearestKeyFrames,
                     nearestKeyFrames);
-  
+
   out_matchedImages.clear();
   out_matchedImages.reserve(nearestKeyFrames.size());
-  
+
   ALICEVISION_LOG_DEBUG("nearestKeyFrames.size() = " << nearestKeyFrames.size());
   for(const IndexT keyframeId : nearestKeyFrames)
   {
     ALICEVISION_LOG_DEBUG(keyframeId);
     ALICEVISION_LOG_DEBUG(_sfm_data.GetViews().at(keyframeId)->getImagePath());
-    const feature::Regions& matchedRegions = _regionsPerView.getRegions(keyframeId, _cctagDescType);
-    const ReconstructedRegionsMapping& regionsMapping = _reconstructedRegionsMappingPerView.at(keyframeId).at(_cctagDescType);
-    const feature::CCTAG_Regions & matchedCCtagRegions = dynamic_cast<const feature::CCTAG_Regions &>(matchedRegions);
-
-    // Matching
-    std::vector<matching::IndMatch> vec_featureMatches;
-    viewMatching(queryRegions, matchedCCtagRegions, vec_featureMatches);
-    ALICEVISION_LOG_DEBUG("[matching]\tFound "<< vec_featureMatches.size() <<" matches.");
-    
-    out_matchedImages.emplace_back(keyframeId, vec_featureMatches.size());
-    
+    const std::bitset<128>& keyframeViewDescriptor = _markerViewDescriptors.at(keyframeId);
+
+    // Recover the 2D-3D associations from the precomputed marker visibility:
+    // each query marker visible in the keyframe is associated to the 3D point
+    // observed as that marker in the keyframe
+    std::size_t numMatches = 0;
+    for(std::size_t i = 0; i < queryRegions.Descriptors().size(); ++i)
+    {
+      const IndexT markerId = feature::getCCTagId(queryRegions.Descriptors()[i]);
+      if(markerId == UndefinedIndexT || !keyframeViewDescriptor.test(markerId))
+        continue;
+
+      // the ID of the 3D point associated to the marker in the keyframe
+      for(const CCTagObservation& observation : _markerVisibility.at(markerId))
+      {
+        if(observation.viewId != keyframeId)
+          continue;
+
+        const IndMatch3D2D key(observation.landmarkId, _cctagDescType, i);
+        if(out_occurences.count(key))
+        {
+          out_occurences[key]++;
+        }
+        else
+        {
+          out_occurences[key] = 1;
+        }
+        ++numMatches;
+        break;
+      }
+    }
+    ALICEVISION_LOG_DEBUG("[matching]\tFound "<< numMatches <<" matches.");
+
+    out_matchedImages.emplace_back(keyframeId, numMatches);
+
     if(!param._visualDebug.empty() && !imagePath.empty())
     {
       namespace bfs = boost::filesystem;
+
+      // the svg export needs the explicit feature matches, recompute them from the stored regions
+      const feature::RegionsHandle matchedRegionsHandle = _regionsPerView.getRegions(keyframeId, _cctagDescType);
+      const feature::CCTAG_Regions & matchedCCtagRegions = dynamic_cast<const feature::CCTAG_Regions &>(*matchedRegionsHandle);
+      std::vector<matching::IndMatch> vec_featureMatches;
+      viewMatching(queryRegions, matchedCCtagRegions, vec_featureMatches);
+
       const sfm::View *mview = _sfm_data.GetViews().at(keyframeId).get();
       const std::string queryImage = bfs::path(imagePath).stem().string();
       const std::string matchedImage = bfs::path(mview->getImagePath()).stem().string();
@@ -814,30 +890,8 @@ void CCTagLocalizer::getAllAssociations(const feature::CCTAG_Regions &queryRegio
                                      outputName.string(),
                                      showNotMatched ); 
     }
-    
-    // Recover the 2D-3D associations from the matches 
-    // Each matched feature in the current similar image is associated to a 3D point,
-    // hence we can recover the 2D-3D associations to estimate the pose
-    
-    // Get the 3D points associated to each matched feature
-    for(const matching::IndMatch& featureMatch : vec_featureMatches)
-    {
-      // the ID of the 3D point
-      const IndexT pt3D_id = regionsMapping._associated3dPoint[featureMatch._j];
-      const IndexT pt2D_id = featureMatch._i;
-      
-      const IndMatch3D2D key(pt3D_id, _cctagDescType, pt2D_id);
-      if(out_occurences.count(key))
-      {
-        out_occurences[key]++;
-      }
-      else
-      {
-        out_occurences[key] = 1;
-      }
-    }
   }
-      
+
   const size_t numCollectedPts = out_occurences.size();
   ALICEVISION_LOG_DEBUG("[matching]\tCollected "<< numCollectedPts <<" associations.");
   
@@ -894,6 +948,41 @@ void CCTagLocalizer::getAllAssociations(const feature::CCTAG_Regions &queryRegio
 }
 
 
+void CCTagLocalizer::kNearestKeyFrames(const std::bitset<128> & queryViewDescriptor,
+                                       std::size_t nNearestKeyFrames,
+                                       std::vector<IndexT> & out_kNearestFrames,
+                                       float similarityThreshold) const
+{
+  out_kNearestFrames.clear();
+
+  // A std::multimap is used instead of a std::map because is very likely that the
+  // similarity measure is equal for a subset of views in the CCTag regions case.
+  std::multimap<float, IndexT> sortedViewSimilarities;
+
+  for(const auto & keyFrame : _markerViewDescriptors)
+  {
+    // The similarity is the number of markers visible in both views.
+    const float similarity = (queryViewDescriptor & keyFrame.second).count();
+    sortedViewSimilarities.emplace(similarity, keyFrame.first);
+  }
+
+  std::size_t counter = 0;
+  out_kNearestFrames.reserve(nNearestKeyFrames);
+  for (auto rit = sortedViewSimilarities.crbegin(); rit != sortedViewSimilarities.crend(); ++rit)
+  {
+    if(rit->first < similarityThreshold)
+      // since it is ordered, the first having smaller similarity guarantees that
+      // there won't be other useful kframes
+      break;
+
+    out_kNearestFrames.push_back(rit->second);
+    ++counter;
+
+    if (counter == nNearestKeyFrames)
+      break;
+  }
+}
+
 void kNearestKeyFrames(const feature::CCTAG_Regions & queryRegions,
                        feature::EImageDescriberType cctagDescType,
                        const feature::RegionsPerView & regionsPerView,
@@ -98,7 +98,12 @@ public:
                    const std::vector<geometry::Pose3 > &vec_subPoses,
                    geometry::Pose3 &rigPose,
                    std::vector<LocalizationResult>& vec_locResults) override;
-  
+
+  bool extractRigRegions(const std::vector<image::Image<unsigned char> > & vec_imageGrey,
+                         const LocalizerParameters *param,
+                         std::vector<feature::MapRegionsPerDesc> & vec_queryRegions,
+                         std::vector<std::pair<std::size_t, std::size_t> > & vec_imageSize) override;
+
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_OPENGV)
   bool localizeRig_opengv(const std::vector<feature::MapRegionsPerDesc> & vec_queryRegions,
                           const std::vector<std::pair<std::size_t, std::size_t> > &imageSize,
@@ -146,16 +151,48 @@ public:
   virtual ~CCTagLocalizer();
 
 private:
-  
+
+  /// A reconstructed CCTag marker as observed in a given view.
+  struct CCTagObservation
+  {
+    /// the id of the view observing the marker
+    IndexT viewId;
+    /// the id of the 3D point associated to the marker in that view
+    IndexT landmarkId;
+  };
+
   bool loadReconstructionDescriptors(
     const sfm::SfMData & sfm_data,
     const std::string & feat_directory);
-  
+
+  /**
+   * @brief Retrieve the k nearest views using the precomputed per-view marker
+   * visibility descriptors (\p _markerViewDescriptors) instead of scanning all
+   * the region sets of the database.
+   *
+   * @param[in] queryViewDescriptor The view descriptor of the query image.
+   * @param[in] nNearestKeyFrames Number of nearest neighbours to return.
+   * @param[out] out_kNearestFrames Set of computed indices associated to the k nearest views.
+   * @param[in] similarityThreshold A threshold to retrieve only the kframes having
+   * at least \p similarityThreshold similarity score.
+   */
+  void kNearestKeyFrames(const std::bitset<128> & queryViewDescriptor,
+                         std::size_t nNearestKeyFrames,
+                         std::vector<IndexT> & out_kNearestFrames,
+                         float similarityThreshold = 1.0f) const;
+
   // for each view index, it contains the cctag features and descriptors that have an
   // associated 3D point
   feature::RegionsPerView _regionsPerView;
   ReconstructedRegionsMappingPerView _reconstructedRegionsMappingPerView;
 
+  // for each reconstructed marker id, the views observing it along with the
+  // associated 3D point; built once at loading time so that the per-frame
+  // association is a hash lookup instead of a scan over the region sets
+  HashMap<IndexT, std::vector<CCTagObservation> > _markerVisibility;
+  // for each view index, the 128 bit visibility descriptor of its reconstructed markers
+  HashMap<IndexT, std::bitset<128> > _markerViewDescriptors;
+
   // the feature extractor
   feature::ImageDescriber_CCTAG _imageDescriber;
   /// @warning: descType needs to be a CCTAG_Regions
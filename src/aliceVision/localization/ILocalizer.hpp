@@ -63,7 +63,16 @@ public:
 
     // Only relevant for CCTagLocalizer
     virtual void setCudaPipe(int) { }
-    
+
+    /**
+     * @brief Drop any state accumulated while tracking a sequence (frame
+     * buffer, last localized pose, motion model), so the localizer can start
+     * over on an unrelated sequence. Localizers without sequence state do
+     * nothing.
+     */
+    virtual void resetSequence() { }
+
+
     bool isInit() const {return _isInit;}
     
     const sfm::SfMData& getSfMData() const {return _sfm_data; }
@@ -109,7 +118,24 @@ public:
                            const std::vector<geometry::Pose3 > &vec_subPoses,
                            geometry::Pose3 &rigPose,
                            std::vector<LocalizationResult>& vec_locResults)=0;
-   
+
+  /**
+   * @brief Extract the features and descriptors of each camera of a rig frame,
+   * without localizing it. Combined with the regions overload of localizeRig,
+   * it lets a caller pipeline the extraction of one frame with the resection
+   * of the previous one.
+   *
+   * @param[in] vec_imageGrey The input greyscale image of each camera.
+   * @param[in] param The parameters for the localization.
+   * @param[out] vec_queryRegions The extracted regions of each camera.
+   * @param[out] vec_imageSize The size of each input image.
+   * @return true if the extraction succeeded.
+   */
+  virtual bool extractRigRegions(const std::vector<image::Image<unsigned char> > & vec_imageGrey,
+                                 const LocalizerParameters *param,
+                                 std::vector<feature::MapRegionsPerDesc> & vec_queryRegions,
+                                 std::vector<std::pair<std::size_t, std::size_t> > & vec_imageSize)=0;
+
   virtual ~ILocalizer( ) {}
 
 protected:
@@ -0,0 +1,148 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/geometry/Pose3.hpp>
+#include <aliceVision/numeric/numeric.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace aliceVision {
+namespace localization {
+
+/**
+ * @brief Constant-velocity pose prediction over the recent trajectory of a
+ * localized sequence.
+ *
+ * The predictor extrapolates the pose of the next frame from the last two
+ * localized ones and measures the error of its own past predictions against
+ * the refined poses (recency-weighted mean and variance of the rotation and
+ * center components). A prediction is only returned while those statistics
+ * stay within the configured bounds, so a consumer automatically falls back
+ * to its cold-start path on jerky motion, cuts or tracking loss, and the
+ * gate reopens by itself once the motion is smooth again.
+ */
+class PosePredictor
+{
+public:
+  /**
+   * @param[in] maxRotationErrorDeg bound on the expected rotation error of a prediction
+   * @param[in] maxCenterErrorRatio bound on the expected center error of a prediction,
+   * as a fraction of the distance travelled between two frames
+   */
+  explicit PosePredictor(double maxRotationErrorDeg = 2.0, double maxCenterErrorRatio = 0.5)
+    : _maxRotationErrorRad(degreeToRadian(maxRotationErrorDeg))
+    , _maxCenterErrorRatio(maxCenterErrorRatio)
+  {}
+
+  /**
+   * @brief Predict the pose of the next frame with a constant-velocity model.
+   * @param[out] predicted The extrapolated pose
+   * @return false if fewer than two consecutive frames are available or if the
+   * error statistics of the past predictions exceed the configured bounds
+   */
+  bool predict(geometry::Pose3& predicted) const
+  {
+    if(!extrapolate(predicted))
+      return false;
+
+    if(_nbMeasuredErrors < 2)
+      return true; // no statistics yet, be optimistic: a bad guess closes the gate
+
+    // expected error of this prediction from the past ones:
+    // mean plus two standard deviations covers most of the observed errors
+    const double rotationBound = _rotationError.mean + 2.0 * std::sqrt(_rotationError.variance());
+    const double centerBound = _centerError.mean + 2.0 * std::sqrt(_centerError.variance());
+    return rotationBound <= _maxRotationErrorRad &&
+           centerBound <= std::max(_maxCenterErrorRatio * _speed.mean, 1e-12);
+  }
+
+  /**
+   * @brief Feed the refined pose of the frame that has just been localized.
+   * The error of the corresponding prediction is measured even when the gate
+   * is closed, so that the gate can reopen on smooth motion.
+   */
+  void update(const geometry::Pose3& refinedPose)
+  {
+    geometry::Pose3 predicted;
+    if(extrapolate(predicted))
+    {
+      _rotationError.add(getRotationMagnitude(predicted.rotation() * refinedPose.rotation().transpose()));
+      _centerError.add((predicted.center() - refinedPose.center()).norm());
+      ++_nbMeasuredErrors;
+    }
+    if(_nbValidPoses >= 1)
+      _speed.add((refinedPose.center() - _last.center()).norm());
+
+    _previous = _last;
+    _last = refinedPose;
+    ++_nbValidPoses;
+  }
+
+  /// Forget the trajectory and the error statistics, e.g. on a localization failure
+  void reset()
+  {
+    _nbValidPoses = 0;
+    _nbMeasuredErrors = 0;
+    _rotationError = RunningStat();
+    _centerError = RunningStat();
+    _speed = RunningStat();
+  }
+
+private:
+  /// Recency-weighted mean and variance (exponential moving statistics)
+  struct RunningStat
+  {
+    void add(double value)
+    {
+      if(empty)
+      {
+        mean = value;
+        meanSq = value * value;
+        empty = false;
+        return;
+      }
+      const double alpha = 0.3; // weight of the newest measurement
+      mean = (1.0 - alpha) * mean + alpha * value;
+      meanSq = (1.0 - alpha) * meanSq + alpha * value * value;
+    }
+
+    double variance() const
+    {
+      return std::max(meanSq - mean * mean, 0.0);
+    }
+
+    double mean = 0.0;
+    double meanSq = 0.0;
+    bool empty = true;
+  };
+
+  /// Constant-velocity extrapolation, regardless of the error gate
+  bool extrapolate(geometry::Pose3& predicted) const
+  {
+    if(_nbValidPoses < 2)
+      return false;
+    const Mat3 relativeRotation = _last.rotation() * _previous.rotation().transpose();
+    const Vec3 velocity = _last.center() - _previous.center();
+    predicted = geometry::Pose3(relativeRotation * _last.rotation(), _last.center() + velocity);
+    return true;
+  }
+
+  double _maxRotationErrorRad;
+  double _maxCenterErrorRatio;
+
+  geometry::Pose3 _previous;
+  geometry::Pose3 _last;
+  std::size_t _nbValidPoses = 0;
+  std::size_t _nbMeasuredErrors = 0;
+  RunningStat _rotationError;
+  RunningStat _centerError;
+  RunningStat _speed;
+};
+
+} // namespace localization
+} // namespace aliceVision
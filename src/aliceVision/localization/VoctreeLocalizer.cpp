@@ -19,6 +19,7 @@
 #include <aliceVision/matching/ArrayMatcher_kdtreeFlann.hpp>
 #include <aliceVision/matchingImageCollection/GeometricFilterMatrix_F_AC.hpp>
 #include <aliceVision/matchingImageCollection/GeometricFilterMatrix.hpp>
+#include <aliceVision/geometry/Frustum.hpp>
 #include <aliceVision/numeric/numeric.hpp>
 #include <aliceVision/robustEstimation/guidedMatching.hpp>
 #include <aliceVision/system/Logger.hpp>
@@ -29,6 +30,7 @@
 
 #include <algorithm>
 #include <chrono>
+#include <thread>
 
 namespace aliceVision {
 namespace localization {
@@ -144,6 +146,13 @@ VoctreeLocalizer::VoctreeLocalizer(const sfm::SfMData &sfmData,
   _isInit = initDatabase(vocTreeFilepath, weightsFilepath, descriptorsFolder);
 }
 
+void VoctreeLocalizer::resetSequence()
+{
+  _frameBuffer.clear();
+  _lastResult = LocalizationResult();
+  _posePredictor.reset();
+}
+
 bool VoctreeLocalizer::localize(const feature::MapRegionsPerDesc & queryRegions,
                                 const std::pair<std::size_t, std::size_t> &imageSize,
                                 const LocalizerParameters *param,
@@ -238,6 +247,100 @@ bool VoctreeLocalizer::localize(const image::Image<unsigned char> & imageGrey,
                   imagePath);
 }
 
+namespace {
+// A frame of the localization pipeline after the extraction stage
+struct ExtractedFrame
+{
+  feature::MapRegionsPerDesc regions;
+  std::pair<std::size_t, std::size_t> imageSize;
+  camera::PinholeRadialK3 intrinsics;
+  bool useInputIntrinsics;
+  std::string imagePath;
+};
+}
+
+std::size_t VoctreeLocalizer::localizeSequence(std::function<bool(image::Image<unsigned char>& imageGrey,
+                                                                  camera::PinholeRadialK3& queryIntrinsics,
+                                                                  bool& useInputIntrinsics,
+                                                                  std::string& imagePath)> getFrame,
+                                               const LocalizerParameters *param,
+                                               std::vector<LocalizationResult>& vec_localizationResults)
+{
+  // a small number of frames in flight is enough to keep both stages busy;
+  // one extraction thread feeds one localization thread, so the lock-free
+  // single-producer/single-consumer queue applies
+  LockFreeSpscQueue<ExtractedFrame> extractedFrames(2);
+
+  // stage 1: read and extract the frames, feeding the queue
+  std::thread extractionThread([&]()
+  {
+    image::Image<unsigned char> imageGrey;
+    ExtractedFrame frame;
+    while(getFrame(imageGrey, frame.intrinsics, frame.useInputIntrinsics, frame.imagePath))
+    {
+      ALICEVISION_LOG_DEBUG("[features]\tExtract Regions from query image");
+      for(const auto& imageDescriber : _imageDescribers)
+      {
+        const auto descType = imageDescriber->getDescriberType();
+        auto & queryRegions = frame.regions[descType];
+
+        imageDescriber->Allocate(queryRegions);
+
+        system::Timer timer;
+        imageDescriber->setCudaPipe(_cudaPipe);
+        imageDescriber->Set_configuration_preset(param->_featurePreset);
+        imageDescriber->Describe(imageGrey, queryRegions, nullptr);
+
+        ALICEVISION_LOG_DEBUG("[features]\tExtract " << feature::EImageDescriberType_enumToString(descType) << " done: found " << queryRegions->RegionCount() << " features in " << timer.elapsedMs() << " [ms]");
+      }
+      frame.imageSize = std::make_pair(imageGrey.Width(), imageGrey.Height());
+
+      // if debugging is enable save the svg image with the extracted features
+      if(!param->_visualDebug.empty() && !frame.imagePath.empty())
+      {
+        feature::MapFeaturesPerDesc extractedFeatures;
+
+        for(const auto& imageDescriber : _imageDescribers)
+        {
+          const auto descType = imageDescriber->getDescriberType();
+          extractedFeatures[descType] = frame.regions.at(descType)->GetRegionsPositions();
+        }
+
+        namespace bfs = boost::filesystem;
+        feature::saveFeatures2SVG(frame.imagePath,
+                         frame.imageSize,
+                         extractedFeatures,
+                         param->_visualDebug + "/" + bfs::path(frame.imagePath).stem().string() + ".svg");
+      }
+
+      extractedFrames.push(std::move(frame));
+      frame = ExtractedFrame();
+    }
+    extractedFrames.close();
+  });
+
+  // stage 2: retrieval, matching and resection of the extracted frames
+  std::size_t numLocalized = 0;
+  ExtractedFrame frame;
+  while(extractedFrames.pop(frame))
+  {
+    vec_localizationResults.emplace_back();
+    if(localize(frame.regions,
+                frame.imageSize,
+                param,
+                frame.useInputIntrinsics,
+                frame.intrinsics,
+                vec_localizationResults.back(),
+                frame.imagePath))
+    {
+      ++numLocalized;
+    }
+  }
+
+  extractionThread.join();
+  return numLocalized;
+}
+
 bool VoctreeLocalizer::loadReconstructionDescriptors(const sfm::SfMData & sfm_data,
                                                      const std::string & feat_directory)
 {
@@ -298,6 +401,7 @@ bool VoctreeLocalizer::initDatabase(const std::string & vocTreeFilepath,
       const IndexT viewId = obs.first;
       const sfm::Observation& obs2d = obs.second;
       observationsPerView[viewId][landmark.descType].emplace_back(obs2d.id_feat, trackId);
+      _landmarksPerView[viewId].push_back(trackId);
     }
   }
   for(auto& featuresPerTypeInImage : observationsPerView)
@@ -339,6 +443,7 @@ bool VoctreeLocalizer::initDatabase(const std::string & vocTreeFilepath,
           // special cases everywhere for empty elements.
           _reconstructedRegionsMappingPerView[id_view][descType] = std::move(mapping);
           imageDescriber->Allocate(_regionsPerView.getData()[id_view][descType]);
+          _positionsPerView[id_view][descType];
         }
         continue;
       }
@@ -358,10 +463,14 @@ bool VoctreeLocalizer::initDatabase(const std::string & vocTreeFilepath,
 
       // Filter descriptors to keep only the 3D reconstructed points
       std::unique_ptr<feature::Regions> filteredRegions = createFilteredRegions(*currRegions, observations.at(descType), mapping);
+      // cache the positions once, so matching does not have to copy them out
+      // of the Regions for every candidate view of every query frame
+      feature::PointFeatures positions = filteredRegions->GetRegionsPositions();
 #pragma omp critical
       {
         _reconstructedRegionsMappingPerView[id_view][descType] = std::move(mapping);
         _regionsPerView.getData()[id_view][descType] = std::move(filteredRegions);
+        _positionsPerView[id_view][descType] = std::move(positions);
       }
     }
 #pragma omp critical
@@ -372,6 +481,52 @@ bool VoctreeLocalizer::initDatabase(const std::string & vocTreeFilepath,
   return true;
 }
 
+bool VoctreeLocalizer::getCandidateViewsFromMotionPrior(const std::pair<std::size_t, std::size_t> &imageSize,
+                                                        const camera::PinholeRadialK3 &queryIntrinsics,
+                                                        std::size_t numResults,
+                                                        std::vector<voctree::DocMatch>& out_matchedImages) const
+{
+  if(!_lastResult.isValid())
+    return false;
+
+  // build the frustum of the camera predicted at the last localized pose
+  const geometry::Pose3 &pose = _lastResult.getPose();
+  const geometry::Frustum frustum(imageSize.first, imageSize.second,
+                                  queryIntrinsics.K(), pose.rotation(), pose.center());
+
+  // score each reconstructed view by the number of its landmarks falling inside
+  // the predicted frustum, ie its covisibility with the predicted camera
+  std::vector<voctree::DocMatch> candidates;
+  Mat3X landmarks;
+  for(const auto &viewLandmarks : _landmarksPerView)
+  {
+    // gather the view landmarks and test them against all the frustum planes at once
+    landmarks.resize(3, viewLandmarks.second.size());
+    Mat3X::Index col = 0;
+    for(const IndexT landmarkId : viewLandmarks.second)
+      landmarks.col(col++) = _sfm_data.structure.at(landmarkId).X;
+
+    const std::size_t numCovisible = frustum.countContainedPoints(landmarks);
+    // minimum number of points that allows a reliable 3D reconstruction
+    const std::size_t minNum3DPoints = 5;
+    if(numCovisible > minNum3DPoints)
+      candidates.emplace_back(viewLandmarks.first, -float(numCovisible));
+  }
+
+  if(candidates.empty())
+  {
+    ALICEVISION_LOG_DEBUG("[database]\tNo view shares enough points with the predicted frustum");
+    return false;
+  }
+
+  // best-to-worst order, like the matches returned by the database
+  std::sort(candidates.begin(), candidates.end());
+  if(numResults != 0 && candidates.size() > numResults)
+    candidates.resize(numResults);
+  out_matchedImages.swap(candidates);
+  return true;
+}
+
 bool VoctreeLocalizer::localizeFirstBestResult(const feature::MapRegionsPerDesc &queryRegions,
                                                const std::pair<std::size_t, std::size_t> &queryImageSize,
                                                const Parameters &param,
@@ -380,16 +535,32 @@ bool VoctreeLocalizer::localizeFirstBestResult(const feature::MapRegionsPerDesc
                                                LocalizationResult &localizationResult,
                                                const std::string &imagePath)
 {
-  // A. Find the (visually) similar images in the database 
-  ALICEVISION_LOG_DEBUG("[database]\tRequest closest images from voctree");
-  // pass the descriptors through the vocabulary tree to get the visual words
-  // associated to each feature
-  voctree::SparseHistogram requestImageWords = _voctree->quantizeToSparse(queryRegions.at(_voctreeDescType)->blindDescriptors());
-  
-  // Request closest images from voctree
+  // A. Find the images to match against, from the motion prior when tracking,
+  // from the (visually) similar images in the database otherwise
   std::vector<voctree::DocMatch> matchedImages;
-  _database.find(requestImageWords, param._numResults, matchedImages);
-  
+  const bool usedMotionPrior = param._useMotionPrior &&
+      getCandidateViewsFromMotionPrior(queryImageSize,
+                                       useInputIntrinsics ? queryIntrinsics : _lastResult.getIntrinsics(),
+                                       param._numResults,
+                                       matchedImages);
+  if(usedMotionPrior)
+  {
+    ALICEVISION_LOG_DEBUG("[database]\tSelected " << matchedImages.size() << " candidate views from the motion prior");
+  }
+  else
+  {
+    ALICEVISION_LOG_DEBUG("[database]\tRequest closest images from voctree");
+    // pass the descriptors through the vocabulary tree to get the visual words
+    // associated to each feature
+    voctree::SparseHistogram requestImageWords = _voctree->quantizeToSparse(queryRegions.at(_voctreeDescType)->blindDescriptors());
+
+    // Request closest images from voctree
+    if(param._useApproximateRetrieval)
+      _database.findApproximate(requestImageWords, param._numResults, matchedImages);
+    else
+      _database.find(requestImageWords, param._numResults, matchedImages);
+  }
+
 //  // Debugging log
 //  // for each similar image found print score and number of features
 //  for(const voctree::DocMatch & currMatch : matchedImages )
@@ -427,9 +598,9 @@ bool VoctreeLocalizer::localizeFirstBestResult(const feature::MapRegionsPerDesc
     // safeguard: we should match the query image with an image that has at least
     // some 3D points visible --> if it has 0 3d points it is likely that it is an
     // image of the dataset that was not reconstructed
-    if(_regionsPerView.getRegionsPerDesc(matchedViewId).getNbAllRegions() < minNum3DPoints)
+    if(_regionsPerView.getRegionsPerDesc(matchedViewId)->getNbAllRegions() < minNum3DPoints)
     {
-      ALICEVISION_LOG_DEBUG("[matching]\tSkipping matching with " << matchedView->getImagePath() << " as it has too few visible 3D points (" << _regionsPerView.getRegionsPerDesc(matchedViewId).getNbAllRegions() << ")");
+      ALICEVISION_LOG_DEBUG("[matching]\tSkipping matching with " << matchedView->getImagePath() << " as it has too few visible 3D points (" << _regionsPerView.getRegionsPerDesc(matchedViewId)->getNbAllRegions() << ")");
       continue;
     }
     ALICEVISION_LOG_DEBUG("[matching]\tTrying to match the query image with " << matchedView->getImagePath());
@@ -445,7 +616,8 @@ bool VoctreeLocalizer::localizeFirstBestResult(const feature::MapRegionsPerDesc
     bool matchWorked = robustMatching(matchers,
                                       // pass the input intrinsic if they are valid, null otherwise
                                       (useInputIntrinsics) ? &queryIntrinsics : nullptr,
-                                      _regionsPerView.getRegionsPerDesc(matchedViewId),
+                                      *_regionsPerView.getRegionsPerDesc(matchedViewId),
+                                      (_positionsPerView.count(matchedViewId) != 0) ? &_positionsPerView.at(matchedViewId) : nullptr,
                                       matchedIntrinsics,
                                       param._fDistRatio,
                                       param._matchingError,
@@ -478,7 +650,7 @@ bool VoctreeLocalizer::localizeFirstBestResult(const feature::MapRegionsPerDesc
                       queryRegions,
                       matchedPath,
                       std::make_pair(mview->getWidth(), mview->getHeight()),
-                      _regionsPerView.getRegionsPerDesc(matchedViewId),
+                      *_regionsPerView.getRegionsPerDesc(matchedViewId),
                       featureMatches,
                       param._visualDebug + "/" + queryimage + "_" + matchedImage + ".svg"); 
     }
@@ -587,8 +759,26 @@ bool VoctreeLocalizer::localizeFirstBestResult(const feature::MapRegionsPerDesc
     break;
   }
   //@todo deal with unsuccesful case...
+
+  if(usedMotionPrior && !localizationResult.isValid())
+  {
+    // tracking loss: retry the frame with a full voctree retrieval
+    ALICEVISION_LOG_DEBUG("[database]\tMotion-prior tracking lost, falling back to voctree retrieval");
+    _lastResult = LocalizationResult();
+    _posePredictor.reset();
+    return localizeFirstBestResult(queryRegions, queryImageSize, param, useInputIntrinsics, queryIntrinsics, localizationResult, imagePath);
+  }
+  if(param._useMotionPrior)
+  {
+    if(localizationResult.isValid())
+      _posePredictor.update(localizationResult.getPose());
+    else
+      _posePredictor.reset();
+    _lastResult = localizationResult;
+  }
+
   return localizationResult.isValid();
-} 
+}
 
 bool VoctreeLocalizer::localizeAllResults(const feature::MapRegionsPerDesc &queryRegions,
                                           const std::pair<std::size_t, std::size_t> & queryImageSize,
@@ -606,6 +796,7 @@ bool VoctreeLocalizer::localizeAllResults(const feature::MapRegionsPerDesc &quer
   
   // get all the association from the database images
   std::vector<voctree::DocMatch> matchedImages;
+  bool usedMotionPrior = false;
   getAllAssociations(queryRegions,
                      queryImageSize,
                      param,
@@ -616,7 +807,8 @@ bool VoctreeLocalizer::localizeAllResults(const feature::MapRegionsPerDesc &quer
                      resectionData.pt3D,
                      resectionData.vec_descType,
                      matchedImages,
-                     imagePath);
+                     imagePath,
+                     &usedMotionPrior);
 
   const std::size_t numCollectedPts = occurences.size();
   std::vector<IndMatch3D2D> associationIDs;
@@ -633,21 +825,94 @@ bool VoctreeLocalizer::localizeAllResults(const feature::MapRegionsPerDesc &quer
   assert(resectionData.pt3D.cols() == numCollectedPts);
 
   geometry::Pose3 pose;
-  
+
   // estimate the pose
   // Do the resectioning: compute the camera pose.
   resectionData.error_max = param._errorMax;
+
+  // warm-start the resection from the trajectory: keep only the associations
+  // consistent with the pose predicted by the constant-velocity model and
+  // shrink the RANSAC budget, the outlier ratio being far lower on the subset
+  bool usedPosePrediction = false;
+  sfm::ImageLocalizerMatchData fullResectionData;
+  std::vector<IndMatch3D2D> fullAssociationIDs;
+  geometry::Pose3 predictedPose;
+  if(param._useMotionPrior && useInputIntrinsics && _posePredictor.predict(predictedPose))
+  {
+    // minimum number of associations surviving the gate for the subset to be
+    // worth resecting on its own
+    const std::size_t minPredictedAssociations = 30;
+    std::vector<std::size_t> keptIndices;
+    keptIndices.reserve(numCollectedPts);
+    for(std::size_t i = 0; i < numCollectedPts; ++i)
+    {
+      const Vec2 residual = queryIntrinsics.residual(predictedPose, resectionData.pt3D.col(i), resectionData.pt2D.col(i));
+      if(residual.norm() <= param._predictionReprojectionGate)
+        keptIndices.push_back(i);
+    }
+    if(keptIndices.size() >= minPredictedAssociations && keptIndices.size() < numCollectedPts)
+    {
+      ALICEVISION_LOG_DEBUG("[poseEstimation]\tPose prediction keeps " << keptIndices.size()
+                            << " of " << numCollectedPts << " associations");
+      fullResectionData = resectionData;
+      fullAssociationIDs = associationIDs;
+
+      sfm::ImageLocalizerMatchData predictedData;
+      predictedData.pt2D = Mat2X(2, keptIndices.size());
+      predictedData.pt3D = Mat3X(3, keptIndices.size());
+      predictedData.vec_descType.resize(keptIndices.size());
+      std::vector<IndMatch3D2D> keptAssociationIDs;
+      keptAssociationIDs.reserve(keptIndices.size());
+      for(std::size_t i = 0; i < keptIndices.size(); ++i)
+      {
+        predictedData.pt2D.col(i) = resectionData.pt2D.col(keptIndices[i]);
+        predictedData.pt3D.col(i) = resectionData.pt3D.col(keptIndices[i]);
+        predictedData.vec_descType[i] = resectionData.vec_descType[keptIndices[i]];
+        keptAssociationIDs.push_back(associationIDs[keptIndices[i]]);
+      }
+      predictedData.error_max = param._errorMax;
+      // the gated associations are mostly inliers, a small budget is enough
+      predictedData.max_iteration = 256;
+
+      resectionData = predictedData;
+      associationIDs.swap(keptAssociationIDs);
+      usedPosePrediction = true;
+    }
+  }
+
   ALICEVISION_LOG_DEBUG("[poseEstimation]\tEstimating camera pose...");
-  const bool bResection = sfm::SfMLocalizer::Localize(queryImageSize,
-                                                      // pass the input intrinsic if they are valid, null otherwise
-                                                      (useInputIntrinsics) ? &queryIntrinsics : nullptr,
-                                                      resectionData,
-                                                      pose,
-                                                      param._resectionEstimator);
+  bool bResection = sfm::SfMLocalizer::Localize(queryImageSize,
+                                                // pass the input intrinsic if they are valid, null otherwise
+                                                (useInputIntrinsics) ? &queryIntrinsics : nullptr,
+                                                resectionData,
+                                                pose,
+                                                param._resectionEstimator);
+
+  if(!bResection && usedPosePrediction)
+  {
+    // the prediction was off: retry on the full association set before
+    // declaring the frame lost
+    ALICEVISION_LOG_DEBUG("[poseEstimation]\tWarm-started resection failed, retrying with all the associations");
+    resectionData = fullResectionData;
+    associationIDs.swap(fullAssociationIDs);
+    bResection = sfm::SfMLocalizer::Localize(queryImageSize,
+                                             (useInputIntrinsics) ? &queryIntrinsics : nullptr,
+                                             resectionData,
+                                             pose,
+                                             param._resectionEstimator);
+  }
 
   if(!bResection)
   {
     ALICEVISION_LOG_DEBUG("[poseEstimation]\tResection failed");
+    if(usedMotionPrior)
+    {
+      // tracking loss: retry the frame with a full voctree retrieval
+      ALICEVISION_LOG_DEBUG("[database]\tMotion-prior tracking lost, falling back to voctree retrieval");
+      _lastResult = LocalizationResult();
+      _posePredictor.reset();
+      return localizeAllResults(queryRegions, queryImageSize, param, useInputIntrinsics, queryIntrinsics, localizationResult, imagePath);
+    }
     if(!param._visualDebug.empty() && !imagePath.empty())
     {
       namespace bfs = boost::filesystem;
@@ -657,6 +922,11 @@ bool VoctreeLocalizer::localizeAllResults(const feature::MapRegionsPerDesc &quer
                                  param._visualDebug + "/" + bfs::path(imagePath).stem().string() + ".associations.svg");
     }
     localizationResult = LocalizationResult(resectionData, associationIDs, pose, queryIntrinsics, matchedImages, bResection);
+    if(param._useMotionPrior)
+    {
+      _lastResult = localizationResult;
+      _posePredictor.reset();
+    }
     return localizationResult.isValid();
   }
   ALICEVISION_LOG_DEBUG("[poseEstimation]\tResection SUCCEDED");
@@ -717,12 +987,30 @@ bool VoctreeLocalizer::localizeAllResults(const feature::MapRegionsPerDesc &quer
                 << " max = " << std::sqrt(sqrErrors.maxCoeff()));
   }
 
+  if(usedMotionPrior && !localizationResult.isValid())
+  {
+    // tracking loss: retry the frame with a full voctree retrieval
+    ALICEVISION_LOG_DEBUG("[database]\tMotion-prior tracking lost, falling back to voctree retrieval");
+    _lastResult = LocalizationResult();
+    _posePredictor.reset();
+    return localizeAllResults(queryRegions, queryImageSize, param, useInputIntrinsics, queryIntrinsics, localizationResult, imagePath);
+  }
+
   if(param._nbFrameBufferMatching > 0)
   {
     // add everything to the buffer
     _frameBuffer.emplace_back(localizationResult, queryRegions);
   }
 
+  if(param._useMotionPrior)
+  {
+    if(localizationResult.isValid())
+      _posePredictor.update(localizationResult.getPose());
+    else
+      _posePredictor.reset();
+    _lastResult = localizationResult;
+  }
+
   return localizationResult.isValid();
 }
 
@@ -736,23 +1024,43 @@ void VoctreeLocalizer::getAllAssociations(const feature::MapRegionsPerDesc &quer
                                           Mat &out_pt3D,
                                           std::vector<feature::EImageDescriberType>& out_descTypes,
                                           std::vector<voctree::DocMatch>& out_matchedImages,
-                                          const std::string& imagePath) const
+                                          const std::string& imagePath,
+                                          bool* out_usedMotionPrior) const
 {
   assert(out_descTypes.size() == 0);
 
-  // A. Find the (visually) similar images in the database 
-  // pass the descriptors through the vocabulary tree to get the visual words
-  // associated to each feature
-  ALICEVISION_LOG_DEBUG("[database]\tRequest closest images from voctree");
-  if(queryRegions.count(_voctreeDescType) == 0)
+  // A. Find the images to match against, from the motion prior when tracking,
+  // from the (visually) similar images in the database otherwise
+  const bool usedMotionPrior = (out_usedMotionPrior != nullptr) && param._useMotionPrior &&
+      getCandidateViewsFromMotionPrior(imageSize,
+                                       useInputIntrinsics ? queryIntrinsics : _lastResult.getIntrinsics(),
+                                       param._numResults,
+                                       out_matchedImages);
+  if(out_usedMotionPrior != nullptr)
+    *out_usedMotionPrior = usedMotionPrior;
+
+  if(usedMotionPrior)
   {
-    ALICEVISION_LOG_WARNING("[database]\t No feature type " << feature::EImageDescriberType_enumToString(_voctreeDescType) << " in query region.");
-    return;
+    ALICEVISION_LOG_DEBUG("[database]\tSelected " << out_matchedImages.size() << " candidate views from the motion prior");
+  }
+  else
+  {
+    // pass the descriptors through the vocabulary tree to get the visual words
+    // associated to each feature
+    ALICEVISION_LOG_DEBUG("[database]\tRequest closest images from voctree");
+    if(queryRegions.count(_voctreeDescType) == 0)
+    {
+      ALICEVISION_LOG_WARNING("[database]\t No feature type " << feature::EImageDescriberType_enumToString(_voctreeDescType) << " in query region.");
+      return;
+    }
+    voctree::SparseHistogram requestImageWords = _voctree->quantizeToSparse(queryRegions.at(_voctreeDescType)->blindDescriptors());
+
+    // Request closest images from voctree
+    if(param._useApproximateRetrieval)
+      _database.findApproximate(requestImageWords, (param._numResults==0) ? (_database.size()) : (param._numResults) , out_matchedImages);
+    else
+      _database.find(requestImageWords, (param._numResults==0) ? (_database.size()) : (param._numResults) , out_matchedImages);
   }
-  voctree::SparseHistogram requestImageWords = _voctree->quantizeToSparse(queryRegions.at(_voctreeDescType)->blindDescriptors());
-  
-  // Request closest images from voctree
-  _database.find(requestImageWords, (param._numResults==0) ? (_database.size()) : (param._numResults) , out_matchedImages);
 
 //  // Debugging log
 //  // for each similar image found print score and number of features
@@ -785,7 +1093,8 @@ void VoctreeLocalizer::getAllAssociations(const feature::MapRegionsPerDesc &quer
     // the handler to the current view
     const std::shared_ptr<sfm::View> matchedView = _sfm_data.views.at(matchedViewId);
     // its associated reconstructed regions
-    const feature::MapRegionsPerDesc& matchedRegions = _regionsPerView.getRegionsPerDesc(matchedViewId);
+    const feature::RegionsPerDescHandle matchedRegionsHandle = _regionsPerView.getRegionsPerDesc(matchedViewId);
+    const feature::MapRegionsPerDesc& matchedRegions = *matchedRegionsHandle;
     
     // safeguard: we should match the query image with an image that has at least
     // some 3D points visible --> if this is not true it is likely that it is an
@@ -814,6 +1123,7 @@ void VoctreeLocalizer::getAllAssociations(const feature::MapRegionsPerDesc &quer
                                       // pass the input intrinsic if they are valid, null otherwise
                                       (useInputIntrinsics) ? &queryIntrinsics : nullptr,
                                       matchedRegions,
+                                      (_positionsPerView.count(matchedViewId) != 0) ? &_positionsPerView.at(matchedViewId) : nullptr,
                                       matchedIntrinsics,
                                       param._fDistRatio,
                                       param._matchingError,
@@ -869,7 +1179,7 @@ void VoctreeLocalizer::getAllAssociations(const feature::MapRegionsPerDesc &quer
                                 queryRegions,
                                 matchedPath,
                                 std::make_pair(mview->getWidth(), mview->getHeight()),
-                                _regionsPerView.getRegionsPerDesc(matchedViewId),
+                                *_regionsPerView.getRegionsPerDesc(matchedViewId),
                                 featureMatches,
                                 outputName.string()); 
     }
@@ -986,6 +1296,7 @@ void VoctreeLocalizer::getAssociationsFromBuffer(matching::RegionsDatabaseMatche
                                       // pass the input intrinsic if they are valid, null otherwise
                                       (useInputIntrinsics) ? &queryIntrinsics : nullptr,
                                       frameRegions,
+                                      nullptr,
                                       &frameIntrinsics,
                                       param._fDistRatio,
                                       param._matchingError,
@@ -1037,6 +1348,7 @@ void VoctreeLocalizer::getAssociationsFromBuffer(matching::RegionsDatabaseMatche
 bool VoctreeLocalizer::robustMatching(matching::RegionsDatabaseMatcherPerDesc & matchers,
                                       const camera::IntrinsicBase * queryIntrinsicsBase,   // the intrinsics of the image we are using as reference
                                       const feature::MapRegionsPerDesc & matchedRegions,
+                                      const feature::MapFeaturesPerDesc * matchedPositions,
                                       const camera::IntrinsicBase * matchedIntrinsicsBase,
                                       float fDistRatio,
                                       double matchingError,
@@ -1069,7 +1381,7 @@ bool VoctreeLocalizer::robustMatching(matching::RegionsDatabaseMatcherPerDesc &
 
   // A. Putative Features Matching
   matching::MatchesPerDescType putativeFeatureMatches;
-  const bool matchWorked = matchers.Match(fDistRatio, matchedRegions, putativeFeatureMatches);
+  const bool matchWorked = matchers.Match(fDistRatio, matchedRegions, matchedPositions, putativeFeatureMatches);
   if (!matchWorked)
   {
     ALICEVISION_LOG_DEBUG("[matching]\tPutative matching failed.");
@@ -1146,10 +1458,32 @@ bool VoctreeLocalizer::localizeRig(const std::vector<image::Image<unsigned char>
   assert(numCams == vec_queryIntrinsics.size());
   assert(numCams == vec_subPoses.size() + 1);
 
-  std::vector<feature::MapRegionsPerDesc> vec_queryRegions(numCams);
+  std::vector<feature::MapRegionsPerDesc> vec_queryRegions;
   std::vector<std::pair<std::size_t, std::size_t> > vec_imageSize;
-  
-  //@todo parallelize?
+
+  if(!extractRigRegions(vec_imageGrey, parameters, vec_queryRegions, vec_imageSize))
+    return false;
+
+  return localizeRig(vec_queryRegions,
+                     vec_imageSize,
+                     parameters,
+                     vec_queryIntrinsics,
+                     vec_subPoses,
+                     rigPose,
+                     vec_locResults);
+}
+
+bool VoctreeLocalizer::extractRigRegions(const std::vector<image::Image<unsigned char> > & vec_imageGrey,
+                                         const LocalizerParameters *param,
+                                         std::vector<feature::MapRegionsPerDesc> & vec_queryRegions,
+                                         std::vector<std::pair<std::size_t, std::size_t> > & vec_imageSize)
+{
+  const size_t numCams = vec_imageGrey.size();
+
+  vec_queryRegions.clear();
+  vec_queryRegions.resize(numCams);
+  vec_imageSize.clear();
+
   for(size_t i = 0; i < numCams; ++i)
   {
     // add the image size for this image
@@ -1165,14 +1499,8 @@ bool VoctreeLocalizer::localizeRig(const std::vector<image::Image<unsigned char>
     ALICEVISION_LOG_DEBUG("[features]\tAll descriptors extracted. Found " <<  vec_queryRegions[i].getNbAllRegions() << " features");
   }
   assert(vec_imageSize.size() == vec_queryRegions.size());
-          
-  return localizeRig(vec_queryRegions,
-                     vec_imageSize,
-                     parameters,
-                     vec_queryIntrinsics,
-                     vec_subPoses,
-                     rigPose,
-                     vec_locResults);
+
+  return true;
 }
 
 
@@ -9,8 +9,10 @@
 #include "LocalizationResult.hpp"
 #include "ILocalizer.hpp"
 #include "BoundedBuffer.hpp"
+#include "PosePredictor.hpp"
 #include <aliceVision/config.hpp>
 #include <aliceVision/feature/ImageDescriber.hpp>
+#include <aliceVision/feature/FeaturesPerView.hpp>
 #include <aliceVision/sfm/SfMData.hpp>
 #include <aliceVision/sfm/pipeline/localization/SfMLocalizer.hpp>
 #include <aliceVision/stl/mapUtils.hpp>
@@ -20,6 +22,8 @@
 #include <aliceVision/matching/RegionsMatcher.hpp>
 #include <flann/algorithms/dist.h>
 
+#include <functional>
+
 
 namespace aliceVision {
 namespace localization {
@@ -53,7 +57,10 @@ public:
       _numCommonViews(3),
       _ccTagUseCuda(true),
       _matchingError(std::numeric_limits<double>::infinity()),
-      _nbFrameBufferMatching(10)
+      _nbFrameBufferMatching(10),
+      _useApproximateRetrieval(false),
+      _useMotionPrior(false),
+      _predictionReprojectionGate(25.0)
     { }
     
     /// Enable/disable guided matching when matching images
@@ -74,6 +81,17 @@ public:
     double _matchingError;
     /// maximum capacity of the frame buffer
     std::size_t _nbFrameBufferMatching;
+    /// use the early-terminating approximate database retrieval instead of scoring every document
+    bool _useApproximateRetrieval;
+    /// during sequence tracking, select the candidate views from the frustum of the
+    /// last localized pose instead of querying the vocabulary tree, falling back to
+    /// the voctree retrieval on tracking loss
+    bool _useMotionPrior;
+    /// maximum reprojection error (in pixels) of an association w.r.t. the pose
+    /// predicted by the constant-velocity model for it to enter the warm-started
+    /// resection; associations beyond the gate are only reconsidered if the
+    /// warm-started resection fails
+    double _predictionReprojectionGate;
   };
   
 public:
@@ -105,7 +123,15 @@ public:
   {
       _cudaPipe = i;
   }
-  
+
+  /**
+   * @brief Clear the frame buffer, the last localized pose and the motion
+   * model, so the next localized image is treated as the first frame of a
+   * new sequence.
+   */
+  void resetSequence() override;
+
+
   /**
    * @brief Just a wrapper around the different localization algorithm, the algorithm
    * used to localized is chosen using \p param._algorithm. This version extract the
@@ -149,8 +175,32 @@ public:
                 camera::PinholeRadialK3 &queryIntrinsics,
                 LocalizationResult & localizationResult,
                 const std::string& imagePath = std::string()) override;
-  
-  
+
+  /**
+   * @brief Localize a sequence of frames with a two-stage pipeline: the
+   * feature extraction of frame N+1 runs on a dedicated thread while frame N
+   * goes through retrieval, matching and resection, overlapping the two most
+   * expensive stages of the offline tracking loop. Results are identical to
+   * calling the image version of localize() on each frame in order.
+   *
+   * @param[in] getFrame Callback producing the next frame of the sequence: it
+   * fills the greyscale image, the query intrinsics, the flag telling whether
+   * the intrinsics can be used as known calibration and the (possibly empty)
+   * image path, and returns false when the sequence is over. It is invoked
+   * from the extraction thread only.
+   * @param[in] param The parameters for the localization.
+   * @param[out] vec_localizationResults One localization result per produced
+   * frame, in sequence order.
+   * @return the number of successfully localized frames.
+   */
+  std::size_t localizeSequence(std::function<bool(image::Image<unsigned char>& imageGrey,
+                                                  camera::PinholeRadialK3& queryIntrinsics,
+                                                  bool& useInputIntrinsics,
+                                                  std::string& imagePath)> getFrame,
+                               const LocalizerParameters *param,
+                               std::vector<LocalizationResult>& vec_localizationResults);
+
+
   bool localizeRig(const std::vector<image::Image<unsigned char> > & vec_imageGrey,
                    const LocalizerParameters *param,
                    std::vector<camera::PinholeRadialK3 > &vec_queryIntrinsics,
@@ -166,6 +216,11 @@ public:
                    geometry::Pose3 &rigPose,
                    std::vector<LocalizationResult>& vec_locResults) override;
 
+  bool extractRigRegions(const std::vector<image::Image<unsigned char> > & vec_imageGrey,
+                         const LocalizerParameters *param,
+                         std::vector<feature::MapRegionsPerDesc> & vec_queryRegions,
+                         std::vector<std::pair<std::size_t, std::size_t> > & vec_imageSize) override;
+
 
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_OPENGV)
   bool localizeRig_opengv(const std::vector<feature::MapRegionsPerDesc> & vec_queryRegions,
@@ -250,6 +305,9 @@ public:
    * @param[out] out_descTypes output vector of describerType
    * @param[out] out_matchedImages image matches output
    * @param[in] imagePath
+   * @param[out] out_usedMotionPrior If non-null, the motion-prior candidate selection
+   * may replace the voctree retrieval (see Parameters::_useMotionPrior) and the flag
+   * reports whether it actually did; if null the voctree is always queried.
    */
   void getAllAssociations(const feature::MapRegionsPerDesc & queryRegions,
                           const std::pair<std::size_t, std::size_t> &imageSize,
@@ -261,7 +319,8 @@ public:
                           Mat &out_pt3D,
                           std::vector<feature::EImageDescriberType>& out_descTypes,
                           std::vector<voctree::DocMatch>& out_matchedImages,
-                          const std::string& imagePath = std::string()) const;
+                          const std::string& imagePath = std::string(),
+                          bool* out_usedMotionPrior = nullptr) const;
 
 private:
   /**
@@ -300,6 +359,7 @@ private:
   bool robustMatching(matching::RegionsDatabaseMatcherPerDesc & matchers,
                       const camera::IntrinsicBase * queryIntrinsics,// the intrinsics of the image we are using as reference
                       const feature::MapRegionsPerDesc & regionsToMatch,
+                      const feature::MapFeaturesPerDesc * positionsToMatch, // cached positions of regionsToMatch, or null
                       const camera::IntrinsicBase * matchedIntrinsics,
                       float fDistRatio,
                       double matchingError,
@@ -310,6 +370,26 @@ private:
                       matching::MatchesPerDescType & out_featureMatches,
                       robustEstimation::ERobustEstimator estimator = robustEstimation::ERobustEstimator::ACRANSAC) const;
   
+  /**
+   * @brief Select the candidate views for matching from the camera frustum of the
+   * last localized pose instead of querying the vocabulary tree. Each reconstructed
+   * view is scored by the number of its landmarks falling inside the predicted query
+   * frustum (its covisibility with the predicted camera) and the best views are
+   * returned in the same best-to-worst order as the database retrieval.
+   *
+   * @param[in] imageSize The size of the query image.
+   * @param[in] queryIntrinsics The intrinsics used to build the query frustum.
+   * @param[in] numResults Maximum number of candidate views to return, 0 for no limit.
+   * @param[out] out_matchedImages The candidate views with their covisibility scores.
+   * @return false if there is no valid previous localization to predict from or no
+   * view shares enough points with the predicted frustum; the caller should then
+   * fall back to the voctree retrieval.
+   */
+  bool getCandidateViewsFromMotionPrior(const std::pair<std::size_t, std::size_t> &imageSize,
+                                        const camera::PinholeRadialK3 &queryIntrinsics,
+                                        std::size_t numResults,
+                                        std::vector<voctree::DocMatch>& out_matchedImages) const;
+
   void getAssociationsFromBuffer(matching::RegionsDatabaseMatcherPerDesc& matchers,
                                  const std::pair<std::size_t, std::size_t> & imageSize,
                                  const Parameters &param,
@@ -333,6 +413,11 @@ public:
   /// associated 3D point
   feature::RegionsPerView _regionsPerView;
   ReconstructedRegionsMappingPerView _reconstructedRegionsMappingPerView;
+
+  /// for each view index, the positions of the reconstructed features, copied
+  /// once at loading time so the per-frame matching does not have to copy them
+  /// out of the Regions for every candidate view
+  feature::MapFeaturesPerView _positionsPerView;
   
   /// the feature extractor
   std::vector<std::unique_ptr<feature::ImageDescriber>> _imageDescribers;
@@ -353,6 +438,17 @@ public:
   /// Last frames buffer
   BoundedBuffer<FrameData> _frameBuffer;
 
+  /// for each reconstructed view, the ids of the landmarks it observes, used to
+  /// rank the candidate views by covisibility in the motion-prior fast path
+  std::map<IndexT, std::vector<IndexT>> _landmarksPerView;
+
+  /// the last successful localization, used as the motion prior of the next frame
+  LocalizationResult _lastResult;
+
+  /// constant-velocity extrapolation of the recent trajectory, used to pre-filter
+  /// the 2D-3D associations and shrink the RANSAC budget of the resection
+  PosePredictor _posePredictor;
+
   matching::EMatcherType _matcherType = matching::ANN_L2;
 };
 
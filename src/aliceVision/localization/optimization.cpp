@@ -337,6 +337,107 @@ bool refineSequence(std::vector<LocalizationResult> & vec_localizationResult,
   return b_BA_Status;
 }
 
+bool refineSequenceSlidingWindow(std::vector<LocalizationResult> & vec_localizationResult,
+                                 std::size_t windowSize,
+                                 std::size_t overlap /*= 50*/,
+                                 bool allTheSameIntrinsics /*= true*/,
+                                 bool b_refine_intrinsic /*= true*/,
+                                 bool b_no_distortion /*= false*/,
+                                 bool b_refine_pose /*= true*/,
+                                 const std::string & outputFilename /*= ""*/,
+                                 std::size_t minPointVisibility /*= 0*/)
+{
+  const std::size_t numViews = vec_localizationResult.size();
+
+  if(windowSize == 0 || numViews <= windowSize)
+  {
+    // the whole sequence fits in one problem
+    return refineSequence(vec_localizationResult,
+                          allTheSameIntrinsics,
+                          b_refine_intrinsic,
+                          b_no_distortion,
+                          b_refine_pose,
+                          false,
+                          outputFilename,
+                          minPointVisibility);
+  }
+
+  // keep at least one fresh frame per window
+  if(overlap >= windowSize)
+    overlap = windowSize - 1;
+  const std::size_t stride = windowSize - overlap;
+
+  bool allWindowsSucceeded = true;
+  std::size_t windowIndex = 0;
+
+  for(std::size_t start = 0; start < numViews; start += stride, ++windowIndex)
+  {
+    const std::size_t end = std::min(start + windowSize, numViews);
+
+    ALICEVISION_LOG_DEBUG("Sliding window " << windowIndex << ": frames [" << start << ", " << end << ")");
+
+    // refine a copy of the window, so that the overlapping frames keep the
+    // values committed by the previous window
+    std::vector<LocalizationResult> window(vec_localizationResult.begin() + start,
+                                           vec_localizationResult.begin() + end);
+
+    // the shared intrinsics are refined on the first window only, the later
+    // windows reuse them as fixed parameters
+    const bool refineIntrinsicsThisWindow = b_refine_intrinsic && (windowIndex == 0);
+
+    const std::string windowOutputFilename =
+        outputFilename.empty() ? outputFilename : outputFilename + ".w" + std::to_string(windowIndex);
+
+    const bool windowSucceeded = refineSequence(window,
+                                                allTheSameIntrinsics,
+                                                refineIntrinsicsThisWindow,
+                                                b_no_distortion,
+                                                b_refine_pose,
+                                                false,
+                                                windowOutputFilename,
+                                                minPointVisibility);
+    if(!windowSucceeded)
+    {
+      ALICEVISION_CERR("Bundle Adjustment of the window [" << start << ", " << end << ") failed!");
+      allWindowsSucceeded = false;
+    }
+
+    // commit the fresh frames of the window (the overlapping head has
+    // already been committed by the previous window)
+    const std::size_t firstFresh = (windowIndex == 0) ? 0 : overlap;
+    for(std::size_t i = firstFresh; i < window.size(); ++i)
+      vec_localizationResult[start + i] = window[i];
+
+    // propagate the intrinsics refined on the first window to the rest of
+    // the sequence before the next window is built
+    if(windowIndex == 0 && allTheSameIntrinsics && refineIntrinsicsThisWindow && windowSucceeded)
+    {
+      std::vector<double> params;
+      for(const LocalizationResult & result : window)
+      {
+        if(result.isValid())
+        {
+          params = result.getIntrinsics().getParams();
+          break;
+        }
+      }
+      if(!params.empty())
+      {
+        for(std::size_t i = end; i < numViews; ++i)
+        {
+          if(vec_localizationResult[i].isValid())
+            vec_localizationResult[i].updateIntrinsics(params);
+        }
+      }
+    }
+
+    if(end == numViews)
+      break;
+  }
+
+  return allWindowsSucceeded;
+}
+
 bool refineRigPose(const std::vector<geometry::Pose3 > &vec_subPoses,
                    const std::vector<localization::LocalizationResult> & vec_localizationResults,
                    geometry::Pose3 & rigPose)
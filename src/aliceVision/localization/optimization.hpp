@@ -48,6 +48,40 @@ bool refineSequence(std::vector<LocalizationResult> & vec_localizationResult,
                     const std::string & outputFilename = "",
                     std::size_t minPointVisibility = 0);
 
+/**
+ * @brief Refine a sequence of camera positions with overlapping fixed-size
+ * windows instead of one bundle adjustment over the whole sequence, so that
+ * the peak memory and the solve time stay bounded for arbitrarily long
+ * captures. The refined poses are committed window by window.
+ *
+ * The structure is not refined in this mode (the 3D points come from the
+ * reconstruction and stay fixed), so the windows are only coupled through the
+ * shared intrinsics: these are refined on the first window and then kept
+ * fixed, and the overlapping frames keep the values committed by the earlier
+ * window so each frame is refined exactly once.
+ *
+ * @param[in,out] vec_localizationResult The series of camera poses and point correspondences.
+ * @param[in] windowSize The number of frames refined together; 0 refines the
+ * whole sequence in one problem (equivalent to refineSequence).
+ * @param[in] overlap The number of boundary frames shared by two consecutive windows.
+ * @param[in] allTheSameIntrinsics See refineSequence.
+ * @param[in] b_refine_intrinsic Whether to refine the camera parameters (first window only).
+ * @param[in] b_no_distortion See refineSequence.
+ * @param[in] b_refine_pose See refineSequence.
+ * @param[in] outputFilename See refineSequence; the window index is appended.
+ * @param[in] minPointVisibility See refineSequence, applied per window.
+ * @return true if the bundle adjustment of every window has success.
+ */
+bool refineSequenceSlidingWindow(std::vector<LocalizationResult> & vec_localizationResult,
+                                 std::size_t windowSize,
+                                 std::size_t overlap = 50,
+                                 bool allTheSameIntrinsics = true,
+                                 bool b_refine_intrinsic = true,
+                                 bool b_no_distortion = false,
+                                 bool b_refine_pose = true,
+                                 const std::string & outputFilename = "",
+                                 std::size_t minPointVisibility = 0);
+
 /**
  * @brief refine the pose of a camera rig by minimizing the reprojection error in
  * each camera with the bundle adjustment.
@@ -0,0 +1,71 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/localization/PosePredictor.hpp>
+#include <aliceVision/geometry/Pose3.hpp>
+#include <aliceVision/numeric/numeric.hpp>
+
+#define BOOST_TEST_MODULE PosePredictor
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::localization;
+
+// Pose of a camera travelling along x at constant speed while rotating at a
+// constant rate around z
+static geometry::Pose3 smoothPose(std::size_t frame)
+{
+  const Mat3 rotation = RotationAroundZ(degreeToRadian(0.5 * frame));
+  const Vec3 center(0.1 * frame, 0.0, 0.0);
+  return geometry::Pose3(rotation, center);
+}
+
+BOOST_AUTO_TEST_CASE(PosePredictor_ConstantVelocity)
+{
+  PosePredictor predictor;
+  geometry::Pose3 predicted;
+
+  // no prediction before two frames are available
+  BOOST_CHECK(!predictor.predict(predicted));
+  predictor.update(smoothPose(0));
+  BOOST_CHECK(!predictor.predict(predicted));
+  predictor.update(smoothPose(1));
+
+  // a constant-velocity motion is predicted exactly
+  for(std::size_t frame = 2; frame < 10; ++frame)
+  {
+    BOOST_CHECK(predictor.predict(predicted));
+    const geometry::Pose3 expected = smoothPose(frame);
+    BOOST_CHECK_SMALL(getRotationMagnitude(predicted.rotation() * expected.rotation().transpose()), 1e-9);
+    BOOST_CHECK_SMALL((predicted.center() - expected.center()).norm(), 1e-9);
+    predictor.update(expected);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(PosePredictor_GateClosesOnJerkyMotion)
+{
+  PosePredictor predictor;
+  geometry::Pose3 predicted;
+
+  // build up statistics on a smooth trajectory
+  for(std::size_t frame = 0; frame < 6; ++frame)
+    predictor.update(smoothPose(frame));
+  BOOST_CHECK(predictor.predict(predicted));
+
+  // large unpredictable jumps must close the gate
+  for(std::size_t frame = 6; frame < 12; ++frame)
+  {
+    const double jump = (frame % 2 == 0) ? 5.0 : -5.0;
+    const Mat3 rotation = RotationAroundZ(degreeToRadian(30.0 * jump));
+    predictor.update(geometry::Pose3(rotation, Vec3(jump, jump, 0.0)));
+  }
+  BOOST_CHECK(!predictor.predict(predicted));
+
+  // reset on tracking loss forgets the bad statistics
+  predictor.reset();
+  for(std::size_t frame = 0; frame < 4; ++frame)
+    predictor.update(smoothPose(frame));
+  BOOST_CHECK(predictor.predict(predicted));
+}
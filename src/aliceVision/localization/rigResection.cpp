@@ -23,6 +23,41 @@ namespace localization{
 
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_OPENGV)
 
+namespace {
+
+/**
+ * @brief Per-thread reusable state for rigResection.
+ *
+ * The rig geometry is fixed across the frames of a sequence, so the
+ * per-camera offsets and rotations fed to the non-central adapter are
+ * rebuilt only when the subposes actually change. The flattened
+ * correspondence buffers are also kept here so they reuse their capacity
+ * across the frames localized by the same thread.
+ */
+struct RigResectionCache
+{
+  /// the subposes the camera setup below was built from
+  std::vector<geometry::Pose3> subPoses;
+  bool setupValid = false;
+  opengv::translations_t camOffsets;
+  opengv::rotations_t camRotations;
+
+  /// flattened per-frame correspondence buffers
+  opengv::bearingVectors_t bearingVectors;
+  opengv::points_t points;
+  std::vector<int> camCorrespondences;
+  /// absolute index -> (camera, local index) of each correspondence
+  std::vector<std::pair<std::size_t, std::size_t>> absoluteToLocal;
+
+  static RigResectionCache& get()
+  {
+    static thread_local RigResectionCache instance;
+    return instance;
+  }
+};
+
+} // namespace
+
 EstimationStatus rigResection(const std::vector<Mat> &pts2d,
                   const std::vector<Mat> &pts3d,
                   const std::vector<camera::PinholeRadialK3 > &vec_queryIntrinsics,
@@ -48,21 +83,32 @@ EstimationStatus rigResection(const std::vector<Mat> &pts2d,
   assert(vec_subPoses.size() == numCameras-1);
   
   
-  // Copy the subposes into separate vectors for rotations and centers
-  opengv::translations_t camOffsets(numCameras); //centers
-  opengv::rotations_t camRotations(numCameras);
-  
-  // the first is the identity (the main camera)
-  camOffsets[0] = Vec3::Zero();
-  camRotations[0] = Mat3::Identity();
-  // now copy the others
-  for(std::size_t i = 1; i < numCameras; ++i)
+  RigResectionCache &cache = RigResectionCache::get();
+
+  // Rebuild the per-camera offsets and rotations only when the rig geometry
+  // changed: across the frames of a shoot the subposes are fixed, so this
+  // setup is paid once per thread instead of once per frame.
+  if(!cache.setupValid || cache.subPoses != vec_subPoses)
   {
-    camOffsets[i] = vec_subPoses[i-1].center();
-    // it takes as input a real pose, ie the rotation wrt the world frame
-    camRotations[i] = vec_subPoses[i-1].rotation().inverse();
+    cache.camOffsets.resize(numCameras); //centers
+    cache.camRotations.resize(numCameras);
+
+    // the first is the identity (the main camera)
+    cache.camOffsets[0] = Vec3::Zero();
+    cache.camRotations[0] = Mat3::Identity();
+    // now copy the others
+    for(std::size_t i = 1; i < numCameras; ++i)
+    {
+      cache.camOffsets[i] = vec_subPoses[i-1].center();
+      // it takes as input a real pose, ie the rotation wrt the world frame
+      cache.camRotations[i] = vec_subPoses[i-1].rotation().inverse();
+    }
+    cache.subPoses = vec_subPoses;
+    cache.setupValid = true;
   }
-  
+  opengv::translations_t &camOffsets = cache.camOffsets;
+  opengv::rotations_t &camRotations = cache.camRotations;
+
   // count the total number of associations
   std::size_t numTotalPoints = 0;
   for(std::size_t i = 0; i < numCameras; ++i)
@@ -73,48 +119,61 @@ EstimationStatus rigResection(const std::vector<Mat> &pts2d,
     assert(pts2d[i].rows() == 2);
     numTotalPoints += numPts;
   }
-  // transform the points into bearingVectors
-  opengv::bearingVectors_t bearingVectors;  // this contains the bearing vector associated to each image feature
-  opengv::points_t points;                  // this contains the 3d points
+  // transform the points into bearingVectors; the buffers come from the
+  // per-thread cache so they reuse their capacity across frames
+  opengv::bearingVectors_t &bearingVectors = cache.bearingVectors; // this contains the bearing vector associated to each image feature
+  opengv::points_t &points = cache.points;                         // this contains the 3d points
+  std::vector<int> &camCorrespondences = cache.camCorrespondences; // this is to keep track, for each bearing vector, whose camera it belongs
+  bearingVectors.clear();
+  points.clear();
+  camCorrespondences.clear();
+  bearingVectors.reserve(numTotalPoints);
   points.reserve(numTotalPoints);
-  std::vector<int> camCorrespondences;      // this is to keep track, for each bearing vector, whose camera it belongs
-  
-  // this map is used to remap the indices of the flatten structure containing
-  // the points (points, bearingvector) to the original local index of each pts2d/pts3d: 
-  // eg 
+  camCorrespondences.reserve(numTotalPoints);
+
+  // this table is used to remap the indices of the flatten structure containing
+  // the points (points, bearingvector) to the original local index of each pts2d/pts3d:
+  // eg
   // localIdx = absoluteToLocal[absoluteID]; such that
   // pts3d[localIdx.first].col(localIdx.second) == points[absoluteID];
-  std::map<std::size_t, std::pair<std::size_t,std::size_t>> absoluteToLocal;   
-  
-  
+  std::vector<std::pair<std::size_t, std::size_t>> &absoluteToLocal = cache.absoluteToLocal;
+  absoluteToLocal.clear();
+  absoluteToLocal.reserve(numTotalPoints);
+
   for(std::size_t cam = 0; cam < numCameras; ++cam)
   {
     const std::size_t numPts = pts2d[cam].cols();
     const camera::PinholeRadialK3 &currCamera = vec_queryIntrinsics[cam];
-    
+
     for(std::size_t i = 0; i < numPts; ++i)
     {
       // store the 3D point
       points.push_back(pts3d[cam].col(i));
-      
+
       // we first remove the distortion and then we transform the undistorted point in
       // normalized camera coordinates (inv(K)*undistortedPoint)
       auto pt = currCamera.ima2cam(currCamera.get_ud_pixel(pts2d[cam].col(i)));
-      
-      opengv::bearingVector_t bearing(pt(0), pt(1), 1.0);
-      
-      // normalize the bearing-vector to 1
-      bearing = bearing / bearing.norm();
-
-      bearingVectors.push_back(bearing);
-      
+
+      // not normalized yet, see the batched normalization below
+      bearingVectors.emplace_back(pt(0), pt(1), 1.0);
+
       camCorrespondences.push_back(cam);
-      
-      // fill the indices map
-      absoluteToLocal[points.size()-1] = std::make_pair(cam, i);
+
+      // fill the indices table
+      absoluteToLocal.emplace_back(cam, i);
     }
   }
 
+  // Batched normalization of the bearing-vectors to 1: the vectors are
+  // packed contiguously as a [3 x N] buffer, so one Eigen pass normalizes
+  // all the columns with packet math instead of one scalar norm per point.
+  if(numTotalPoints > 0)
+  {
+    Eigen::Map<Eigen::Matrix<double, 3, Eigen::Dynamic>>
+        packed(bearingVectors[0].data(), 3, numTotalPoints);
+    packed.array().rowwise() /= packed.colwise().norm().array();
+  }
+
   assert(points.size() == numTotalPoints);
   assert(bearingVectors.size() == numTotalPoints);
   assert(camCorrespondences.size() == numTotalPoints);
@@ -181,7 +240,7 @@ EstimationStatus rigResection(const std::vector<Mat> &pts2d,
   // remap the inliers
   for(std::size_t i = 0; i < numInliers; i++)
   {
-    const auto idx = absoluteToLocal.at(ransac.inliers_[i]);
+    const auto &idx = absoluteToLocal[ransac.inliers_[i]];
     inliers[idx.first].emplace_back(idx.second);
   }
 //  for(size_t i = 0; i < ransac.inliers_.size(); i++)
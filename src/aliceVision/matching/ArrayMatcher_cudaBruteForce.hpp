@@ -0,0 +1,154 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include "aliceVision/matching/ArrayMatcher.hpp"
+#include "aliceVision/matching/cudaBruteForceMatching.hpp"
+#include "aliceVision/matching/metric.hpp"
+#include <aliceVision/system/Logger.hpp>
+
+#include <algorithm>
+#include <vector>
+
+namespace aliceVision {
+namespace matching {
+
+/**
+ * @brief Brute force L2 matcher running on a CUDA device.
+ *
+ * The database descriptors are converted to float and uploaded once at Build
+ * time; they stay resident on the GPU across all the queries matched against
+ * this instance. Each search streams the query descriptors to the device,
+ * computes the distance matrix tile by tile (see CudaBruteForceMatcher) and
+ * only brings the two best (index, squared distance) pairs per query back, so
+ * the nearest neighbours needed by the distance ratio test are found without
+ * any host side distance computation.
+ *
+ * Only available when AliceVision is built with CUDA support.
+ */
+template < typename Scalar = float, typename Metric = L2_Vectorized<Scalar> >
+class ArrayMatcher_cudaBruteForce : public ArrayMatcher<Scalar, Metric>
+{
+  public:
+  typedef typename Metric::ResultType DistanceType;
+
+  ArrayMatcher_cudaBruteForce() {}
+  virtual ~ArrayMatcher_cudaBruteForce() {}
+
+  /**
+   * Build the matching structure: upload the dataset to the CUDA device.
+   *
+   * \param[in] dataset   Input data.
+   * \param[in] nbRows    The number of component.
+   * \param[in] dimension Length of the data contained in the dataset.
+   *
+   * \return True if success.
+   */
+  bool Build(const Scalar * dataset, int nbRows, int dimension)
+  {
+    if (nbRows < 1)
+      return false;
+
+    if (!CudaBruteForceMatcher::isAvailable())
+    {
+      ALICEVISION_LOG_WARNING("No CUDA device available for BRUTE_FORCE_CUDA_L2 matching.");
+      return false;
+    }
+
+    const std::vector<float> floatDataset(dataset, dataset + std::size_t(nbRows) * dimension);
+    return _cudaMatcher.setDatabase(&floatDataset[0], nbRows, dimension);
+  }
+
+  /**
+   * Search the nearest Neighbor of the scalar array query.
+   *
+   * \param[in]   query     The query array
+   * \param[out]  indice    The indice of array in the dataset that
+   *  have been computed as the nearest array.
+   * \param[out]  distance  The distance between the two arrays.
+   *
+   * \return True if success.
+   */
+  bool SearchNeighbour( const Scalar * query,
+                        int * indice, DistanceType * distance)
+  {
+    if (_cudaMatcher.databaseSize() < 1)
+      return false;
+
+    const std::vector<float> floatQuery(query, query + _cudaMatcher.dimension());
+    int indices[2];
+    float distances[2];
+
+    if (!_cudaMatcher.searchTwoNearestNeighbours(&floatQuery[0], 1, indices, distances))
+      return false;
+
+    *indice = indices[0];
+    *distance = static_cast<DistanceType>(distances[0]);
+    return true;
+  }
+
+/**
+   * Search the N nearest Neighbor of the scalar array query.
+   * The device kernel keeps the two best candidates per query, so at most
+   * two neighbours can be requested.
+   *
+   * \param[in]   query     The query array
+   * \param[in]   nbQuery   The number of query rows
+   * \param[out]  indices   The corresponding (query, neighbor) indices
+   * \param[out]  distances The distances between the matched arrays.
+   * \param[out]  NN        The number of maximal neighbor that will be searched.
+   *
+   * \return True if success.
+   */
+  bool SearchNeighbours
+  (
+    const Scalar * query, int nbQuery,
+    IndMatches * pvec_indices,
+    std::vector<DistanceType> * pvec_distances,
+    size_t NN
+  )
+  {
+    if (_cudaMatcher.databaseSize() < 1 || nbQuery < 1)
+      return false;
+
+    if (NN > size_t(_cudaMatcher.databaseSize()))
+      return false;
+
+    if (NN > 2)
+    {
+      ALICEVISION_LOG_WARNING("BRUTE_FORCE_CUDA_L2 only supports up to 2 nearest neighbours per query.");
+      return false;
+    }
+
+    const int dimension = _cudaMatcher.dimension();
+    const std::vector<float> floatQueries(query, query + std::size_t(nbQuery) * dimension);
+    std::vector<int> foundIndices(std::size_t(nbQuery) * 2);
+    std::vector<float> foundDistances(std::size_t(nbQuery) * 2);
+
+    if (!_cudaMatcher.searchTwoNearestNeighbours(&floatQueries[0], nbQuery, &foundIndices[0], &foundDistances[0]))
+      return false;
+
+    pvec_distances->resize(nbQuery * NN);
+    pvec_indices->resize(nbQuery * NN);
+
+    for (int queryIndex = 0; queryIndex < nbQuery; ++queryIndex)
+    {
+      for (size_t i = 0; i < NN; ++i)
+      {
+        (*pvec_distances)[queryIndex*NN+i] = static_cast<DistanceType>(foundDistances[queryIndex*2+i]);
+        (*pvec_indices)[queryIndex*NN+i] = IndMatch(queryIndex, foundIndices[queryIndex*2+i]);
+      }
+    }
+    return true;
+  }
+
+private:
+  /// Device side matcher, keeps the dataset resident on the GPU.
+  CudaBruteForceMatcher _cudaMatcher;
+};
+
+}  // namespace matching
+}  // namespace aliceVision
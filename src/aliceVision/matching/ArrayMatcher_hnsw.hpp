@@ -0,0 +1,337 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/matching/ArrayMatcher.hpp>
+#include <aliceVision/matching/metric.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <random>
+#include <vector>
+
+namespace aliceVision {
+namespace matching {
+
+/// Implement ArrayMatcher as a Hierarchical Navigable Small World graph.
+// "Efficient and robust approximate nearest neighbor search using
+//  Hierarchical Navigable Small World graphs"
+// Yu. A. Malkov, D. A. Yashunin
+//
+// Approximate search: a layered proximity graph is traversed greedily from
+// a single entry point, which gives query times that grow logarithmically
+// with the dataset size. Recall is controlled by the ef parameters.
+//
+// By default use squared L2 metric (L2_Vectorized<Scalar>)
+
+template < typename Scalar = float, typename Metric = L2_Vectorized<Scalar> >
+class ArrayMatcher_hnsw : public ArrayMatcher<Scalar, Metric>
+{
+  public:
+  typedef typename Metric::ResultType DistanceType;
+
+  /**
+   * \param[in] graphDegree      Number of links per node on the upper layers (M).
+   *  Layer 0 uses twice this value.
+   * \param[in] efConstruction   Size of the candidate list while building the
+   *  graph: larger is slower to build but gives a better graph.
+   * \param[in] efSearch         Size of the candidate list while querying:
+   *  larger is slower but increases recall.
+   */
+  ArrayMatcher_hnsw(std::size_t graphDegree = 16,
+                    std::size_t efConstruction = 100,
+                    std::size_t efSearch = 64)
+    : _graphDegree(graphDegree)
+    , _efConstruction(efConstruction)
+    , _efSearch(efSearch)
+  {}
+
+  virtual ~ArrayMatcher_hnsw() {}
+
+  void setEfSearch(std::size_t efSearch) { _efSearch = efSearch; }
+
+  /**
+   * Build the matching structure
+   *
+   * \param[in] dataset   Input data.
+   * \param[in] nbRows    The number of component.
+   * \param[in] dimension Length of the data contained in the dataset.
+   *
+   * \return True if success.
+   */
+  bool Build( const Scalar * dataset, int nbRows, int dimension)
+  {
+    if (nbRows <= 0)
+      return false;
+
+    _dataset = dataset;
+    _nbRows = nbRows;
+    _dimension = dimension;
+    _links.assign(nbRows, {});
+    _entryPoint = 0;
+    _maxLevel = 0;
+
+    // Deterministic seed: the same dataset always produces the same graph
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    const double levelMult = 1.0 / std::log(double(_graphDegree));
+
+    for (int node = 0; node < nbRows; ++node)
+    {
+      const int nodeLevel = (int)std::floor(-std::log(uniform(rng)) * levelMult);
+      insertNode(node, nodeLevel);
+    }
+    return true;
+  }
+
+  /**
+   * Search the nearest Neighbor of the scalar array query.
+   *
+   * \param[in]   query     The query array
+   * \param[out]  indice    The indice of array in the dataset that
+   *  have been computed as the nearest array.
+   * \param[out]  distance  The distance between the two arrays.
+   *
+   * \return True if success.
+   */
+  bool SearchNeighbour( const Scalar * query,
+                        int * indice, DistanceType * distance)
+  {
+    if (_dataset == nullptr)
+      return false;
+
+    const std::vector<Candidate> found = searchKnn(query, 1);
+    if (found.empty())
+      return false;
+
+    *indice = found.front().index;
+    *distance = found.front().distance;
+    return true;
+  }
+
+  /**
+   * Search the N nearest Neighbor of the scalar array query.
+   *
+   * \param[in]   query     The query array
+   * \param[in]   nbQuery   The number of query rows
+   * \param[out]  pvec_indices   The corresponding (query, neighbor) indices
+   * \param[out]  pvec_distances The distances between the matched arrays.
+   * \param[out]  NN        The number of maximal neighbor that could
+   *  will be searched.
+   *
+   * \return True if success.
+   */
+  bool SearchNeighbours( const Scalar * query, int nbQuery,
+                         IndMatches * pvec_indices,
+                         std::vector<DistanceType> * pvec_distances,
+                         size_t NN)
+  {
+    if (_dataset == nullptr || NN > (size_t)_nbRows || nbQuery < 1)
+      return false;
+
+    pvec_distances->resize(nbQuery * NN);
+    pvec_indices->resize(nbQuery * NN);
+
+    // The graph is read-only once built: batched queries run in parallel
+    #pragma omp parallel for schedule(dynamic)
+    for (int queryIndex = 0; queryIndex < nbQuery; ++queryIndex)
+    {
+      const Scalar * queryPtr = query + queryIndex * _dimension;
+      const std::vector<Candidate> found = searchKnn(queryPtr, NN);
+      for (size_t i = 0; i < found.size(); ++i)
+      {
+        (*pvec_distances)[queryIndex*NN+i] = found[i].distance;
+        (*pvec_indices)[queryIndex*NN+i] = IndMatch(queryIndex, found[i].index);
+      }
+    }
+    return true;
+  }
+
+  private:
+
+  struct Candidate
+  {
+    DistanceType distance;
+    int index;
+
+    bool operator<(const Candidate& other) const { return distance < other.distance; }
+    bool operator>(const Candidate& other) const { return distance > other.distance; }
+  };
+
+  inline DistanceType distanceToNode(const Scalar * query, int node) const
+  {
+    return Metric()(query, _dataset + (std::size_t)node * _dimension, _dimension);
+  }
+
+  std::size_t levelCapacity(int level) const
+  {
+    return (level == 0) ? 2 * _graphDegree : _graphDegree;
+  }
+
+  /// Greedy descent on one layer: move to the closest neighbor until stuck
+  void greedyStep(const Scalar * query, int level, int & current, DistanceType & currentDist) const
+  {
+    bool changed = true;
+    while (changed)
+    {
+      changed = false;
+      for (const int neighbor : _links[current][level])
+      {
+        const DistanceType d = distanceToNode(query, neighbor);
+        if (d < currentDist)
+        {
+          currentDist = d;
+          current = neighbor;
+          changed = true;
+        }
+      }
+    }
+  }
+
+  /// Beam search on one layer, returns up to ef candidates sorted by
+  /// increasing distance
+  std::vector<Candidate> searchLayer(const Scalar * query, int entry,
+                                     DistanceType entryDist, int level, std::size_t ef) const
+  {
+    std::vector<char> visited(_nbRows, 0);
+    visited[entry] = 1;
+
+    // candidates to expand, closest first
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> candidates;
+    // current best results, farthest first
+    std::priority_queue<Candidate> results;
+    candidates.push({entryDist, entry});
+    results.push({entryDist, entry});
+
+    while (!candidates.empty())
+    {
+      const Candidate closest = candidates.top();
+      if (closest.distance > results.top().distance && results.size() >= ef)
+        break;
+      candidates.pop();
+
+      for (const int neighbor : _links[closest.index][level])
+      {
+        if (visited[neighbor])
+          continue;
+        visited[neighbor] = 1;
+        const DistanceType d = distanceToNode(query, neighbor);
+        if (results.size() < ef || d < results.top().distance)
+        {
+          candidates.push({d, neighbor});
+          results.push({d, neighbor});
+          if (results.size() > ef)
+            results.pop();
+        }
+      }
+    }
+
+    std::vector<Candidate> out(results.size());
+    for (std::size_t i = out.size(); i > 0; --i)
+    {
+      out[i-1] = results.top();
+      results.pop();
+    }
+    return out;
+  }
+
+  /// Full query: greedy descent on the upper layers then beam search on layer 0
+  std::vector<Candidate> searchKnn(const Scalar * query, std::size_t nn) const
+  {
+    int current = _entryPoint;
+    DistanceType currentDist = distanceToNode(query, current);
+    for (int level = _maxLevel; level > 0; --level)
+      greedyStep(query, level, current, currentDist);
+
+    std::vector<Candidate> found =
+        searchLayer(query, current, currentDist, 0, std::max(_efSearch, nn));
+    if (found.size() > nn)
+      found.resize(nn);
+    return found;
+  }
+
+  void insertNode(int node, int nodeLevel)
+  {
+    _links[node].assign(nodeLevel + 1, {});
+
+    if (node == 0)
+    {
+      _entryPoint = node;
+      _maxLevel = nodeLevel;
+      return;
+    }
+
+    const Scalar * point = _dataset + (std::size_t)node * _dimension;
+    int current = _entryPoint;
+    DistanceType currentDist = distanceToNode(point, current);
+
+    for (int level = _maxLevel; level > nodeLevel; --level)
+      greedyStep(point, level, current, currentDist);
+
+    for (int level = std::min(nodeLevel, _maxLevel); level >= 0; --level)
+    {
+      const std::vector<Candidate> candidates =
+          searchLayer(point, current, currentDist, level, _efConstruction);
+
+      // link to the closest candidates, both ways
+      const std::size_t capacity = levelCapacity(level);
+      const std::size_t nbLinks = std::min(candidates.size(), (std::size_t)_graphDegree);
+      for (std::size_t i = 0; i < nbLinks; ++i)
+      {
+        const int neighbor = candidates[i].index;
+        _links[node][level].push_back(neighbor);
+        _links[neighbor][level].push_back(node);
+        if (_links[neighbor][level].size() > capacity)
+          pruneLinks(neighbor, level, capacity);
+      }
+
+      current = candidates.front().index;
+      currentDist = candidates.front().distance;
+    }
+
+    if (nodeLevel > _maxLevel)
+    {
+      _entryPoint = node;
+      _maxLevel = nodeLevel;
+    }
+  }
+
+  /// Keep only the capacity closest links of a node on a layer
+  void pruneLinks(int node, int level, std::size_t capacity)
+  {
+    const Scalar * point = _dataset + (std::size_t)node * _dimension;
+    std::vector<Candidate> linked;
+    linked.reserve(_links[node][level].size());
+    for (const int neighbor : _links[node][level])
+      linked.push_back({distanceToNode(point, neighbor), neighbor});
+    std::sort(linked.begin(), linked.end());
+    linked.resize(capacity);
+
+    std::vector<int> & links = _links[node][level];
+    links.clear();
+    for (const Candidate & candidate : linked)
+      links.push_back(candidate.index);
+  }
+
+  /// Not owned: mapped on the descriptors given to Build
+  const Scalar * _dataset = nullptr;
+  int _nbRows = 0;
+  int _dimension = 0;
+
+  std::size_t _graphDegree;
+  std::size_t _efConstruction;
+  std::size_t _efSearch;
+
+  /// Per node, per level adjacency of the navigable small world graph
+  std::vector<std::vector<std::vector<int>>> _links;
+  int _entryPoint = 0;
+  int _maxLevel = 0;
+};
+
+}  // namespace matching
+}  // namespace aliceVision
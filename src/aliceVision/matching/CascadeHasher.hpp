@@ -189,40 +189,47 @@ public:
       // Allocate space for hash codes.
       const typename MatrixT::Index nbDescriptions = descriptions.rows();
       hashed_descriptions.hashed_desc.resize(nbDescriptions);
-      Eigen::VectorXf descriptor(descriptions.cols());
-      for (int i = 0; i < nbDescriptions; ++i)
-      {
-        // Allocate space for each bucket id.
-        hashed_descriptions.hashed_desc[i].bucket_ids.resize(nb_bucket_groups_);
-
-        for (int k = 0; k < descriptions.cols(); ++k)
-        {
-          descriptor(k) = descriptions(i,k);
-        }
-        descriptor -= zero_mean_descriptor;
 
-        auto& hash_code = hashed_descriptions.hashed_desc[i].hash_code;
-        hash_code = stl::dynamic_bitset(descriptions.cols());
+      // The projections are batched over chunks of descriptors: one
+      // matrix-matrix product per chunk lets Eigen use its vectorized kernels
+      // instead of one matrix-vector product per descriptor.
+      static const typename MatrixT::Index kChunkSize = 256;
+      Eigen::MatrixXf chunk;
+      Eigen::MatrixXf primary_projection;
+      Eigen::MatrixXf secondary_projection;
+      for (typename MatrixT::Index chunk_start = 0; chunk_start < nbDescriptions; chunk_start += kChunkSize)
+      {
+        const typename MatrixT::Index chunk_rows = std::min(kChunkSize, nbDescriptions - chunk_start);
+        chunk = descriptions.middleRows(chunk_start, chunk_rows).template cast<float>();
+        chunk.rowwise() -= zero_mean_descriptor.transpose();
 
-        // Compute hash code.
-        const Eigen::VectorXf primary_projection = primary_hash_projection_ * descriptor;
-        for (int j = 0; j < nb_hash_code_; ++j)
+        // Compute the hash codes of the whole chunk.
+        primary_projection.noalias() = chunk * primary_hash_projection_.transpose();
+        for (typename MatrixT::Index r = 0; r < chunk_rows; ++r)
         {
-          hash_code[j] = primary_projection(j) > 0;
+          auto& hashed_desc = hashed_descriptions.hashed_desc[chunk_start + r];
+          // Allocate space for each bucket id.
+          hashed_desc.bucket_ids.resize(nb_bucket_groups_);
+          hashed_desc.hash_code = stl::dynamic_bitset(descriptions.cols());
+          for (int j = 0; j < nb_hash_code_; ++j)
+          {
+            hashed_desc.hash_code[j] = primary_projection(r, j) > 0;
+          }
         }
 
         // Determine the bucket index for each group.
-        Eigen::VectorXf secondary_projection;
         for (int j = 0; j < nb_bucket_groups_; ++j)
         {
-          uint16_t bucket_id = 0;
-          secondary_projection = secondary_hash_projection_[j] * descriptor;
-
-          for (int k = 0; k < nb_bits_per_bucket_; ++k)
+          secondary_projection.noalias() = chunk * secondary_hash_projection_[j].transpose();
+          for (typename MatrixT::Index r = 0; r < chunk_rows; ++r)
           {
-            bucket_id = (bucket_id << 1) + (secondary_projection(k) > 0 ? 1 : 0);
+            uint16_t bucket_id = 0;
+            for (int k = 0; k < nb_bits_per_bucket_; ++k)
+            {
+              bucket_id = (bucket_id << 1) + (secondary_projection(r, k) > 0 ? 1 : 0);
+            }
+            hashed_descriptions.hashed_desc[chunk_start + r].bucket_ids[j] = bucket_id;
           }
-          hashed_descriptions.hashed_desc[i].bucket_ids[j] = bucket_id;
         }
       }
     }
@@ -279,9 +286,10 @@ public:
     std::vector<std::pair<DistanceType, int> > candidate_euclidean_distances;
     candidate_euclidean_distances.reserve(kNumTopCandidates);
 
-    // A preallocated vector to determine if we have already used a particular
-    // feature for matching (i.e., prevents duplicates).
-    std::vector<bool> used_descriptor(hashed_descriptions2.hashed_desc.size());
+    // A preallocated bitset to determine if we have already used a particular
+    // feature for matching (i.e., prevents duplicates). It is reused across
+    // the queries: each candidate clears its own bit before testing it.
+    stl::dynamic_bitset used_descriptor(hashed_descriptions2.hashed_desc.size());
 
     typedef matching::Hamming<stl::dynamic_bitset::BlockType> HammingMetricType;
     static const HammingMetricType metricH = {};
@@ -0,0 +1,69 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "CompactPairwiseMatches.hpp"
+
+namespace aliceVision {
+namespace matching {
+
+void CompactPairwiseMatches::fromPairwiseMatches(const PairwiseMatches& matches)
+{
+  clear();
+
+  std::size_t nbRanges = 0;
+  std::size_t nbMatches = 0;
+  for(const auto& matchesPerDescIt: matches)
+  {
+    nbRanges += matchesPerDescIt.second.size();
+    for(const auto& matchesIt: matchesPerDescIt.second)
+      nbMatches += matchesIt.second.size();
+  }
+
+  _ranges.reserve(nbRanges);
+  _leftFeatures.reserve(nbMatches);
+  _rightFeatures.reserve(nbMatches);
+
+  for(const auto& matchesPerDescIt: matches)
+  {
+    for(const auto& matchesIt: matchesPerDescIt.second)
+    {
+      MatchRange range;
+      range.imagePair = matchesPerDescIt.first;
+      range.descType = matchesIt.first;
+      range.begin = _leftFeatures.size();
+      range.size = matchesIt.second.size();
+      _ranges.push_back(range);
+
+      for(const IndMatch& m: matchesIt.second)
+      {
+        _leftFeatures.push_back(m._i);
+        _rightFeatures.push_back(m._j);
+      }
+    }
+  }
+}
+
+void CompactPairwiseMatches::toPairwiseMatches(PairwiseMatches& out_matches) const
+{
+  out_matches.clear();
+
+  for(const MatchRange& range: _ranges)
+  {
+    IndMatches& matches = out_matches[range.imagePair][range.descType];
+    matches.reserve(range.size);
+    for(std::size_t k = range.begin; k < range.begin + range.size; ++k)
+      matches.emplace_back(_leftFeatures[k], _rightFeatures[k]);
+  }
+}
+
+void CompactPairwiseMatches::clear()
+{
+  _ranges.clear();
+  _leftFeatures.clear();
+  _rightFeatures.clear();
+}
+
+} // namespace matching
+} // namespace aliceVision
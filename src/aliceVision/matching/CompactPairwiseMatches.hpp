@@ -0,0 +1,81 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+#include <aliceVision/feature/imageDescriberCommon.hpp>
+#include <aliceVision/matching/IndMatch.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace aliceVision {
+namespace matching {
+
+/**
+ * @brief Compact structure-of-arrays storage for pairwise matches.
+ *
+ * PairwiseMatches keeps one std::vector<IndMatch> per (image pair, describer
+ * type): on very large match sets the map nodes, the per-vector bookkeeping
+ * and the IndMatch padding (the debug distance member) multiply the memory of
+ * what is conceptually two 32-bit index columns. This container stores the
+ * feature indices of all the matches in two contiguous std::uint32_t arrays
+ * plus a slim pair -> range index, ordered like the map form, so consumers
+ * such as the track builders iterate the same matches with a fraction of the
+ * footprint and sequential memory accesses.
+ *
+ * Convertible from/to the map form; the conversion preserves the matches and
+ * their order but drops the optional debug distances.
+ */
+class CompactPairwiseMatches
+{
+public:
+  /// The matches of one (image pair, describer type): one contiguous run of
+  /// the feature index arrays.
+  struct MatchRange
+  {
+    Pair imagePair;
+    feature::EImageDescriberType descType;
+    std::size_t begin; ///< index of the first match of the run in the feature arrays
+    std::size_t size;  ///< number of matches of the run
+  };
+
+  CompactPairwiseMatches() = default;
+
+  explicit CompactPairwiseMatches(const PairwiseMatches& matches)
+  {
+    fromPairwiseMatches(matches);
+  }
+
+  /// Rebuild the compact storage from the map form.
+  void fromPairwiseMatches(const PairwiseMatches& matches);
+
+  /// Expand back to the map form (the debug distances are zero).
+  void toPairwiseMatches(PairwiseMatches& out_matches) const;
+
+  void clear();
+
+  /// The runs, ordered by (image pair, describer type) like the map form.
+  const std::vector<MatchRange>& getRanges() const { return _ranges; }
+
+  /// Left feature index of each match, all runs concatenated.
+  const std::vector<std::uint32_t>& getLeftFeatures() const { return _leftFeatures; }
+
+  /// Right feature index of each match, all runs concatenated.
+  const std::vector<std::uint32_t>& getRightFeatures() const { return _rightFeatures; }
+
+  std::size_t getNbAllMatches() const { return _leftFeatures.size(); }
+
+  bool empty() const { return _ranges.empty(); }
+
+private:
+  std::vector<MatchRange> _ranges;
+  std::vector<std::uint32_t> _leftFeatures;
+  std::vector<std::uint32_t> _rightFeatures;
+};
+
+} // namespace matching
+} // namespace aliceVision
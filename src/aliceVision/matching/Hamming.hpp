@@ -21,6 +21,12 @@ typedef unsigned __int64 uint64_t;
 #include "arm_neon.h"
 #endif
 
+#if defined(__AVX2__)
+#define ALICEVISION_HAMMING_HAVE_AVX2
+#include <aliceVision/system/cpu.hpp>
+#include <immintrin.h>
+#endif
+
 // Brief:
 // Hamming distance count the number of bits in common between descriptors
 //  by using a XOR operation + a count.
@@ -67,6 +73,45 @@ static const unsigned char pop_count_LUT[256] =
 #undef OMVG_B6
 };
 
+#if defined(ALICEVISION_HAMMING_HAVE_AVX2)
+
+/// Cached CPUID result, evaluated once per process
+inline bool hammingCpuHasAvx2()
+{
+  static const bool support = system::cpu_support_avx2();
+  return support;
+}
+
+/// Bulk Hamming distance over a whole binary descriptor (AVX2 method).
+/// Nibble popcounts come from a VPSHUFB lookup table and are accumulated
+/// with VPSADBW. Assumes size is a multiple of 32 bytes.
+inline unsigned int hamming_avx2(const unsigned char* a, const unsigned char* b, std::size_t size)
+{
+  const __m256i lut = _mm256_setr_epi8(
+    0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+    0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i lowMask = _mm256_set1_epi8(0x0f);
+  __m256i cumSum = _mm256_setzero_si256();
+
+  for(std::size_t i = 0; i < size; i += 32)
+  {
+    const __m256i x = _mm256_xor_si256(
+      _mm256_loadu_si256((const __m256i*)(a+i)),
+      _mm256_loadu_si256((const __m256i*)(b+i)));
+    const __m256i lo = _mm256_and_si256(x, lowMask);
+    const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(x, 4), lowMask);
+    const __m256i counts = _mm256_add_epi8(
+      _mm256_shuffle_epi8(lut, lo),
+      _mm256_shuffle_epi8(lut, hi));
+    cumSum = _mm256_add_epi64(cumSum, _mm256_sad_epu8(counts, _mm256_setzero_si256()));
+  }
+
+  const __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(cumSum), _mm256_extracti128_si256(cumSum, 1));
+  return static_cast<unsigned int>(_mm_cvtsi128_si64(sum) + _mm_extract_epi64(sum, 1));
+}
+
+#endif // ALICEVISION_HAMMING_HAVE_AVX2
+
 // Hamming distance to work on raw memory
 //  like unsigned char *
 template<typename T>
@@ -110,6 +155,17 @@ struct Hamming
   inline ResultType operator()(Iterator1 a, Iterator2 b, size_t size) const
   {
     ResultType result = 0;
+
+#if defined(ALICEVISION_HAMMING_HAVE_AVX2)
+    // Whole descriptor at once (e.g. AKAZE MLDB), runtime-dispatched
+    if(size % 32 == 0 && hammingCpuHasAvx2())
+    {
+      return hamming_avx2(
+        reinterpret_cast<const unsigned char*>(a),
+        reinterpret_cast<const unsigned char*>(b), size);
+    }
+#endif
+
 // Windows & generic platforms:
 
 #ifdef PLATFORM_64_BIT
@@ -5,13 +5,104 @@
 
 #pragma once
 
+#include <algorithm>
 #include <iostream>
+#include <vector>
 #include "aliceVision/matching/IndMatch.hpp"
 #include "aliceVision/feature/feature.hpp"
 
 namespace aliceVision {
 namespace matching {
 
+/**
+ * Remove matches that share the same (xL,yL,xR,yR) positions, in place.
+ * Sort-based alternative to the IndMatchDecorator object: it sorts a
+ * permutation of the match indexes over the position keys and keeps the first
+ * occurrence of every key, without copying the positions into decorated
+ * structures. The kept matches stay in their original order. The scratch
+ * buffer can be hoisted by the caller and reused across pairs to avoid the
+ * per-pair allocation.
+ *
+ * \param[in] leftFeat     Features of the left image, indexed by _i.
+ * \param[in] rightFeat    Features of the right image, indexed by _j.
+ * \param[in,out] vec_matches The matches to deduplicate.
+ * \param[in,out] scratchOrder Reusable scratch buffer.
+ * \return True if duplicates have been removed.
+ */
+template<class FeatureT>
+inline bool removeDuplicateMatchPositions(
+  const std::vector<FeatureT> & leftFeat,
+  const std::vector<FeatureT> & rightFeat,
+  std::vector<IndMatch> & vec_matches,
+  std::vector<unsigned int> & scratchOrder)
+{
+  const size_t sizeBefore = vec_matches.size();
+  if (sizeBefore < 2)
+    return false;
+
+  scratchOrder.resize(sizeBefore);
+  for (unsigned int i = 0; i < sizeBefore; ++i)
+    scratchOrder[i] = i;
+
+  const auto positionsEqual = [&](unsigned int a, unsigned int b) -> bool
+  {
+    const IndMatch & ma = vec_matches[a];
+    const IndMatch & mb = vec_matches[b];
+    return leftFeat[ma._i].x() == leftFeat[mb._i].x() &&
+           leftFeat[ma._i].y() == leftFeat[mb._i].y() &&
+           rightFeat[ma._j].x() == rightFeat[mb._j].x() &&
+           rightFeat[ma._j].y() == rightFeat[mb._j].y();
+  };
+
+  // Lexicographical ordering over the position keys, ties broken by the
+  // original index so the first occurrence of a key sorts first.
+  std::sort(scratchOrder.begin(), scratchOrder.end(),
+    [&](unsigned int a, unsigned int b) -> bool
+    {
+      const IndMatch & ma = vec_matches[a];
+      const IndMatch & mb = vec_matches[b];
+      if (leftFeat[ma._i].x() != leftFeat[mb._i].x())
+        return leftFeat[ma._i].x() < leftFeat[mb._i].x();
+      if (leftFeat[ma._i].y() != leftFeat[mb._i].y())
+        return leftFeat[ma._i].y() < leftFeat[mb._i].y();
+      if (rightFeat[ma._j].x() != rightFeat[mb._j].x())
+        return rightFeat[ma._j].x() < rightFeat[mb._j].x();
+      if (rightFeat[ma._j].y() != rightFeat[mb._j].y())
+        return rightFeat[ma._j].y() < rightFeat[mb._j].y();
+      return a < b;
+    });
+
+  // Tombstone every element of a key run except the first one. Feature
+  // indexes are never UndefinedIndexT, so the marker cannot collide with a
+  // valid match.
+  unsigned int runHead = scratchOrder[0];
+  for (size_t k = 1; k < sizeBefore; ++k)
+  {
+    if (positionsEqual(scratchOrder[k], runHead))
+      vec_matches[scratchOrder[k]] = IndMatch(UndefinedIndexT, UndefinedIndexT);
+    else
+      runHead = scratchOrder[k];
+  }
+
+  vec_matches.erase(
+    std::remove_if(vec_matches.begin(), vec_matches.end(),
+      [](const IndMatch & m) { return m._i == UndefinedIndexT; }),
+    vec_matches.end());
+
+  return sizeBefore != vec_matches.size();
+}
+
+/// Same as above with a local scratch buffer, for one-shot callers.
+template<class FeatureT>
+inline bool removeDuplicateMatchPositions(
+  const std::vector<FeatureT> & leftFeat,
+  const std::vector<FeatureT> & rightFeat,
+  std::vector<IndMatch> & vec_matches)
+{
+  std::vector<unsigned int> scratchOrder;
+  return removeDuplicateMatchPositions(leftFeat, rightFeat, vec_matches, scratchOrder);
+}
+
 /// IndMatch decorator.
 /// Use sorting over x,y coordinates.
 template<class T = float>
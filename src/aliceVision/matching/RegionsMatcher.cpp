@@ -8,6 +8,12 @@
 #include "aliceVision/matching/ArrayMatcher_bruteForce.hpp"
 #include "aliceVision/matching/ArrayMatcher_kdtreeFlann.hpp"
 #include "aliceVision/matching/ArrayMatcher_cascadeHashing.hpp"
+#include "aliceVision/matching/ArrayMatcher_hnsw.hpp"
+#include <aliceVision/config.hpp>
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+#include "aliceVision/matching/ArrayMatcher_cudaBruteForce.hpp"
+#endif
 
 namespace aliceVision {
 namespace matching {
@@ -23,10 +29,45 @@ void DistanceRatioMatch(
   matcher.Match(f_dist_ratio, regions_J, matches);
 }
 
+void DistanceRatioMatchSymmetric(
+  float f_dist_ratio,
+  matching::EMatcherType eMatcherType,
+  const feature::Regions & regions_I, // database
+  const feature::Regions & regions_J, // query
+  matching::IndMatches & matches)
+{
+  RegionsDatabaseMatcher matcher(eMatcherType, regions_I);
+  matcher.MatchSymmetric(f_dist_ratio, regions_J, nullptr, matches);
+}
+
 bool RegionsDatabaseMatcher::Match(
   float distRatio,
   const feature::Regions & queryRegions,
   matching::IndMatches & matches) const
+{
+  return Match(distRatio, queryRegions, nullptr, matches);
+}
+
+bool RegionsDatabaseMatcher::Match(
+  float distRatio,
+  const feature::Regions & queryRegions,
+  const feature::PointFeatures * queryPositions,
+  matching::IndMatches & matches) const
+{
+  if (queryRegions.RegionCount() == 0)
+    return false;
+
+  if (!_regionsMatcher)
+    return false;
+
+  return _regionsMatcher->Match(distRatio, queryRegions, queryPositions, matches);
+}
+
+bool RegionsDatabaseMatcher::MatchSymmetric(
+  float distRatio,
+  const feature::Regions & queryRegions,
+  const feature::PointFeatures * queryPositions,
+  matching::IndMatches & matches) const
 {
   if (queryRegions.RegionCount() == 0)
     return false;
@@ -34,7 +75,7 @@ bool RegionsDatabaseMatcher::Match(
   if (!_regionsMatcher)
     return false;
 
-  return _regionsMatcher->Match(distRatio, queryRegions, matches);
+  return _regionsMatcher->MatchSymmetric(distRatio, queryRegions, queryPositions, matches);
 }
 
 RegionsDatabaseMatcher::RegionsDatabaseMatcher():
@@ -62,6 +103,14 @@ std::unique_ptr<IRegionsMatcher> createRegionsMatcher(const feature::Regions & r
   if (regions.IsBinary() && matcherType != BRUTE_FORCE_HAMMING)
     return out;
 
+#if !ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+  if (matcherType == BRUTE_FORCE_CUDA_L2)
+  {
+    ALICEVISION_LOG_WARNING("BRUTE_FORCE_CUDA_L2 is not available: AliceVision is built without CUDA support.");
+    return out;
+  }
+#endif
+
   // Switch regions type ID, matcher & Metric: initialize the Matcher interface
   if (regions.IsScalar())
   {
@@ -90,6 +139,21 @@ std::unique_ptr<IRegionsMatcher> createRegionsMatcher(const feature::Regions & r
           out.reset(new matching::RegionsMatcher<MatcherT>(regions, true));
         }
         break;
+        case HNSW_L2:
+        {
+          typedef ArrayMatcher_hnsw<unsigned char> MatcherT;
+          out.reset(new matching::RegionsMatcher<MatcherT>(regions, true));
+        }
+        break;
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+        case BRUTE_FORCE_CUDA_L2:
+        {
+          typedef L2_Vectorized<unsigned char> MetricT;
+          typedef ArrayMatcher_cudaBruteForce<unsigned char, MetricT> MatcherT;
+          out.reset(new matching::RegionsMatcher<MatcherT>(regions, true));
+        }
+        break;
+#endif
         default:
           ALICEVISION_LOG_WARNING("Using unknown matcher type");
       }
@@ -119,10 +183,50 @@ std::unique_ptr<IRegionsMatcher> createRegionsMatcher(const feature::Regions & r
           out.reset(new matching::RegionsMatcher<MatcherT>(regions, true));
         }
         break;
+        case HNSW_L2:
+        {
+          typedef ArrayMatcher_hnsw<float> MatcherT;
+          out.reset(new matching::RegionsMatcher<MatcherT>(regions, true));
+        }
+        break;
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+        case BRUTE_FORCE_CUDA_L2:
+        {
+          typedef L2_Vectorized<float> MetricT;
+          typedef ArrayMatcher_cudaBruteForce<float, MetricT> MatcherT;
+          out.reset(new matching::RegionsMatcher<MatcherT>(regions, true));
+        }
+        break;
+#endif
         default:
           ALICEVISION_LOG_WARNING("Using unknown matcher type");
       }
     }
+    else if (regions.Type_id() == typeid(Eigen::half).name())
+    {
+      // Build on the fly half precision based Matcher, the distance kernels
+      // widen the descriptors back to single precision in registers
+      switch (matcherType)
+      {
+        case BRUTE_FORCE_L2:
+        {
+          typedef L2_Vectorized<Eigen::half> MetricT;
+          typedef ArrayMatcher_bruteForce<Eigen::half, MetricT> MatcherT;
+          out.reset(new matching::RegionsMatcher<MatcherT>(regions, true));
+        }
+        break;
+        case CASCADE_HASHING_L2:
+        {
+          typedef L2_Vectorized<Eigen::half> MetricT;
+          typedef ArrayMatcher_cascadeHashing<Eigen::half, MetricT> MatcherT;
+          out.reset(new matching::RegionsMatcher<MatcherT>(regions, true));
+        }
+        break;
+        default:
+          ALICEVISION_LOG_WARNING("Half precision descriptors are only supported by the "
+            "BRUTE_FORCE_L2 and CASCADE_HASHING_L2 matchers");
+      }
+    }
     else if (regions.Type_id() == typeid(double).name())
     {
       // Build on the fly double based Matcher
@@ -146,6 +250,18 @@ std::unique_ptr<IRegionsMatcher> createRegionsMatcher(const feature::Regions & r
           ALICEVISION_LOG_WARNING("Not yet implemented");
         }
         break;
+        case HNSW_L2:
+        {
+          typedef ArrayMatcher_hnsw<double> MatcherT;
+          out.reset(new matching::RegionsMatcher<MatcherT>(regions, true));
+        }
+        break;
+        case BRUTE_FORCE_CUDA_L2:
+        {
+          // the CUDA kernel matches in single precision
+          ALICEVISION_LOG_WARNING("Not yet implemented");
+        }
+        break;
         default:
           ALICEVISION_LOG_WARNING("Using unknown matcher type");
       }
@@ -13,6 +13,7 @@
 #include "aliceVision/numeric/numeric.hpp"
 #include "aliceVision/feature/Regions.hpp"
 #include "aliceVision/feature/RegionsPerView.hpp"
+#include "aliceVision/feature/FeaturesPerView.hpp"
 
 #include <vector>
 
@@ -39,6 +40,27 @@ void DistanceRatioMatch
   matching::IndMatches & matches // corresponding points
 );
 
+/**
+ * @brief Same as DistanceRatioMatch(), additionally cross-checking the
+ * candidates so each feature of regions_I is matched at most once. The
+ * cross-check reuses the distances of the forward search: the matches are
+ * one-to-one without a reverse matching pass.
+ *
+ * @param[in] dist_ratio The threshold for the ratio test.
+ * @param[in] eMatcherType The type of matcher to use.
+ * @param[in] regions_I The first Region to match
+ * @param[in] regions_J The second Region to match
+ * @param[out] matches It contains the indices of the matching features
+ */
+void DistanceRatioMatchSymmetric
+(
+  float dist_ratio,   // Distance ratio
+  matching::EMatcherType eMatcherType, // Matcher
+  const feature::Regions & regions_I, // database
+  const feature::Regions & regions_J, // query
+  matching::IndMatches & matches // corresponding points
+);
+
 
 /**
  * @brief Interface for a matcher of Regions that keep on of the Regions stored
@@ -77,6 +99,53 @@ public:
     matching::IndMatches & vec_putative_matches
   ) = 0;
 
+  /**
+   * @brief Same as Match(), with the positions of the query features provided
+   * by the caller. Pass the positions cached alongside the query Regions to
+   * avoid the copy that GetRegionsPositions() performs on every call; the
+   * default implementation ignores them and performs the copy.
+   *
+   * @param[in] f_dist_ratio The threshold for the ratio test.
+   * @param[in] query_regions The Regions to match.
+   * @param[in] query_positions The positions of the query features, or null.
+   * @param[out] vec_putative_matches It contains the indices of the matching features
+   * of the database and the query Regions.
+   * @return True if everything went well.
+   */
+  virtual bool Match(
+    const float f_dist_ratio,
+    const feature::Regions& query_regions,
+    const feature::PointFeatures* query_positions,
+    matching::IndMatches & vec_putative_matches
+  )
+  {
+    return Match(f_dist_ratio, query_regions, vec_putative_matches);
+  }
+
+  /**
+   * @brief Same as Match(), additionally cross-checking the ratio-test
+   * survivors: each database feature keeps at most its best query candidate,
+   * so the emitted matches are one-to-one. The check reuses the distances of
+   * the forward search, no reverse matching pass is performed. The default
+   * implementation falls back to the one-way Match().
+   *
+   * @param[in] f_dist_ratio The threshold for the ratio test.
+   * @param[in] query_regions The Regions to match.
+   * @param[in] query_positions The positions of the query features, or null.
+   * @param[out] vec_putative_matches It contains the indices of the matching features
+   * of the database and the query Regions.
+   * @return True if everything went well.
+   */
+  virtual bool MatchSymmetric(
+    const float f_dist_ratio,
+    const feature::Regions& query_regions,
+    const feature::PointFeatures* query_positions,
+    matching::IndMatches & vec_putative_matches
+  )
+  {
+    return Match(f_dist_ratio, query_regions, query_positions, vec_putative_matches);
+  }
+
   const feature::Regions& getDatabaseRegions() const { return regions_; }
 };
 
@@ -92,6 +161,7 @@ class RegionsMatcher : public IRegionsMatcher
 private:
   ArrayMatcherT matcher_;
   bool b_squared_metric_; // Store if the metric is squared or not
+  feature::PointFeatures database_positions_; // Positions of the database features, copied once at build time
 public:
   typedef typename ArrayMatcherT::ScalarT Scalar;
   typedef typename ArrayMatcherT::DistanceType DistanceType;
@@ -116,6 +186,7 @@ public:
 
     const Scalar * tab = reinterpret_cast<const Scalar *>(regions_.DescriptorRawData());
     matcher_.Build(tab, regions_.RegionCount(), regions_.DescriptorLength());
+    database_positions_ = regions_.GetRegionsPositions();
   }
 
   /**
@@ -132,7 +203,88 @@ public:
              const feature::Regions& queryregions_,
              matching::IndMatches & vec_putative_matches)
   {
+    return Match(f_dist_ratio, queryregions_, nullptr, vec_putative_matches);
+  }
+
+  /**
+   * @brief Same as Match(), reading the query feature positions from the given
+   * cache instead of copying them out of the Regions.
+   *
+   * @param[in] f_dist_ratio The threshold for the ratio test.
+   * @param[in] queryregions_ The Regions to match.
+   * @param[in] query_positions The positions of the query features, or null to
+   * copy them from the Regions.
+   * @param[out] vec_putative_matches It contains the indices of the matching features
+     * of the database and the query Regions.
+   * @return True if everything went well.
+   */
+  bool Match(const float f_dist_ratio,
+             const feature::Regions& queryregions_,
+             const feature::PointFeatures* query_positions,
+             matching::IndMatches & vec_putative_matches)
+  {
+    std::vector<DistanceType> candidateDistances;
+    if (!ratioTestCandidates(f_dist_ratio, queryregions_, vec_putative_matches, candidateDistances))
+      return false;
+
+    // Remove duplicates
+    matching::IndMatch::getDeduplicated(vec_putative_matches);
+
+    removeSamePositionMatches(queryregions_, query_positions, vec_putative_matches);
+
+    return (!vec_putative_matches.empty());
+  }
+
+  /**
+   * @brief Same as Match(), additionally keeping only the best query candidate
+   * of each database feature (see MutualBestMatches). The 2 nearest neighbours
+   * of the forward search provide both the ratio test and the cross-check, so
+   * the distance structure is only scanned once.
+   *
+   * @param[in] f_dist_ratio The threshold for the ratio test.
+   * @param[in] queryregions_ The Regions to match.
+   * @param[in] query_positions The positions of the query features, or null to
+   * copy them from the Regions.
+   * @param[out] vec_putative_matches It contains the indices of the matching features
+     * of the database and the query Regions, one-to-one.
+   * @return True if everything went well.
+   */
+  bool MatchSymmetric(const float f_dist_ratio,
+                      const feature::Regions& queryregions_,
+                      const feature::PointFeatures* query_positions,
+                      matching::IndMatches & vec_putative_matches)
+  {
+    matching::IndMatches candidates;
+    std::vector<DistanceType> candidateDistances;
+    if (!ratioTestCandidates(f_dist_ratio, queryregions_, candidates, candidateDistances))
+      return false;
 
+    // Cross-check the candidates: at most one match per database feature.
+    // The search emits at most one candidate per query, so the result is
+    // one-to-one and no index deduplication pass is needed.
+    std::vector<int> vec_mutual_idx;
+    matching::MutualBestMatches(candidates, candidateDistances, vec_mutual_idx);
+
+    vec_putative_matches.reserve(vec_mutual_idx.size());
+    for (size_t k = 0; k < vec_mutual_idx.size(); ++k)
+      vec_putative_matches.push_back(candidates[vec_mutual_idx[k]]);
+
+    removeSamePositionMatches(queryregions_, query_positions, vec_putative_matches);
+
+    return (!vec_putative_matches.empty());
+  }
+
+private:
+  /**
+   * @brief Search the 2 nearest neighbours of each query descriptor and apply
+   * the distance ratio test, emitting the surviving (database, query) matches
+   * and the distance of each of them.
+   */
+  bool ratioTestCandidates(const float f_dist_ratio,
+                           const feature::Regions& queryregions_,
+                           matching::IndMatches & candidates,
+                           std::vector<DistanceType> & candidateDistances)
+  {
     const Scalar * queries = reinterpret_cast<const Scalar *>(queryregions_.DescriptorRawData());
 
     const size_t NNN__ = 2;
@@ -155,28 +307,36 @@ public:
       vec_nn_ratio_idx, // output (indices that respect the distance Ratio)
       b_squared_metric_ ? Square(f_dist_ratio) : f_dist_ratio);
 
-    vec_putative_matches.reserve(vec_nn_ratio_idx.size());
+    candidates.reserve(vec_nn_ratio_idx.size());
+    candidateDistances.reserve(vec_nn_ratio_idx.size());
     for (size_t k=0; k < vec_nn_ratio_idx.size(); ++k)
     {
       const size_t index = vec_nn_ratio_idx[k];
-      vec_putative_matches.emplace_back(vec_nIndice[index*NNN__]._j, vec_nIndice[index*NNN__]._i
+      candidates.emplace_back(vec_nIndice[index*NNN__]._j, vec_nIndice[index*NNN__]._i
   #ifdef ALICEVISION_DEBUG_MATCHING
-          , (float) vec_fDistance[vec_nn_ratio_idx[0]]
+          , (float) vec_fDistance[index*NNN__]
   #endif
       );
+      candidateDistances.push_back(vec_fDistance[index*NNN__]);
     }
-
-    // Remove duplicates
-    matching::IndMatch::getDeduplicated(vec_putative_matches);
-
-    // Remove matches that have the same (X,Y) coordinates
-    matching::IndMatchDecorator<float> matchDeduplicator(vec_putative_matches,
-      regions_.GetRegionsPositions(), queryregions_.GetRegionsPositions());
-    matchDeduplicator.getDeduplicated(vec_putative_matches);
-
-    return (!vec_putative_matches.empty());
+    return true;
   }
 
+  /// Remove matches that have the same (X,Y) coordinates
+  void removeSamePositionMatches(const feature::Regions& queryregions_,
+                                 const feature::PointFeatures* query_positions,
+                                 matching::IndMatches & vec_putative_matches)
+  {
+    if (query_positions != nullptr)
+    {
+      matching::removeDuplicateMatchPositions(database_positions_, *query_positions, vec_putative_matches);
+    }
+    else
+    {
+      const feature::PointFeatures localQueryPositions = queryregions_.GetRegionsPositions();
+      matching::removeDuplicateMatchPositions(database_positions_, localQueryPositions, vec_putative_matches);
+    }
+  }
 };
 
 
@@ -218,6 +378,45 @@ class RegionsDatabaseMatcher
       const feature::Regions & queryRegions,
       matching::IndMatches & matches) const;
 
+    /**
+     * @brief Find corresponding points between the query Regions and the database one,
+     * reading the query feature positions from the given cache instead of copying them
+     * out of the Regions.
+     *
+     * @param[in] distRatio The threshold for the ratio test used to discard spurious correspondence.
+     * @param[in] queryRegions The Regions to match.
+     * @param[in] queryPositions The positions of the query features, or null to copy
+     *                           them from the Regions.
+     * @param[out] matches It contains the indices of the matching features (photometric corresponding points)
+     *                     of the database and the query Regions.
+     * @return True if everything went well.
+     */
+    bool Match(
+      float distRatio,
+      const feature::Regions & queryRegions,
+      const feature::PointFeatures * queryPositions,
+      matching::IndMatches & matches) const;
+
+    /**
+     * @brief Same as Match(), additionally cross-checking the candidates so
+     * each database feature is matched at most once (one-to-one matches).
+     * The cross-check reuses the distances of the forward search, no reverse
+     * matching pass is performed.
+     *
+     * @param[in] distRatio The threshold for the ratio test used to discard spurious correspondence.
+     * @param[in] queryRegions The Regions to match.
+     * @param[in] queryPositions The positions of the query features, or null to copy
+     *                           them from the Regions.
+     * @param[out] matches It contains the indices of the matching features (photometric corresponding points)
+     *                     of the database and the query Regions.
+     * @return True if everything went well.
+     */
+    bool MatchSymmetric(
+      float distRatio,
+      const feature::Regions & queryRegions,
+      const feature::PointFeatures * queryPositions,
+      matching::IndMatches & matches) const;
+
     const feature::Regions& getDatabaseRegions() const { return _regionsMatcher->getDatabaseRegions(); }
 
   private:
@@ -245,14 +444,31 @@ public:
     float distRatio,
     const feature::MapRegionsPerDesc & matchedRegions,
     matching::MatchesPerDescType & out_putativeFeatureMatches)
+  {
+    return Match(distRatio, matchedRegions, nullptr, out_putativeFeatureMatches);
+  }
+
+  /**
+   * @brief Same as Match(), reading the positions of the matched features from the
+   * given per-describer cache instead of copying them out of the Regions.
+   */
+  bool Match(
+    float distRatio,
+    const feature::MapRegionsPerDesc & matchedRegions,
+    const feature::MapFeaturesPerDesc * matchedPositions,
+    matching::MatchesPerDescType & out_putativeFeatureMatches)
   {
     bool res = false;
     for(auto& matcherIt: _mapMatchers)
     {
       const feature::EImageDescriberType descType = matcherIt.first;
+      const feature::PointFeatures * positions = nullptr;
+      if(matchedPositions != nullptr && matchedPositions->count(descType) != 0)
+        positions = &matchedPositions->at(descType);
       res |= matcherIt.second.Match(
             distRatio,
             *matchedRegions.at(descType),
+            positions,
             out_putativeFeatureMatches[descType]);
     }
     return res;
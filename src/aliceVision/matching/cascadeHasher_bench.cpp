@@ -0,0 +1,76 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "aliceVision/matching/CascadeHasher.hpp"
+#include "aliceVision/matching/metric.hpp"
+#include "aliceVision/matching/IndMatch.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+using namespace aliceVision;
+using namespace aliceVision::matching;
+
+// SIFT-like descriptor layout: 128 dimensions, values in [0;255]
+typedef Eigen::Matrix<unsigned char, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> DescriptorsT;
+
+static DescriptorsT randomDescriptors(int nbDescriptors, unsigned int seed)
+{
+  std::mt19937 gen(seed); // fixed seed for run to run stability
+  std::uniform_int_distribution<int> d(0, 255);
+  DescriptorsT descriptors(nbDescriptors, 128);
+  for(int i = 0; i < descriptors.rows(); ++i)
+    for(int j = 0; j < descriptors.cols(); ++j)
+      descriptors(i, j) = static_cast<unsigned char>(d(gen));
+  return descriptors;
+}
+
+static void BM_CascadeHasher_Hash(benchmark::State& state)
+{
+  const DescriptorsT descriptors = randomDescriptors(static_cast<int>(state.range(0)), 42);
+
+  CascadeHasher hasher;
+  hasher.Init();
+  const Eigen::VectorXf zeroMeanDescriptor = CascadeHasher::GetZeroMeanDescriptor(descriptors);
+
+  for(auto _ : state)
+  {
+    HashedDescriptions hashedDescriptions = hasher.CreateHashedDescriptions(descriptors, zeroMeanDescriptor);
+    benchmark::DoNotOptimize(hashedDescriptions);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CascadeHasher_Hash)->Arg(1000)->Arg(10000);
+
+static void BM_CascadeHasher_Match(benchmark::State& state)
+{
+  const DescriptorsT descriptors1 = randomDescriptors(static_cast<int>(state.range(0)), 42);
+  const DescriptorsT descriptors2 = randomDescriptors(static_cast<int>(state.range(0)), 43);
+
+  CascadeHasher hasher;
+  hasher.Init();
+  const Eigen::VectorXf zeroMeanDescriptor = CascadeHasher::GetZeroMeanDescriptor(descriptors1);
+  const HashedDescriptions hashedDescriptions1 = hasher.CreateHashedDescriptions(descriptors1, zeroMeanDescriptor);
+  const HashedDescriptions hashedDescriptions2 = hasher.CreateHashedDescriptions(descriptors2, zeroMeanDescriptor);
+
+  typedef L2_Vectorized<unsigned char>::ResultType DistanceT;
+
+  for(auto _ : state)
+  {
+    IndMatches indices;
+    std::vector<DistanceT> distances;
+    hasher.Match_HashedDescriptions(
+      hashedDescriptions1, descriptors1,
+      hashedDescriptions2, descriptors2,
+      &indices, &distances);
+    benchmark::DoNotOptimize(indices);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CascadeHasher_Match)->Arg(1000)->Arg(10000);
+
+BENCHMARK_MAIN();
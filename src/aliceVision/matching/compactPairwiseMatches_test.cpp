@@ -0,0 +1,87 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "aliceVision/matching/CompactPairwiseMatches.hpp"
+
+#define BOOST_TEST_MODULE CompactPairwiseMatches
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::matching;
+
+// Matches of two pairs, the first one with two describer types.
+static PairwiseMatches makeMatches()
+{
+  PairwiseMatches matches;
+  IndMatches& sift01 = matches[Pair(0, 1)][feature::EImageDescriberType::SIFT];
+  sift01.emplace_back(0, 3);
+  sift01.emplace_back(1, 4);
+  sift01.emplace_back(2, 5);
+  IndMatches& akaze01 = matches[Pair(0, 1)][feature::EImageDescriberType::AKAZE];
+  akaze01.emplace_back(7, 8);
+  IndMatches& sift12 = matches[Pair(1, 2)][feature::EImageDescriberType::SIFT];
+  sift12.emplace_back(3, 6);
+  sift12.emplace_back(4, 7);
+  return matches;
+}
+
+BOOST_AUTO_TEST_CASE(compactPairwiseMatches_RoundTrip)
+{
+  const PairwiseMatches matches = makeMatches();
+
+  const CompactPairwiseMatches compact(matches);
+  BOOST_CHECK_EQUAL(compact.getNbAllMatches(), 6);
+  BOOST_CHECK_EQUAL(compact.getRanges().size(), 3);
+  BOOST_CHECK_EQUAL(compact.getLeftFeatures().size(), compact.getRightFeatures().size());
+
+  PairwiseMatches rebuilt;
+  compact.toPairwiseMatches(rebuilt);
+
+  BOOST_CHECK_EQUAL(rebuilt.size(), matches.size());
+  for(const auto& matchesPerDescIt: matches)
+  {
+    const MatchesPerDescType& rebuiltPerDesc = rebuilt.at(matchesPerDescIt.first);
+    for(const auto& matchesIt: matchesPerDescIt.second)
+    {
+      const IndMatches& rebuiltMatches = rebuiltPerDesc.at(matchesIt.first);
+      BOOST_CHECK(rebuiltMatches == matchesIt.second);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(compactPairwiseMatches_RangesFollowMapOrder)
+{
+  const CompactPairwiseMatches compact(makeMatches());
+  const std::vector<CompactPairwiseMatches::MatchRange>& ranges = compact.getRanges();
+
+  // ranges ordered by (image pair, describer type), contiguous in the arrays
+  BOOST_CHECK(ranges[0].imagePair == Pair(0, 1));
+  BOOST_CHECK(ranges[1].imagePair == Pair(0, 1));
+  BOOST_CHECK(ranges[2].imagePair == Pair(1, 2));
+  BOOST_CHECK(ranges[0].descType < ranges[1].descType);
+
+  std::size_t expectedBegin = 0;
+  for(const CompactPairwiseMatches::MatchRange& range: ranges)
+  {
+    BOOST_CHECK_EQUAL(range.begin, expectedBegin);
+    expectedBegin += range.size;
+  }
+  BOOST_CHECK_EQUAL(expectedBegin, compact.getNbAllMatches());
+
+  // spot-check one run content
+  BOOST_CHECK_EQUAL(compact.getLeftFeatures()[ranges[2].begin], 3);
+  BOOST_CHECK_EQUAL(compact.getRightFeatures()[ranges[2].begin + 1], 7);
+}
+
+BOOST_AUTO_TEST_CASE(compactPairwiseMatches_Empty)
+{
+  CompactPairwiseMatches compact;
+  BOOST_CHECK(compact.empty());
+  BOOST_CHECK_EQUAL(compact.getNbAllMatches(), 0);
+
+  PairwiseMatches rebuilt;
+  compact.toPairwiseMatches(rebuilt);
+  BOOST_CHECK(rebuilt.empty());
+}
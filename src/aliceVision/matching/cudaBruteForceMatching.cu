@@ -0,0 +1,195 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "cudaBruteForceMatching.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+
+#include <cuda_runtime.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cstddef>
+
+namespace aliceVision {
+namespace matching {
+
+namespace {
+
+/// Number of query descriptors handled per block (one thread per query).
+const int kQueriesPerBlock = 64;
+
+/// Shared memory budget used to stage database descriptors, in bytes.
+/// Kept below the 48KB limit of every supported device.
+const int kSharedBytes = 32 * 1024;
+
+bool checkCuda(cudaError_t error, const char* context)
+{
+  if(error == cudaSuccess)
+    return true;
+  ALICEVISION_LOG_ERROR("CUDA error in " << context << ": " << cudaGetErrorString(error));
+  return false;
+}
+
+/**
+ * One thread per query descriptor: the block cooperatively stages a tile of
+ * database descriptors in shared memory, then each thread scans the tile and
+ * keeps the two smallest squared L2 distances seen so far. Only the two
+ * (index, distance) pairs per query are written back to global memory.
+ */
+__global__ void twoNearestNeighboursKernel(const float* dataset, int nbRows, int dimension,
+                                           const float* queries, int nbQuery, int rowsPerTile,
+                                           int* indices, float* distances)
+{
+  extern __shared__ float sharedRows[];
+
+  const int queryIndex = blockIdx.x * blockDim.x + threadIdx.x;
+  const float* query = queries + queryIndex * dimension;
+
+  float bestDist = FLT_MAX;
+  float secondDist = FLT_MAX;
+  int bestIndex = -1;
+  int secondIndex = -1;
+
+  for(int tileStart = 0; tileStart < nbRows; tileStart += rowsPerTile)
+  {
+    const int rowsInTile = min(rowsPerTile, nbRows - tileStart);
+    const int valuesInTile = rowsInTile * dimension;
+
+    for(int v = threadIdx.x; v < valuesInTile; v += blockDim.x)
+      sharedRows[v] = dataset[tileStart * dimension + v];
+    __syncthreads();
+
+    if(queryIndex < nbQuery)
+    {
+      for(int r = 0; r < rowsInTile; ++r)
+      {
+        const float* row = sharedRows + r * dimension;
+        float dist = 0.0f;
+        for(int d = 0; d < dimension; ++d)
+        {
+          const float diff = query[d] - row[d];
+          dist += diff * diff;
+        }
+
+        if(dist < bestDist)
+        {
+          secondDist = bestDist;
+          secondIndex = bestIndex;
+          bestDist = dist;
+          bestIndex = tileStart + r;
+        }
+        else if(dist < secondDist)
+        {
+          secondDist = dist;
+          secondIndex = tileStart + r;
+        }
+      }
+    }
+    __syncthreads();
+  }
+
+  if(queryIndex < nbQuery)
+  {
+    indices[2 * queryIndex] = bestIndex;
+    indices[2 * queryIndex + 1] = secondIndex;
+    distances[2 * queryIndex] = bestDist;
+    distances[2 * queryIndex + 1] = secondDist;
+  }
+}
+
+} // namespace
+
+CudaBruteForceMatcher::CudaBruteForceMatcher()
+{}
+
+CudaBruteForceMatcher::~CudaBruteForceMatcher()
+{
+  release();
+}
+
+bool CudaBruteForceMatcher::isAvailable()
+{
+  int deviceCount = 0;
+  if(cudaGetDeviceCount(&deviceCount) != cudaSuccess)
+    return false;
+  return deviceCount > 0;
+}
+
+void CudaBruteForceMatcher::release()
+{
+  if(_deviceDataset != nullptr)
+  {
+    cudaFree(_deviceDataset);
+    _deviceDataset = nullptr;
+  }
+  _nbRows = 0;
+  _dimension = 0;
+}
+
+bool CudaBruteForceMatcher::setDatabase(const float* dataset, int nbRows, int dimension)
+{
+  release();
+
+  if(nbRows < 1 || dimension < 1)
+    return false;
+
+  const std::size_t bytes = std::size_t(nbRows) * dimension * sizeof(float);
+
+  if(!checkCuda(cudaMalloc(&_deviceDataset, bytes), "CudaBruteForceMatcher::setDatabase"))
+    return false;
+
+  if(!checkCuda(cudaMemcpy(_deviceDataset, dataset, bytes, cudaMemcpyHostToDevice), "CudaBruteForceMatcher::setDatabase"))
+  {
+    release();
+    return false;
+  }
+
+  _nbRows = nbRows;
+  _dimension = dimension;
+  return true;
+}
+
+bool CudaBruteForceMatcher::searchTwoNearestNeighbours(const float* queries, int nbQuery, int* indices, float* distances) const
+{
+  if(_deviceDataset == nullptr || nbQuery < 1)
+    return false;
+
+  const std::size_t queryBytes = std::size_t(nbQuery) * _dimension * sizeof(float);
+  const std::size_t indexBytes = std::size_t(nbQuery) * 2 * sizeof(int);
+  const std::size_t distanceBytes = std::size_t(nbQuery) * 2 * sizeof(float);
+
+  float* deviceQueries = nullptr;
+  int* deviceIndices = nullptr;
+  float* deviceDistances = nullptr;
+
+  bool ok = checkCuda(cudaMalloc(&deviceQueries, queryBytes), "CudaBruteForceMatcher::searchTwoNearestNeighbours") &&
+            checkCuda(cudaMalloc(&deviceIndices, indexBytes), "CudaBruteForceMatcher::searchTwoNearestNeighbours") &&
+            checkCuda(cudaMalloc(&deviceDistances, distanceBytes), "CudaBruteForceMatcher::searchTwoNearestNeighbours") &&
+            checkCuda(cudaMemcpy(deviceQueries, queries, queryBytes, cudaMemcpyHostToDevice), "CudaBruteForceMatcher::searchTwoNearestNeighbours");
+
+  if(ok)
+  {
+    // stage as many database descriptors per tile as fit in the shared memory budget
+    const int rowsPerTile = std::max(1, kSharedBytes / (_dimension * int(sizeof(float))));
+    const int sharedBytes = rowsPerTile * _dimension * sizeof(float);
+    const int blockCount = (nbQuery + kQueriesPerBlock - 1) / kQueriesPerBlock;
+
+    twoNearestNeighboursKernel<<<blockCount, kQueriesPerBlock, sharedBytes>>>(
+      _deviceDataset, _nbRows, _dimension, deviceQueries, nbQuery, rowsPerTile, deviceIndices, deviceDistances);
+
+    ok = checkCuda(cudaGetLastError(), "twoNearestNeighboursKernel") &&
+         checkCuda(cudaMemcpy(indices, deviceIndices, indexBytes, cudaMemcpyDeviceToHost), "CudaBruteForceMatcher::searchTwoNearestNeighbours") &&
+         checkCuda(cudaMemcpy(distances, deviceDistances, distanceBytes, cudaMemcpyDeviceToHost), "CudaBruteForceMatcher::searchTwoNearestNeighbours");
+  }
+
+  cudaFree(deviceQueries);
+  cudaFree(deviceIndices);
+  cudaFree(deviceDistances);
+  return ok;
+}
+
+} // namespace matching
+} // namespace aliceVision
@@ -0,0 +1,78 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+namespace aliceVision {
+namespace matching {
+
+/**
+ * @brief CUDA backend of the brute force L2 descriptor matcher.
+ *
+ * The database descriptors are uploaded once and stay resident on the device
+ * for the lifetime of the matcher, so matching one image against many query
+ * images only streams the query descriptors up and the two best
+ * (index, squared distance) pairs per query descriptor back. The distance
+ * matrix is computed tile by tile in shared memory and is never materialized.
+ *
+ * Descriptors are always matched as float on the device: the templated
+ * ArrayMatcher_cudaBruteForce front-end converts other scalar types on upload.
+ * The implementation lives in cudaBruteForceMatching.cu and is only built when
+ * ALICEVISION_HAVE_CUDA is set.
+ */
+class CudaBruteForceMatcher
+{
+public:
+  CudaBruteForceMatcher();
+  ~CudaBruteForceMatcher();
+
+  CudaBruteForceMatcher(const CudaBruteForceMatcher&) = delete;
+  CudaBruteForceMatcher& operator=(const CudaBruteForceMatcher&) = delete;
+
+  /**
+   * @brief Check whether a usable CUDA device is present.
+   * @return true if at least one CUDA device is available
+   */
+  static bool isAvailable();
+
+  /**
+   * @brief Upload the database descriptors to the device.
+   * Any previously uploaded database is released first.
+   * @param[in] dataset Row-major nbRows x dimension float array
+   * @param[in] nbRows Number of database descriptors
+   * @param[in] dimension Descriptor dimension
+   * @return true if the upload succeeded
+   */
+  bool setDatabase(const float* dataset, int nbRows, int dimension);
+
+  /// @return number of database descriptors resident on the device
+  int databaseSize() const { return _nbRows; }
+
+  /// @return dimension of the database descriptors, 0 if no database is set
+  int dimension() const { return _dimension; }
+
+  /**
+   * @brief Search the two nearest database descriptors of each query descriptor.
+   * @param[in] queries Row-major nbQuery x dimension float array
+   * @param[in] nbQuery Number of query descriptors
+   * @param[out] indices 2 * nbQuery array receiving per query the best and
+   * second best database index
+   * @param[out] distances 2 * nbQuery array receiving the corresponding
+   * squared L2 distances
+   * @return true on success, false if no database is set or a CUDA call failed
+   */
+  bool searchTwoNearestNeighbours(const float* queries, int nbQuery, int* indices, float* distances) const;
+
+private:
+  /// Release the device database, if any.
+  void release();
+
+  float* _deviceDataset = nullptr;
+  int _nbRows = 0;
+  int _dimension = 0;
+};
+
+} // namespace matching
+} // namespace aliceVision
@@ -9,6 +9,7 @@
 #include <algorithm>
 #include <cassert>
 #include <iterator>
+#include <map>
 #include <set>
 #include <vector>
 
@@ -87,6 +88,49 @@ inline void SymmetricMatches(const vector<int> & vec_matches,
   }
 }
 
+/**
+  * Fused cross-check filtering :
+  * Given candidate matches (database index in _i) and the distance of each
+  * candidate, keep for every database feature only the candidate with the
+  * smallest distance. A nearest neighbour search already emits at most one
+  * candidate per query, so the surviving matches are one-to-one: this is the
+  * cross-check restricted to the candidate set, computed from the distances
+  * of the forward search without any reverse matching pass.
+  *
+  * \param[in]  vec_matches    Candidate matches, the database index is _i.
+  * \param[in]  vec_distances  Distance of each candidate match.
+  * \param[out] vec_goodIndex  Indexes of the candidates to keep, sorted.
+  *
+  * \return void.
+  */
+template <typename DistanceType>
+inline void MutualBestMatches(const std::vector<IndMatch> & vec_matches,
+  const std::vector<DistanceType> & vec_distances,
+  std::vector<int> & vec_goodIndex)
+{
+  assert(vec_matches.size() == vec_distances.size());
+
+  // index of the best candidate seen so far, per database feature
+  std::map<IndexT, int> bestPerDatabase;
+  for (int i = 0; i < static_cast<int>(vec_matches.size()); ++i)
+  {
+    std::map<IndexT, int>::iterator it = bestPerDatabase.find(vec_matches[i]._i);
+    if (it == bestPerDatabase.end())
+      bestPerDatabase.insert(std::make_pair(vec_matches[i]._i, i));
+    else if (vec_distances[i] < vec_distances[it->second])
+      it->second = i;
+  }
+
+  vec_goodIndex.clear();
+  vec_goodIndex.reserve(bestPerDatabase.size());
+  for (std::map<IndexT, int>::const_iterator it = bestPerDatabase.begin();
+    it != bestPerDatabase.end(); ++it)
+  {
+    vec_goodIndex.push_back(it->second);
+  }
+  std::sort(vec_goodIndex.begin(), vec_goodIndex.end());
+}
+
 /**
   * Intersect two container via Iterator.
   * Keep element that exist in the two sequence of data.
@@ -34,3 +34,29 @@ BOOST_AUTO_TEST_CASE(matching_setIntersection)
   BOOST_CHECK_EQUAL(6, vec_intersect[4]);
   BOOST_CHECK_EQUAL(7, vec_intersect[5]);
 }
+
+/// Fused cross-check: keep the best candidate per database feature
+BOOST_AUTO_TEST_CASE(matching_mutualBestMatches)
+{
+  // candidates (database, query): database 0 is claimed by queries 0 and 2,
+  // database 1 by query 1 only, database 2 by queries 3 and 4.
+  vector<IndMatch> vec_matches;
+  vec_matches.emplace_back(0, 0);
+  vec_matches.emplace_back(1, 1);
+  vec_matches.emplace_back(0, 2);
+  vec_matches.emplace_back(2, 3);
+  vec_matches.emplace_back(2, 4);
+
+  const float distances[] = {4.f, 1.f, 2.f, 3.f, 5.f};
+  vector<float> vec_distances(distances, distances + 5);
+
+  vector<int> vec_goodIndex;
+  MutualBestMatches(vec_matches, vec_distances, vec_goodIndex);
+
+  // database 0 keeps query 2 (2 < 4), database 1 keeps query 1,
+  // database 2 keeps query 3 (3 < 5).
+  BOOST_CHECK_EQUAL(3, vec_goodIndex.size());
+  BOOST_CHECK_EQUAL(1, vec_goodIndex[0]);
+  BOOST_CHECK_EQUAL(2, vec_goodIndex[1]);
+  BOOST_CHECK_EQUAL(3, vec_goodIndex[2]);
+}
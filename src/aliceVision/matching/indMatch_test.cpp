@@ -4,6 +4,7 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "aliceVision/matching/IndMatch.hpp"
+#include "aliceVision/matching/IndMatchDecorator.hpp"
 #include "aliceVision/matching/io.hpp"
 
 #define BOOST_TEST_MODULE IndMatch
@@ -158,3 +159,34 @@ BOOST_AUTO_TEST_CASE(IndMatch_DuplicateRemoval)
   BOOST_CHECK_EQUAL(IndMatch(2,3), vec_indMatch[3]);
   BOOST_CHECK_EQUAL(IndMatch(3,3), vec_indMatch[4]);
 }
+
+BOOST_AUTO_TEST_CASE(IndMatch_removeDuplicateMatchPositions)
+{
+  // features 0 and 2 of the left image share the same position
+  std::vector<PointFeature> leftFeat;
+  leftFeat.emplace_back(1.f, 1.f);
+  leftFeat.emplace_back(2.f, 2.f);
+  leftFeat.emplace_back(1.f, 1.f);
+
+  std::vector<PointFeature> rightFeat;
+  rightFeat.emplace_back(5.f, 5.f);
+  rightFeat.emplace_back(6.f, 6.f);
+
+  // matches (0,0) and (2,0) map the same position pair; (1,1) is unique
+  IndMatches matches;
+  matches.emplace_back(0, 0);
+  matches.emplace_back(1, 1);
+  matches.emplace_back(2, 0);
+
+  std::vector<unsigned int> scratch;
+  BOOST_CHECK(removeDuplicateMatchPositions(leftFeat, rightFeat, matches, scratch));
+
+  // the first occurrence is kept and the original order is preserved
+  BOOST_CHECK_EQUAL(2, matches.size());
+  BOOST_CHECK(matches[0] == IndMatch(0, 0));
+  BOOST_CHECK(matches[1] == IndMatch(1, 1));
+
+  // no duplicates: nothing is removed
+  BOOST_CHECK(!removeDuplicateMatchPositions(leftFeat, rightFeat, matches, scratch));
+  BOOST_CHECK_EQUAL(2, matches.size());
+}
@@ -16,15 +16,327 @@
 
 #include "dependencies/stlplus3/filesystemSimplified/file_system.hpp"
 
+#include <algorithm>
+#include <cstdint>
 #include <map>
 #include <fstream>
 #include <iterator>
+#include <sstream>
 #include <string>
 #include <vector>
 
 namespace aliceVision {
 namespace matching {
 
+namespace {
+
+// Compact binary matches file ("cbin"):
+// - header : magic "ALVMCBIN", version byte, sizeof(IndMatch) byte
+// - index  : nbPairs (uint64), then per pair
+//            I (IndexT), J (IndexT), payload offset (uint64), nbDescTypes (uint32)
+// - payload: per pair, nbDescTypes blocks of
+//            descType (int32), nbMatches (uint64), raw IndMatch array
+// The pair->offset index allows to read only the pairs a consumer requests.
+
+const char CBIN_MAGIC[8] = {'A','L','V','M','C','B','I','N'};
+const unsigned char CBIN_VERSION = 1;
+
+template<typename T>
+inline void writePod(std::ostream& stream, const T& value)
+{
+  stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+inline bool readPod(std::istream& stream, T& value)
+{
+  stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+  return bool(stream);
+}
+
+struct CompactIndexEntry
+{
+  IndexT I;
+  IndexT J;
+  std::uint64_t offset;
+  std::uint32_t nbDescTypes;
+};
+
+bool LoadCompactMatchFile(
+  PairwiseMatches& matches,
+  const std::string& filepath,
+  const PairSet& pairsFilter)
+{
+  std::ifstream stream(filepath.c_str(), std::ios::in | std::ios::binary);
+  if(!stream.is_open())
+    return false;
+
+  char magic[8];
+  stream.read(magic, sizeof(magic));
+  if(!stream || !std::equal(magic, magic + sizeof(magic), CBIN_MAGIC))
+  {
+    ALICEVISION_LOG_WARNING("Invalid compact matches file: " << filepath);
+    return false;
+  }
+
+  unsigned char version = 0;
+  unsigned char matchSize = 0;
+  readPod(stream, version);
+  readPod(stream, matchSize);
+  if(version != CBIN_VERSION || matchSize != sizeof(IndMatch))
+  {
+    ALICEVISION_LOG_WARNING("Incompatible compact matches file: " << filepath);
+    return false;
+  }
+
+  std::uint64_t nbPairs = 0;
+  if(!readPod(stream, nbPairs))
+    return false;
+
+  std::vector<CompactIndexEntry> index(nbPairs);
+  for(CompactIndexEntry& entry: index)
+  {
+    readPod(stream, entry.I);
+    readPod(stream, entry.J);
+    readPod(stream, entry.offset);
+    if(!readPod(stream, entry.nbDescTypes))
+      return false;
+  }
+
+  for(const CompactIndexEntry& entry: index)
+  {
+    const Pair imagePair(entry.I, entry.J);
+    if(!pairsFilter.empty() &&
+       !pairsFilter.count(imagePair) &&
+       !pairsFilter.count(Pair(entry.J, entry.I)))
+      continue;
+
+    stream.seekg(entry.offset);
+    MatchesPerDescType& matchesPerDesc = matches[imagePair];
+    for(std::uint32_t i = 0; i < entry.nbDescTypes; ++i)
+    {
+      std::int32_t descType = 0;
+      std::uint64_t nbMatches = 0;
+      readPod(stream, descType);
+      if(!readPod(stream, nbMatches))
+        return false;
+      IndMatches& descMatches = matchesPerDesc[feature::EImageDescriberType(descType)];
+      descMatches.resize(nbMatches);
+      stream.read(reinterpret_cast<char*>(descMatches.data()), nbMatches * sizeof(IndMatch));
+      if(!stream)
+        return false;
+    }
+  }
+  return true;
+}
+
+// Sidecar statistics index ("matches.stats.txt"):
+// one line per pair "I J nbPutative nbGeometric model", updated at save time
+// so that match counts can be consulted without parsing the matches files.
+
+const char STATS_BASENAME[] = "matches.stats.txt";
+
+void mergeStatsEntry(PairStats& into, const PairStats& from)
+{
+  // an empty field never overwrites a filled one
+  if(from.nbPutativeMatches != 0)
+    into.nbPutativeMatches = from.nbPutativeMatches;
+  if(from.nbGeometricMatches != 0)
+    into.nbGeometricMatches = from.nbGeometricMatches;
+  if(from.geometricModel != '?')
+    into.geometricModel = from.geometricModel;
+}
+
+bool LoadStatsFile(PairwiseMatchesStats& stats, const std::string& folder)
+{
+  std::ifstream stream(stlplus::create_filespec(folder, STATS_BASENAME).c_str());
+  if(!stream.is_open())
+    return false;
+
+  std::string line;
+  while(std::getline(stream, line))
+  {
+    if(line.empty() || line[0] == '#')
+      continue;
+    std::istringstream iss(line);
+    IndexT I = 0, J = 0;
+    PairStats entry;
+    if(!(iss >> I >> J >> entry.nbPutativeMatches >> entry.nbGeometricMatches >> entry.geometricModel))
+    {
+      ALICEVISION_LOG_WARNING("Invalid matches statistics index in: " << folder);
+      return false;
+    }
+    mergeStatsEntry(stats[Pair(I, J)], entry);
+  }
+  return true;
+}
+
+bool SaveStatsFile(const PairwiseMatchesStats& stats, const std::string& folder)
+{
+  std::ofstream stream(stlplus::create_filespec(folder, STATS_BASENAME).c_str());
+  if(!stream.is_open())
+    return false;
+
+  stream << "# I J nbPutative nbGeometric model\n";
+  for(const auto& statsPair: stats)
+  {
+    const PairStats& entry = statsPair.second;
+    stream << statsPair.first.first << ' ' << statsPair.first.second << ' '
+           << entry.nbPutativeMatches << ' '
+           << entry.nbGeometricMatches << ' '
+           << entry.geometricModel << '\n';
+  }
+  return !stream.bad();
+}
+
+void UpdateStatsFile(
+  const PairwiseMatches& matches,
+  const std::string& folder,
+  const std::string& mode)
+{
+  // merge into the existing index: the putative and geometric passes each
+  // fill their own column
+  PairwiseMatchesStats stats;
+  LoadStatsFile(stats, folder);
+
+  for(const auto& match: matches)
+  {
+    PairStats& entry = stats[match.first];
+    if(mode == "putative")
+    {
+      entry.nbPutativeMatches = match.second.getNbAllMatches();
+    }
+    else
+    {
+      entry.nbGeometricMatches = match.second.getNbAllMatches();
+      entry.geometricModel = mode[0];
+    }
+  }
+
+  if(!SaveStatsFile(stats, folder))
+    ALICEVISION_LOG_WARNING("Unable to save the matches statistics index in: " << folder);
+}
+
+// Sidecar cache index ("matches.cache.txt"):
+// one line per pair "I J contentHashI contentHashJ parametersHash", recording
+// the input hashes under which the saved result of the pair was computed.
+
+const char CACHE_BASENAME[] = "matches.cache.txt";
+
+bool LoadCacheFile(PairwiseMatchesCache& cache, const std::string& folder)
+{
+  std::ifstream stream(stlplus::create_filespec(folder, CACHE_BASENAME).c_str());
+  if(!stream.is_open())
+    return false;
+
+  std::string line;
+  while(std::getline(stream, line))
+  {
+    if(line.empty() || line[0] == '#')
+      continue;
+    std::istringstream iss(line);
+    IndexT I = 0, J = 0;
+    PairCacheRecord record;
+    if(!(iss >> I >> J >> record.contentHashI >> record.contentHashJ >> record.parametersHash))
+    {
+      ALICEVISION_LOG_WARNING("Invalid matches cache index in: " << folder);
+      return false;
+    }
+    cache[Pair(I, J)] = record;
+  }
+  return true;
+}
+
+bool SaveCacheFile(const PairwiseMatchesCache& cache, const std::string& folder)
+{
+  std::ofstream stream(stlplus::create_filespec(folder, CACHE_BASENAME).c_str());
+  if(!stream.is_open())
+    return false;
+
+  stream << "# I J contentHashI contentHashJ parametersHash\n";
+  for(const auto& cachePair: cache)
+  {
+    const PairCacheRecord& record = cachePair.second;
+    stream << cachePair.first.first << ' ' << cachePair.first.second << ' '
+           << record.contentHashI << ' '
+           << record.contentHashJ << ' '
+           << record.parametersHash << '\n';
+  }
+  return !stream.bad();
+}
+
+} // namespace
+
+bool LoadStats(
+  PairwiseMatchesStats & stats,
+  const std::vector<std::string> & folders)
+{
+  bool res = false;
+  for(const std::string& folder: folders)
+    res |= LoadStatsFile(stats, folder);
+  return res;
+}
+
+std::uint64_t HashContent(const void* data, std::size_t size, std::uint64_t seed)
+{
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  std::uint64_t hash = seed;
+  for(std::size_t i = 0; i < size; ++i)
+  {
+    hash ^= std::uint64_t(bytes[i]);
+    hash *= 1099511628211ULL; // FNV prime
+  }
+  return hash;
+}
+
+std::uint64_t HashFileContent(const std::string & path, std::uint64_t seed)
+{
+  std::ifstream stream(path.c_str(), std::ios::binary);
+  if(!stream.is_open())
+    return 0;
+
+  char buffer[65536];
+  std::uint64_t hash = seed;
+  while(stream)
+  {
+    stream.read(buffer, sizeof(buffer));
+    const std::streamsize nbRead = stream.gcount();
+    if(nbRead <= 0)
+      break;
+    hash = HashContent(buffer, std::size_t(nbRead), hash);
+  }
+  return hash;
+}
+
+bool LoadCache(
+  PairwiseMatchesCache & cache,
+  const std::vector<std::string> & folders)
+{
+  bool res = false;
+  for(const std::string& folder: folders)
+    res |= LoadCacheFile(cache, folder);
+  return res;
+}
+
+bool UpdateCache(
+  const PairwiseMatchesCache & records,
+  const std::string & folder)
+{
+  // merge into the existing index: recomputed pairs overwrite their record
+  PairwiseMatchesCache cache;
+  LoadCacheFile(cache, folder);
+
+  for(const auto& record: records)
+    cache[record.first] = record.second;
+
+  if(!SaveCacheFile(cache, folder))
+  {
+    ALICEVISION_LOG_WARNING("Unable to save the matches cache index in: " << folder);
+    return false;
+  }
+  return true;
+}
+
 bool LoadMatchFile(
   PairwiseMatches & matches,
   const std::string& folder,
@@ -100,6 +412,10 @@ bool LoadMatchFile(
     }
     return true;
   }
+  else if (ext == "cbin")
+  {
+    return LoadCompactMatchFile(matches, filepath, PairSet());
+  }
   else
   {
     ALICEVISION_LOG_WARNING("Unknown matching file format: " << ext);
@@ -126,6 +442,20 @@ void filterMatchesByViews(
   matches.swap(filteredMatches);
 }
 
+void filterMatchesByPairs(
+  PairwiseMatches & matches,
+  const PairSet & pairs)
+{
+  matching::PairwiseMatches filteredMatches;
+  for(const auto& match: matches)
+  {
+    if(pairs.count(match.first) ||
+       pairs.count(Pair(match.first.second, match.first.first)))
+      filteredMatches.insert(match);
+  }
+  matches.swap(filteredMatches);
+}
+
 void filterTopMatches(
   PairwiseMatches & allMatches,
   const int limitNum)
@@ -235,6 +565,10 @@ bool Load(
     {
       res = LoadMatchFile(matches, folder, basename + ".bin");
     }
+    else if(stlplus::is_file(stlplus::create_filespec(folder, basename + ".cbin")))
+    {
+      res = LoadMatchFile(matches, folder, basename + ".cbin");
+    }
     else if(!stlplus::folder_wildcard(folder, "*."+basename+".txt", false, true).empty())
     {
       res = LoadMatchFilePerImage(matches, viewsKeysFilter, folder, basename + ".txt");
@@ -243,6 +577,10 @@ bool Load(
     {
       res = LoadMatchFilePerImage(matches, viewsKeysFilter, folder, basename + ".bin");
     }
+    else if(!stlplus::folder_wildcard(folder, "*."+basename+".cbin", false, true).empty())
+    {
+      res = LoadMatchFilePerImage(matches, viewsKeysFilter, folder, basename + ".cbin");
+    }
   }
 
   if(!res)
@@ -272,6 +610,47 @@ bool Load(
   return res;
 }
 
+bool Load(PairwiseMatches& matches,
+  const PairSet& pairsFilter,
+  const std::vector<std::string>& folders,
+  const std::vector<feature::EImageDescriberType>& descTypesFilter,
+  const std::string& mode)
+{
+  bool res = false;
+  const std::string basename = "matches." + mode;
+
+  for(const std::string& folder : folders)
+  {
+    if(stlplus::is_file(stlplus::create_filespec(folder, basename + ".cbin")))
+    {
+      // indexed format: only the requested pairs are read from disk
+      if(LoadCompactMatchFile(matches, folder + "/" + basename + ".cbin", pairsFilter))
+        res = true;
+    }
+    else
+    {
+      // no indexed file in this folder: load everything and filter afterwards
+      PairwiseMatches folderMatches;
+      if(Load(folderMatches, std::set<IndexT>(), {folder}, std::vector<feature::EImageDescriberType>(), mode))
+      {
+        if(!pairsFilter.empty())
+          filterMatchesByPairs(folderMatches, pairsFilter);
+        for(const auto& v: folderMatches)
+          matches[v.first] = v.second;
+        res = true;
+      }
+    }
+  }
+
+  if(!res)
+    return false;
+
+  if(!descTypesFilter.empty())
+    filterMatchesByDesc(matches, descTypesFilter);
+
+  return true;
+}
+
 
 class MatchExporter
 {
@@ -312,6 +691,47 @@ private:
     stream.close();
   }
 
+  void saveCompactBinary(
+    const std::string & filepath,
+    const PairwiseMatches::const_iterator& matchBegin,
+    const PairwiseMatches::const_iterator& matchEnd)
+  {
+    const std::uint64_t nbPairs = std::distance(matchBegin, matchEnd);
+    // the payload starts right after the header and the index
+    const std::uint64_t headerSize = sizeof(CBIN_MAGIC) + 2 * sizeof(unsigned char);
+    const std::uint64_t entrySize = 2 * sizeof(IndexT) + sizeof(std::uint64_t) + sizeof(std::uint32_t);
+    std::uint64_t offset = headerSize + sizeof(std::uint64_t) + nbPairs * entrySize;
+
+    std::ofstream stream(filepath.c_str(), std::ios::out | std::ios::binary);
+    stream.write(CBIN_MAGIC, sizeof(CBIN_MAGIC));
+    writePod(stream, CBIN_VERSION);
+    writePod(stream, static_cast<unsigned char>(sizeof(IndMatch)));
+    writePod(stream, nbPairs);
+
+    // pair -> payload offset index
+    for(PairwiseMatches::const_iterator match = matchBegin; match != matchEnd; ++match)
+    {
+      writePod(stream, match->first.first);
+      writePod(stream, match->first.second);
+      writePod(stream, offset);
+      writePod(stream, static_cast<std::uint32_t>(match->second.size()));
+      for(const auto& m: match->second)
+        offset += sizeof(std::int32_t) + sizeof(std::uint64_t) + m.second.size() * sizeof(IndMatch);
+    }
+
+    // raw IndMatch payload
+    for(PairwiseMatches::const_iterator match = matchBegin; match != matchEnd; ++match)
+    {
+      for(const auto& m: match->second)
+      {
+        writePod(stream, static_cast<std::int32_t>(m.first));
+        writePod(stream, static_cast<std::uint64_t>(m.second.size()));
+        stream.write(reinterpret_cast<const char*>(m.second.data()), m.second.size() * sizeof(IndMatch));
+      }
+    }
+    stream.close();
+  }
+
 public:
   MatchExporter(
     const PairwiseMatches& matches,
@@ -339,6 +759,10 @@ public:
     {
       saveBinary(filepath, m_matches.begin(), m_matches.end());
     }
+    else if(m_ext == "cbin")
+    {
+      saveCompactBinary(filepath, m_matches.begin(), m_matches.end());
+    }
     else
     {
       throw std::runtime_error(std::string("Unknown matching file format: ") + m_ext);
@@ -374,6 +798,10 @@ public:
       {
         saveBinary(filepath, matchBegin, match);
       }
+      else if(m_ext == "cbin")
+      {
+        saveCompactBinary(filepath, matchBegin, match);
+      }
       else
       {
         throw std::runtime_error(std::string("Unknown matching file format: ") + m_ext);
@@ -403,6 +831,9 @@ bool Save(
     exporter.saveOneFilePerImage();
   else
     exporter.saveGlobalFile();
+
+  // keep the sidecar statistics index in sync with the saved matches
+  UpdateStatsFile(matches, folder, mode);
   return true;
 }
 
@@ -7,7 +7,10 @@
 
 #include <aliceVision/matching/IndMatch.hpp>
 
+#include <cstdint>
+#include <map>
 #include <string>
+#include <vector>
 
 namespace aliceVision {
 namespace matching {
@@ -55,6 +58,24 @@ bool Load(PairwiseMatches& matches,
   const std::string& mode,
   const int maxNbMatches = 0);
 
+/**
+ * @brief Load match files for a selection of image pairs.
+ *
+ * With the indexed "cbin" format only the requested pairs are read from disk,
+ * with the other formats everything is loaded and filtered afterwards.
+ *
+ * @param[out] matches: container for the output matches
+ * @param[in] pairsFilter: image pairs to load, empty means all the pairs
+ * @param[in] folders: folders containing the match files
+ * @param[in] descTypesFilter
+ * @param[in] mode: type of matching, it could be: "f", "e" or "putative".
+ */
+bool Load(PairwiseMatches& matches,
+  const PairSet& pairsFilter,
+  const std::vector<std::string>& folders,
+  const std::vector<feature::EImageDescriberType>& descTypesFilter,
+  const std::string& mode);
+
 /**
  * @brief Filter to keep only specific viewIds.
  */
@@ -62,6 +83,13 @@ void filterMatchesByViews(
   PairwiseMatches & matches,
   const std::set<IndexT> & viewsKeys);
 
+/**
+ * @brief Filter to keep only specific image pairs (both orientations are accepted).
+ */
+void filterMatchesByPairs(
+  PairwiseMatches & matches,
+  const PairSet & pairs);
+
 /**
  * @brief Filter to keep only the \c limitNum first matches per descriptor type.
  */
@@ -69,6 +97,132 @@ void filterTopMatches(
   PairwiseMatches & allMatches,
   const int limitNum);
 
+/**
+ * @brief Per-pair statistics stored in the "matches.stats.txt" sidecar index.
+ *
+ * The index is updated every time a matches file is saved, so consumers
+ * (shard planning, dataset debugging, export tools) can get the match counts
+ * of every pair without parsing the matches files themselves.
+ */
+struct PairStats
+{
+  PairStats()
+    : nbPutativeMatches(0)
+    , nbGeometricMatches(0)
+    , geometricModel('?')
+  {}
+
+  /// number of putative (photometric) matches of the pair
+  std::size_t nbPutativeMatches;
+  /// number of matches kept by the geometric filtering
+  std::size_t nbGeometricMatches;
+  /// geometric model used by the filtering: 'f', 'e' or 'h' ('?': none saved yet)
+  char geometricModel;
+};
+
+typedef std::map<Pair, PairStats> PairwiseMatchesStats;
+
+/**
+ * @brief Load the matches statistics sidecar index from the given folders.
+ *
+ * Entries found in several folders are merged field by field, an empty field
+ * never overwrites a filled one.
+ *
+ * @param[out] stats: container for the output statistics
+ * @param[in] folders: folders containing the match files
+ * @return true if at least one index file has been loaded
+ */
+bool LoadStats(
+  PairwiseMatchesStats & stats,
+  const std::vector<std::string> & folders);
+
+/**
+ * @brief 64 bits FNV-1a content hash.
+ *
+ * Chainable: pass the hash of a previous buffer as the seed to hash a
+ * logical sequence of buffers as one.
+ *
+ * @param[in] data: bytes to hash
+ * @param[in] size: number of bytes
+ * @param[in] seed: hash to chain from (default: FNV offset basis)
+ * @return hash of the bytes
+ */
+std::uint64_t HashContent(
+  const void* data,
+  std::size_t size,
+  std::uint64_t seed = 0xcbf29ce484222325ULL);
+
+/**
+ * @brief Content hash of a whole file, chainable like HashContent.
+ *
+ * @param[in] path: file to hash
+ * @param[in] seed: hash to chain from (default: FNV offset basis)
+ * @return hash of the file content, 0 if the file cannot be read
+ */
+std::uint64_t HashFileContent(
+  const std::string & path,
+  std::uint64_t seed = 0xcbf29ce484222325ULL);
+
+/**
+ * @brief Per-pair cache record stored in the "matches.cache.txt" sidecar index.
+ *
+ * A record stores the content hashes of the descriptors of the two views and
+ * of the matching parameters under which the saved result of the pair was
+ * computed. When the hashes of a new run are identical the saved result is
+ * still valid and the pair can be skipped, whatever combination of stages was
+ * re-run in between. A recorded pair without a saved matches entry is a
+ * cached empty result.
+ */
+struct PairCacheRecord
+{
+  PairCacheRecord()
+    : contentHashI(0)
+    , contentHashJ(0)
+    , parametersHash(0)
+  {}
+
+  /// content hash of the descriptor files of the first view
+  std::uint64_t contentHashI;
+  /// content hash of the descriptor files of the second view
+  std::uint64_t contentHashJ;
+  /// hash of the matching parameters (matcher, ratio, geometric model, ...)
+  std::uint64_t parametersHash;
+
+  bool operator==(const PairCacheRecord& other) const
+  {
+    return contentHashI == other.contentHashI &&
+           contentHashJ == other.contentHashJ &&
+           parametersHash == other.parametersHash;
+  }
+};
+
+typedef std::map<Pair, PairCacheRecord> PairwiseMatchesCache;
+
+/**
+ * @brief Load the matches cache sidecar index from the given folders.
+ *
+ * @param[out] cache: container for the output records
+ * @param[in] folders: folders containing the match files
+ * @return true if at least one index file has been loaded
+ */
+bool LoadCache(
+  PairwiseMatchesCache & cache,
+  const std::vector<std::string> & folders);
+
+/**
+ * @brief Merge the given records into the cache index of the given folder.
+ *
+ * The existing index is loaded first and recomputed pairs get their record
+ * overwritten, so partial runs (shards, pair lists) accumulate into one index.
+ *
+ * @param[in] records: records of the freshly computed pairs
+ * @param[in] folder: folder containing the match files
+ * @return true if the index has been written
+ */
+bool UpdateCache(
+  const PairwiseMatchesCache & records,
+  const std::string & folder);
+
 /**
  * @brief Save match files.
  *
@@ -76,7 +230,7 @@ void filterTopMatches(
  * @param[in] sfm_data
  * @param[in] folder: folder containing the match files
  * @param[in] mode: type of matching, it could be: "f", "e" or "putative".
- * @param[in] extension: txt or bin file format
+ * @param[in] extension: txt, bin or cbin file format
  * @param[in] matchFilePerImage: do we store a global match file
  *            or one match file per image
  */
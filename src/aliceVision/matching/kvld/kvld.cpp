@@ -257,12 +257,22 @@ float KVLD( const Image< float >& I1,
     fill( scoretable.begin(), scoretable.end(), 0.0 );
     fill( result.begin(), result.end(), 0 );
     //========substep 1: search foreach match its neighbors and verify if they are gvld-consistent ============//
+    // The VLD scoring of the neighbor candidates of one match is independent
+    // (each candidate touches its own E(it1,it2)/E(it2,it1) cells and the two
+    // scale-space pyramids are read-only), so the candidates are collected
+    // first and their VLD errors are computed in parallel by blocks. The
+    // accumulation and the max_connection cut-off stay sequential and in the
+    // original order, so the filtering result is the same as the serial
+    // version; at most one extra block of candidates is scored per match,
+    // and a scored E value is identical whenever it is computed.
+    std::vector< int > candidates;
     for( int it1 = 0; it1 < size - 1; it1++ )
     {
       if( valide[ it1 ] )
       {
         size_t a1 = matches[ it1 ].first, b1 = matches[ it1 ].second;
 
+        candidates.clear();
         for( int it2 = it1 + 1; it2 < size; it2++ )
           if(valide[ it2 ])
           {
@@ -276,38 +286,63 @@ float KVLD( const Image< float >& I1,
               bOk = ( point_distance( F1[ a1 ], F1[ a2 ] ) > min_dist && point_distance( F2[ b1 ], F2[ b2 ] ) > min_dist &&
                     ( point_distance( F1[ a1 ], F1[ a2 ] ) < range1   || point_distance( F2[ b1 ], F2[ b2 ] ) < range2 ) );
             if( bOk )
-            {
-              if( E( it1, it2 ) == -1 )
-              { //update E ifunknow
-                E( it1, it2 ) = -2;
-                E( it2, it1 ) = -2;
+              candidates.push_back( it2 );
+          }
+
+        // block size: enough work to keep the threads busy, small enough to
+        // limit the scoring done past the max_connection cut-off
+        const size_t blockSize = 4 * max_connection;
+        bool capped = false;
+
+        for( size_t blockStart = 0; blockStart < candidates.size() && !capped; blockStart += blockSize )
+        {
+          const size_t blockEnd = std::min( candidates.size(), blockStart + blockSize );
 
-                if( !kvldParameters.geometry || consistent( F1[ a1 ], F1[ a2 ], F2[ b1 ], F2[ b2 ] ) < distance_thres )
+          #pragma omp parallel for schedule(dynamic)
+          for( int c = int( blockStart ); c < int( blockEnd ); c++ )
+          {
+            const int it2 = candidates[ c ];
+            const size_t a2 = matches[ it2 ].first, b2 = matches[ it2 ].second;
+
+            if( E( it1, it2 ) == -1 )
+            { //update E ifunknow
+              E( it1, it2 ) = -2;
+              E( it2, it1 ) = -2;
+
+              if( !kvldParameters.geometry || consistent( F1[ a1 ], F1[ a2 ], F2[ b1 ], F2[ b2 ] ) < distance_thres )
+              {
+                VLD vld1( Chaine1, F1[ a1 ], F1[ a2 ] );
+                VLD vld2( Chaine2, F2[ b1 ], F2[ b2 ] );
+                //vld1.test();
+                double error = vld1.difference( vld2 );
+                //cout<<endl<<it1<<" "<<it2<<" "<<dist1(a1,a2)<<" "<< dist2(b1,b2)<<" "<<error<<endl;
+                if( error < juge )
                 {
-                  VLD vld1( Chaine1, F1[ a1 ], F1[ a2 ] );
-                  VLD vld2( Chaine2, F2[ b1 ], F2[ b2 ] );
-                  //vld1.test();
-                  double error = vld1.difference( vld2 );
-                  //cout<<endl<<it1<<" "<<it2<<" "<<dist1(a1,a2)<<" "<< dist2(b1,b2)<<" "<<error<<endl;
-                  if( error < juge )
-                  {
-                    E( it1, it2 ) = ( float ) error;
-                    E( it2, it1 ) = ( float ) error;
-                    //cout<<E(it2,it1)<<endl;
-                  }
+                  E( it1, it2 ) = ( float ) error;
+                  E( it2, it1 ) = ( float ) error;
+                  //cout<<E(it2,it1)<<endl;
                 }
               }
-              if( E( it1, it2 ) >= 0 )
+            }
+          }
+
+          for( size_t c = blockStart; c < blockEnd; c++ )
+          {
+            const int it2 = candidates[ c ];
+            if( E( it1, it2 ) >= 0 )
+            {
+              result[ it1 ] += 1;
+              result[ it2 ] += 1;
+              scoretable[ it1 ] += double( E( it1, it2 ) );
+              scoretable[ it2 ] += double( E( it1, it2 ) );
+              if( result[ it1 ] >= max_connection )
               {
-                result[ it1 ] += 1;
-                result[ it2 ] += 1;
-                scoretable[ it1 ] += double( E( it1, it2 ) );
-                scoretable[ it2 ] += double( E( it1, it2 ) );
-                if( result[ it1 ] >= max_connection )
-                  break;
+                capped = true;
+                break;
               }
             }
           }
+        }
       }
     }
 
@@ -16,6 +16,8 @@ enum EMatcherType
   ANN_L2,
   CASCADE_HASHING_L2,
   FAST_CASCADE_HASHING_L2,
+  HNSW_L2,
+  BRUTE_FORCE_CUDA_L2,
   BRUTE_FORCE_HAMMING
 };
 
@@ -0,0 +1,84 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "aliceVision/matching/io.hpp"
+
+#define BOOST_TEST_MODULE matchesCache
+#include <boost/test/included/unit_test.hpp>
+
+#include <fstream>
+
+using namespace aliceVision;
+using namespace aliceVision::matching;
+
+BOOST_AUTO_TEST_CASE(matchesCache_ContentHash)
+{
+  const char data[] = "some descriptor bytes";
+
+  // deterministic and sensitive to every byte
+  const std::uint64_t hash = HashContent(data, sizeof(data));
+  BOOST_CHECK_EQUAL(hash, HashContent(data, sizeof(data)));
+  BOOST_CHECK_NE(hash, HashContent(data, sizeof(data) - 1));
+  BOOST_CHECK_NE(hash, HashContent(data + 1, sizeof(data) - 1));
+
+  // chaining through the seed is equivalent to hashing the concatenation
+  const std::size_t split = 7;
+  const std::uint64_t chained = HashContent(data + split, sizeof(data) - split,
+                                            HashContent(data, split));
+  BOOST_CHECK_EQUAL(hash, chained);
+
+  // a file hashes like its content, a missing file hashes to 0
+  const std::string path = "./matchesCache_test.bin";
+  {
+    std::ofstream stream(path.c_str(), std::ios::binary);
+    stream.write(data, sizeof(data));
+  }
+  BOOST_CHECK_EQUAL(hash, HashFileContent(path));
+  BOOST_CHECK_EQUAL(0, HashFileContent("./matchesCache_test_missing.bin"));
+}
+
+BOOST_AUTO_TEST_CASE(matchesCache_UpdateAndLoadIndex)
+{
+  const std::string folder = ".";
+
+  // a first run records two pairs
+  PairwiseMatchesCache firstRun;
+  firstRun[Pair(0, 1)].contentHashI = 11;
+  firstRun[Pair(0, 1)].contentHashJ = 12;
+  firstRun[Pair(0, 1)].parametersHash = 13;
+  firstRun[Pair(1, 2)].contentHashI = 21;
+  firstRun[Pair(1, 2)].contentHashJ = 22;
+  firstRun[Pair(1, 2)].parametersHash = 23;
+  BOOST_CHECK(UpdateCache(firstRun, folder));
+
+  {
+    PairwiseMatchesCache cache;
+    BOOST_CHECK(LoadCache(cache, {folder}));
+    BOOST_CHECK_EQUAL(cache.size(), 2);
+    BOOST_CHECK(cache.at(Pair(0, 1)) == firstRun.at(Pair(0, 1)));
+    BOOST_CHECK(cache.at(Pair(1, 2)) == firstRun.at(Pair(1, 2)));
+  }
+
+  // a second run recomputing (1,2) overwrites its record and keeps (0,1)
+  PairwiseMatchesCache secondRun;
+  secondRun[Pair(1, 2)].contentHashI = 31;
+  secondRun[Pair(1, 2)].contentHashJ = 32;
+  secondRun[Pair(1, 2)].parametersHash = 33;
+  BOOST_CHECK(UpdateCache(secondRun, folder));
+
+  {
+    PairwiseMatchesCache cache;
+    BOOST_CHECK(LoadCache(cache, {folder}));
+    BOOST_CHECK_EQUAL(cache.size(), 2);
+    BOOST_CHECK(cache.at(Pair(0, 1)) == firstRun.at(Pair(0, 1)));
+    BOOST_CHECK(cache.at(Pair(1, 2)) == secondRun.at(Pair(1, 2)));
+    BOOST_CHECK(!(cache.at(Pair(1, 2)) == firstRun.at(Pair(1, 2))));
+  }
+
+  // a missing index loads nothing
+  PairwiseMatchesCache cache;
+  BOOST_CHECK(!LoadCache(cache, {"./matchesCache_test_missing_folder"}));
+  BOOST_CHECK(cache.empty());
+}
@@ -0,0 +1,72 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "aliceVision/matching/io.hpp"
+
+#define BOOST_TEST_MODULE matchesStats
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::matching;
+
+// Putative matches of two pairs: 4 matches for (0,1), 2 matches for (1,2).
+static PairwiseMatches makePutativeMatches()
+{
+  PairwiseMatches matches;
+  IndMatches& sift01 = matches[Pair(0, 1)][feature::EImageDescriberType::SIFT];
+  sift01.emplace_back(0, 3);
+  sift01.emplace_back(1, 4);
+  sift01.emplace_back(2, 5);
+  IndMatches& akaze01 = matches[Pair(0, 1)][feature::EImageDescriberType::AKAZE];
+  akaze01.emplace_back(7, 8);
+  IndMatches& sift12 = matches[Pair(1, 2)][feature::EImageDescriberType::SIFT];
+  sift12.emplace_back(3, 6);
+  sift12.emplace_back(4, 7);
+  return matches;
+}
+
+BOOST_AUTO_TEST_CASE(matchesStats_SaveUpdatesIndex)
+{
+  const std::string folder = ".";
+  const PairwiseMatches putativeMatches = makePutativeMatches();
+  BOOST_CHECK(Save(putativeMatches, folder, "putative", "txt", false));
+
+  // the putative pass fills the putative column only
+  {
+    PairwiseMatchesStats stats;
+    BOOST_CHECK(LoadStats(stats, {folder}));
+    BOOST_CHECK_EQUAL(stats.size(), 2);
+    BOOST_CHECK_EQUAL(stats.at(Pair(0, 1)).nbPutativeMatches, 4);
+    BOOST_CHECK_EQUAL(stats.at(Pair(0, 1)).nbGeometricMatches, 0);
+    BOOST_CHECK_EQUAL(stats.at(Pair(0, 1)).geometricModel, '?');
+    BOOST_CHECK_EQUAL(stats.at(Pair(1, 2)).nbPutativeMatches, 2);
+  }
+
+  // the geometric pass keeps only a subset and fills the geometric column
+  PairwiseMatches geometricMatches;
+  IndMatches& sift01 = geometricMatches[Pair(0, 1)][feature::EImageDescriberType::SIFT];
+  sift01.emplace_back(0, 3);
+  sift01.emplace_back(2, 5);
+  BOOST_CHECK(Save(geometricMatches, folder, "f", "txt", false));
+
+  {
+    PairwiseMatchesStats stats;
+    BOOST_CHECK(LoadStats(stats, {folder}));
+    BOOST_CHECK_EQUAL(stats.at(Pair(0, 1)).nbPutativeMatches, 4);
+    BOOST_CHECK_EQUAL(stats.at(Pair(0, 1)).nbGeometricMatches, 2);
+    BOOST_CHECK_EQUAL(stats.at(Pair(0, 1)).geometricModel, 'f');
+    // pair (1,2) lost all its matches: putative count kept, geometric empty
+    BOOST_CHECK_EQUAL(stats.at(Pair(1, 2)).nbPutativeMatches, 2);
+    BOOST_CHECK_EQUAL(stats.at(Pair(1, 2)).nbGeometricMatches, 0);
+    BOOST_CHECK_EQUAL(stats.at(Pair(1, 2)).geometricModel, '?');
+  }
+}
+
+BOOST_AUTO_TEST_CASE(matchesStats_MissingIndex)
+{
+  PairwiseMatchesStats stats;
+  BOOST_CHECK(!LoadStats(stats, {"./no_such_folder"}));
+  BOOST_CHECK(stats.empty());
+}
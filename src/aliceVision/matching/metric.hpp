@@ -8,15 +8,22 @@
 #include "aliceVision/matching/Hamming.hpp"
 #include "aliceVision/numeric/Accumulator.hpp"
 #include <aliceVision/config.hpp>
+#include <aliceVision/system/cpuDispatch.hpp>
 
-#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_SSE)
-#include <aliceVision/system/Logger.hpp>
-#include <xmmintrin.h>
+#if defined(ALICEVISION_CPU_DISPATCH_X86)
+#include <immintrin.h>
 #endif
 
+#include <Eigen/Core> // Eigen::half
+
 #include <cstddef>
 
 namespace aliceVision {
+
+// Half precision descriptors accumulate their distances in single precision
+template<>
+struct Accumulator<Eigen::half> { typedef float Type; };
+
 namespace matching {
 
 /// Squared Euclidean distance functor.
@@ -73,52 +80,309 @@ struct L2_Vectorized
   }
 };
 
-#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_SSE)
+#if defined(ALICEVISION_CPU_DISPATCH_X86)
 
-namespace optim_ss2{
+// Multiversioned squared L2 kernels for float and unsigned char descriptors.
+// Every variant handles any size (vector body + scalar tail), so the resolved
+// function pointer can be called unconditionally.
+namespace optim_dispatch {
 
-  /// Union to switch between SSE and float array
-  union sseRegisterHelper
+  // Euclidean distance (scalar method) (squared result)
+  inline float l2_scalar(const float * b1, const float * b2, int size)
   {
-      __m128 m;
-      float f[4];
-  };
+    float result = 0.f;
+    int i = 0;
+    // Process 4 items with each loop for efficiency.
+    for(; i + 4 <= size; i += 4)
+    {
+      const float diff0 = b1[i]   - b2[i];
+      const float diff1 = b1[i+1] - b2[i+1];
+      const float diff2 = b1[i+2] - b2[i+2];
+      const float diff3 = b1[i+3] - b2[i+3];
+      result += diff0 * diff0 + diff1 * diff1 + diff2 * diff2 + diff3 * diff3;
+    }
+    for(; i < size; ++i)
+    {
+      const float diff = b1[i] - b2[i];
+      result += diff * diff;
+    }
+    return result;
+  }
 
-  // Euclidean distance (SSE method) (squared result)
-  inline float l2_sse(const float * b1, const float * b2, int size)
+  // Euclidean distance on unsigned char descriptors (scalar method) (squared result)
+  inline int l2_scalar(const unsigned char * b1, const unsigned char * b2, int size)
   {
-    float* b1Pt = (float*)b1;
-    float* b2Pt = (float*)b2;
-    if(size%4 == 0)
+    int result = 0;
+    for(int i = 0; i < size; ++i)
     {
-      __m128 srcA, srcB, temp, cumSum;
-      float zeros[4] = {0.f,0.f,0.f,0.f};
-      cumSum = _mm_load_ps( zeros );
-      for(int i = 0 ; i < size; i+=4)
-      {
-        srcA = _mm_load_ps(b1Pt+i);
-        srcB = _mm_load_ps(b2Pt+i);
-        //-- Subtract
-        temp = _mm_sub_ps( srcA, srcB );
-        //-- Multiply
-        temp =  _mm_mul_ps( temp, temp );
-        //-- sum
-        cumSum = _mm_add_ps( cumSum, temp );
-      }
-      sseRegisterHelper res;
-      res.m = cumSum;
-      return (res.f[0]+res.f[1]+res.f[2]+res.f[3]);
+      const int diff = int(b1[i]) - int(b2[i]);
+      result += diff * diff;
     }
-    else
+    return result;
+  }
+
+  // Euclidean distance on half precision descriptors (scalar method) (squared result)
+  inline float l2_scalar(const Eigen::half * b1, const Eigen::half * b2, int size)
+  {
+    float result = 0.f;
+    for(int i = 0; i < size; ++i)
+    {
+      const float diff = float(b1[i]) - float(b2[i]);
+      result += diff * diff;
+    }
+    return result;
+  }
+
+  // Euclidean distance (SSE4 method) (squared result)
+  ALICEVISION_TARGET_SSE4
+  inline float l2_sse4(const float * b1, const float * b2, int size)
+  {
+    __m128 cumSum = _mm_setzero_ps();
+    int i = 0;
+    for(; i + 4 <= size; i += 4)
     {
-      ALICEVISION_LOG_WARNING("/!\\ size is not modulus 4, distance cannot be performed in SSE");
-      return 0.0f;
+      const __m128 diff = _mm_sub_ps(_mm_loadu_ps(b1+i), _mm_loadu_ps(b2+i));
+      cumSum = _mm_add_ps(cumSum, _mm_mul_ps(diff, diff));
     }
+    __m128 sum = _mm_hadd_ps(cumSum, cumSum);
+    sum = _mm_hadd_ps(sum, sum);
+    float result = _mm_cvtss_f32(sum);
+    for(; i < size; ++i)
+    {
+      const float diff = b1[i] - b2[i];
+      result += diff * diff;
+    }
+    return result;
   }
-} // namespace optim_ss2
 
-// Template specification to run SSE L2 squared distance
-//  on float vector
+  // Euclidean distance on unsigned char descriptors (SSE4 method) (squared result)
+  ALICEVISION_TARGET_SSE4
+  inline int l2_sse4(const unsigned char * b1, const unsigned char * b2, int size)
+  {
+    __m128i cumSum = _mm_setzero_si128();
+    int i = 0;
+    for(; i + 16 <= size; i += 16)
+    {
+      // Widen each 8 bytes half to 16 bits so the subtraction cannot overflow
+      const __m128i a0 = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i*)(b1+i)));
+      const __m128i a1 = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i*)(b1+i+8)));
+      const __m128i b0 = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i*)(b2+i)));
+      const __m128i b1r = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i*)(b2+i+8)));
+      const __m128i d0 = _mm_sub_epi16(a0, b0);
+      const __m128i d1 = _mm_sub_epi16(a1, b1r);
+      cumSum = _mm_add_epi32(cumSum, _mm_madd_epi16(d0, d0));
+      cumSum = _mm_add_epi32(cumSum, _mm_madd_epi16(d1, d1));
+    }
+    __m128i sum = _mm_add_epi32(cumSum, _mm_shuffle_epi32(cumSum, _MM_SHUFFLE(1,0,3,2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2,3,0,1)));
+    int result = _mm_cvtsi128_si32(sum);
+    for(; i < size; ++i)
+    {
+      const int diff = int(b1[i]) - int(b2[i]);
+      result += diff * diff;
+    }
+    return result;
+  }
+
+  /// Horizontal sum of a 256 bits float register
+  ALICEVISION_TARGET_AVX2
+  inline float hsum256_ps(__m256 v)
+  {
+    const __m128 low = _mm256_castps256_ps128(v);
+    const __m128 high = _mm256_extractf128_ps(v, 1);
+    __m128 sum = _mm_add_ps(low, high);
+    sum = _mm_hadd_ps(sum, sum);
+    sum = _mm_hadd_ps(sum, sum);
+    return _mm_cvtss_f32(sum);
+  }
+
+  // Euclidean distance (AVX2 method) (squared result)
+  ALICEVISION_TARGET_AVX2
+  inline float l2_avx2(const float * b1, const float * b2, int size)
+  {
+    __m256 cumSum = _mm256_setzero_ps();
+    int i = 0;
+    for(; i + 8 <= size; i += 8)
+    {
+      const __m256 diff = _mm256_sub_ps(_mm256_loadu_ps(b1+i), _mm256_loadu_ps(b2+i));
+      cumSum = _mm256_add_ps(cumSum, _mm256_mul_ps(diff, diff));
+    }
+    float result = hsum256_ps(cumSum);
+    for(; i < size; ++i)
+    {
+      const float diff = b1[i] - b2[i];
+      result += diff * diff;
+    }
+    return result;
+  }
+
+  // Euclidean distance on unsigned char descriptors (AVX2 method) (squared result)
+  ALICEVISION_TARGET_AVX2
+  inline int l2_avx2(const unsigned char * b1, const unsigned char * b2, int size)
+  {
+    __m256i cumSum = _mm256_setzero_si256();
+    int i = 0;
+    for(; i + 32 <= size; i += 32)
+    {
+      // Widen each 16 bytes half to 16 bits so the subtraction cannot overflow
+      const __m256i a0 = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(b1+i)));
+      const __m256i a1 = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(b1+i+16)));
+      const __m256i b0 = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(b2+i)));
+      const __m256i b1r = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(b2+i+16)));
+      const __m256i d0 = _mm256_sub_epi16(a0, b0);
+      const __m256i d1 = _mm256_sub_epi16(a1, b1r);
+      cumSum = _mm256_add_epi32(cumSum, _mm256_madd_epi16(d0, d0));
+      cumSum = _mm256_add_epi32(cumSum, _mm256_madd_epi16(d1, d1));
+    }
+    const __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(cumSum), _mm256_extracti128_si256(cumSum, 1));
+    const __m128i sum2 = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1,0,3,2)));
+    const __m128i sum3 = _mm_add_epi32(sum2, _mm_shuffle_epi32(sum2, _MM_SHUFFLE(2,3,0,1)));
+    int result = _mm_cvtsi128_si32(sum3);
+    for(; i < size; ++i)
+    {
+      const int diff = int(b1[i]) - int(b2[i]);
+      result += diff * diff;
+    }
+    return result;
+  }
+
+  // Euclidean distance (AVX-512 method) (squared result)
+  ALICEVISION_TARGET_AVX512
+  inline float l2_avx512(const float * b1, const float * b2, int size)
+  {
+    __m512 cumSum = _mm512_setzero_ps();
+    int i = 0;
+    for(; i + 16 <= size; i += 16)
+    {
+      const __m512 diff = _mm512_sub_ps(_mm512_loadu_ps(b1+i), _mm512_loadu_ps(b2+i));
+      cumSum = _mm512_add_ps(cumSum, _mm512_mul_ps(diff, diff));
+    }
+    float result = _mm512_reduce_add_ps(cumSum);
+    for(; i < size; ++i)
+    {
+      const float diff = b1[i] - b2[i];
+      result += diff * diff;
+    }
+    return result;
+  }
+
+  // Euclidean distance on unsigned char descriptors (AVX-512 method) (squared result)
+  ALICEVISION_TARGET_AVX512
+  inline int l2_avx512(const unsigned char * b1, const unsigned char * b2, int size)
+  {
+    __m512i cumSum = _mm512_setzero_si512();
+    int i = 0;
+    for(; i + 64 <= size; i += 64)
+    {
+      const __m512i a0 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((const __m256i*)(b1+i)));
+      const __m512i a1 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((const __m256i*)(b1+i+32)));
+      const __m512i b0 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((const __m256i*)(b2+i)));
+      const __m512i b1r = _mm512_cvtepu8_epi16(_mm256_loadu_si256((const __m256i*)(b2+i+32)));
+      const __m512i d0 = _mm512_sub_epi16(a0, b0);
+      const __m512i d1 = _mm512_sub_epi16(a1, b1r);
+      cumSum = _mm512_add_epi32(cumSum, _mm512_madd_epi16(d0, d0));
+      cumSum = _mm512_add_epi32(cumSum, _mm512_madd_epi16(d1, d1));
+    }
+    int result = (int)_mm512_reduce_add_epi32(cumSum);
+    for(; i < size; ++i)
+    {
+      const int diff = int(b1[i]) - int(b2[i]);
+      result += diff * diff;
+    }
+    return result;
+  }
+
+  // Euclidean distance on half precision descriptors (F16C + AVX2 method)
+  // (squared result): the halves are widened to single precision in registers
+  // and accumulated like the float kernel, at half the memory bandwidth
+  ALICEVISION_TARGET_AVX2_F16C
+  inline float l2_f16c_avx2(const Eigen::half * b1, const Eigen::half * b2, int size)
+  {
+    const unsigned short* h1 = reinterpret_cast<const unsigned short*>(b1);
+    const unsigned short* h2 = reinterpret_cast<const unsigned short*>(b2);
+    __m256 cumSum = _mm256_setzero_ps();
+    int i = 0;
+    for(; i + 8 <= size; i += 8)
+    {
+      const __m256 a = _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(h1+i)));
+      const __m256 b = _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(h2+i)));
+      const __m256 diff = _mm256_sub_ps(a, b);
+      cumSum = _mm256_add_ps(cumSum, _mm256_mul_ps(diff, diff));
+    }
+    float result = hsum256_ps(cumSum);
+    for(; i < size; ++i)
+    {
+      const float diff = float(b1[i]) - float(b2[i]);
+      result += diff * diff;
+    }
+    return result;
+  }
+
+  // Euclidean distance on half precision descriptors (AVX-512 method) (squared result)
+  ALICEVISION_TARGET_AVX512
+  inline float l2_avx512(const Eigen::half * b1, const Eigen::half * b2, int size)
+  {
+    const unsigned short* h1 = reinterpret_cast<const unsigned short*>(b1);
+    const unsigned short* h2 = reinterpret_cast<const unsigned short*>(b2);
+    __m512 cumSum = _mm512_setzero_ps();
+    int i = 0;
+    for(; i + 16 <= size; i += 16)
+    {
+      const __m512 a = _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i*)(h1+i)));
+      const __m512 b = _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i*)(h2+i)));
+      const __m512 diff = _mm512_sub_ps(a, b);
+      cumSum = _mm512_add_ps(cumSum, _mm512_mul_ps(diff, diff));
+    }
+    float result = _mm512_reduce_add_ps(cumSum);
+    for(; i < size; ++i)
+    {
+      const float diff = float(b1[i]) - float(b2[i]);
+      result += diff * diff;
+    }
+    return result;
+  }
+
+  typedef float (*L2FloatKernel)(const float*, const float*, int);
+  typedef int (*L2UcharKernel)(const unsigned char*, const unsigned char*, int);
+  typedef float (*L2HalfKernel)(const Eigen::half*, const Eigen::half*, int);
+
+  /// Squared L2 distance, resolved once to the widest instruction set of the host
+  inline float l2Dispatch(const float * b1, const float * b2, int size)
+  {
+    static const L2FloatKernel kernel =
+      system::CpuDispatch<L2FloatKernel>(&l2_scalar)
+        .sse4(&l2_sse4)
+        .avx2(&l2_avx2)
+        .avx512(&l2_avx512)
+        .resolve();
+    return kernel(b1, b2, size);
+  }
+
+  inline int l2Dispatch(const unsigned char * b1, const unsigned char * b2, int size)
+  {
+    static const L2UcharKernel kernel =
+      system::CpuDispatch<L2UcharKernel>(&l2_scalar)
+        .sse4(&l2_sse4)
+        .avx2(&l2_avx2)
+        .avx512(&l2_avx512)
+        .resolve();
+    return kernel(b1, b2, size);
+  }
+
+  inline float l2Dispatch(const Eigen::half * b1, const Eigen::half * b2, int size)
+  {
+    static const L2HalfKernel kernel =
+      system::CpuDispatch<L2HalfKernel>(&l2_scalar)
+        .avx2(&l2_f16c_avx2)
+        .avx512(&l2_avx512)
+        .resolve();
+    return kernel(b1, b2, size);
+  }
+
+} // namespace optim_dispatch
+
+// Template specification to run vectorized L2 squared distance
+//  on float vector, resolved once to the widest supported ISA
 template<>
 struct L2_Vectorized<float>
 {
@@ -128,11 +392,41 @@ struct L2_Vectorized<float>
   template <typename Iterator1, typename Iterator2>
   inline ResultType operator()(Iterator1 a, Iterator2 b, size_t size) const
   {
-    return optim_ss2::l2_sse(a,b,size);
+    return optim_dispatch::l2Dispatch(&(*a), &(*b), static_cast<int>(size));
+  }
+};
+
+// Template specification to run vectorized L2 squared distance
+//  on unsigned char vector (SIFT uchar descriptors), resolved once
+template<>
+struct L2_Vectorized<unsigned char>
+{
+  typedef unsigned char ElementType;
+  typedef Accumulator<unsigned char>::Type ResultType;
+
+  template <typename Iterator1, typename Iterator2>
+  inline ResultType operator()(Iterator1 a, Iterator2 b, size_t size) const
+  {
+    return optim_dispatch::l2Dispatch(&(*a), &(*b), static_cast<int>(size));
+  }
+};
+
+// Template specification to run vectorized L2 squared distance
+//  on half precision vector, widened to single precision in registers
+template<>
+struct L2_Vectorized<Eigen::half>
+{
+  typedef Eigen::half ElementType;
+  typedef Accumulator<Eigen::half>::Type ResultType;
+
+  template <typename Iterator1, typename Iterator2>
+  inline ResultType operator()(Iterator1 a, Iterator2 b, size_t size) const
+  {
+    return optim_dispatch::l2Dispatch(&(*a), &(*b), static_cast<int>(size));
   }
 };
 
-#endif // ALICEVISION_HAVE_SSE
+#endif // ALICEVISION_CPU_DISPATCH_X86
 
 }  // namespace matching
 }  // namespace aliceVision
@@ -0,0 +1,62 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "aliceVision/matching/metric.hpp"
+#include "aliceVision/matching/Hamming.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+using namespace aliceVision;
+using namespace aliceVision::matching;
+
+// SIFT-like descriptor layout: 128 dimensions, values in [0;255]
+static const std::size_t DESC_SIZE = 128;
+static const std::size_t NB_DESCRIPTORS = 1024;
+
+template<typename T>
+std::vector<T> randomDescriptors()
+{
+  std::mt19937 gen(42); // fixed seed for run to run stability
+  std::uniform_int_distribution<int> d(0, 255);
+  std::vector<T> values(NB_DESCRIPTORS * DESC_SIZE);
+  for(std::size_t i = 0; i < values.size(); ++i)
+    values[i] = static_cast<T>(d(gen));
+  return values;
+}
+
+template<typename Metric>
+void benchDistance(benchmark::State& state)
+{
+  typedef typename Metric::ElementType T;
+  const std::vector<T> a = randomDescriptors<T>();
+  const std::vector<T> b = randomDescriptors<T>();
+  const Metric metric;
+
+  for(auto _ : state)
+  {
+    typename Metric::ResultType sum = 0;
+    for(std::size_t i = 0; i < NB_DESCRIPTORS; ++i)
+      sum += metric(&a[i * DESC_SIZE], &b[i * DESC_SIZE], DESC_SIZE);
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * NB_DESCRIPTORS);
+}
+
+static void BM_L2Simple_uchar(benchmark::State& state) { benchDistance<L2_Simple<unsigned char> >(state); }
+static void BM_L2Vectorized_uchar(benchmark::State& state) { benchDistance<L2_Vectorized<unsigned char> >(state); }
+static void BM_L2Simple_float(benchmark::State& state) { benchDistance<L2_Simple<float> >(state); }
+static void BM_L2Vectorized_float(benchmark::State& state) { benchDistance<L2_Vectorized<float> >(state); }
+static void BM_Hamming_uchar(benchmark::State& state) { benchDistance<Hamming<unsigned char> >(state); }
+
+BENCHMARK(BM_L2Simple_uchar);
+BENCHMARK(BM_L2Vectorized_uchar);
+BENCHMARK(BM_L2Simple_float);
+BENCHMARK(BM_L2Vectorized_float);
+BENCHMARK(BM_Hamming_uchar);
+
+BENCHMARK_MAIN();
@@ -6,6 +6,7 @@
 #include "aliceVision/matching/metric.hpp"
 #include <iostream>
 #include <string>
+#include <vector>
 
 #define BOOST_TEST_MODULE matchingMetric
 #include <boost/test/included/unit_test.hpp>
@@ -42,6 +43,39 @@ BOOST_AUTO_TEST_CASE(Metric_L2_Vectorized)
   BOOST_CHECK_EQUAL(168, DistanceT<L2_Vectorized<double> >());
 }
 
+BOOST_AUTO_TEST_CASE(Metric_L2_Vectorized_Half)
+{
+  // exact on small integers: fp16 represents them without rounding
+  // (Eigen::half is only explicitly constructible, so no DistanceT<> here)
+  {
+    Eigen::half array1[8], array2[8];
+    for(int i = 0; i < 8; ++i)
+    {
+      array1[i] = Eigen::half(float(i));
+      array2[i] = Eigen::half(float(7 - i));
+    }
+    L2_Vectorized<Eigen::half> metric;
+    BOOST_CHECK_EQUAL(168, metric(array1, array2, 8));
+  }
+
+  // the half kernels must agree with the float kernel on the rounded values
+  const int dimension = 131; // covers the vectorized body and the scalar tail
+  std::vector<Eigen::half> a(dimension), b(dimension);
+  std::vector<float> af(dimension), bf(dimension);
+  for(int i = 0; i < dimension; ++i)
+  {
+    a[i] = Eigen::half(0.57f * i - 11.0f);
+    b[i] = Eigen::half(42.0f - 0.91f * i);
+    af[i] = float(a[i]);
+    bf[i] = float(b[i]);
+  }
+  L2_Vectorized<Eigen::half> metricHalf;
+  L2_Vectorized<float> metricFloat;
+  const float distHalf = metricHalf(&a[0], &b[0], dimension);
+  const float distFloat = metricFloat(&af[0], &bf[0], dimension);
+  BOOST_CHECK_SMALL(distHalf - distFloat, 1e-3f * distFloat);
+}
+
 BOOST_AUTO_TEST_CASE(Metric_HAMMING_BITSET)
 {
   std::bitset<8> a(std::string("01010101"));
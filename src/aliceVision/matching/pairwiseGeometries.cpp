@@ -0,0 +1,80 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "aliceVision/matching/pairwiseGeometries.hpp"
+#include <aliceVision/system/Logger.hpp>
+
+#include "dependencies/stlplus3/filesystemSimplified/file_system.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <limits>
+
+namespace aliceVision {
+namespace matching {
+
+bool savePairwiseGeometries(const PairwiseGeometries& geometries,
+                            const std::string& folder,
+                            const std::string& mode)
+{
+  const std::string filepath = stlplus::create_filespec(folder, "geometries." + mode, "txt");
+  std::ofstream stream(filepath.c_str());
+  if(!stream.is_open())
+  {
+    ALICEVISION_LOG_WARNING("savePairwiseGeometries: Impossible to open the output file: \"" << filepath << "\".");
+    return false;
+  }
+  stream << std::setprecision(std::numeric_limits<double>::max_digits10);
+  for(PairwiseGeometries::const_iterator iter = geometries.begin();
+    iter != geometries.end(); ++iter)
+  {
+    const PairGeometry& geometry = iter->second;
+    stream << iter->first.first << ' ' << iter->first.second
+           << ' ' << geometry.model
+           << ' ' << geometry.nbInliers
+           << ' ' << geometry.precision;
+    for(int i = 0; i < 3; ++i)
+      for(int j = 0; j < 3; ++j)
+        stream << ' ' << geometry.matrix(i, j);
+    stream << '\n';
+  }
+  const bool bOk = !stream.bad();
+  stream.close();
+  return bOk;
+}
+
+bool loadPairwiseGeometries(PairwiseGeometries& geometries,
+                            const std::string& folder,
+                            const std::string& mode)
+{
+  const std::string filepath = stlplus::create_filespec(folder, "geometries." + mode, "txt");
+  if(!stlplus::is_file(filepath))
+    return false;
+  std::ifstream stream(filepath.c_str());
+  if(!stream.is_open())
+  {
+    ALICEVISION_LOG_WARNING("loadPairwiseGeometries: Impossible to read the file: \"" << filepath << "\".");
+    return false;
+  }
+  Pair pair;
+  PairGeometry geometry;
+  while(stream >> pair.first >> pair.second
+               >> geometry.model >> geometry.nbInliers >> geometry.precision)
+  {
+    for(int i = 0; i < 3; ++i)
+      for(int j = 0; j < 3; ++j)
+        stream >> geometry.matrix(i, j);
+    if(!stream)
+    {
+      ALICEVISION_LOG_WARNING("loadPairwiseGeometries: Invalid file: \"" << filepath << "\".");
+      return false;
+    }
+    geometries[pair] = geometry;
+  }
+  return true;
+}
+
+} // namespace matching
+} // namespace aliceVision
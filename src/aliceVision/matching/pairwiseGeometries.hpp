@@ -0,0 +1,71 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+#include <aliceVision/numeric/numeric.hpp>
+
+#include <map>
+#include <string>
+
+namespace aliceVision {
+namespace matching {
+
+/**
+ * @brief Geometric model estimated for an image pair during the geometric
+ * filtering of the putative matches.
+ * The filtering step already pays for a robust estimation per pair; keeping
+ * the resulting model allows the SfM pipeline to reuse it as a prior instead
+ * of re-estimating the relative geometry from scratch.
+ */
+struct PairGeometry
+{
+  PairGeometry()
+    : model('\0')
+    , matrix(Mat3::Identity())
+    , precision(0.0)
+    , nbInliers(0)
+  {}
+
+  /// Model type, same convention as the geometric matches file: 'f', 'e' or 'h'
+  char model;
+  /// The estimated model matrix (F, E or H according to \p model)
+  Mat3 matrix;
+  /// A contrario estimated precision of the model (pixels)
+  double precision;
+  /// Number of matches validated by the model
+  std::size_t nbInliers;
+};
+
+/// Estimated geometric model per image pair
+typedef std::map<Pair, PairGeometry> PairwiseGeometries;
+
+/**
+ * @brief Save the per-pair geometric models to a "geometries.<mode>.txt" file
+ * next to the corresponding matches file.
+ * @param[in] geometries The geometric models to save.
+ * @param[in] folder The matches folder.
+ * @param[in] mode The geometric model used for the filtering: "f", "e" or "h".
+ * @return True if everything was ok, otherwise false.
+ */
+bool savePairwiseGeometries(const PairwiseGeometries& geometries,
+                            const std::string& folder,
+                            const std::string& mode);
+
+/**
+ * @brief Load the per-pair geometric models saved by savePairwiseGeometries.
+ * The loaded models are added to \p geometries.
+ * @param[out] geometries The loaded geometric models.
+ * @param[in] folder The matches folder.
+ * @param[in] mode The geometric model used for the filtering: "f", "e" or "h".
+ * @return True if a geometries file exists and has been read, otherwise false.
+ */
+bool loadPairwiseGeometries(PairwiseGeometries& geometries,
+                            const std::string& folder,
+                            const std::string& mode);
+
+} // namespace matching
+} // namespace aliceVision
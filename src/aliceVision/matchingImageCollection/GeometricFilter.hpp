@@ -9,12 +9,16 @@
 #include "aliceVision/feature/PointFeature.hpp"
 #include "aliceVision/feature/RegionsPerView.hpp"
 #include "aliceVision/matching/IndMatch.hpp"
+#include "aliceVision/matching/pairwiseGeometries.hpp"
 #include "aliceVision/matchingImageCollection/GeometricFilterMatrix.hpp"
 
-#include "dependencies/stlplus3/filesystemSimplified/file_system.hpp"
+#include "aliceVision/system/Logger.hpp"
+#include "aliceVision/system/ProgressReporter.hpp"
+#include "aliceVision/system/Timer.hpp"
 
-#include <boost/progress.hpp>
+#include "dependencies/stlplus3/filesystemSimplified/file_system.hpp"
 
+#include <algorithm>
 #include <vector>
 #include <map>
 
@@ -34,20 +38,28 @@ struct GeometricFilter
   {}
 
   /// Perform robust model estimation (with optional guided_matching) for all the pairs and regions correspondences contained in the putative_matches set.
+  /// When maxElapsedSeconds > 0, the pairs are estimated by decreasing putative
+  /// match support and the pairs left once the budget is spent are dropped, so
+  /// the long tail of weakly supported pairs is the one cut off.
   template<typename GeometryFunctor>
   void Robust_model_estimation(
     const GeometryFunctor & functor,
     const PairwiseMatches & putative_matches,
     const bool b_guided_matching = false,
-    const double d_distance_ratio = 0.6
+    const double d_distance_ratio = 0.6,
+    const double maxElapsedSeconds = 0.0
   );
 
   const PairwiseMatches & Get_geometric_matches() const {return _map_GeometricMatches;}
 
+  /// The models estimated for the pairs of Get_geometric_matches()
+  const PairwiseGeometries & Get_geometric_models() const {return _map_GeometricModels;}
+
   // Data
   const sfm::SfMData * _sfm_data;
   const feature::RegionsPerView & _regionsPerView;
   PairwiseMatches _map_GeometricMatches;
+  PairwiseGeometries _map_GeometricModels;
 };
 
 template<typename GeometryFunctor>
@@ -55,15 +67,51 @@ void GeometricFilter::Robust_model_estimation(
   const GeometryFunctor & functor,
   const PairwiseMatches & putative_matches,
   const bool b_guided_matching,
-  const double d_distance_ratio)
+  const double d_distance_ratio,
+  const double maxElapsedSeconds)
 {
-  boost::progress_display my_progress_bar( putative_matches.size() );
-  
+  system::ProgressReporter progress(putative_matches.size(), "Geometric filtering");
+
+  // Process the pairs by decreasing putative match support: the pairs the
+  // most likely to survive the filtering are estimated first and, when a
+  // time budget is set, the weakly supported tail is the part dropped.
+  std::vector<PairwiseMatches::const_iterator> vec_pairs;
+  vec_pairs.reserve(putative_matches.size());
+  for (PairwiseMatches::const_iterator iter = putative_matches.begin();
+    iter != putative_matches.end(); ++iter)
+    vec_pairs.push_back(iter);
+  std::sort(vec_pairs.begin(), vec_pairs.end(),
+    [](PairwiseMatches::const_iterator a, PairwiseMatches::const_iterator b)
+    { return a->second.getNbAllMatches() > b->second.getNbAllMatches(); });
+
+  system::Timer timer;
+  bool timeBudgetSpent = false;
+  std::size_t nbSkippedPairs = 0;
+
   #pragma omp parallel for schedule(dynamic)
-  for (int i = 0; i < (int)putative_matches.size(); ++i)
+  for (int i = 0; i < (int)vec_pairs.size(); ++i)
   {
-    PairwiseMatches::const_iterator iter = putative_matches.begin();
-    advance(iter,i);
+    PairwiseMatches::const_iterator iter = vec_pairs[i];
+
+    if (maxElapsedSeconds > 0.0)
+    {
+      bool skip = false;
+      #pragma omp critical
+      {
+        if (!timeBudgetSpent && timer.elapsed() > maxElapsedSeconds)
+          timeBudgetSpent = true;
+        if (timeBudgetSpent)
+        {
+          ++nbSkippedPairs;
+          skip = true;
+        }
+      }
+      if (skip)
+      {
+        progress.advance();
+        continue;
+      }
+    }
 
     Pair current_pair = iter->first;
     const MatchesPerDescType & putativeMatchesPerType = iter->second;
@@ -83,17 +131,24 @@ void GeometricFilter::Robust_model_estimation(
           //ALICEVISION_LOG_DEBUG("#before/#after: " << putative_inliers.size() << "/" << guided_geometric_inliers.size());
           std::swap(inliers, guided_geometric_inliers);
         }
+        // keep the estimated model so that it can be saved along the matches
+        // and reused as a prior by the SfM pipeline
+        PairGeometry pairGeometry;
+        geometricFilter.getPairGeometry(pairGeometry);
+        pairGeometry.nbInliers = inliers.getNbAllMatches();
         #pragma omp critical
         {
+          _map_GeometricModels.insert(std::make_pair(current_pair, pairGeometry));
           _map_GeometricMatches.insert(std::make_pair(current_pair, std::move(inliers)));
         }
       }
     }
-    #pragma omp critical
-    {
-      ++my_progress_bar;
-    }
+    progress.advance();
   }
+
+  if (nbSkippedPairs > 0)
+    ALICEVISION_LOG_WARNING("Geometric filtering time budget of " << maxElapsedSeconds
+      << "s spent: " << nbSkippedPairs << " weakly supported image pairs skipped.");
 }
 
 } // namespace aliceVision
@@ -14,6 +14,7 @@
 #include <limits>
 
 #include "aliceVision/matching/IndMatch.hpp"
+#include "aliceVision/matching/pairwiseGeometries.hpp"
 #include "aliceVision/sfm/SfMData.hpp"
 #include "aliceVision/feature/RegionsPerView.hpp"
 #include "aliceVision/matchingImageCollection/GeometricFilterMatrix.hpp"
@@ -26,9 +27,13 @@ struct GeometricFilterMatrix_E_AC : public GeometricFilterMatrix
 {
   GeometricFilterMatrix_E_AC(
     double dPrecision = std::numeric_limits<double>::infinity(),
-    size_t iteration = 1024)
+    size_t iteration = 1024,
+    bool prosacSampling = false,
+    double adaptiveConfidence = 0.0)
     : GeometricFilterMatrix(dPrecision, std::numeric_limits<double>::infinity(), iteration)
     , m_E(Mat3::Identity())
+    , m_prosacSampling(prosacSampling)
+    , m_adaptiveConfidence(adaptiveConfidence)
   {}
 
   /**
@@ -91,8 +96,12 @@ struct GeometricFilterMatrix_E_AC : public GeometricFilterMatrix
     // Robustly estimate the Essential matrix with A Contrario ransac
     const double upper_bound_precision = Square(m_dPrecision);
 
+    // Per-pair random stream seeded from the view ids: the estimation of a
+    // pair is reproducible whatever the scheduling of the other pairs
+    std::mt19937 randomGenerator = robustEstimation::createTaskGenerator(pairIndex.first, pairIndex.second);
+
     std::vector<size_t> inliers;
-    const std::pair<double,double> ACRansacOut = ACRANSAC(kernel, inliers, m_stIteration, &m_E, upper_bound_precision);
+    const std::pair<double,double> ACRansacOut = ACRANSAC(kernel, inliers, m_stIteration, &m_E, upper_bound_precision, false, m_prosacSampling, &randomGenerator, m_adaptiveConfidence);
 
     if (inliers.empty())
       return EstimationStatus(false, false);
@@ -162,17 +171,31 @@ struct GeometricFilterMatrix_E_AC : public GeometricFilterMatrix
             aliceVision::fundamental::kernel::EpipolarDistanceError>(
             //aliceVision::fundamental::kernel::SymmetricEpipolarDistanceError>(
         F,
-        cam_I, regionsPerView.getAllRegions(viewId_I),
-        cam_J, regionsPerView.getAllRegions(viewId_J),
+        cam_I, *regionsPerView.getAllRegions(viewId_I),
+        cam_J, *regionsPerView.getAllRegions(viewId_J),
         Square(m_dPrecision_robust), Square(dDistanceRatio),
         matches);
     }
     return matches.getNbAllMatches() != 0;
   }
 
+  /// Export the estimated model so that it can be cached along the matches
+  void getPairGeometry(matching::PairGeometry & geometry) const
+  {
+    geometry.model = 'e';
+    geometry.matrix = m_E;
+    geometry.precision = m_dPrecision_robust;
+  }
+
   //
   //-- Stored data
   Mat3 m_E;
+  /// draw the ACRANSAC samples progressively (PROSAC); requires the putative
+  /// matches to be sorted by decreasing quality
+  bool m_prosacSampling;
+  /// stop the ACRANSAC sampling once this confidence of having drawn an
+  /// all-inlier sample is reached (0: use the full iteration budget)
+  double m_adaptiveConfidence;
 };
 
 } // namespace matchingImageCollection
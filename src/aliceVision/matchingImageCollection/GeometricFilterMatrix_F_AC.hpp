@@ -8,6 +8,7 @@
 #include "aliceVision/matchingImageCollection/GeometricFilterMatrix.hpp"
 #include "aliceVision/matchingImageCollection/geometricFilterUtils.hpp"
 #include "aliceVision/matching/IndMatch.hpp"
+#include "aliceVision/matching/pairwiseGeometries.hpp"
 #include "aliceVision/multiview/fundamentalKernelSolver.hpp"
 #include "aliceVision/multiview/essential.hpp"
 #include "aliceVision/robustEstimation/estimators.hpp"
@@ -29,10 +30,14 @@ struct GeometricFilterMatrix_F_AC: public GeometricFilterMatrix
   GeometricFilterMatrix_F_AC(
     double dPrecision = std::numeric_limits<double>::infinity(),
     size_t iteration = 1024,
-    robustEstimation::ERobustEstimator estimator = robustEstimation::ERobustEstimator::ACRANSAC)
+    robustEstimation::ERobustEstimator estimator = robustEstimation::ERobustEstimator::ACRANSAC,
+    bool prosacSampling = false,
+    double adaptiveConfidence = 0.0)
     : GeometricFilterMatrix(dPrecision, std::numeric_limits<double>::infinity(), iteration)
     , m_F(Mat3::Identity())
     , m_estimator(estimator)
+    , m_prosacSampling(prosacSampling)
+    , m_adaptiveConfidence(adaptiveConfidence)
   {}
 
   /**
@@ -64,12 +69,17 @@ struct GeometricFilterMatrix_F_AC: public GeometricFilterMatrix
     const std::pair<size_t,size_t> imageSizeI(sfmData->GetViews().at(iIndex)->getWidth(), sfmData->GetViews().at(iIndex)->getHeight());
     const std::pair<size_t,size_t> imageSizeJ(sfmData->GetViews().at(jIndex)->getWidth(), sfmData->GetViews().at(jIndex)->getHeight());
 
+    // Per-pair random stream seeded from the view ids: the estimation of a
+    // pair is reproducible whatever the scheduling of the other pairs
+    std::mt19937 randomGenerator = robustEstimation::createTaskGenerator(pairIndex.first, pairIndex.second);
+
     return geometricEstimation(
-        regionsPerView.getDataPerDesc(pairIndex.first), regionsPerView.getDataPerDesc(pairIndex.second),
+        *regionsPerView.getDataPerDesc(pairIndex.first), *regionsPerView.getDataPerDesc(pairIndex.second),
         cam_I, cam_J,
         imageSizeI, imageSizeJ,
         putativeMatchesPerType,
-        out_geometricInliersPerType);
+        out_geometricInliersPerType,
+        &randomGenerator);
   }
 
   /**
@@ -85,7 +95,8 @@ struct GeometricFilterMatrix_F_AC: public GeometricFilterMatrix
       const std::pair<size_t,size_t> & imageSizeI,     // size of the first image
       const std::pair<size_t,size_t> & imageSizeJ,     // size of the first image
       const matching::MatchesPerDescType & putativeMatchesPerType,
-      matching::MatchesPerDescType & out_geometricInliersPerType)
+      matching::MatchesPerDescType & out_geometricInliersPerType,
+      std::mt19937 * randomGenerator = nullptr)
   {
     using namespace aliceVision;
     using namespace aliceVision::robustEstimation;
@@ -107,7 +118,8 @@ struct GeometricFilterMatrix_F_AC: public GeometricFilterMatrix
         xI, xJ,
         imageSizeI,
         imageSizeJ,
-        inliers);
+        inliers,
+        randomGenerator);
 
     if (!estimationPair.first) // estimation is not valid
     {
@@ -144,12 +156,18 @@ struct GeometricFilterMatrix_F_AC: public GeometricFilterMatrix
     const Mat& xJ,       // points of the second image
     const std::pair<size_t,size_t> & imageSizeI,     // size of the first image  
     const std::pair<size_t,size_t> & imageSizeJ,     // size of the first image
-    std::vector<size_t> & out_inliers)
+    std::vector<size_t> & out_inliers,
+    std::mt19937 * randomGenerator = nullptr)
   {
     using namespace aliceVision;
     using namespace aliceVision::robustEstimation;
     out_inliers.clear();
 
+    // Normalize the point sets once for the pair, whatever the number of
+    // kernels built from them
+    m_normalizationCache.normalize(xI, imageSizeI.first, imageSizeI.second,
+                                   xJ, imageSizeJ.first, imageSizeJ.second);
+
     switch(m_estimator)
     {
       case ERobustEstimator::ACRANSAC:
@@ -163,14 +181,12 @@ struct GeometricFilterMatrix_F_AC: public GeometricFilterMatrix
           Mat3>
           KernelType;
 
-        const KernelType kernel(
-          xI, imageSizeI.first, imageSizeI.second,
-          xJ, imageSizeJ.first, imageSizeJ.second, true);
+        const KernelType kernel(m_normalizationCache, imageSizeJ.first, imageSizeJ.second, true);
 
         // Robustly estimate the Fundamental matrix with A Contrario ransac
         const double upper_bound_precision = Square(m_dPrecision);
         const std::pair<double,double> ACRansacOut =
-          ACRANSAC(kernel, out_inliers, m_stIteration, &m_F, upper_bound_precision);
+          ACRANSAC(kernel, out_inliers, m_stIteration, &m_F, upper_bound_precision, false, m_prosacSampling, randomGenerator, m_adaptiveConfidence);
 
         if(out_inliers.empty())
           return std::make_pair(false, KernelType::MINIMUM_SAMPLES);
@@ -195,14 +211,13 @@ struct GeometricFilterMatrix_F_AC: public GeometricFilterMatrix
                 aliceVision::fundamental::kernel::EightPointSolver>
                 KernelType;
 
-        const KernelType kernel(xI, imageSizeI.first, imageSizeI.second,
-                                xJ, imageSizeJ.first, imageSizeJ.second, true);
+        const KernelType kernel(m_normalizationCache, imageSizeJ.first, imageSizeJ.second, true);
 
         //@fixme scorer should be using the pixel error, not the squared version, refactoring needed
         const double normalizedThreshold = Square(m_dPrecision * kernel.normalizer2()(0, 0));
         ScoreEvaluator<KernelType> scorer(normalizedThreshold);
 
-        m_F = LO_RANSAC(kernel, scorer, &out_inliers);
+        m_F = LO_RANSAC(kernel, scorer, &out_inliers, NULL, false, 100, 1e-2, randomGenerator);
 
         if(out_inliers.empty())
           return std::make_pair(false, KernelType::MINIMUM_SAMPLES);
@@ -255,19 +270,36 @@ struct GeometricFilterMatrix_F_AC: public GeometricFilterMatrix
                                      fundamental::kernel::EpipolarDistanceError>(
         m_F,
         cam_I, // camera::IntrinsicBase
-        regionsPerView.getAllRegions(viewId_I), // feature::Regions
+        *regionsPerView.getAllRegions(viewId_I), // feature::Regions
         cam_J, // camera::IntrinsicBase
-        regionsPerView.getAllRegions(viewId_J), // feature::Regions
+        *regionsPerView.getAllRegions(viewId_J), // feature::Regions
         Square(m_dPrecision_robust), Square(dDistanceRatio),
         matches);
     }
     return matches.getNbAllMatches() != 0;
   }
-  
+
+  /// Export the estimated model so that it can be cached along the matches
+  void getPairGeometry(matching::PairGeometry & geometry) const
+  {
+    geometry.model = 'f';
+    geometry.matrix = m_F;
+    geometry.precision = m_dPrecision_robust;
+  }
+
   //
   //-- Stored data
   Mat3 m_F;
   robustEstimation::ERobustEstimator m_estimator;
+  /// normalized coordinates of the current pair, shared by all the kernels
+  /// built for it
+  robustEstimation::PointNormalizationCache m_normalizationCache;
+  /// draw the ACRANSAC samples progressively (PROSAC); requires the putative
+  /// matches to be sorted by decreasing quality
+  bool m_prosacSampling;
+  /// stop the ACRANSAC sampling once this confidence of having drawn an
+  /// all-inlier sample is reached (0: use the full iteration budget)
+  double m_adaptiveConfidence;
 };
 
 } // namespace matchingImageCollection
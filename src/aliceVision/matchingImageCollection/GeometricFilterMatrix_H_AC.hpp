@@ -12,6 +12,7 @@
 
 #include "aliceVision/matching/IndMatch.hpp"
 #include "aliceVision/matching/IndMatchDecorator.hpp"
+#include "aliceVision/matching/pairwiseGeometries.hpp"
 #include "aliceVision/sfm/SfMData.hpp"
 #include "aliceVision/feature/RegionsPerView.hpp"
 #include "aliceVision/matchingImageCollection/GeometricFilterMatrix.hpp"
@@ -24,9 +25,13 @@ struct GeometricFilterMatrix_H_AC : public GeometricFilterMatrix
 {
   GeometricFilterMatrix_H_AC(
     double dPrecision = std::numeric_limits<double>::infinity(),
-    size_t iteration = 1024)
+    size_t iteration = 1024,
+    bool prosacSampling = false,
+    double adaptiveConfidence = 0.0)
     : GeometricFilterMatrix(dPrecision, std::numeric_limits<double>::infinity(), iteration)
     , m_H(Mat3::Identity())
+    , m_prosacSampling(prosacSampling)
+    , m_adaptiveConfidence(adaptiveConfidence)
   {}
 
   /**
@@ -57,24 +62,36 @@ struct GeometricFilterMatrix_H_AC : public GeometricFilterMatrix
     Mat xI, xJ;
     MatchesPairToMat(pairIndex, putativeMatchesPerType, sfmData, regionsPerView, descTypes, xI, xJ);
 
-    // Define the AContrario adapted Homography matrix solver
+    // Define the AContrario adapted Homography matrix solver. The cheirality
+    // variant drops hypotheses mapping part of their sample behind the
+    // camera before they are scored against all the putative matches.
     typedef ACKernelAdaptor<
-        aliceVision::homography::kernel::FourPointSolver,
+        aliceVision::homography::kernel::FourPointSolverCheirality,
         aliceVision::homography::kernel::AsymmetricError,
         UnnormalizerI,
         Mat3>
         KernelType;
 
-    KernelType kernel(
+    // Normalize the point sets once for the pair, whatever the number of
+    // kernels built from them
+    m_normalizationCache.normalize(
       xI, sfmData->GetViews().at(iIndex)->getWidth(), sfmData->GetViews().at(iIndex)->getHeight(),
-      xJ, sfmData->GetViews().at(jIndex)->getWidth(), sfmData->GetViews().at(jIndex)->getHeight(),
+      xJ, sfmData->GetViews().at(jIndex)->getWidth(), sfmData->GetViews().at(jIndex)->getHeight());
+
+    KernelType kernel(
+      m_normalizationCache,
+      sfmData->GetViews().at(jIndex)->getWidth(), sfmData->GetViews().at(jIndex)->getHeight(),
       false); // configure as point to point error model.
 
     // Robustly estimate the Homography matrix with A Contrario ransac
     const double upper_bound_precision = Square(m_dPrecision);
 
+    // Per-pair random stream seeded from the view ids: the estimation of a
+    // pair is reproducible whatever the scheduling of the other pairs
+    std::mt19937 randomGenerator = robustEstimation::createTaskGenerator(pairIndex.first, pairIndex.second);
+
     std::vector<size_t> inliers;
-    const std::pair<double,double> ACRansacOut = ACRANSAC(kernel, inliers, m_stIteration, &m_H, upper_bound_precision);
+    const std::pair<double,double> ACRansacOut = ACRANSAC(kernel, inliers, m_stIteration, &m_H, upper_bound_precision, false, m_prosacSampling, &randomGenerator, m_adaptiveConfidence);
 
     if (inliers.empty())
       return EstimationStatus(false, false);
@@ -111,11 +128,15 @@ struct GeometricFilterMatrix_H_AC : public GeometricFilterMatrix
 
     if (hasValidIntrinsics)
     {
+      // fill the raw coordinates, then undistort the whole block at once:
+      // the distortion inversion is vectorized and shared between the points
+      Mat2X pts(2, vec_feats.size());
       for( feature::PointFeatures::const_iterator iter = vec_feats.begin();
         iter != vec_feats.end(); ++iter, ++i)
       {
-          m.col(i) = cam->get_ud_pixel(Vec2(iter->x(), iter->y()));
+          pts.col(i) << iter->x(), iter->y();
       }
+      m = cam->get_ud_pixel_many(pts).cast<Scalar>();
     }
     else
     {
@@ -211,8 +232,10 @@ struct GeometricFilterMatrix_H_AC : public GeometricFilterMatrix
           assert(descType != feature::EImageDescriberType::UNINITIALIZED);
           matching::IndMatches localMatches;
 
-          const feature::Regions& regions_I = regionsPerView.getRegions(viewId_I, descType);
-          const feature::Regions& regions_J = regionsPerView.getRegions(viewId_J, descType);
+          const feature::RegionsHandle regionsHandle_I = regionsPerView.getRegions(viewId_I, descType);
+          const feature::RegionsHandle regionsHandle_J = regionsPerView.getRegions(viewId_J, descType);
+          const feature::Regions& regions_I = *regionsHandle_I;
+          const feature::Regions& regions_J = *regionsHandle_J;
           const feature::PointFeatures pointsFeaturesI = regions_I.GetRegionsPositions();
           const feature::PointFeatures pointsFeaturesJ = regions_J.GetRegionsPositions();
 
@@ -237,8 +260,8 @@ struct GeometricFilterMatrix_H_AC : public GeometricFilterMatrix
         robustEstimation::GuidedMatching
           <Mat3, aliceVision::homography::kernel::AsymmetricError>(
           m_H,
-          cam_I, regionsPerView.getAllRegions(viewId_I),
-          cam_J, regionsPerView.getAllRegions(viewId_J),
+          cam_I, *regionsPerView.getAllRegions(viewId_I),
+          cam_J, *regionsPerView.getAllRegions(viewId_J),
           Square(m_dPrecision_robust), Square(dDistanceRatio),
           matches);
       }
@@ -246,9 +269,26 @@ struct GeometricFilterMatrix_H_AC : public GeometricFilterMatrix
     return matches.getNbAllMatches() != 0;
   }
 
+  /// Export the estimated model so that it can be cached along the matches
+  void getPairGeometry(matching::PairGeometry & geometry) const
+  {
+    geometry.model = 'h';
+    geometry.matrix = m_H;
+    geometry.precision = m_dPrecision_robust;
+  }
+
   //
   //-- Stored data
   Mat3 m_H;
+  /// normalized coordinates of the current pair, shared by all the kernels
+  /// built for it
+  robustEstimation::PointNormalizationCache m_normalizationCache;
+  /// draw the ACRANSAC samples progressively (PROSAC); requires the putative
+  /// matches to be sorted by decreasing quality
+  bool m_prosacSampling;
+  /// stop the ACRANSAC sampling once this confidence of having drawn an
+  /// all-inlier sample is reached (0: use the full iteration budget)
+  double m_adaptiveConfidence;
 };
 
 } // namespace matchingImageCollection
@@ -9,9 +9,9 @@
 #include "aliceVision/matching/filters.hpp"
 #include <aliceVision/config.hpp>
 
-#include "dependencies/stlplus3/filesystemSimplified/file_system.hpp"
+#include <aliceVision/system/ProgressReporter.hpp>
 
-#include <boost/progress.hpp>
+#include "dependencies/stlplus3/filesystemSimplified/file_system.hpp"
 
 namespace aliceVision {
 namespace matchingImageCollection {
@@ -39,7 +39,7 @@ void Match
   PairwiseMatches & map_PutativesMatches // the pairwise photometric corresponding points
 )
 {
-  boost::progress_display my_progress_bar( pairs.size() );
+  system::ProgressReporter progress(pairs.size(), "Cascade hashing matching");
 
   // Collect used view indexes
   std::set<IndexT> used_index;
@@ -60,7 +60,8 @@ void Match
   if (!used_index.empty())
   {
     const IndexT I = *used_index.begin();
-    const feature::Regions &regionsI = regionsPerView.getRegions(I, descType);
+    const feature::RegionsHandle regionsIHandle = regionsPerView.getRegions(I, descType);
+    const feature::Regions &regionsI = *regionsIHandle;
     const size_t dimension = regionsI.DescriptorLength();
     cascade_hasher.Init(dimension);
   }
@@ -76,7 +77,8 @@ void Match
       std::set<IndexT>::const_iterator iter = used_index.begin();
       std::advance(iter, i);
       const IndexT I = *iter;
-      const feature::Regions &regionsI = regionsPerView.getRegions(I, descType);
+      const feature::RegionsHandle regionsIHandle = regionsPerView.getRegions(I, descType);
+      const feature::Regions &regionsI = *regionsIHandle;
       const ScalarT * tabI =
         reinterpret_cast<const ScalarT*>(regionsI.DescriptorRawData());
       const size_t dimension = regionsI.DescriptorLength();
@@ -101,7 +103,8 @@ void Match
     std::set<IndexT>::const_iterator iter = used_index.begin();
     std::advance(iter, i);
     const IndexT I = *iter;
-    const feature::Regions &regionsI = regionsPerView.getRegions(I, descType);
+    const feature::RegionsHandle regionsIHandle = regionsPerView.getRegions(I, descType);
+    const feature::Regions &regionsI = *regionsIHandle;
     const ScalarT * tabI =
       reinterpret_cast<const ScalarT*>(regionsI.DescriptorRawData());
     const size_t dimension = regionsI.DescriptorLength();
@@ -122,10 +125,12 @@ void Match
     const IndexT I = iter->first;
     const std::vector<IndexT> & indexToCompare = iter->second;
 
-    const feature::Regions &regionsI = regionsPerView.getRegions(I, descType);
+    const feature::RegionsHandle regionsIHandle = regionsPerView.getRegions(I, descType);
+
+    const feature::Regions &regionsI = *regionsIHandle;
     if (regionsI.RegionCount() == 0)
     {
-      my_progress_bar += indexToCompare.size();
+      progress.advance(indexToCompare.size());
       continue;
     }
 
@@ -138,13 +143,13 @@ void Match
     for (int j = 0; j < (int)indexToCompare.size(); ++j)
     {
       size_t J = indexToCompare[j];
-      const feature::Regions &regionsJ = regionsPerView.getRegions(I, descType);
+      const feature::RegionsHandle regionsJHandle = regionsPerView.getRegions(I, descType);
+      const feature::Regions &regionsJ = *regionsJHandle;
 
       if (!regionsPerView.viewExist(J)
           || regionsI.Type_id() != regionsJ.Type_id())
       {
-        #pragma omp critical
-        ++my_progress_bar;
+        progress.advance();
         continue;
       }
 
@@ -189,14 +194,12 @@ void Match
 
       // Remove matches that have the same (X,Y) coordinates
       const std::vector<feature::PointFeature> pointFeaturesJ = regionsJ.GetRegionsPositions();
-      matching::IndMatchDecorator<float> matchDeduplicator(vec_putative_matches,
-        pointFeaturesI, pointFeaturesJ);
-      matchDeduplicator.getDeduplicated(vec_putative_matches);
+      matching::removeDuplicateMatchPositions(pointFeaturesI, pointFeaturesJ, vec_putative_matches);
 
-      #pragma omp critical
+      progress.advance();
+      if (!vec_putative_matches.empty())
       {
-        ++my_progress_bar;
-        if (!vec_putative_matches.empty())
+        #pragma omp critical
         {
           assert(map_PutativesMatches.count(std::make_pair(I,J)) == 0);
           map_PutativesMatches[std::make_pair(I,J)].emplace(descType, std::move(vec_putative_matches));
@@ -247,6 +250,16 @@ void ImageCollectionMatcher_cascadeHashing::Match
       map_PutativesMatches);
   }
   else
+  if(regions.Type_id() == typeid(Eigen::half).name())
+  {
+    impl::Match<Eigen::half>(
+      regionsPerView,
+      pairs,
+      descType,
+      f_dist_ratio_,
+      map_PutativesMatches);
+  }
+  else
   {
     ALICEVISION_LOG_WARNING("Matcher not implemented for this region type");
   }
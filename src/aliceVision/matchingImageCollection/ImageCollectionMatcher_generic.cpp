@@ -9,11 +9,18 @@
 #include <aliceVision/matching/ArrayMatcher_cascadeHashing.hpp>
 #include <aliceVision/matching/RegionsMatcher.hpp>
 #include <aliceVision/matchingImageCollection/IImageCollectionMatcher.hpp>
+#include <aliceVision/feature/selection.hpp>
+#include <aliceVision/system/ProgressReporter.hpp>
+#include <aliceVision/system/TaskScheduler.hpp>
 #include <aliceVision/config.hpp>
 
 #include <dependencies/stlplus3/filesystemSimplified/file_system.hpp>
 
-#include <boost/progress.hpp>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace aliceVision {
 namespace matchingImageCollection {
@@ -21,11 +28,61 @@ namespace matchingImageCollection {
 using namespace aliceVision::matching;
 using namespace aliceVision::feature;
 
+namespace {
+
+// Fraction of the features matched in the first stage of the cascade
+const double cascadeFraction = 0.1;
+// Below this geometric support the pair is discarded without full matching
+const std::size_t cascadeRejectSupport = 8;
+// Above this geometric support the subset matches are kept as-is
+const std::size_t cascadeAcceptSupport = 50;
+
+/**
+ * @brief Cheap geometric verification of a set of putative matches: the
+ * matches vote for the relative orientation and log scale ratio of their
+ * features, and the support is the population of the best bin. Matches of a
+ * real epipolar geometry agree on a narrow band of both values while
+ * mismatches vote uniformly, so the peak separates connected pairs from
+ * unconnected ones without estimating a model.
+ */
+std::size_t similarityVotingSupport(const matching::IndMatches& matches,
+                                    const std::vector<feature::SIOPointFeature>& featsI,
+                                    const std::vector<feature::SIOPointFeature>& featsJ)
+{
+  const std::size_t nbOrientationBins = 12;  // 30 degree bins
+  const std::size_t nbScaleBins = 16;        // half octave bins over [-4, 4)
+
+  std::vector<std::size_t> histogram(nbOrientationBins * nbScaleBins, 0);
+  std::size_t support = 0;
+  for(const matching::IndMatch& match: matches)
+  {
+    const feature::SIOPointFeature& fI = featsI[match._i];
+    const feature::SIOPointFeature& fJ = featsJ[match._j];
+
+    double orientationDiff = (fJ.orientation() - fI.orientation()) / (2.0 * M_PI);
+    orientationDiff -= std::floor(orientationDiff);  // wrap to [0, 1)
+    const std::size_t orientationBin =
+        std::min<std::size_t>(orientationDiff * nbOrientationBins, nbOrientationBins - 1);
+
+    const double logScaleRatio = std::log2(double(fJ.scale()) / double(fI.scale()));
+    const std::size_t scaleBin = clamp((logScaleRatio + 4.0) * 2.0, 0.0, double(nbScaleBins - 1));
+
+    std::size_t& bin = histogram[orientationBin * nbScaleBins + scaleBin];
+    ++bin;
+    support = std::max(support, bin);
+  }
+  return support;
+}
+
+} // namespace
+
 ImageCollectionMatcher_generic::ImageCollectionMatcher_generic(
-  float distRatio, EMatcherType matcherType)
+  float distRatio, EMatcherType matcherType, bool crossMatching, bool cascadeMatching)
   : IImageCollectionMatcher()
   , _f_dist_ratio(distRatio)
   , _matcherType(matcherType)
+  , _crossMatching(crossMatching)
+  , _cascadeMatching(cascadeMatching)
 {
 }
 
@@ -35,65 +92,165 @@ void ImageCollectionMatcher_generic::Match(
   feature::EImageDescriberType descType,
   matching::PairwiseMatches & map_PutativesMatches)const // the pairwise photometric corresponding points
 {
-#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_OPENMP)
-  ALICEVISION_LOG_DEBUG("Using the OPENMP thread interface");
-#endif
-  const bool b_multithreaded_pair_search = (_matcherType == CASCADE_HASHING_L2);
-  // -> set to true for CASCADE_HASHING_L2, since OpenMP instructions are not used in this matcher
-
-  boost::progress_display my_progress_bar( pairs.size() );
-
-  // Sort pairs according the first index to minimize the MatcherT build operations
-  typedef std::map<size_t, std::vector<size_t> > Map_vectorT;
-  Map_vectorT map_Pairs;
-  for (PairSet::const_iterator iter = pairs.begin(); iter != pairs.end(); ++iter)
+  ALICEVISION_LOG_DEBUG("Using the process-wide task scheduler ("
+                        << system::TaskScheduler::instance().nbThreads() << " threads)");
+  system::ProgressReporter progress(pairs.size(), "Feature matching");
+
+  // Each pair is an independent task scheduled dynamically, so a few
+  // feature-rich left images cannot serialize the tail of the run.
+  // The trained matcher of a left image is built once on first use and
+  // shared by all the tasks referencing it.
+  struct LeftImageMatcher
+  {
+    std::once_flag onceFlag;
+    // keeps the left regions alive for the lifetime of the trained matcher,
+    // which stores a reference on them (the lazy container may evict them)
+    feature::RegionsHandle regions;
+    std::unique_ptr<matching::RegionsDatabaseMatcher> matcher;
+    // trained on the feature subset of the left image (cascade mode)
+    std::once_flag subsetOnceFlag;
+    std::unique_ptr<matching::RegionsDatabaseMatcher> subsetMatcher;
+  };
+
+  // In cascade mode every view also carries its strongest-feature subset,
+  // built once on first use and shared by all the pairs referencing it.
+  // The regions stay null when the view has no oriented scale-invariant
+  // features or too few features for the subset stage to pay off.
+  struct ViewSubset
+  {
+    std::once_flag onceFlag;
+    std::vector<IndexT> indices; // subset index -> full set index
+    std::unique_ptr<feature::Regions> regions;
+  };
+
+  // Flat task list: the pairs are already sorted by left image, which keeps
+  // tasks sharing a trained matcher close to each other in the schedule.
+  const std::vector<Pair> tasks(pairs.begin(), pairs.end());
+
+  // Pre-build the left image entries: the map is read-only during matching.
+  std::map<size_t, LeftImageMatcher> leftMatchers;
+  for (const Pair& pair : pairs)
+    leftMatchers[pair.first];
+
+  std::map<size_t, ViewSubset> viewSubsets;
+  if (_cascadeMatching)
   {
-    map_Pairs[iter->first].push_back(iter->second);
+    for (const Pair& pair : pairs)
+    {
+      viewSubsets[pair.first];
+      viewSubsets[pair.second];
+    }
   }
 
-  // Perform matching between all the pairs
-  for (Map_vectorT::const_iterator iter = map_Pairs.begin();
-    iter != map_Pairs.end(); ++iter)
+  auto ensureSubset = [](ViewSubset& subset, const feature::Regions& regions)
   {
-    const size_t I = iter->first;
-    const std::vector<size_t> & indexToCompare = iter->second;
+    std::call_once(subset.onceFlag, [&]()
+    {
+      const std::vector<SIOPointFeature>& features = getSIOPointFeatures(regions);
+      if (features.empty())
+        return;
+      const std::size_t count = std::max<std::size_t>(1, std::ceil(features.size() * cascadeFraction));
+      if (count * 2 >= features.size())
+        return;
+      selectGridDistributedFeatures(features, count, subset.indices);
+      subset.regions.reset(regions.EmptyClone());
+      for (IndexT index : subset.indices)
+        regions.CopyRegion(index, subset.regions.get());
+    });
+  };
 
-    const feature::Regions & regionsI = regionsPerView.getRegions(I, descType);
-    if (regionsI.RegionCount() == 0)
+  std::mutex resultsMutex;
+  system::TaskScheduler::instance().parallelFor(0, tasks.size(), [&](std::size_t t)
+  {
+    const size_t I = tasks[t].first;
+    const size_t J = tasks[t].second;
+
+    const feature::RegionsHandle regionsIHandle = regionsPerView.getRegions(I, descType);
+    const feature::RegionsHandle regionsJHandle = regionsPerView.getRegions(J, descType);
+    const feature::Regions & regionsI = *regionsIHandle;
+    const feature::Regions & regionsJ = *regionsJHandle;
+
+    if (regionsI.RegionCount() == 0
+        || regionsJ.RegionCount() == 0
+        || regionsI.Type_id() != regionsJ.Type_id())
     {
-      my_progress_bar += indexToCompare.size();
-      continue;
+      progress.advance();
+      return;
     }
 
-    // Initialize the matching interface
-    matching::RegionsDatabaseMatcher matcher(_matcherType, regionsI);
+    LeftImageMatcher & left = leftMatchers.at(I);
 
-    #pragma omp parallel for schedule(dynamic) if(b_multithreaded_pair_search)
-    for (int j = 0; j < (int)indexToCompare.size(); ++j)
+    if (_cascadeMatching)
     {
-      const size_t J = indexToCompare[j];
+      ViewSubset & subsetI = viewSubsets.at(I);
+      ViewSubset & subsetJ = viewSubsets.at(J);
+      ensureSubset(subsetI, regionsI);
+      ensureSubset(subsetJ, regionsJ);
 
-      const feature::Regions &regionsJ = regionsPerView.getRegions(J, descType);
-      if (regionsJ.RegionCount() == 0
-          || regionsI.Type_id() != regionsJ.Type_id())
+      if (subsetI.regions && subsetJ.regions)
       {
-        #pragma omp critical
-        ++my_progress_bar;
-        continue;
-      }
+        std::call_once(left.subsetOnceFlag, [&]()
+        {
+          left.subsetMatcher.reset(new matching::RegionsDatabaseMatcher(_matcherType, *subsetI.regions));
+        });
 
-      IndMatches vec_putatives_matches;
-      matcher.Match(_f_dist_ratio, regionsJ, vec_putatives_matches);
-      #pragma omp critical
-      {
-        ++my_progress_bar;
-        if (!vec_putatives_matches.empty())
+        IndMatches subsetMatches;
+        if (_crossMatching)
+          left.subsetMatcher->MatchSymmetric(_f_dist_ratio, *subsetJ.regions, nullptr, subsetMatches);
+        else
+          left.subsetMatcher->Match(_f_dist_ratio, *subsetJ.regions, subsetMatches);
+
+        const std::size_t support = similarityVotingSupport(subsetMatches,
+            getSIOPointFeatures(*subsetI.regions), getSIOPointFeatures(*subsetJ.regions));
+
+        if (support < cascadeRejectSupport || support >= cascadeAcceptSupport)
         {
-          map_PutativesMatches[std::make_pair(I,J)].emplace(descType, std::move(vec_putatives_matches));
+          // The pair is decidable from the subset: either there is no
+          // geometric support and it is dropped, or the support is strong
+          // and the subset matches are kept as the putative matches.
+          if (support >= cascadeAcceptSupport)
+          {
+            for (IndMatch& match : subsetMatches)
+            {
+              match._i = subsetI.indices[match._i];
+              match._j = subsetJ.indices[match._j];
+            }
+          }
+          else
+          {
+            subsetMatches.clear();
+          }
+          progress.advance();
+          if (!subsetMatches.empty())
+          {
+            std::lock_guard<std::mutex> lock(resultsMutex);
+            map_PutativesMatches[std::make_pair(I,J)].emplace(descType, std::move(subsetMatches));
+          }
+          return;
         }
+        // ambiguous pair: fall back to full-set matching
       }
     }
-  }
+
+    // Initialize the matching interface, once per left image
+    std::call_once(left.onceFlag, [&]()
+    {
+      left.regions = regionsIHandle;
+      left.matcher.reset(new matching::RegionsDatabaseMatcher(_matcherType, *left.regions));
+    });
+
+    IndMatches vec_putatives_matches;
+    if (_crossMatching)
+      left.matcher->MatchSymmetric(_f_dist_ratio, regionsJ, nullptr, vec_putatives_matches);
+    else
+      left.matcher->Match(_f_dist_ratio, regionsJ, vec_putatives_matches);
+    progress.advance();
+    if (!vec_putatives_matches.empty())
+    {
+      std::lock_guard<std::mutex> lock(resultsMutex);
+      map_PutativesMatches[std::make_pair(I,J)].emplace(descType, std::move(vec_putatives_matches));
+    }
+  });
 }
 
 } // namespace aliceVision
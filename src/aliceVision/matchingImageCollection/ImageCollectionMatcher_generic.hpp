@@ -21,9 +21,25 @@ namespace matchingImageCollection {
 class ImageCollectionMatcher_generic : public IImageCollectionMatcher
 {
   public:
+  /**
+   * @param[in] dist_ratio Distance ratio used to discard spurious correspondence.
+   * @param[in] matcherType The type of matcher to use.
+   * @param[in] crossMatching If true, the candidate matches are additionally
+   * cross-checked so each left feature is matched at most once (one-to-one
+   * matches). The cross-check reuses the distances of the forward search.
+   * @param[in] cascadeMatching If true, each pair is first matched on a small
+   * subset of the strongest features, spread over the image grid (see
+   * feature::selectGridDistributedFeatures). Pairs whose subset matches show
+   * clear geometric support keep them as putative matches, pairs without any
+   * support are discarded, and only the ambiguous pairs fall back to full-set
+   * matching. Requires oriented scale-invariant features; region types without
+   * them are always matched on the full sets.
+   */
   ImageCollectionMatcher_generic(
     float dist_ratio,
-    matching::EMatcherType matcherType
+    matching::EMatcherType matcherType,
+    bool crossMatching = false,
+    bool cascadeMatching = false
   );
 
   /// Find corresponding points between some pair of view Ids
@@ -39,6 +55,10 @@ class ImageCollectionMatcher_generic : public IImageCollectionMatcher
   float _f_dist_ratio;
   // Matcher Type
   matching::EMatcherType _matcherType;
+  // Cross-check the matches (one-to-one matches)
+  bool _crossMatching;
+  // Match a strong feature subset first, full sets only for ambiguous pairs
+  bool _cascadeMatching;
 };
 
 } // namespace aliceVision
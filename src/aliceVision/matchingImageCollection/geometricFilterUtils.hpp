@@ -49,11 +49,14 @@ void fillMatricesWithUndistortFeaturesMatches(
 
   if (I_hasValidIntrinsics)
   {
+    // gather the raw positions, then undistort the whole block at once:
+    // the distortion inversion is vectorized and shared between the points
+    Mat2X pts_I(2, putativeMatches.size());
     for (size_t i=0; i < putativeMatches.size(); ++i)
     {
-      const Vec2 pt_I = getFeaturePosition(feature_I, putativeMatches[i]._i);
-      x_I.col(i) = cam_I->get_ud_pixel(pt_I);
+      pts_I.col(i) = getFeaturePosition(feature_I, putativeMatches[i]._i);
     }
+    x_I = cam_I->get_ud_pixel_many(pts_I).cast<Scalar>();
   }
   else
   {
@@ -65,11 +68,12 @@ void fillMatricesWithUndistortFeaturesMatches(
   }
   if (J_hasValidIntrinsics)
   {
+    Mat2X pts_J(2, putativeMatches.size());
     for (size_t i=0; i < putativeMatches.size(); ++i)
     {
-      const Vec2 pt_J = getFeaturePosition(feature_J, putativeMatches[i]._j);
-      x_J.col(i) = cam_J->get_ud_pixel(pt_J);
+      pts_J.col(i) = getFeaturePosition(feature_J, putativeMatches[i]._j);
     }
+    x_J = cam_J->get_ud_pixel_many(pts_J).cast<Scalar>();
   }
   else
   {
@@ -165,8 +169,8 @@ void MatchesPairToMat(
       putativeMatchesPerType,
       cam_I,
       cam_J,
-      regionsPerView.getRegionsPerDesc(pairIndex.first),
-      regionsPerView.getRegionsPerDesc(pairIndex.second),
+      *regionsPerView.getRegionsPerDesc(pairIndex.first),
+      *regionsPerView.getRegionsPerDesc(pairIndex.second),
       descTypes,
       x_I, x_J);
 }
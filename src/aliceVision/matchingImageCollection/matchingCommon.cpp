@@ -8,6 +8,8 @@
 #include "aliceVision/matchingImageCollection/ImageCollectionMatcher_generic.hpp"
 #include "aliceVision/matchingImageCollection/ImageCollectionMatcher_cascadeHashing.hpp"
 
+#include <aliceVision/system/Logger.hpp>
+
 #include <exception>
 #include <cassert>
 
@@ -15,18 +17,26 @@ namespace aliceVision {
 namespace matchingImageCollection {
   
 
-std::unique_ptr<IImageCollectionMatcher> createImageCollectionMatcher(matching::EMatcherType matcherType, float distRatio)
+std::unique_ptr<IImageCollectionMatcher> createImageCollectionMatcher(matching::EMatcherType matcherType, float distRatio, bool crossMatching, bool cascadeMatching)
 {
   std::unique_ptr<IImageCollectionMatcher> matcherPtr;
-  
+
+  if(crossMatching && matcherType == matching::FAST_CASCADE_HASHING_L2)
+    ALICEVISION_LOG_WARNING("Cross matching is not implemented for FAST_CASCADE_HASHING_L2, the option is ignored.");
+
+  if(cascadeMatching && matcherType == matching::FAST_CASCADE_HASHING_L2)
+    ALICEVISION_LOG_WARNING("Cascade matching is not implemented for FAST_CASCADE_HASHING_L2, the option is ignored.");
+
   switch(matcherType)
   {
-    case matching::BRUTE_FORCE_L2:          matcherPtr.reset(new ImageCollectionMatcher_generic(distRatio, matching::BRUTE_FORCE_L2)); break;
-    case matching::ANN_L2:                  matcherPtr.reset(new ImageCollectionMatcher_generic(distRatio, matching::ANN_L2)); break;
-    case matching::CASCADE_HASHING_L2:      matcherPtr.reset(new ImageCollectionMatcher_generic(distRatio, matching::CASCADE_HASHING_L2)); break;
+    case matching::BRUTE_FORCE_L2:          matcherPtr.reset(new ImageCollectionMatcher_generic(distRatio, matching::BRUTE_FORCE_L2, crossMatching, cascadeMatching)); break;
+    case matching::ANN_L2:                  matcherPtr.reset(new ImageCollectionMatcher_generic(distRatio, matching::ANN_L2, crossMatching, cascadeMatching)); break;
+    case matching::CASCADE_HASHING_L2:      matcherPtr.reset(new ImageCollectionMatcher_generic(distRatio, matching::CASCADE_HASHING_L2, crossMatching, cascadeMatching)); break;
     case matching::FAST_CASCADE_HASHING_L2: matcherPtr.reset(new ImageCollectionMatcher_cascadeHashing(distRatio)); break;
-    case matching::BRUTE_FORCE_HAMMING:     matcherPtr.reset(new ImageCollectionMatcher_generic(distRatio, matching::BRUTE_FORCE_HAMMING)); break;
-    
+    case matching::HNSW_L2:                 matcherPtr.reset(new ImageCollectionMatcher_generic(distRatio, matching::HNSW_L2, crossMatching, cascadeMatching)); break;
+    case matching::BRUTE_FORCE_CUDA_L2:     matcherPtr.reset(new ImageCollectionMatcher_generic(distRatio, matching::BRUTE_FORCE_CUDA_L2, crossMatching, cascadeMatching)); break;
+    case matching::BRUTE_FORCE_HAMMING:     matcherPtr.reset(new ImageCollectionMatcher_generic(distRatio, matching::BRUTE_FORCE_HAMMING, crossMatching, cascadeMatching)); break;
+
     default: throw std::out_of_range("Invalid matcherType enum");
   }
   assert(matcherPtr != nullptr);
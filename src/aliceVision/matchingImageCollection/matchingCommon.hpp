@@ -12,11 +12,16 @@ namespace aliceVision {
 namespace matchingImageCollection {
   
 /**
- * 
+ *
  * @param matcherType
- * @return 
+ * @param distRatio
+ * @param crossMatching Cross-check the matches so each left feature is matched
+ * at most once (ignored by FAST_CASCADE_HASHING_L2).
+ * @param cascadeMatching Match a strong feature subset first and use the full
+ * sets only for ambiguous pairs (ignored by FAST_CASCADE_HASHING_L2).
+ * @return
  */
-std::unique_ptr<IImageCollectionMatcher> createImageCollectionMatcher(matching::EMatcherType matcherType, float distRatio);
+std::unique_ptr<IImageCollectionMatcher> createImageCollectionMatcher(matching::EMatcherType matcherType, float distRatio, bool crossMatching = false, bool cascadeMatching = false);
 
 
 } // namespace matching
@@ -9,6 +9,7 @@
 
 #include <boost/algorithm/string.hpp>
 
+#include <cassert>
 #include <set>
 #include <iostream>
 #include <fstream>
@@ -43,6 +44,54 @@ PairSet exhaustivePairs(const sfm::Views& views, int rangeStart, int rangeSize)
   return pairs;
 }
 
+std::vector<PairSet> buildBalancedShards(const PairSet& pairs,
+                                         std::size_t nbShards,
+                                         const std::map<IndexT, std::size_t>& viewWeights,
+                                         const std::map<Pair, std::size_t>& pairWeights)
+{
+  assert(nbShards > 0);
+
+  const auto weightOfView = [&viewWeights](IndexT viewId) -> std::size_t
+  {
+    const std::map<IndexT, std::size_t>::const_iterator it = viewWeights.find(viewId);
+    return (it == viewWeights.end() || it->second == 0) ? 1 : it->second;
+  };
+
+  // cost of a pair: the measured weight when available, otherwise the product
+  // of the view weights, as the descriptor matching time is roughly
+  // proportional to it
+  std::vector<std::pair<std::size_t, Pair> > weightedPairs;
+  weightedPairs.reserve(pairs.size());
+  for(const Pair& pair : pairs)
+  {
+    const std::map<Pair, std::size_t>::const_iterator it = pairWeights.find(pair);
+    if(it != pairWeights.end() && it->second != 0)
+      weightedPairs.emplace_back(it->second, pair);
+    else
+      weightedPairs.emplace_back(weightOfView(pair.first) * weightOfView(pair.second), pair);
+  }
+
+  // heaviest pairs first; stable so that equal weights keep the pair ordering
+  // and the partition is deterministic
+  std::stable_sort(weightedPairs.begin(), weightedPairs.end(),
+                   [](const std::pair<std::size_t, Pair>& lhs, const std::pair<std::size_t, Pair>& rhs)
+                   {
+                     return lhs.first > rhs.first;
+                   });
+
+  // greedy assignment to the currently lightest shard (lowest index on ties)
+  std::vector<PairSet> shards(nbShards);
+  std::vector<std::size_t> shardLoads(nbShards, 0);
+  for(const auto& weightedPair : weightedPairs)
+  {
+    const std::size_t lightest =
+      std::min_element(shardLoads.begin(), shardLoads.end()) - shardLoads.begin();
+    shards[lightest].insert(weightedPair.second);
+    shardLoads[lightest] += weightedPair.first;
+  }
+  return shards;
+}
+
 bool loadPairs(const std::string &sFileName,
                PairSet & pairs,
                int rangeStart,
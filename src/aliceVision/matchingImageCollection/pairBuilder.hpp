@@ -9,12 +9,40 @@
 #include <aliceVision/sfm/SfMData.hpp>
 
 #include <algorithm>
+#include <map>
+#include <vector>
 
 namespace aliceVision {
 
 /// Generate all the (I,J) pairs of the upper diagonal of the NxN matrix
 PairSet exhaustivePairs(const sfm::Views& views, int rangeStart=-1, int rangeSize=0);
 
+/**
+ * @brief Partition a pair list into nbShards shards of balanced matching cost.
+ *
+ * The cost of a pair is the product of the weights of its two views (e.g.
+ * their feature counts, as the matching time is roughly proportional to it);
+ * views missing from viewWeights count as weight 1. Pairs are assigned
+ * greedily, heaviest first, to the currently lightest shard, so every machine
+ * of a farm receives a comparable amount of work. The result only depends on
+ * the input pairs and weights: each node can recompute its own shard
+ * independently and the shards are guaranteed to be disjoint and complete.
+ *
+ * When a measured per-pair weight is available (typically the putative match
+ * counts of a previous run, from the matches statistics index) it overrides
+ * the view-weight product estimate for that pair.
+ *
+ * @param[in] pairs The full pair list to partition.
+ * @param[in] nbShards The number of shards to produce.
+ * @param[in] viewWeights Optional per-view weight (typically feature counts).
+ * @param[in] pairWeights Optional measured per-pair weight, overrides the estimate.
+ * @return One PairSet per shard; empty pairs give nbShards empty shards.
+ */
+std::vector<PairSet> buildBalancedShards(const PairSet& pairs,
+                                         std::size_t nbShards,
+                                         const std::map<IndexT, std::size_t>& viewWeights = std::map<IndexT, std::size_t>(),
+                                         const std::map<Pair, std::size_t>& pairWeights = std::map<Pair, std::size_t>());
+
 /// Load a set of PairSet from a file
 /// I J K L (pair that link I)
 bool loadPairs(
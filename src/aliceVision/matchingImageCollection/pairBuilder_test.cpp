@@ -59,6 +59,53 @@ BOOST_AUTO_TEST_CASE(matchingImageCollection_exhaustivePairs)
   }
 }
 
+BOOST_AUTO_TEST_CASE(matchingImageCollection_buildBalancedShards)
+{
+  // all the pairs of 6 views
+  sfm::Views views;
+  for(IndexT i = 0; i < 6; ++i)
+    views[i] = std::make_shared<sfm::View>("filepath", i);
+  const PairSet pairSet = exhaustivePairs(views);
+  BOOST_CHECK_EQUAL( 15, pairSet.size());
+
+  // unweighted: the shards form a disjoint and complete partition
+  std::vector<PairSet> shards = buildBalancedShards(pairSet, 4);
+  BOOST_CHECK_EQUAL( 4, shards.size());
+  PairSet unionOfShards;
+  std::size_t total = 0;
+  for(const PairSet& shard : shards)
+  {
+    total += shard.size();
+    unionOfShards.insert(shard.begin(), shard.end());
+  }
+  BOOST_CHECK_EQUAL( pairSet.size(), total);
+  BOOST_CHECK( unionOfShards == pairSet );
+
+  // the partition is deterministic
+  BOOST_CHECK( shards == buildBalancedShards(pairSet, 4) );
+
+  // weighted: view 0 is far heavier than the others, so the pairs involving
+  // it must spread over the shards instead of piling up in one
+  std::map<IndexT, std::size_t> viewWeights;
+  viewWeights[0] = 1000;
+  for(IndexT i = 1; i < 6; ++i)
+    viewWeights[i] = 1;
+  shards = buildBalancedShards(pairSet, 5, viewWeights);
+  for(const PairSet& shard : shards)
+  {
+    std::size_t nbHeavyPairs = 0;
+    for(const Pair& pair : shard)
+      if(pair.first == 0)
+        ++nbHeavyPairs;
+    BOOST_CHECK_EQUAL( 1, nbHeavyPairs );
+  }
+
+  // one shard always yields the full pair list
+  shards = buildBalancedShards(pairSet, 1, viewWeights);
+  BOOST_CHECK_EQUAL( 1, shards.size());
+  BOOST_CHECK( shards[0] == pairSet );
+}
+
 BOOST_AUTO_TEST_CASE(matchingImageCollection_IO)
 {
   PairSet pairSetGT;
@@ -42,15 +42,39 @@ void ApplyTransformationToPoints(const Mat &points,
                                  Mat *transformed_points) {
   const Mat::Index n = points.cols();
   transformed_points->resize(2,n);
-  for (Mat::Index i = 0; i < n; ++i) {
-    Vec3 in, out;
-    in << points(0, i), points(1, i), 1;
-    out = T * in;
-    (*transformed_points)(0, i) = out(0)/out(2);
-    (*transformed_points)(1, i) = out(1)/out(2);
+  // Apply the linear part as a single matrix product and add the translation
+  // column-wise, instead of transforming one point at a time.
+  transformed_points->noalias() = T.topLeftCorner<2,2>() * points;
+  transformed_points->colwise() += T.block<2,1>(0,2);
+  // A generic projective transform also needs the homogeneous division; the
+  // conditioning matrices built by the preconditioners are affine, so the
+  // division is skipped for them.
+  if (T(2,0) != 0.0 || T(2,1) != 0.0 || T(2,2) != 1.0) {
+    const Vec w = (T(2,0) * points.row(0) + T(2,1) * points.row(1)).transpose()
+                  + Vec::Constant(n, T(2,2));
+    transformed_points->row(0).array() /= w.transpose().array();
+    transformed_points->row(1).array() /= w.transpose().array();
   }
 }
 
+void ApplyTransformationToPoints(const Mat3 &T, Mat *points) {
+  const Mat::Index n = points->cols();
+  // Keep the original x row: it feeds both transformed rows. The y row is
+  // overwritten last with element-wise expressions, which alias safely.
+  const Vec x = points->row(0).transpose();
+  if (T(2,0) != 0.0 || T(2,1) != 0.0 || T(2,2) != 1.0) {
+    const Vec w = T(2,0) * x + T(2,1) * points->row(1).transpose()
+                  + Vec::Constant(n, T(2,2));
+    points->row(0) = (T(0,0) * x.transpose().array() + T(0,1) * points->row(1).array() + T(0,2))
+                     / w.transpose().array();
+    points->row(1) = (T(1,0) * x.transpose().array() + T(1,1) * points->row(1).array() + T(1,2))
+                     / w.transpose().array();
+    return;
+  }
+  points->row(0) = T(0,0) * x.transpose().array() + T(0,1) * points->row(1).array() + T(0,2);
+  points->row(1) = T(1,0) * x.transpose().array() + T(1,1) * points->row(1).array() + T(1,2);
+}
+
 void NormalizePointsFromImageSize(const Mat &points,
                       Mat *normalized_points,
                       Mat3 *T,
@@ -68,6 +92,11 @@ void NormalizePoints(const Mat &points,
   ApplyTransformationToPoints(points, *T, normalized_points);
 }
 
+void NormalizePoints(Mat *points, Mat3 *T) {
+  PreconditionerFromPoints(*points, T);
+  ApplyTransformationToPoints(*T, points);
+}
+
 // Denormalize the results. See HZ page 109.
 void UnnormalizerT::Unnormalize(const Mat3 &T1, const Mat3 &T2, Mat3 *H)  {
   *H = T2.transpose() * (*H) * T1;
@@ -22,11 +22,18 @@ void ApplyTransformationToPoints(const Mat &points,
                                  const Mat3 &T,
                                  Mat *transformed_points);
 
+/// In-place variant: transform the points without the copy, for callers
+/// owning their point matrix (eg. an already extracted sample)
+void ApplyTransformationToPoints(const Mat3 &T, Mat *points);
+
 // Normalize point in [-.5, .5] and return transformation matrix
 void NormalizePoints(const Mat &points,
                      Mat *normalized_points,
                      Mat3 *T);
 
+/// In-place variant of NormalizePoints, skipping the copy
+void NormalizePoints(Mat *points, Mat3 *T);
+
 /// Point conditioning (compute Transformation matrix)
 void PreconditionerFromImageSize(int width, int height, Mat3 *T);
 
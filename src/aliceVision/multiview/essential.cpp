@@ -115,6 +115,62 @@ int MotionFromEssentialChooseSolution(const std::vector<Mat3> &Rs,
   return -1;
 }
 
+// HZ 9.6 pag 259, over a whole set of correspondences
+int MotionFromEssentialChooseSolution(const std::vector<Mat3> &Rs,
+                                      const std::vector<Vec3> &ts,
+                                      const Mat3 &K1,
+                                      const Mat &x1,
+                                      const Mat3 &K2,
+                                      const Mat &x2) {
+  assert(Rs.size() == 4);
+  assert(ts.size() == 4);
+  assert(2 == x1.rows());
+  assert(x1.rows() == x2.rows());
+  assert(x1.cols() == x2.cols());
+
+  Mat34 P1, P2;
+  // Set P1 = K1 [Id|0]
+  Mat3 R1 = Mat3::Identity();
+  Vec3 t1 = Vec3::Zero();
+  P_From_KRt(K1, R1, t1, &P1);
+
+  const Mat::Index n = x1.cols();
+  Mat3X X(3, n);
+  std::size_t bestSupport = 0;
+  int bestSolution = -1;
+  for (int i = 0; i < 4; ++i) {
+    const Mat3 &R2 = Rs[i];
+    const Vec3 &t2 = ts[i];
+    P_From_KRt(K2, R2, t2, &P2);
+    for (Mat::Index k = 0; k < n; ++k) {
+      Vec3 Xk;
+      TriangulateDLT(P1, x1.col(k), P2, x2.col(k), &Xk);
+      X.col(k) = Xk;
+    }
+    // Count the points in front of the two cameras with a single vectorized
+    // depth sign test (the first camera is [Id|0], so its depths are the
+    // third coordinates of the triangulated points).
+    const std::size_t support =
+      (X.row(2).array() > 0.0 && ((R2.row(2) * X).array() + t2(2)) > 0.0).count();
+    if (support > bestSupport) {
+      bestSupport = support;
+      bestSolution = i;
+    }
+  }
+  return bestSolution;
+}
+
+// HZ 9.7 page 259 (Result 9.19), batched over several hypotheses
+void MotionFromEssential(const std::vector<Mat3> &Es,
+                         std::vector<std::vector<Mat3> > *Rs,
+                         std::vector<std::vector<Vec3> > *ts) {
+  Rs->resize(Es.size());
+  ts->resize(Es.size());
+  for (std::size_t i = 0; i < Es.size(); ++i) {
+    MotionFromEssential(Es[i], &(*Rs)[i], &(*ts)[i]);
+  }
+}
+
 bool MotionFromEssentialAndCorrespondence(const Mat3 &E,
                                           const Mat3 &K1,
                                           const Vec2 &x1,
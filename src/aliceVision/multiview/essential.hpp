@@ -65,10 +65,31 @@ int MotionFromEssentialChooseSolution(const std::vector<Mat3> &Rs,
                                       const Mat3 &K2,
                                       const Vec2 &x2);
 
+/// Choose one of the four possible motion solutions from an essential matrix
+/// over a whole set of correspondences (2xn matrices of point coordinates).
+/// The four-fold ambiguity is resolved by triangulating every correspondence
+/// and counting, with a vectorized depth sign test, how many points lie in
+/// front of both cameras; the solution with the largest support wins.
+/// Return the index of the right solution or -1 if no correspondence is in
+/// front of the cameras for any solution.
+int MotionFromEssentialChooseSolution(const std::vector<Mat3> &Rs,
+                                      const std::vector<Vec3> &ts,
+                                      const Mat3 &K1,
+                                      const Mat &x1,
+                                      const Mat3 &K2,
+                                      const Mat &x2);
+
 // HZ 9.7 page 259 (Result 9.19)
 void MotionFromEssential(const Mat3 &E,
   std::vector<Mat3> *Rs,
   std::vector<Vec3> *ts);
 
+/// Batched variant of MotionFromEssential: decompose every hypothesis of
+/// \p Es into its four (R,t) candidates. Useful when many essential matrix
+/// hypotheses must be evaluated (e.g. initial pair selection).
+void MotionFromEssential(const std::vector<Mat3> &Es,
+  std::vector<std::vector<Mat3> > *Rs,
+  std::vector<std::vector<Vec3> > *ts);
+
 
 } // namespace aliceVision
@@ -10,7 +10,8 @@
 
 namespace aliceVision {
 
-Mat FivePointsNullspaceBasis(const Mat2X &x1, const Mat2X &x2) {
+Eigen::Matrix<double, 9, 4> FivePointsNullspaceBasis(const Mat2X &x1,
+                                                     const Mat2X &x2) {
   Eigen::Matrix<double,9, 9> A;
   A.setZero();  // Make A square until Eigen supports rectangular SVD.
   fundamental::kernel::EncodeEpipolarEquation(x1, x2, &A);
@@ -18,8 +19,8 @@ Mat FivePointsNullspaceBasis(const Mat2X &x1, const Mat2X &x2) {
   return svd.matrixV().topRightCorner<9,4>();
 }
 
-Vec o1(const Vec &a, const Vec &b) {
-  Vec res = Vec::Zero(20);
+Vec20 o1(const Vec20 &a, const Vec20 &b) {
+  Vec20 res = Vec20::Zero();
 
   res(coef_xx) = a(coef_x) * b(coef_x);
   res(coef_xy) = a(coef_x) * b(coef_y)
@@ -41,8 +42,8 @@ Vec o1(const Vec &a, const Vec &b) {
   return res;
 }
 
-Vec o2(const Vec &a, const Vec &b) {
-  Vec res(20);
+Vec20 o2(const Vec20 &a, const Vec20 &b) {
+  Vec20 res;
 
   res(coef_xxx) = a(coef_xx) * b(coef_x);
   res(coef_xxy) = a(coef_xx) * b(coef_y)
@@ -88,12 +89,13 @@ Vec o2(const Vec &a, const Vec &b) {
   return res;
 }
 
-Mat FivePointsPolynomialConstraints(const Mat &E_basis) {
+Eigen::Matrix<double, 10, 20> FivePointsPolynomialConstraints(
+    const Eigen::Matrix<double, 9, 4> &E_basis) {
   // Build the polynomial form of E (equation (8) in Stewenius et al. [1])
-  Vec E[3][3];
+  Vec20 E[3][3];
   for (int i = 0; i < 3; ++i) {
     for (int j = 0; j < 3; ++j) {
-      E[i][j] = Vec::Zero(20);
+      E[i][j] = Vec20::Zero();
       E[i][j](coef_x) = E_basis(3 * i + j, 0);
       E[i][j](coef_y) = E_basis(3 * i + j, 1);
       E[i][j](coef_z) = E_basis(3 * i + j, 2);
@@ -102,7 +104,7 @@ Mat FivePointsPolynomialConstraints(const Mat &E_basis) {
   }
 
   // The constraint matrix.
-  Mat M(10, 20);
+  Eigen::Matrix<double, 10, 20> M;
   int mrow = 0;
 
   // Determinant constraint det(E) = 0; equation (19) of Nister [2].
@@ -112,7 +114,7 @@ Mat FivePointsPolynomialConstraints(const Mat &E_basis) {
 
   // Cubic singular values constraint.
   // Equation (20).
-  Vec EET[3][3];
+  Vec20 EET[3][3];
   for (int i = 0; i < 3; ++i) {    // Since EET is symmetric, we only compute
     for (int j = 0; j < 3; ++j) {  // its upper triangular part.
       if (i <= j) {
@@ -126,8 +128,8 @@ Mat FivePointsPolynomialConstraints(const Mat &E_basis) {
   }
 
   // Equation (21).
-  Vec (&L)[3][3] = EET;
-  Vec trace  = 0.5 * (EET[0][0] + EET[1][1] + EET[2][2]);
+  Vec20 (&L)[3][3] = EET;
+  const Vec20 trace = 0.5 * (EET[0][0] + EET[1][1] + EET[2][2]);
   for (int i = 0; i < 3; ++i) {
     L[i][i] -= trace;
   }
@@ -135,7 +137,7 @@ Mat FivePointsPolynomialConstraints(const Mat &E_basis) {
   // Equation (23).
   for (int i = 0; i < 3; ++i) {
     for (int j = 0; j < 3; ++j) {
-      Vec LEij = o2(L[i][0], E[0][j])
+      const Vec20 LEij = o2(L[i][0], E[0][j])
                + o2(L[i][1], E[1][j])
                + o2(L[i][2], E[2][j]);
       M.row(mrow++) = LEij;
@@ -189,4 +191,23 @@ void FivePointsRelativePose(const Mat2X &x1,
   }
 }
 
+void FivePointsRelativePoseMany(const Mat2X &x1,
+                                const Mat2X &x2,
+                                const vector<vector<size_t>> &samples,
+                                vector<vector<Mat3>> *Es) {
+  Es->resize(samples.size());
+  // fixed-size gather buffers reused across the samples
+  Eigen::Matrix<double, 2, 5> sx1, sx2;
+  for (size_t s = 0; s < samples.size(); ++s) {
+    const vector<size_t> &sample = samples[s];
+    assert(sample.size() == 5);
+    for (int i = 0; i < 5; ++i) {
+      sx1.col(i) = x1.col(sample[i]);
+      sx2.col(i) = x2.col(sample[i]);
+    }
+    (*Es)[s].clear();
+    FivePointsRelativePose(sx1, sx2, &(*Es)[s]);
+  }
+}
+
 } // namespace aliceVision
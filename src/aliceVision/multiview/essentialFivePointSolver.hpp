@@ -12,6 +12,10 @@
 namespace aliceVision {
   using namespace std;
 
+/// A polynomial in the 20 monomial basis below, as a fixed-size vector of its
+/// coefficients so all the solver arithmetic stays allocation free.
+typedef Eigen::Matrix<double, 20, 1> Vec20;
+
 /** Computes the relative pose of two calibrated cameras from 5 correspondences.
  *
  * \param x1 Points in the first image.  One per column.
@@ -21,17 +25,34 @@ namespace aliceVision {
 void FivePointsRelativePose(const Mat2X &x1, const Mat2X &x2,
                             vector<Mat3> *E);
 
+/** Batch version solving many minimal 5-point samples at once.
+ *
+ * The per-sample points are gathered into a fixed-size workspace reused
+ * across the samples, so repeated hypothesis generation (e.g. by RANSAC)
+ * avoids any per-call allocation besides the output models.
+ *
+ * \param x1 Points in the first image.  One per column.
+ * \param x2 Corresponding points in the second image. One per column.
+ * \param samples One entry per minimal sample, each holding 5 column indices.
+ * \param Es (*Es)[i] receives the candidate solutions of samples[i].
+ */
+void FivePointsRelativePoseMany(const Mat2X &x1, const Mat2X &x2,
+                                const vector<vector<size_t>> &samples,
+                                vector<vector<Mat3>> *Es);
+
 // Compute the nullspace of the linear constraints given by the matches.
-Mat FivePointsNullspaceBasis(const Mat2X &x1, const Mat2X &x2);
+Eigen::Matrix<double, 9, 4> FivePointsNullspaceBasis(const Mat2X &x1,
+                                                     const Mat2X &x2);
 
 // Multiply two polynomials of degree 1.
-Vec o1(const Vec &a, const Vec &b);
+Vec20 o1(const Vec20 &a, const Vec20 &b);
 
 // Multiply a polynomial of degree 2, a, by a polynomial of degree 1, b.
-Vec o2(const Vec &a, const Vec &b);
+Vec20 o2(const Vec20 &a, const Vec20 &b);
 
 // Builds the polynomial constraint matrix M.
-Mat FivePointsPolynomialConstraints(const Mat &E_basis);
+Eigen::Matrix<double, 10, 20> FivePointsPolynomialConstraints(
+    const Eigen::Matrix<double, 9, 4> &E_basis);
 
 // In the following code, polynomials are expressed as vectors containing
 // their coeficients in the basis of monomials:
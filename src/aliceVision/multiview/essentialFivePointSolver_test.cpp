@@ -244,6 +244,40 @@ BOOST_AUTO_TEST_CASE(FivePointsRelativePose_test_data_sets) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(FivePointsRelativePoseMany_MatchesSingleSampleCalls) {
+
+  //-- A pair with 20 correspondences and several minimal samples drawn from it.
+  const int iNviews = 2;
+  NViewDataSet d = NRealisticCamerasRing(iNviews, 20,
+    NViewDatasetConfigurator(1,1,0,0,5,0));
+
+  vector<vector<size_t>> samples;
+  for (size_t s = 0; s < 6; ++s) {
+    vector<size_t> sample;
+    for (size_t k = 0; k < 5; ++k)
+      sample.push_back((3 * s + 2 * k) % 20);
+    samples.push_back(sample);
+  }
+
+  vector<vector<Mat3>> EsMany;
+  FivePointsRelativePoseMany(d._x[0], d._x[1], samples, &EsMany);
+  BOOST_CHECK_EQUAL(samples.size(), EsMany.size());
+
+  for (size_t s = 0; s < samples.size(); ++s) {
+    Mat2X x1(2, 5), x2(2, 5);
+    for (int i = 0; i < 5; ++i) {
+      x1.col(i) = d._x[0].col(samples[s][i]);
+      x2.col(i) = d._x[1].col(samples[s][i]);
+    }
+    vector<Mat3> Es;
+    FivePointsRelativePose(x1, x2, &Es);
+    BOOST_CHECK_EQUAL(Es.size(), EsMany[s].size());
+    for (size_t m = 0; m < Es.size(); ++m) {
+      EXPECT_MATRIX_NEAR(Es[m], EsMany[s][m], 1e-12);
+    }
+  }
+}
+
 BOOST_AUTO_TEST_CASE(FivePointsNullspaceBasis_SatisfyEpipolarConstraint) {
 
   TestData d = SomeTestData();
@@ -94,6 +94,22 @@ struct SampsonError {
     return Square(y.dot(F_x)) / (  F_x.head<2>().squaredNorm()
                                 + Ft_y.head<2>().squaredNorm());
   }
+
+  /// Whole-block evaluation of the error on all the correspondences,
+  /// with the epipolar lines and the residuals computed as row arrays
+  static void Errors(const Mat3 &F, const Mat &x1, const Mat &x2,
+                     std::vector<double> &vec_errors) {
+    typedef Eigen::Array<double, 1, Eigen::Dynamic> RowArrayXd;
+    const RowArrayXd F_x0 = F(0,0) * x1.row(0).array() + F(0,1) * x1.row(1).array() + F(0,2);
+    const RowArrayXd F_x1 = F(1,0) * x1.row(0).array() + F(1,1) * x1.row(1).array() + F(1,2);
+    const RowArrayXd F_x2 = F(2,0) * x1.row(0).array() + F(2,1) * x1.row(1).array() + F(2,2);
+    const RowArrayXd Ft_y0 = F(0,0) * x2.row(0).array() + F(1,0) * x2.row(1).array() + F(2,0);
+    const RowArrayXd Ft_y1 = F(0,1) * x2.row(0).array() + F(1,1) * x2.row(1).array() + F(2,1);
+    const RowArrayXd y_F_x = x2.row(0).array() * F_x0 + x2.row(1).array() * F_x1 + F_x2;
+    const RowArrayXd errors = y_F_x.square() /
+      ((F_x0.square() + F_x1.square()) + (Ft_y0.square() + Ft_y1.square()));
+    vec_errors.assign(errors.data(), errors.data() + errors.size());
+  }
 };
 
 struct SymmetricEpipolarDistanceError {
@@ -107,6 +123,21 @@ struct SymmetricEpipolarDistanceError {
                                 + 1.0 / Ft_y.head<2>().squaredNorm())
       / 4.0;  // The divide by 4 is to make this match the Sampson distance.
   }
+
+  /// Whole-block evaluation of the error on all the correspondences
+  static void Errors(const Mat3 &F, const Mat &x1, const Mat &x2,
+                     std::vector<double> &vec_errors) {
+    typedef Eigen::Array<double, 1, Eigen::Dynamic> RowArrayXd;
+    const RowArrayXd F_x0 = F(0,0) * x1.row(0).array() + F(0,1) * x1.row(1).array() + F(0,2);
+    const RowArrayXd F_x1 = F(1,0) * x1.row(0).array() + F(1,1) * x1.row(1).array() + F(1,2);
+    const RowArrayXd F_x2 = F(2,0) * x1.row(0).array() + F(2,1) * x1.row(1).array() + F(2,2);
+    const RowArrayXd Ft_y0 = F(0,0) * x2.row(0).array() + F(1,0) * x2.row(1).array() + F(2,0);
+    const RowArrayXd Ft_y1 = F(0,1) * x2.row(0).array() + F(1,1) * x2.row(1).array() + F(2,1);
+    const RowArrayXd y_F_x = x2.row(0).array() * F_x0 + x2.row(1).array() * F_x1 + F_x2;
+    const RowArrayXd errors = y_F_x.square() *
+      (1.0 / (F_x0.square() + F_x1.square()) + 1.0 / (Ft_y0.square() + Ft_y1.square())) / 4.0;
+    vec_errors.assign(errors.data(), errors.data() + errors.size());
+  }
 };
 
 struct EpipolarDistanceError {
@@ -118,6 +149,18 @@ struct EpipolarDistanceError {
     Vec3 F_x = F * x;
     return Square(F_x.dot(y)) /  F_x.head<2>().squaredNorm();
   }
+
+  /// Whole-block evaluation of the error on all the correspondences
+  static void Errors(const Mat3 &F, const Mat &x1, const Mat &x2,
+                     std::vector<double> &vec_errors) {
+    typedef Eigen::Array<double, 1, Eigen::Dynamic> RowArrayXd;
+    const RowArrayXd F_x0 = F(0,0) * x1.row(0).array() + F(0,1) * x1.row(1).array() + F(0,2);
+    const RowArrayXd F_x1 = F(1,0) * x1.row(0).array() + F(1,1) * x1.row(1).array() + F(1,2);
+    const RowArrayXd F_x2 = F(2,0) * x1.row(0).array() + F(2,1) * x1.row(1).array() + F(2,2);
+    const RowArrayXd F_x_y = F_x0 * x2.row(0).array() + F_x1 * x2.row(1).array() + F_x2;
+    const RowArrayXd errors = F_x_y.square() / (F_x0.square() + F_x1.square());
+    vec_errors.assign(errors.data(), errors.data() + errors.size());
+  }
 };
 typedef EpipolarDistanceError SimpleError;
 
@@ -36,6 +36,12 @@ void BuildActionMatrix(Matrix & L, const Mat &x, const Mat &y)  {
 }
 
 void FourPointSolver::Solve(const Mat &x, const Mat &y, vector<Mat3> *Hs) {
+  Scratch scratch;
+  Solve(x, y, Hs, scratch);
+}
+
+void FourPointSolver::Solve(const Mat &x, const Mat &y, vector<Mat3> *Hs,
+                            Scratch &scratch) {
   assert(2 == x.rows());
   assert(4 <= x.cols());
   assert(x.rows() == y.rows());
@@ -47,20 +53,50 @@ void FourPointSolver::Solve(const Mat &x, const Mat &y, vector<Mat3> *Hs) {
   if (n == 4)  {
     // In the case of minimal configuration we use fixed sized matrix to let
     //  Eigen and the compiler doing the maximum of optimization.
-    typedef Eigen::Matrix<double, 16, 9> Mat16_9;
-    Mat16_9 L = Mat::Zero(16, 9);
-    BuildActionMatrix(L, x, y);
-    Nullspace(&L, &h);
+    scratch.L.setZero();
+    BuildActionMatrix(scratch.L, x, y);
+    Nullspace(&scratch.L, &h);
   }
   else {
-    MatX9 L = Mat::Zero(n * 2, 9);
-    BuildActionMatrix(L, x, y);
-    Nullspace(&L, &h);
+    scratch.Ldyn.setZero(n * 2, 9);
+    BuildActionMatrix(scratch.Ldyn, x, y);
+    Nullspace(&scratch.Ldyn, &h);
   }
   Mat3 H = Map<RMat3>(h.data()); // map the linear vector as the H matrix
   Hs->push_back(H);
 }
 
+void FourPointSolver::SolveBatch(const Mat &x, const Mat &y,
+                                 const vector<vector<size_t> > &samples,
+                                 vector<Mat3> *Hs) {
+  assert(2 == x.rows());
+  assert(x.rows() == y.rows());
+  assert(x.cols() == y.cols());
+
+  Scratch scratch;
+  Mat xs(2, MINIMUM_SAMPLES), ys(2, MINIMUM_SAMPLES);
+  for (size_t s = 0; s < samples.size(); ++s) {
+    const vector<size_t> &sample = samples[s];
+    assert(MINIMUM_SAMPLES == sample.size());
+    for (size_t i = 0; i < sample.size(); ++i) {
+      xs.col(i) = x.col(sample[i]);
+      ys.col(i) = y.col(sample[i]);
+    }
+    const size_t before = Hs->size();
+    Solve(xs, ys, Hs, scratch);
+    if (Hs->size() > before && !IsOrientationConsistent(Hs->back(), xs))
+      Hs->pop_back();
+  }
+}
+
+bool IsOrientationConsistent(const Mat3 &H, const Mat &x) {
+  // Sign of the homogeneous scale of every transformed point; the sign
+  // pattern is unchanged by affine conditioning (its last row is (0,0,1)).
+  const Eigen::Array<double, 1, Eigen::Dynamic> w =
+      H(2,0) * x.row(0).array() + H(2,1) * x.row(1).array() + H(2,2);
+  return (w > 0.0).all() || (w < 0.0).all();
+}
+
 }  // namespace kernel
 }  // namespace homography
 }  // namespace aliceVision
@@ -19,6 +19,15 @@ using namespace std;
 struct FourPointSolver {
   enum { MINIMUM_SAMPLES = 4 };
   enum { MAX_MODELS = 1 };
+
+  /// Workspace for the DLT system, so repeated solves (eg. the hypothesis
+  /// loop of a robust estimator) do not re-allocate the action matrix.
+  struct Scratch {
+    Eigen::Matrix<double, 16, 9> L; // minimal 4-point configuration
+    MatX9 Ldyn;                     // over-determined configurations
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  };
+
   /**
    * Computes the homography that transforms x to y with the Direct Linear
    * Transform (DLT).
@@ -30,6 +39,50 @@ struct FourPointSolver {
    * The estimated homography should approximately hold the condition y = H x.
    */
   static void Solve(const Mat &x, const Mat &y, vector<Mat3> *Hs);
+
+  /// Same as Solve, reusing the caller-provided scratch space.
+  static void Solve(const Mat &x, const Mat &y, vector<Mat3> *Hs,
+                    Scratch &scratch);
+
+  /**
+   * Batched hypothesis generation: solve one homography per minimal 4-point
+   * sample, sharing a single scratch across the whole batch.
+   *
+   * \param x       A 2xN matrix of column vectors.
+   * \param y       A 2xN matrix of column vectors.
+   * \param samples Column index sets, each of MINIMUM_SAMPLES indices.
+   * \param Hs      One homography is appended per orientation-consistent
+   *                sample; inconsistent hypotheses are dropped (see
+   *                IsOrientationConsistent).
+   */
+  static void SolveBatch(const Mat &x, const Mat &y,
+                         const vector<vector<size_t> > &samples,
+                         vector<Mat3> *Hs);
+};
+
+/**
+ * Cheirality check for a homography hypothesis: a homography induced by an
+ * actual scene plane maps every sample point with a homogeneous scale of
+ * constant sign. A mixed-sign solution sends part of the sample behind the
+ * camera and can only come from a degenerate or mismatched sample, so such
+ * hypotheses can be rejected before the error evaluation over all the
+ * putative matches.
+ */
+bool IsOrientationConsistent(const Mat3 &H, const Mat &x);
+
+/// FourPointSolver variant discarding orientation-inconsistent hypotheses,
+/// for use inside robust estimation loops. The sign check is invariant to the
+/// usual affine conditioning of the points, so it can run on normalized data.
+struct FourPointSolverCheirality {
+  enum { MINIMUM_SAMPLES = FourPointSolver::MINIMUM_SAMPLES };
+  enum { MAX_MODELS = FourPointSolver::MAX_MODELS };
+
+  static void Solve(const Mat &x, const Mat &y, vector<Mat3> *Hs) {
+    const size_t before = Hs->size();
+    FourPointSolver::Solve(x, y, Hs);
+    if (Hs->size() > before && !IsOrientationConsistent(Hs->back(), x))
+      Hs->pop_back();
+  }
 };
 
 // Should be distributed as Chi-squared with k = 2.
@@ -39,6 +92,19 @@ struct AsymmetricError {
     Vec2 x2_est = x2h_est.head<2>() / x2h_est[2];
     return (x2 - x2_est).squaredNorm();
   }
+
+  /// Whole-block evaluation of the error on all the correspondences
+  static void Errors(const Mat &H, const Mat &x1, const Mat &x2,
+                     std::vector<double> &vec_errors) {
+    typedef Eigen::Array<double, 1, Eigen::Dynamic> RowArrayXd;
+    const RowArrayXd x2h_est0 = H(0,0) * x1.row(0).array() + H(0,1) * x1.row(1).array() + H(0,2);
+    const RowArrayXd x2h_est1 = H(1,0) * x1.row(0).array() + H(1,1) * x1.row(1).array() + H(1,2);
+    const RowArrayXd x2h_est2 = H(2,0) * x1.row(0).array() + H(2,1) * x1.row(1).array() + H(2,2);
+    const RowArrayXd dx = x2.row(0).array() - x2h_est0 / x2h_est2;
+    const RowArrayXd dy = x2.row(1).array() - x2h_est1 / x2h_est2;
+    const RowArrayXd errors = dx.square() + dy.square();
+    vec_errors.assign(errors.data(), errors.data() + errors.size());
+  }
 };
 
 // Kernel that works on original data point
@@ -51,6 +51,74 @@ BOOST_AUTO_TEST_CASE(HomographyKernelTest_Fitting_Unnormalized) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(HomographyKernelTest_SolveBatch) {
+  // Affine ground truth: every point keeps a positive homogeneous scale.
+  Mat3 H_gt;
+  H_gt << 1,  0, -4,
+          0,  1,  5,
+          0,  0,  1;
+
+  Mat x(2, 9), xh;
+  x << 0, 0, 0, 1, 1, 1, 2, 2, 2,
+       0, 1, 2, 0, 1, 2, 0, 1, 2;
+  EuclideanToHomogeneous(x, &xh);
+  Mat y, yh = H_gt * xh;
+  HomogeneousToEuclidean(yh, &y);
+
+  vector<vector<size_t> > samples(3);
+  size_t s0[4] = {0, 1, 3, 4}; samples[0].assign(s0, s0 + 4);
+  size_t s1[4] = {1, 3, 5, 8}; samples[1].assign(s1, s1 + 4);
+  size_t s2[4] = {1, 3, 5, 7}; samples[2].assign(s2, s2 + 4);
+
+  vector<Mat3> Hs;
+  homography::kernel::FourPointSolver::SolveBatch(x, y, samples, &Hs);
+  BOOST_CHECK_EQUAL(samples.size(), Hs.size());
+  for (size_t i = 0; i < Hs.size(); ++i)
+    EXPECT_MATRIX_PROP(H_gt, Hs[i], 1e-6);
+
+  // The scratch overload must match the plain per-sample solver.
+  homography::kernel::FourPointSolver::Scratch scratch;
+  for (size_t i = 0; i < samples.size(); ++i) {
+    vector<Mat3> Hsingle;
+    Mat xs = ExtractColumns(x, samples[i]), ys = ExtractColumns(y, samples[i]);
+    homography::kernel::FourPointSolver::Solve(xs, ys, &Hsingle, scratch);
+    BOOST_CHECK_EQUAL(1, Hsingle.size());
+    EXPECT_MATRIX_PROP(Hs[i], Hsingle[0], 1e-8);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(HomographyKernelTest_CheiralityFilter) {
+  // Projective ground truth with a mixed-sign homogeneous scale over the
+  // grid: samples crossing the sign change must be rejected.
+  Mat3 H_gt;
+  H_gt << 1, -2,  3,
+          4,  5, -6,
+         -7,  8,  1;
+
+  Mat x(2, 9), xh;
+  x << 0, 0, 0, 1, 1, 1, 2, 2, 2,
+       0, 1, 2, 0, 1, 2, 0, 1, 2;
+  EuclideanToHomogeneous(x, &xh);
+  Mat y, yh = H_gt * xh;
+  HomogeneousToEuclidean(yh, &y);
+
+  // w = -7x + 8y + 1: positive on {0,1,2,4,5,8}, negative on {3,6,7}.
+  vector<vector<size_t> > samples(2);
+  size_t sPos[4] = {1, 2, 4, 8};   samples[0].assign(sPos, sPos + 4);
+  size_t sMixed[4] = {0, 1, 2, 3}; samples[1].assign(sMixed, sMixed + 4);
+
+  vector<Mat3> Hs;
+  homography::kernel::FourPointSolver::SolveBatch(x, y, samples, &Hs);
+  BOOST_CHECK_EQUAL(1, Hs.size());
+  EXPECT_MATRIX_PROP(H_gt, Hs[0], 1e-6);
+
+  // Same behaviour through the drop-in filtered solver.
+  vector<Mat3> HsFiltered;
+  Mat xs = ExtractColumns(x, samples[1]), ys = ExtractColumns(y, samples[1]);
+  homography::kernel::FourPointSolverCheirality::Solve(xs, ys, &HsFiltered);
+  BOOST_CHECK_EQUAL(0, HsFiltered.size());
+}
+
 BOOST_AUTO_TEST_CASE(HomographyKernelTest_Fitting_Normalized) {
   // Define 3 knows homographies (Use as GT).
   vector<Mat3> H_gt(3);
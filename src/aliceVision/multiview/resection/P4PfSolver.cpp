@@ -970,8 +970,8 @@ void computeP4pfPoses(const double *glab, const double *a1, const double *b1, co
   M[6742] = coefs[41];
   M[6826] = coefs[41];
 
-  // GJ elimination
-  GJ(M, 78, 88, 2.2204e-11);
+  // GJ elimination with compile-time sizes
+  GJ<78, 88>(M, 2.2204e-11);
 
   // action matrix
   std::memset(A, 0, sizeof (double) * 100);
@@ -1115,6 +1115,29 @@ void getRigidTransform(const Mat &pp1, const Mat &pp2, Mat &R, Vec3 &t)
   t = -R * p1mean + p2mean;
 }
 
+void P4PfSolver::solveMany(const Mat &pt2D,
+                           const Mat &pt3D,
+                           const std::vector<std::vector<std::size_t>> &samples,
+                           std::vector<std::vector<p4fSolution>> *models)
+{
+  models->resize(samples.size());
+  // gather buffers reused across the samples
+  Mat spt2D(2, 4);
+  Mat spt3D(3, 4);
+  for(std::size_t s = 0; s < samples.size(); ++s)
+  {
+    const std::vector<std::size_t> &sample = samples[s];
+    assert(sample.size() == 4);
+    for(int i = 0; i < 4; ++i)
+    {
+      spt2D.col(i) = pt2D.col(sample[i]);
+      spt3D.col(i) = pt3D.col(sample[i]);
+    }
+    (*models)[s].clear();
+    solve(spt2D, spt3D, &(*models)[s]);
+  }
+}
+
 void P4PfSolver::solve(const Mat &pt2Dx, const Mat &pt3Dx, std::vector<p4fSolution> *models)
 {
   Mat pt2D(pt2Dx);
@@ -1146,7 +1169,7 @@ void P4PfSolver::solve(const Mat &pt2Dx, const Mat &pt3Dx, std::vector<p4fSoluti
   if(glab * glac * glad * glbc * glbd * glcd < tol)
     return;
 
-  Mat A = Mat::Zero(10, 10);
+  Eigen::Matrix<double, 10, 10> A = Eigen::Matrix<double, 10, 10>::Zero();
   {
     const double gl[] = {glab, glac, glad, glbc, glbd, glcd};
     const double *a1 = pt2D.col(0).data();
@@ -1159,11 +1182,10 @@ void P4PfSolver::solve(const Mat &pt2Dx, const Mat &pt3Dx, std::vector<p4fSoluti
 
   Mat vSol;
   {
-    Eigen::EigenSolver<Mat> es(A.transpose());
-    Eigen::MatrixXcd sol = es.eigenvectors();
-    Eigen::MatrixXcd diag = sol.row(0).cwiseInverse().asDiagonal();
-
-    sol = sol.block(1, 0, 4, 10) * diag;
+    Eigen::EigenSolver<Eigen::Matrix<double, 10, 10> > es(A.transpose());
+    const Eigen::Matrix<std::complex<double>, 10, 10> evec = es.eigenvectors();
+    const Eigen::MatrixXcd sol =
+        evec.block(1, 0, 4, 10) * evec.row(0).cwiseInverse().asDiagonal();
 
     // contain at least one NaN
     if(isNan(sol))
@@ -1183,13 +1205,13 @@ void P4PfSolver::solve(const Mat &pt2Dx, const Mat &pt3Dx, std::vector<p4fSoluti
     const double zb = vSol(2, i);
 
     // create p3d points in a camera coordinate system(using depths)
-    Mat p3dc = Mat(3, 4);
+    Mat34 p3dc;
     p3dc << pt2D(0, 0), zb * pt2D(0, 1), zc * pt2D(0, 2), zd * pt2D(0, 3),
             pt2D(1, 0), zb * pt2D(1, 1), zc * pt2D(1, 2), zd * pt2D(1, 3),
             f, zb * f, zc * f, zd * f;
 
     // fix scale(recover 'za')
-    Mat d = Mat(6, 1);
+    Vec6 d;
     d(0, 0) = sqrt(glab / (p3dc.col(0) - p3dc.col(1)).squaredNorm());
     d(1, 0) = sqrt(glac / (p3dc.col(0) - p3dc.col(2)).squaredNorm());
     d(2, 0) = sqrt(glad / (p3dc.col(0) - p3dc.col(3)).squaredNorm());
@@ -7,7 +7,9 @@
 
 #include <aliceVision/numeric/numeric.hpp>
 
+#include <cmath>
 #include <iostream>
+#include <vector>
 
 namespace aliceVision {
 namespace resection {
@@ -80,6 +82,23 @@ struct P4PfSolver
                     const Mat &pt3Dx,
                     std::vector<p4fSolution> *models);
 
+  /**
+   * @brief Batch version solving many minimal 4-point samples at once.
+   *
+   * The per-sample points are gathered into buffers reused across the samples,
+   * so repeated hypothesis generation (e.g. by RANSAC) avoids any per-call
+   * allocation besides the output models.
+   *
+   * @param[in] pt2D 2 x n matrix with all the feature vectors (each column is a vector)
+   * @param[in] pt3D 3 x n matrix with the corresponding 3D world points
+   * @param[in] samples one entry per minimal sample, each holding 4 column indices
+   * @param[out] models (*models)[i] receives the solutions of samples[i]
+   */
+  static void solveMany(const Mat &pt2D,
+                        const Mat &pt3D,
+                        const std::vector<std::vector<std::size_t>> &samples,
+                        std::vector<std::vector<p4fSolution>> *models);
+
   /**
    * @brief Compute the residual of the projection distance(pt2D, Project(P,pt3D)).
    * @param[in] solution
@@ -100,6 +119,131 @@ struct P4PfSolver
  */
 void GJ(double *A, int rcnt, int ccnt, double tol);
 
+/**
+ * @brief GJ elimination with compile-time matrix dimensions.
+ *
+ * Same algorithm as GJ() but with the sizes as template parameters, so the
+ * compiler can keep the loop bounds and row strides as constants; this is the
+ * variant used for the fixed 78 x 88 elimination of the solver.
+ *
+ * @tparam rcnt number of rows
+ * @tparam ccnt number of columns
+ * @param[in,out] A
+ * @param[in] tol
+ */
+template<int rcnt, int ccnt>
+inline void GJ(double *A, double tol)
+{
+  int row = 0;
+  int col = 0;
+  int ofs = 0;
+
+  while(row < rcnt && col < ccnt)
+  {
+    // find pivot
+    double apivot = 0;
+    double pivot = 0;
+    int pivot_r = -1;
+
+    int pofs = ofs;
+    for(int k = row; k < rcnt; ++k)
+    {
+      // pivot selection criteria here !
+      if(std::abs(*(A + pofs)) > apivot)
+      {
+        pivot = *(A + pofs);
+        apivot = std::abs(pivot);
+        pivot_r = k;
+      }
+      pofs += ccnt;
+    }
+
+    if(apivot < tol)
+    {
+      // empty col - shift to next col (or jump)
+      ++col;
+      ++ofs;
+    }
+    else
+    {
+      // process rows
+      const double pivot_i = 1.0 / pivot;
+
+      // exchange pivot and selected rows
+      // + divide row
+      if(pivot_r == row)
+      {
+        int srcofs = ofs;
+        for(int c = col; c < ccnt; ++c)
+        {
+          *(A + srcofs) = *(A + srcofs) * pivot_i;
+          srcofs++;
+        }
+      }
+      else
+      {
+        int srcofs = ofs;
+        int dstofs = ccnt * pivot_r + col;
+        for(int c = col; c < ccnt; ++c)
+        {
+          const double b = *(A + srcofs);
+          *(A + srcofs) = *(A + dstofs) * pivot_i;
+          *(A + dstofs) = b;
+
+          ++srcofs;
+          ++dstofs;
+        }
+      }
+
+      // zero bottom
+      pofs = ofs + ccnt;
+      for(int k = row + 1; k < rcnt; ++k)
+      {
+        if(std::abs(*(A + pofs)) > tol)
+        {
+          // nonzero row
+          const double b = *(A + pofs);
+          int dstofs = pofs + 1;
+          int srcofs = ofs + 1;
+          for(int c = col + 1; c < ccnt; ++c)
+          {
+            *(A + dstofs) = (*(A + dstofs) - *(A + srcofs) * b);
+            ++dstofs;
+            ++srcofs;
+          }
+          *(A + pofs) = 0;
+        }
+        pofs += ccnt;
+      }
+
+      // zero top
+      pofs = col;
+      for(int k = 0; k < row; ++k)
+      {
+        if(std::abs(*(A + pofs)) > tol)
+        {
+          // nonzero row
+          const double b = *(A + pofs);
+          int dstofs = pofs + 1;
+          int srcofs = ofs + 1;
+          for(int c = col + 1; c < ccnt; ++c)
+          {
+            *(A + dstofs) = (*(A + dstofs) - *(A + srcofs) * b);
+            ++dstofs;
+            ++srcofs;
+          }
+          *(A + pofs) = 0;
+        }
+        pofs += ccnt;
+      }
+
+      ++row;
+      ++col;
+      ofs += ccnt + 1;
+    }
+  }
+}
+
 /**
  * @brief Prepare polynomial coefficients.
  * @param[in] src1
@@ -92,6 +92,45 @@ BOOST_AUTO_TEST_CASE(Resection_P4Pf_AssignmentWithMoreResults)
   BOOST_CHECK(pass);
 }
 
+BOOST_AUTO_TEST_CASE(Resection_P4Pf_BatchMatchesSingleSampleCalls)
+{
+  // the data of the two assignments above, as one 8-point set and two samples
+  Mat pt2D(2, 8);
+  pt2D << -493.1500, 1051.9100, 176.9500, -1621.9800, 774.88000, -772.31000, -1661.63300, -1836.57300,
+          -878.4550, -984.7530, -381.4300, -543.3450, -534.74500, -554.09400, -585.53300, -430.03000;
+  Mat pt3D(3, 8);
+  pt3D << 2.7518, 2.2375, 1.1940, 2.5778, 2.01852, 1.00709, 0.74051, 0.61962,
+          0.1336, -0.3709, 0.2048, -0.9147, 0.02133, 0.30770, 0.16656, 0.11249,
+          -0.5491, -2.0511, 1.1480, -1.6151, -1.68077, 0.81502, 1.21056, 1.22624;
+
+  std::vector<std::vector<std::size_t>> samples(2);
+  for(std::size_t i = 0; i < 4; ++i)
+  {
+    samples[0].push_back(i);
+    samples[1].push_back(4 + i);
+  }
+
+  std::vector<std::vector<resection::p4fSolution>> modelsMany;
+  resection::P4PfSolver::solveMany(pt2D, pt3D, samples, &modelsMany);
+  BOOST_CHECK_EQUAL(samples.size(), modelsMany.size());
+
+  for(std::size_t s = 0; s < samples.size(); ++s)
+  {
+    Mat spt2D(2, 4);
+    Mat spt3D(3, 4);
+    for(int i = 0; i < 4; ++i)
+    {
+      spt2D.col(i) = pt2D.col(samples[s][i]);
+      spt3D.col(i) = pt3D.col(samples[s][i]);
+    }
+    std::vector<resection::p4fSolution> models;
+    resection::P4PfSolver::solve(spt2D, spt3D, &models);
+    BOOST_CHECK_EQUAL(models.size(), modelsMany[s].size());
+    for(std::size_t m = 0; m < models.size(); ++m)
+      BOOST_CHECK(isEqual(models[m], modelsMany[s][m]));
+  }
+}
+
 BOOST_AUTO_TEST_CASE(Resection_P4Pf_AssignmentWithNoResults)
 {
   // DATA
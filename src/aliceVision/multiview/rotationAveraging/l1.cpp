@@ -5,6 +5,9 @@
 
 #include "l1.hpp"
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <Eigen/IterativeLinearSolvers>
 
 #ifdef ALICEVISION_ROTATION_AVERAGING_WITH_BOOST
 #include <boost/graph/adjacency_list.hpp>
@@ -28,6 +31,7 @@
 #include "ceres/ceres.h"
 #include "ceres/rotation.h"
 
+#include <algorithm>
 #include <map>
 #include <queue>
 #include <stdint.h>
@@ -287,6 +291,64 @@ bool IterativelyReweightedLeastSquares(
   return TIterativelyReweightedLeastSquares(A, b, x, sigma, eps);
 }
 
+// Multithreaded IRLS implementation:
+// - the robust reweighting of the errors is multithreaded,
+// - the (symmetric positive) normal equations stay sparse and are solved with a
+//   conjugate gradient, whose sparse matrix products are themselves multithreaded
+//   by Eigen when OpenMP is enabled, instead of a dense Cholesky factorization.
+bool IterativelyReweightedLeastSquares_MT(
+  const Eigen::SparseMatrix<REAL, Eigen::ColMajor>& A,
+  const Eigen::Matrix<REAL, Eigen::Dynamic, 1>& b,
+  Eigen::Matrix<REAL, Eigen::Dynamic, 1>& x,
+  REAL sigma, REAL eps)
+{
+  typedef Eigen::SparseMatrix<REAL, Eigen::RowMajor> RowSparseMatrix;
+  typedef Eigen::Matrix<REAL, Eigen::Dynamic, 1> Vector;
+  const unsigned m = (unsigned)b.size();
+  const unsigned n = (unsigned)x.size();
+  assert(A.rows() == m && A.cols() == n);
+
+  // row-major products are the ones Eigen multithreads
+  const RowSparseMatrix At(A.transpose());
+
+  Eigen::ConjugateGradient<RowSparseMatrix, Eigen::Lower|Eigen::Upper> solver;
+
+  // iterate optimization till the desired precision is reached
+  Vector xp(n), e(m);
+  const REAL sigmaSq(Square(sigma));
+  unsigned iter = 0;
+  REAL delta = std::numeric_limits<REAL>::max(), deltap;
+  do {
+    xp = x;
+    // compute error vector
+    e = A*x-b;
+    // compute robust weights using the Huber-like loss function
+#pragma omp parallel for
+    for (int i=0; i<(int)m; ++i) {
+      REAL& err = e(i);
+      const REAL errSq(Square(err));
+      err = sigmaSq / (errSq + sigmaSq);
+    }
+    // solve the weighted linear system using l2 norm
+    const RowSparseMatrix AtF(At*e.asDiagonal());
+    const RowSparseMatrix H(AtF*A); // symmetric: At * diag(weights) * A
+    solver.compute(H);
+    if (solver.info() != Eigen::Success) {
+      ALICEVISION_LOG_WARNING("error: decomposing linear system failed");
+      return false;
+    }
+    x = solver.solveWithGuess(AtF*b, x);
+    if (solver.info() != Eigen::Success) {
+      ALICEVISION_LOG_WARNING("error: solving linear system failed");
+      return false;
+    }
+    if (++iter > 32)
+      break;
+    deltap = delta; delta = (xp-x).norm();
+  } while (delta > eps && (deltap-delta)/delta > 1e-2);
+  return true;
+}
+
 /////////////////////////
 
 // given an array of values, compute the X84 threshold as in:
@@ -704,6 +766,141 @@ bool RefineRotationsAvgL1IRLS(
 
   return true;
 } // RefineRotationsAvgL1IRLS
+//----------------------------------------------------------------
+
+
+// build A in Ax=b (multithreaded & deterministic: each relative rotation owns a
+// fixed range of the triplet list, the zero-valued slots are dropped before insertion)
+inline void _FillMappingMatrixMT(
+  const RelativeRotations& RelRs,
+  const size_t nMainViewID,
+  Eigen::SparseMatrix<REAL,Eigen::ColMajor>& A)
+{
+  typedef Eigen::Triplet<REAL> Triplet;
+  std::vector<Triplet> triplets(RelRs.size()*6, Triplet(0, 0, REAL(0)));
+
+#pragma omp parallel for
+  for(int r=0; r<(int)RelRs.size(); ++r) {
+    const RelativeRotation& relR = RelRs[r];
+    const std::size_t t = std::size_t(r)*6;
+    if (relR.i != nMainViewID) {
+      const int j = 3*int(relR.i<nMainViewID ? relR.i : relR.i-1);
+      triplets[t+0] = Triplet(3*r+0, j+0, REAL(-1));
+      triplets[t+1] = Triplet(3*r+1, j+1, REAL(-1));
+      triplets[t+2] = Triplet(3*r+2, j+2, REAL(-1));
+    }
+    if (relR.j != nMainViewID) {
+      const int j = 3*int(relR.j<nMainViewID ? relR.j : relR.j-1);
+      triplets[t+3] = Triplet(3*r+0, j+0, REAL(1));
+      triplets[t+4] = Triplet(3*r+1, j+1, REAL(1));
+      triplets[t+5] = Triplet(3*r+2, j+2, REAL(1));
+    }
+  }
+
+  triplets.erase(std::remove_if(triplets.begin(), triplets.end(),
+                                [](const Triplet& t) { return t.value() == REAL(0); }),
+                 triplets.end());
+
+  A.setFromTriplets(triplets.begin(), triplets.end());
+  A.makeCompressed();
+}
+
+// compute errors for each relative rotation (multithreaded, each relative
+// rotation owns its own 3 rows of b)
+inline void _FillErrorMatrixMT(
+  const RelativeRotations& RelRs,
+  const Matrix3x3Arr& Rs,
+  Eigen::Matrix<REAL,Eigen::Dynamic,1>& b)
+{
+#pragma omp parallel for
+  for (int r = 0; r < (int)RelRs.size(); ++r) {
+    const RelativeRotation& relR = RelRs[r];
+    const Matrix3x3& Ri = Rs[relR.i];
+    const Matrix3x3& Rj = Rs[relR.j];
+    const Matrix3x3& Rij = relR.Rij;
+    const Mat3 eRij(Rj.transpose()*Rij*Ri);
+    const aliceVision::Vec3 erij;
+    ceres::RotationMatrixToAngleAxis((const double*)eRij.data(), (double*)erij.data());
+    b.block<3,1>(3*r,0) = aliceVision::Vec3(erij*relR.weight);
+  }
+}
+
+// Multithreaded refinement of the global rotations using the given relative rotations:
+// IRLS only (see [1]), the robust reweighting stands in for the dense L1RA stage.
+bool RefineRotationsAvgIRLS_MT(
+  const RelativeRotations& RelRs,
+  Matrix3x3Arr& Rs,
+  const size_t nMainViewID,
+  REAL sigma)
+{
+  assert(!RelRs.empty() && !Rs.empty());
+  assert(Rs[nMainViewID] == Matrix3x3::Identity());
+
+  REAL fMinBefore, fMaxBefore, fMeanBefore = RelRotationAvgError(RelRs, Rs, &fMinBefore, &fMaxBefore);
+
+  const unsigned nObss = (unsigned)RelRs.size();
+  const unsigned nVars = (unsigned)Rs.size()-1; // main view is kept constant
+  const unsigned m = nObss*3;
+  const unsigned n = nVars*3;
+
+  // build mapping matrix A in Ax=b
+  Eigen::SparseMatrix<REAL,Eigen::ColMajor> A(m, n);
+  _FillMappingMatrixMT(RelRs, nMainViewID, A);
+
+  // init x with 0 that corresponds to trusting completely the initial Ri guess
+  Vec x(Vec::Zero(n)), b(m);
+
+  // IRLS iterate optimization till the desired precision is reached
+  REAL e = std::numeric_limits<REAL>::max(), ep;
+  unsigned iter = 0;
+  do {
+    // compute errors for each relative rotation
+    _FillErrorMatrixMT(RelRs, Rs, b);
+    // solve the linear system using l2 norm
+    if (!IterativelyReweightedLeastSquares_MT(A, b, x, sigma)) {
+      ALICEVISION_LOG_WARNING("error: l2 iterative regression failed");
+      return false;
+    }
+    ep = e; e = x.norm();
+    if (ep < e)
+      break;
+    // apply correction to global rotations
+    _CorrectMatrix(x, nMainViewID, Rs);
+  } while (++iter < 32 && e > 1e-5 && (ep-e)/e > 1e-2);
+
+  REAL fMinAfter, fMaxAfter, fMeanAfter = RelRotationAvgError(RelRs, Rs, &fMinAfter, &fMaxAfter);
+
+  ALICEVISION_LOG_DEBUG("Refine global rotations using multithreaded IRLS and " << nObss << " relative rotations:\n"
+    << " error reduced from " << fMeanBefore << "(" <<fMinBefore << " min, " << fMaxBefore << " max)\n"
+    << " to " << fMeanAfter << "(" << fMinAfter << "min,"<< fMaxAfter<< "max)\n"
+    << " in " << iter << " iterations");
+
+  return true;
+} // RefineRotationsAvgIRLS_MT
+
+// Multithreaded variant of GlobalRotationsRobust (see l1.hpp)
+bool GlobalRotationsRobust_MT(
+  const RelativeRotations& RelRs,
+  Matrix3x3Arr& Rs,
+  const size_t nMainViewID,
+  float threshold,
+  std::vector<bool> * vec_Inliers)
+{
+  assert(!Rs.empty());
+
+  // -- Compute coarse global rotation estimates:
+  InitRotationsMST(RelRs, Rs, nMainViewID);
+
+  // refine global rotations based on the relative rotations
+  const bool bOk = RefineRotationsAvgIRLS_MT(RelRs, Rs, nMainViewID);
+
+  // find outlier relative rotations
+  if (threshold>=0 && vec_Inliers)  {
+    FilterRelativeRotations(RelRs, Rs, threshold, vec_Inliers);
+  }
+
+  return bOk;
+} // GlobalRotationsRobust_MT
 
 } // namespace l1
 } // namespace rotationAveraging
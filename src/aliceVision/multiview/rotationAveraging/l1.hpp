@@ -53,6 +53,29 @@ bool GlobalRotationsRobust(
   float threshold = 0.f,
   std::vector<bool> * vec_inliers = nullptr);
 
+/**
+ * @brief Multithreaded variant of GlobalRotationsRobust(): initial estimation along a MST
+ * then Iteratively Reweighted Least Squares refinement, [1].
+ *
+ * The sparse system assembly and the per-edge error computations are multithreaded, and
+ * the normal equations are solved with a sparse conjugate gradient whose matrix products
+ * are themselves multithreaded by Eigen when OpenMP is enabled, instead of a dense
+ * Cholesky factorization. There is no dense L1 regression stage: gross outliers are
+ * handled by the IRLS weights only.
+ *
+ * @param[in] RelRs Relative weighted rotation matrices
+ * @param[out] Rs output global rotation matrices
+ * @param[in] nMainViewID Id of the image considered as Identity (unit rotation)
+ * @param[in] threshold (optionnal) threshold
+ * @param[out] vec_inliers rotation labelled as inliers or outliers
+ */
+bool GlobalRotationsRobust_MT(
+  const RelativeRotations& RelRs,
+  Matrix3x3Arr& Rs,
+  const size_t nMainViewID,
+  float threshold = 0.f,
+  std::vector<bool> * vec_inliers = nullptr);
+
 /**
  * @brief Implementation of Iteratively Reweighted Least Squares (IRLS) [1].
  *
@@ -67,6 +90,21 @@ bool RefineRotationsAvgL1IRLS(
   const size_t nMainViewID,
   REAL sigma=aliceVision::degreeToRadian(5.0));
 
+/**
+ * @brief Multithreaded implementation of Iteratively Reweighted Least Squares (IRLS) [1]
+ * (see GlobalRotationsRobust_MT).
+ *
+ * @param[in] RelRs Relative weighted rotation matrices
+ * @param[out] Rs output global rotation matrices
+ * @param[in] nMainViewID Id of the image considered as Identity (unit rotation)
+ * @param[in] sigma factor
+ */
+bool RefineRotationsAvgIRLS_MT(
+  const RelativeRotations& RelRs,
+  Matrix3x3Arr& Rs,
+  const size_t nMainViewID,
+  REAL sigma=aliceVision::degreeToRadian(5.0));
+
 /**
  * @brief Sort relative rotation as inlier, outlier rotations.
  *
@@ -112,6 +150,14 @@ bool IterativelyReweightedLeastSquares(
   Eigen::Matrix<REAL, Eigen::Dynamic, 1>& x,
   REAL sigma, REAL eps=1e-5);
 
+/// Multithreaded IRLS [1] for sparse A matrix, solving the normal equations with
+/// a sparse conjugate gradient instead of a dense Cholesky factorization
+bool IterativelyReweightedLeastSquares_MT(
+  const Eigen::SparseMatrix<REAL, Eigen::ColMajor>& A,
+  const Eigen::Matrix<REAL, Eigen::Dynamic, 1>& b,
+  Eigen::Matrix<REAL, Eigen::Dynamic, 1>& x,
+  REAL sigma, REAL eps=1e-5);
+
 } // namespace l1
 } // namespace rotationAveraging
 } // namespace aliceVision
@@ -146,6 +146,42 @@ BOOST_AUTO_TEST_CASE ( rotationAveraging_RefineRotationsAvgL1IRLS_SimpleTriplet)
   BOOST_CHECK_SMALL(FrobeniusDistance( R20, R), 1e-8);
 }
 
+BOOST_AUTO_TEST_CASE ( rotationAveraging_RefineRotationsAvgIRLS_MT_SimpleTriplet)
+{
+  //--
+  // Same triplet as the L1IRLS test, solved with the multithreaded IRLS variant.
+  //--
+  Mat3 R01 = RotationAroundZ(2.*M_PI/3.0); //120deg
+  Mat3 R12 = RotationAroundZ(2.*M_PI/3.0); //120deg
+  Mat3 R20 = RotationAroundZ(2.*M_PI/3.0); //120deg
+
+  // Setup the relative motions (relative rotations)
+  RelativeRotations vec_relativeRotEstimate;
+  vec_relativeRotEstimate.push_back(RelativeRotation(0, 1, R01, 1));
+  vec_relativeRotEstimate.push_back(RelativeRotation(1, 2, R12, 1));
+  vec_relativeRotEstimate.push_back(RelativeRotation(2, 0, R20, 1));
+
+  //- Solve the global rotation estimation problem :
+  Matrix3x3Arr vec_globalR(3);
+  std::size_t nMainViewID = 0;
+  BOOST_CHECK(GlobalRotationsRobust_MT(vec_relativeRotEstimate, vec_globalR, nMainViewID, 0.0f, NULL));
+
+  // Check that the loop is closing
+  EXPECT_MATRIX_NEAR(Mat3::Identity(), (vec_globalR[0]*vec_globalR[1]*vec_globalR[2]), 1e-4);
+
+  // Check that the found relative rotation matrix give the expected rotation.
+  Mat3 R;
+  Vec3 t, t0 = Vec3::Zero(), t1 = Vec3::Zero();
+  RelativeCameraMotion(vec_globalR[0], t0, vec_globalR[1], t1, &R, &t);
+  BOOST_CHECK_SMALL(FrobeniusDistance( R01, R), 1e-8);
+
+  RelativeCameraMotion(vec_globalR[1], t0, vec_globalR[2], t1, &R, &t);
+  BOOST_CHECK_SMALL(FrobeniusDistance( R12, R), 1e-8);
+
+  RelativeCameraMotion(vec_globalR[2], t0, vec_globalR[0], t1, &R, &t);
+  BOOST_CHECK_SMALL(FrobeniusDistance( R20, R), 1e-8);
+}
+
 // Test over a loop of cameras
 BOOST_AUTO_TEST_CASE ( rotationAveraging_RefineRotationsAvgL1IRLS_CompleteGraph)
 {
@@ -41,28 +41,37 @@ void TriangulateNViewAlgebraic(const Mat2X &x,
   Mat2X::Index nviews = x.cols();
   assert(static_cast<std::size_t>(nviews) == Ps.size());
 
-  Mat design(2 * nviews, 4);
+  // Accumulate the 4x4 normal matrix of the stacked 2x4 design rows instead of
+  // materializing the 2n x 4 design matrix: the sought nullspace vector is the
+  // eigenvector of the smallest eigenvalue of A^t * A. All the state is
+  // fixed-size, so triangulating a whole block of tracks does not allocate.
+  Mat4 AtA = Mat4::Zero();
+  Eigen::Matrix<double, 2, 4> rows;
   for(Mat2X::Index i = 0; i < nviews; ++i)
   {
-    design.block<2, 4>(2 * i, 0) = SkewMatMinimal(x.col(i)) * Ps[i];
+    rows.noalias() = SkewMatMinimal(x.col(i)) * Ps[i];
     if(weights != nullptr)
     {
-      design.block<2, 4>(2 * i, 0) *= (*weights)[i];
+      rows *= (*weights)[i];
     }
+    AtA.noalias() += rows.transpose() * rows;
   }
-  Nullspace(&design, X);
+  // Eigenvalues are sorted in increasing order
+  const Eigen::SelfAdjointEigenSolver<Mat4> eigenSolver(AtA);
+  *X = eigenSolver.eigenvectors().col(0);
 }
 
-void TriangulateNViewLORANSAC(const Mat2X &x, 
+void TriangulateNViewLORANSAC(const Mat2X &x,
                               const std::vector< Mat34 > &Ps,
-                              Vec4 *X, 
-                              std::vector<std::size_t> *inliersIndex, 
-                              const double & thresholdError)
+                              Vec4 *X,
+                              std::vector<std::size_t> *inliersIndex,
+                              const double & thresholdError,
+                              std::mt19937 *randomGenerator)
 {
   using TriangulationKernel = LORansacTriangulationKernel<>;
   TriangulationKernel kernel(x, Ps);
   robustEstimation::ScoreEvaluator<TriangulationKernel> scorer(thresholdError);
-  *X = robustEstimation::LO_RANSAC(kernel, scorer, inliersIndex);
+  *X = robustEstimation::LO_RANSAC(kernel, scorer, inliersIndex, NULL, false, 100, 1e-2, randomGenerator);
 }
 
 double Triangulation::error(const Vec3 &X) const
@@ -86,7 +95,7 @@ Vec3 Triangulation::compute(int iter) const
   // Iterative weighted linear least squares
   Mat3 AtA;
   Vec3 Atb, X;
-  std::vector<double> weights(nviews, double(1.0));
+  weights.assign(nviews, double(1.0));
   for(int it = 0; it < iter; ++it)
   {
     AtA.fill(0.0);
@@ -7,6 +7,7 @@
 
 #include <aliceVision/numeric/numeric.hpp>
 
+#include <random>
 #include <vector>
 
 namespace aliceVision {
@@ -56,12 +57,15 @@ void TriangulateNViewAlgebraic(const Mat2X &x,
  * @param[out] X is the estimated 3D point
  * @param[out] inliersIndex (optional) store the index of the cameras (following Ps ordering, not the view_id) set as Inliers by Lo-RANSAC
  * @param[in] thresholdError (optional) set a threashold value to the Lo-RANSAC scorer
- */                               
-void TriangulateNViewLORANSAC(const Mat2X &x, 
+ * @param[in,out] randomGenerator (optional) draw the Lo-RANSAC samples from this
+ * random stream instead of a device-seeded one, making the triangulation reproducible
+ */
+void TriangulateNViewLORANSAC(const Mat2X &x,
                               const std::vector< Mat34 > &Ps,
                               Vec4 *X,
                               std::vector<std::size_t> *inliersIndex = NULL,
-                              const double & thresholdError = 4.0);                               
+                              const double & thresholdError = 4.0,
+                              std::mt19937 *randomGenerator = nullptr);
 
 //Iterated linear method
 
@@ -98,6 +102,7 @@ protected:
   mutable double zmin; // min depth, mutable since modified in compute(...) const;
   mutable double zmax; // max depth, mutable since modified in compute(...) const;
   mutable double err; // re-projection error, mutable since modified in compute(...) const;
+  mutable std::vector<double> weights; // per-view weights, a member so a reused object keeps its capacity across tracks
   std::vector< std::pair<Mat34, Vec2> > views; // Proj matrix and associated image point
 };
 
@@ -113,21 +113,12 @@ Mat3 LookAt2(const Vec3 &eyePosition3D,
 void MeanAndVarianceAlongRows(const Mat &A,
   Vec *mean_pointer,
   Vec *variance_pointer) {
-    Vec &mean = *mean_pointer;
-    Vec &variance = *variance_pointer;
-    Mat::Index n = A.rows();
-    double m = static_cast<double>(A.cols());
-    mean = variance = Vec::Zero(n);
-
-    for (Mat::Index i = 0; i < n; ++i) {
-      mean(i) += A.row(i).array().sum();
-      variance(i) += (A.row(i).array() * A.row(i).array()).array().sum();
-    }
-
-    mean /= m;
-    for (Mat::Index i = 0; i < n; ++i) {
-      variance(i) = variance(i) / m - Square(mean(i));
-    }
+    // Single pair of rowwise reductions over the whole matrix instead of a
+    // loop over the rows, so Eigen vectorizes across the columns.
+    const double m = static_cast<double>(A.cols());
+    *mean_pointer = A.rowwise().sum() / m;
+    *variance_pointer = A.array().square().matrix().rowwise().sum() / m
+                        - mean_pointer->array().square().matrix();
 }
 
 bool exportMatToTextFile(const Mat & mat, const std::string & filename,
@@ -26,6 +26,7 @@
 #include <numeric>
 #include <string>
 #include <iostream>
+#include <type_traits>
 #include <vector>
 
 namespace aliceVision {
@@ -252,6 +253,83 @@ inline bool AreMatNearEqual(const TMat& X, const TMat& Y, const double epsilon)
   return true;
 }
 
+// Implementation details of Nullspace() / Nullspace2().
+// When the number of columns of the design matrix is known at compile time,
+// the nullspace is extracted from the fixed-size normal matrix A^T * A with
+// the self-adjoint eigensolver (closed-form for 2x2 and 3x3), which avoids
+// the heap allocations of the dynamic-size JacobiSVD. The minimal solvers
+// run millions of times inside the RANSAC loops, where this overhead counts.
+template <typename TMat,
+          bool FixedColumns = (TMat::ColsAtCompileTime != Eigen::Dynamic)>
+struct NullspaceImpl
+{
+  template <typename TVec>
+  static double solve(TMat *A, TVec *nullspace)
+  {
+    Eigen::JacobiSVD<TMat> svd(*A, Eigen::ComputeFullV);
+    (*nullspace) = svd.matrixV().col(A->cols() - 1);
+    return svd.singularValues()(A->cols() - 1);
+  }
+
+  template <typename TVec1, typename TVec2>
+  static double solve2(TMat *A, TVec1 *x1, TVec2 *x2)
+  {
+    Eigen::JacobiSVD<TMat> svd(*A, Eigen::ComputeFullV);
+    TMat V = svd.matrixV();
+    *x1 = V.col(A->cols() - 1);
+    *x2 = V.col(A->cols() - 2);
+    return svd.singularValues()(A->cols() - 1);
+  }
+};
+
+template <typename TMat>
+struct NullspaceImpl<TMat, true>
+{
+  enum { N = TMat::ColsAtCompileTime };
+  typedef typename TMat::Scalar Scalar;
+  typedef Eigen::Matrix<Scalar, N, N> NormalMat;
+  typedef Eigen::SelfAdjointEigenSolver<NormalMat> EigenSolver;
+
+  // 2x2 and 3x3 normal matrices have a closed-form decomposition
+  static void compute(const NormalMat &AtA, EigenSolver &solver, std::true_type)
+  {
+    solver.computeDirect(AtA);
+  }
+
+  static void compute(const NormalMat &AtA, EigenSolver &solver, std::false_type)
+  {
+    solver.compute(AtA);
+  }
+
+  static void compute(const NormalMat &AtA, EigenSolver &solver)
+  {
+    NullspaceImpl::compute(AtA, solver, std::integral_constant<bool, N == 2 || N == 3>());
+  }
+
+  template <typename TVec>
+  static double solve(TMat *A, TVec *nullspace)
+  {
+    // The right singular vectors of A are the eigenvectors of A^T * A, in
+    // ascending order of the squared singular values
+    const NormalMat AtA = A->transpose() * (*A);
+    EigenSolver solver;
+    NullspaceImpl::compute(AtA, solver);
+    (*nullspace) = solver.eigenvectors().col(0);
+    return std::sqrt(std::max(Scalar(0), solver.eigenvalues()(0)));
+  }
+
+  template <typename TVec1, typename TVec2>
+  static double solve2(TMat *A, TVec1 *x1, TVec2 *x2)
+  {
+    const NormalMat AtA = A->transpose() * (*A);
+    EigenSolver solver;
+    NullspaceImpl::compute(AtA, solver);
+    *x1 = solver.eigenvectors().col(0);
+    *x2 = solver.eigenvectors().col(1);
+    return std::sqrt(std::max(Scalar(0), solver.eigenvalues()(0)));
+  }
+};
+
 // Solve the linear system Ax = 0 via SVD. Store the solution in x, such that
 // ||x|| = 1.0. Return the singular value corresponding to the solution.
 // Destroys A and resizes x if necessary.
@@ -261,9 +339,7 @@ double Nullspace(TMat *A, TVec *nullspace)
 {
   if(A->rows() >= A->cols())
   {
-    Eigen::JacobiSVD<TMat> svd(*A, Eigen::ComputeFullV);
-    (*nullspace) = svd.matrixV().col(A->cols() - 1);
-    return svd.singularValues()(A->cols() - 1);
+    return NullspaceImpl<TMat>::solve(A, nullspace);
   }
   // Extend A with rows of zeros to make it square. It's a hack, but is
   // necessary until Eigen supports SVD with more columns than rows.
@@ -284,11 +360,7 @@ inline double Nullspace2(TMat *A, TVec1 *x1, TVec2 *x2)
 {
   if(A->rows() >= A->cols())
   {
-    Eigen::JacobiSVD<TMat> svd(*A, Eigen::ComputeFullV);
-    TMat V = svd.matrixV();
-    *x1 = V.col(A->cols() - 1);
-    *x2 = V.col(A->cols() - 2);
-    return svd.singularValues()(A->cols() - 1);
+    return NullspaceImpl<TMat>::solve2(A, x1, x2);
   }
   // Extend A with rows of zeros to make it square. It's a hack, but is
   // necessary until Eigen supports SVD with more columns than rows.
@@ -58,19 +58,26 @@ void Rig::setTrackingResult(
         std::vector<localization::LocalizationResult> vLocalizationResults,
         std::size_t i)
 {
-  _vLocalizationResults.emplace(i, vLocalizationResults);
+  // replace any previous sequence of the camera, so that a calibrated rig can
+  // be fed with incrementally longer takes and re-optimized
+  _vLocalizationResults[i].swap(vLocalizationResults);
 }
 
 bool Rig::initializeCalibration()
 {
-  if(_isInitialized)
+  // Warm start: when the rig holds the relative poses of a previous
+  // calibration, keep them as the initial guess instead of searching the best
+  // relative pose again, and only update the witness camera poses for the
+  // frames of the new sequences.
+  const bool warmStart = _isInitialized && (_vRelativePoses.size() == _vLocalizationResults.size()-1);
+  if(_isInitialized && !warmStart)
   {
     ALICEVISION_LOG_DEBUG("The rig is already initialized");
     return _isInitialized;
   }
   // check that there are cameras
   assert(_vLocalizationResults.size()>0);
-  
+
   // make all the cameras have the same number of localizationResults (equal to the shortest clip)
   const std::size_t nCams = _vLocalizationResults.size();
   {
@@ -79,58 +86,65 @@ bool Rig::initializeCalibration()
       shortestSeqLength = std::min(shortestSeqLength, v.second.size());
     for (auto& v: _vLocalizationResults)
       v.second.resize(shortestSeqLength);
-  
+
     if(shortestSeqLength == 0)
     {
         ALICEVISION_LOG_DEBUG("The calibration results are empty!");
         return false;
     }
   }
-  
+
   // Tracker of the main cameras
   std::vector<localization::LocalizationResult> & resMainCamera = _vLocalizationResults[0];
-  
-  // Clear all relative poses
-  _vRelativePoses.clear();
-  _vRelativePoses.reserve(nCams-1);
-  
-  // Loop over all witness cameras
-  for(std::size_t iLocalizer=1 ; iLocalizer < nCams ; ++iLocalizer)
+
+  if(warmStart)
   {
-    // Perform the pose averaging over all relative pose between the main camera
-    // (index 0) and the witness camera (index i)
-    std::vector<localization::LocalizationResult> & resWitnessCamera = _vLocalizationResults[iLocalizer];
-    
-    // vRelativePoses will store all the relative poses overall frames where both
-    // the pose computation of the main camera and witness camera succeed
-    std::vector<geometry::Pose3> vRelativePoses;
-    vRelativePoses.reserve(resWitnessCamera.size());
-    
-    for(std::size_t iView=0 ; iView < resWitnessCamera.size() ; ++iView )
+    ALICEVISION_LOG_DEBUG("Warm starting the rig calibration from the previous relative poses");
+  }
+  else
+  {
+    // Clear all relative poses
+    _vRelativePoses.clear();
+    _vRelativePoses.reserve(nCams-1);
+
+    // Loop over all witness cameras
+    for(std::size_t iLocalizer=1 ; iLocalizer < nCams ; ++iLocalizer)
     {
-      // Check that both pose computations succeeded 
-      if ( resMainCamera[iView].isValid() && resWitnessCamera[iView].isValid() )
+      // Perform the pose averaging over all relative pose between the main camera
+      // (index 0) and the witness camera (index i)
+      std::vector<localization::LocalizationResult> & resWitnessCamera = _vLocalizationResults[iLocalizer];
+
+      // vRelativePoses will store all the relative poses overall frames where both
+      // the pose computation of the main camera and witness camera succeed
+      std::vector<geometry::Pose3> vRelativePoses;
+      vRelativePoses.reserve(resWitnessCamera.size());
+
+      for(std::size_t iView=0 ; iView < resWitnessCamera.size() ; ++iView )
       {
-        // q0 ~ [poseMain] Q
-        // q1 ~ [relative][poseMain] Q = [poseWitness]Q
-        // [relative] = [poseWitness]*inv([poseMain])
-        vRelativePoses.push_back(computeRelativePose(resMainCamera[iView].getPose(), 
-                                                     resWitnessCamera[iView].getPose()));
+        // Check that both pose computations succeeded
+        if ( resMainCamera[iView].isValid() && resWitnessCamera[iView].isValid() )
+        {
+          // q0 ~ [poseMain] Q
+          // q1 ~ [relative][poseMain] Q = [poseWitness]Q
+          // [relative] = [poseWitness]*inv([poseMain])
+          vRelativePoses.push_back(computeRelativePose(resMainCamera[iView].getPose(),
+                                                       resWitnessCamera[iView].getPose()));
+        }
       }
+      if(vRelativePoses.empty())
+      {
+        ALICEVISION_CERR("Unable to find candidate poses between the main camera and "
+                "the witness camera " << iLocalizer << "\nAborting...");
+        return false;
+      }
+      geometry::Pose3 optimalRelativePose;
+      findBestRelativePose(vRelativePoses, iLocalizer, optimalRelativePose );
+
+      //poseAveraging(vRelativePoses, averageRelativePose);
+      _vRelativePoses.push_back(optimalRelativePose);
     }
-    if(vRelativePoses.empty())
-    {
-      ALICEVISION_CERR("Unable to find candidate poses between the main camera and "
-              "the witness camera " << iLocalizer << "\nAborting...");
-      return false;
-    }
-    geometry::Pose3 optimalRelativePose;
-    findBestRelativePose(vRelativePoses, iLocalizer, optimalRelativePose );
-  
-    //poseAveraging(vRelativePoses, averageRelativePose);
-    _vRelativePoses.push_back(optimalRelativePose);
   }
-  
+
   // Update all poses in all localization results
   for(std::size_t iRelativePose = 0 ; iRelativePose < _vRelativePoses.size() ; ++iRelativePose )
   {
@@ -164,19 +178,21 @@ void Rig::findBestRelativePose(
   const std::vector<localization::LocalizationResult> & resMainCamera = _vLocalizationResults[0];
   const std::vector<localization::LocalizationResult> & resWitnessCamera = _vLocalizationResults[iLocalizer];
   
-  double minReprojError = std::numeric_limits<double>::max();
-  std::size_t iMin = 0;
-  
   assert(vPoses.size() > 0);
-  
-  for(std::size_t i=0 ; i < vPoses.size() ; ++i)
+
+  // Score every candidate relative pose in parallel, each one accumulating
+  // the reprojection error over the whole sequence
+  std::vector<double> vErrors(vPoses.size(), 0.0);
+
+  #pragma omp parallel for schedule(dynamic)
+  for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(vPoses.size()); ++i)
   {
     const geometry::Pose3 & relativePose = vPoses[i];
 
     double error = 0;
     for(std::size_t j=0 ; j < resWitnessCamera.size() ; ++j )
     {
-      // Check that both pose computations succeeded 
+      // Check that both pose computations succeeded
       if ( ( resMainCamera[j].isValid() ) && ( resWitnessCamera[j].isValid() ) )
       {
         // [poseWitness] = [relativePose]*[poseMainCamera]
@@ -184,11 +200,18 @@ void Rig::findBestRelativePose(
         error += reprojectionError(resWitnessCamera[j], poseWitnessCamera);
       }
     }
-    if ( error < minReprojError )
+    vErrors[i] = error;
+  }
+
+  double minReprojError = std::numeric_limits<double>::max();
+  std::size_t iMin = 0;
+  for(std::size_t i=0 ; i < vPoses.size() ; ++i)
+  {
+    if ( vErrors[i] < minReprojError )
     {
       iMin = i;
-      minReprojError = error;
-    }           
+      minReprojError = vErrors[i];
+    }
   }
   result = vPoses[iMin];
   
@@ -327,7 +350,8 @@ bool Rig::optimizeCalibration()
 
   for(auto &elem : vMainPoses)
   {
-    auto pose = elem.second;
+    // take the address of the stored pose, not of a temporary copy
+    std::vector<double> & pose = elem.second;
     double * parameter_block = &pose[0];
     assert(parameter_block && "parameter_block is null in vMainPoses");
     problem.AddParameterBlock(parameter_block, 6);
@@ -397,74 +421,98 @@ bool Rig::optimizeCalibration()
   // todo: make the LOSS function and the parameter an option
 
   // For all visibility add reprojections errors:
+  // collect the views contributing residuals, so the cost functions of every
+  // view can be built in parallel
+  std::vector<std::pair<std::size_t, std::size_t> > contributingViews;
   for(std::size_t iLocalizer = 0 ; iLocalizer < _vLocalizationResults.size() ; ++iLocalizer)
   {
-    const std::vector<localization::LocalizationResult> & currentResult = _vLocalizationResults[iLocalizer];
-    
+    const std::vector<localization::LocalizationResult> & currentResult = _vLocalizationResults.at(iLocalizer);
+
     for(std::size_t iView = 0 ; iView < currentResult.size() ; ++iView)
     {
       // if the current localization is not valid skip it
       if(!currentResult[iView].isValid())
         continue;
-      
-      // if it is not the main camera and the same view was not localized for the 
+
+      // if it is not the main camera and the same view was not localized for the
       // main camera, skip it
-      if( (iLocalizer != 0) && (!_vLocalizationResults[0][iView].isValid()) )
+      if( (iLocalizer != 0) && (!_vLocalizationResults.at(0)[iView].isValid()) )
         continue;
-      
-      // Get the inliers 3D points
-      const Mat & points3D = currentResult[iView].getPt3D();
-      // Get their image locations (also referred as observations)
-      const Mat & points2D = currentResult[iView].getPt2D();
-      
-      // Add a residual block for all inliers
-      for(const IndexT iPoint : currentResult[iView].getInliers() )
+
+      contributingViews.emplace_back(iLocalizer, iView);
+    }
+  }
+
+  // Build the cost functions of every view in parallel; adding the residual
+  // blocks to the ceres problem is not thread safe and stays serial below.
+  std::vector<std::vector<ceres::CostFunction*> > costFunctionsPerView(contributingViews.size());
+
+  #pragma omp parallel for schedule(dynamic)
+  for(std::ptrdiff_t v = 0; v < static_cast<std::ptrdiff_t>(contributingViews.size()); ++v)
+  {
+    const std::size_t iLocalizer = contributingViews[v].first;
+    const std::size_t iView = contributingViews[v].second;
+    const localization::LocalizationResult & currentResult = _vLocalizationResults.at(iLocalizer)[iView];
+
+    // Get the inliers 3D points
+    const Mat & points3D = currentResult.getPt3D();
+    // Get their image locations (also referred as observations)
+    const Mat & points2D = currentResult.getPt2D();
+
+    std::vector<ceres::CostFunction*> & costFunctions = costFunctionsPerView[v];
+    costFunctions.reserve(currentResult.getInliers().size());
+
+    for(const IndexT iPoint : currentResult.getInliers() )
+    {
+      // Each Residual block takes a point and a camera as input and outputs a 2
+      // dimensional residual. Internally, the cost function stores the observations
+      // and the 3D point and compares the reprojection against the observation.
+      if ( iLocalizer == 0 )
+      {
+        // Vector-2 residual, pose of the rig parameterized by 6 parameters
+        costFunctions.push_back(new ceres::AutoDiffCostFunction<ResidualErrorMainCameraFunctor, 2, 6>(
+          new ResidualErrorMainCameraFunctor(currentResult.getIntrinsics(), points2D.col(iPoint), points3D.col(iPoint) )));
+      }
+      else
       {
-        // Each Residual block takes a point and a camera as input and outputs a 2
-        // dimensional residual. Internally, the cost function stores the observations
-        // and the 3D point and compares the reprojection against the observation.
-        ceres::CostFunction* cost_function;
+        // Vector-2 residual, pose of the rig parameterized by 6 parameters
+        //                  + relative pose of the secondary camera parameterized by 6 parameters
+        costFunctions.push_back(new ceres::AutoDiffCostFunction<ResidualErrorSecondaryCameraFunctor, 2, 6, 6>(
+          new ResidualErrorSecondaryCameraFunctor(currentResult.getIntrinsics(), points2D.col(iPoint), points3D.col(iPoint))));
+      }
+    }
+  }
 
-        // Add a residual block for the main camera
-        if ( iLocalizer == 0 )
-        {
-          // Vector-2 residual, pose of the rig parameterized by 6 parameters
-          cost_function = new ceres::AutoDiffCostFunction<ResidualErrorMainCameraFunctor, 2, 6>(
-          new ResidualErrorMainCameraFunctor(currentResult[iView].getIntrinsics(), points2D.col(iPoint), points3D.col(iPoint) ));
-            
-          if (cost_function)
-          {
-            assert(vMainPoses.find(iView) != vMainPoses.end());
-            problem.AddResidualBlock( cost_function,
-                                      p_LossFunction,
-                                      &vMainPoses[iView][0]);
-          }else
-          {
-            ALICEVISION_CERR("Fail in adding residual block for the main camera");
-          }
-
-        }else
-        // Add a residual block for a secondary camera
-        {
-            // Vector-2 residual, pose of the rig parameterized by 6 parameters
-            //                  + relative pose of the secondary camera parameterized by 6 parameters
-            
-            cost_function = new ceres::AutoDiffCostFunction<ResidualErrorSecondaryCameraFunctor, 2, 6, 6>(
-          new ResidualErrorSecondaryCameraFunctor(currentResult[iView].getIntrinsics(), points2D.col(iPoint), points3D.col(iPoint)));
-          
-          if (cost_function)
-          {
-            assert(vMainPoses.find(iView) != vMainPoses.end());
-            assert(iLocalizer-1 < vRelativePoses.size());
-            problem.AddResidualBlock( cost_function,
-                                      p_LossFunction,
-                                      &vMainPoses[iView][0],
-                                      &vRelativePoses[iLocalizer-1][0]);
-          }else
-          {
-            ALICEVISION_CERR("Fail in adding residual block for a secondary camera");
-          }
-        }
+  for(std::size_t v = 0; v < contributingViews.size(); ++v)
+  {
+    const std::size_t iLocalizer = contributingViews[v].first;
+    const std::size_t iView = contributingViews[v].second;
+
+    for(ceres::CostFunction* cost_function : costFunctionsPerView[v])
+    {
+      if (!cost_function)
+      {
+        ALICEVISION_CERR("Fail in adding residual block for the camera " << iLocalizer);
+        continue;
+      }
+
+      // Add a residual block for the main camera
+      if ( iLocalizer == 0 )
+      {
+        assert(vMainPoses.find(iView) != vMainPoses.end());
+        problem.AddResidualBlock( cost_function,
+                                  p_LossFunction,
+                                  &vMainPoses[iView][0]);
+      }
+      else
+      // Add a residual block for a secondary camera
+      {
+        assert(vMainPoses.find(iView) != vMainPoses.end());
+        assert(iLocalizer-1 < vRelativePoses.size());
+        problem.AddResidualBlock( cost_function,
+                                  p_LossFunction,
+                                  &vMainPoses[iView][0],
+                                  &vRelativePoses[iLocalizer-1][0]);
       }
     }
   }
@@ -481,8 +529,8 @@ bool Rig::optimizeCalibration()
   options.sparse_linear_algebra_library_type = aliceVision_options._sparse_linear_algebra_library_type;
   options.minimizer_progress_to_stdout = aliceVision_options._bVerbose;
   options.logging_type = ceres::SILENT;
-  options.num_threads = 1;//aliceVision_options._nbThreads;
-  options.num_linear_solver_threads = 1;//aliceVision_options._nbThreads;
+  options.num_threads = aliceVision_options._nbThreads;
+  options.num_linear_solver_threads = aliceVision_options._nbThreads;
   
   // Solve BA
   ceres::Solver::Summary summary;
@@ -524,6 +572,7 @@ bool Rig::optimizeCalibration()
   }
     
     // Update the main camera pose after optimization
+  _vPoses.clear(); // do not accumulate the poses of a previous run
   for(std::size_t iView = 0 ; iView < _vLocalizationResults[0].size() ; ++iView)
   {
     if( _vLocalizationResults[0][iView].isValid() )
@@ -613,21 +662,21 @@ geometry::Pose3 poseFromMainToWitness(const geometry::Pose3 &poseMainCamera, con
 
 double reprojectionError(const localization::LocalizationResult & localizationResult, const geometry::Pose3 & pose)
 {
-  double residual = 0;
-  
-  for(const IndexT iInliers : localizationResult.getInliers())
+  const std::vector<std::size_t> & inliers = localizationResult.getInliers();
+  if(inliers.empty())
+    return 0;
+
+  // Gather the inlier 3D points and their observations, so that the pose,
+  // distortion and intrinsics are applied to the whole block through a single
+  // virtual call instead of one per point
+  Mat3X points3D(3, inliers.size());
+  Mat2X points2D(2, inliers.size());
+  for(std::size_t i = 0; i < inliers.size(); ++i)
   {
-    // Inlier 3D point
-    const Vec3 & point3D = localizationResult.getPt3D().col(iInliers);
-    // Its reprojection
-    const Vec2 itsReprojection = localizationResult.getIntrinsics().project(pose, point3D);
-    // Its associated observation location
-    const Vec2 & point2D = localizationResult.getPt2D().col(iInliers);
-    // Residual
-    residual += (point2D(0) - itsReprojection(0))*(point2D(0) - itsReprojection(0));
-    residual += (point2D(1) - itsReprojection(1))*(point2D(1) - itsReprojection(1));
+    points3D.col(i) = localizationResult.getPt3D().col(inliers[i]);
+    points2D.col(i) = localizationResult.getPt2D().col(inliers[i]);
   }
-  return residual;
+  return localizationResult.getIntrinsics().residualsMany(pose, points3D, points2D).squaredNorm();
 }
 
 void cvpause(){
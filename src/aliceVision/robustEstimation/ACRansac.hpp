@@ -112,6 +112,39 @@ static void makelogcombi
 /// NFA and associated index
 typedef std::pair<double,size_t> ErrorIndex;
 
+/**
+ * @brief Iteration-local buffers of ACRANSAC.
+ *
+ * Every vector used inside the estimation loop is drawn from a per-thread
+ * instance of this context instead of being constructed in the loop: the
+ * buffers keep their capacity across the iterations of one estimation and
+ * across the successive estimations run on the same thread (e.g. all the
+ * pairs of a matching job), so the tight sampling loop does not allocate.
+ */
+template<typename ModelT>
+struct ACRansacScratch
+{
+  /// minimal sample indices
+  std::vector<std::size_t> sample;
+  /// up to MAX_MODELS hypotheses per draw
+  std::vector<ModelT> models;
+  /// [residual,index] pairs, ordered for the NFA minimization
+  std::vector<ErrorIndex> residualIndexes;
+  /// raw residuals of the current hypothesis
+  std::vector<double> residuals;
+  /// current sampling domain (shrinks to the best inliers in the focused phase)
+  std::vector<std::size_t> samplingIndexes;
+  /// tabulated log combinations
+  std::vector<float> logcN, logcK;
+
+  /// The scratch context of the calling thread
+  static ACRansacScratch& get()
+  {
+    static thread_local ACRansacScratch instance;
+    return instance;
+  }
+};
+
 /// Find best NFA and its index wrt square error threshold in e.
 static ErrorIndex bestNFA(
   int startIndex, //number of point required for estimation
@@ -150,6 +183,17 @@ static ErrorIndex bestNFA(
  * @param[out] model returned model if found
  * @param[in] precision upper bound of the precision (squared error)
  * @param[in] bVerbose display console log
+ * @param[in] bProsacSampling draw the minimal samples progressively starting
+ *            from the best ranked correspondences (PROSAC); the kernel data
+ *            must be sorted by decreasing match quality
+ * @param[in,out] externalGenerator draw all the samples from this random
+ *            stream instead of a device-seeded one, making the estimation
+ *            reproducible (@see createTaskGenerator)
+ * @param[in] adaptiveConfidence when > 0, stop the random sampling phase as
+ *            soon as the number of drawn samples guarantees, with this
+ *            confidence, that at least one all-inlier minimal sample has been
+ *            drawn given the best inlier ratio found so far (0 keeps the full
+ *            nIter budget)
  *
  * @return (errorMax, minNFA)
  */
@@ -159,7 +203,10 @@ std::pair<double, double> ACRANSAC(const Kernel &kernel,
   size_t nIter = 1024,
   typename Kernel::Model * model = nullptr,
   double precision = std::numeric_limits<double>::infinity(),
-  bool bVerbose = false)
+  bool bVerbose = false,
+  bool bProsacSampling = false,
+  std::mt19937 * externalGenerator = nullptr,
+  double adaptiveConfidence = 0.0)
 {
   vec_inliers.clear();
 
@@ -172,16 +219,22 @@ std::pair<double, double> ACRANSAC(const Kernel &kernel,
     std::numeric_limits<double>::infinity() :
     precision * kernel.normalizer2()(0,0) * kernel.normalizer2()(0,0);
 
-  std::vector<ErrorIndex> vec_residuals(nData); // [residual,index]
-  std::vector<double> vec_residuals_(nData);
+  ACRansacScratch<typename Kernel::Model>& scratch = ACRansacScratch<typename Kernel::Model>::get();
+
+  std::vector<ErrorIndex>& vec_residuals = scratch.residualIndexes; // [residual,index]
+  vec_residuals.resize(nData);
+  std::vector<double>& vec_residuals_ = scratch.residuals;
+  vec_residuals_.resize(nData);
 
   // Possible sampling indices [0,..,nData] (will change in the optimization phase)
-  std::vector<size_t> vec_index(nData);
+  std::vector<size_t>& vec_index = scratch.samplingIndexes;
+  vec_index.resize(nData);
   std::iota(vec_index.begin(), vec_index.end(), 0);
 
   // Precompute log combi
   const double loge0 = log10((double)Kernel::MAX_MODELS * (nData-sizeSample));
-  std::vector<float> vec_logc_n, vec_logc_k;
+  std::vector<float>& vec_logc_n = scratch.logcN;
+  std::vector<float>& vec_logc_k = scratch.logcK;
   makelogcombi(sizeSample, nData, vec_logc_k, vec_logc_n);
 
   // Output parameters
@@ -194,16 +247,32 @@ std::pair<double, double> ACRANSAC(const Kernel &kernel,
 
   bool bACRansacMode = (precision == std::numeric_limits<double>::infinity());
 
+  // Progressive sampling, active until the sampling gets focused on the best
+  // set of inliers found so far
+  bool bProsacPhase = bProsacSampling;
+  std::mt19937 internalGenerator;
+  if (externalGenerator == nullptr)
+  {
+    std::random_device rd;
+    internalGenerator.seed(rd());
+  }
+  std::mt19937 & randomGenerator = (externalGenerator != nullptr) ? *externalGenerator : internalGenerator;
+  ProsacSampler prosacSampler(sizeSample, nData);
+
+  std::vector<std::size_t>& vec_sample = scratch.sample; // Sample indices
+  std::vector<typename Kernel::Model>& vec_models = scratch.models; // Up to max_models solutions
+
   // Main estimation loop.
   for (size_t iter=0; iter < nIter; ++iter)
   {
-    std::vector< std::size_t> vec_sample(sizeSample); // Sample indices
-    if (bACRansacMode)
-      UniformSample(sizeSample, vec_index, vec_sample); // Get random sample
+    if (bProsacPhase)
+      prosacSampler.sample(randomGenerator, vec_sample); // Get progressive sample
+    else if (bACRansacMode)
+      UniformSample(randomGenerator, sizeSample, vec_index, vec_sample); // Get random sample
     else
-      UniformSample(sizeSample, nData, vec_sample); // Get random sample
+      UniformSample(randomGenerator, sizeSample, nData, vec_sample); // Get random sample
 
-    std::vector<typename Kernel::Model> vec_models; // Up to max_models solutions
+    vec_models.clear();
     kernel.Fit(vec_sample, &vec_models);
 
     // Evaluate models
@@ -231,7 +300,21 @@ std::pair<double, double> ACRANSAC(const Kernel &kernel,
           const double error = vec_residuals_[i];
           vec_residuals[i] = ErrorIndex(error, i);
         }
-        std::sort(vec_residuals.begin(), vec_residuals.end());
+        if (maxThreshold == std::numeric_limits<double>::infinity())
+        {
+          std::sort(vec_residuals.begin(), vec_residuals.end());
+        }
+        else
+        {
+          // Only the residuals below the threshold can take part in the NFA
+          // minimization: move them to the front and sort just that prefix.
+          // bestNFA stops at the first residual above the threshold, so the
+          // unsorted tail is never read in order.
+          const std::vector<ErrorIndex>::iterator itBelow =
+            std::partition(vec_residuals.begin(), vec_residuals.end(),
+                           [maxThreshold](const ErrorIndex& res) { return res.first <= maxThreshold; });
+          std::sort(vec_residuals.begin(), itBelow);
+        }
 
         // Most meaningful discrimination inliers/outliers
         const ErrorIndex best = bestNFA(
@@ -268,7 +351,29 @@ std::pair<double, double> ACRANSAC(const Kernel &kernel,
         }
       } //if(bACRansacMode)
     } //for(size_t k...
-    
+
+    // Adaptive termination: bound the number of random draws needed to reach
+    // the requested confidence of having drawn at least one all-inlier
+    // minimal sample, given the best inlier ratio found so far. Only nIter
+    // shrinks: the focused sampling reserve is preserved and triggered when
+    // the bound is reached.
+    if (adaptiveConfidence > 0.0 && better && !vec_inliers.empty())
+    {
+      const double inlierRatio = vec_inliers.size() / (double)nData;
+      const double pAllInlierSample = std::pow(inlierRatio, (double)sizeSample);
+      if (pAllInlierSample >= 1.0)
+      {
+        nIter = iter + 1;
+      }
+      else if (pAllInlierSample > 0.0)
+      {
+        const double nIterConfidence =
+          std::log(1.0 - adaptiveConfidence) / std::log(1.0 - pAllInlierSample);
+        if (nIterConfidence < (double)nIter)
+          nIter = std::max((size_t)std::ceil(nIterConfidence), iter + 1);
+      }
+    }
+
     // Early exit test -> no meaningful model found after nIterReserve*2 iterations
     if (!bACRansacMode && iter > nIterReserve*2)
       break;
@@ -286,6 +391,7 @@ std::pair<double, double> ACRANSAC(const Kernel &kernel,
       {
         // ACRANSAC optimization: draw samples among best set of inliers so far
         vec_index = vec_inliers;
+        bProsacPhase = false;
         if(nIterReserve)
         {
           nIter = iter + 1 + nIterReserve;
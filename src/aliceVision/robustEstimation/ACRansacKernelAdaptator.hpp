@@ -83,6 +83,79 @@ inline bool hasStrongSupport(const matching::MatchesPerDescType& matchesPerDesc,
 }
 
 
+/// Compute the residuals of all the correspondences for a model.
+/// This overload is picked when the error functor provides a whole-block
+/// Errors() and evaluates the residuals in one vectorized pass; otherwise the
+/// fallback below loops over the scalar Error() per correspondence.
+template <typename ErrorT, typename Model>
+inline auto evaluateModelErrors(const Model& model, const Mat& x1, const Mat& x2,
+                                std::vector<double>& vec_errors, int)
+  -> decltype(ErrorT::Errors(model, x1, x2, vec_errors), void())
+{
+  ErrorT::Errors(model, x1, x2, vec_errors);
+}
+
+template <typename ErrorT, typename Model>
+inline void evaluateModelErrors(const Model& model, const Mat& x1, const Mat& x2,
+                                std::vector<double>& vec_errors, ...)
+{
+  vec_errors.resize(x1.cols());
+  for(std::size_t sample = 0; sample < x1.cols(); ++sample)
+    vec_errors[sample] = ErrorT::Error(model, x1.col(sample), x2.col(sample));
+}
+
+/**
+ * @brief Cache of the point set normalization performed by the two view
+ * kernel adaptors.
+ *
+ * The geometric filters may try several models on the same pair of views
+ * (e.g. a fundamental matrix and then a homography): keeping the normalized
+ * coordinates and the conditioning matrices here lets every kernel built for
+ * the pair reuse the same normalization instead of re-conditioning the full
+ * point sets once per model.
+ */
+class PointNormalizationCache
+{
+public:
+  /**
+   * @brief Normalize both point sets from the image sizes, reusing the
+   * previous result when the input did not change since the last call.
+   */
+  void normalize(const Mat &x1, int w1, int h1,
+                 const Mat &x2, int w2, int h2)
+  {
+    if(_valid
+       && _x1Data == x1.data() && _x2Data == x2.data()
+       && _nbPoints == x1.cols()
+       && _w1 == w1 && _h1 == h1 && _w2 == w2 && _h2 == h2)
+      return;
+
+    NormalizePointsFromImageSize(x1, &_x1, &_N1, w1, h1);
+    NormalizePointsFromImageSize(x2, &_x2, &_N2, w2, h2);
+    _x1Data = x1.data();
+    _x2Data = x2.data();
+    _nbPoints = x1.cols();
+    _w1 = w1; _h1 = h1;
+    _w2 = w2; _h2 = h2;
+    _valid = true;
+  }
+
+  const Mat& x1() const {return _x1;}
+  const Mat& x2() const {return _x2;}
+  const Mat3& N1() const {return _N1;}
+  const Mat3& N2() const {return _N2;}
+
+private:
+  Mat _x1, _x2; // Normalized input data
+  Mat3 _N1, _N2; // Matrix used to normalize data
+  // Key of the cached entry
+  const double* _x1Data = nullptr;
+  const double* _x2Data = nullptr;
+  Mat::Index _nbPoints = 0;
+  int _w1 = 0, _h1 = 0, _w2 = 0, _h2 = 0;
+  bool _valid = false;
+};
+
 /// Two view Kernel adapter for the A contrario model estimator
 /// Handle data normalization and compute the corresponding logalpha 0
 ///  that depends of the error model (point to line, or point to point)
@@ -113,19 +186,23 @@ public:
     NormalizePointsFromImageSize(x1, &x1_, &N1_, w1, h1);
     NormalizePointsFromImageSize(x2, &x2_, &N2_, w2, h2);
 
-    // LogAlpha0 is used to make error data scale invariant
-    if(bPointToLine)
-    {
-      // Ratio of containing diagonal image rectangle over image area
-      const double D = sqrt(w2 * (double) w2 + h2 * (double) h2); // diameter
-      const double A = w2 * (double) h2; // area
-      logalpha0_ = log10(2.0 * D / A / N2_(0, 0));
-    }
-    else
-    {
-      // ratio of area : unit circle over image area
-      logalpha0_ = log10(M_PI / (w2 * (double) h2) / (N2_(0, 0) * N2_(0, 0)));
-    }
+    computeLogAlpha0(w2, h2);
+  }
+
+  /// Build the kernel from a normalization cached by the caller, so trying
+  /// several geometric models on the same pair does not re-condition the
+  /// point sets.
+  ACKernelAdaptor(const PointNormalizationCache &normalization,
+                  int w2, int h2, bool bPointToLine = true)
+  : x1_(normalization.x1()), x2_(normalization.x2()),
+  N1_(normalization.N1()), N2_(normalization.N2()),
+  logalpha0_(0.0), bPointToLine_(bPointToLine)
+  {
+    assert(2 == x1_.rows());
+    assert(x1_.rows() == x2_.rows());
+    assert(x1_.cols() == x2_.cols());
+
+    computeLogAlpha0(w2, h2);
   }
 
   enum
@@ -152,9 +229,7 @@ public:
 
   void Errors(const Model & model, std::vector<double> & vec_errors) const
   {
-    vec_errors.resize(x1_.cols());
-    for(std::size_t sample = 0; sample < x1_.cols(); ++sample)
-      vec_errors[sample] = ErrorT::Error(model, x1_.col(sample), x2_.col(sample));
+    evaluateModelErrors<ErrorT>(model, x1_, x2_, vec_errors, 0);
   }
 
   std::size_t NumSamples() const
@@ -176,6 +251,24 @@ public:
   Mat3 normalizer2() const {return N2_;}
   double unormalizeError(double val) const {return sqrt(val) / N2_(0,0);}
 
+protected:
+  // LogAlpha0 is used to make error data scale invariant
+  void computeLogAlpha0(int w2, int h2)
+  {
+    if(bPointToLine_)
+    {
+      // Ratio of containing diagonal image rectangle over image area
+      const double D = sqrt(w2 * (double) w2 + h2 * (double) h2); // diameter
+      const double A = w2 * (double) h2; // area
+      logalpha0_ = log10(2.0 * D / A / N2_(0, 0));
+    }
+    else
+    {
+      // ratio of area : unit circle over image area
+      logalpha0_ = log10(M_PI / (w2 * (double) h2) / (N2_(0, 0) * N2_(0, 0)));
+    }
+  }
+
 protected:
   Mat x1_, x2_; // Normalized input data
   Mat3 N1_, N2_; // Matrix used to normalize data
@@ -409,9 +502,7 @@ public:
   {
     Mat3 F;
     FundamentalFromEssential(model, K1_, K2_, &F);
-    vec_errors.resize(x1_.cols());
-    for(std::size_t sample = 0; sample < x1_.cols(); ++sample)
-      vec_errors[sample] = ErrorT::Error(F, this->x1_.col(sample), this->x2_.col(sample));
+    evaluateModelErrors<ErrorT>(F, this->x1_, this->x2_, vec_errors, 0);
   }
 
   std::size_t NumSamples() const { return x1_.cols(); }
@@ -110,6 +110,41 @@ class LORansacGenericKernel
 };
 
 
+/**
+ * @brief Iteration-local buffers of the LORansac framework.
+ *
+ * The vectors used inside the estimation loops are drawn from a per-thread
+ * instance of this context so their capacity is reused across iterations and
+ * across the successive estimations run on the same thread, instead of being
+ * reallocated in the loops. LO_RANSAC, its local optimization step and the
+ * IRLS refinement nest on the same thread, so each level owns its buffers;
+ * only allSamples is shared, as every level fills it with the same
+ * [0, NumSamples) index list.
+ */
+template<typename ModelT>
+struct LORansacScratch
+{
+  /// the full [0, NumSamples) index list the scorers evaluate on
+  std::vector<std::size_t> allSamples;
+  /// LO_RANSAC: minimal sample and hypotheses
+  std::vector<std::size_t> sampleMain;
+  std::vector<ModelT> modelsMain;
+  /// localOptimization: base inliers, inner sample and LS models
+  std::vector<std::size_t> inliersBase;
+  std::vector<std::size_t> sampleLO;
+  std::vector<ModelT> modelsLO;
+  /// iterativeReweightedLeastSquares: LS models and weights
+  std::vector<ModelT> modelsIRLS;
+  std::vector<double> weights;
+
+  /// The scratch context of the calling thread
+  static LORansacScratch& get()
+  {
+    static thread_local LORansacScratch instance;
+    return instance;
+  }
+};
+
 /**
  * @brief It performs an iterative reweighted least square (IRLS) estimation of the problem
  * defined by \p Kernel. At each step it perform a LS estimation using weights
@@ -148,13 +183,16 @@ double iterativeReweightedLeastSquares(const Kernel &kernel,
   // used in the iterations to update (reduce) the threshold value
   const double deltaTetha = (mtheta*theta - theta) / (numIter-1);
   
-  std::vector<std::size_t> all_samples(total_samples);
+  LORansacScratch<typename Kernel::Model>& scratch = LORansacScratch<typename Kernel::Model>::get();
+
+  std::vector<std::size_t>& all_samples = scratch.allSamples;
+  all_samples.resize(total_samples);
   std::iota(all_samples.begin(), all_samples.end(), 0);
-  
+
   // find inliers from best model with threshold theta
   inliers.clear();
   scorer.Score(kernel, best_model, all_samples, &inliers, theta);
-  
+
   if(inliers.size() < min_samples)
   {
     inliers.clear();
@@ -164,9 +202,10 @@ double iterativeReweightedLeastSquares(const Kernel &kernel,
     }
     return std::numeric_limits<double>::infinity();
   }
-  
+
   // LS model from the above inliers
-  std::vector<typename Kernel::Model> models;
+  std::vector<typename Kernel::Model>& models = scratch.modelsIRLS;
+  models.clear();
   kernel.FitLS(inliers, &models);
   assert(models.size()==1);   // LS fitting must always return 1 model
   
@@ -195,7 +234,7 @@ double iterativeReweightedLeastSquares(const Kernel &kernel,
 //            << " num inliers: " << inliers.size());
     
     // compute the weights for the inliers
-    std::vector<double> weights;
+    std::vector<double>& weights = scratch.weights;
     kernel.computeWeights(models[0], inliers, weights);
     
     // LS with weights on inliers
@@ -251,6 +290,7 @@ double iterativeReweightedLeastSquares(const Kernel &kernel,
  * @param[in,out] best_model In input the model estimated by a minimum solver, as
  * output the best model found.
  * @param[out] bestInliers The inliers supporting the best model.
+ * @param[in,out] generator The random generator used for the inner re-sampling.
  * @param[in] mtheta A threshold multiplier used for IRLS.
  * @param[in] numRep The number of re-sampling/re-estimation of the model.
  * @param[in] minSampleSize Size of the inner sample used for re-estimation.
@@ -261,6 +301,7 @@ double localOptimization(const Kernel &kernel,
                          const Scorer &scorer,
                          typename Kernel::Model &bestModel,
                          std::vector<std::size_t> &bestInliers,
+                         std::mt19937 &generator,
                          double mtheta = std::sqrt(2),
                          std::size_t numRep = 10,
                          std::size_t minSampleSize = 10,
@@ -272,10 +313,13 @@ double localOptimization(const Kernel &kernel,
           "[localOptimization] not enough data to estimate the model!");
   
   const double theta = scorer.getThreshold();
-  
-  std::vector<std::size_t> all_samples(total_samples);
+
+  LORansacScratch<typename Kernel::Model>& scratch = LORansacScratch<typename Kernel::Model>::get();
+
+  std::vector<std::size_t>& all_samples = scratch.allSamples;
+  all_samples.resize(total_samples);
   std::iota(all_samples.begin(), all_samples.end(), 0);
-  
+
   std::size_t debugInit = 0;
   if(!bestInliers.empty())
   {
@@ -295,13 +339,15 @@ double localOptimization(const Kernel &kernel,
   }
      
   // find inliers from best model with larger threshold t*m over all the samples
-  std::vector<std::size_t> inliersBase;
+  std::vector<std::size_t>& inliersBase = scratch.inliersBase;
+  inliersBase.clear();
   scorer.Score(kernel, bestModel, all_samples, &inliersBase, theta*mtheta);
-  assert((inliersBase.size() > min_samples) && 
+  assert((inliersBase.size() > min_samples) &&
           "[localOptimization] not enough data in inliersBase to estimate the model!");
-  
+
   // LS model from the above inliers
-  std::vector<typename Kernel::Model> models;
+  std::vector<typename Kernel::Model>& models = scratch.modelsLO;
+  models.clear();
 //  ALICEVISION_LOG_DEBUG("[localOptim] before: ");
   kernel.FitLS(inliersBase, &models);
 //  ALICEVISION_LOG_DEBUG("[localOptim] after: ");
@@ -323,10 +369,10 @@ double localOptimization(const Kernel &kernel,
   }
   
   // do numRep resampling + iterative LS
+  std::vector<std::size_t>& sample = scratch.sampleLO;
   for(std::size_t i = 0; i < numRep; ++i)
   {
-    std::vector<std::size_t> sample;
-    UniformSample(sampleSize, inliersBase, sample);
+    UniformSample(generator, sampleSize, inliersBase, sample);
     assert(sampleSize > Kernel::MINIMUM_LSSAMPLES);
     assert(sample.size() > Kernel::MINIMUM_LSSAMPLES);
   
@@ -378,6 +424,9 @@ double localOptimization(const Kernel &kernel,
  * @param[in] bVerbose Enable/Disable log messages
  * @param[in] max_iterations Maximum number of iterations for the ransac part.
  * @param[in] outliers_probability The wanted probability of picking outliers.
+ * @param[in,out] externalGenerator draw all the samples from this random
+ * stream instead of a device-seeded one, making the estimation reproducible
+ * (@see createTaskGenerator).
  * @return The best model found.
  */
 template<typename Kernel, typename Scorer>
@@ -387,7 +436,8 @@ typename Kernel::Model LO_RANSAC(const Kernel &kernel,
                                 double *best_score = NULL,
                                 bool bVerbose = false,
                                 std::size_t max_iterations = 100,
-                                double outliers_probability = 1e-2)
+                                double outliers_probability = 1e-2,
+                                std::mt19937 *externalGenerator = nullptr)
 {
   assert(outliers_probability < 1.0);
   assert(outliers_probability > 0.0);
@@ -410,24 +460,42 @@ typename Kernel::Model LO_RANSAC(const Kernel &kernel,
     return bestModel;
   }
 
+  LORansacScratch<typename Kernel::Model>& scratch = LORansacScratch<typename Kernel::Model>::get();
+
   // In this robust estimator, the scorer always works on all the data points
   // at once. So precompute the list ahead of time [0,..,total_samples].
-  std::vector<std::size_t> all_samples(total_samples);
+  std::vector<std::size_t>& all_samples = scratch.allSamples;
+  all_samples.resize(total_samples);
   std::iota(all_samples.begin(), all_samples.end(), 0);
 
-  for(iteration = 0; iteration < max_iterations; ++iteration) 
+  // used for the sampling and by the preemptive verification of the scorer
+  std::mt19937 internalGenerator;
+  if(externalGenerator == nullptr)
   {
-    std::vector<std::size_t> sample;
-    UniformSample(min_samples, total_samples, sample);
+    std::random_device rd;
+    internalGenerator.seed(rd());
+  }
+  std::mt19937 &randomGenerator = (externalGenerator != nullptr) ? *externalGenerator : internalGenerator;
+
+  std::vector<std::size_t>& sample = scratch.sampleMain;
+  std::vector<typename Kernel::Model>& models = scratch.modelsMain;
 
-    std::vector<typename Kernel::Model> models;
+  for(iteration = 0; iteration < max_iterations; ++iteration)
+  {
+    UniformSample(randomGenerator, min_samples, total_samples, sample);
+
+    models.clear();
     kernel.Fit(sample, &models);
 
     // Compute the inlier list for each fit.
-    for(std::size_t i = 0; i < models.size(); ++i) 
+    for(std::size_t i = 0; i < models.size(); ++i)
     {
       std::vector<std::size_t> inliers;
-      double score = scorer.Score(kernel, models[i], all_samples, &inliers);
+      bool rejected = false;
+      double score = scorer.ScorePreemptive(kernel, models[i], all_samples, &inliers, randomGenerator, rejected);
+      // hypothesis abandoned by the preemptive test before the full evaluation
+      if(rejected)
+        continue;
       if(bVerbose)
       {
         ALICEVISION_LOG_DEBUG("sample=" << sample);
@@ -450,7 +518,7 @@ typename Kernel::Model LO_RANSAC(const Kernel &kernel,
         
         if(inliers.size() > Kernel::MINIMUM_LSSAMPLES)
         {
-          score = localOptimization(kernel, scorer, bestModel, inliers);
+          score = localOptimization(kernel, scorer, bestModel, inliers, randomGenerator);
         }
         
         if(bVerbose)
@@ -46,11 +46,20 @@ public:
   };
 
   KernelAdaptorLoRansac(const Mat &x1, int w1, int h1,
-                        const Mat &x2, int w2, int h2, 
-                        bool bPointToLine = true) 
+                        const Mat &x2, int w2, int h2,
+                        bool bPointToLine = true)
           : ACKernelAdaptor<SolverArg, ErrorArg, UnnormalizerArg, ModelArg>(x1, w1, h1, x2, w2, h2, bPointToLine)
   {
   }
+
+  /// Build the kernel from a normalization cached by the caller.
+  /// @see ACKernelAdaptor
+  KernelAdaptorLoRansac(const PointNormalizationCache &normalization,
+                        int w2, int h2,
+                        bool bPointToLine = true)
+          : ACKernelAdaptor<SolverArg, ErrorArg, UnnormalizerArg, ModelArg>(normalization, w2, h2, bPointToLine)
+  {
+  }
   
   void FitLS(const std::vector<std::size_t> &inliers, 
               std::vector<Model> *models, 
@@ -6,10 +6,12 @@
 #pragma once
 
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 #include "aliceVision/robustEstimation/randSampling.hpp"
 #include "aliceVision/robustEstimation/ransacTools.hpp"
 #include <limits>
 #include <numeric>
+#include <random>
 #include <vector>
 #include <iostream>
 #include <iterator>
@@ -110,13 +112,137 @@ typename Kernel::Model RANSAC(
   }
   if (best_score)
     *best_score = best_num_inliers;
-  
+
   if(best_num_inliers)
     kernel.Unnormalize(&best_model);
-  
+
   return best_model;
 }
 
+/// \brief Parallel RANSAC with a deterministic reduction.
+/// \details Hypotheses are generated and scored by batches spread across the
+/// available threads. Each hypothesis draws its minimal sample from its own
+/// random stream, seeded from the master seed and the global hypothesis
+/// index, and the batch reduces to the best model in hypothesis order, so the
+/// result only depends on the seed, never on the thread count or scheduling.
+/// The adaptive iteration bound is reevaluated between batches.
+template<typename Kernel, typename Scorer>
+typename Kernel::Model RANSACParallel(
+  const Kernel &kernel,
+  const Scorer &scorer,
+  std::vector<size_t> *best_inliers = nullptr,
+  double *best_score = nullptr,
+  bool bVerbose = true,
+  double outliers_probability = 1e-2,
+  unsigned int seed = 0)
+{
+  assert(outliers_probability < 1.0);
+  assert(outliers_probability > 0.0);
+  const size_t min_samples = Kernel::MINIMUM_SAMPLES;
+  const size_t total_samples = kernel.NumSamples();
+
+  size_t max_iterations = 100;
+  const size_t really_max_iterations = 4096;
+
+  size_t best_num_inliers = 0;
+  double best_inlier_ratio = 0.0;
+  typename Kernel::Model best_model;
+
+  // Test if we have sufficient points for the kernel.
+  if (total_samples < min_samples)
+  {
+    if (best_inliers) {
+      best_inliers->resize(0);
+    }
+    return best_model;
+  }
+
+  // In this robust estimator, the scorer always works on all the data points
+  // at once. So precompute the list ahead of time [0,..,total_samples].
+  std::vector<size_t> all_samples(total_samples);
+  std::iota(all_samples.begin(), all_samples.end(), 0);
+
+  const size_t batchSize = std::max<size_t>(8, omp_get_max_threads() * 4);
+
+  size_t iteration = 0;
+  while (iteration < max_iterations && iteration < really_max_iterations)
+  {
+    const size_t nbHypotheses =
+      std::min(batchSize, std::min(max_iterations, really_max_iterations) - iteration);
+
+    std::vector<size_t> batchNbInliers(nbHypotheses, 0);
+    std::vector<typename Kernel::Model> batchModels(nbHypotheses);
+    std::vector<std::vector<size_t>> batchInliers(nbHypotheses);
+
+    #pragma omp parallel for schedule(dynamic)
+    for (long b = 0; b < static_cast<long>(nbHypotheses); ++b)
+    {
+      // fixed per-hypothesis random stream: the drawn sample only depends on
+      // the master seed and the global hypothesis index
+      std::seed_seq sequence{seed, static_cast<unsigned int>(iteration + b)};
+      std::mt19937 generator(sequence);
+
+      std::vector<size_t> sample;
+      UniformSample(generator, min_samples, total_samples, sample);
+
+      std::vector<typename Kernel::Model> models;
+      kernel.Fit(sample, &models);
+
+      // keep the best model of this hypothesis (first one on equality)
+      for (size_t i = 0; i < models.size(); ++i)
+      {
+        std::vector<size_t> inliers;
+        scorer.Score(kernel, models[i], all_samples, &inliers);
+        if (inliers.size() > batchNbInliers[b])
+        {
+          batchNbInliers[b] = inliers.size();
+          batchModels[b] = models[i];
+          batchInliers[b].swap(inliers);
+        }
+      }
+    }
+
+    // deterministic reduction: scan the batch in hypothesis order
+    for (size_t b = 0; b < nbHypotheses; ++b)
+    {
+      if (batchNbInliers[b] > best_num_inliers)
+      {
+        best_num_inliers = batchNbInliers[b];
+        best_inlier_ratio = batchNbInliers[b] / double(total_samples);
+        best_model = batchModels[b];
+        if (best_inliers)
+        {
+          best_inliers->swap(batchInliers[b]);
+        }
+        if (bVerbose)
+        {
+          ALICEVISION_LOG_DEBUG("inliers=" << best_num_inliers << "/" << total_samples
+                    << " (iter=" << iteration + b << ")");
+        }
+      }
+    }
+
+    iteration += nbHypotheses;
+
+    // reevaluate the adaptive iteration bound once per batch
+    if (best_inlier_ratio)
+    {
+      max_iterations = IterationsRequired(min_samples,
+        outliers_probability,
+        best_inlier_ratio);
+      if (bVerbose)
+        ALICEVISION_LOG_DEBUG("New max_iteration: " << max_iterations);
+    }
+  }
+
+  if (best_score)
+    *best_score = best_num_inliers;
+
+  if (best_num_inliers)
+    kernel.Unnormalize(&best_model);
+
+  return best_model;
+}
 
 } // namespace robustEstimation
 } // namespace aliceVision
@@ -5,6 +5,11 @@
 
 #pragma once
 
+#include <cstddef>
+#include <limits>
+#include <random>
+#include <vector>
+
 namespace aliceVision {
 namespace robustEstimation{
 
@@ -14,7 +19,16 @@ using namespace std;
 template<typename Kernel>
 class ScoreEvaluator {
 public:
-  ScoreEvaluator(double threshold) : threshold_(threshold) {}
+  /**
+   * @param[in] threshold The error threshold classifying a sample as inlier.
+   * @param[in] preemptionSamples The number of randomly drawn samples checked
+   *            by the preemptive T(d,d) test before a full evaluation
+   *            (@see ScorePreemptive()), 0 disables the test.
+   */
+  ScoreEvaluator(double threshold, std::size_t preemptionSamples = 0)
+    : threshold_(threshold)
+    , preemptionSamples_(preemptionSamples)
+  {}
 
   template <typename T>
   double Score(const Kernel &kernel,
@@ -50,10 +64,55 @@ public:
     return Score(kernel, model, samples, inliers, threshold_);
   }
   
-  double getThreshold() const {return threshold_;} 
-  
+  /**
+   * @brief Score with preemptive verification, the T(d,d) test of
+   *
+   * Jiri Matas, Ondrej Chum:
+   * Randomized RANSAC with T(d,d) test. BMVC 2002
+   *
+   * d = preemptionSamples randomly drawn samples are evaluated first and the
+   * hypothesis is abandoned unless all of them are inliers. Most contaminated
+   * hypotheses fail within the first few samples, which avoids their full
+   * evaluation. A good hypothesis is also rejected with probability 1-e^d
+   * (e the inlier ratio), which the caller compensates with more hypotheses.
+   *
+   * @param[in] kernel The kernel containing the problem to solve.
+   * @param[in] model The model to evaluate.
+   * @param[in] samples The indices of the data to evaluate.
+   * @param[out] inliers The indices of the samples supporting the model.
+   * @param[in,out] generator The random generator drawing the test samples.
+   * @param[out] rejected Whether the model was abandoned by the test.
+   * @return The score of the model, infinity if it was rejected.
+   */
+  template <typename T>
+  double ScorePreemptive(const Kernel &kernel,
+                         const typename Kernel::Model &model,
+                         const std::vector<T> &samples,
+                         std::vector<T> *inliers,
+                         std::mt19937 &generator,
+                         bool &rejected) const
+  {
+    std::uniform_int_distribution<std::size_t> distribution(0, samples.size() - 1);
+    for(std::size_t d = 0; d < preemptionSamples_; ++d)
+    {
+      const double error = kernel.Error(samples[distribution(generator)], model);
+      if(!(error < threshold_))
+      {
+        rejected = true;
+        return std::numeric_limits<double>::infinity();
+      }
+    }
+    rejected = false;
+    return Score(kernel, model, samples, inliers, threshold_);
+  }
+
+  double getThreshold() const {return threshold_;}
+
+  std::size_t getPreemptionSamples() const {return preemptionSamples_;}
+
 private:
   double threshold_;
+  std::size_t preemptionSamples_;
 };
 
 } // namespace robustEstimation
@@ -246,6 +246,43 @@ BOOST_AUTO_TEST_CASE(RansacLineFitter_RealisticCase)
   BOOST_CHECK_SMALL(GTModel(1)-line[1], 1e-9);
 }
 
+// Same data as the realistic case, with the adaptive termination enabled:
+// the model found must be the same even if the sampling stops early.
+BOOST_AUTO_TEST_CASE(RansacLineFitter_RealisticCase_AdaptiveConfidence)
+{
+  const int NbPoints = 100;
+  const float outlierRatio = .3;
+  Mat2X xy(2, NbPoints);
+
+  Vec2 GTModel; // y = 6.3 x + (-2.0)
+  GTModel << -2.0, 6.3;
+
+  for(Mat::Index i = 0; i < NbPoints; ++i)
+  {
+    xy.col(i) << i, (double) i * GTModel[1] + GTModel[0];
+  }
+
+  std::mt19937 gen;
+  std::normal_distribution<> d(0, 5);
+
+  const int nbPtToNoise = (int) NbPoints * outlierRatio;
+  for(std::size_t i = 0; i < (std::size_t)nbPtToNoise; ++i)
+  {
+    xy.col(i) << d(gen), d(gen);
+  }
+
+  ACRANSACOneViewKernel<LineSolver, pointToLineError, Vec2> lineKernel(xy, 12, 12);
+
+  std::vector<std::size_t> vec_inliers;
+  Vec2 line;
+  ACRANSAC(lineKernel, vec_inliers, 300, &line,
+    std::numeric_limits<double>::infinity(), false, false, nullptr, 0.999);
+
+  BOOST_CHECK_EQUAL(NbPoints - nbPtToNoise, vec_inliers.size());
+  BOOST_CHECK_SMALL(GTModel(0)-line[0], 1e-9);
+  BOOST_CHECK_SMALL(GTModel(1)-line[1], 1e-9);
+}
+
 // Generate nbPoints along a line and add gaussian noise.
 // Move some point in the dataset to create outlier contamined data
 
@@ -454,5 +454,162 @@ void GuidedMatching_Fundamental_Fast(
   }
 }
 
+/**
+ * @brief Uniform grid over the region positions of one view.
+ *
+ * Built once per view (positions are undistorted once at build time) and
+ * reused across all the pairs involving that view, so guided matching only
+ * evaluates the features whose cell intersects the epipolar band instead of
+ * scanning every left/right feature pair.
+ */
+class RegionsGridIndex
+{
+public:
+
+  /// Index the region positions of a view on a uniform grid
+  void build(const feature::Regions & regions,
+             const camera::IntrinsicBase * cam, // optional, to undistort the positions once
+             std::size_t width, std::size_t height,
+             std::size_t cellSize = 64)
+  {
+    _cellSize = cellSize;
+    _nbCellsX = std::max<std::size_t>(1, (width + cellSize - 1) / cellSize);
+    _nbCellsY = std::max<std::size_t>(1, (height + cellSize - 1) / cellSize);
+    _cells.assign(_nbCellsX * _nbCellsY, {});
+    _positions.resize(regions.RegionCount());
+
+    const bool undistort = (cam && cam->isValid());
+    for(std::size_t i = 0; i < regions.RegionCount(); ++i)
+    {
+      _positions[i] = undistort ? cam->get_ud_pixel(regions.GetRegionPosition(i))
+                                : regions.GetRegionPosition(i);
+      const std::size_t cx = std::min(std::size_t(std::max(0.0, _positions[i](0) / _cellSize)), _nbCellsX - 1);
+      const std::size_t cy = std::min(std::size_t(std::max(0.0, _positions[i](1) / _cellSize)), _nbCellsY - 1);
+      _cells[cy * _nbCellsX + cx].push_back(i);
+    }
+  }
+
+  /// Positions used to build the grid (undistorted if a valid camera was given)
+  const std::vector<Vec2> & positions() const { return _positions; }
+
+  /**
+   * @brief Collect the regions whose cell intersects the band
+   *        |line . (x, y, 1)| / ||line_{1,2}|| <= margin
+   * @param[in] line The epipolar line (a, b, c)
+   * @param[in] margin Half width of the band, in pixels
+   * @param[out] candidates The indexes of the candidate regions (cleared first)
+   */
+  void getCandidatesAlongLine(const Vec3 & line, double margin, std::vector<IndexT> & candidates) const
+  {
+    candidates.clear();
+    const double a = line(0), b = line(1), c = line(2);
+    const double norm = std::hypot(a, b);
+    if(norm == 0.0)
+      return;
+
+    // Walk the grid along the dominant axis of the line and keep, for each
+    // strip, the cells covered by the band extent on the other axis.
+    if(std::abs(b) >= std::abs(a))
+    {
+      const double halfBand = margin * norm / std::abs(b); // vertical half extent of the band
+      for(std::size_t cx = 0; cx < _nbCellsX; ++cx)
+      {
+        const double x0 = cx * double(_cellSize);
+        const double x1 = x0 + _cellSize;
+        const double y0 = (-c - a * x0) / b;
+        const double y1 = (-c - a * x1) / b;
+        const double yMin = std::min(y0, y1) - halfBand;
+        const double yMax = std::max(y0, y1) + halfBand;
+        if(yMax < 0.0 || yMin >= double(_nbCellsY * _cellSize))
+          continue;
+        const std::size_t cyMin = std::size_t(std::max(0.0, yMin / _cellSize));
+        const std::size_t cyMax = std::min(_nbCellsY - 1, std::size_t(std::max(0.0, yMax / _cellSize)));
+        for(std::size_t cy = cyMin; cy <= cyMax; ++cy)
+        {
+          const std::vector<IndexT> & cell = _cells[cy * _nbCellsX + cx];
+          candidates.insert(candidates.end(), cell.begin(), cell.end());
+        }
+      }
+    }
+    else
+    {
+      const double halfBand = margin * norm / std::abs(a); // horizontal half extent of the band
+      for(std::size_t cy = 0; cy < _nbCellsY; ++cy)
+      {
+        const double y0 = cy * double(_cellSize);
+        const double y1 = y0 + _cellSize;
+        const double x0 = (-c - b * y0) / a;
+        const double x1 = (-c - b * y1) / a;
+        const double xMin = std::min(x0, x1) - halfBand;
+        const double xMax = std::max(x0, x1) + halfBand;
+        if(xMax < 0.0 || xMin >= double(_nbCellsX * _cellSize))
+          continue;
+        const std::size_t cxMin = std::size_t(std::max(0.0, xMin / _cellSize));
+        const std::size_t cxMax = std::min(_nbCellsX - 1, std::size_t(std::max(0.0, xMax / _cellSize)));
+        for(std::size_t cx = cxMin; cx <= cxMax; ++cx)
+        {
+          const std::vector<IndexT> & cell = _cells[cy * _nbCellsX + cx];
+          candidates.insert(candidates.end(), cell.begin(), cell.end());
+        }
+      }
+    }
+  }
+
+private:
+  std::size_t _cellSize = 64;
+  std::size_t _nbCellsX = 0;
+  std::size_t _nbCellsY = 0;
+  // _cells[cy * _nbCellsX + cx] = indexes of the regions falling in the cell
+  std::vector<std::vector<IndexT>> _cells;
+  std::vector<Vec2> _positions;
+};
+
+/// Guided Matching (features + descriptors with distance ratio):
+/// Use a per-view RegionsGridIndex to only evaluate the right features close
+/// to the epipolar band of each left feature. The grid indexes are built once
+/// per view and shared by all the pairs involving that view.
+template<typename ErrorArg> // The metric to compute distance to the model
+void GuidedMatching_Fundamental_Grid(
+  const Mat3 & FMat,    // The fundamental matrix
+  const feature::Regions & lRegions,  // regions (point features & corresponding descriptors)
+  const RegionsGridIndex & lIndex,    // grid index of the left view
+  const feature::Regions & rRegions,  // regions (point features & corresponding descriptors)
+  const RegionsGridIndex & rIndex,    // grid index of the right view
+  double errorTh,       // Maximal authorized error threshold (consider it's a square threshold)
+  double distRatio,     // Maximal authorized distance ratio
+  matching::IndMatches & out_matches) // Ouput corresponding index
+{
+  const double bandMargin = std::sqrt(errorTh);
+  std::vector<IndexT> candidates;
+
+  for(std::size_t i = 0; i < lRegions.RegionCount(); ++i)
+  {
+    const Vec2 & xL = lIndex.positions()[i];
+    const Vec3 line = FMat * Vec3(xL(0), xL(1), 1.0);
+    rIndex.getCandidatesAlongLine(line, bandMargin, candidates);
+
+    distanceRatio<double> dR;
+    for(const IndexT j : candidates)
+    {
+      // Compute the geometric error: error to the model
+      const double geomErr = ErrorArg::Error(FMat, xL, rIndex.positions()[j]);
+      if(geomErr < errorTh)
+      {
+        // Update the corresponding points & distance (if required)
+        dR.update(j, lRegions.SquaredDescriptorDistance(i, &rRegions, j));
+      }
+    }
+    // Add correspondence only iff the distance ratio is valid
+    if(dR.isValid(distRatio))
+    {
+      // save the best corresponding index
+      out_matches.emplace_back(i, dR.idx);
+    }
+  }
+
+  // Remove duplicates (when multiple points at same position exist)
+  matching::IndMatch::getDeduplicated(out_matches);
+}
+
 } // namespace robustEstimation
 } // namespace aliceVision
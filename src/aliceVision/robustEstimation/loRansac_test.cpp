@@ -159,3 +159,48 @@ BOOST_AUTO_TEST_CASE(LoRansacLineFitter_RealCaseLoRansac)
     BOOST_CHECK_EQUAL(expectedInliers, vec_inliers.size());
   }
 }
+
+BOOST_AUTO_TEST_CASE(LoRansacLineFitter_PreemptiveScoring)
+{
+  const std::size_t numPoints = 300;
+  const double outlierRatio = .3;
+  const std::size_t numTrials = 10;
+  std::mt19937 gen;
+
+  Vec2 GTModel; // y = 2x + 6.3
+  GTModel << -2.0, 6.3;
+
+  Mat2X xy(2, numPoints);
+  vector<std::size_t> vec_inliersGT;
+  generateLine(numPoints, outlierRatio, 0.0, GTModel, gen, xy, vec_inliersGT);
+
+  const double threshold = 0.3;
+  LineKernelLoRansac kernel(xy);
+  // T(d,d) test with d = 1 before every full evaluation
+  const ScoreEvaluator<LineKernel> scorer(threshold, 1);
+  BOOST_CHECK_EQUAL(1, scorer.getPreemptionSamples());
+
+  const std::size_t expectedInliers = numPoints - (std::size_t) numPoints * outlierRatio;
+  for(std::size_t trial = 0; trial < numTrials; ++trial)
+  {
+    std::vector<std::size_t> vec_inliers;
+    const Vec2 model = LO_RANSAC(kernel, scorer, &vec_inliers);
+    BOOST_CHECK_EQUAL(expectedInliers, vec_inliers.size());
+    BOOST_CHECK_SMALL(GTModel[0]-model[0], 1e-2);
+    BOOST_CHECK_SMALL(GTModel[1]-model[1], 1e-2);
+  }
+
+  // a garbage model must be abandoned by the preemptive test on pure inlier data
+  Mat2X xyClean = ExtractColumns(xy, vec_inliersGT);
+  LineKernelLoRansac cleanKernel(xyClean);
+  std::vector<std::size_t> all_samples(xyClean.cols());
+  std::iota(all_samples.begin(), all_samples.end(), 0);
+  Vec2 garbageModel;
+  garbageModel << 1000.0, -7.0;
+  std::vector<std::size_t> inliers;
+  bool rejected = false;
+  const double score = scorer.ScorePreemptive(cleanKernel, garbageModel, all_samples, &inliers, gen, rejected);
+  BOOST_CHECK(rejected);
+  BOOST_CHECK(inliers.empty());
+  BOOST_CHECK_EQUAL(std::numeric_limits<double>::infinity(), score);
+}
@@ -8,13 +8,35 @@
 #include <set>
 #include <unordered_set>
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <cstdlib>
 #include <random>
+#include <vector>
 #include <cassert>
 
 namespace aliceVision {
 namespace robustEstimation{
 
+/**
+ * @brief Build an independent random stream from the stable identifiers of a
+ * work item (an image pair, a view, a track...).
+ *
+ * Estimators running in parallel draw from per-item generators created with
+ * this helper instead of a shared (or freshly device-seeded) one, so the
+ * result of each item no longer depends on the scheduling of the others and
+ * a run is reproducible.
+ *
+ * @param[in] id0 First identifier of the work item.
+ * @param[in] id1 Optional second identifier (e.g. the second view of a pair).
+ * @return A generator seeded only from the given identifiers.
+ */
+inline std::mt19937 createTaskGenerator(std::size_t id0, std::size_t id1 = 0)
+{
+  std::seed_seq seed{std::uint32_t(id0), std::uint32_t(std::uint64_t(id0) >> 32),
+                     std::uint32_t(id1), std::uint32_t(std::uint64_t(id1) >> 32)};
+  return std::mt19937(seed);
+}
 
 /**
  * @brief Generate a unique random samples without replacement in the 
@@ -26,59 +48,83 @@ namespace robustEstimation{
  * by drawing random numbers until the numSamples elements are generated, using  
  * Robert Floyd's algorithm.
  * 
+ * The overload taking a generator draws from the given random stream, so the
+ * caller controls the seeding (used for deterministic parallel estimation);
+ * the other one seeds a fresh generator from the system random device.
+ *
+ * @param[in,out] generator The random generator to draw from.
  * @param[in] lowerBound The lower bound of the range.
  * @param[in] upperBound The upper bound of the range (not included).
  * @param[in] numSamples Number of unique samples to draw.
  * @return samples The vector containing the samples.
  */
 template<typename IntT>
-inline std::vector<IntT> randSample(IntT lowerBound,
-                                    IntT upperBound,
-                                    IntT numSamples)
+inline void randSample(std::mt19937& generator,
+                       IntT lowerBound,
+                       IntT upperBound,
+                       IntT numSamples,
+                       std::vector<IntT>& result)
 {
   const auto rangeSize = upperBound - lowerBound;
-  
+
   assert(lowerBound < upperBound);
   assert(numSamples <= rangeSize);
   static_assert(std::is_integral<IntT>::value, "Only integer types are supported");
 
-  
-  std::random_device rd;
-  std::mt19937 generator(rd());
-
   if(numSamples * 1.5 > rangeSize)
   {
     // if the number of required samples is a large fraction of the range size
-    // generate a vector with all the elements in the range, shuffle it and 
+    // generate a vector with all the elements in the range, shuffle it and
     // return the first numSample elements.
     // this should be more time efficient than drawing at each time.
-    std::vector<IntT> result(rangeSize);
+    result.resize(rangeSize);
     std::iota(result.begin(), result.end(), lowerBound);
     std::shuffle(result.begin(), result.end(), generator);
     result.resize(numSamples);
-    return result;
   }
   else
   {
     // otherwise if the number of required samples is small wrt the range
     // use the optimized Robert Floyd algorithm.
     // this has linear complexity and minimize the memory usage.
-    std::unordered_set<IntT> samples;
+    // The duplicate test is a linear scan of the output: for the minimal
+    // sample sizes drawn in the estimation loops it beats the set based
+    // rejection and, once the output vector has its capacity, it does not
+    // allocate.
+    result.clear();
     for(IntT d = upperBound - numSamples; d < upperBound; ++d)
     {
       IntT t = std::uniform_int_distribution<>(0, d)(generator) + lowerBound;
-      if(samples.find(t) == samples.end())
-        samples.insert(t);
+      if(std::find(result.begin(), result.end(), t) == result.end())
+        result.push_back(t);
       else
-        samples.insert(d);
+        result.push_back(d);
     }
-    assert(samples.size() == numSamples);
-    std::vector<IntT> result(std::make_move_iterator(samples.begin()),
-                             std::make_move_iterator(samples.end()));
-    return result;
+    assert(result.size() == numSamples);
   }
 }
 
+template<typename IntT>
+inline std::vector<IntT> randSample(std::mt19937& generator,
+                                    IntT lowerBound,
+                                    IntT upperBound,
+                                    IntT numSamples)
+{
+  std::vector<IntT> result;
+  randSample(generator, lowerBound, upperBound, numSamples, result);
+  return result;
+}
+
+template<typename IntT>
+inline std::vector<IntT> randSample(IntT lowerBound,
+                                    IntT upperBound,
+                                    IntT numSamples)
+{
+  std::random_device rd;
+  std::mt19937 generator(rd());
+  return randSample<IntT>(generator, lowerBound, upperBound, numSamples);
+}
+
 /**
 * @brief Pick a random subset of the integers in the range [0, upperBound).
 *
@@ -134,6 +180,110 @@ inline void UniformSample(std::size_t numSamples,
   UniformSample(0, upperBound, numSamples, samples);
 }
 
+/**
+ * @brief Generate a unique random samples in the range [0 upperBound),
+ * drawing from the given random stream.
+ *
+ * @param[in,out] generator The random generator to draw from.
+ * @param[in] numSamples Number of unique samples to draw.
+ * @param[in] upperBound The value at the end of the range (not included).
+ * @param[out] samples The vector containing the samples.
+ */
+template<typename IntT>
+inline void UniformSample(std::mt19937& generator,
+                          std::size_t numSamples,
+                          std::size_t upperBound,
+                          std::vector<IntT> &samples)
+{
+  randSample<IntT>(generator, IntT(0), IntT(upperBound), IntT(numSamples), samples);
+}
+
+/**
+ * @brief Progressive sampler following PROSAC [Chum & Matas, CVPR 2005].
+ *
+ * The data must be sorted by decreasing quality (best correspondence first,
+ * e.g. by ascending descriptor distance). Early hypotheses are drawn from a
+ * small pool containing only the top ranked correspondences; the pool is then
+ * widened following the growth function of the paper until it covers the
+ * whole data set, after which the sampling degenerates to uniform. On data
+ * where the ranking correlates with the inlier probability this finds a good
+ * model in far fewer hypotheses than uniform sampling.
+ */
+class ProsacSampler
+{
+public:
+
+  /**
+   * @param[in] sampleSize The size of the minimal sample to draw.
+   * @param[in] numData The number of data points, ranked by decreasing quality.
+   * @param[in] maxHypotheses The number of hypotheses after which the pool
+   *            covers the whole data set (T_N in the paper).
+   */
+  ProsacSampler(std::size_t sampleSize, std::size_t numData,
+                std::size_t maxHypotheses = 200000)
+    : _sampleSize(sampleSize)
+    , _numData(numData)
+    , _n(sampleSize)
+    , _t(0)
+    , _TnPrime(1.0)
+  {
+    assert(sampleSize > 0);
+    assert(sampleSize <= numData);
+    // T_m = T_N * C(m,m) / C(N,m), computed as a running product to avoid
+    // overflowing the binomial coefficients
+    _Tn = double(maxHypotheses);
+    for(std::size_t i = 0; i < sampleSize; ++i)
+      _Tn *= double(sampleSize - i) / double(numData - i);
+  }
+
+  /// The current size of the sampling pool (the poolSize() best correspondences).
+  std::size_t poolSize() const { return _n; }
+
+  /**
+   * @brief Draw the next minimal sample.
+   *
+   * @param[in,out] generator The random generator to draw from.
+   * @param[out] samples The vector containing the sample indices.
+   */
+  void sample(std::mt19937& generator, std::vector<std::size_t>& samples)
+  {
+    ++_t;
+    // widen the pool following the growth function T'_n of the paper
+    while(_t > _TnPrime && _n < _numData)
+    {
+      const double TnNext = _Tn * double(_n + 1) / double(_n + 1 - _sampleSize);
+      _TnPrime += std::ceil(TnNext - _Tn);
+      _Tn = TnNext;
+      ++_n;
+    }
+    if(_t > _TnPrime)
+    {
+      // the growth function is exhausted: degenerate to uniform sampling
+      randSample<std::size_t>(generator, std::size_t(0), _numData, _sampleSize, samples);
+    }
+    else
+    {
+      // the n-th ranked correspondence plus sampleSize-1 drawn uniformly
+      // among the n-1 better ranked ones
+      samples.clear();
+      if(_sampleSize > 1)
+        randSample<std::size_t>(generator, std::size_t(0), _n - 1, _sampleSize - 1, samples);
+      samples.push_back(_n - 1);
+    }
+  }
+
+private:
+  std::size_t _sampleSize;
+  std::size_t _numData;
+  /// size of the current sampling pool
+  std::size_t _n;
+  /// number of hypotheses drawn so far
+  std::size_t _t;
+  /// growth function value for the current pool size, and its ceiled running sum
+  double _Tn;
+  double _TnPrime;
+};
+
 /**
  * @brief Generate a random sequence containing a sampling without replacement of
  * of the elements of the input vector.
@@ -154,5 +304,27 @@ inline void UniformSample(std::size_t sampleSize,
   }
 }
 
+/**
+ * @brief Generate a random sequence containing a sampling without replacement
+ * of the elements of the input vector, drawing from the given random stream.
+ *
+ * @param[in,out] generator The random generator to draw from.
+ * @param[in] sampleSize The size of the sample to generate.
+ * @param[in] elements The possible data indices.
+ * @param[out] sample The random sample of sizeSample indices.
+ */
+inline void UniformSample(std::mt19937& generator,
+                          std::size_t sampleSize,
+                          const std::vector<std::size_t>& elements,
+                          std::vector<std::size_t>& sample)
+{
+  randSample<std::size_t>(generator, std::size_t(0), elements.size(), sampleSize, sample);
+  assert(sample.size() == sampleSize);
+  for(auto& s : sample)
+  {
+    s = elements[ s ];
+  }
+}
+
 } // namespace robustEstimation
 } // namespace aliceVision
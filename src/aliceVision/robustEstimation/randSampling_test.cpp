@@ -4,6 +4,7 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "aliceVision/robustEstimation/randSampling.hpp"
+#include <numeric>
 #include <set>
 #include <vector>
 
@@ -109,3 +110,70 @@ BOOST_AUTO_TEST_CASE(UniformSampleTest_randSample) {
     }
   }
 }
+
+BOOST_AUTO_TEST_CASE(ProsacSamplerTest_ProgressivePool) {
+
+  const std::size_t numData = 100;
+  const std::size_t sampleSize = 7;
+  std::mt19937 generator(42);
+  // small hypothesis budget so the pool covers the data within the test
+  ProsacSampler sampler(sampleSize, numData, 1000);
+
+  // the first sample is deterministic: the sampleSize best ranked points
+  std::vector<std::size_t> samples;
+  sampler.sample(generator, samples);
+  std::set<std::size_t> myset(samples.begin(), samples.end());
+  BOOST_CHECK_EQUAL(sampleSize, myset.size());
+  BOOST_CHECK_EQUAL(sampleSize - 1, *myset.rbegin());
+
+  std::size_t previousPoolSize = sampler.poolSize();
+  for(std::size_t t = 0; t < 5000; ++t)
+  {
+    sampler.sample(generator, samples);
+
+    // the pool only grows and never beyond the data set
+    BOOST_CHECK(sampler.poolSize() >= previousPoolSize);
+    BOOST_CHECK(sampler.poolSize() <= numData);
+    previousPoolSize = sampler.poolSize();
+
+    // each sample has no repetitions and stays within the current pool
+    myset.clear();
+    myset.insert(samples.begin(), samples.end());
+    BOOST_CHECK_EQUAL(sampleSize, myset.size());
+    BOOST_CHECK(*myset.rbegin() < sampler.poolSize());
+  }
+  // after that many hypotheses the pool must cover the whole data set
+  BOOST_CHECK_EQUAL(numData, sampler.poolSize());
+}
+
+BOOST_AUTO_TEST_CASE(UniformSampleTest_DeterministicTaskGenerator) {
+
+  // the same work item ids always produce the same stream...
+  std::mt19937 genA = createTaskGenerator(12, 345);
+  std::mt19937 genB = createTaskGenerator(12, 345);
+  std::vector<std::size_t> samplesA, samplesB;
+  UniformSample(genA, 10, 1000, samplesA);
+  UniformSample(genB, 10, 1000, samplesB);
+  BOOST_CHECK(samplesA == samplesB);
+
+  // ...and different ids produce independent ones
+  std::mt19937 genC = createTaskGenerator(345, 12);
+  std::vector<std::size_t> samplesC;
+  UniformSample(genC, 10, 1000, samplesC);
+  BOOST_CHECK(samplesA != samplesC);
+
+  // the overload sampling among given elements draws from the stream too
+  std::vector<std::size_t> elements(50);
+  std::iota(elements.begin(), elements.end(), 100);
+  std::mt19937 genD = createTaskGenerator(12, 345);
+  std::mt19937 genE = createTaskGenerator(12, 345);
+  std::vector<std::size_t> sampleD, sampleE;
+  UniformSample(genD, 10, elements, sampleD);
+  UniformSample(genE, 10, elements, sampleE);
+  BOOST_CHECK(sampleD == sampleE);
+  for(const std::size_t s : sampleD)
+  {
+    BOOST_CHECK(s >= 100);
+    BOOST_CHECK(s < 150);
+  }
+}
@@ -96,3 +96,34 @@ BOOST_AUTO_TEST_CASE(MaxConsensusLineFitter_RealisticCase) {
   BOOST_CHECK_SMALL((-2.0)-model[0], 1e-9);
   BOOST_CHECK_SMALL( 6.3-model[1], 1e-9);
 }
+
+// Parallel variant: must find the same model and be deterministic for a
+// given seed, whatever the number of threads.
+BOOST_AUTO_TEST_CASE(ParallelRansacLineFitter_DeterministicRealisticCase) {
+
+  const int NbPoints = 300;
+  const double outlierRatio = .3;
+  Mat2X xy(2, NbPoints);
+  std::mt19937 gen;
+
+  Vec2 GTModel; // y = 6.3x - 2.0
+  GTModel << -2.0, 6.3;
+
+  const std::size_t nbPtToNoise = (size_t) NbPoints*outlierRatio;
+  std::vector<std::size_t> vec_inliersGT;
+  generateLine(NbPoints, outlierRatio, 0.0, GTModel, gen, xy, vec_inliersGT);
+
+  LineKernel kernel(xy);
+  std::vector<size_t> vec_inliers;
+  Vec2 model = RANSACParallel(kernel, ScoreEvaluator<LineKernel>(0.3), &vec_inliers);
+  BOOST_CHECK_EQUAL(NbPoints-nbPtToNoise, vec_inliers.size());
+  BOOST_CHECK_SMALL((-2.0)-model[0], 1e-9);
+  BOOST_CHECK_SMALL( 6.3-model[1], 1e-9);
+
+  // same seed, same result: model and inlier set must be reproducible
+  std::vector<size_t> vec_inliers2;
+  Vec2 model2 = RANSACParallel(kernel, ScoreEvaluator<LineKernel>(0.3), &vec_inliers2);
+  BOOST_CHECK_EQUAL(model[0], model2[0]);
+  BOOST_CHECK_EQUAL(model[1], model2[1]);
+  BOOST_CHECK(vec_inliers == vec_inliers2);
+}
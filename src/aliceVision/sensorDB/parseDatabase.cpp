@@ -21,16 +21,42 @@
 namespace aliceVision {
 namespace sensorDB {
 
+namespace {
+
+/// Case-normalized "brand;model" key used for the exact index lookups
+std::string normalizedKey(const std::string& brand, const std::string& model)
+{
+  std::string key = boost::trim_copy(brand) + ";" + boost::trim_copy(model);
+  boost::to_lower(key);
+  return key;
+}
+
+} // namespace
+
 bool parseDatabase(const std::string& databaseFilePath, std::vector<Datasheet>& databaseStructure)
 {
-  std::ifstream iFilein( databaseFilePath );
+  std::ifstream iFilein( databaseFilePath, std::ios::binary );
   if(!iFilein || !stlplus::is_file(databaseFilePath))
     return false;
 
-  std::string line;
-  while(iFilein.good())
+  // load the whole database with a single read, the lines are split in memory
+  std::string buffer;
+  iFilein.seekg(0, std::ios::end);
+  buffer.resize(iFilein.tellg());
+  iFilein.seekg(0, std::ios::beg);
+  iFilein.read(&buffer[0], buffer.size());
+
+  std::size_t lineStart = 0;
+  while(lineStart < buffer.size())
   {
-    getline( iFilein, line);
+    std::size_t lineEnd = buffer.find('\n', lineStart);
+    if(lineEnd == std::string::npos)
+      lineEnd = buffer.size();
+    std::string line = buffer.substr(lineStart, lineEnd - lineStart);
+    lineStart = lineEnd + 1;
+    if(!line.empty() && line[line.size() - 1] == '\r')
+      line.resize(line.size() - 1);
+
     if(!line.empty())
     {
       //std::stringstream sStream( line );
@@ -66,5 +92,42 @@ bool getInfo(const std::string& brand, const std::string& model, const std::vect
   return existInDatabase;
 }
 
+DatasheetIndex::DatasheetIndex(const std::vector<Datasheet>& databaseStructure)
+  : _datasheets(databaseStructure)
+{}
+
+bool DatasheetIndex::getInfo(const std::string& brand, const std::string& model, Datasheet& datasheetContent) const
+{
+  const std::string key = normalizedKey(brand, model);
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const std::unordered_map<std::string, std::ptrdiff_t>::const_iterator it = _queryCache.find(key);
+    if(it != _queryCache.end())
+    {
+      if(it->second < 0)
+        return false;
+      datasheetContent = _datasheets[it->second];
+      return true;
+    }
+  }
+
+  // first query for this camera: linear scan, as getInfo
+  const Datasheet refDatasheet(brand, model, -1.);
+  const std::vector<Datasheet>::const_iterator datasheet =
+    std::find(_datasheets.begin(), _datasheets.end(), refDatasheet);
+  const std::ptrdiff_t index = (datasheet == _datasheets.end()) ?
+    -1 : std::distance(_datasheets.begin(), datasheet);
+
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _queryCache.emplace(key, index);
+  }
+
+  if(index < 0)
+    return false;
+  datasheetContent = _datasheets[index];
+  return true;
+}
+
 } // namespace sensorDB
 } // namespace aliceVision
@@ -7,6 +7,8 @@
 
 #include <aliceVision/sensorDB/Datasheet.hpp>
 
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 #include <string>
 
@@ -31,5 +33,50 @@ bool parseDatabase(const std::string& databaseFilePath, std::vector<Datasheet>&
  */
 bool getInfo(const std::string& brand, const std::string& model, const std::vector<Datasheet>& databaseStructure, Datasheet& datasheetContent);
 
+/**
+ * @brief Hashed index over the sensor database for constant time lookups.
+ *
+ * The linear scan of getInfo relies on the tokenized datasheet comparison and
+ * on the database order (the first matching entry wins), so its result cannot
+ * be precomputed per database entry. Instead each query is resolved once with
+ * the scan and memoized under a case-normalized "brand;model" key: a scene
+ * with 50k views only pays the scan once per distinct camera, every other
+ * lookup is a single hash probe with a result identical to getInfo.
+ * Thread-safe, the cache is guarded by a mutex.
+ */
+class DatasheetIndex
+{
+public:
+  DatasheetIndex() = default;
+
+  /**
+   * @brief Build the index of the given database
+   * @param[in] databaseStructure The database in memory
+   */
+  explicit DatasheetIndex(const std::vector<Datasheet>& databaseStructure);
+
+  /**
+   * @brief Get information for the given camera brand / model
+   * @param[in] brand The camera brand
+   * @param[in] model The camera model
+   * @param[out] datasheetContent The corresponding datasheet
+   * @return True if ok
+   */
+  bool getInfo(const std::string& brand, const std::string& model, Datasheet& datasheetContent) const;
+
+  bool empty() const
+  {
+    return _datasheets.empty();
+  }
+
+private:
+  /// The indexed datasheets
+  std::vector<Datasheet> _datasheets;
+  /// Case-normalized "brand;model" query to datasheet index (-1 when unknown)
+  mutable std::unordered_map<std::string, std::ptrdiff_t> _queryCache;
+  /// Guards the query cache
+  mutable std::mutex _mutex;
+};
+
 } // namespace sensorDB
 } // namespace aliceVision
@@ -116,3 +116,27 @@ BOOST_AUTO_TEST_CASE(ParseDatabaseCanon_EOS_1100D)
   BOOST_CHECK( getInfo( sBrand, sModel, vec_database, datasheet ) );
   BOOST_CHECK_EQUAL( 22.2, datasheet._sensorSize );
 }
+
+BOOST_AUTO_TEST_CASE(DatasheetIndexLookup)
+{
+  std::vector<Datasheet> vec_database;
+  Datasheet datasheet;
+  const std::string sfileDatabase = stlplus::create_filespec( std::string(THIS_SOURCE_DIR), sDatabase );
+
+  BOOST_CHECK( parseDatabase( sfileDatabase, vec_database ) );
+
+  const DatasheetIndex index(vec_database);
+  BOOST_CHECK( !index.empty() );
+
+  // same results as the linear scan, twice to exercise the memoized path
+  for(int iteration = 0; iteration < 2; ++iteration)
+  {
+    BOOST_CHECK( index.getInfo( "Canon", "Canon EOS 5D Mark II", datasheet ) );
+    BOOST_CHECK_EQUAL( 35.8, datasheet._sensorSize );
+
+    BOOST_CHECK( index.getInfo( "Canon", "Canon PowerShot A710 IS", datasheet ) );
+    BOOST_CHECK_EQUAL( "Canon PowerShot A710 IS", datasheet._model );
+
+    BOOST_CHECK(! index.getInfo( "NotExistBrand", "NotExistModel", datasheet ) );
+  }
+}
@@ -204,80 +204,99 @@ void AlembicExporter::addLandmarks(const Landmarks& landmarks, bool withVisibili
   if(landmarks.empty())
     return;
 
-  // Fill vector with the values taken from AliceVision
-  std::vector<V3f> positions;
-  std::vector<Imath::C3f> colors;
-  std::vector<Alembic::Util::uint32_t> descTypes;
-  positions.reserve(landmarks.size());
-  descTypes.reserve(landmarks.size());
-
-  // For all the 3d points in the hash_map
-  for(const auto landmark : landmarks)
+  // Emit the point cloud by fixed size chunks (one OPoints object per chunk), so the
+  // size of the temporary buffers stays bounded whatever the size of the scene.
+  // The importer concatenates the successive point clouds on load.
+  static const std::size_t maxChunkSize = 1000000;
+
+  Landmarks::const_iterator itChunkBegin = landmarks.cbegin();
+  std::size_t nbRemaining = landmarks.size();
+
+  for(std::size_t chunkId = 1; nbRemaining > 0; ++chunkId)
   {
-    const Vec3& pt = landmark.second.X;
-    const image::RGBColor& color = landmark.second.rgb;
-    positions.emplace_back(pt[0], pt[1], pt[2]);
-    colors.emplace_back(color.r()/255.f, color.g()/255.f, color.b()/255.f);
-    descTypes.emplace_back(static_cast<Alembic::Util::uint8_t>(landmark.second.descType));
-  }
+    const std::size_t chunkSize = std::min(maxChunkSize, nbRemaining);
+
+    // Fill vector with the values taken from AliceVision
+    std::vector<V3f> positions;
+    std::vector<Imath::C3f> colors;
+    std::vector<Alembic::Util::uint32_t> descTypes;
+    positions.reserve(chunkSize);
+    colors.reserve(chunkSize);
+    descTypes.reserve(chunkSize);
+
+    // For all the 3d points of the chunk
+    Landmarks::const_iterator itLandmark = itChunkBegin;
+    for(std::size_t i = 0; i < chunkSize; ++i, ++itLandmark)
+    {
+      const Vec3& pt = itLandmark->second.X;
+      const image::RGBColor& color = itLandmark->second.rgb;
+      positions.emplace_back(pt[0], pt[1], pt[2]);
+      colors.emplace_back(color.r()/255.f, color.g()/255.f, color.b()/255.f);
+      descTypes.emplace_back(static_cast<Alembic::Util::uint8_t>(itLandmark->second.descType));
+    }
 
-  std::vector<Alembic::Util::uint64_t> ids(positions.size());
-  std::iota(begin(ids), end(ids), 0);
+    std::vector<Alembic::Util::uint64_t> ids(positions.size());
+    std::iota(begin(ids), end(ids), 0);
 
-  OPoints partsOut(_dataImpl->_mvgPointCloud, "particleShape1");
-  OPointsSchema &pSchema = partsOut.getSchema();
+    OPoints partsOut(_dataImpl->_mvgPointCloud, "particleShape" + std::to_string(chunkId));
+    OPointsSchema &pSchema = partsOut.getSchema();
 
-  OPointsSchema::Sample psamp(std::move(V3fArraySample(positions)), std::move(UInt64ArraySample(ids)));
-  pSchema.set(psamp);
+    OPointsSchema::Sample psamp(std::move(V3fArraySample(positions)), std::move(UInt64ArraySample(ids)));
+    pSchema.set(psamp);
 
-  OCompoundProperty arbGeom = pSchema.getArbGeomParams();
+    OCompoundProperty arbGeom = pSchema.getArbGeomParams();
 
-  C3fArraySample cval_samp(&colors[0], colors.size());
-  OC3fGeomParam::Sample color_samp(cval_samp, kVertexScope);
+    C3fArraySample cval_samp(&colors[0], colors.size());
+    OC3fGeomParam::Sample color_samp(cval_samp, kVertexScope);
 
-  OC3fGeomParam rgbOut(arbGeom, "color", false, kVertexScope, 1);
-  rgbOut.set(color_samp);
+    OC3fGeomParam rgbOut(arbGeom, "color", false, kVertexScope, 1);
+    rgbOut.set(color_samp);
 
-  OCompoundProperty userProps = pSchema.getUserProperties();
+    OCompoundProperty userProps = pSchema.getUserProperties();
 
-  OUInt32ArrayProperty(userProps, "mvg_describerType").set(descTypes);
+    OUInt32ArrayProperty(userProps, "mvg_describerType").set(descTypes);
 
-  if(withVisibility)
-  {
-    std::vector<::uint32_t> visibilitySize;
-    visibilitySize.reserve(positions.size());
-    for(const auto landmark : landmarks)
+    if(withVisibility)
     {
-      visibilitySize.emplace_back(landmark.second.observations.size());
-    }
-    std::size_t nbObservations = std::accumulate(visibilitySize.begin(), visibilitySize.end(), 0);
+      std::vector<::uint32_t> visibilitySize;
+      visibilitySize.reserve(positions.size());
+      itLandmark = itChunkBegin;
+      for(std::size_t i = 0; i < chunkSize; ++i, ++itLandmark)
+      {
+        visibilitySize.emplace_back(itLandmark->second.observations.size());
+      }
+      std::size_t nbObservations = std::accumulate(visibilitySize.begin(), visibilitySize.end(), 0);
 
-    // Use std::vector<::uint32_t> and std::vector<float> instead of std::vector<V2i> and std::vector<V2f>
-    // Because Maya don't import them correctly
-    std::vector<::uint32_t> visibilityIds;
-    visibilityIds.reserve(nbObservations*2);
-    std::vector<float>featPos2d;
-    featPos2d.reserve(nbObservations*2);
+      // Use std::vector<::uint32_t> and std::vector<float> instead of std::vector<V2i> and std::vector<V2f>
+      // Because Maya don't import them correctly
+      std::vector<::uint32_t> visibilityIds;
+      visibilityIds.reserve(nbObservations*2);
+      std::vector<float>featPos2d;
+      featPos2d.reserve(nbObservations*2);
 
-    for(Landmarks::const_iterator itLandmark = landmarks.cbegin(), itLandmarkEnd = landmarks.cend();
-       itLandmark != itLandmarkEnd; ++itLandmark)
-    {
-      const Observations& observations = itLandmark->second.observations;
-      for(const auto vObs: observations )
+      itLandmark = itChunkBegin;
+      for(std::size_t i = 0; i < chunkSize; ++i, ++itLandmark)
       {
-        const Observation& obs = vObs.second;
-        // (View ID, Feature ID)
-        visibilityIds.emplace_back(vObs.first);
-        visibilityIds.emplace_back(obs.id_feat);
-        // Feature 2D position (x, y))
-        featPos2d.emplace_back(obs.x[0]);
-        featPos2d.emplace_back(obs.x[1]);
+        const Observations& observations = itLandmark->second.observations;
+        for(const auto vObs: observations )
+        {
+          const Observation& obs = vObs.second;
+          // (View ID, Feature ID)
+          visibilityIds.emplace_back(vObs.first);
+          visibilityIds.emplace_back(obs.id_feat);
+          // Feature 2D position (x, y))
+          featPos2d.emplace_back(obs.x[0]);
+          featPos2d.emplace_back(obs.x[1]);
+        }
       }
+
+      OUInt32ArrayProperty( userProps, "mvg_visibilitySize" ).set(visibilitySize);
+      OUInt32ArrayProperty(userProps, "mvg_visibilityIds" ).set(visibilityIds); // (viewID, featID)
+      OFloatArrayProperty(userProps, "mvg_visibilityFeatPos" ).set(featPos2d); // feature position (x,y)
     }
 
-    OUInt32ArrayProperty( userProps, "mvg_visibilitySize" ).set(visibilitySize);
-    OUInt32ArrayProperty(userProps, "mvg_visibilityIds" ).set(visibilityIds); // (viewID, featID)
-    OFloatArrayProperty(userProps, "mvg_visibilityFeatPos" ).set(featPos2d); // feature position (x,y)
+    itChunkBegin = itLandmark;
+    nbRemaining -= chunkSize;
   }
 }
 
@@ -132,7 +132,10 @@ bool readPointCloud(IObject iObj, M44d mat, sfm::SfMData &sfmdata, sfm::ESfMData
     }
   }
 
-  if(userProps &&
+  // The visibility arrays are by far the largest part of a point cloud:
+  // do not even sample them when the observations are not requested
+  if((flags_part & sfm::ESfMData::OBSERVATIONS) &&
+     userProps &&
      userProps.getPropertyHeader("mvg_visibilitySize") &&
      userProps.getPropertyHeader("mvg_visibilityIds") &&
      userProps.getPropertyHeader("mvg_visibilityFeatPos"))
@@ -529,8 +532,12 @@ void visitObject(IObject iObj, M44d mat, sfm::SfMData& sfmdata, sfm::ESfMData fl
     isReconstructed = false;
   
   const MetaData& md = iObj.getMetaData();
-  if(IPoints::matches(md) && (flagsPart & sfm::ESfMData::STRUCTURE))
+  if(IPoints::matches(md))
   {
+    // Skip the whole point cloud subtree, without sampling it, when the
+    // structure is not requested
+    if(!(flagsPart & sfm::ESfMData::STRUCTURE))
+      return;
     readPointCloud(iObj, mat, sfmdata, flagsPart);
   }
   else if(IXform::matches(md))
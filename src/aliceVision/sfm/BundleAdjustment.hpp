@@ -28,6 +28,15 @@ enum BA_Refine
 
 ALICEVISION_BITMASK(BA_Refine)
 
+/// Linear solver profile used by the bundle adjustment backends
+enum BA_SolverProfile
+{
+  BA_SOLVER_AUTO = 0,        //< pick the profile from the scene size (landmark/pose counts)
+  BA_SOLVER_DENSE_SCHUR,     //< exact dense Schur complement factorization
+  BA_SOLVER_SPARSE_SCHUR,    //< exact sparse Schur complement factorization
+  BA_SOLVER_ITERATIVE_SCHUR, //< PCG on the Schur complement (SCHUR_JACOBI preconditioner)
+};
+
 class BundleAdjustment
 {
   public:
@@ -4,6 +4,7 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include <aliceVision/sfm/BundleAdjustmentCeres.hpp>
+#include <aliceVision/sfm/LandmarksData.hpp>
 #include <aliceVision/config.hpp>
 #include <aliceVision/alicevision_omp.hpp>
 
@@ -16,8 +17,25 @@ using namespace aliceVision::camera;
 using namespace aliceVision::geometry;
 
 /// Create the appropriate cost functor according the provided input camera intrinsic model
-ceres::CostFunction * createCostFunctionFromIntrinsics(IntrinsicBase * intrinsic, const Vec2 & observation)
+ceres::CostFunction * createCostFunctionFromIntrinsics(IntrinsicBase * intrinsic, const Vec2 & observation, bool useAnalyticDerivatives)
 {
+  if(useAnalyticDerivatives)
+  {
+    switch(intrinsic->getType())
+    {
+      case PINHOLE_CAMERA:
+        return new AnalyticCostFunction_Pinhole(observation.data());
+      case PINHOLE_CAMERA_RADIAL1:
+        return new AnalyticCostFunction_PinholeRadialK1(observation.data());
+      case PINHOLE_CAMERA_RADIAL3:
+        return new AnalyticCostFunction_PinholeRadialK3(observation.data());
+      case PINHOLE_CAMERA_BROWN:
+        return new AnalyticCostFunction_PinholeBrownT2(observation.data());
+      default:
+        break; // no analytic version, fall back to automatic differentiation
+    }
+  }
+
   switch(intrinsic->getType())
   {
     case PINHOLE_CAMERA:
@@ -80,23 +98,29 @@ ceres::CostFunction * createRigCostFunctionFromIntrinsics(IntrinsicBase * intrin
 }
 
 
-void addPose(ceres::Problem& problem,
-             BA_Refine refineOptions,
-             const Pose3 & pose,
-             std::vector<double>& out_poseParams)
+/// Fill the BA parameter array from a pose (angle-axis rotation + translation)
+void setPoseParams(const Pose3 & pose, std::vector<double>& out_poseParams)
 {
   const Mat3 R = pose.rotation();
   const Vec3 t = pose.translation();
 
   double angleAxis[3];
   ceres::RotationMatrixToAngleAxis((const double*)R.data(), angleAxis);
-  out_poseParams.reserve(6); //angleAxis + translation
-  out_poseParams.push_back(angleAxis[0]);
-  out_poseParams.push_back(angleAxis[1]);
-  out_poseParams.push_back(angleAxis[2]);
-  out_poseParams.push_back(t(0));
-  out_poseParams.push_back(t(1));
-  out_poseParams.push_back(t(2));
+  out_poseParams.resize(6); //angleAxis + translation
+  out_poseParams[0] = angleAxis[0];
+  out_poseParams[1] = angleAxis[1];
+  out_poseParams[2] = angleAxis[2];
+  out_poseParams[3] = t(0);
+  out_poseParams[4] = t(1);
+  out_poseParams[5] = t(2);
+}
+
+void addPose(ceres::Problem& problem,
+             BA_Refine refineOptions,
+             const Pose3 & pose,
+             std::vector<double>& out_poseParams)
+{
+  setPoseParams(pose, out_poseParams);
 
   double * parameter_block = &out_poseParams[0];
   problem.AddParameterBlock(parameter_block, 6);
@@ -133,6 +157,145 @@ void addPose(ceres::Problem& problem,
   }
 }
 
+void addIntrinsic(ceres::Problem& problem,
+                  BA_Refine refineOptions,
+                  const IntrinsicBase & intrinsic,
+                  std::size_t intrinsicUsage,
+                  std::vector<double>& out_intrinsicParams)
+{
+  const bool refineIntrinsicsOpticalCenter = (refineOptions & BA_REFINE_INTRINSICS_OPTICALCENTER_ALWAYS) || (refineOptions & BA_REFINE_INTRINSICS_OPTICALCENTER_IF_ENOUGH_DATA);
+  const bool refineIntrinsics = (refineOptions & BA_REFINE_INTRINSICS_FOCAL) ||
+                                (refineOptions & BA_REFINE_INTRINSICS_DISTORTION) ||
+                                refineIntrinsicsOpticalCenter;
+  out_intrinsicParams = intrinsic.getParams();
+
+  double * parameter_block = &out_intrinsicParams[0];
+  problem.AddParameterBlock(parameter_block, out_intrinsicParams.size());
+  if (!refineIntrinsics)
+  {
+    // Nothing to refine in the intrinsics,
+    // so set the whole parameter block as constant with better performances.
+    problem.SetParameterBlockConstant(parameter_block);
+  }
+  else
+  {
+    std::vector<int> vec_constant_params;
+    // Focal length
+    if(refineOptions & BA_REFINE_INTRINSICS_FOCAL)
+    {
+      // Refine the focal length
+      if(intrinsic.initialFocalLengthPix() > 0)
+      {
+        // If we have an initial guess, we only authorize a margin around this value.
+        assert(out_intrinsicParams.size() >= 1);
+        const unsigned int maxFocalErr = 0.2 * std::max(intrinsic.w(), intrinsic.h());
+        problem.SetParameterLowerBound(parameter_block, 0, (double)intrinsic.initialFocalLengthPix() - maxFocalErr);
+        problem.SetParameterUpperBound(parameter_block, 0, (double)intrinsic.initialFocalLengthPix() + maxFocalErr);
+      }
+      else // no initial guess
+      {
+        // We don't have an initial guess, but we assume that we use
+        // a converging lens, so the focal length should be positive.
+        problem.SetParameterLowerBound(parameter_block, 0, 0.0);
+      }
+    }
+    else
+    {
+      // Set focal length as constant
+      vec_constant_params.push_back(0);
+    }
+
+    const std::size_t minImagesForOpticalCenter = 3;
+
+    // Optical center
+    if((refineOptions & BA_REFINE_INTRINSICS_OPTICALCENTER_ALWAYS) ||
+       ((refineOptions & BA_REFINE_INTRINSICS_OPTICALCENTER_IF_ENOUGH_DATA) && intrinsicUsage > minImagesForOpticalCenter)
+       )
+    {
+      // Refine optical center within 10% of the image size.
+      assert(out_intrinsicParams.size() >= 3);
+
+      const double opticalCenterMinPercent = 0.45;
+      const double opticalCenterMaxPercent = 0.55;
+
+      // Add bounds to the principal point
+      problem.SetParameterLowerBound(parameter_block, 1, opticalCenterMinPercent * intrinsic.w());
+      problem.SetParameterUpperBound(parameter_block, 1, opticalCenterMaxPercent * intrinsic.w());
+
+      problem.SetParameterLowerBound(parameter_block, 2, opticalCenterMinPercent * intrinsic.h());
+      problem.SetParameterUpperBound(parameter_block, 2, opticalCenterMaxPercent * intrinsic.h());
+    }
+    else
+    {
+      // Don't refine the optical center
+      vec_constant_params.push_back(1);
+      vec_constant_params.push_back(2);
+    }
+
+    // Lens distortion
+    if(!(refineOptions & BA_REFINE_INTRINSICS_DISTORTION))
+    {
+      for(std::size_t i = 3; i < out_intrinsicParams.size(); ++i)
+      {
+        vec_constant_params.push_back(i);
+      }
+    }
+
+    if(!vec_constant_params.empty())
+    {
+      ceres::SubsetParameterization *subset_parameterization =
+        new ceres::SubsetParameterization(out_intrinsicParams.size(), vec_constant_params);
+      problem.SetParameterization(parameter_block, subset_parameterization);
+    }
+  }
+}
+
+/// Add the reprojection residual of one landmark observation to the problem
+ceres::ResidualBlockId addObservationResidual(
+  ceres::Problem& problem,
+  ceres::LossFunction* lossFunction,
+  SfMData & sfm_data,
+  const View * view,
+  const Vec2 & observation,
+  HashMap<IndexT, std::vector<double>>& map_intrinsics,
+  HashMap<IndexT, std::vector<double>>& map_poses,
+  HashMap<IndexT, HashMap<IndexT, std::vector<double>>>& map_subposes,
+  double * landmarkBlock,
+  bool useAnalyticDerivatives)
+{
+  // Each Residual block takes a point and a camera as input and outputs a 2
+  // dimensional residual. Internally, the cost function stores the observed
+  // image location and compares the reprojection against the observation.
+
+  if(view->isPartOfRig())
+  {
+    ceres::CostFunction* costFunction = createRigCostFunctionFromIntrinsics(sfm_data.intrinsics[view->getIntrinsicId()].get(), observation);
+
+    const Rig& rig = sfm_data.getRig(*view);
+    const RigSubPose& rigSubPose = rig.getSubPose(view->getSubPoseId());
+    assert(rigSubPose.status != ERigSubPoseStatus::UNINITIALIZED);
+
+    double* subpose_ptr = &map_subposes.at(view->getRigId()).at(view->getSubPoseId())[0];
+
+    return problem.AddResidualBlock(
+      costFunction,
+      lossFunction,
+      &map_intrinsics[view->getIntrinsicId()][0],
+      &map_poses[view->getPoseId()][0],
+      subpose_ptr, // subpose of the cameras rig
+      landmarkBlock); //Do we need to copy 3D point to avoid false motion, if failure ?
+  }
+
+  ceres::CostFunction* costFunction = createCostFunctionFromIntrinsics(sfm_data.intrinsics[view->getIntrinsicId()].get(), observation, useAnalyticDerivatives);
+
+  return problem.AddResidualBlock(
+    costFunction,
+    lossFunction,
+    &map_intrinsics[view->getIntrinsicId()][0],
+    &map_poses[view->getPoseId()][0],
+    landmarkBlock); //Do we need to copy 3D point to avoid false motion, if failure ?
+}
+
 BundleAdjustmentCeres::BA_options::BA_options(const bool bVerbose, bool bmultithreaded)
   :_bVerbose(bVerbose)
 {
@@ -143,7 +306,13 @@ BundleAdjustmentCeres::BA_options::BA_options(const bool bVerbose, bool bmultith
     _nbThreads = 1;
 
   _bCeres_Summary = false;
-  
+
+  // Autodiff by default, the analytic Jacobians only cover the pinhole radial/brown models
+  _bUseAnalyticDerivatives = false;
+
+  _bUseInnerIterations = false;
+  _maxLinearSolverIterations = 0;
+
   // Use dense BA by default
   setDenseBA();
 }
@@ -186,6 +355,41 @@ void BundleAdjustmentCeres::BA_options::setSparseBA()
   }
 }
 
+void BundleAdjustmentCeres::BA_options::setIterativeBA()
+{
+  // PCG on the Schur complement: the solves are approximate, but the memory
+  // stays linear in the problem size while the exact Schur factorizations
+  // run out of memory on scenes with thousands of cameras
+  _preconditioner_type = ceres::SCHUR_JACOBI;
+  _linear_solver_type = ceres::ITERATIVE_SCHUR;
+  ALICEVISION_LOG_DEBUG("BundleAdjustmentCeres: ITERATIVE_SCHUR, SCHUR_JACOBI");
+}
+
+void BundleAdjustmentCeres::BA_options::setSolverProfile(BA_SolverProfile profile, const SfMData& sfm_data)
+{
+  if (profile == BA_SOLVER_AUTO)
+  {
+    // Exact factorizations are the most accurate as long as they fit in memory:
+    // dense for small problems, sparse up to ~1k poses, PCG beyond.
+    const std::size_t nbPoses = sfm_data.GetPoses().size();
+    const std::size_t nbLandmarks = sfm_data.structure.size();
+
+    if (nbPoses > 1000 || nbLandmarks > 500000)
+      profile = BA_SOLVER_ITERATIVE_SCHUR;
+    else if (nbPoses > 100)
+      profile = BA_SOLVER_SPARSE_SCHUR;
+    else
+      profile = BA_SOLVER_DENSE_SCHUR;
+  }
+
+  switch (profile)
+  {
+    case BA_SOLVER_SPARSE_SCHUR: setSparseBA(); break;
+    case BA_SOLVER_ITERATIVE_SCHUR: setIterativeBA(); break;
+    default: setDenseBA(); break;
+  }
+}
+
 
 BundleAdjustmentCeres::BundleAdjustmentCeres(
   BundleAdjustmentCeres::BA_options options)
@@ -245,10 +449,6 @@ bool BundleAdjustmentCeres::Adjust(
   HashMap<IndexT, std::size_t> intrinsicsUsage;
 
   // Setup Intrinsics data & subparametrization
-  const bool refineIntrinsicsOpticalCenter = (refineOptions & BA_REFINE_INTRINSICS_OPTICALCENTER_ALWAYS) || (refineOptions & BA_REFINE_INTRINSICS_OPTICALCENTER_IF_ENOUGH_DATA);
-  const bool refineIntrinsics = (refineOptions & BA_REFINE_INTRINSICS_FOCAL) ||
-                                (refineOptions & BA_REFINE_INTRINSICS_DISTORTION) ||
-                                refineIntrinsicsOpticalCenter;
   for(const auto& itView: sfm_data.GetViews())
   {
     const View* v = itView.second.get();
@@ -276,87 +476,7 @@ bool BundleAdjustmentCeres::Adjust(
       continue;
     }
     assert(isValid(itIntrinsic.second->getType()));
-    map_intrinsics[idIntrinsics] = itIntrinsic.second->getParams();
-
-    double * parameter_block = &map_intrinsics[idIntrinsics][0];
-    problem.AddParameterBlock(parameter_block, map_intrinsics[idIntrinsics].size());
-    if (!refineIntrinsics)
-    {
-      // Nothing to refine in the intrinsics,
-      // so set the whole parameter block as constant with better performances.
-      problem.SetParameterBlockConstant(parameter_block);
-    }
-    else
-    {
-      std::vector<int> vec_constant_params;
-      // Focal length
-      if(refineOptions & BA_REFINE_INTRINSICS_FOCAL)
-      {
-        // Refine the focal length
-        if(itIntrinsic.second->initialFocalLengthPix() > 0)
-        {
-          // If we have an initial guess, we only authorize a margin around this value.
-          assert(map_intrinsics[idIntrinsics].size() >= 1);
-          const unsigned int maxFocalErr = 0.2 * std::max(itIntrinsic.second->w(), itIntrinsic.second->h());
-          problem.SetParameterLowerBound(parameter_block, 0, (double)itIntrinsic.second->initialFocalLengthPix() - maxFocalErr);
-          problem.SetParameterUpperBound(parameter_block, 0, (double)itIntrinsic.second->initialFocalLengthPix() + maxFocalErr);
-        }
-        else // no initial guess
-        {
-          // We don't have an initial guess, but we assume that we use
-          // a converging lens, so the focal length should be positive.
-          problem.SetParameterLowerBound(parameter_block, 0, 0.0);
-        }
-      }
-      else
-      {
-        // Set focal length as constant
-        vec_constant_params.push_back(0);
-      }
-
-      const std::size_t minImagesForOpticalCenter = 3;
-
-      // Optical center
-      if((refineOptions & BA_REFINE_INTRINSICS_OPTICALCENTER_ALWAYS) ||
-         ((refineOptions & BA_REFINE_INTRINSICS_OPTICALCENTER_IF_ENOUGH_DATA) && intrinsicsUsage[idIntrinsics] > minImagesForOpticalCenter)
-         )
-      {
-        // Refine optical center within 10% of the image size.
-        assert(map_intrinsics[idIntrinsics].size() >= 3);
-        
-        const double opticalCenterMinPercent = 0.45;
-        const double opticalCenterMaxPercent = 0.55;
-        
-        // Add bounds to the principal point
-        problem.SetParameterLowerBound(parameter_block, 1, opticalCenterMinPercent * itIntrinsic.second->w());
-        problem.SetParameterUpperBound(parameter_block, 1, opticalCenterMaxPercent * itIntrinsic.second->w());
-
-        problem.SetParameterLowerBound(parameter_block, 2, opticalCenterMinPercent * itIntrinsic.second->h());
-        problem.SetParameterUpperBound(parameter_block, 2, opticalCenterMaxPercent * itIntrinsic.second->h());
-      }
-      else
-      {
-        // Don't refine the optical center
-        vec_constant_params.push_back(1);
-        vec_constant_params.push_back(2);
-      }
-
-      // Lens distortion
-      if(!(refineOptions & BA_REFINE_INTRINSICS_DISTORTION))
-      {
-        for(std::size_t i = 3; i < map_intrinsics[idIntrinsics].size(); ++i)
-        {
-          vec_constant_params.push_back(i);
-        }
-      }
-
-      if(!vec_constant_params.empty())
-      {
-        ceres::SubsetParameterization *subset_parameterization =
-          new ceres::SubsetParameterization(map_intrinsics[idIntrinsics].size(), vec_constant_params);
-        problem.SetParameterization(parameter_block, subset_parameterization);
-      }
-    }
+    addIntrinsic(problem, refineOptions, *itIntrinsic.second, intrinsicsUsage[idIntrinsics], map_intrinsics[idIntrinsics]);
   }
 
   // Set a LossFunction to be less penalized by false measurements
@@ -365,54 +485,50 @@ bool BundleAdjustmentCeres::Adjust(
   // TODO: make the LOSS function and the parameter an option
 
 
+  // Gather the landmarks in a compact structure-of-arrays layout: the residual
+  // block assembly walks flat observation records instead of chasing the landmark
+  // map, and the 3D point parameter blocks are contiguous for the solver.
+  LandmarksData landmarksData;
+  landmarksData.fromLandmarks(sfm_data.structure);
+
   // For all visibility add reprojections errors:
-  for(auto& landmarkIt: sfm_data.structure)
+  for(std::size_t i = 0; i < landmarksData.nbLandmarks(); ++i)
   {
-    const Observations & observations = landmarkIt.second.observations;
+    double* landmarkBlock = landmarksData.pointPtr(i);
+
     // Iterate over 2D observation associated to the 3D landmark
-    for (const auto& observationIt: observations)
+    for(std::size_t o = landmarksData.obsBegin(i); o < landmarksData.obsEnd(i); ++o)
     {
+      const LandmarksData::ObservationRecord& record = landmarksData.observation(o);
       // Build the residual block corresponding to the track observation:
-      const View * view = sfm_data.views.at(observationIt.first).get();
-
-      // Each Residual block takes a point and a camera as input and outputs a 2
-      // dimensional residual. Internally, the cost function stores the observed
-      // image location and compares the reprojection against the observation.
-
-      if(view->isPartOfRig())
-      {
-        ceres::CostFunction* costFunction = createRigCostFunctionFromIntrinsics(sfm_data.intrinsics[view->getIntrinsicId()].get(), observationIt.second.x);
+      const View * view = sfm_data.views.at(record.viewId).get();
 
-        const Rig& rig = sfm_data.getRig(*view);
-        const RigSubPose& rigSubPose = rig.getSubPose(view->getSubPoseId());
-        assert(rigSubPose.status != ERigSubPoseStatus::UNINITIALIZED);
-
-        double* subpose_ptr = &map_subposes.at(view->getRigId()).at(view->getSubPoseId())[0];
-
-        problem.AddResidualBlock(
-          costFunction,
-          p_LossFunction,
-          &map_intrinsics[view->getIntrinsicId()][0],
-          &map_poses[view->getPoseId()][0],
-          subpose_ptr, // subpose of the cameras rig
-          landmarkIt.second.X.data()); //Do we need to copy 3D point to avoid false motion, if failure ?
-      }
-      else
-      {
-        ceres::CostFunction* costFunction = createCostFunctionFromIntrinsics(sfm_data.intrinsics[view->getIntrinsicId()].get(), observationIt.second.x);
-
-        problem.AddResidualBlock(
-          costFunction,
-          p_LossFunction,
-          &map_intrinsics[view->getIntrinsicId()][0],
-          &map_poses[view->getPoseId()][0],
-          landmarkIt.second.X.data()); //Do we need to copy 3D point to avoid false motion, if failure ?
-      }
+      addObservationResidual(problem, p_LossFunction, sfm_data, view, Vec2(record.x, record.y),
+        map_intrinsics, map_poses, map_subposes, landmarkBlock,
+        _aliceVision_options._bUseAnalyticDerivatives);
     }
     if (!(refineOptions & BA_REFINE_STRUCTURE))
-      problem.SetParameterBlockConstant(landmarkIt.second.X.data());
+      problem.SetParameterBlockConstant(landmarkBlock);
   }
 
+  if(!solveAndUpdate(problem, sfm_data, refineOptions, map_poses, map_subposes, map_intrinsics))
+    return false;
+
+  // write the refined 3D points back to the scene
+  if(refineOptions & BA_REFINE_STRUCTURE)
+    landmarksData.updatePoints(sfm_data.structure);
+
+  return true;
+}
+
+bool BundleAdjustmentCeres::solveAndUpdate(
+  ceres::Problem& problem,
+  SfMData& sfm_data,
+  BA_Refine refineOptions,
+  HashMap<IndexT, std::vector<double>>& map_poses,
+  HashMap<IndexT, HashMap<IndexT, std::vector<double>>>& map_subposes,
+  HashMap<IndexT, std::vector<double>>& map_intrinsics)
+{
   // Configure a BA engine and run it
   //  Make Ceres automatically detect the bundle structure.
   ceres::Solver::Options options;
@@ -423,6 +539,9 @@ bool BundleAdjustmentCeres::Adjust(
   options.logging_type = ceres::SILENT;
   options.num_threads = _aliceVision_options._nbThreads;
   options.num_linear_solver_threads = _aliceVision_options._nbThreads;
+  options.use_inner_iterations = _aliceVision_options._bUseInnerIterations;
+  if (_aliceVision_options._maxLinearSolverIterations > 0)
+    options.max_linear_solver_iterations = _aliceVision_options._maxLinearSolverIterations;
 
   // Solve BA
   ceres::Solver::Summary summary;
@@ -488,6 +607,10 @@ bool BundleAdjustmentCeres::Adjust(
   }
 
   // Update camera intrinsics with refined data
+  const bool refineIntrinsics = (refineOptions & BA_REFINE_INTRINSICS_FOCAL) ||
+                                (refineOptions & BA_REFINE_INTRINSICS_DISTORTION) ||
+                                (refineOptions & BA_REFINE_INTRINSICS_OPTICALCENTER_ALWAYS) ||
+                                (refineOptions & BA_REFINE_INTRINSICS_OPTICALCENTER_IF_ENOUGH_DATA);
   if (refineIntrinsics)
   {
     for (const auto& intrinsicsV: map_intrinsics)
@@ -498,6 +621,184 @@ bool BundleAdjustmentCeres::Adjust(
   return true;
 }
 
+void BundleAdjustmentCeres::resetProblem()
+{
+  _problem.reset();
+  _lossFunction = nullptr; // owned by the problem
+  _problemScene = nullptr;
+  _problemRefineOptions = BA_REFINE_NONE;
+  _posesParams.clear();
+  _subposesParams.clear();
+  _intrinsicsParams.clear();
+  _landmarkResiduals.clear();
+}
+
+bool BundleAdjustmentCeres::AdjustIncremental(
+  SfMData & sfm_data,
+  BA_Refine refineOptions)
+{
+  // Ensure we are not using incompatible options:
+  //  - BA_REFINE_INTRINSICS_OPTICALCENTER_ALWAYS and BA_REFINE_INTRINSICS_OPTICALCENTER_IF_ENOUGH_DATA cannot be used at the same time
+  assert(!((refineOptions & BA_REFINE_INTRINSICS_OPTICALCENTER_ALWAYS) && (refineOptions & BA_REFINE_INTRINSICS_OPTICALCENTER_IF_ENOUGH_DATA)));
+
+  // The persistent problem references parameter blocks stored in the scene and
+  // in the member maps: it cannot survive a scene change or other refine options.
+  if (_problem != nullptr && (_problemScene != &sfm_data || _problemRefineOptions != refineOptions))
+    resetProblem();
+
+  // A removed pose or intrinsic would leave residual blocks wired on a stale
+  // parameter block: fall back to a full rebuild in that rare case.
+  if (_problem != nullptr)
+  {
+    bool reusable = true;
+    for (const auto& itPose: _posesParams)
+      if (sfm_data.GetPoses().count(itPose.first) == 0)
+        reusable = false;
+    for (const auto& itIntrinsic: _intrinsicsParams)
+      if (sfm_data.GetIntrinsics().count(itIntrinsic.first) == 0)
+        reusable = false;
+    if (!reusable)
+      resetProblem();
+  }
+
+  if (_problem == nullptr)
+  {
+    ceres::Problem::Options problemOptions;
+    // Required to erase the residual blocks of the tracks removed by the
+    // outlier filtering without rebuilding the whole problem.
+    problemOptions.enable_fast_removal = true;
+    _problem.reset(new ceres::Problem(problemOptions));
+    // Set a LossFunction to be less penalized by false measurements.
+    // The problem takes the ownership and shares it between the residual blocks.
+    _lossFunction = new ceres::HuberLoss(Square(4.0));
+    _problemScene = &sfm_data;
+    _problemRefineOptions = refineOptions;
+  }
+  ceres::Problem& problem = *_problem;
+
+  // Setup Poses data & subparametrization:
+  // add the new poses, refresh the parameter values of the existing ones in place
+  for (Poses::const_iterator itPose = sfm_data.GetPoses().begin(); itPose != sfm_data.GetPoses().end(); ++itPose)
+  {
+    const auto paramsIt = _posesParams.find(itPose->first);
+    if (paramsIt == _posesParams.end())
+      addPose(problem, refineOptions, itPose->second, _posesParams[itPose->first]);
+    else
+      setPoseParams(itPose->second, paramsIt->second);
+  }
+
+  // Setup rig sub-poses
+  for(const auto& rigIt : sfm_data.getRigs())
+  {
+    const IndexT rigId = rigIt.first;
+    const Rig& rig = rigIt.second;
+    const std::size_t nbSubPoses = rig.getNbSubPoses();
+
+    for(std::size_t subPoseId = 0 ; subPoseId < nbSubPoses; ++subPoseId)
+    {
+      const RigSubPose& rigSubPose = rig.getSubPose(subPoseId);
+
+      if(rigSubPose.status == ERigSubPoseStatus::UNINITIALIZED)
+        continue;
+
+      HashMap<IndexT, std::vector<double>>& rigParams = _subposesParams[rigId];
+      const auto paramsIt = rigParams.find(subPoseId);
+      if (paramsIt == rigParams.end())
+        addPose(problem, refineOptions, rigSubPose.pose, rigParams[subPoseId]);
+      else
+        setPoseParams(rigSubPose.pose, paramsIt->second);
+    }
+  }
+
+  // Count how many views use each intrinsic (for the optical center refinement policy)
+  HashMap<IndexT, std::size_t> intrinsicsUsage;
+  for(const auto& itView: sfm_data.GetViews())
+  {
+    const View* v = itView.second.get();
+    if (sfm_data.IsPoseAndIntrinsicDefined(v))
+      ++intrinsicsUsage[v->getIntrinsicId()];
+  }
+
+  // Setup Intrinsics data & subparametrization
+  for(const auto& itIntrinsic: sfm_data.GetIntrinsics())
+  {
+    const IndexT idIntrinsics = itIntrinsic.first;
+    const auto paramsIt = _intrinsicsParams.find(idIntrinsics);
+    if (paramsIt != _intrinsicsParams.end())
+    {
+      // Refresh the parameter values in place: the block pointer must not change
+      const std::vector<double> params = itIntrinsic.second->getParams();
+      assert(params.size() == paramsIt->second.size());
+      std::copy(params.begin(), params.end(), paramsIt->second.begin());
+    }
+    else if (intrinsicsUsage[idIntrinsics] > 0)
+    {
+      assert(isValid(itIntrinsic.second->getType()));
+      addIntrinsic(problem, refineOptions, *itIntrinsic.second, intrinsicsUsage[idIntrinsics], _intrinsicsParams[idIntrinsics]);
+    }
+  }
+
+  // Erase the residual blocks of the landmarks removed from the scene
+  // (outlier filtering), then release their 3D point parameter block.
+  // The stored block pointer is only used as a key by ceres, never dereferenced.
+  for (auto landmarkIt = _landmarkResiduals.begin(); landmarkIt != _landmarkResiduals.end(); )
+  {
+    if (sfm_data.structure.count(landmarkIt->first) == 0)
+    {
+      for (const ceres::ResidualBlockId block: landmarkIt->second.blocks)
+        problem.RemoveResidualBlock(block);
+      problem.RemoveParameterBlock(landmarkIt->second.parameterBlock);
+      landmarkIt = _landmarkResiduals.erase(landmarkIt);
+    }
+    else
+    {
+      ++landmarkIt;
+    }
+  }
+
+  // For all visibility add reprojections errors of the new landmarks;
+  // a landmark whose observations or 3D point storage changed (removed and
+  // re-triangulated track) gets its residual blocks rebuilt.
+  for(auto& landmarkIt: sfm_data.structure)
+  {
+    const Observations & observations = landmarkIt.second.observations;
+    const auto residualsIt = _landmarkResiduals.find(landmarkIt.first);
+    if (residualsIt != _landmarkResiduals.end())
+    {
+      if (residualsIt->second.nbObservations == observations.size() &&
+          residualsIt->second.parameterBlock == landmarkIt.second.X.data())
+        continue; // unchanged track
+
+      for (const ceres::ResidualBlockId block: residualsIt->second.blocks)
+        problem.RemoveResidualBlock(block);
+      if (residualsIt->second.parameterBlock != landmarkIt.second.X.data())
+        problem.RemoveParameterBlock(residualsIt->second.parameterBlock);
+    }
+
+    LandmarkResidualBlocks& residuals = _landmarkResiduals[landmarkIt.first];
+    residuals.blocks.clear();
+    residuals.blocks.reserve(observations.size());
+    residuals.nbObservations = observations.size();
+    residuals.parameterBlock = landmarkIt.second.X.data();
+
+    // Iterate over 2D observation associated to the 3D landmark
+    for (const auto& observationIt: observations)
+    {
+      // Build the residual block corresponding to the track observation:
+      const View * view = sfm_data.views.at(observationIt.first).get();
+
+      residuals.blocks.push_back(
+        addObservationResidual(problem, _lossFunction, sfm_data, view, observationIt.second.x,
+          _intrinsicsParams, _posesParams, _subposesParams, landmarkIt.second.X.data(),
+          _aliceVision_options._bUseAnalyticDerivatives));
+    }
+    if (!(refineOptions & BA_REFINE_STRUCTURE))
+      problem.SetParameterBlockConstant(landmarkIt.second.X.data());
+  }
+
+  return solveAndUpdate(problem, sfm_data, refineOptions, _posesParams, _subposesParams, _intrinsicsParams);
+}
+
 } // namespace sfm
 } // namespace aliceVision
 
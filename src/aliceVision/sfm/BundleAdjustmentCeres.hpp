@@ -10,11 +10,15 @@
 #include "aliceVision/sfm/ResidualErrorFunctor.hpp"
 #include "ceres/ceres.h"
 
+#include <memory>
+
 namespace aliceVision {
 namespace sfm {
 
-/// Create the appropriate cost functor according the provided input camera intrinsic model
-ceres::CostFunction * createCostFunctionFromIntrinsics(camera::IntrinsicBase * intrinsic, const Vec2 & observation);
+/// Create the appropriate cost functor according the provided input camera intrinsic model.
+/// With useAnalyticDerivatives the hand-derived Jacobian implementations are used for the
+/// models providing one, the other models fall back to automatic differentiation.
+ceres::CostFunction * createCostFunctionFromIntrinsics(camera::IntrinsicBase * intrinsic, const Vec2 & observation, bool useAnalyticDerivatives = false);
 ceres::CostFunction * createRigCostFunctionFromIntrinsics(camera::IntrinsicBase * intrinsic, const Vec2 & observation);
 
 class BundleAdjustmentCeres : public BundleAdjustment
@@ -25,6 +29,9 @@ class BundleAdjustmentCeres : public BundleAdjustment
     bool _bVerbose;
     unsigned int _nbThreads;
     bool _bCeres_Summary;
+    bool _bUseAnalyticDerivatives; //< hand-derived Jacobians instead of autodiff for the supported camera models
+    bool _bUseInnerIterations; //< ceres inner iterations (coordinate descent between the solver iterations)
+    unsigned int _maxLinearSolverIterations; //< cap on the PCG iterations of ITERATIVE_SCHUR, 0 keeps the ceres default
     ceres::LinearSolverType _linear_solver_type;
     ceres::PreconditionerType _preconditioner_type;
     ceres::SparseLinearAlgebraLibraryType _sparse_linear_algebra_library_type;
@@ -32,6 +39,13 @@ class BundleAdjustmentCeres : public BundleAdjustment
     BA_options(const bool bVerbose = true, bool bmultithreaded = true);
     void setDenseBA();
     void setSparseBA();
+    void setIterativeBA();
+
+    /// Choose the linear solver from a profile; BA_SOLVER_AUTO picks it from the scene size
+    void setSolverProfile(BA_SolverProfile profile, const SfMData& sfm_data);
+
+    /// Set the number of threads used by the jacobian evaluation and the linear solver
+    void setNbThreads(unsigned int nbThreads) { _nbThreads = nbThreads; }
   };
   private:
     BA_options _aliceVision_options;
@@ -39,12 +53,64 @@ class BundleAdjustmentCeres : public BundleAdjustment
   public:
   BundleAdjustmentCeres(BundleAdjustmentCeres::BA_options options = BA_options());
 
+  /// Replace the solver options used by the next Adjust calls
+  void setOptions(const BA_options& options) { _aliceVision_options = options; }
+
   /**
    * @see BundleAdjustment::Adjust
    */
   bool Adjust(
     SfMData & sfm_data,
     BA_Refine refineOptions = BA_REFINE_ALL);
+
+  /**
+   * @brief Incremental variant of Adjust: the ceres::Problem is kept alive
+   * between the calls on the same scene.
+   *
+   * Only the residual blocks of the new or modified tracks are added (and the
+   * ones of removed tracks erased), the parameter values of the existing blocks
+   * are refreshed in place, and the solver starts from the previous solution
+   * stored in the scene. The problem is rebuilt from scratch whenever it cannot
+   * be reused: another scene, other refine options, or a removed pose/intrinsic.
+   *
+   * @param[in,out] sfm_data The SfM scene to refine, must stay alive between the calls
+   * @param[in] refineOptions What to refine, must not change between the calls
+   * @return false if the solution is not usable
+   */
+  bool AdjustIncremental(
+    SfMData & sfm_data,
+    BA_Refine refineOptions = BA_REFINE_ALL);
+
+  /// Drop the problem kept alive by AdjustIncremental, the next call rebuilds it
+  void resetProblem();
+
+  private:
+  /// Residual blocks attached to one landmark of the persistent problem
+  struct LandmarkResidualBlocks
+  {
+    std::vector<ceres::ResidualBlockId> blocks;
+    std::size_t nbObservations = 0;
+    double* parameterBlock = nullptr;
+  };
+
+  /// Solve the given problem and write the refined parameters back in the scene
+  bool solveAndUpdate(
+    ceres::Problem& problem,
+    SfMData& sfm_data,
+    BA_Refine refineOptions,
+    HashMap<IndexT, std::vector<double>>& map_poses,
+    HashMap<IndexT, HashMap<IndexT, std::vector<double>>>& map_subposes,
+    HashMap<IndexT, std::vector<double>>& map_intrinsics);
+
+  // Persistent problem state for AdjustIncremental
+  std::unique_ptr<ceres::Problem> _problem;
+  ceres::LossFunction* _lossFunction = nullptr; //< owned by _problem
+  SfMData* _problemScene = nullptr;
+  BA_Refine _problemRefineOptions = BA_REFINE_NONE;
+  HashMap<IndexT, std::vector<double>> _posesParams;
+  HashMap<IndexT, HashMap<IndexT, std::vector<double>>> _subposesParams;
+  HashMap<IndexT, std::vector<double>> _intrinsicsParams;
+  HashMap<IndexT, LandmarkResidualBlocks> _landmarkResiduals;
 };
 
 } // namespace sfm
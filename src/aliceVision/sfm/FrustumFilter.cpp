@@ -12,7 +12,9 @@
 
 #include <boost/progress.hpp>
 
+#include <algorithm>
 #include <fstream>
+#include <numeric>
 
 namespace aliceVision {
 namespace sfm {
@@ -21,6 +23,109 @@ using namespace aliceVision::camera;
 using namespace aliceVision::geometry;
 using namespace aliceVision::geometry::halfPlane;
 
+namespace {
+
+/// Bounding-volume hierarchy over axis-aligned bounding boxes.
+/// A box query returns the indexes of every stored box overlapping the query box,
+/// so only those candidate pairs have to go through the costly
+/// linear-programming based Frustum::intersect test.
+class BoxBVH
+{
+public:
+  explicit BoxBVH(const std::vector<Eigen::AlignedBox3d> & boxes)
+    : _boxes(boxes)
+  {
+    _indexes.resize(boxes.size());
+    std::iota(_indexes.begin(), _indexes.end(), 0);
+    if (!_indexes.empty())
+    {
+      _nodes.reserve(2 * _indexes.size());
+      build(0, _indexes.size());
+    }
+  }
+
+  /// List the indexes of the stored boxes that overlap the given box
+  void query(const Eigen::AlignedBox3d & box, std::vector<size_t> & candidates) const
+  {
+    if (_nodes.empty())
+      return;
+    queryNode(0, box, candidates);
+  }
+
+private:
+  static const size_t _leafSize = 8;
+
+  struct Node
+  {
+    Eigen::AlignedBox3d box;
+    int children[2]; // {-1,-1} for a leaf node
+    size_t begin, end; // box indexes range covered by a leaf node
+  };
+
+  /// Build the node covering the given _indexes range, return its index
+  int build(const size_t begin, const size_t end)
+  {
+    const int nodeId = static_cast<int>(_nodes.size());
+    _nodes.emplace_back();
+    Eigen::AlignedBox3d box;
+    for (size_t i = begin; i < end; ++i)
+      box.extend(_boxes[_indexes[i]]);
+
+    if (end - begin <= _leafSize)
+    {
+      Node & node = _nodes[nodeId];
+      node.box = box;
+      node.children[0] = node.children[1] = -1;
+      node.begin = begin;
+      node.end = end;
+      return nodeId;
+    }
+
+    // Split the boxes at the median of their centers, along the largest box dimension
+    int splitAxis = 0;
+    box.sizes().maxCoeff(&splitAxis);
+    const size_t middle = begin + (end - begin) / 2;
+    std::nth_element(_indexes.begin() + begin, _indexes.begin() + middle, _indexes.begin() + end,
+      [&](const size_t a, const size_t b)
+      {
+        return _boxes[a].center()[splitAxis] < _boxes[b].center()[splitAxis];
+      });
+
+    const int left = build(begin, middle);
+    const int right = build(middle, end);
+    Node & node = _nodes[nodeId];
+    node.box = box;
+    node.children[0] = left;
+    node.children[1] = right;
+    node.begin = node.end = 0;
+    return nodeId;
+  }
+
+  void queryNode(const int nodeId, const Eigen::AlignedBox3d & box, std::vector<size_t> & candidates) const
+  {
+    const Node & node = _nodes[nodeId];
+    if (!node.box.intersects(box))
+      return;
+    if (node.children[0] == -1) // leaf node
+    {
+      for (size_t i = node.begin; i < node.end; ++i)
+      {
+        if (_boxes[_indexes[i]].intersects(box))
+          candidates.push_back(_indexes[i]);
+      }
+      return;
+    }
+    queryNode(node.children[0], box, candidates);
+    queryNode(node.children[1], box, candidates);
+  }
+
+  const std::vector<Eigen::AlignedBox3d> & _boxes;
+  std::vector<size_t> _indexes;
+  std::vector<Node> _nodes;
+};
+
+} // namespace
+
 // Constructor
 FrustumFilter::FrustumFilter(const SfMData & sfm_data,
   const double zNear, const double zFar)
@@ -76,27 +181,81 @@ PairSet FrustumFilter::getFrustumIntersectionPairs() const
   std::transform(z_near_z_far_perView.begin(), z_near_z_far_perView.end(),
     std::back_inserter(viewIds), stl::RetrieveKey());
 
-  boost::progress_display my_progress_bar(
-    viewIds.size() * (viewIds.size()-1)/2,
-    std::cout, "\nCompute frustum intersection\n");
-
-  // Exhaustive comparison (use the fact that the intersect function is symmetric)
-  #pragma omp parallel for
-  for (int i = 0; i < (int)viewIds.size(); ++i)
+  if (_bTruncated)
   {
-    for (size_t j = i+1; j < viewIds.size(); ++j)
+    // A truncated frustum is the convex hull of its supporting points, so two frustums
+    // can only intersect if the bounding boxes of their supporting points overlap.
+    // Use a BVH over the bounding boxes to list the overlapping candidates, so the costly
+    // intersect test runs on a set close to the true intersection set instead of all the pairs.
+    std::vector<Eigen::AlignedBox3d> boxes(viewIds.size());
+    for (size_t i = 0; i < viewIds.size(); ++i)
     {
-      if (frustum_perView.at(viewIds[i]).intersect(frustum_perView.at(viewIds[j])))
+      const std::vector<Vec3> & points = frustum_perView.at(viewIds[i]).frustum_points();
+      for (const Vec3 & pt : points)
+        boxes[i].extend(pt);
+    }
+    const BoxBVH bvh(boxes);
+
+    boost::progress_display my_progress_bar(
+      viewIds.size(),
+      std::cout, "\nCompute frustum intersection\n");
+
+    // Per-view intersecting pairs, merged in view order after the parallel region
+    std::vector<std::vector<Pair> > pairsPerView(viewIds.size());
+
+    #pragma omp parallel
+    {
+      std::vector<size_t> candidates;
+
+      #pragma omp for schedule(dynamic)
+      for (int i = 0; i < (int)viewIds.size(); ++i)
       {
+        candidates.clear();
+        bvh.query(boxes[i], candidates);
+        for (const size_t j : candidates)
+        {
+          // use the fact that the intersect function is symmetric
+          if (j <= (size_t)i)
+            continue;
+          if (frustum_perView.at(viewIds[i]).intersect(frustum_perView.at(viewIds[j])))
+            pairsPerView[i].emplace_back(viewIds[i], viewIds[j]);
+        }
+        // Progress bar update
         #pragma omp critical
         {
-          pairs.insert(std::make_pair(viewIds[i], viewIds[j]));
+          ++my_progress_bar;
         }
       }
-      // Progress bar update
-      #pragma omp critical
+    }
+
+    for (const auto & viewPairs : pairsPerView)
+      pairs.insert(viewPairs.begin(), viewPairs.end());
+  }
+  else
+  {
+    // Infinite frustums are unbounded volumes: no bounding box pruning possible
+    boost::progress_display my_progress_bar(
+      viewIds.size() * (viewIds.size()-1)/2,
+      std::cout, "\nCompute frustum intersection\n");
+
+    // Exhaustive comparison (use the fact that the intersect function is symmetric)
+    #pragma omp parallel for
+    for (int i = 0; i < (int)viewIds.size(); ++i)
+    {
+      for (size_t j = i+1; j < viewIds.size(); ++j)
       {
-        ++my_progress_bar;
+        if (frustum_perView.at(viewIds[i]).intersect(frustum_perView.at(viewIds[j])))
+        {
+          #pragma omp critical
+          {
+            pairs.insert(std::make_pair(viewIds[i], viewIds[j]));
+          }
+        }
+        // Progress bar update
+        #pragma omp critical
+        {
+          ++my_progress_bar;
+        }
       }
     }
   }
@@ -220,13 +379,9 @@ void FrustumFilter::init_z_near_z_far_depth(const SfMData & sfm_data,
   else
   {
     // Init the same near & far limit for all the valid views
-    for (Views::const_iterator it = sfm_data.GetViews().begin();
-    it != sfm_data.GetViews().end(); ++it)
+    for (const Views::value_type& viewPair : sfm_data.validViews())
     {
-      const View * view = it->second.get();
-      if (!sfm_data.IsPoseAndIntrinsicDefined(view))
-        continue;
-      z_near_z_far_perView[view->getViewId()] = std::make_pair(zNear, zFar);
+      z_near_z_far_perView[viewPair.second->getViewId()] = std::make_pair(zNear, zFar);
     }
   }
 }
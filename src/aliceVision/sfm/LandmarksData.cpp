@@ -0,0 +1,113 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "LandmarksData.hpp"
+
+#include <cassert>
+
+namespace aliceVision {
+namespace sfm {
+
+void LandmarksData::fromLandmarks(const Landmarks& landmarks)
+{
+  const std::size_t nbLandmarks = landmarks.size();
+
+  std::size_t nbObservations = 0;
+  for(const auto& landmarkIt : landmarks)
+    nbObservations += landmarkIt.second.observations.size();
+
+  _landmarkIds.clear();
+  _landmarkIds.reserve(nbLandmarks);
+  _points.clear();
+  _points.reserve(3 * nbLandmarks);
+  _descTypes.clear();
+  _descTypes.reserve(nbLandmarks);
+  _colors.clear();
+  _colors.reserve(nbLandmarks);
+  _observationStarts.clear();
+  _observationStarts.reserve(nbLandmarks + 1);
+  _observations.clear();
+  _observations.reserve(nbObservations);
+
+  for(const auto& landmarkIt : landmarks)
+  {
+    const Landmark& landmark = landmarkIt.second;
+
+    _landmarkIds.push_back(landmarkIt.first);
+    _points.push_back(landmark.X(0));
+    _points.push_back(landmark.X(1));
+    _points.push_back(landmark.X(2));
+    _descTypes.push_back(landmark.descType);
+    _colors.push_back(landmark.rgb);
+    _observationStarts.push_back(_observations.size());
+
+    for(const auto& observationIt : landmark.observations)
+    {
+      ObservationRecord record;
+      record.viewId = observationIt.first;
+      record.featId = observationIt.second.id_feat;
+      record.x = observationIt.second.x(0);
+      record.y = observationIt.second.x(1);
+      _observations.push_back(record);
+    }
+  }
+  _observationStarts.push_back(_observations.size());
+
+  _erasedLandmarks.assign(nbLandmarks, 0);
+  _erasedObservations.assign(_observations.size(), 0);
+}
+
+void LandmarksData::toLandmarks(Landmarks& landmarks) const
+{
+  landmarks.clear();
+
+  for(std::size_t i = 0; i < nbLandmarks(); ++i)
+  {
+    if(isLandmarkErased(i))
+      continue;
+
+    Landmark& landmark = landmarks[_landmarkIds[i]];
+    landmark.X = point(i);
+    landmark.descType = _descTypes[i];
+    landmark.rgb = _colors[i];
+
+    // records are grouped by landmark with ascending view ids,
+    // so the flat_map can be filled with an end hint
+    for(std::size_t o = obsBegin(i); o < obsEnd(i); ++o)
+    {
+      if(isObservationErased(o))
+        continue;
+
+      const ObservationRecord& record = _observations[o];
+      landmark.observations.emplace_hint(landmark.observations.end(),
+                                         record.viewId,
+                                         Observation(Vec2(record.x, record.y), record.featId));
+    }
+  }
+}
+
+void LandmarksData::applySRt(const double S, const Mat3& R, const Vec3& t)
+{
+  if(_points.empty())
+    return;
+
+  // the points are stored as 3 contiguous doubles per landmark,
+  // so the whole cloud can be mapped as a 3xN matrix and moved at once
+  Eigen::Map<Mat3X> points(&_points[0], 3, nbLandmarks());
+  points = (S * R * points).colwise() + t;
+}
+
+void LandmarksData::updatePoints(Landmarks& landmarks) const
+{
+  for(std::size_t i = 0; i < nbLandmarks(); ++i)
+  {
+    Landmarks::iterator landmarkIt = landmarks.find(_landmarkIds[i]);
+    assert(landmarkIt != landmarks.end());
+    landmarkIt->second.X = point(i);
+  }
+}
+
+} // namespace sfm
+} // namespace aliceVision
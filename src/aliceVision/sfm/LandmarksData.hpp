@@ -0,0 +1,113 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/sfm/Landmark.hpp>
+#include <aliceVision/types.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace aliceVision {
+namespace sfm {
+
+/**
+ * @brief Compact structure-of-arrays representation of the scene landmarks.
+ *
+ * The map form (Landmarks) is convenient for incremental updates but chases
+ * pointers on every access. This class gathers the 3D points into one
+ * contiguous array and the 2D observations into flat records grouped by
+ * landmark, so that bulk consumers (bundle adjustment assembly, observation
+ * filters) can walk the scene linearly.
+ */
+class LandmarksData
+{
+public:
+
+  /// flat 2D observation record
+  struct ObservationRecord
+  {
+    IndexT viewId;
+    IndexT featId;
+    double x;
+    double y;
+  };
+
+  /**
+   * @brief Gather the landmarks of the map form into contiguous arrays.
+   * Previous content and erased markers are discarded.
+   * @param[in] landmarks the scene landmarks
+   */
+  void fromLandmarks(const Landmarks& landmarks);
+
+  /**
+   * @brief Rebuild the map form, skipping the erased landmarks and observations.
+   * @param[out] landmarks the output scene landmarks
+   */
+  void toLandmarks(Landmarks& landmarks) const;
+
+  /**
+   * @brief Write the (possibly refined) 3D points back into an existing map form.
+   * The landmark set must not have changed since fromLandmarks().
+   * @param[in,out] landmarks the scene landmarks to update
+   */
+  void updatePoints(Landmarks& landmarks) const;
+
+  /**
+   * @brief Apply the transformation X = S * R * X + t to every 3D point,
+   * in place, as one vectorized pass over the contiguous point storage.
+   * @param[in] S the scale
+   * @param[in] R the 3x3 rotation
+   * @param[in] t the translation
+   */
+  void applySRt(const double S, const Mat3& R, const Vec3& t);
+
+  std::size_t nbLandmarks() const { return _landmarkIds.size(); }
+  std::size_t nbObservations() const { return _observations.size(); }
+
+  IndexT landmarkId(std::size_t i) const { return _landmarkIds[i]; }
+  feature::EImageDescriberType descType(std::size_t i) const { return _descTypes[i]; }
+
+  /// contiguous (x, y, z) storage of the 3D point of the i-th landmark,
+  /// usable in-place as an optimization parameter block
+  double* pointPtr(std::size_t i) { return &_points[3 * i]; }
+  const double* pointPtr(std::size_t i) const { return &_points[3 * i]; }
+  Vec3 point(std::size_t i) const { return Eigen::Map<const Vec3>(pointPtr(i)); }
+
+  /// observation record range [obsBegin(i), obsEnd(i)) of the i-th landmark,
+  /// view ids are ascending inside a range
+  std::size_t obsBegin(std::size_t i) const { return _observationStarts[i]; }
+  std::size_t obsEnd(std::size_t i) const { return _observationStarts[i + 1]; }
+  const ObservationRecord& observation(std::size_t o) const { return _observations[o]; }
+
+  /// erased markers are honoured by toLandmarks()
+  void eraseLandmark(std::size_t i) { _erasedLandmarks[i] = 1; }
+  void eraseObservation(std::size_t o) { _erasedObservations[o] = 1; }
+  bool isLandmarkErased(std::size_t i) const { return _erasedLandmarks[i] != 0; }
+  bool isObservationErased(std::size_t o) const { return _erasedObservations[o] != 0; }
+
+private:
+
+  /// landmark ids, in the enumeration order of the source map
+  std::vector<IndexT> _landmarkIds;
+  /// 3D points, 3 contiguous doubles per landmark
+  std::vector<double> _points;
+  /// describer type per landmark
+  std::vector<feature::EImageDescriberType> _descTypes;
+  /// color per landmark
+  std::vector<image::RGBColor> _colors;
+  /// first observation record index per landmark (nbLandmarks() + 1 entries)
+  std::vector<std::size_t> _observationStarts;
+  /// observation records grouped by landmark
+  std::vector<ObservationRecord> _observations;
+  /// per landmark erased marker
+  std::vector<char> _erasedLandmarks;
+  /// per observation erased marker
+  std::vector<char> _erasedObservations;
+};
+
+} // namespace sfm
+} // namespace aliceVision
@@ -306,19 +306,34 @@ void LocalBundleAdjustmentData::computeGraphDistances(const SfMData& sfm_data, c
     else
       bfs.addSource(it->second);
   }
-  bfs.start();
-  
+
+  // The LBA states only distinguish the distances in [0; D+1] (D = _graphDistanceLimit):
+  // every view further away behaves exactly like an unreached one (ignored).
+  // So the visit is a bounded relaxation around the new views instead of a
+  // traversal of the whole co-visibility graph, whose cost would keep growing
+  // with the length of the sequence.
+  while(!bfs.emptyQueue())
+  {
+    const lemon::ListGraph::Node node = bfs.processNextNode();
+    if (bfs.dist(node) > static_cast<int>(_graphDistanceLimit) + 1)
+      break;
+  }
+
   // -- Handle bfs results (distances)
   for(const auto& x : _mapNodePerViewId) // each node in the graph
   {
     auto& node = x.second;
-    int d = -1; 
-    
+    int d = -1;
+
     if (bfs.reached(node))
     {
       d = bfs.dist(node);
       // dist(): "If node v is not reached from the root(s), then the return value of this function is undefined."
       // This is why the distance is previously set to -1.
+
+      // nodes discovered beyond the bounded depth behave like unreached ones
+      if (d > static_cast<int>(_graphDistanceLimit) + 1)
+        d = -1;
     }
     _mapDistancePerViewId[x.first] = d;
   }
@@ -434,27 +449,24 @@ std::map<Pair, std::size_t> LocalBundleAdjustmentData::countSharedLandmarksPerIm
     const std::set<IndexT>& newViewsId)
 {
   std::map<Pair, std::size_t> map_imagesPair_nbSharedLandmarks;
-  
-  // Get landmarks id. of all the reconstructed 3D points (: landmarks)
-  // TODO: avoid copy and use boost::transform_iterator
-  std::set<IndexT> landmarkIds;
-  std::transform(sfm_data.GetLandmarks().begin(), sfm_data.GetLandmarks().end(),
-                 std::inserter(landmarkIds, landmarkIds.begin()),
-                 stl::RetrieveKey());
-  
+
+  // Flag the reconstructed 3D points (landmarkId == trackId) in a bitset,
+  // so each new view intersects its track ids against flat bits instead of
+  // a tree of all the landmark ids.
+  track::TrackIdBitset reconstructedLandmarks;
+  for(const auto& landmarkIt : sfm_data.GetLandmarks())
+    reconstructedLandmarks.insert(landmarkIt.first);
+
+  std::vector<std::size_t> newView_landmarks; // all landmarks (already reconstructed) visible from the new view
+
   for(const auto& viewId: newViewsId)
   {
     // Get all the tracks of the new added view
     const aliceVision::track::TrackIdSet& newView_trackIds = map_tracksPerView.at(viewId);
-    
+
     // Keep the reconstructed tracks (with an associated landmark)
-    std::vector<IndexT> newView_landmarks; // all landmarks (already reconstructed) visible from the new view
-    
-    newView_landmarks.reserve(newView_trackIds.size());
-    std::set_intersection(newView_trackIds.begin(), newView_trackIds.end(),
-                          landmarkIds.begin(), landmarkIds.end(),
-                          std::back_inserter(newView_landmarks));
-    
+    reconstructedLandmarks.intersect(newView_trackIds, newView_landmarks);
+
     // Retrieve the common track Ids
     for(const auto& landmarkId: newView_landmarks)
     {
@@ -107,7 +107,9 @@ public:
   
   /// @brief Compute the intragraph-distance between all the nodes of the graph (posed views) and the newly resected
   /// views.
-  /// @details The graph-distances are computed using a Breadth-first Search (BFS) method.
+  /// @details The graph-distances are computed using a Breadth-first Search (BFS) method,
+  /// bounded to the distance limit + 1: farther views behave like unreached ones (distance -1),
+  /// so the visit stays local to the newly resected views whatever the size of the graph.
   /// @param[in] sfm_data contains all the information about the reconstruction, notably the posed views
   /// @param[in] newReconstructedViews The list of the newly resected views used (used as source in the BFS algorithm)
   void computeGraphDistances(const SfMData& sfm_data, const std::set<IndexT> &newReconstructedViews);
@@ -7,6 +7,7 @@
 
 #include "aliceVision/camera/camera.hpp"
 #include "ceres/rotation.h"
+#include "ceres/sized_cost_function.h"
 
 // Define ceres Cost_functor for each AliceVision camera model
 
@@ -957,5 +958,476 @@ struct ResidualErrorFunctor_PinholeFisheye1
 };
 
 
+//--
+// Analytic cost functions
+//
+// Same residuals as the autodiff functors above, but with hand-derived
+// Jacobians: the Jet arithmetic of autodiff evaluates the whole projection
+// chain once per derivative direction, while the closed forms below share all
+// the intermediate terms. They are selectable through
+// BundleAdjustmentCeres::BA_options (the models without an analytic version
+// keep using autodiff).
+//--
+
+/**
+ * @brief Jacobian of R(angleAxis) * pt with respect to the angle axis parameters.
+ *
+ * Uses the compact formula of Gallego & Yezzi, "A compact formula for the
+ * derivative of a 3-D rotation in exponential coordinates", eq. (8).
+ *
+ * @param[in] angleAxis the 3 angle axis parameters
+ * @param[in] R the rotation matrix corresponding to angleAxis
+ * @param[in] rotatedPt the already rotated point R * pt
+ * @param[out] J the 3x3 Jacobian d(R * pt) / d(angleAxis)
+ */
+inline void angleAxisRotatePointJacobian(const double* const angleAxis,
+                                         const Mat3& R,
+                                         const Vec3& rotatedPt,
+                                         Mat3* J)
+{
+  const Eigen::Map<const Vec3> w(angleAxis);
+  const double theta2 = w.squaredNorm();
+  for(int i = 0; i < 3; ++i)
+  {
+    Vec3 ei = Vec3::Zero();
+    ei(i) = 1.0;
+    if(theta2 > 1e-14)
+    {
+      ei = (w(i) * w + w.cross(ei - R.col(i))) / theta2;
+    }
+    // near zero the formula degenerates, d(R * pt) / d(angleAxis) -> -[pt]x
+    J->col(i) = ei.cross(rotatedPt);
+  }
+}
+
+/**
+ * @brief Jacobian of the residual with respect to the point in the camera frame:
+ * perspective division chained with the distortion Jacobian and the focal length.
+ *
+ * @param[in] pos_proj the point in the camera frame
+ * @param[in] x_u, y_u the undistorted normalized coordinates pos_proj.hnormalized()
+ * @param[in] focal the focal length
+ * @param[in] Jd the 2x2 Jacobian of the distortion at (x_u, y_u)
+ * @return the 2x3 Jacobian d(residual) / d(pos_proj)
+ */
+inline Eigen::Matrix<double, 2, 3> residualCameraFrameJacobian(const Vec3& pos_proj,
+                                                               const double x_u,
+                                                               const double y_u,
+                                                               const double focal,
+                                                               const Eigen::Matrix<double, 2, 2>& Jd)
+{
+  const double iz = 1.0 / pos_proj(2);
+  Eigen::Matrix<double, 2, 3> Jh;
+  Jh << iz, 0.0, -x_u * iz,
+        0.0, iz, -y_u * iz;
+  return focal * Jd * Jh;
+}
+
+/**
+ * @brief Analytic version of ResidualErrorFunctor_Pinhole (single camera only).
+ *
+ *  Data parameter blocks are the following <2,3,6,3>
+ *  - 2 => dimension of the residuals,
+ *  - 3 => the intrinsic data block [focal, principal point x, principal point y],
+ *  - 6 => the camera extrinsic data block [R;t],
+ *  - 3 => a 3D point data block.
+ */
+class AnalyticCostFunction_Pinhole : public ceres::SizedCostFunction<2, 3, 6, 3>
+{
+public:
+  explicit AnalyticCostFunction_Pinhole(const double* const pos_2dpoint)
+  {
+    m_pos_2dpoint[0] = pos_2dpoint[0];
+    m_pos_2dpoint[1] = pos_2dpoint[1];
+  }
+
+  enum {
+    OFFSET_FOCAL_LENGTH = 0,
+    OFFSET_PRINCIPAL_POINT_X = 1,
+    OFFSET_PRINCIPAL_POINT_Y = 2
+  };
+
+  bool Evaluate(double const* const* parameters,
+                double* residuals,
+                double** jacobians) const override
+  {
+    const double* cam_K = parameters[0];
+    const double* cam_Rt = parameters[1];
+
+    const double& focal = cam_K[OFFSET_FOCAL_LENGTH];
+
+    // Apply external parameters (Pose)
+    Mat3 R;
+    ceres::AngleAxisToRotationMatrix(cam_Rt, R.data());
+    const Eigen::Map<const Vec3> t(&cam_Rt[3]);
+    const Eigen::Map<const Vec3> pos_3dpoint(parameters[2]);
+    const Vec3 pos_proj = R * pos_3dpoint + t;
+
+    // Transform the point from homogeneous to euclidean (undistorted point)
+    const double x_u = pos_proj(0) / pos_proj(2);
+    const double y_u = pos_proj(1) / pos_proj(2);
+
+    residuals[0] = cam_K[OFFSET_PRINCIPAL_POINT_X] + focal * x_u - m_pos_2dpoint[0];
+    residuals[1] = cam_K[OFFSET_PRINCIPAL_POINT_Y] + focal * y_u - m_pos_2dpoint[1];
+
+    if(jacobians == nullptr)
+      return true;
+
+    const Eigen::Matrix<double, 2, 3> Jp =
+      residualCameraFrameJacobian(pos_proj, x_u, y_u, focal, Eigen::Matrix<double, 2, 2>::Identity());
+
+    if(jacobians[0] != nullptr) // intrinsics
+    {
+      Eigen::Map<Eigen::Matrix<double, 2, 3, Eigen::RowMajor> > J(jacobians[0]);
+      J.setZero();
+      J(0, OFFSET_FOCAL_LENGTH) = x_u;
+      J(1, OFFSET_FOCAL_LENGTH) = y_u;
+      J(0, OFFSET_PRINCIPAL_POINT_X) = 1.0;
+      J(1, OFFSET_PRINCIPAL_POINT_Y) = 1.0;
+    }
+    if(jacobians[1] != nullptr) // pose
+    {
+      Eigen::Map<Eigen::Matrix<double, 2, 6, Eigen::RowMajor> > J(jacobians[1]);
+      Mat3 JRot;
+      angleAxisRotatePointJacobian(cam_Rt, R, pos_proj - t, &JRot);
+      J.leftCols<3>() = Jp * JRot;
+      J.rightCols<3>() = Jp;
+    }
+    if(jacobians[2] != nullptr) // 3D point
+    {
+      Eigen::Map<Eigen::Matrix<double, 2, 3, Eigen::RowMajor> > J(jacobians[2]);
+      J = Jp * R;
+    }
+    return true;
+  }
+
+  double m_pos_2dpoint[2]; // The 2D observation
+};
+
+/**
+ * @brief Analytic version of ResidualErrorFunctor_PinholeRadialK1 (single camera only).
+ *
+ *  Data parameter blocks are the following <2,4,6,3>
+ *  - 2 => dimension of the residuals,
+ *  - 4 => the intrinsic data block [focal, principal point x, principal point y, K1],
+ *  - 6 => the camera extrinsic data block [R;t],
+ *  - 3 => a 3D point data block.
+ */
+class AnalyticCostFunction_PinholeRadialK1 : public ceres::SizedCostFunction<2, 4, 6, 3>
+{
+public:
+  explicit AnalyticCostFunction_PinholeRadialK1(const double* const pos_2dpoint)
+  {
+    m_pos_2dpoint[0] = pos_2dpoint[0];
+    m_pos_2dpoint[1] = pos_2dpoint[1];
+  }
+
+  enum {
+    OFFSET_FOCAL_LENGTH = 0,
+    OFFSET_PRINCIPAL_POINT_X = 1,
+    OFFSET_PRINCIPAL_POINT_Y = 2,
+    OFFSET_DISTO_K1 = 3
+  };
+
+  bool Evaluate(double const* const* parameters,
+                double* residuals,
+                double** jacobians) const override
+  {
+    const double* cam_K = parameters[0];
+    const double* cam_Rt = parameters[1];
+
+    const double& focal = cam_K[OFFSET_FOCAL_LENGTH];
+    const double& k1 = cam_K[OFFSET_DISTO_K1];
+
+    // Apply external parameters (Pose)
+    Mat3 R;
+    ceres::AngleAxisToRotationMatrix(cam_Rt, R.data());
+    const Eigen::Map<const Vec3> t(&cam_Rt[3]);
+    const Eigen::Map<const Vec3> pos_3dpoint(parameters[2]);
+    const Vec3 pos_proj = R * pos_3dpoint + t;
+
+    // Transform the point from homogeneous to euclidean (undistorted point)
+    const double x_u = pos_proj(0) / pos_proj(2);
+    const double y_u = pos_proj(1) / pos_proj(2);
+
+    // Apply distortion (xd,yd) = disto(x_u,y_u)
+    const double r2 = x_u * x_u + y_u * y_u;
+    const double r_coeff = 1.0 + k1 * r2;
+    const double x_d = x_u * r_coeff;
+    const double y_d = y_u * r_coeff;
+
+    residuals[0] = cam_K[OFFSET_PRINCIPAL_POINT_X] + focal * x_d - m_pos_2dpoint[0];
+    residuals[1] = cam_K[OFFSET_PRINCIPAL_POINT_Y] + focal * y_d - m_pos_2dpoint[1];
+
+    if(jacobians == nullptr)
+      return true;
+
+    // Jacobian of the distortion, with d(r_coeff)/d(r2) = k1
+    Eigen::Matrix<double, 2, 2> Jd;
+    Jd(0, 0) = r_coeff + 2.0 * x_u * x_u * k1;
+    Jd(0, 1) = 2.0 * x_u * y_u * k1;
+    Jd(1, 0) = Jd(0, 1);
+    Jd(1, 1) = r_coeff + 2.0 * y_u * y_u * k1;
+
+    const Eigen::Matrix<double, 2, 3> Jp = residualCameraFrameJacobian(pos_proj, x_u, y_u, focal, Jd);
+
+    if(jacobians[0] != nullptr) // intrinsics
+    {
+      Eigen::Map<Eigen::Matrix<double, 2, 4, Eigen::RowMajor> > J(jacobians[0]);
+      J.setZero();
+      J(0, OFFSET_FOCAL_LENGTH) = x_d;
+      J(1, OFFSET_FOCAL_LENGTH) = y_d;
+      J(0, OFFSET_PRINCIPAL_POINT_X) = 1.0;
+      J(1, OFFSET_PRINCIPAL_POINT_Y) = 1.0;
+      J(0, OFFSET_DISTO_K1) = focal * x_u * r2;
+      J(1, OFFSET_DISTO_K1) = focal * y_u * r2;
+    }
+    if(jacobians[1] != nullptr) // pose
+    {
+      Eigen::Map<Eigen::Matrix<double, 2, 6, Eigen::RowMajor> > J(jacobians[1]);
+      Mat3 JRot;
+      angleAxisRotatePointJacobian(cam_Rt, R, pos_proj - t, &JRot);
+      J.leftCols<3>() = Jp * JRot;
+      J.rightCols<3>() = Jp;
+    }
+    if(jacobians[2] != nullptr) // 3D point
+    {
+      Eigen::Map<Eigen::Matrix<double, 2, 3, Eigen::RowMajor> > J(jacobians[2]);
+      J = Jp * R;
+    }
+    return true;
+  }
+
+  double m_pos_2dpoint[2]; // The 2D observation
+};
+
+/**
+ * @brief Analytic version of ResidualErrorFunctor_PinholeRadialK3 (single camera only).
+ *
+ *  Data parameter blocks are the following <2,6,6,3>
+ *  - 2 => dimension of the residuals,
+ *  - 6 => the intrinsic data block [focal, principal point x, principal point y, K1, K2, K3],
+ *  - 6 => the camera extrinsic data block [R;t],
+ *  - 3 => a 3D point data block.
+ */
+class AnalyticCostFunction_PinholeRadialK3 : public ceres::SizedCostFunction<2, 6, 6, 3>
+{
+public:
+  explicit AnalyticCostFunction_PinholeRadialK3(const double* const pos_2dpoint)
+  {
+    m_pos_2dpoint[0] = pos_2dpoint[0];
+    m_pos_2dpoint[1] = pos_2dpoint[1];
+  }
+
+  enum {
+    OFFSET_FOCAL_LENGTH = 0,
+    OFFSET_PRINCIPAL_POINT_X = 1,
+    OFFSET_PRINCIPAL_POINT_Y = 2,
+    OFFSET_DISTO_K1 = 3,
+    OFFSET_DISTO_K2 = 4,
+    OFFSET_DISTO_K3 = 5,
+  };
+
+  bool Evaluate(double const* const* parameters,
+                double* residuals,
+                double** jacobians) const override
+  {
+    const double* cam_K = parameters[0];
+    const double* cam_Rt = parameters[1];
+
+    const double& focal = cam_K[OFFSET_FOCAL_LENGTH];
+    const double& k1 = cam_K[OFFSET_DISTO_K1];
+    const double& k2 = cam_K[OFFSET_DISTO_K2];
+    const double& k3 = cam_K[OFFSET_DISTO_K3];
+
+    // Apply external parameters (Pose)
+    Mat3 R;
+    ceres::AngleAxisToRotationMatrix(cam_Rt, R.data());
+    const Eigen::Map<const Vec3> t(&cam_Rt[3]);
+    const Eigen::Map<const Vec3> pos_3dpoint(parameters[2]);
+    const Vec3 pos_proj = R * pos_3dpoint + t;
+
+    // Transform the point from homogeneous to euclidean (undistorted point)
+    const double x_u = pos_proj(0) / pos_proj(2);
+    const double y_u = pos_proj(1) / pos_proj(2);
+
+    // Apply distortion (xd,yd) = disto(x_u,y_u)
+    const double r2 = x_u * x_u + y_u * y_u;
+    const double r4 = r2 * r2;
+    const double r6 = r4 * r2;
+    const double r_coeff = 1.0 + k1 * r2 + k2 * r4 + k3 * r6;
+    const double x_d = x_u * r_coeff;
+    const double y_d = y_u * r_coeff;
+
+    residuals[0] = cam_K[OFFSET_PRINCIPAL_POINT_X] + focal * x_d - m_pos_2dpoint[0];
+    residuals[1] = cam_K[OFFSET_PRINCIPAL_POINT_Y] + focal * y_d - m_pos_2dpoint[1];
+
+    if(jacobians == nullptr)
+      return true;
+
+    // Jacobian of the distortion, with d(r_coeff)/d(r2)
+    const double d_coeff = k1 + 2.0 * k2 * r2 + 3.0 * k3 * r4;
+    Eigen::Matrix<double, 2, 2> Jd;
+    Jd(0, 0) = r_coeff + 2.0 * x_u * x_u * d_coeff;
+    Jd(0, 1) = 2.0 * x_u * y_u * d_coeff;
+    Jd(1, 0) = Jd(0, 1);
+    Jd(1, 1) = r_coeff + 2.0 * y_u * y_u * d_coeff;
+
+    const Eigen::Matrix<double, 2, 3> Jp = residualCameraFrameJacobian(pos_proj, x_u, y_u, focal, Jd);
+
+    if(jacobians[0] != nullptr) // intrinsics
+    {
+      Eigen::Map<Eigen::Matrix<double, 2, 6, Eigen::RowMajor> > J(jacobians[0]);
+      J.setZero();
+      J(0, OFFSET_FOCAL_LENGTH) = x_d;
+      J(1, OFFSET_FOCAL_LENGTH) = y_d;
+      J(0, OFFSET_PRINCIPAL_POINT_X) = 1.0;
+      J(1, OFFSET_PRINCIPAL_POINT_Y) = 1.0;
+      J(0, OFFSET_DISTO_K1) = focal * x_u * r2;
+      J(1, OFFSET_DISTO_K1) = focal * y_u * r2;
+      J(0, OFFSET_DISTO_K2) = focal * x_u * r4;
+      J(1, OFFSET_DISTO_K2) = focal * y_u * r4;
+      J(0, OFFSET_DISTO_K3) = focal * x_u * r6;
+      J(1, OFFSET_DISTO_K3) = focal * y_u * r6;
+    }
+    if(jacobians[1] != nullptr) // pose
+    {
+      Eigen::Map<Eigen::Matrix<double, 2, 6, Eigen::RowMajor> > J(jacobians[1]);
+      Mat3 JRot;
+      angleAxisRotatePointJacobian(cam_Rt, R, pos_proj - t, &JRot);
+      J.leftCols<3>() = Jp * JRot;
+      J.rightCols<3>() = Jp;
+    }
+    if(jacobians[2] != nullptr) // 3D point
+    {
+      Eigen::Map<Eigen::Matrix<double, 2, 3, Eigen::RowMajor> > J(jacobians[2]);
+      J = Jp * R;
+    }
+    return true;
+  }
+
+  double m_pos_2dpoint[2]; // The 2D observation
+};
+
+/**
+ * @brief Analytic version of ResidualErrorFunctor_PinholeBrownT2 (single camera only).
+ *
+ *  Data parameter blocks are the following <2,8,6,3>
+ *  - 2 => dimension of the residuals,
+ *  - 8 => the intrinsic data block [focal, principal point x, principal point y, K1, K2, K3, T1, T2],
+ *  - 6 => the camera extrinsic data block [R;t],
+ *  - 3 => a 3D point data block.
+ */
+class AnalyticCostFunction_PinholeBrownT2 : public ceres::SizedCostFunction<2, 8, 6, 3>
+{
+public:
+  explicit AnalyticCostFunction_PinholeBrownT2(const double* const pos_2dpoint)
+  {
+    m_pos_2dpoint[0] = pos_2dpoint[0];
+    m_pos_2dpoint[1] = pos_2dpoint[1];
+  }
+
+  enum {
+    OFFSET_FOCAL_LENGTH = 0,
+    OFFSET_PRINCIPAL_POINT_X = 1,
+    OFFSET_PRINCIPAL_POINT_Y = 2,
+    OFFSET_DISTO_K1 = 3,
+    OFFSET_DISTO_K2 = 4,
+    OFFSET_DISTO_K3 = 5,
+    OFFSET_DISTO_T1 = 6,
+    OFFSET_DISTO_T2 = 7,
+  };
+
+  bool Evaluate(double const* const* parameters,
+                double* residuals,
+                double** jacobians) const override
+  {
+    const double* cam_K = parameters[0];
+    const double* cam_Rt = parameters[1];
+
+    const double& focal = cam_K[OFFSET_FOCAL_LENGTH];
+    const double& k1 = cam_K[OFFSET_DISTO_K1];
+    const double& k2 = cam_K[OFFSET_DISTO_K2];
+    const double& k3 = cam_K[OFFSET_DISTO_K3];
+    const double& t1 = cam_K[OFFSET_DISTO_T1];
+    const double& t2 = cam_K[OFFSET_DISTO_T2];
+
+    // Apply external parameters (Pose)
+    Mat3 R;
+    ceres::AngleAxisToRotationMatrix(cam_Rt, R.data());
+    const Eigen::Map<const Vec3> t(&cam_Rt[3]);
+    const Eigen::Map<const Vec3> pos_3dpoint(parameters[2]);
+    const Vec3 pos_proj = R * pos_3dpoint + t;
+
+    // Transform the point from homogeneous to euclidean (undistorted point)
+    const double x_u = pos_proj(0) / pos_proj(2);
+    const double y_u = pos_proj(1) / pos_proj(2);
+
+    // Apply distortion (xd,yd) = disto(x_u,y_u)
+    const double r2 = x_u * x_u + y_u * y_u;
+    const double r4 = r2 * r2;
+    const double r6 = r4 * r2;
+    const double r_coeff = 1.0 + k1 * r2 + k2 * r4 + k3 * r6;
+    const double t_x = t2 * (r2 + 2.0 * x_u * x_u) + 2.0 * t1 * x_u * y_u;
+    const double t_y = t1 * (r2 + 2.0 * y_u * y_u) + 2.0 * t2 * x_u * y_u;
+    const double x_d = x_u * r_coeff + t_x;
+    const double y_d = y_u * r_coeff + t_y;
+
+    residuals[0] = cam_K[OFFSET_PRINCIPAL_POINT_X] + focal * x_d - m_pos_2dpoint[0];
+    residuals[1] = cam_K[OFFSET_PRINCIPAL_POINT_Y] + focal * y_d - m_pos_2dpoint[1];
+
+    if(jacobians == nullptr)
+      return true;
+
+    // Jacobian of the distortion: radial part with d(r_coeff)/d(r2), plus the
+    // tangential part
+    const double d_coeff = k1 + 2.0 * k2 * r2 + 3.0 * k3 * r4;
+    Eigen::Matrix<double, 2, 2> Jd;
+    Jd(0, 0) = r_coeff + 2.0 * x_u * x_u * d_coeff + 6.0 * t2 * x_u + 2.0 * t1 * y_u;
+    Jd(0, 1) = 2.0 * x_u * y_u * d_coeff + 2.0 * t2 * y_u + 2.0 * t1 * x_u;
+    Jd(1, 0) = 2.0 * x_u * y_u * d_coeff + 2.0 * t1 * x_u + 2.0 * t2 * y_u;
+    Jd(1, 1) = r_coeff + 2.0 * y_u * y_u * d_coeff + 6.0 * t1 * y_u + 2.0 * t2 * x_u;
+
+    const Eigen::Matrix<double, 2, 3> Jp = residualCameraFrameJacobian(pos_proj, x_u, y_u, focal, Jd);
+
+    if(jacobians[0] != nullptr) // intrinsics
+    {
+      Eigen::Map<Eigen::Matrix<double, 2, 8, Eigen::RowMajor> > J(jacobians[0]);
+      J.setZero();
+      J(0, OFFSET_FOCAL_LENGTH) = x_d;
+      J(1, OFFSET_FOCAL_LENGTH) = y_d;
+      J(0, OFFSET_PRINCIPAL_POINT_X) = 1.0;
+      J(1, OFFSET_PRINCIPAL_POINT_Y) = 1.0;
+      J(0, OFFSET_DISTO_K1) = focal * x_u * r2;
+      J(1, OFFSET_DISTO_K1) = focal * y_u * r2;
+      J(0, OFFSET_DISTO_K2) = focal * x_u * r4;
+      J(1, OFFSET_DISTO_K2) = focal * y_u * r4;
+      J(0, OFFSET_DISTO_K3) = focal * x_u * r6;
+      J(1, OFFSET_DISTO_K3) = focal * y_u * r6;
+      J(0, OFFSET_DISTO_T1) = focal * 2.0 * x_u * y_u;
+      J(1, OFFSET_DISTO_T1) = focal * (r2 + 2.0 * y_u * y_u);
+      J(0, OFFSET_DISTO_T2) = focal * (r2 + 2.0 * x_u * x_u);
+      J(1, OFFSET_DISTO_T2) = focal * 2.0 * x_u * y_u;
+    }
+    if(jacobians[1] != nullptr) // pose
+    {
+      Eigen::Map<Eigen::Matrix<double, 2, 6, Eigen::RowMajor> > J(jacobians[1]);
+      Mat3 JRot;
+      angleAxisRotatePointJacobian(cam_Rt, R, pos_proj - t, &JRot);
+      J.leftCols<3>() = Jp * JRot;
+      J.rightCols<3>() = Jp;
+    }
+    if(jacobians[2] != nullptr) // 3D point
+    {
+      Eigen::Map<Eigen::Matrix<double, 2, 3, Eigen::RowMajor> > J(jacobians[2]);
+      J = Jp * R;
+    }
+    return true;
+  }
+
+  double m_pos_2dpoint[2]; // The 2D observation
+};
+
+
 } // namespace sfm
 } // namespace aliceVision
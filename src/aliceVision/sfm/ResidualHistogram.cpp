@@ -0,0 +1,98 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "ResidualHistogram.hpp"
+
+#include <aliceVision/sfm/SfMData.hpp>
+
+#include <algorithm>
+#include <cassert>
+
+namespace aliceVision {
+namespace sfm {
+
+const std::size_t ResidualHistogram::NB_BINS;
+
+ResidualHistogram::ResidualHistogram(const double maxResidual)
+  : _bins(NB_BINS + 1, 0)
+  , _binWidth(maxResidual / NB_BINS)
+  , _count(0)
+{
+  assert(maxResidual > 0.0);
+}
+
+void ResidualHistogram::clear()
+{
+  std::fill(_bins.begin(), _bins.end(), 0);
+  _count = 0;
+}
+
+void ResidualHistogram::add(const double residualNorm)
+{
+  const std::size_t bin = std::min(static_cast<std::size_t>(residualNorm / _binWidth), NB_BINS);
+  ++_bins[bin];
+  ++_count;
+}
+
+void ResidualHistogram::remove(const double residualNorm)
+{
+  const std::size_t bin = std::min(static_cast<std::size_t>(residualNorm / _binWidth), NB_BINS);
+  assert(_bins[bin] > 0);
+  --_bins[bin];
+  --_count;
+}
+
+void ResidualHistogram::rebuild(const SfMData& sfm_data)
+{
+  clear();
+  for (const auto& landmarkIt : sfm_data.structure)
+  {
+    const Landmark& landmark = landmarkIt.second;
+    for (const auto& observationIt : landmark.observations)
+    {
+      const View* view = sfm_data.views.at(observationIt.first).get();
+      const geometry::Pose3 pose = sfm_data.getPose(*view);
+      const camera::IntrinsicBase* intrinsic = sfm_data.intrinsics.at(view->getIntrinsicId()).get();
+      add(intrinsic->residual(pose, landmark.X, observationIt.second.x).norm());
+    }
+  }
+}
+
+double ResidualHistogram::mean() const
+{
+  if (_count == 0)
+    return 0.0;
+
+  double sum = 0.0;
+  for (std::size_t bin = 0; bin <= NB_BINS; ++bin)
+    sum += _bins[bin] * (bin + 0.5) * _binWidth;
+  return sum / _count;
+}
+
+double ResidualHistogram::percentile(const double p) const
+{
+  assert(p > 0.0 && p <= 1.0);
+  if (_count == 0)
+    return 0.0;
+
+  const double target = p * _count;
+  double cumulated = 0.0;
+  for (std::size_t bin = 0; bin <= NB_BINS; ++bin)
+  {
+    if (cumulated + _bins[bin] >= target)
+    {
+      // interpolate inside the bin; the overflow bin has no upper bound,
+      // report its lower one
+      if (bin == NB_BINS || _bins[bin] == 0)
+        return bin * _binWidth;
+      return (bin + (target - cumulated) / _bins[bin]) * _binWidth;
+    }
+    cumulated += _bins[bin];
+  }
+  return (NB_BINS + 1) * _binWidth;
+}
+
+} // namespace sfm
+} // namespace aliceVision
@@ -0,0 +1,77 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace aliceVision {
+namespace sfm {
+
+class SfMData;
+
+/**
+ * @brief Incrementally maintained histogram of the reprojection residual norms.
+ *
+ * The scene statistics used by the outlier filters and the reports do not need
+ * exact order statistics: a fixed-bin histogram supports add/remove updates in
+ * constant time and percentile queries in constant time (one walk over the
+ * fixed bin array), instead of re-scanning every observation of the scene.
+ * Residuals beyond the value range accumulate in the last bin.
+ */
+class ResidualHistogram
+{
+public:
+
+  /**
+   * @param[in] maxResidual upper bound of the binned range, in pixels;
+   *            larger residuals are counted in the overflow bin
+   */
+  explicit ResidualHistogram(const double maxResidual = 64.0);
+
+  /// Remove all the recorded residuals
+  void clear();
+
+  /// Record one residual norm
+  void add(const double residualNorm);
+
+  /// Forget one previously recorded residual norm
+  void remove(const double residualNorm);
+
+  /// Rebuild the histogram from a full scan of the scene observations
+  void rebuild(const SfMData& sfm_data);
+
+  std::size_t size() const { return _count; }
+  bool empty() const { return _count == 0; }
+
+  /// Mean of the recorded residual norms (bin-centre approximation)
+  double mean() const;
+
+  /**
+   * @brief Approximate percentile of the recorded residual norms.
+   * @param[in] p the requested fraction, in ]0, 1]
+   * @return the residual value below which the fraction p of the
+   *         recorded residuals lies (linear interpolation inside the bin)
+   */
+  double percentile(const double p) const;
+
+  const std::vector<std::size_t>& bins() const { return _bins; }
+  double binWidth() const { return _binWidth; }
+
+private:
+
+  /// number of regular bins; one more bin holds the overflow
+  static const std::size_t NB_BINS = 256;
+
+  std::vector<std::size_t> _bins;
+  double _binWidth;
+  std::size_t _count;
+};
+
+} // namespace sfm
+} // namespace aliceVision
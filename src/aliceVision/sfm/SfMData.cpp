@@ -208,110 +208,71 @@ void SfMData::combine(const SfMData& sfmData)
 /// Find the color of the SfMData Landmarks/structure
 bool ColorizeTracks( SfMData & sfm_data )
 {
-  // Colorize each track
-  //  Start with the most representative image
-  //    and iterate to provide a color to each 3D point
-
-  std::vector<Vec3> vec_3dPoints;
-  std::vector<Vec3> vec_tracksColor;
-
-  boost::progress_display my_progress_bar(sfm_data.GetLandmarks().size(),
-                                     std::cout,
-                                     "\nCompute scene structure color\n");
-
-  vec_3dPoints.resize(sfm_data.GetLandmarks().size());
-
-  //Build a list of contiguous index for the trackIds
-  std::map<IndexT, IndexT> trackIds_to_contiguousIndexes;
-  IndexT cpt = 0;
-  for (Landmarks::const_iterator it = sfm_data.GetLandmarks().begin();
-    it != sfm_data.GetLandmarks().end(); ++it, ++cpt)
+  // Colorize each track from its most representative image:
+  // each landmark is sampled in the observed view that covers the most
+  // landmarks overall, so that the popular images color big batches and every
+  // image is decoded at most once.
+
+  // Count the observations per view
+  HashMap<IndexT, IndexT> cardinalPerView; // ViewId, Cardinal
+  for (const auto& landmarkIt : sfm_data.GetLandmarks())
   {
-    trackIds_to_contiguousIndexes[it->first] = cpt;
-    vec_3dPoints[cpt] = it->second.X;
+    for (const auto& observationIt : landmarkIt.second.observations)
+      ++cardinalPerView[observationIt.first];
   }
 
-  // The track list that will be colored (point removed during the process)
-  std::set<IndexT> remainingTrackToColor;
-  std::transform(sfm_data.GetLandmarks().begin(), sfm_data.GetLandmarks().end(),
-    std::inserter(remainingTrackToColor, remainingTrackToColor.begin()),
-    stl::RetrieveKey());
-  
-  while( !remainingTrackToColor.empty() )
+  // Group the landmarks by their best observed view
+  HashMap<IndexT, std::vector<std::pair<IndexT, Vec2>>> tracksPerView; // ViewId, (trackId, feature position)
+  for (const auto& landmarkIt : sfm_data.GetLandmarks())
   {
-    // Find the most representative image (for the remaining 3D points)
-    //  a. Count the number of observation per view for each 3Dpoint Index
-    //  b. Sort to find the most representative view index
-
-    std::map<IndexT, IndexT> map_IndexCardinal; // ViewId, Cardinal
-    for (std::set<IndexT>::const_iterator
-      iterT = remainingTrackToColor.begin();
-      iterT != remainingTrackToColor.end();
-      ++iterT)
+    IndexT bestViewId = UndefinedIndexT;
+    IndexT bestCardinal = 0;
+    for (const auto& observationIt : landmarkIt.second.observations)
     {
-      const size_t trackId = *iterT;
-      const Observations & observations = sfm_data.GetLandmarks().at(trackId).observations;
-      for( Observations::const_iterator iterObs = observations.begin();
-        iterObs != observations.end(); ++iterObs)
+      const IndexT cardinal = cardinalPerView.at(observationIt.first);
+      if (bestViewId == UndefinedIndexT || cardinal > bestCardinal)
       {
-        const size_t viewId = iterObs->first;
-        if (map_IndexCardinal.find(viewId) == map_IndexCardinal.end())
-          map_IndexCardinal[viewId] = 1;
-        else
-          ++map_IndexCardinal[viewId];
+        bestViewId = observationIt.first;
+        bestCardinal = cardinal;
       }
     }
+    if (bestViewId != UndefinedIndexT)
+      tracksPerView[bestViewId].emplace_back(landmarkIt.first, landmarkIt.second.observations.at(bestViewId).x);
+  }
 
-    // Find the View index that is the most represented
-    std::vector<IndexT> vec_cardinal;
-    std::transform(map_IndexCardinal.begin(),
-      map_IndexCardinal.end(),
-      std::back_inserter(vec_cardinal),
-      stl::RetrieveValue());
-    using namespace stl::indexed_sort;
-    std::vector< sort_index_packet_descend< IndexT, IndexT> > packet_vec(vec_cardinal.size());
-    sort_index_helper(packet_vec, &vec_cardinal[0], 1);
-
-    // First image index with the most of occurrence
-    std::map<IndexT, IndexT>::const_iterator iterTT = map_IndexCardinal.begin();
-    std::advance(iterTT, packet_vec[0].index);
-    const size_t view_index = iterTT->first;
-    const View * view = sfm_data.GetViews().at(view_index).get();
-    const std::string sView_filename = view->getImagePath();
-    Image<RGBColor> image;
+  boost::progress_display my_progress_bar(tracksPerView.size(),
+                                     std::cout,
+                                     "\nCompute scene structure color\n");
 
-    readImage(sView_filename, image);
+  // index the view groups so they can be distributed across threads
+  std::vector<const std::pair<const IndexT, std::vector<std::pair<IndexT, Vec2>>>*> viewGroups;
+  viewGroups.reserve(tracksPerView.size());
+  for (const auto& tracksIt : tracksPerView)
+    viewGroups.push_back(&tracksIt);
 
-    // Iterate through the remaining track to color
-    // - look if the current view is present to color the track
-    std::set<IndexT> set_toRemove;
-    for (std::set<IndexT>::const_iterator
-      iterT = remainingTrackToColor.begin();
-      iterT != remainingTrackToColor.end();
-      ++iterT)
-    {
-      const size_t trackId = *iterT;
-      const Observations & observations = sfm_data.GetLandmarks().at(trackId).observations;
-      Observations::const_iterator it = observations.find(view_index);
+  // The groups are disjoint (every landmark belongs to exactly one view),
+  // so each thread decodes its image once and writes its own landmark colors.
+#pragma omp parallel for schedule(dynamic)
+  for (std::size_t g = 0; g < viewGroups.size(); ++g)
+  {
+    const IndexT viewId = viewGroups[g]->first;
+    const View * view = sfm_data.GetViews().at(viewId).get();
+    Image<RGBColor> image;
 
-      if (it != observations.end())
-      {
-        // Color the track
-        Vec2 pt = it->second.x;
-        // Clamp the pixel position if the feature/marker center is outside the image.
-        pt.x() = clamp(pt.x(), 0.0, double(image.Width()-1));
-        pt.y() = clamp(pt.y(), 0.0, double(image.Height()-1));
-        sfm_data.structure.at(trackId).rgb = image(pt.y(), pt.x());
-        set_toRemove.insert(trackId);
-        ++my_progress_bar;
-      }
-    }
-    // Remove colored track
-    for (std::set<IndexT>::const_iterator iter = set_toRemove.begin();
-      iter != set_toRemove.end(); ++iter)
+    readImage(view->getImagePath(), image);
+
+    for (const auto& trackIt : viewGroups[g]->second)
     {
-      remainingTrackToColor.erase(*iter);
+      // Color the track
+      Vec2 pt = trackIt.second;
+      // Clamp the pixel position if the feature/marker center is outside the image.
+      pt.x() = clamp(pt.x(), 0.0, double(image.Width()-1));
+      pt.y() = clamp(pt.y(), 0.0, double(image.Height()-1));
+      sfm_data.structure.at(trackIt.first).rgb = image(pt.y(), pt.x());
     }
+
+#pragma omp critical
+    ++my_progress_bar;
   }
   return true;
 }
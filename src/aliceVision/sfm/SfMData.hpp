@@ -33,6 +33,8 @@ using Landmarks = HashMap<IndexT, Landmark>;
 /// Define a collection of Rig
 using Rigs = std::map<IndexT, Rig>;
 
+class ValidViewsRange;
+
 /// Generic SfM data container
 /// Store structure and camera properties:
 class SfMData
@@ -84,6 +86,29 @@ public:
    */
   std::set<IndexT> getReconstructedIntrinsics() const;
 
+  /**
+   * @brief Non-owning range over the views that have valid camera intrinsic
+   * and pose, iterated in place. Unlike getValidViews it does not build an
+   * index set nor copy any shared_ptr, so prefer it for read-only traversals.
+   * @return range of (viewId, view) entries
+   */
+  ValidViewsRange validViews() const;
+
+  /**
+   * @brief Non-owning range over the valid views sharing the given intrinsic,
+   * iterated in place without allocation.
+   * @param[in] intrinsicId The intrinsic index of the group
+   * @return range of (viewId, view) entries
+   */
+  ValidViewsRange viewsWithIntrinsic(IndexT intrinsicId) const;
+
+  /**
+   * @brief Count the views that have valid camera intrinsic and pose, without
+   * materializing the index set built by getValidViews.
+   * @return number of valid views
+   */
+  std::size_t nbValidViews() const;
+
   /**
    * @brief Return a pointer to an intrinsic if available or nullptr otherwise.
    * @param[in] intrinsicId
@@ -281,6 +306,86 @@ public:
    */
   void combine(const SfMData& sfmData);
 
+  /**
+   * @brief Erase from the given landmark every observation matched by the
+   * predicate, compacting the observation map in a single pass: the kept
+   * entries are rebuilt in order and swapped in, instead of shifting the
+   * flat_map storage once per erased entry.
+   * The predicate is called once per observation as predicate(viewId, observation).
+   * @param[in,out] landmark The landmark to filter
+   * @param[in] predicate Returns true for the observations to erase
+   * @return number of erased observations
+   */
+  template <class Predicate>
+  static std::size_t eraseObservationsIf(Landmark& landmark, Predicate predicate)
+  {
+    Observations& observations = landmark.observations;
+
+    // landmarks with no rejected observation keep their storage untouched
+    Observations::const_iterator itObs = observations.begin();
+    for (; itObs != observations.end(); ++itObs)
+    {
+      if (predicate(itObs->first, itObs->second))
+        break;
+    }
+    if (itObs == observations.end())
+      return 0;
+
+    Observations kept;
+    kept.reserve(observations.size() - 1);
+    for (Observations::const_iterator it = observations.begin(); it != itObs; ++it)
+      kept.emplace_hint(kept.end(), it->first, it->second);
+
+    std::size_t erased = 1;
+    for (++itObs; itObs != observations.end(); ++itObs)
+    {
+      if (predicate(itObs->first, itObs->second))
+        ++erased;
+      else
+        kept.emplace_hint(kept.end(), itObs->first, itObs->second);
+    }
+    observations.swap(kept);
+    return erased;
+  }
+
+  /**
+   * @brief Erase from every landmark of the structure the observations matched
+   * by the predicate, compacting each modified landmark in a single pass.
+   * The predicate is called once per observation as predicate(viewId, observation).
+   * @param[in] predicate Returns true for the observations to erase
+   * @return number of erased observations
+   */
+  template <class Predicate>
+  std::size_t eraseObservationsIf(Predicate predicate)
+  {
+    std::size_t erased = 0;
+    for (Landmarks::iterator itLandmark = structure.begin(); itLandmark != structure.end(); ++itLandmark)
+      erased += eraseObservationsIf(itLandmark->second, predicate);
+    return erased;
+  }
+
+  /**
+   * @brief Erase from the structure every landmark matched by the predicate.
+   * The removals are collected during the scan and applied afterwards, so the
+   * predicate can safely inspect the whole structure.
+   * The predicate is called once per landmark as predicate(landmarkId, landmark).
+   * @param[in] predicate Returns true for the landmarks to erase
+   * @return number of erased landmarks
+   */
+  template <class Predicate>
+  std::size_t eraseLandmarksIf(Predicate predicate)
+  {
+    std::vector<IndexT> removedIds;
+    for (Landmarks::const_iterator itLandmark = structure.begin(); itLandmark != structure.end(); ++itLandmark)
+    {
+      if (predicate(itLandmark->first, itLandmark->second))
+        removedIds.push_back(itLandmark->first);
+    }
+    for (std::size_t i = 0; i < removedIds.size(); ++i)
+      structure.erase(removedIds[i]);
+    return removedIds.size();
+  }
+
 private:
 
   /// Considered poses (indexed by view.getPoseId())
@@ -333,6 +438,100 @@ private:
   }
 };
 
+/**
+ * @brief Non-owning range over the views of an SfMData that have valid camera
+ * intrinsic and pose, optionally restricted to the views sharing one
+ * intrinsic. Invalid entries are skipped while iterating, so traversing the
+ * range costs no allocation and no shared_ptr copy, contrary to building a
+ * std::set<IndexT> with getValidViews and looking every view up again.
+ */
+class ValidViewsRange
+{
+public:
+  class const_iterator
+  {
+  public:
+    const_iterator(const SfMData& sfmData, Views::const_iterator it, IndexT intrinsicId)
+      : _sfmData(&sfmData)
+      , _it(it)
+      , _intrinsicId(intrinsicId)
+    {
+      skipInvalid();
+    }
+
+    const Views::value_type& operator*() const { return *_it; }
+    const Views::value_type* operator->() const { return &(*_it); }
+
+    const_iterator& operator++()
+    {
+      ++_it;
+      skipInvalid();
+      return *this;
+    }
+
+    bool operator==(const const_iterator& other) const { return _it == other._it; }
+    bool operator!=(const const_iterator& other) const { return _it != other._it; }
+
+  private:
+    /// Advance to the next view of the group with valid intrinsic and pose
+    void skipInvalid()
+    {
+      const Views& views = _sfmData->GetViews();
+      while(_it != views.end() &&
+            ((_intrinsicId != UndefinedIndexT && _it->second->getIntrinsicId() != _intrinsicId) ||
+             !_sfmData->IsPoseAndIntrinsicDefined(_it->second.get())))
+      {
+        ++_it;
+      }
+    }
+
+    const SfMData* _sfmData;
+    Views::const_iterator _it;
+    IndexT _intrinsicId;
+  };
+
+  explicit ValidViewsRange(const SfMData& sfmData, IndexT intrinsicId = UndefinedIndexT)
+    : _sfmData(&sfmData)
+    , _intrinsicId(intrinsicId)
+  {}
+
+  const_iterator begin() const { return const_iterator(*_sfmData, _sfmData->GetViews().begin(), _intrinsicId); }
+  const_iterator end() const { return const_iterator(*_sfmData, _sfmData->GetViews().end(), _intrinsicId); }
+
+  /// true if no view of the range is valid; cheaper than size() as it stops
+  /// at the first valid entry
+  bool empty() const { return begin() == end(); }
+
+  /// Number of views in the range; linear in the number of views but
+  /// allocation-free
+  std::size_t size() const
+  {
+    std::size_t count = 0;
+    for(const_iterator it = begin(); it != end(); ++it)
+      ++count;
+    return count;
+  }
+
+private:
+  const SfMData* _sfmData;
+  IndexT _intrinsicId;
+};
+
+inline ValidViewsRange SfMData::validViews() const
+{
+  return ValidViewsRange(*this);
+}
+
+inline ValidViewsRange SfMData::viewsWithIntrinsic(IndexT intrinsicId) const
+{
+  return ValidViewsRange(*this, intrinsicId);
+}
+
+inline std::size_t SfMData::nbValidViews() const
+{
+  return validViews().size();
+}
+
 /**
  * @brief ColorizeTracks Add the associated color to each 3D point of
  * the sfm_data, using the track to determine the best view from which
@@ -112,6 +112,50 @@ BOOST_AUTO_TEST_CASE(BUNDLE_ADJUSTMENT_EffectiveMinimization_PinholeBrownT2) {
   BOOST_CHECK( dResidual_before > dResidual_after);
 }
 
+BOOST_AUTO_TEST_CASE(BUNDLE_ADJUSTMENT_EffectiveMinimization_PinholeRadialK3_AnalyticDerivatives) {
+
+  const int nviews = 3;
+  const int npoints = 6;
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  // Translate the input dataset to a SfMData scene
+  SfMData sfmData = getInputScene(d, config, PINHOLE_CAMERA_RADIAL3);
+
+  const double dResidual_before = RMSE(sfmData);
+
+  // Same as above but with the hand-derived Jacobians instead of autodiff
+  BundleAdjustmentCeres::BA_options options;
+  options._bUseAnalyticDerivatives = true;
+  std::shared_ptr<BundleAdjustment> ba_object = std::make_shared<BundleAdjustmentCeres>(options);
+  BOOST_CHECK( ba_object->Adjust(sfmData) );
+
+  const double dResidual_after = RMSE(sfmData);
+  BOOST_CHECK( dResidual_before > dResidual_after);
+}
+
+BOOST_AUTO_TEST_CASE(BUNDLE_ADJUSTMENT_EffectiveMinimization_Pinhole_IterativeSchur) {
+
+  const int nviews = 3;
+  const int npoints = 6;
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  // Translate the input dataset to a SfMData scene
+  SfMData sfmData = getInputScene(d, config, PINHOLE_CAMERA);
+
+  const double dResidual_before = RMSE(sfmData);
+
+  // Same as above but with the PCG solver profile instead of the exact factorization
+  BundleAdjustmentCeres::BA_options options;
+  options.setSolverProfile(BA_SOLVER_ITERATIVE_SCHUR, sfmData);
+  std::shared_ptr<BundleAdjustment> ba_object = std::make_shared<BundleAdjustmentCeres>(options);
+  BOOST_CHECK( ba_object->Adjust(sfmData) );
+
+  const double dResidual_after = RMSE(sfmData);
+  BOOST_CHECK( dResidual_before > dResidual_after);
+}
+
 BOOST_AUTO_TEST_CASE(BUNDLE_ADJUSTMENT_EffectiveMinimization_PinholeFisheye) {
 
   const int nviews = 3;
@@ -55,7 +55,7 @@ bool Generate_SfM_Report(const SfMData & sfm_data,
 
   std::ostringstream os;
   os << "#views: " << sfm_data.GetViews().size() << sNewLine
-  << " #valid views: " << sfm_data.getValidViews().size() << sNewLine
+  << " #valid views: " << sfm_data.nbValidViews() << sNewLine
   << " #poses: " << sfm_data.GetPoses().size() << sNewLine
   << " #intrinsics: " << sfm_data.GetIntrinsics().size() << sNewLine
   << " #tracks: " << sfm_data.GetLandmarks().size() << sNewLine
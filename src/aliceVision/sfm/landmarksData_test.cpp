@@ -0,0 +1,96 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "LandmarksData.hpp"
+
+#define BOOST_TEST_MODULE landmarksData
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::sfm;
+
+namespace {
+
+Landmarks createTestLandmarks()
+{
+  Landmarks landmarks;
+
+  for(IndexT landmarkId = 10; landmarkId < 50; landmarkId += 10)
+  {
+    Landmark landmark(Vec3(landmarkId, landmarkId + 0.5, landmarkId + 1.0), feature::EImageDescriberType::SIFT);
+
+    for(IndexT viewId = 0; viewId < 1 + landmarkId / 10; ++viewId)
+      landmark.observations[viewId] = Observation(Vec2(viewId, viewId + 0.5), landmarkId + viewId);
+
+    landmarks.emplace(landmarkId, landmark);
+  }
+  return landmarks;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(landmarksData_RoundTrip)
+{
+  const Landmarks landmarks = createTestLandmarks();
+
+  LandmarksData data;
+  data.fromLandmarks(landmarks);
+
+  BOOST_CHECK_EQUAL(data.nbLandmarks(), landmarks.size());
+  BOOST_CHECK_EQUAL(data.nbObservations(), 2 + 3 + 4 + 5);
+
+  Landmarks rebuilt;
+  data.toLandmarks(rebuilt);
+
+  BOOST_CHECK(rebuilt == landmarks);
+}
+
+BOOST_AUTO_TEST_CASE(landmarksData_UpdatePoints)
+{
+  Landmarks landmarks = createTestLandmarks();
+
+  LandmarksData data;
+  data.fromLandmarks(landmarks);
+
+  for(std::size_t i = 0; i < data.nbLandmarks(); ++i)
+    Eigen::Map<Vec3>(data.pointPtr(i)) = Vec3(i, i, i);
+
+  data.updatePoints(landmarks);
+
+  std::size_t i = 0;
+  for(const auto& landmarkIt : landmarks)
+  {
+    BOOST_CHECK_EQUAL(landmarkIt.second.X, data.point(i));
+    ++i;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(landmarksData_Erase)
+{
+  const Landmarks landmarks = createTestLandmarks();
+
+  LandmarksData data;
+  data.fromLandmarks(landmarks);
+
+  // erase the first landmark and the first observation of every other landmark
+  data.eraseLandmark(0);
+  for(std::size_t i = 1; i < data.nbLandmarks(); ++i)
+    data.eraseObservation(data.obsBegin(i));
+
+  Landmarks rebuilt;
+  data.toLandmarks(rebuilt);
+
+  BOOST_CHECK_EQUAL(rebuilt.size(), landmarks.size() - 1);
+  BOOST_CHECK_EQUAL(rebuilt.count(data.landmarkId(0)), 0);
+
+  for(std::size_t i = 1; i < data.nbLandmarks(); ++i)
+  {
+    const Landmark& original = landmarks.at(data.landmarkId(i));
+    const Landmark& filtered = rebuilt.at(data.landmarkId(i));
+
+    BOOST_CHECK_EQUAL(filtered.observations.size(), original.observations.size() - 1);
+    BOOST_CHECK_EQUAL(filtered.observations.count(original.observations.begin()->first), 0);
+  }
+}
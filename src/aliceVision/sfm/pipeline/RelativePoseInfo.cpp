@@ -20,54 +20,31 @@ bool estimate_Rt_fromE(const Mat3 & K1, const Mat3 & K2,
   const Mat3 & E, const std::vector<size_t> & vec_inliers,
   Mat3 * R, Vec3 * t)
 {
-  // Accumulator to find the best solution
-  std::vector<size_t> f(4, 0);
-
   std::vector<Mat3> Rs;  // Rotation matrix.
   std::vector<Vec3> ts;  // Translation matrix.
 
   // Recover best rotation and translation from E.
   MotionFromEssential(E, &Rs, &ts);
 
-  //-> Test the 4 solutions will all the points
-  assert(Rs.size() == 4);
-  assert(ts.size() == 4);
-
-  Mat34 P1, P2;
-  Mat3 R1 = Mat3::Identity();
-  Vec3 t1 = Vec3::Zero();
-  P_From_KRt(K1, R1, t1, &P1);
-
-  for (unsigned int i = 0; i < 4; ++i)
+  // Gather the inlier correspondences
+  Mat x1_inliers(2, vec_inliers.size());
+  Mat x2_inliers(2, vec_inliers.size());
+  for (size_t k = 0; k < vec_inliers.size(); ++k)
   {
-    const Mat3 &R2 = Rs[i];
-    const Vec3 &t2 = ts[i];
-    P_From_KRt(K2, R2, t2, &P2);
-    Vec3 X;
-
-    for (size_t k = 0; k < vec_inliers.size(); ++k)
-    {
-      const Vec2
-        & x1_ = x1.col(vec_inliers[k]),
-        & x2_ = x2.col(vec_inliers[k]);
-      TriangulateDLT(P1, x1_, P2, x2_, &X);
-      // Test if point is front to the two cameras.
-      if (Depth(R1, t1, X) > 0 && Depth(R2, t2, X) > 0)
-      {
-        ++f[i];
-      }
-    }
+    x1_inliers.col(k) = x1.col(vec_inliers[k]);
+    x2_inliers.col(k) = x2.col(vec_inliers[k]);
   }
-  // Check the solution:
-  const std::vector<size_t>::iterator iter = std::max_element(f.begin(), f.end());
-  if (*iter == 0)
+
+  //-> Test the 4 solutions with all the points
+  const int solution =
+    MotionFromEssentialChooseSolution(Rs, ts, K1, x1_inliers, K2, x2_inliers);
+  if (solution < 0)
   {
     // There is no right solution with points in front of the cameras
     return false;
   }
-  const size_t index = std::distance(f.begin(), iter);
-  (*R) = Rs[index];
-  (*t) = ts[index];
+  (*R) = Rs[solution];
+  (*t) = ts[solution];
 
   return true;
 }
@@ -116,6 +93,45 @@ bool robustRelativePose(
   return true;
 }
 
+bool relativePoseFromEssential(
+  const Mat3 & K1, const Mat3 & K2,
+  const Mat & x1, const Mat & x2,
+  const Mat3 & E, const double precision,
+  RelativePoseInfo & relativePose_info)
+{
+  typedef aliceVision::essential::kernel::FivePointKernel SolverType;
+
+  // Collect the correspondences supporting the given model
+  Mat3 F;
+  FundamentalFromEssential(E, K1, K2, &F);
+  const double threshold = Square(std::max(precision, 1.0));
+
+  relativePose_info.vec_inliers.clear();
+  for (Mat::Index i = 0; i < x1.cols(); ++i)
+  {
+    if (fundamental::kernel::EpipolarDistanceError::Error(F, x1.col(i), x2.col(i)) < threshold)
+      relativePose_info.vec_inliers.push_back(i);
+  }
+
+  if (relativePose_info.vec_inliers.size() < SolverType::MINIMUM_SAMPLES * ALICEVISION_MINIMUM_SAMPLES_COEF )
+    return false; // no sufficient coverage (the model does not support enough samples)
+
+  relativePose_info.essential_matrix = E;
+  relativePose_info.found_residual_precision = std::max(precision, 1.0);
+
+  // estimation of the relative poses
+  Mat3 R;
+  Vec3 t;
+  if (!estimate_Rt_fromE(
+    K1, K2, x1, x2,
+    relativePose_info.essential_matrix, relativePose_info.vec_inliers, &R, &t))
+    return false; // cannot find a valid [R|t] couple that makes the inliers in front of the camera.
+
+  // Store [R|C] for the second camera, since the first camera is [Id|0]
+  relativePose_info.relativePose = geometry::Pose3(R, -R.transpose() * t);
+  return true;
+}
+
 } // namespace sfm
 } // namespace aliceVision
 
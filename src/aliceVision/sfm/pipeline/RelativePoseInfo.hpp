@@ -71,5 +71,28 @@ bool robustRelativePose
   const size_t max_iteration_count = 4096
 );
 
+/**
+ * @brief Compute the Relative pose between two views from an essential matrix
+ *  already estimated by a previous step (e.g. the geometric filtering of the
+ *  matches), instead of running a new robust estimation.
+ *  The inliers of the given model are recomputed on the input points with the
+ *  given precision threshold.
+ *
+ * @param[in] K1 camera 1 intrinsics
+ * @param[in] K2 camera 2 intrinsics
+ * @param[in] x1 camera 1 image points
+ * @param[in] x2 camera 2 image points
+ * @param[in] E essential matrix prior (x2' * E * x1 = 0 in camera coordinates)
+ * @param[in] precision estimated precision of the prior (pixels)
+ * @param[out] relativePose_info relative pose information
+ */
+bool relativePoseFromEssential
+(
+  const Mat3 & K1, const Mat3 & K2,
+  const Mat & x1, const Mat & x2,
+  const Mat3 & E, const double precision,
+  RelativePoseInfo & relativePose_info
+);
+
 } // namespace sfm
 } // namespace aliceVision
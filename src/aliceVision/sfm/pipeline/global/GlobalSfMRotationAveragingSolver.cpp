@@ -41,7 +41,7 @@ bool GlobalSfMRotationAveragingSolver::Run(
       // Triplet inference (test over the composition error)
       //-------------------
       PairSet pairs = getPairs(relativeRotations);
-      std::vector< graph::Triplet > vec_triplets = graph::tripletListing(pairs);
+      std::vector< graph::Triplet > vec_triplets = graph::tripletListingParallel(pairs);
       //-- Rejection triplet that are 'not' identity rotation (error to identity > 5°)
       TripletRotationRejection(5.0f, vec_triplets, relativeRotations);
 
@@ -100,14 +100,19 @@ bool GlobalSfMRotationAveragingSolver::Run(
     }
     break;
     case ROTATION_AVERAGING_L1:
+    case ROTATION_AVERAGING_L1_MT:
     {
       using namespace aliceVision::rotationAveraging::l1;
 
       //- Solve the global rotation estimation problem:
       const size_t nMainViewID = 0; //arbitrary choice
       std::vector<bool> vec_inliers;
-      bSuccess = rotationAveraging::l1::GlobalRotationsRobust(
-        relativeRotations, vec_globalR, nMainViewID, 0.0f, &vec_inliers);
+      if(eRotationAveragingMethod == ROTATION_AVERAGING_L1_MT)
+        bSuccess = rotationAveraging::l1::GlobalRotationsRobust_MT(
+          relativeRotations, vec_globalR, nMainViewID, 0.0f, &vec_inliers);
+      else
+        bSuccess = rotationAveraging::l1::GlobalRotationsRobust(
+          relativeRotations, vec_globalR, nMainViewID, 0.0f, &vec_inliers);
 
       ALICEVISION_LOG_DEBUG("inliers: " << vec_inliers);
 
@@ -161,10 +166,14 @@ void GlobalSfMRotationAveragingSolver::TripletRotationRejection(
   std::vector< graph::Triplet > vec_triplets_validated;
   vec_triplets_validated.reserve(vec_triplets.size());
 
-  std::vector<float> vec_errToIdentityPerTriplet;
-  vec_errToIdentityPerTriplet.reserve(vec_triplets.size());
-  // Compute the composition error for each length 3 cycles
-  for (size_t i = 0; i < vec_triplets.size(); ++i)
+  // Compute the composition error for each length 3 cycles.
+  // The cycles are independent (const lookups in the relative rotations map),
+  // so the compositions are evaluated on all the cores; the per-triplet error
+  // array keeps the collection deterministic and the validated relative
+  // rotations are gathered serially afterwards.
+  std::vector<float> vec_errToIdentityPerTriplet(vec_triplets.size());
+  #pragma omp parallel for schedule(static)
+  for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(vec_triplets.size()); ++i)
   {
     const graph::Triplet & triplet = vec_triplets[i];
     const IndexT I = triplet.i, J = triplet.j , K = triplet.k;
@@ -183,11 +192,19 @@ void GlobalSfMRotationAveragingSolver::TripletRotationRejection(
       map_relatives.at(ki).Rij : Mat3(map_relatives.at(ik).Rij.transpose());
 
     const Mat3 Rot_To_Identity = RIJ * RJK * RKI; // motion composition
-    const float angularErrorDegree = static_cast<float>(radianToDegree(getRotationMagnitude(Rot_To_Identity)));
-    vec_errToIdentityPerTriplet.push_back(angularErrorDegree);
+    vec_errToIdentityPerTriplet[i] =
+      static_cast<float>(radianToDegree(getRotationMagnitude(Rot_To_Identity)));
+  }
 
-    if (angularErrorDegree < max_angular_error)
+  // Keep the triplets below the angular error threshold and their edges
+  for (size_t i = 0; i < vec_triplets.size(); ++i)
+  {
+    if (vec_errToIdentityPerTriplet[i] < max_angular_error)
     {
+      const graph::Triplet & triplet = vec_triplets[i];
+      const IndexT I = triplet.i, J = triplet.j , K = triplet.k;
+      const Pair ij(I,J), ji(J,I), jk(J,K), kj(K,J), ki(K,I), ik(I,K);
+
       vec_triplets_validated.push_back(triplet);
 
       if (map_relatives.count(ij))
@@ -11,7 +11,8 @@ namespace sfm{
 enum ERotationAveragingMethod
 {
   ROTATION_AVERAGING_L1 = 1,
-  ROTATION_AVERAGING_L2 = 2
+  ROTATION_AVERAGING_L2 = 2,
+  ROTATION_AVERAGING_L1_MT = 3 // multithreaded IRLS with a sparse solver
 };
 
 enum ERelativeRotationInferenceMethod
@@ -353,7 +353,7 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
     // An estimated triplets of translation mark three edges as estimated.
 
     //-- precompute the number of track per triplet:
-    HashMap<IndexT, IndexT> map_tracksPerTriplets;
+    std::vector<IndexT> vec_tracksPerTriplets(vec_triplets.size(), 0);
 
     #pragma omp parallel for schedule(dynamic)
     for (int i = 0; i < (int)vec_triplets.size(); ++i)
@@ -382,8 +382,8 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
         tracksBuilder.Build(map_triplet_matches);
         tracksBuilder.Filter(3);
 
-        #pragma omp critical
-        map_tracksPerTriplets[i] = tracksBuilder.NbTracks(); //count the # of matches in the UF tree
+        // each thread writes its own slot, no synchronization needed
+        vec_tracksPerTriplets[i] = tracksBuilder.NbTracks(); //count the # of matches in the UF tree
       }
     }
 
@@ -410,8 +410,11 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
       std::cout,
       "\nRelative translations computation (edge coverage algorithm)\n");
 
-    // set number of threads, 1 if openMP is not enabled  
-    std::vector<translationAveraging::RelativeInfoVec> initial_estimates(omp_get_max_threads());
+    // Per-edge estimation results, indexed by the edge position in vec_edges, so that
+    // the final reduction does not depend on the thread scheduling
+    std::vector<translationAveraging::RelativeInfoVec> initial_estimates(vec_edges.size());
+    std::vector<std::vector<size_t> > vec_edgeInliers(vec_edges.size());
+    std::vector<aliceVision::track::TracksMap> vec_edgeTracks(vec_edges.size());
     const bool bVerbose = false;
 
     #pragma omp parallel for schedule(dynamic)
@@ -431,7 +434,7 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
         std::vector<size_t> vec_commonTracksPerTriplets;
         for (const size_t triplet_index : vec_possibleTripletIndexes)
         {
-          vec_commonTracksPerTriplets.push_back(map_tracksPerTriplets[triplet_index]);
+          vec_commonTracksPerTriplets.push_back(vec_tracksPerTriplets[triplet_index]);
         }
 
         using namespace stl::indexed_sort;
@@ -508,53 +511,17 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
               Vec3 tik;
               RelativeCameraMotion(RI, ti, RK, tk, &Rik, &tik);
 
-              // set number of threads, 1 if openMP is not enabled
-              const int thread_id = omp_get_thread_num();
-
-              initial_estimates[thread_id].emplace_back(
+              // each thread writes its own edge slot, no synchronization needed
+              initial_estimates[k].emplace_back(
                 std::make_pair(triplet.i, triplet.j), std::make_pair(Rij, tij));
-              initial_estimates[thread_id].emplace_back(
+              initial_estimates[k].emplace_back(
                 std::make_pair(triplet.j, triplet.k), std::make_pair(Rjk, tjk));
-              initial_estimates[thread_id].emplace_back(
+              initial_estimates[k].emplace_back(
                 std::make_pair(triplet.i, triplet.k), std::make_pair(Rik, tik));
 
-              //--- ATOMIC
-              #pragma omp critical
-              {
-                // Add inliers as valid pairwise matches
-                for (std::vector<size_t>::const_iterator iterInliers = vec_inliers.begin();
-                  iterInliers != vec_inliers.end(); ++iterInliers)
-                {
-                  using namespace aliceVision::track;
-                  TracksMap::iterator it_tracks = pose_triplet_tracks.begin();
-                  std::advance(it_tracks, *iterInliers);
-                  const Track & track = it_tracks->second;
-
-                  // create pairwise matches from inlier track
-                  for (size_t index_I = 0; index_I < track.featPerView.size() ; ++index_I)
-                  {
-                    Track::FeatureIdPerView::const_iterator iter_I = track.featPerView.begin();
-                    std::advance(iter_I, index_I);
-
-                    // extract camera indexes
-                    const size_t id_view_I = iter_I->first;
-                    const size_t id_feat_I = iter_I->second;
-
-                    // loop on subtracks
-                    for (size_t index_J = index_I+1; index_J < track.featPerView.size() ; ++index_J)
-                    {
-                      Track::FeatureIdPerView::const_iterator iter_J = track.featPerView.begin();
-                      std::advance(iter_J, index_J);
-
-                      // extract camera indexes
-                      const size_t id_view_J = iter_J->first;
-                      const size_t id_feat_J = iter_J->second;
-
-                      newpairMatches[std::make_pair(id_view_I, id_view_J)][track.descType].emplace_back(id_feat_I, id_feat_J);
-                    }
-                  }
-                }
-              }
+              // Keep the inlier tracks, the matches are committed sequentially after the parallel region
+              vec_edgeInliers[k] = std::move(vec_inliers);
+              vec_edgeTracks[k] = std::move(pose_triplet_tracks);
             }
             // Since a relative translation have been found for the edge: vec_edges[k],
             //  we break and start to estimate the translations for some other edges.
@@ -563,13 +530,47 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
         }
       }
     }
-    // Merge thread estimates
-    for (const auto vec : initial_estimates)
+    // Merge the per-edge estimates, in edge order whatever the thread scheduling
+    for (size_t k = 0; k < vec_edges.size(); ++k)
     {
-      for (const auto val : vec)
+      for (const auto & val : initial_estimates[k])
       {
         vec_initialEstimates.emplace_back(val);
       }
+
+      // Add inliers as valid pairwise matches
+      const aliceVision::track::TracksMap & pose_triplet_tracks = vec_edgeTracks[k];
+      for (const size_t inlierIndex : vec_edgeInliers[k])
+      {
+        using namespace aliceVision::track;
+        TracksMap::const_iterator it_tracks = pose_triplet_tracks.begin();
+        std::advance(it_tracks, inlierIndex);
+        const Track & track = it_tracks->second;
+
+        // create pairwise matches from inlier track
+        for (size_t index_I = 0; index_I < track.featPerView.size() ; ++index_I)
+        {
+          Track::FeatureIdPerView::const_iterator iter_I = track.featPerView.begin();
+          std::advance(iter_I, index_I);
+
+          // extract camera indexes
+          const size_t id_view_I = iter_I->first;
+          const size_t id_feat_I = iter_I->second;
+
+          // loop on subtracks
+          for (size_t index_J = index_I+1; index_J < track.featPerView.size() ; ++index_J)
+          {
+            Track::FeatureIdPerView::const_iterator iter_J = track.featPerView.begin();
+            std::advance(iter_J, index_J);
+
+            // extract camera indexes
+            const size_t id_view_J = iter_J->first;
+            const size_t id_feat_J = iter_J->second;
+
+            newpairMatches[std::make_pair(id_view_I, id_view_J)][track.descType].emplace_back(id_feat_I, id_feat_J);
+          }
+        }
+      }
     }
   }
 
@@ -49,8 +49,8 @@ namespace sfm {
         if (observation.second.id_feat != UndefinedIndexT)
         {
           // copy the feature/descriptor to landmark_observations_descriptors
-          const feature::Regions& viewRegions = regionsPerView.getRegions(observation.first, landmark.second.descType);
-          viewRegions.CopyRegion(observation.second.id_feat, landmark_observations_descriptors_.get());
+          const feature::RegionsHandle viewRegions = regionsPerView.getRegions(observation.first, landmark.second.descType);
+          viewRegions->CopyRegion(observation.second.id_feat, landmark_observations_descriptors_.get());
           // link this descriptor to the track Id
           index_to_landmark_id_.push_back(landmark.first);
         }
@@ -36,7 +36,8 @@ bool SfMLocalizer::Localize
   const camera::IntrinsicBase * optional_intrinsics,
   ImageLocalizerMatchData & resection_data,
   geometry::Pose3 & pose,
-  robustEstimation::ERobustEstimator estimator
+  robustEstimation::ERobustEstimator estimator,
+  std::mt19937 * randomGenerator
 )
 {
   // --
@@ -68,7 +69,7 @@ bool SfMLocalizer::Localize
       resection_data.pt3D);
     // Robust estimation of the Projection matrix and its precision
     const std::pair<double,double> ACRansacOut =
-      aliceVision::robustEstimation::ACRANSAC(kernel, resection_data.vec_inliers, resection_data.max_iteration, &P, dPrecision, true);
+      aliceVision::robustEstimation::ACRANSAC(kernel, resection_data.vec_inliers, resection_data.max_iteration, &P, dPrecision, true, false, randomGenerator);
     // Update the upper bound precision of the model found by AC-RANSAC
     resection_data.error_max = ACRansacOut.first;
   }
@@ -79,12 +80,9 @@ bool SfMLocalizer::Localize
     const bool has_disto = pinhole_cam->have_disto();
     if(has_disto)
     {
-      const std::size_t numPts = resection_data.pt2D.cols();
-      pt2Dundistorted = Mat2X(2, numPts);
-      for(std::size_t iPoint = 0; iPoint < numPts; ++iPoint)
-      {
-        pt2Dundistorted.col(iPoint) = pinhole_cam->get_ud_pixel(resection_data.pt2D.col(iPoint));
-      }
+      // undistort the whole block at once, the distortion inversion is
+      // vectorized and shared between the points
+      pt2Dundistorted = pinhole_cam->get_ud_pixel_many(resection_data.pt2D);
     }
 
     switch(estimator)
@@ -105,7 +103,7 @@ bool SfMLocalizer::Localize
 
         // Robust estimation of the Projection matrix and its precision
         const std::pair<double, double> ACRansacOut =
-                aliceVision::robustEstimation::ACRANSAC(kernel, resection_data.vec_inliers, resection_data.max_iteration, &P, dPrecision, true);
+                aliceVision::robustEstimation::ACRANSAC(kernel, resection_data.vec_inliers, resection_data.max_iteration, &P, dPrecision, true, false, randomGenerator);
         // Update the upper bound precision of the model found by AC-RANSAC
         resection_data.error_max = ACRansacOut.first;
         break;
@@ -144,7 +142,7 @@ bool SfMLocalizer::Localize
         // @todo refactor, maybe move scorer directly inside the kernel
         const double threshold = resection_data.error_max * resection_data.error_max * (kernel.normalizer2()(0, 0) * kernel.normalizer2()(0, 0));
         robustEstimation::ScoreEvaluator<KernelType> scorer(threshold);
-        P = robustEstimation::LO_RANSAC(kernel, scorer, &resection_data.vec_inliers);
+        P = robustEstimation::LO_RANSAC(kernel, scorer, &resection_data.vec_inliers, NULL, false, 100, 1e-2, randomGenerator);
         break;
       }
 
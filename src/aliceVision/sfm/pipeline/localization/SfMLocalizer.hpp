@@ -12,6 +12,7 @@
 
 #include <cstddef>
 #include <limits>
+#include <random>
 
 namespace aliceVision {
 namespace sfm {
@@ -88,8 +89,11 @@ public:
   * @param[in,out] resection_data matching data (with filled 2D-3D correspondences). 
    * The 2D points are supposed to be the original distorted image points
   * @param[out] pose found pose
-  * @param[in] estimator The type of robust estimator to use. The only supported 
+  * @param[in] estimator The type of robust estimator to use. The only supported
    * frameworks are ERobustEstimator::ACRANSAC and ERobustEstimator::LORANSAC.
+  * @param[in,out] randomGenerator If given, the robust estimation draws all its
+   * samples from this random stream instead of a device-seeded one, making the
+   * localization reproducible (@see robustEstimation::createTaskGenerator).
   * @return True if a putative pose has been estimated
   */
   static bool Localize
@@ -98,7 +102,8 @@ public:
     const camera::IntrinsicBase * optional_intrinsics,
     ImageLocalizerMatchData & resection_data,
     geometry::Pose3 & pose,
-    robustEstimation::ERobustEstimator estimator = robustEstimation::ERobustEstimator::ACRANSAC
+    robustEstimation::ERobustEstimator estimator = robustEstimation::ERobustEstimator::ACRANSAC,
+    std::mt19937 * randomGenerator = nullptr
   );
 
   /**
@@ -0,0 +1,400 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "aliceVision/sfm/pipeline/partitioned/ReconstructionEngine_partitionedSfM.hpp"
+#include "aliceVision/sfm/pipeline/sequential/ReconstructionEngine_sequentialSfM.hpp"
+#include "aliceVision/sfm/BundleAdjustmentCeres.hpp"
+#include "aliceVision/sfm/utils/alignment.hpp"
+#include "aliceVision/track/Track.hpp"
+#include "aliceVision/system/Logger.hpp"
+
+#include "dependencies/stlplus3/filesystemSimplified/file_system.hpp"
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <utility>
+
+namespace aliceVision {
+namespace sfm {
+
+using namespace aliceVision::track;
+
+namespace {
+
+/// Number of common elements between two sorted track id sets
+std::size_t countCommonTracks(const TrackIdSet& a, const TrackIdSet& b)
+{
+  std::size_t nbCommon = 0;
+  std::size_t ia = 0, ib = 0;
+  while(ia < a.size() && ib < b.size())
+  {
+    if(a[ia] < b[ib])
+      ++ia;
+    else if(b[ib] < a[ia])
+      ++ib;
+    else
+    {
+      ++nbCommon;
+      ++ia;
+      ++ib;
+    }
+  }
+  return nbCommon;
+}
+
+} // namespace
+
+ReconstructionEngine_partitionedSfM::ReconstructionEngine_partitionedSfM(
+  const SfMData& sfmData,
+  const std::string& soutDirectory)
+  : ReconstructionEngine(sfmData, soutDirectory)
+{
+}
+
+bool ReconstructionEngine_partitionedSfM::computeClusters()
+{
+  _clusters.clear();
+
+  if(_pairwiseMatches == nullptr || _pairwiseMatches->empty())
+  {
+    ALICEVISION_LOG_WARNING("ReconstructionEngine_partitionedSfM: no pairwise matches.");
+    return false;
+  }
+
+  // Fuse the matches into tracks to measure the covisibility of the views
+  TracksPerView tracksPerView;
+  {
+    TracksMap tracks;
+    FlatTracksBuilder tracksBuilder;
+    tracksBuilder.Build(*_pairwiseMatches);
+    tracksBuilder.Filter();
+    tracksBuilder.ExportToSTL(tracks);
+    TracksUtilsMap::computeTracksPerView(tracks, tracksPerView);
+  }
+
+  // Covisibility graph: one edge per matched pair, weighted by the number of
+  // common tracks of the two views
+  std::map<IndexT, std::map<IndexT, std::size_t>> covisibility;
+  for(const auto& pairMatches: *_pairwiseMatches)
+  {
+    const Pair& currentPair = pairMatches.first;
+    const auto itI = tracksPerView.find(currentPair.first);
+    const auto itJ = tracksPerView.find(currentPair.second);
+    if(itI == tracksPerView.end() || itJ == tracksPerView.end())
+      continue;
+    const std::size_t nbCommonTracks = countCommonTracks(itI->second, itJ->second);
+    if(nbCommonTracks == 0)
+      continue;
+    covisibility[currentPair.first][currentPair.second] = nbCommonTracks;
+    covisibility[currentPair.second][currentPair.first] = nbCommonTracks;
+  }
+
+  if(covisibility.empty())
+  {
+    ALICEVISION_LOG_WARNING("ReconstructionEngine_partitionedSfM: the matches do not build any track.");
+    return false;
+  }
+
+  std::set<IndexT> assigned;
+  while(assigned.size() < covisibility.size())
+  {
+    // Seed the cluster with the unassigned view of largest total covisibility
+    IndexT seed = UndefinedIndexT;
+    std::size_t seedWeight = 0;
+    for(const auto& viewEdges: covisibility)
+    {
+      if(assigned.count(viewEdges.first) != 0)
+        continue;
+      std::size_t totalWeight = 0;
+      for(const auto& edge: viewEdges.second)
+        totalWeight += edge.second;
+      if(seed == UndefinedIndexT || totalWeight > seedWeight)
+      {
+        seed = viewEdges.first;
+        seedWeight = totalWeight;
+      }
+    }
+    if(seed == UndefinedIndexT)
+      break;
+
+    std::vector<IndexT> cluster;
+    std::set<IndexT> clusterSet;
+    // Covisibility of each unassigned neighbor view with the current cluster
+    std::map<IndexT, std::size_t> frontier;
+
+    cluster.push_back(seed);
+    clusterSet.insert(seed);
+    assigned.insert(seed);
+    for(const auto& edge: covisibility.at(seed))
+    {
+      if(assigned.count(edge.first) == 0)
+        frontier[edge.first] += edge.second;
+    }
+
+    // Grow the cluster by absorbing its most covisible neighbor
+    while(cluster.size() < _maxClusterSize && !frontier.empty())
+    {
+      auto itBest = frontier.begin();
+      for(auto it = frontier.begin(); it != frontier.end(); ++it)
+      {
+        if(it->second > itBest->second)
+          itBest = it;
+      }
+      const IndexT viewId = itBest->first;
+      frontier.erase(itBest);
+
+      cluster.push_back(viewId);
+      clusterSet.insert(viewId);
+      assigned.insert(viewId);
+      for(const auto& edge: covisibility.at(viewId))
+      {
+        if(assigned.count(edge.first) == 0)
+          frontier[edge.first] += edge.second;
+      }
+    }
+
+    // Share the most covisible views of the previous clusters with this one,
+    // they provide the common poses used by the merge alignment
+    if(!_clusters.empty() && _clusterOverlap > 0)
+    {
+      std::map<IndexT, std::size_t> overlapWeights;
+      for(const IndexT viewId: cluster)
+      {
+        for(const auto& edge: covisibility.at(viewId))
+        {
+          if(assigned.count(edge.first) != 0 && clusterSet.count(edge.first) == 0)
+            overlapWeights[edge.first] += edge.second;
+        }
+      }
+      for(std::size_t k = 0; k < _clusterOverlap && !overlapWeights.empty(); ++k)
+      {
+        auto itBest = overlapWeights.begin();
+        for(auto it = overlapWeights.begin(); it != overlapWeights.end(); ++it)
+        {
+          if(it->second > itBest->second)
+            itBest = it;
+        }
+        cluster.push_back(itBest->first);
+        clusterSet.insert(itBest->first);
+        overlapWeights.erase(itBest);
+      }
+    }
+
+    _clusters.push_back(cluster);
+  }
+
+  ALICEVISION_LOG_DEBUG("ReconstructionEngine_partitionedSfM: " << covisibility.size()
+    << " connected views partitioned in " << _clusters.size() << " cluster(s).");
+  return !_clusters.empty();
+}
+
+bool ReconstructionEngine_partitionedSfM::processCluster(std::size_t i, SfMData& outSubmodel)
+{
+  const std::vector<IndexT>& cluster = _clusters.at(i);
+  const std::set<IndexT> clusterSet(cluster.begin(), cluster.end());
+
+  // Scene restricted to the cluster views; each cluster refines its own copy
+  // of the intrinsics, so the reconstructions can run concurrently
+  SfMData clusterScene;
+  clusterScene._featuresFolders = _sfm_data._featuresFolders;
+  clusterScene._matchesFolders = _sfm_data._matchesFolders;
+  for(const IndexT viewId: cluster)
+  {
+    const auto itView = _sfm_data.GetViews().find(viewId);
+    if(itView == _sfm_data.GetViews().end())
+      continue;
+    clusterScene.views[viewId] = itView->second;
+    const IndexT intrinsicId = itView->second->getIntrinsicId();
+    if(clusterScene.intrinsics.count(intrinsicId) == 0)
+    {
+      const auto itIntrinsic = _sfm_data.GetIntrinsics().find(intrinsicId);
+      if(itIntrinsic != _sfm_data.GetIntrinsics().end())
+        clusterScene.intrinsics[intrinsicId] = std::shared_ptr<camera::IntrinsicBase>(itIntrinsic->second->clone());
+    }
+  }
+
+  // Matches restricted to the pairs internal to the cluster
+  matching::PairwiseMatches clusterMatches;
+  for(const auto& pairMatches: *_pairwiseMatches)
+  {
+    const Pair& currentPair = pairMatches.first;
+    if(clusterSet.count(currentPair.first) != 0 && clusterSet.count(currentPair.second) != 0)
+      clusterMatches.insert(pairMatches);
+  }
+
+  const std::string clusterDirectory = stlplus::create_filespec(_sOutDirectory, "cluster_" + std::to_string(i));
+  if(!stlplus::folder_exists(clusterDirectory))
+    stlplus::folder_create(clusterDirectory);
+
+  ReconstructionEngine_sequentialSfM clusterEngine(
+    clusterScene,
+    clusterDirectory,
+    stlplus::create_filespec(clusterDirectory, "Reconstruction_Report.html"));
+  clusterEngine.setFeatures(_featuresPerView);
+  clusterEngine.setMatches(&clusterMatches);
+  clusterEngine.Set_bFixedIntrinsics(Get_bFixedIntrinsics());
+
+  if(!clusterEngine.Process())
+  {
+    ALICEVISION_LOG_WARNING("ReconstructionEngine_partitionedSfM: reconstruction of cluster #" << i << " failed.");
+    return false;
+  }
+  outSubmodel = clusterEngine.Get_SfMData();
+  return true;
+}
+
+bool ReconstructionEngine_partitionedSfM::mergeSubmodels(std::vector<SfMData>& submodels)
+{
+  if(submodels.empty())
+    return false;
+
+  // The largest submodel defines the reference frame of the merged scene
+  std::size_t refIndex = 0;
+  for(std::size_t i = 1; i < submodels.size(); ++i)
+  {
+    if(submodels[i].GetPoses().size() > submodels[refIndex].GetPoses().size())
+      refIndex = i;
+  }
+
+  // Track ids are local to each cluster: the landmarks are re-indexed on
+  // insertion and the shared ones are recognized from their observations, so
+  // the overlap tracks end up observed from several submodels and tie them
+  // together in the joint bundle adjustment.
+  IndexT nextLandmarkId = 0;
+  std::map<std::pair<IndexT, IndexT>, IndexT> observationToLandmark; // (viewId, featId) -> merged landmark id
+
+  // importSubmodel copies the poses, refined intrinsics and landmarks of an
+  // aligned submodel in the internal scene; the estimates already present in
+  // the merged scene are kept.
+  const auto importSubmodel = [&](const SfMData& submodel)
+  {
+    for(const auto& intrinsic: submodel.GetIntrinsics())
+      _sfm_data.intrinsics[intrinsic.first] = intrinsic.second;
+
+    for(const auto& viewPair: submodel.GetViews())
+    {
+      const View& view = *viewPair.second;
+      if(!submodel.IsPoseAndIntrinsicDefined(&view))
+        continue;
+      if(!_sfm_data.existsPose(view))
+        _sfm_data.setPose(view, submodel.getPose(view));
+    }
+
+    for(const auto& landmarkPair: submodel.structure)
+    {
+      const Landmark& landmark = landmarkPair.second;
+
+      // A track already imported from another submodel?
+      IndexT landmarkId = UndefinedIndexT;
+      for(const auto& obs: landmark.observations)
+      {
+        const auto it = observationToLandmark.find(std::make_pair(obs.first, obs.second.id_feat));
+        if(it != observationToLandmark.end())
+        {
+          landmarkId = it->second;
+          break;
+        }
+      }
+
+      if(landmarkId == UndefinedIndexT)
+      {
+        landmarkId = nextLandmarkId++;
+        _sfm_data.structure[landmarkId] = landmark;
+      }
+      else
+      {
+        Observations& mergedObservations = _sfm_data.structure[landmarkId].observations;
+        for(const auto& obs: landmark.observations)
+        {
+          if(mergedObservations.count(obs.first) == 0)
+            mergedObservations[obs.first] = obs.second;
+        }
+      }
+      for(const auto& obs: landmark.observations)
+        observationToLandmark[std::make_pair(obs.first, obs.second.id_feat)] = landmarkId;
+    }
+  };
+
+  std::vector<bool> registered(submodels.size(), false);
+  registered[refIndex] = true;
+  importSubmodel(submodels[refIndex]);
+
+  for(std::size_t round = 1; round < submodels.size(); ++round)
+  {
+    // Register next the submodel sharing the most posed views with the merged scene
+    std::size_t best = submodels.size();
+    std::size_t bestNbCommon = 0;
+    for(std::size_t i = 0; i < submodels.size(); ++i)
+    {
+      if(registered[i])
+        continue;
+      std::vector<IndexT> commonViews;
+      getCommonViewsWithPoses(submodels[i], _sfm_data, commonViews);
+      if(best == submodels.size() || commonViews.size() > bestNbCommon)
+      {
+        best = i;
+        bestNbCommon = commonViews.size();
+      }
+    }
+    if(best == submodels.size() || bestNbCommon < 2)
+    {
+      ALICEVISION_LOG_WARNING("ReconstructionEngine_partitionedSfM: not enough common poses to register the remaining submodels.");
+      return false;
+    }
+
+    double S;
+    Mat3 R;
+    Vec3 t;
+    if(!computeSimilarity(submodels[best], _sfm_data, &S, &R, &t))
+    {
+      ALICEVISION_LOG_WARNING("ReconstructionEngine_partitionedSfM: similarity estimation failed for submodel #" << best << ".");
+      return false;
+    }
+    applyTransform(submodels[best], S, R, t);
+
+    registered[best] = true;
+    importSubmodel(submodels[best]);
+  }
+  return true;
+}
+
+bool ReconstructionEngine_partitionedSfM::jointBundleAdjustment()
+{
+  BundleAdjustmentCeres::BA_options options;
+  options.setSolverProfile(BA_SOLVER_AUTO, _sfm_data);
+  BundleAdjustmentCeres bundleAdjustment(options);
+
+  BA_Refine refineOptions = BA_REFINE_ROTATION | BA_REFINE_TRANSLATION | BA_REFINE_STRUCTURE;
+  if(!_bFixedIntrinsics)
+    refineOptions |= BA_REFINE_INTRINSICS_ALL;
+  return bundleAdjustment.Adjust(_sfm_data, refineOptions);
+}
+
+bool ReconstructionEngine_partitionedSfM::Process()
+{
+  if(!computeClusters())
+    return false;
+
+  // The clusters are reconstructed one after the other: the sequential engine
+  // already spreads each reconstruction on all the cores. processCluster() is
+  // public, so a driver can also distribute the clusters on separate jobs.
+  std::vector<SfMData> submodels(_clusters.size());
+  for(std::size_t i = 0; i < _clusters.size(); ++i)
+  {
+    if(!processCluster(i, submodels[i]))
+      return false;
+  }
+
+  if(!mergeSubmodels(submodels))
+    return false;
+
+  // Joint bundle adjustment of the merged scene to dissolve the seams between
+  // the submodels
+  return jointBundleAdjustment();
+}
+
+} // namespace sfm
+} // namespace aliceVision
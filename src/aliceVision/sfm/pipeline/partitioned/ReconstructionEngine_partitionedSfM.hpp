@@ -0,0 +1,131 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/sfm/pipeline/ReconstructionEngine.hpp>
+#include <aliceVision/feature/FeaturesPerView.hpp>
+#include <aliceVision/matching/IndMatch.hpp>
+
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace sfm {
+
+/**
+ * @brief Partition-and-merge SfM Pipeline Reconstruction Engine.
+ *
+ * The view graph is clustered along its track covisibility, each cluster is
+ * reconstructed independently with ReconstructionEngine_sequentialSfM, and the
+ * submodels are merged back with a similarity alignment on the views shared
+ * between the clusters, followed by a joint bundle adjustment.
+ *
+ * Because the global bundle adjustment frequency of the sequential pipeline
+ * grows with the scene, keeping every incremental reconstruction bounded by
+ * the cluster size makes the total cost roughly linear in the number of views.
+ * Process() runs the clusters one after the other in this process (each
+ * sequential engine already spreads its work on all the cores); computeClusters()
+ * and processCluster() are exposed so a driver can also distribute the clusters
+ * on separate jobs and merge the saved submodels afterwards.
+ */
+class ReconstructionEngine_partitionedSfM : public ReconstructionEngine
+{
+public:
+
+  ReconstructionEngine_partitionedSfM(const SfMData& sfmData,
+                                      const std::string& soutDirectory);
+
+  void setFeatures(feature::FeaturesPerView* featuresPerView)
+  {
+    _featuresPerView = featuresPerView;
+  }
+
+  void setMatches(matching::PairwiseMatches* pairwiseMatches)
+  {
+    _pairwiseMatches = pairwiseMatches;
+  }
+
+  /// Maximum number of views reconstructed together in one cluster
+  void setMaxClusterSize(std::size_t maxClusterSize)
+  {
+    _maxClusterSize = maxClusterSize;
+  }
+
+  /// Number of views shared with the previous clusters, used to align the submodels
+  void setClusterOverlap(std::size_t clusterOverlap)
+  {
+    _clusterOverlap = clusterOverlap;
+  }
+
+  /**
+   * @brief Partition the view graph into covisibility clusters.
+   *
+   * The edge weight between two matched views is their number of common
+   * tracks. Each cluster is grown greedily from the most connected unassigned
+   * view, then extended with the views of the previous clusters it is the most
+   * covisible with, so that consecutive submodels share enough poses for the
+   * similarity alignment of the merge step.
+   *
+   * @return true if at least one cluster is found
+   */
+  bool computeClusters();
+
+  /// Number of clusters found by computeClusters()
+  std::size_t getNbClusters() const { return _clusters.size(); }
+
+  /// Views of one cluster (the trailing views are the ones shared with previous clusters)
+  const std::vector<IndexT>& getCluster(std::size_t i) const { return _clusters.at(i); }
+
+  /**
+   * @brief Reconstruct one cluster with the sequential pipeline.
+   *
+   * The cluster scene uses the input views and its own copy of the intrinsics;
+   * the matches are restricted to the pairs internal to the cluster. The
+   * outputs of the reconstruction are written in a "cluster_<i>" subfolder of
+   * the engine output directory.
+   *
+   * @param[in] i index of the cluster to reconstruct
+   * @param[out] outSubmodel the reconstructed submodel
+   * @return true if the cluster reconstruction succeeds
+   */
+  bool processCluster(std::size_t i, SfMData& outSubmodel);
+
+  /**
+   * @brief Merge the submodels into the internal scene.
+   *
+   * The largest submodel defines the reference frame; the others are brought
+   * into it one by one with the similarity estimated on their common posed
+   * views (sfm::computeSimilarity), starting each time from the submodel with
+   * the strongest overlap with the merged scene. Landmarks are re-indexed on
+   * the way as the track ids are local to each cluster.
+   *
+   * @param[in,out] submodels the aligned cluster reconstructions, modified in place
+   * @return true if every submodel is registered in the merged scene
+   */
+  bool mergeSubmodels(std::vector<SfMData>& submodels);
+
+  /// Cluster, reconstruct, merge and run the joint bundle adjustment
+  virtual bool Process();
+
+private:
+
+  /// Refine the merged scene with a joint bundle adjustment
+  bool jointBundleAdjustment();
+
+  //-- Data provider
+  feature::FeaturesPerView* _featuresPerView = nullptr;
+  matching::PairwiseMatches* _pairwiseMatches = nullptr;
+
+  //-- Parameters
+  std::size_t _maxClusterSize = 500;
+  std::size_t _clusterOverlap = 5;
+
+  /// View ids of each cluster, overlap views with previous clusters at the end
+  std::vector<std::vector<IndexT>> _clusters;
+};
+
+} // namespace sfm
+} // namespace aliceVision
@@ -0,0 +1,116 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/feature/imageDescriberCommon.hpp>
+#include <aliceVision/sfm/utils/statistics.hpp>
+#include <aliceVision/sfm/utils/syntheticScene.hpp>
+#include <aliceVision/sfm/sfm.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+
+
+#define BOOST_TEST_MODULE PARTITIONED_SFM
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::camera;
+using namespace aliceVision::geometry;
+using namespace aliceVision::sfm;
+
+// Test summary:
+// - Create features points and matching from the synthetic dataset
+// - Init a SfMData scene VIew and Intrinsic from a synthetic dataset
+// - Perform the partitioned SfM on the data, with a cluster size small enough
+//   to force several clusters
+// - Assert that:
+//   - the view graph is split in several clusters,
+//   - every pose is recovered in the merged scene,
+//   - mean residual error is below the gaussian noise added to observation.
+
+BOOST_AUTO_TEST_CASE(PARTITIONED_SFM_Known_Intrinsics)
+{
+  const int nviews = 9;
+  const int npoints = 128;
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  // Translate the input dataset to a SfMData scene
+  const SfMData sfmData = getInputScene(d, config, PINHOLE_CAMERA);
+
+  // Remove poses and structure
+  SfMData sfmData2 = sfmData;
+  sfmData2.GetPoses().clear();
+  sfmData2.structure.clear();
+
+  ReconstructionEngine_partitionedSfM sfmEngine(sfmData2, "./");
+
+  // Add a tiny noise in 2D observations to make data more realistic
+  std::normal_distribution<double> distribution(0.0,0.5);
+
+  // Configure the featuresPerView & the matches_provider from the synthetic dataset
+  feature::FeaturesPerView featuresPerView;
+  generateSyntheticFeatures(featuresPerView, feature::EImageDescriberType::UNKNOWN, sfmData, distribution);
+
+  matching::PairwiseMatches pairwiseMatches;
+  generateSyntheticMatches(pairwiseMatches, sfmData, feature::EImageDescriberType::UNKNOWN);
+
+  // Configure data provider (Features and Matches)
+  sfmEngine.setFeatures(&featuresPerView);
+  sfmEngine.setMatches(&pairwiseMatches);
+
+  // Configure reconstruction parameters: force several clusters
+  sfmEngine.Set_bFixedIntrinsics(true);
+  sfmEngine.setMaxClusterSize(4);
+  sfmEngine.setClusterOverlap(2);
+
+  BOOST_CHECK (sfmEngine.Process());
+  BOOST_CHECK_GT(sfmEngine.getNbClusters(), 1);
+
+  const double dResidual = RMSE(sfmEngine.Get_SfMData());
+  ALICEVISION_LOG_DEBUG("RMSE residual: " << dResidual);
+  BOOST_CHECK_LT(dResidual, 0.5);
+  BOOST_CHECK_EQUAL(sfmEngine.Get_SfMData().GetPoses().size(), nviews);
+}
+
+// The clustering alone: every matched view must be assigned to a cluster and
+// the clusters must respect the size limit (overlap views excepted)
+BOOST_AUTO_TEST_CASE(PARTITIONED_SFM_Clustering_Covers_The_Views)
+{
+  const int nviews = 12;
+  const int npoints = 64;
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+  const SfMData sfmData = getInputScene(d, config, PINHOLE_CAMERA);
+
+  std::normal_distribution<double> distribution(0.0,0.5);
+  feature::FeaturesPerView featuresPerView;
+  generateSyntheticFeatures(featuresPerView, feature::EImageDescriberType::UNKNOWN, sfmData, distribution);
+  matching::PairwiseMatches pairwiseMatches;
+  generateSyntheticMatches(pairwiseMatches, sfmData, feature::EImageDescriberType::UNKNOWN);
+
+  const std::size_t maxClusterSize = 5;
+  const std::size_t clusterOverlap = 2;
+
+  ReconstructionEngine_partitionedSfM sfmEngine(sfmData, "./");
+  sfmEngine.setFeatures(&featuresPerView);
+  sfmEngine.setMatches(&pairwiseMatches);
+  sfmEngine.setMaxClusterSize(maxClusterSize);
+  sfmEngine.setClusterOverlap(clusterOverlap);
+
+  BOOST_CHECK(sfmEngine.computeClusters());
+  BOOST_CHECK_GT(sfmEngine.getNbClusters(), 1);
+
+  std::set<IndexT> coveredViews;
+  for(std::size_t i = 0; i < sfmEngine.getNbClusters(); ++i)
+  {
+    const std::vector<IndexT>& cluster = sfmEngine.getCluster(i);
+    BOOST_CHECK_LE(cluster.size(), maxClusterSize + clusterOverlap);
+    coveredViews.insert(cluster.begin(), cluster.end());
+  }
+  BOOST_CHECK_EQUAL(coveredViews.size(), nviews);
+}
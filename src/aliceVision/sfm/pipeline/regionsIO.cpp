@@ -5,6 +5,8 @@
 
 #include "regionsIO.hpp"
 
+#include <aliceVision/system/MemoryInfo.hpp>
+
 #include <boost/progress.hpp>
 #include <boost/filesystem.hpp>
 
@@ -16,15 +18,98 @@ namespace fs = boost::filesystem;
 namespace aliceVision {
 namespace sfm {
 
+namespace {
+
+/// Replace float SIFT regions by their unsigned char quantization, see
+/// feature::quantizeRegionsToUChar. Other region types are left untouched.
+void quantizeIfFloatSift(std::unique_ptr<feature::Regions>& regionsPtr)
+{
+  const feature::SIFT_Float_Regions* floatRegions = dynamic_cast<const feature::SIFT_Float_Regions*>(regionsPtr.get());
+  if(floatRegions != nullptr)
+    regionsPtr = feature::quantizeRegionsToUChar(*floatRegions);
+}
+
+/// Replace float SIFT regions by their half precision conversion, see
+/// feature::convertRegionsToHalf. Other region types are left untouched.
+void halfIfFloatSift(std::unique_ptr<feature::Regions>& regionsPtr)
+{
+  const feature::SIFT_Float_Regions* floatRegions = dynamic_cast<const feature::SIFT_Float_Regions*>(regionsPtr.get());
+  if(floatRegions != nullptr)
+    regionsPtr = feature::convertRegionsToHalf(*floatRegions);
+}
+
+/// Apply the requested on-load descriptor conversion; the quantization has
+/// priority as it is the most compact form
+void convertFloatDescriptors(std::unique_ptr<feature::Regions>& regionsPtr,
+                             bool quantizeFloatDescriptors,
+                             bool halfFloatDescriptors)
+{
+  if(quantizeFloatDescriptors)
+    quantizeIfFloatSift(regionsPtr);
+  else if(halfFloatDescriptors)
+    halfIfFloatSift(regionsPtr);
+}
+
+} // namespace
+
 std::unique_ptr<feature::Regions> loadRegions(const std::vector<std::string>& folders,
                                               IndexT viewId,
-                                              const feature::ImageDescriber& imageDescriber)
+                                              const feature::ImageDescriber& imageDescriber,
+                                              bool useMappedDescriptors,
+                                              const feature::RegionsPackSet* packs,
+                                              bool quantizeFloatDescriptors,
+                                              const feature::SharedRegionsStore* sharedStore,
+                                              bool halfFloatDescriptors)
 {
   assert(!folders.empty());
 
   const std::string imageDescriberTypeName = feature::EImageDescriberType_enumToString(imageDescriber.getDescriberType());
   const std::string basename = std::to_string(viewId);
 
+  if(sharedStore != nullptr)
+  {
+    std::unique_ptr<feature::Regions> regionsPtr;
+    imageDescriber.Allocate(regionsPtr);
+
+    try
+    {
+      if(sharedStore->loadRegions(viewId, imageDescriberTypeName, *regionsPtr, useMappedDescriptors))
+      {
+        convertFloatDescriptors(regionsPtr, quantizeFloatDescriptors, halfFloatDescriptors);
+
+        ALICEVISION_LOG_TRACE("Region count: " << regionsPtr->RegionCount());
+        return regionsPtr;
+      }
+    }
+    catch(const std::exception& e)
+    {
+      // fall back to the packs and per-view files below
+      ALICEVISION_LOG_WARNING("Invalid " << imageDescriberTypeName << " shared memory regions for the view "
+                              << basename << " : " << e.what());
+    }
+  }
+
+  if(packs != nullptr && packs->hasView(viewId))
+  {
+    std::unique_ptr<feature::Regions> regionsPtr;
+    imageDescriber.Allocate(regionsPtr);
+
+    try
+    {
+      packs->loadRegions(viewId, *regionsPtr);
+    }
+    catch(const std::exception& e)
+    {
+      ALICEVISION_LOG_ERROR("Invalid " << imageDescriberTypeName << " pack regions for the view " << basename << " : " << e.what());
+      throw std::runtime_error(e.what());
+    }
+
+    convertFloatDescriptors(regionsPtr, quantizeFloatDescriptors, halfFloatDescriptors);
+
+    ALICEVISION_LOG_TRACE("Region count: " << regionsPtr->RegionCount());
+    return regionsPtr;
+  }
+
   std::string featFilename;
   std::string descFilename;
 
@@ -51,7 +136,10 @@ std::unique_ptr<feature::Regions> loadRegions(const std::vector<std::string>& fo
 
   try
   {
-    regionsPtr->Load(featFilename, descFilename);
+    if(useMappedDescriptors)
+      regionsPtr->LoadMapped(featFilename, descFilename);
+    else
+      regionsPtr->Load(featFilename, descFilename);
   }
   catch(const std::exception& e)
   {
@@ -65,19 +153,41 @@ std::unique_ptr<feature::Regions> loadRegions(const std::vector<std::string>& fo
     throw std::runtime_error(e.what());
   }
 
+  convertFloatDescriptors(regionsPtr, quantizeFloatDescriptors, halfFloatDescriptors);
+
   ALICEVISION_LOG_TRACE("Region count: " << regionsPtr->RegionCount());
   return regionsPtr;
 }
 
 std::unique_ptr<feature::Regions> loadFeatures(const std::vector<std::string>& folders,
                                               IndexT viewId,
-                                              const feature::ImageDescriber& imageDescriber)
+                                              const feature::ImageDescriber& imageDescriber,
+                                              const feature::RegionsPackSet* packs)
 {
   assert(!folders.empty());
 
   const std::string imageDescriberTypeName = feature::EImageDescriberType_enumToString(imageDescriber.getDescriberType());
   const std::string basename = std::to_string(viewId);
 
+  if(packs != nullptr && packs->hasView(viewId))
+  {
+    std::unique_ptr<feature::Regions> regionsPtr;
+    imageDescriber.Allocate(regionsPtr);
+
+    try
+    {
+      packs->loadFeatures(viewId, *regionsPtr);
+    }
+    catch(const std::exception& e)
+    {
+      ALICEVISION_LOG_ERROR("Invalid " << imageDescriberTypeName << " pack features for the view " << basename << " : " << e.what());
+      throw std::runtime_error(e.what());
+    }
+
+    ALICEVISION_LOG_TRACE("Feature count: " << regionsPtr->RegionCount());
+    return regionsPtr;
+  }
+
   std::string featFilename;
 
   for(const std::string& folder : folders)
@@ -118,7 +228,11 @@ bool loadRegionsPerView(feature::RegionsPerView& regionsPerView,
             const SfMData& sfmData,
             const std::string& folder,
             const std::vector<feature::EImageDescriberType>& imageDescriberTypes,
-            const std::set<IndexT>& viewIdFilter)
+            const std::set<IndexT>& viewIdFilter,
+            bool useMappedDescriptors,
+            bool quantizeFloatDescriptors,
+            const feature::SharedRegionsStore* sharedStore,
+            bool halfFloatDescriptors)
 {
   std::vector<std::string> featuresFolders = sfmData.getFeaturesFolders();
   featuresFolders.emplace_back(folder);
@@ -130,8 +244,14 @@ bool loadRegionsPerView(feature::RegionsPerView& regionsPerView,
   std::vector< std::unique_ptr<feature::ImageDescriber> > imageDescribers;
   imageDescribers.resize(imageDescriberTypes.size());
 
+  // one pack set per describer type, shared by the loading threads
+  std::vector<feature::RegionsPackSet> regionsPacks(imageDescriberTypes.size());
+
   for(std::size_t i =0; i < imageDescriberTypes.size(); ++i)
+  {
     imageDescribers[i] = createImageDescriber(imageDescriberTypes[i]);
+    regionsPacks[i].open(featuresFolders, feature::EImageDescriberType_enumToString(imageDescriberTypes[i]));
+  }
 
 #pragma omp parallel num_threads(3)
  for (auto iter = sfmData.GetViews().begin();
@@ -143,7 +263,7 @@ bool loadRegionsPerView(feature::RegionsPerView& regionsPerView,
      {
        if(viewIdFilter.empty() || viewIdFilter.find(iter->second.get()->getViewId()) != viewIdFilter.end())
        {
-         std::unique_ptr<feature::Regions> regionsPtr = loadRegions(featuresFolders, iter->second.get()->getViewId(), *imageDescribers[i]);
+         std::unique_ptr<feature::Regions> regionsPtr = loadRegions(featuresFolders, iter->second.get()->getViewId(), *imageDescribers[i], useMappedDescriptors, &regionsPacks[i], quantizeFloatDescriptors, sharedStore, halfFloatDescriptors);
 
          if(regionsPtr)
          {
@@ -165,6 +285,40 @@ bool loadRegionsPerView(feature::RegionsPerView& regionsPerView,
 }
 
 
+void setupLazyRegionsPerView(feature::RegionsPerView& regionsPerView,
+                             const SfMData& sfmData,
+                             const std::string& folder,
+                             const std::vector<feature::EImageDescriberType>& imageDescriberTypes,
+                             std::size_t maxMemoryBytes)
+{
+  std::vector<std::string> featuresFolders = sfmData.getFeaturesFolders();
+  featuresFolders.emplace_back(folder);
+
+  if(maxMemoryBytes == 0)
+    maxMemoryBytes = system::getMemoryInfo().freeRam / 2;
+
+  // the describers are shared by the loader, which is not thread-safe anyway
+  auto imageDescribers = std::make_shared<std::vector<std::unique_ptr<feature::ImageDescriber>>>();
+  imageDescribers->resize(imageDescriberTypes.size());
+
+  // one pack set per describer type, kept open for the lifetime of the loader
+  auto regionsPacks = std::make_shared<std::vector<feature::RegionsPackSet>>(imageDescriberTypes.size());
+
+  for(std::size_t i = 0; i < imageDescriberTypes.size(); ++i)
+  {
+    (*imageDescribers)[i] = createImageDescriber(imageDescriberTypes[i]);
+    (*regionsPacks)[i].open(featuresFolders, feature::EImageDescriberType_enumToString(imageDescriberTypes[i]));
+  }
+
+  regionsPerView.setLazyLoader(
+    [featuresFolders, imageDescriberTypes, imageDescribers, regionsPacks](IndexT viewId, feature::MapRegionsPerDesc& outRegions)
+    {
+      for(std::size_t i = 0; i < imageDescriberTypes.size(); ++i)
+        outRegions[imageDescriberTypes[i]] = loadRegions(featuresFolders, viewId, *(*imageDescribers)[i], false, &(*regionsPacks)[i]);
+    },
+    maxMemoryBytes);
+}
+
 bool loadFeaturesPerView(feature::FeaturesPerView& featuresPerView,
                       const SfMData& sfmData,
                       const std::string& folder,
@@ -181,9 +335,23 @@ bool loadFeaturesPerView(feature::FeaturesPerView& featuresPerView,
   std::vector< std::unique_ptr<feature::ImageDescriber> > imageDescribers;
   imageDescribers.resize(imageDescriberTypes.size());
 
+  // one pack set per describer type, shared by the loading threads
+  std::vector<feature::RegionsPackSet> regionsPacks(imageDescriberTypes.size());
+
   for(std::size_t i =0; i < imageDescriberTypes.size(); ++i)
   {
     imageDescribers[i] = createImageDescriber(imageDescriberTypes[i]);
+    regionsPacks[i].open(featuresFolders, feature::EImageDescriberType_enumToString(imageDescriberTypes[i]));
+  }
+
+  // Pre-create every (view, describerType) entry of the output container, so
+  // the loading threads below fill disjoint pre-existing slots and never
+  // mutate the maps concurrently: no lock is needed around the insertions.
+  for(const auto& viewIt : sfmData.GetViews())
+  {
+    feature::MapFeaturesPerDesc& viewFeatures = featuresPerView.getData()[viewIt.second.get()->getViewId()];
+    for(const feature::EImageDescriberType descType : imageDescriberTypes)
+      viewFeatures[descType];
   }
 
 #pragma omp parallel
@@ -194,14 +362,13 @@ bool loadFeaturesPerView(feature::FeaturesPerView& featuresPerView,
     {
       for(std::size_t i = 0; i < imageDescriberTypes.size(); ++i)
       {
-        std::unique_ptr<feature::Regions> regionsPtr = loadFeatures(featuresFolders, iter->second.get()->getViewId(), *imageDescribers[i]);
+        std::unique_ptr<feature::Regions> regionsPtr = loadFeatures(featuresFolders, iter->second.get()->getViewId(), *imageDescribers[i], &regionsPacks[i]);
+
+        // save loaded Features as PointFeature, in the slot created above
+        featuresPerView.getData().at(iter->second.get()->getViewId()).at(imageDescriberTypes[i]) = regionsPtr->GetRegionsPositions();
 
 #pragma omp critical
-        {
-          // save loaded Features as PointFeature
-          featuresPerView.addFeatures(iter->second.get()->getViewId(), imageDescriberTypes[i], regionsPtr->GetRegionsPositions());
-          ++my_progress_bar;
-        }
+        ++my_progress_bar;
       }
     }
   }
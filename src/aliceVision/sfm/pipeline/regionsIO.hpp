@@ -9,6 +9,8 @@
 #include <aliceVision/sfm/SfMData.hpp>
 #include <aliceVision/feature/ImageDescriber.hpp>
 #include <aliceVision/feature/imageDescriberCommon.hpp>
+#include <aliceVision/feature/RegionsPack.hpp>
+#include <aliceVision/feature/SharedRegionsStore.hpp>
 #include <aliceVision/feature/RegionsPerView.hpp>
 #include <aliceVision/feature/FeaturesPerView.hpp>
 
@@ -22,18 +24,35 @@ namespace sfm {
  * @param[in] folders The list of featureFolders
  * @param[in] viewId The view id
  * @param[in] imageDescriber The imageDescriber type
+ * @param[in] useMappedDescriptors If true, the descriptors are memory-mapped
+ * from the .desc file instead of being copied in memory (read-only regions).
+ * Views stored in a pack always use a regular copy.
+ * @param[in] packs Optional pack set (see RegionsPack.hpp): views found in a
+ * pack are read from it instead of per-view .feat/.desc files.
+ * @param[in] quantizeFloatDescriptors If true, SIFT_FLOAT descriptors are
+ * quantized to unsigned char on load, so they are matched with the unsigned
+ * char kernels (see feature::quantizeRegionsToUChar).
+ * @param[in] sharedStore Optional shared memory store (see
+ * SharedRegionsStore.hpp): views published in it are attached from shared
+ * memory, the others fall back to the packs and per-view files.
+ * @param[in] halfFloatDescriptors If true, SIFT_FLOAT descriptors are
+ * converted to half precision on load, so they are matched with the half
+ * precision kernels (see feature::convertRegionsToHalf); ignored when
+ * quantizeFloatDescriptors is set.
  * @return loaded Regions
  */
-std::unique_ptr<feature::Regions> loadRegions(const std::vector<std::string>& folders, IndexT viewId, const feature::ImageDescriber& imageDescriber);
+std::unique_ptr<feature::Regions> loadRegions(const std::vector<std::string>& folders, IndexT viewId, const feature::ImageDescriber& imageDescriber, bool useMappedDescriptors = false, const feature::RegionsPackSet* packs = nullptr, bool quantizeFloatDescriptors = false, const feature::SharedRegionsStore* sharedStore = nullptr, bool halfFloatDescriptors = false);
 
 /**
  * @brief Load Features for one view.
  * @param[in] folders The list of featureFolders
  * @param[in] viewId The view id
  * @param[in] imageDescriber The imageDescriber type
+ * @param[in] packs Optional pack set (see RegionsPack.hpp): views found in a
+ * pack are read from it instead of per-view .feat files.
  * @return loaded Regions (with only features)
  */
-std::unique_ptr<feature::Regions> loadFeatures(const std::vector<std::string>& folders, IndexT viewId, const feature::ImageDescriber& imageDescriber);
+std::unique_ptr<feature::Regions> loadFeatures(const std::vector<std::string>& folders, IndexT viewId, const feature::ImageDescriber& imageDescriber, const feature::RegionsPackSet* packs = nullptr);
 
 /**
  * @brief Load Regions (Features & Descriptors) for each view of the provided SfMData container.
@@ -42,13 +61,44 @@ std::unique_ptr<feature::Regions> loadFeatures(const std::vector<std::string>& f
  * @param[in] folder The feature Folder
  * @param[in] imageDescriberType The imageDescriber type
  * @param[in] filter To load Regions only for a sub-set of the views contained in the sfmData
+ * @param[in] useMappedDescriptors If true, the descriptors are memory-mapped
+ * from the .desc files instead of being copied in memory (read-only regions).
+ * @param[in] quantizeFloatDescriptors If true, SIFT_FLOAT descriptors are
+ * quantized to unsigned char on load (see feature::quantizeRegionsToUChar).
+ * @param[in] sharedStore Optional shared memory store (see
+ * SharedRegionsStore.hpp): views published in it are attached from shared
+ * memory, the others fall back to the packs and per-view files.
+ * @param[in] halfFloatDescriptors If true, SIFT_FLOAT descriptors are
+ * converted to half precision on load (see feature::convertRegionsToHalf);
+ * ignored when quantizeFloatDescriptors is set.
  * @return true if the regions are correctlty loaded
  */
 bool loadRegionsPerView(feature::RegionsPerView& regionsPerView,
                         const SfMData& sfmData,
                         const std::string& folders,
                         const std::vector<feature::EImageDescriberType>& imageDescriberTypes,
-                        const std::set<IndexT>& filter = std::set<IndexT>());
+                        const std::set<IndexT>& filter = std::set<IndexT>(),
+                        bool useMappedDescriptors = false,
+                        bool quantizeFloatDescriptors = false,
+                        const feature::SharedRegionsStore* sharedStore = nullptr,
+                        bool halfFloatDescriptors = false);
+
+/**
+ * @brief Setup lazy Regions loading for each view of the provided SfMData container.
+ * Nothing is loaded upfront: RegionsPerView faults in the regions of a view on
+ * first access and evicts least-recently-used views against the memory budget.
+ * @param[in,out] regionsPerView
+ * @param[in] sfmData The provided SfMData container
+ * @param[in] folder The feature Folder
+ * @param[in] imageDescriberTypes The imageDescriber types
+ * @param[in] maxMemoryBytes Byte budget for the loaded regions
+ * (0 means half of the currently free RAM, queried from system::MemoryInfo)
+ */
+void setupLazyRegionsPerView(feature::RegionsPerView& regionsPerView,
+                             const SfMData& sfmData,
+                             const std::string& folder,
+                             const std::vector<feature::EImageDescriberType>& imageDescriberTypes,
+                             std::size_t maxMemoryBytes = 0);
 
 /**
  * @brief Load Features for each view of the provided SfMData container.
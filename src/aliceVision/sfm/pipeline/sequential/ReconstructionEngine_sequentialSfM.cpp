@@ -17,10 +17,14 @@
 #include <aliceVision/multiview/triangulation/Triangulation.hpp>
 #include <aliceVision/multiview/triangulation/NViewsTriangulationLORansac.hpp>
 #include <aliceVision/robustEstimation/LORansac.hpp>
+#include <aliceVision/robustEstimation/randSampling.hpp>
 #include <aliceVision/robustEstimation/ScoreEvaluator.hpp>
 #include <aliceVision/graph/connectedComponent.hpp>
+#include <aliceVision/track/trackIO.hpp>
+#include <aliceVision/stl/ArenaAllocator.hpp>
 #include <aliceVision/stl/stl.hpp>
 #include <aliceVision/system/Timer.hpp>
+#include <aliceVision/system/Trace.hpp>
 #include <aliceVision/system/cpu.hpp>
 #include <aliceVision/system/MemoryInfo.hpp>
 #include <aliceVision/config.hpp>
@@ -34,6 +38,7 @@
 #include <tuple>
 #include <iostream>
 #include <algorithm>
+#include <numeric>
 
 #ifdef _MSC_VER
 #pragma warning( once : 4267 ) //warning C4267: 'argument' : conversion from 'size_t' to 'const int', possible loss of data
@@ -136,6 +141,10 @@ ReconstructionEngine_sequentialSfM::ReconstructionEngine_sequentialSfM(
     _htmlDocStream->pushInfo("Dataset info:");
     _htmlDocStream->pushInfo("Views count: " + htmlDocument::toString( sfm_data.GetViews().size()) + "<br>");
   }
+
+  // collect a performance trace of the reconstruction (written by exportStatistics)
+  system::Trace::instance().setOutputFilepath(
+    stlplus::create_filespec(_sOutDirectory, "sfm_trace", ".json"));
 }
 
 bool ReconstructionEngine_sequentialSfM::Process()
@@ -180,10 +189,12 @@ void ReconstructionEngine_sequentialSfM::initializePyramidScoring()
   if(_pyramidWeights.size() != _pyramidDepth)
   {
     _pyramidWeights.resize(_pyramidDepth);
+    _pyramidNbCells = 0;
     std::size_t maxWeight = 0;
     for(std::size_t level = 0; level < _pyramidDepth; ++level)
     {
       std::size_t nbCells = Square(std::pow(_pyramidBase, level+1));
+      _pyramidNbCells += nbCells;
       // We use a different weighting strategy than [Schonberger 2016].
       // They use w = 2^l with l={1...L} (even if there is a typo in the text where they say to use w=2^{2*l}.
       // We prefer to give more importance to the first levels of the pyramid, so:
@@ -193,16 +204,39 @@ void ReconstructionEngine_sequentialSfM::initializePyramidScoring()
     }
     _pyramidThreshold = maxWeight * 0.2;
   }
+  // restart the incremental score maintenance from an empty reconstruction
+  _viewPyramidScores.clear();
+  _scoredReconstructedTracks.reset(0);
 }
 
 std::size_t ReconstructionEngine_sequentialSfM::fuseMatchesIntoTracks()
 {
-  // compute tracks from matches
-  track::TracksBuilder tracksBuilder;
-
+  const system::TraceSpan traceSpan("fuseMatchesIntoTracks");
+
+  // list of features matches for each couple of images
+  const aliceVision::matching::PairwiseMatches & map_Matches = *_pairwiseMatches;
+
+  // The fused tracks only depend on the matches content and on the fusion
+  // parameters folded into the key below (the features are produced together
+  // with the matches, so the matches hash stands in for them too). A cache
+  // keyed by this hash can be reloaded instead of re-running the fusion when
+  // iterating on the reconstruction parameters.
+  std::uint64_t tracksCacheKey = track::hashPairwiseMatches(map_Matches);
+  tracksCacheKey = track::hashCombine(tracksCacheKey, _minInputTrackLength);
+  tracksCacheKey = track::hashCombine(tracksCacheKey, _pyramidBase);
+  tracksCacheKey = track::hashCombine(tracksCacheKey, _pyramidDepth);
+  const std::string tracksCacheFilename = stlplus::create_filespec(_sOutDirectory, "tracks.cache.bin");
+
+  if(track::loadTracksCache(tracksCacheFilename, tracksCacheKey,
+                            _map_tracks, _map_tracksPerView, _map_featsPyramidPerView))
+  {
+    ALICEVISION_LOG_INFO("Tracks reloaded from the cache: " << tracksCacheFilename);
+  }
+  else
   {
-    // list of features matches for each couple of images
-    const aliceVision::matching::PairwiseMatches & map_Matches = *_pairwiseMatches;
+    // compute tracks from matches, with the flat union-find builder:
+    // track fusion is the biggest memory spike of the sequential pipeline
+    track::FlatTracksBuilder tracksBuilder;
     ALICEVISION_LOG_DEBUG("Track building");
 
     tracksBuilder.Build(map_Matches);
@@ -218,24 +252,28 @@ std::size_t ReconstructionEngine_sequentialSfM::fuseMatchesIntoTracks()
     computeTracksPyramidPerView(
             _map_tracksPerView, _map_tracks, _sfm_data.views, *_featuresPerView, _pyramidBase, _pyramidDepth, _map_featsPyramidPerView);
 
-    // display stats
-    {
-      std::set<size_t> set_imagesId;
-      track::TracksUtilsMap::ImageIdInTracks(_map_tracksPerView, set_imagesId);
+    if(!track::saveTracksCache(tracksCacheFilename, tracksCacheKey,
+                               _map_tracks, _map_tracksPerView, _map_featsPyramidPerView))
+      ALICEVISION_LOG_WARNING("Unable to write the track cache: " << tracksCacheFilename);
+  }
+
+  // display stats
+  {
+    std::set<size_t> set_imagesId;
+    track::TracksUtilsMap::ImageIdInTracks(_map_tracksPerView, set_imagesId);
 
-      ALICEVISION_LOG_INFO("Fuse matches into tracks: " << std::endl
-        << "\t- # tracks: " << tracksBuilder.NbTracks() << std::endl
-        << "\t- # images in tracks: " << set_imagesId.size());
+    ALICEVISION_LOG_INFO("Fuse matches into tracks: " << std::endl
+      << "\t- # tracks: " << _map_tracks.size() << std::endl
+      << "\t- # images in tracks: " << set_imagesId.size());
 
-      std::map<size_t, size_t> map_Occurence_TrackLength;
-      track::TracksUtilsMap::TracksLength(_map_tracks, map_Occurence_TrackLength);
-      ALICEVISION_LOG_INFO("TrackLength, Occurrence");
-      for(const auto& iter: map_Occurence_TrackLength)
-      {
-        // add input tracks histogram
-        _jsonLogTree.add("sfm.inputtracks_histogram." + std::to_string(iter.first), iter.second);
-        ALICEVISION_LOG_INFO("\t" << iter.first << "\t" << iter.second);
-      }
+    std::map<size_t, size_t> map_Occurence_TrackLength;
+    track::TracksUtilsMap::TracksLength(_map_tracks, map_Occurence_TrackLength);
+    ALICEVISION_LOG_INFO("TrackLength, Occurrence");
+    for(const auto& iter: map_Occurence_TrackLength)
+    {
+      // add input tracks histogram
+      _jsonLogTree.add("sfm.inputtracks_histogram." + std::to_string(iter.first), iter.second);
+      ALICEVISION_LOG_INFO("\t" << iter.first << "\t" << iter.second);
     }
   }
   return _map_tracks.size();
@@ -350,18 +388,29 @@ double ReconstructionEngine_sequentialSfM::incrementalReconstruction()
     ++resectionId;
   }
 
+  // with adaptive scheduling the last resection groups may have been skipped:
+  // always close the reconstruction on an adjusted scene
+  if(_useAdaptiveBundleAdjustment && !_viewsPendingBA.empty())
+    adjustScene();
+
   return timer.elapsed();
 }
 
 void ReconstructionEngine_sequentialSfM::updateReconstruction(IndexT resectionId, const std::vector<IndexT>& bestViewIds, std::set<IndexT>& viewIds)
 {
+  const system::TraceSpan traceSpan("updateReconstruction");
+
   auto chrono_start = std::chrono::steady_clock::now();
   bool imageAdded = false;
 
   // get reconstructed views before resection
   const std::set<IndexT> prevReconstructedViews = _sfm_data.getValidViews();
 
-  // add images to the 3D reconstruction
+  // localization / resection of all the candidate views of the group.
+  // each candidate is independent and the scene is read-only until the commit phase.
+  std::vector<ResectionData> resectionDatas(bestViewIds.size());
+  std::vector<char> resectionSucceed(bestViewIds.size(), 0);
+
 #pragma omp parallel for
   for(std::size_t i = 0; i < bestViewIds.size(); ++i)
   {
@@ -370,20 +419,9 @@ void ReconstructionEngine_sequentialSfM::updateReconstruction(IndexT resectionId
 
     if(view.isPartOfRig())
     {
-      // some views can become indirectly localized when the sub-pose becomes defined
+      // some views are already indirectly localized when the sub-pose and pose are defined
       if(_sfm_data.IsPoseAndIntrinsicDefined(view.getViewId()))
-      {
-        ALICEVISION_LOG_DEBUG("Resection of image " << i << " was skipped." << std::endl
-          << "View indirectly localized, sub-pose and pose already defined." << std::endl
-          << "\t- view id: " << viewId << std::endl
-          << "\t- rig id: " << view.getRigId() << std::endl
-          << "\t- sub-pose id: " << view.getSubPoseId());
-
-#pragma omp critical
-        viewIds.erase(viewId);
-
         continue;
-      }
 
       // we cannot localize a view if it is part of an initialized rig with unknown rig Pose
       const bool knownPose = _sfm_data.existsPose(view);
@@ -398,30 +436,51 @@ void ReconstructionEngine_sequentialSfM::updateReconstruction(IndexT resectionId
           << "\t- rig id: " << view.getRigId() << std::endl
           << "\t- sub-pose id: " << view.getSubPoseId());
 
-#pragma omp critical
-        viewIds.erase(viewId);
-
         continue;
       }
     }
 
-    ResectionData newResectionData;
-    bool bResect = computeResection(viewId, newResectionData);
+    resectionSucceed.at(i) = computeResection(viewId, resectionDatas.at(i)) ? 1 : 0;
+  }
 
-#pragma omp critical
+  // commit the successful resections to the scene sequentially, in view id order,
+  // so that the reconstruction does not depend on the thread scheduling.
+  std::vector<std::size_t> commitOrder(bestViewIds.size());
+  std::iota(commitOrder.begin(), commitOrder.end(), 0);
+  std::sort(commitOrder.begin(), commitOrder.end(), [&bestViewIds](std::size_t a, std::size_t b) {
+    return bestViewIds.at(a) < bestViewIds.at(b);
+  });
+
+  for(const std::size_t i : commitOrder)
+  {
+    const IndexT viewId = bestViewIds.at(i);
+    const View& view = *_sfm_data.GetViews().at(viewId);
+
+    viewIds.erase(viewId);
+
+    // some views can become indirectly localized when the sub-pose becomes defined,
+    // possibly by an earlier commit of the same resection group.
+    if(view.isPartOfRig() && _sfm_data.IsPoseAndIntrinsicDefined(viewId))
     {
-      if(bResect)
-      {
-        imageAdded |= bResect;
-        updateScene(viewId, newResectionData);
-        ALICEVISION_LOG_DEBUG("Resection of image " << i << " ( view id: " << viewId << " ) succeed.");
-        _sfm_data.GetViews().at(viewId)->setResectionId(resectionId);
-      }
-      else
-      {
-        ALICEVISION_LOG_DEBUG("Resection of image " << i << " ( view id: " << viewId << " ) was not possible.");
-      }
-      viewIds.erase(viewId);
+      ALICEVISION_LOG_DEBUG("Resection of image " << i << " was skipped." << std::endl
+        << "View indirectly localized, sub-pose and pose already defined." << std::endl
+        << "\t- view id: " << viewId << std::endl
+        << "\t- rig id: " << view.getRigId() << std::endl
+        << "\t- sub-pose id: " << view.getSubPoseId());
+
+      continue;
+    }
+
+    if(resectionSucceed.at(i))
+    {
+      imageAdded = true;
+      updateScene(viewId, resectionDatas.at(i));
+      ALICEVISION_LOG_DEBUG("Resection of image " << i << " ( view id: " << viewId << " ) succeed.");
+      _sfm_data.GetViews().at(viewId)->setResectionId(resectionId);
+    }
+    else
+    {
+      ALICEVISION_LOG_DEBUG("Resection of image " << i << " ( view id: " << viewId << " ) was not possible.");
     }
   }
 
@@ -460,58 +519,41 @@ void ReconstructionEngine_sequentialSfM::updateReconstruction(IndexT resectionId
       // Scene logging as ply for visual debug
       std::ostringstream os;
       os << std::setw(8) << std::setfill('0') << resectionId << "_resection";
-      Save(_sfm_data, stlplus::create_filespec(_sOutDirectory, os.str(), _sfmdataInterFileExtension), _sfmdataInterFilter);
+      if(_sfmdataInterFileDelta)
+      {
+        // write only the changes since the previous intermediate save, the
+        // full snapshots are materialized on demand from the delta sequence
+        if(!_interFileDeltaSaver)
+          _interFileDeltaSaver.reset(new DeltaSaver(
+            stlplus::create_filespec(_sOutDirectory, "sfmdata_inter_base", ".json"), _sfmdataInterFilter));
+        _interFileDeltaSaver->save(_sfm_data);
+      }
+      else
+      {
+        Save(_sfm_data, stlplus::create_filespec(_sOutDirectory, os.str(), _sfmdataInterFileExtension), _sfmdataInterFilter);
+      }
       ALICEVISION_LOG_DEBUG("Save of file " << os.str() << " took " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - chrono_start).count() << " msec.");
     }
 
-    ALICEVISION_LOG_DEBUG("Global Bundle start");
-
-    chrono_start = std::chrono::steady_clock::now();
-    std::size_t bundleAdjustmentIteration = 0;
+    // the local BA graph update needs every view reconstructed since the last
+    // adjustment, not only the current group, when groups have been skipped
+    _viewsPendingBA.insert(newReconstructedViews.begin(), newReconstructedViews.end());
 
-    const std::size_t nbOutliersThreshold = 50;
-    // Perform BA until all point are under the given precision
-    do
+    if(!_useAdaptiveBundleAdjustment || needsBundleAdjustment())
     {
-      auto chrono2_start = std::chrono::steady_clock::now();
-
-      if (_uselocalBundleAdjustment)
-        localBundleAdjustment(newReconstructedViews);
-      else
-        BundleAdjustment(_bFixedIntrinsics);
-
-      ALICEVISION_LOG_DEBUG("Resection index: " << resectionId << ", bundle iteration: " << bundleAdjustmentIteration
-                << " took " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - chrono2_start).count() << " msec.");
-      ++bundleAdjustmentIteration;
+      adjustScene();
     }
-    while(removeOutliers(4.0) > nbOutliersThreshold);
-
-    ALICEVISION_LOG_DEBUG("Bundle adjustment with " << bundleAdjustmentIteration << " iterations took " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - chrono_start).count() << " msec.");
-    chrono_start = std::chrono::steady_clock::now();
-
-    std::set<IndexT> removedPosesId;
-    bool contentRemoved = eraseUnstablePosesAndObservations(this->_sfm_data, _minPointsPerPose, _minTrackLength, &removedPosesId);
-
-    if (_uselocalBundleAdjustment && contentRemoved)
+    else
     {
-      // Get removed VIEWS index
-      std::set<IndexT> removedViewsId;
-      for (const auto& x : _sfm_data.GetViews())
-      {
-        if (removedPosesId.find(x.second->getPoseId()) != removedPosesId.end())
-        {
-          if (!_sfm_data.IsPoseAndIntrinsicDefined(x.second->getViewId()))
-            removedViewsId.insert(x.second->getViewId());
-          else
-            ALICEVISION_LOG_WARNING("The view #" << x.second->getViewId() << " is set as Removed while it is still in the scene.");
-        }
-      }
+      ALICEVISION_LOG_DEBUG("Bundle adjustment skipped by the adaptive scheduling policy ("
+        << _viewsPendingBA.size() << " views pending).");
+    }
 
-      // Remove removed views to the graph
-      _localBA_data->removeViewsToTheGraph(removedViewsId);
-      ALICEVISION_LOG_INFO("Poses removed from the reconstruction: " << removedPosesId);
+    if(_checkpointInterval != 0 &&
+       (resectionId % _checkpointInterval) == 0)
+    {
+      saveCheckpoint(resectionId);
     }
-    ALICEVISION_LOG_DEBUG("eraseUnstablePosesAndObservations took " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - chrono_start).count() << " msec.");
   }
 
   ALICEVISION_LOG_INFO("Update Reconstruction complete: " << std::endl
@@ -519,6 +561,34 @@ void ReconstructionEngine_sequentialSfM::updateReconstruction(IndexT resectionId
      << "\t- # landmarks: " << _sfm_data.GetLandmarks().size());
 }
 
+void ReconstructionEngine_sequentialSfM::saveCheckpoint(IndexT resectionId) const
+{
+  auto chrono_start = std::chrono::steady_clock::now();
+
+  const std::string checkpointFilepath = getCheckpointFilepath(_sOutDirectory);
+  const std::string tmpFilepath = stlplus::create_filespec(_sOutDirectory, "sfm_checkpoint_tmp", ".bin");
+
+  // the complete scene is needed to resume:
+  // the view resection ids give back the remaining view set and the next resection id,
+  // the landmark / track id mapping is recovered by remapLandmarkIdsToTrackIds().
+  if(!Save(_sfm_data, tmpFilepath, ESfMData::ALL))
+  {
+    ALICEVISION_LOG_WARNING("Unable to write the reconstruction checkpoint file: " << tmpFilepath);
+    return;
+  }
+
+  if(stlplus::file_exists(checkpointFilepath))
+    stlplus::file_delete(checkpointFilepath);
+
+  if(!stlplus::file_rename(tmpFilepath, checkpointFilepath))
+  {
+    ALICEVISION_LOG_WARNING("Unable to rename the reconstruction checkpoint file: " << tmpFilepath);
+    return;
+  }
+
+  ALICEVISION_LOG_DEBUG("Checkpoint of resection id " << resectionId << " took " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - chrono_start).count() << " msec.");
+}
+
 void ReconstructionEngine_sequentialSfM::exportStatistics(double reconstructionTime)
 {
   const double residual = RMSE(_sfm_data);
@@ -530,6 +600,16 @@ void ReconstructionEngine_sequentialSfM::exportStatistics(double reconstructionT
     << "\t- elapsed time: " << reconstructionTime << std::endl
     << "\t- residual RMSE: " <<  residual);
 
+  // percentiles from the histogram maintained by the outlier filtering,
+  // no scene scan needed
+  if(!_residualHistogram.empty())
+  {
+    ALICEVISION_LOG_INFO("Residuals of the kept observations:" << std::endl
+      << "\t- median: " << _residualHistogram.percentile(0.5) << std::endl
+      << "\t- 90th percentile: " << _residualHistogram.percentile(0.9) << std::endl
+      << "\t- 99th percentile: " << _residualHistogram.percentile(0.99));
+  }
+
   // residual histogram
   Histogram<double> residualHistogram;
   computeResidualsHistogram(&residualHistogram);
@@ -575,7 +655,7 @@ void ReconstructionEngine_sequentialSfM::exportStatistics(double reconstructionT
   {
     // put nb images, nb poses, nb points
     _jsonLogTree.put("sfm.views", _sfm_data.GetViews().size());
-    _jsonLogTree.put("sfm.validViews", _sfm_data.getValidViews().size());
+    _jsonLogTree.put("sfm.validViews", _sfm_data.nbValidViews());
     _jsonLogTree.put("sfm.poses", _sfm_data.GetPoses().size());
     _jsonLogTree.put("sfm.points", _sfm_data.GetLandmarks().size());
     _jsonLogTree.put("sfm.residual", residual);
@@ -602,91 +682,135 @@ void ReconstructionEngine_sequentialSfM::exportStatistics(double reconstructionT
     // write json on disk
     pt::write_json(stlplus::folder_append_separator(_sOutDirectory) + "stats.json", _jsonLogTree);
   }
+
+  // write the performance trace collected along the reconstruction
+  if(system::Trace::instance().isEnabled() && !system::Trace::instance().save())
+    ALICEVISION_LOG_WARNING("Unable to write the performance trace.");
 }
 
 bool ReconstructionEngine_sequentialSfM::findConnectedViews(
   std::vector<ViewConnectionScore>& out_connectedViews,
-  const std::set<IndexT>& remainingViewIds) const
+  const std::set<IndexT>& remainingViewIds,
+  std::size_t maxConnectedViews) const
 {
   out_connectedViews.clear();
 
   if (remainingViewIds.empty() || _sfm_data.GetLandmarks().empty())
     return false;
 
-  // Collect tracksIds
-  std::set<size_t> reconstructed_trackId;
-  std::transform(_sfm_data.GetLandmarks().begin(), _sfm_data.GetLandmarks().end(),
-                 std::inserter(reconstructed_trackId, reconstructed_trackId.begin()),
-                 stl::RetrieveKey());
+  // Collect the reconstructed tracksIds in a bitset: landmark ids are dense
+  // track ids, so the delta against the previous iteration is a cheap
+  // word-wise comparison
+  track::TrackIdBitset reconstructedTracks;
+  reconstructedTracks.reset(_map_tracks.size());
+  for(const auto& landmarkIt: _sfm_data.GetLandmarks())
+    reconstructedTracks.insert(landmarkIt.first);
 
-  const std::set<IndexT> reconstructedIntrinsics = _sfm_data.getReconstructedIntrinsics();
+  // Fold the tracks reconstructed or removed since the last iteration into the
+  // per-view score accumulators, so the loop below reads the scores directly.
+  updatePyramidScores(reconstructedTracks);
 
-#pragma omp parallel for
-  for(IndexT i = 0; i < remainingViewIds.size(); ++i)
-  {
-    std::set<IndexT>::const_iterator iter = remainingViewIds.cbegin();
-    std::advance(iter, i);
-    const IndexT viewId = *iter;
-    const IndexT intrinsicId = _sfm_data.GetViews().at(viewId)->getIntrinsicId();
-    const bool isIntrinsicsReconstructed = reconstructedIntrinsics.count(intrinsicId);
+  const std::set<IndexT> reconstructedIntrinsics = _sfm_data.getReconstructedIntrinsics();
 
-    // Compute 2D - 3D possible content
-    aliceVision::track::TracksPerView::const_iterator tracksIdsIt = _map_tracksPerView.find(viewId);
-    if(tracksIdsIt == _map_tracksPerView.end())
-      continue;
+  const auto hasHigherScore = [](const ViewConnectionScore& t1, const ViewConnectionScore& t2) {
+    return std::get<2>(t1) > std::get<2>(t2);
+  };
 
-    const aliceVision::track::TrackIdSet& set_tracksIds = tracksIdsIt->second;
-    if (set_tracksIds.empty())
-      continue;
+#pragma omp parallel
+  {
+    // Each thread keeps its own bounded candidate list, organized as a min-heap
+    // on the score so a better candidate replaces the worst kept one in O(log k)
+    // without any synchronization on the shared output.
+    std::vector<ViewConnectionScore> localScores;
 
-    // Check if the view is part of a rig
+#pragma omp for nowait
+    for(IndexT i = 0; i < remainingViewIds.size(); ++i)
     {
-      const View& view = *_sfm_data.views.at(viewId);
+      std::set<IndexT>::const_iterator iter = remainingViewIds.cbegin();
+      std::advance(iter, i);
+      const IndexT viewId = *iter;
+      const IndexT intrinsicId = _sfm_data.GetViews().at(viewId)->getIntrinsicId();
+      const bool isIntrinsicsReconstructed = reconstructedIntrinsics.count(intrinsicId);
+
+      // Compute 2D - 3D possible content
+      aliceVision::track::TracksPerView::const_iterator tracksIdsIt = _map_tracksPerView.find(viewId);
+      if(tracksIdsIt == _map_tracksPerView.end())
+        continue;
+
+      const aliceVision::track::TrackIdSet& set_tracksIds = tracksIdsIt->second;
+      if (set_tracksIds.empty())
+        continue;
 
-      if(view.isPartOfRig())
+      // Check if the view is part of a rig
       {
-        // Some views can become indirectly localized when the sub-pose becomes defined
-        if(_sfm_data.IsPoseAndIntrinsicDefined(view.getViewId()))
+        const View& view = *_sfm_data.views.at(viewId);
+
+        if(view.isPartOfRig())
         {
-          continue;
-        }
+          // Some views can become indirectly localized when the sub-pose becomes defined
+          if(_sfm_data.IsPoseAndIntrinsicDefined(view.getViewId()))
+          {
+            continue;
+          }
 
-        // We cannot localize a view if it is part of an initialized RIG with unknown Rig Pose
-        const bool knownPose = _sfm_data.existsPose(view);
-        const Rig& rig = _sfm_data.getRig(view);
-        const RigSubPose& subpose = rig.getSubPose(view.getSubPoseId());
+          // We cannot localize a view if it is part of an initialized RIG with unknown Rig Pose
+          const bool knownPose = _sfm_data.existsPose(view);
+          const Rig& rig = _sfm_data.getRig(view);
+          const RigSubPose& subpose = rig.getSubPose(view.getSubPoseId());
 
-        if(rig.isInitialized() &&
-           !knownPose &&
-           (subpose.status == ERigSubPoseStatus::UNINITIALIZED))
-        {
-          continue;
+          if(rig.isInitialized() &&
+             !knownPose &&
+             (subpose.status == ERigSubPoseStatus::UNINITIALIZED))
+          {
+            continue;
+          }
         }
       }
+
+      // Read the number of common putative points with the already reconstructed
+      // 3D points, and the image score based on the repartition of these
+      // features in the image, from the incrementally maintained accumulators.
+      std::size_t nbCommonTracks = 0;
+      std::size_t score = 0;
+      const auto viewScoreIt = _viewPyramidScores.find(viewId);
+      if(viewScoreIt != _viewPyramidScores.end())
+      {
+        const ViewPyramidScore& viewScore = viewScoreIt->second;
+        nbCommonTracks = viewScore.nbReconstructedTracks;
+  #ifdef ALICEVISION_NEXTBESTVIEW_WITHOUT_SCORE
+        score = viewScore.nbReconstructedTracks;
+  #else
+        for(std::size_t level = 0; level < _pyramidDepth; ++level)
+          score += viewScore.nbOccupiedCellsPerLevel[level] * _pyramidWeights[level];
+  #endif
+      }
+      if(maxConnectedViews == 0 || localScores.size() < maxConnectedViews)
+      {
+        localScores.emplace_back(viewId, nbCommonTracks, score, isIntrinsicsReconstructed);
+        if(maxConnectedViews != 0)
+          std::push_heap(localScores.begin(), localScores.end(), hasHigherScore);
+      }
+      else if(score > std::get<2>(localScores.front()))
+      {
+        std::pop_heap(localScores.begin(), localScores.end(), hasHigherScore);
+        localScores.back() = ViewConnectionScore(viewId, nbCommonTracks, score, isIntrinsicsReconstructed);
+        std::push_heap(localScores.begin(), localScores.end(), hasHigherScore);
+      }
     }
 
-    // Count the common possible putative point
-    //  with the already 3D reconstructed trackId
-    std::vector<std::size_t> vec_trackIdForResection;
-    vec_trackIdForResection.reserve(set_tracksIds.size());
-    std::set_intersection(set_tracksIds.begin(), set_tracksIds.end(),
-                          reconstructed_trackId.begin(),
-                          reconstructed_trackId.end(),
-                          std::back_inserter(vec_trackIdForResection));
-    // Compute an image score based on the number of matches to the 3D scene
-    // and the repartition of these features in the image.
-    std::size_t score = computeImageScore(viewId, vec_trackIdForResection);
 #pragma omp critical
-    {
-      out_connectedViews.emplace_back(viewId, vec_trackIdForResection.size(), score, isIntrinsicsReconstructed);
-    }
+    out_connectedViews.insert(out_connectedViews.end(), localScores.begin(), localScores.end());
   }
 
-  // Sort by the image score
-  std::sort(out_connectedViews.begin(), out_connectedViews.end(),
-            [](const ViewConnectionScore& t1, const ViewConnectionScore& t2) {
-    return std::get<2>(t1) > std::get<2>(t2);
-  });
+  // Keep the best candidates of the merged per-thread lists, then sort this
+  // small selection by the image score instead of sorting every candidate
+  if(maxConnectedViews != 0 && out_connectedViews.size() > maxConnectedViews)
+  {
+    std::nth_element(out_connectedViews.begin(), out_connectedViews.begin() + maxConnectedViews,
+                     out_connectedViews.end(), hasHigherScore);
+    out_connectedViews.resize(maxConnectedViews);
+  }
+  std::sort(out_connectedViews.begin(), out_connectedViews.end(), hasHigherScore);
   return !out_connectedViews.empty();
 }
 
@@ -694,10 +818,19 @@ bool ReconstructionEngine_sequentialSfM::findNextBestViews(
   std::vector<IndexT> & out_selectedViewIds,
   const std::set<IndexT>& remainingViewIds) const
 {
+  const system::TraceSpan traceSpan("findNextBestViews");
+
   out_selectedViewIds.clear();
   auto chrono_start = std::chrono::steady_clock::now();
+
+  // Limit to a maximum number of cameras added to ensure that
+  // we don't add too much data in one step without bundle adjustment.
+  static const std::size_t maxImagesPerGroup = 30;
+
   std::vector<ViewConnectionScore> vec_viewsScore;
-  if(!findConnectedViews(vec_viewsScore, remainingViewIds))
+  // The selection below never consumes more than the best image plus one
+  // resection group, so only these top candidates are selected and sorted.
+  if(!findConnectedViews(vec_viewsScore, remainingViewIds, maxImagesPerGroup + 1))
   {
     ALICEVISION_LOG_DEBUG("FindConnectedViews does not find connected new views ");
     return false;
@@ -783,10 +916,6 @@ bool ReconstructionEngine_sequentialSfM::findNextBestViews(
     out_selectedViewIds.resize(1);
   }
 
-  // Limit to a maximum number of cameras added to ensure that
-  // we don't add too much data in one step without bundle adjustment.
-  static const std::size_t maxImagesPerGroup = 30;
-
   if(out_selectedViewIds.size() > maxImagesPerGroup)
     out_selectedViewIds.resize(maxImagesPerGroup);
 
@@ -799,6 +928,41 @@ bool ReconstructionEngine_sequentialSfM::findNextBestViews(
   return (!out_selectedViewIds.empty());
 }
 
+/// Try to compute the relative pose of a view pair from a geometric model
+/// cached by the matching step instead of a new robust estimation.
+/// Returns false when no usable prior is available for the pair.
+static bool relativePoseFromPairGeometry(
+  const matching::PairwiseGeometries* pairwiseGeometries,
+  const Pair& pair,
+  const Mat3& KI, const Mat3& KJ,
+  const Mat& xI, const Mat& xJ,
+  RelativePoseInfo& relativePose_info)
+{
+  if (pairwiseGeometries == nullptr)
+    return false;
+  const matching::PairwiseGeometries::const_iterator iterGeometry = pairwiseGeometries->find(pair);
+  if (iterGeometry == pairwiseGeometries->end())
+    return false;
+
+  const matching::PairGeometry& geometry = iterGeometry->second;
+  Mat3 E;
+  if (geometry.model == 'e')
+  {
+    E = geometry.matrix;
+  }
+  else if (geometry.model == 'f')
+  {
+    // the intrinsics are known, so the fundamental matrix gives the essential one
+    EssentialFromFundamental(geometry.matrix, KI, KJ, &E);
+  }
+  else
+  {
+    // an homography does not constrain the relative pose enough
+    return false;
+  }
+  return relativePoseFromEssential(KI, KJ, xI, xJ, E, geometry.precision, relativePose_info);
+}
+
 bool ReconstructionEngine_sequentialSfM::makeInitialPair3D(const Pair& current_pair)
 {
   // Compute robust Essential matrix for ImageId [I,J]
@@ -864,7 +1028,12 @@ bool ReconstructionEngine_sequentialSfM::makeInitialPair3D(const Pair& current_p
   const std::pair<std::size_t, std::size_t> imageSizeI(camI->w(), camI->h());
   const std::pair<std::size_t, std::size_t> imageSizeJ(camJ->w(), camJ->h());
 
-  if (!robustRelativePose(
+  if (relativePoseFromPairGeometry(
+        _pairwiseGeometries, Pair(I, J), camI->K(), camJ->K(), xI, xJ, relativePose_info))
+  {
+    ALICEVISION_LOG_INFO("Relative pose of the initial pair reused from the cached geometric model.");
+  }
+  else if (!robustRelativePose(
         camI->K(), camJ->K(), xI, xJ, relativePose_info, imageSizeI, imageSizeJ, 4096))
   {
     ALICEVISION_LOG_WARNING(" /!\\ Robust estimation failed to compute E for this pair");
@@ -1084,7 +1253,13 @@ bool ReconstructionEngine_sequentialSfM::getBestInitialImagePairs(std::vector<Pa
     RelativePoseInfo relativePose_info;
     relativePose_info.initial_residual_tolerance = Square(4.0);
     
-    const bool relativePoseSuccess = robustRelativePose(
+    // reuse the model cached by the matching step when available,
+    // fall back on a robust estimation from scratch otherwise
+    bool relativePoseSuccess = relativePoseFromPairGeometry(
+          _pairwiseGeometries, Pair(I, J), camI->K(), camJ->K(), xI, xJ, relativePose_info);
+
+    if (!relativePoseSuccess)
+      relativePoseSuccess = robustRelativePose(
           camI->K(), camJ->K(),
           xI, xJ, relativePose_info,
           std::make_pair(camI->w(), camI->h()), std::make_pair(camJ->w(), camJ->h()),
@@ -1256,6 +1431,58 @@ std::size_t ReconstructionEngine_sequentialSfM::computeImageScore(IndexT viewId,
 #endif
 }
 
+void ReconstructionEngine_sequentialSfM::updatePyramidScores(const track::TrackIdBitset& reconstructedTracks) const
+{
+  std::vector<std::size_t> changedTracks;
+  // Patch the accumulators of every view seeing one of the changed tracks:
+  // direction is +1 for newly reconstructed tracks, -1 for removed ones.
+  const auto applyDelta = [this, &changedTracks](int direction)
+  {
+    for(const std::size_t trackId: changedTracks)
+    {
+      const track::Track& track = _map_tracks.at(trackId);
+      for(const auto& viewFeat: track.featPerView)
+      {
+        const IndexT viewId = viewFeat.first;
+        const auto pyramidIt = _map_featsPyramidPerView.find(viewId);
+        if(pyramidIt == _map_featsPyramidPerView.end())
+          continue;
+        ViewPyramidScore& viewScore = _viewPyramidScores[viewId];
+        if(viewScore.cellCounts.empty())
+        {
+          viewScore.cellCounts.assign(_pyramidNbCells, 0);
+          viewScore.nbOccupiedCellsPerLevel.assign(_pyramidDepth, 0);
+        }
+        for(std::size_t level = 0; level < _pyramidDepth; ++level)
+        {
+          const std::size_t cell = pyramidIt->second.at(trackId * _pyramidDepth + level);
+          std::uint32_t& count = viewScore.cellCounts.at(cell);
+          if(direction > 0)
+          {
+            if(count++ == 0)
+              ++viewScore.nbOccupiedCellsPerLevel[level];
+          }
+          else
+          {
+            if(--count == 0)
+              --viewScore.nbOccupiedCellsPerLevel[level];
+          }
+        }
+        viewScore.nbReconstructedTracks += direction;
+      }
+    }
+  };
+
+  // tracks reconstructed since the last call
+  reconstructedTracks.difference(_scoredReconstructedTracks, changedTracks);
+  applyDelta(+1);
+  // tracks removed since the last call (e.g. by the outlier filtering)
+  _scoredReconstructedTracks.difference(reconstructedTracks, changedTracks);
+  applyDelta(-1);
+
+  _scoredReconstructedTracks = reconstructedTracks;
+}
+
 /**
  * @brief Add one image to the 3D reconstruction. To the resectioning of
  * the camera.
@@ -1269,14 +1496,21 @@ std::size_t ReconstructionEngine_sequentialSfM::computeImageScore(IndexT viewId,
  */
 bool ReconstructionEngine_sequentialSfM::computeResection(const IndexT viewIndex, ResectionData& resectionData)
 {
+  const system::TraceSpan traceSpan("computeResection");
+
   using namespace track;
 
   // A. Compute 2D/3D matches
   // A1. list tracks ids used by the view
   const aliceVision::track::TrackIdSet& set_tracksIds = _map_tracksPerView.at(viewIndex);
 
-  // A2. intersects the track list with the reconstructed
-  std::set<std::size_t> reconstructed_trackId;
+  // A2. intersects the track list with the reconstructed.
+  // The reconstructed track id set is a large transient rebuilt at every
+  // resection: back its nodes with a bump arena instead of the global
+  // allocator, the whole set is released at once when the arena dies.
+  stl::arena scratchArena;
+  typedef std::set<std::size_t, std::less<std::size_t>, stl::arena_allocator<std::size_t> > TrackIdScratchSet;
+  TrackIdScratchSet reconstructed_trackId{std::less<std::size_t>(), stl::arena_allocator<std::size_t>(scratchArena)};
   std::transform(_sfm_data.GetLandmarks().begin(), _sfm_data.GetLandmarks().end(),
                  std::inserter(reconstructed_trackId, reconstructed_trackId.begin()),
                  stl::RetrieveKey());
@@ -1325,12 +1559,17 @@ bool ReconstructionEngine_sequentialSfM::computeResection(const IndexT viewIndex
   // C. Do the resectioning: compute the camera pose.
   ALICEVISION_LOG_INFO("Robust Resection of view: " << viewIndex);
 
+  // per-view random stream: the resection of a view is reproducible
+  // whatever the views resected before it
+  std::mt19937 randomGenerator = robustEstimation::createTaskGenerator(viewIndex);
+
   const bool bResection = sfm::SfMLocalizer::Localize(
       Pair(view_I->getWidth(), view_I->getHeight()),
       resectionData.optionalIntrinsic.get(),
       resectionData,
-      resectionData.pose, 
-      _localizerEstimator
+      resectionData.pose,
+      _localizerEstimator,
+      &randomGenerator
     );
 
   if (!_htmlLogFile.empty())
@@ -1388,9 +1627,10 @@ bool ReconstructionEngine_sequentialSfM::computeResection(const IndexT viewIndex
       pinhole_cam->setK(focal, principal_point(0), principal_point(1));
     }
 
-    const std::set<IndexT> reconstructedIntrinsics = _sfm_data.getReconstructedIntrinsics();
     // If we use a camera intrinsic for the first time we need to refine it.
-    const bool intrinsicsFirstUsage = (reconstructedIntrinsics.count(view_I->getIntrinsicId()) == 0);
+    // The range stops at the first valid view of the group, no need to
+    // materialize the whole reconstructed intrinsics set for one membership.
+    const bool intrinsicsFirstUsage = _sfm_data.viewsWithIntrinsic(view_I->getIntrinsicId()).empty();
 
     if(!sfm::SfMLocalizer::RefinePose(
       resectionData.optionalIntrinsic.get(), resectionData.pose,
@@ -1479,15 +1719,21 @@ void ReconstructionEngine_sequentialSfM::getTracksToTriangulate(const std::set<I
   std::set<IndexT>::iterator it;
 #pragma omp parallel private(it)
   {
+    // thread-private arena backing the per-track scratch set below,
+    // rewound in O(1) for each track instead of reallocating its nodes
+    stl::arena trackArena;
+    typedef std::set<IndexT, std::less<IndexT>, stl::arena_allocator<IndexT> > ViewIdScratchSet;
+
     for (it = allTracksInNewViews.begin(); it != allTracksInNewViews.end(); ++it)
     {
 #pragma omp single nowait
       {
         const std::size_t trackId = *it;
-        
+
         const track::Track & track = _map_tracks.at(trackId);
-        
-        std::set<IndexT> allViewsSharingTheTrack;
+
+        trackArena.reset();
+        ViewIdScratchSet allViewsSharingTheTrack{std::less<IndexT>(), stl::arena_allocator<IndexT>(trackArena)};
         std::transform(track.featPerView.begin(), track.featPerView.end(),
                        std::inserter(allViewsSharingTheTrack, allViewsSharingTheTrack.begin()),
                        stl::RetrieveKey());
@@ -1509,6 +1755,8 @@ void ReconstructionEngine_sequentialSfM::getTracksToTriangulate(const std::set<I
 
 void ReconstructionEngine_sequentialSfM::triangulateMultiViews_LORANSAC(SfMData& scene, const std::set<IndexT>& previousReconstructedViews, const std::set<IndexT>& newReconstructedViews)
 {
+  const system::TraceSpan traceSpan("triangulateMultiViews_LORANSAC");
+
   ALICEVISION_LOG_DEBUG("Triangulating (mode: multi-view LO-RANSAC)... ");
 
   // -- Identify the track to triangulate :
@@ -1522,21 +1770,32 @@ void ReconstructionEngine_sequentialSfM::triangulateMultiViews_LORANSAC(SfMData&
                  std::inserter(setTracksId, setTracksId.begin()),
                  stl::RetrieveKey());
                    
-#pragma omp parallel for 
+  // per-track triangulation results, committed to the scene sequentially afterwards
+  // (0: untouched, 1: valid landmark, 2: invalid track to remove from the scene)
+  std::vector<char> trackStatus(setTracksId.size(), 0);
+  std::vector<Landmark> trackLandmarks(setTracksId.size());
+
+#pragma omp parallel
+  {
+  // thread-local scratch reused across tracks to avoid per-track dynamic allocations
+  std::vector<Mat34> Ps; // projective matrices (one per pose)
+  std::vector<std::size_t> inliersIndex;
+
+#pragma omp for schedule(dynamic)
   for (int i = 0; i < setTracksId.size(); i++) // each track (already reconstructed or not)
   {
     const IndexT trackId = setTracksId.at(i);
     bool isValidTrack = true;
     const track::Track & track = _map_tracks.at(trackId);
     std::set<IndexT> & observations = mapTracksToTriangulate.at(trackId); // all the posed views possessing the track
-    
+
     // The track needs to be seen by a min. number of views to be triangulated
     if (observations.size() < _minNbObservationsForTriangulation)
       continue;
-    
+
     Vec3 X_euclidean = Vec3::Zero();
     std::set<IndexT> inliers;
-    
+
     if (observations.size() == 2) 
     {
       /* --------------------------------------------
@@ -1589,28 +1848,32 @@ void ReconstructionEngine_sequentialSfM::triangulateMultiViews_LORANSAC(SfMData&
      
       // -- Prepare:
       Mat2X features(2, observations.size()); // undistorted 2D features (one per pose)
-      std::vector< Mat34 > Ps; // projective matrices (one per pose)
+      Ps.clear();
       {
         const track::Track & track = _map_tracks.at(trackId);
-        
+
         int i = 0;
         for (const IndexT & viewId : observations)
         {
           const View* view = scene.GetViews().at(viewId).get();
           const IntrinsicBase* cam = scene.GetIntrinsics().at(view->getIntrinsicId()).get();
           const Vec2 x_ud = cam->get_ud_pixel(_featuresPerView->getFeatures(viewId, track.descType)[track.featPerView.at(viewId)].coords().cast<double>()); // undistorted 2D point
-          features(0,i) = x_ud(0); 
-          features(1,i) = x_ud(1);  
+          features(0,i) = x_ud(0);
+          features(1,i) = x_ud(1);
           Ps.push_back(cam->get_projective_equivalent(scene.getPose(*view)));
           i++;
         }
       }
-      
-      // -- Triangulate: 
+
+      // -- Triangulate:
       Vec4 X_homogeneous = Vec4::Zero();
-      std::vector<std::size_t> inliersIndex;
-      
-      TriangulateNViewLORANSAC(features, Ps, &X_homogeneous, &inliersIndex, 8.0);
+      inliersIndex.clear();
+
+      // per-track random stream: the triangulation of a track is
+      // reproducible whatever the scheduling of the other tracks
+      std::mt19937 randomGenerator = robustEstimation::createTaskGenerator(trackId);
+
+      TriangulateNViewLORANSAC(features, Ps, &X_homogeneous, &inliersIndex, 8.0, &randomGenerator);
       
       HomogeneousToEuclidean(X_homogeneous, &X_euclidean);     
       
@@ -1628,35 +1891,47 @@ void ReconstructionEngine_sequentialSfM::triangulateMultiViews_LORANSAC(SfMData&
         isValidTrack = false;
     }  
 
-    // -- Add the tringulated point to the scene
+    // -- Store the triangulation result, the scene is updated after the parallel loop
     if (isValidTrack)
     {
-      Landmark landmark;
+      Landmark& landmark = trackLandmarks.at(i);
       landmark.X = X_euclidean;
       landmark.descType = track.descType;
+      std::vector<std::pair<IndexT, Observation>> trackObservations;
+      trackObservations.reserve(inliers.size());
       for (const IndexT & viewId : inliers) // add inliers as observations
       {
         const Vec2 x = _featuresPerView->getFeatures(viewId, track.descType)[track.featPerView.at(viewId)].coords().cast<double>();
-        landmark.observations[viewId] = Observation(x, track.featPerView.at(viewId));
+        trackObservations.emplace_back(viewId, Observation(x, track.featPerView.at(viewId)));
       }
-#pragma omp critical
-      {
-        scene.structure[trackId] = landmark;
-      }      
+      // inliers is a sorted set: build the flat map in one allocation
+      landmark.observations = stl::flat_map_from_sorted_unique<IndexT, Observation>(
+        trackObservations.begin(), trackObservations.end());
+      trackStatus.at(i) = 1;
     }
     else
     {
-#pragma omp critical
-      {
-        if (scene.structure.find(trackId) != scene.structure.end()) 
-          scene.structure.erase(trackId);
-      }
+      trackStatus.at(i) = 2;
     }
-  } // for all shared tracks 
+  } // for all shared tracks
+  } // omp parallel
+
+  // -- Bulk-insert the triangulated points to the scene and remove the invalidated tracks
+  for (std::size_t i = 0; i < setTracksId.size(); ++i)
+  {
+    const IndexT trackId = setTracksId.at(i);
+
+    if (trackStatus.at(i) == 1)
+      scene.structure[trackId] = std::move(trackLandmarks.at(i));
+    else if (trackStatus.at(i) == 2)
+      scene.structure.erase(trackId);
+  }
 }
 
 void ReconstructionEngine_sequentialSfM::triangulate(SfMData& scene, const std::set<IndexT>& previousReconstructedViews, const std::set<IndexT>& newReconstructedViews)
 {
+  const system::TraceSpan traceSpan("triangulate");
+
   {
     std::vector<IndexT> intersection;
     std::set_intersection(
@@ -1814,8 +2089,102 @@ void ReconstructionEngine_sequentialSfM::triangulate(SfMData& scene, const std::
 }
 
 /// Bundle adjustment to refine Structure; Motion and Intrinsics
+bool ReconstructionEngine_sequentialSfM::needsBundleAdjustment() const
+{
+  // until a first adjustment has been recorded there is nothing to compare against
+  if(_nbObservationsAtLastBA == 0)
+    return true;
+
+  std::size_t nbObservations = 0;
+  for(const auto& landmarkPair : _sfm_data.GetLandmarks())
+    nbObservations += landmarkPair.second.observations.size();
+
+  // fraction of observations added since the last adjustment
+  const double growth = (nbObservations > _nbObservationsAtLastBA)
+    ? (nbObservations - _nbObservationsAtLastBA) / double(_nbObservationsAtLastBA)
+    : 0.0;
+  if(growth >= _adaptiveBAMaxGrowth)
+    return true;
+
+  // accumulated drift of the residuals since the last adjustment: resection and
+  // triangulation slowly degrade the scene even when few observations are added
+  const double rmse = RMSE(_sfm_data);
+  if(rmse > _rmseAtLastBA * (1.0 + _adaptiveBAMaxGrowth))
+    return true;
+
+  ALICEVISION_LOG_DEBUG("Adaptive bundle adjustment scheduling:" << std::endl
+    << "\t- observation growth: " << growth << std::endl
+    << "\t- residual RMSE: " << rmse << " (after last adjustment: " << _rmseAtLastBA << ")");
+
+  return false;
+}
+
+void ReconstructionEngine_sequentialSfM::adjustScene()
+{
+  ALICEVISION_LOG_DEBUG("Global Bundle start");
+
+  auto chrono_start = std::chrono::steady_clock::now();
+  std::size_t bundleAdjustmentIteration = 0;
+
+  const std::size_t nbOutliersThreshold = 50;
+  // Perform BA until all point are under the given precision
+  do
+  {
+    auto chrono2_start = std::chrono::steady_clock::now();
+
+    if (_uselocalBundleAdjustment)
+      localBundleAdjustment(_viewsPendingBA);
+    else
+      BundleAdjustment(_bFixedIntrinsics);
+
+    ALICEVISION_LOG_DEBUG("Bundle iteration: " << bundleAdjustmentIteration
+              << " took " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - chrono2_start).count() << " msec.");
+    ++bundleAdjustmentIteration;
+  }
+  while(removeOutliers(4.0) > nbOutliersThreshold);
+
+  ALICEVISION_LOG_DEBUG("Bundle adjustment with " << bundleAdjustmentIteration << " iterations took " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - chrono_start).count() << " msec.");
+  chrono_start = std::chrono::steady_clock::now();
+
+  std::set<IndexT> removedPosesId;
+  bool contentRemoved = eraseUnstablePosesAndObservations(this->_sfm_data, _minPointsPerPose, _minTrackLength, &removedPosesId);
+
+  if (_uselocalBundleAdjustment && contentRemoved)
+  {
+    // Get removed VIEWS index
+    std::set<IndexT> removedViewsId;
+    for (const auto& x : _sfm_data.GetViews())
+    {
+      if (removedPosesId.find(x.second->getPoseId()) != removedPosesId.end())
+      {
+        if (!_sfm_data.IsPoseAndIntrinsicDefined(x.second->getViewId()))
+          removedViewsId.insert(x.second->getViewId());
+        else
+          ALICEVISION_LOG_WARNING("The view #" << x.second->getViewId() << " is set as Removed while it is still in the scene.");
+      }
+    }
+
+    // Remove removed views to the graph
+    _localBA_data->removeViewsToTheGraph(removedViewsId);
+    ALICEVISION_LOG_INFO("Poses removed from the reconstruction: " << removedPosesId);
+  }
+  ALICEVISION_LOG_DEBUG("eraseUnstablePosesAndObservations took " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - chrono_start).count() << " msec.");
+
+  // record the adjusted scene state for the adaptive scheduling policy
+  _viewsPendingBA.clear();
+  if(_useAdaptiveBundleAdjustment)
+  {
+    _nbObservationsAtLastBA = 0;
+    for(const auto& landmarkPair : _sfm_data.GetLandmarks())
+      _nbObservationsAtLastBA += landmarkPair.second.observations.size();
+    _rmseAtLastBA = RMSE(_sfm_data);
+  }
+}
+
 bool ReconstructionEngine_sequentialSfM::BundleAdjustment(bool fixedIntrinsics)
 {
+  const system::TraceSpan traceSpan("BundleAdjustment");
+
   BundleAdjustmentCeres::BA_options options;
   if (_sfm_data.GetPoses().size() > 100)
   {
@@ -1827,16 +2196,23 @@ bool ReconstructionEngine_sequentialSfM::BundleAdjustment(bool fixedIntrinsics)
     ALICEVISION_LOG_DEBUG("Global BundleAdjustment dense");
     options.setDenseBA();
   }
-  BundleAdjustmentCeres bundle_adjustment_obj(options);
+  // Keep one BA engine alive across the reconstruction: the ceres problem is
+  // updated with the newly resected views and triangulated tracks instead of
+  // being rebuilt from scratch, and the solver restarts from the previous solution.
+  if(_bundleAdjustment == nullptr)
+    _bundleAdjustment = std::make_shared<BundleAdjustmentCeres>(options);
+  else
+    _bundleAdjustment->setOptions(options);
   BA_Refine refineOptions = BA_REFINE_ROTATION | BA_REFINE_TRANSLATION | BA_REFINE_STRUCTURE;
   if(!fixedIntrinsics)
     refineOptions |= BA_REFINE_INTRINSICS_ALL;
-  return bundle_adjustment_obj.Adjust(_sfm_data, refineOptions);
+  return _bundleAdjustment->AdjustIncremental(_sfm_data, refineOptions);
 }
 
 bool ReconstructionEngine_sequentialSfM::localBundleAdjustment(const std::set<IndexT>& newReconstructedViews)
 {
-  
+  const system::TraceSpan traceSpan("localBundleAdjustment");
+
   // -- Manage Ceres options (parameter ordering, local BA, sparse/dense mode, etc.)
   
   LocalBundleAdjustmentCeres::LocalBA_options options;
@@ -1919,7 +2295,7 @@ bool ReconstructionEngine_sequentialSfM::localBundleAdjustment(const std::set<In
 
 std::size_t ReconstructionEngine_sequentialSfM::removeOutliers(double precision)
 {
-  const std::size_t nbOutliersResidualErr = RemoveOutliers_PixelResidualError(_sfm_data, precision, 2);
+  const std::size_t nbOutliersResidualErr = RemoveOutliers_PixelResidualError(_sfm_data, precision, 2, &_residualHistogram);
   const std::size_t nbOutliersAngleErr = RemoveOutliers_AngleError(_sfm_data, 2.0);
 
   ALICEVISION_LOG_DEBUG("Remove outliers: " << std::endl
@@ -9,7 +9,10 @@
 #include <aliceVision/sfm/LocalBundleAdjustmentData.hpp>
 #include <aliceVision/sfm/pipeline/localization/SfMLocalizer.hpp>
 #include <aliceVision/sfm/pipeline/pairwiseMatchesIO.hpp>
+#include <aliceVision/matching/pairwiseGeometries.hpp>
 #include <aliceVision/sfm/sfmDataIO.hpp>
+#include <aliceVision/sfm/sfmDataIO_delta.hpp>
+#include <aliceVision/sfm/ResidualHistogram.hpp>
 #include <aliceVision/feature/FeaturesPerView.hpp>
 #include <aliceVision/track/Track.hpp>
 
@@ -23,6 +26,8 @@ namespace pt = boost::property_tree;
 namespace aliceVision {
 namespace sfm {
 
+class BundleAdjustmentCeres;
+
 /// Image score contains <ImageId, NbPutativeCommonPoint, score, isIntrinsicsReconstructed>
 typedef std::tuple<IndexT, std::size_t, std::size_t, bool> ViewConnectionScore;
 
@@ -47,6 +52,16 @@ public:
     _pairwiseMatches = pairwiseMatches;
   }
 
+  /**
+   * @brief Set the per-pair geometric models estimated by the matching step.
+   * When available, they are used as relative pose priors to avoid
+   * re-estimating the two views geometry during the initial pair selection.
+   */
+  void setPairwiseGeometries(const matching::PairwiseGeometries* pairwiseGeometries)
+  {
+    _pairwiseGeometries = pairwiseGeometries;
+  }
+
   void setInitialPair(const Pair& initialPair)
   {
     _userInitialImagePair = initialPair;
@@ -67,6 +82,11 @@ public:
     _sfmdataInterFileExtension = interFileExtension;
   }
 
+  void setIntermediateFileDeltaSave(bool deltaSave)
+  {
+    _sfmdataInterFileDelta = deltaSave;
+  }
+
   void setNbOfObservationsForTriangulation(std::size_t minNbObservationsForTriangulation)
   {
     _minNbObservationsForTriangulation = minNbObservationsForTriangulation;
@@ -93,11 +113,41 @@ public:
     }
   }
 
+  void setUseAdaptiveBundleAdjustmentStrategy(bool v)
+  {
+    _useAdaptiveBundleAdjustment = v;
+  }
+
+  /**
+   * @brief Set the cost/quality trade-off of the adaptive bundle adjustment scheduling.
+   * @param[in] maxGrowth tolerated fraction of new observations (and of residual RMSE
+   * drift) accumulated between two adjustments; lower values adjust more often.
+   */
+  void setAdaptiveBundleAdjustmentMaxGrowth(double maxGrowth)
+  {
+    _adaptiveBAMaxGrowth = maxGrowth;
+  }
+
   void setLocalizerEstimator(robustEstimation::ERobustEstimator estimator)
   {
     _localizerEstimator = estimator;
   }
 
+  void setCheckpointInterval(std::size_t nbResectionGroups)
+  {
+    _checkpointInterval = nbResectionGroups;
+  }
+
+  /**
+   * @brief Get the filepath of the reconstruction checkpoint file in a given folder.
+   * @param[in] folder the reconstruction output folder
+   * @return the checkpoint filepath
+   */
+  static std::string getCheckpointFilepath(const std::string& folder)
+  {
+    return stlplus::create_filespec(folder, "sfm_checkpoint", ".bin");
+  }
+
   /**
    * @brief Process the entire incremental reconstruction
    * @return true if done
@@ -147,6 +197,16 @@ public:
    */
   void updateReconstruction(IndexT resectionId, const std::vector<IndexT>& bestViewIds, std::set<IndexT>& viewIds);
 
+  /**
+   * @brief Save a resumable snapshot of the current scene in the output directory.
+   * The snapshot contains the full SfMData, including the view resection ids from
+   * which the remaining view set and the next resection group are recomputed on resume.
+   * The file is written next to its final location and renamed afterwards, so an
+   * existing checkpoint is never left half-written if the process is killed.
+   * @param[in] resectionId The last completed resection id
+   */
+  void saveCheckpoint(IndexT resectionId) const;
+
   /**
    * @brief Export and print statistics of a complete reconstruction
    * @param[in] reconstructionTime The duration of the reconstruction
@@ -160,10 +220,14 @@ public:
    *
    * @param[out] out_connectedViews: output list of view IDs connected with the 3D reconstruction.
    * @param[in] remainingViewIds: input list of remaining view IDs in which we will search for connected views.
+   * @param[in] maxConnectedViews: if not 0, only the maxConnectedViews best
+   *            scored views are kept, selected with bounded per-thread heaps
+   *            instead of a full sort of all the candidates.
    * @return False if there is no view connected.
    */
   bool findConnectedViews(std::vector<ViewConnectionScore>& out_connectedViews,
-                          const std::set<IndexT>& remainingViewIds) const;
+                          const std::set<IndexT>& remainingViewIds,
+                          std::size_t maxConnectedViews = 0) const;
 
   /**
    * @brief Estimate the best images on which we can compute the resectioning safely.
@@ -241,6 +305,20 @@ private:
    */
   std::size_t computeImageScore(IndexT viewId, const std::vector<std::size_t>& trackIds) const;
 
+  /**
+   * @brief Fold into the per-view pyramid score accumulators the tracks that
+   *        were reconstructed or removed since the previous call.
+   *
+   * The accumulators maintain, for each view, the number of reconstructed
+   * tracks falling in each pyramid cell, so findConnectedViews() can read the
+   * scores directly instead of recomputing them from all the landmarks: the
+   * cost of an update is proportional to the number of landmarks added or
+   * removed since the last resection iteration.
+   *
+   * @param[in] reconstructedTracks: the track IDs of the current landmarks
+   */
+  void updatePyramidScores(const track::TrackIdBitset& reconstructedTracks) const;
+
   /**
    * @brief Apply the resection on a single view.
    * @param[in] viewIndex: image index to add to the reconstruction.
@@ -330,6 +408,22 @@ private:
    */
   std::size_t removeOutliers(double precision);
 
+  /**
+   * @brief Decide whether the scene changed enough since the last bundle adjustment
+   * to be worth a new one (adaptive scheduling).
+   * @details Triggers on the fraction of observations added since the last adjustment
+   * and on the drift of the residual RMSE, both against \c _adaptiveBAMaxGrowth.
+   * @return true if the bundle adjustment should run on the current scene
+   */
+  bool needsBundleAdjustment() const;
+
+  /**
+   * @brief Run the bundle adjustment / outlier filtering loop on the current scene
+   * until the remaining outliers are under the threshold, then erase the unstable
+   * poses and observations. Resets the adaptive scheduling state.
+   */
+  void adjustScene();
+
   // Parameters
 
   Pair _userInitialImagePair;
@@ -337,6 +431,11 @@ private:
   int _minTrackLength = 2;
   int _minPointsPerPose = 30;
   bool _uselocalBundleAdjustment = false;
+  /// is adaptive bundle adjustment scheduling activated
+  bool _useAdaptiveBundleAdjustment = false;
+  /// cost/quality trade-off of the adaptive scheduling: tolerated fraction of new
+  /// observations and of residual RMSE drift accumulated between two adjustments
+  double _adaptiveBAMaxGrowth = 0.1;
   /// minimum number of obersvations to triangulate a 3d point.
   std::size_t _minNbObservationsForTriangulation = 2;
   /// a 3D point must have at least 2 obervations not too much aligned.
@@ -347,6 +446,8 @@ private:
 
   feature::FeaturesPerView* _featuresPerView;
   matching::PairwiseMatches* _pairwiseMatches;
+  /// Optional per-pair geometric models estimated by the matching step
+  const matching::PairwiseGeometries* _pairwiseGeometries = nullptr;
 
   // Pyramid scoring
 
@@ -355,6 +456,23 @@ private:
   /// internal cache of precomputed values for the weighting of the pyramid levels
   std::vector<int> _pyramidWeights;
   int _pyramidThreshold;
+  /// total number of cells over all the pyramid levels
+  std::size_t _pyramidNbCells = 0;
+
+  /// Incrementally maintained pyramid score of one view (see updatePyramidScores)
+  struct ViewPyramidScore
+  {
+    /// number of reconstructed tracks of the view falling in each pyramid cell
+    std::vector<std::uint32_t> cellCounts;
+    /// number of non-empty cells of each pyramid level
+    std::vector<std::uint32_t> nbOccupiedCellsPerLevel;
+    /// number of reconstructed tracks visible in the view
+    std::size_t nbReconstructedTracks = 0;
+  };
+  /// Per-view pyramid score accumulators over the reconstructed tracks
+  mutable HashMap<IndexT, ViewPyramidScore> _viewPyramidScores;
+  /// Reconstructed tracks already folded into _viewPyramidScores
+  mutable track::TrackIdBitset _scoredReconstructedTracks;
 
   // Temporary data
 
@@ -366,18 +484,43 @@ private:
   track::TracksPyramidPerView _map_featsPyramidPerView;
   /// Per camera confidence (A contrario estimated threshold error)
   HashMap<IndexT, double> _map_ACThreshold;
+  /// Residual distribution of the kept observations, maintained by the
+  /// outlier filtering after each bundle adjustment
+  ResidualHistogram _residualHistogram;
+
+  // Adaptive bundle adjustment scheduling state
+
+  /// views reconstructed since the last bundle adjustment: when groups are skipped
+  /// the next adjustment has to consider all of them, not only the current group
+  std::set<IndexT> _viewsPendingBA;
+  /// number of observations in the scene after the last bundle adjustment
+  std::size_t _nbObservationsAtLastBA = 0;
+  /// residual RMSE after the last bundle adjustment
+  double _rmseAtLastBA = 0.0;
 
   // Local Bundle Adjustment data
 
   /// Contains all the data used by the Local BA approach
   std::shared_ptr<LocalBundleAdjustmentData> _localBA_data;
 
+  // Global Bundle Adjustment data
+
+  /// Global BA engine kept alive across the reconstruction so that its ceres
+  /// problem is updated incrementally instead of being rebuilt at each call
+  std::shared_ptr<BundleAdjustmentCeres> _bundleAdjustment;
+
   // Intermediate reconstructions
 
   /// extension of the intermediate reconstruction files
   std::string _sfmdataInterFileExtension = ".ply";
+  /// checkpoint interval in number of resection groups (0: checkpointing disabled)
+  std::size_t _checkpointInterval = 0;
   /// filter for the intermediate reconstruction files
   ESfMData _sfmdataInterFilter = ESfMData(EXTRINSICS | INTRINSICS | STRUCTURE | OBSERVATIONS | CONTROL_POINTS);
+  /// save the intermediate reconstructions as JSON deltas instead of full scene files
+  bool _sfmdataInterFileDelta = false;
+  /// delta writer for the intermediate reconstructions, created at the first save
+  std::unique_ptr<DeltaSaver> _interFileDeltaSaver;
 
   // Log
 
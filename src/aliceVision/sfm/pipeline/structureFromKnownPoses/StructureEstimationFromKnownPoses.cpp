@@ -48,11 +48,12 @@ void PointsToMat(
   for( PointFeatures::const_iterator iter = vec_feats.begin();
     iter != vec_feats.end(); ++iter, ++i)
   {
-    if (cam && cam->isValid())
-      m.col(i) = cam->get_ud_pixel(Vec2(iter->x(), iter->y()));
-    else
-      m.col(i) << iter->x(), iter->y();
+    m.col(i) << iter->x(), iter->y();
   }
+  // undistort the whole block at once, the distortion inversion is
+  // vectorized and shared between the points
+  if (cam && cam->isValid())
+    m = cam->get_ud_pixel_many(m);
 }
 
 /// Use geometry of the views to compute a putative structure from features and descriptors.
@@ -77,6 +78,35 @@ void StructureEstimationFromKnownPoses::match(
   boost::progress_display my_progress_bar( pairs.size(), std::cout,
     "Compute pairwise fundamental guided matching:\n" );
 
+#ifndef EXHAUSTIVE_MATCHING
+  // Build the per-view spatial grid indexes once: they are shared by all
+  // the pairs involving the view, instead of rebuilding a bucket structure
+  // for every pair.
+  std::map<IndexT, std::map<feature::EImageDescriberType, robustEstimation::RegionsGridIndex>> gridIndexPerView;
+  {
+    std::set<IndexT> viewIds;
+    for(const Pair& pair: pairs)
+    {
+      viewIds.insert(pair.first);
+      viewIds.insert(pair.second);
+    }
+    for(const IndexT viewId: viewIds)
+    {
+      const View * view = sfm_data.GetViews().at(viewId).get();
+      const Intrinsics::const_iterator iterIntrinsic = sfm_data.GetIntrinsics().find(view->getIntrinsicId());
+      if(iterIntrinsic == sfm_data.GetIntrinsics().end())
+        continue;
+      const IntrinsicBase * cam = iterIntrinsic->second.get();
+      const feature::RegionsPerDescHandle regionsPerDescHandle = regionsPerView.getRegionsPerDesc(viewId);
+      for(const auto& regionsPerDesc: *regionsPerDescHandle)
+      {
+        gridIndexPerView[viewId][regionsPerDesc.first].build(
+          *regionsPerDesc.second, cam, cam->w(), cam->h());
+      }
+    }
+  }
+#endif
+
   #pragma omp parallel
   for (PairSet::const_iterator it = pairs.begin(); it != pairs.end(); ++it)
   {
@@ -123,20 +153,15 @@ void StructureEstimationFromKnownPoses::match(
             matches
           );
       #else
-        const Vec3 epipole2  = epipole_from_P(P_R, poseL);
-
-        //const feature::Regions& regions = regionsPerView.getRegions(it->first);
-        robustEstimation::GuidedMatching_Fundamental_Fast
+        // The grid indexes are read-only here: they were built once per view
+        robustEstimation::GuidedMatching_Fundamental_Grid
           <fundamental::kernel::EpipolarDistanceError>
           (
             F_lr,
-            epipole2,
-            iterIntrinsicL->second.get(),
-            regionsPerView.getRegions(it->first, descType),
-            iterIntrinsicR->second.get(),
-            regionsPerView.getRegions(it->second, descType),
-            iterIntrinsicR->second->w(), iterIntrinsicR->second->h(),
-            //descType,
+            *regionsPerView.getRegions(it->first, descType),
+            gridIndexPerView.at(it->first).at(descType),
+            *regionsPerView.getRegions(it->second, descType),
+            gridIndexPerView.at(it->second).at(descType),
             Square(thresholdF), Square(0.8),
             matches
           );
@@ -212,7 +237,7 @@ void StructureEstimationFromKnownPoses::filter(
               const View * view = sfm_data.GetViews().at(imaIndex).get();
               const IntrinsicBase * cam = sfm_data.GetIntrinsics().at(view->getIntrinsicId()).get();
               const Pose3 pose = sfm_data.getPose(*view);
-              const Vec2 pt = regionsPerView.getRegions(imaIndex, subTrack.descType).GetRegionPosition(featIndex);
+              const Vec2 pt = regionsPerView.getRegions(imaIndex, subTrack.descType)->GetRegionPosition(featIndex);
               trianObj.add(cam->get_projective_equivalent(pose), cam->get_ud_pixel(pt));
             }
             const Vec3 Xs = trianObj.compute();
@@ -264,14 +289,18 @@ void StructureEstimationFromKnownPoses::triangulate(
   {
     const track::Track & track = itTracks->second;
     structure[idx] = Landmark(track.descType);
-    Observations & observations = structure.at(idx).observations;
+    std::vector<std::pair<IndexT, Observation>> trackObservations;
+    trackObservations.reserve(track.featPerView.size());
     for (auto it = track.featPerView.begin(); it != track.featPerView.end(); ++it)
     {
       const size_t imaIndex = it->first;
       const size_t featIndex = it->second;
-      const Vec2 pt = regionsPerView.getRegions(imaIndex, track.descType).GetRegionPosition(featIndex);
-      observations[imaIndex] = Observation(pt, featIndex);
+      const Vec2 pt = regionsPerView.getRegions(imaIndex, track.descType)->GetRegionPosition(featIndex);
+      trackObservations.emplace_back(imaIndex, Observation(pt, featIndex));
     }
+    // featPerView is sorted by view id: build the flat map in one allocation
+    structure.at(idx).observations = stl::flat_map_from_sorted_unique<IndexT, Observation>(
+      trackObservations.begin(), trackObservations.end());
   }
 
   // Triangulate them using a robust triangulation scheme
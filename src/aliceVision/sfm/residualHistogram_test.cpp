@@ -0,0 +1,53 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfm/ResidualHistogram.hpp>
+
+#define BOOST_TEST_MODULE residualHistogram
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::sfm;
+
+BOOST_AUTO_TEST_CASE(ResidualHistogram_AddRemoveCount)
+{
+  ResidualHistogram histogram(8.0);
+  BOOST_CHECK(histogram.empty());
+
+  histogram.add(0.5);
+  histogram.add(1.5);
+  histogram.add(100.0); // overflow bin
+  BOOST_CHECK_EQUAL(3, histogram.size());
+
+  histogram.remove(1.5);
+  BOOST_CHECK_EQUAL(2, histogram.size());
+
+  histogram.clear();
+  BOOST_CHECK(histogram.empty());
+  BOOST_CHECK_EQUAL(0.0, histogram.percentile(0.5));
+}
+
+BOOST_AUTO_TEST_CASE(ResidualHistogram_Percentile)
+{
+  ResidualHistogram histogram(16.0);
+
+  // 1000 uniformly spread residuals in [0, 10[
+  for (int i = 0; i < 1000; ++i)
+    histogram.add(i * 0.01);
+
+  // the percentiles of a uniform distribution are linear in p;
+  // allow the bin width (16 / 256 = 0.0625) as tolerance
+  BOOST_CHECK_SMALL(histogram.percentile(0.5) - 5.0, 0.0625);
+  BOOST_CHECK_SMALL(histogram.percentile(0.9) - 9.0, 0.0625);
+
+  // mean of the uniform distribution
+  BOOST_CHECK_SMALL(histogram.mean() - 5.0, 0.0625);
+
+  // removing the upper half moves the median down
+  for (int i = 500; i < 1000; ++i)
+    histogram.remove(i * 0.01);
+  BOOST_CHECK_SMALL(histogram.percentile(0.5) - 2.5, 0.0625);
+}
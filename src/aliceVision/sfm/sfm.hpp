@@ -30,6 +30,7 @@
 #include "aliceVision/sfm/pipeline/global/reindexGlobalSfM.hpp"
 #include "aliceVision/sfm/pipeline/global/ReconstructionEngine_globalSfM.hpp"
 #include "aliceVision/sfm/pipeline/sequential/ReconstructionEngine_sequentialSfM.hpp"
+#include "aliceVision/sfm/pipeline/partitioned/ReconstructionEngine_partitionedSfM.hpp"
 #include "aliceVision/sfm/pipeline/structureFromKnownPoses/StructureEstimationFromKnownPoses.hpp"
 #include "aliceVision/sfm/pipeline/localization/SfMLocalizer.hpp"
 #include "aliceVision/sfm/pipeline/localization/SfMLocalizationSingle3DTrackObservationDatabase.hpp"
@@ -0,0 +1,110 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfm/SfMData.hpp>
+#include <aliceVision/sfm/sfmDataFilters.hpp>
+
+#define BOOST_TEST_MODULE sfmDataEraseIf
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::sfm;
+
+namespace {
+
+// Build a scene with 3 posed views and 3 landmarks:
+// landmark 0 is seen by views 0,1,2; landmark 1 by views 0,1; landmark 2 by view 2.
+SfMData buildTestScene()
+{
+  SfMData sfmData;
+  for(IndexT viewId = 0; viewId < 3; ++viewId)
+  {
+    sfmData.views[viewId] = std::make_shared<View>("view" + std::to_string(viewId) + ".jpg", viewId, 0, viewId);
+    sfmData.setAbsolutePose(viewId, geometry::Pose3());
+  }
+  sfmData.intrinsics[0] = std::make_shared<camera::Pinhole>();
+
+  Observations obs0;
+  obs0[0] = Observation(Vec2(0.0, 0.0), 0);
+  obs0[1] = Observation(Vec2(1.0, 0.0), 1);
+  obs0[2] = Observation(Vec2(2.0, 0.0), 2);
+  sfmData.structure[0] = Landmark(Vec3(0, 0, 1), feature::EImageDescriberType::SIFT, obs0);
+
+  Observations obs1;
+  obs1[0] = Observation(Vec2(0.0, 1.0), 3);
+  obs1[1] = Observation(Vec2(1.0, 1.0), 4);
+  sfmData.structure[1] = Landmark(Vec3(0, 1, 1), feature::EImageDescriberType::SIFT, obs1);
+
+  Observations obs2;
+  obs2[2] = Observation(Vec2(2.0, 2.0), 5);
+  sfmData.structure[2] = Landmark(Vec3(1, 1, 1), feature::EImageDescriberType::SIFT, obs2);
+
+  return sfmData;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(SfMDataEraseIf_ObservationsCompaction)
+{
+  SfMData sfmData = buildTestScene();
+  Landmark& landmark = sfmData.structure[0];
+
+  // a predicate matching nothing leaves the landmark untouched
+  std::size_t erased = SfMData::eraseObservationsIf(landmark,
+    [](IndexT, const Observation&) { return false; });
+  BOOST_CHECK_EQUAL(0, erased);
+  BOOST_CHECK_EQUAL(3, landmark.observations.size());
+
+  // erase the observation of view 1, the others keep their values
+  erased = SfMData::eraseObservationsIf(landmark,
+    [](IndexT viewId, const Observation&) { return viewId == 1; });
+  BOOST_CHECK_EQUAL(1, erased);
+  BOOST_CHECK_EQUAL(2, landmark.observations.size());
+  BOOST_CHECK(landmark.observations.count(0));
+  BOOST_CHECK(!landmark.observations.count(1));
+  BOOST_CHECK(landmark.observations.count(2));
+  BOOST_CHECK_EQUAL(2, landmark.observations.at(2).id_feat);
+
+  // scene-wide erase: drop every observation of view 0
+  erased = sfmData.eraseObservationsIf(
+    [](IndexT viewId, const Observation&) { return viewId == 0; });
+  BOOST_CHECK_EQUAL(2, erased);
+  BOOST_CHECK_EQUAL(1, sfmData.structure.at(0).observations.size());
+  BOOST_CHECK_EQUAL(1, sfmData.structure.at(1).observations.size());
+  BOOST_CHECK_EQUAL(1, sfmData.structure.at(2).observations.size());
+}
+
+BOOST_AUTO_TEST_CASE(SfMDataEraseIf_LandmarksDeferredRemoval)
+{
+  SfMData sfmData = buildTestScene();
+
+  // remove the landmarks seen by less than 2 views; the scan must be able to
+  // inspect the whole structure before any removal is applied
+  const std::size_t nbLandmarksBeforeScan = sfmData.structure.size();
+  const std::size_t erased = sfmData.eraseLandmarksIf(
+    [&](IndexT, const Landmark& landmark)
+    {
+      BOOST_CHECK_EQUAL(nbLandmarksBeforeScan, sfmData.structure.size());
+      return landmark.observations.size() < 2;
+    });
+  BOOST_CHECK_EQUAL(1, erased);
+  BOOST_CHECK_EQUAL(2, sfmData.structure.size());
+  BOOST_CHECK(sfmData.structure.count(0));
+  BOOST_CHECK(sfmData.structure.count(1));
+}
+
+BOOST_AUTO_TEST_CASE(SfMDataEraseIf_ObservationsWithMissingPoses)
+{
+  SfMData sfmData = buildTestScene();
+
+  // unpose view 1: its observations must disappear, and the landmarks left
+  // under the length threshold (1 and 2) must be removed with them
+  sfmData.erasePose(1);
+  BOOST_CHECK(eraseObservationsWithMissingPoses(sfmData, 2));
+
+  BOOST_CHECK_EQUAL(1, sfmData.structure.size());
+  BOOST_CHECK_EQUAL(2, sfmData.structure.at(0).observations.size());
+  BOOST_CHECK(!sfmData.structure.at(0).observations.count(1));
+}
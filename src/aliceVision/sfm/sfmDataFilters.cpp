@@ -4,6 +4,8 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "sfmDataFilters.hpp"
+#include <aliceVision/camera/cameraDispatch.hpp>
+#include <aliceVision/sfm/LandmarksData.hpp>
 #include <aliceVision/stl/stl.hpp>
 #include <aliceVision/system/Logger.hpp>
 
@@ -12,78 +14,233 @@
 namespace aliceVision {
 namespace sfm {
 
+namespace {
+
+/// Compute the batched residuals of one view block through the concrete
+/// camera model, so the projection and distortion math gets inlined per
+/// model instead of crossing the IntrinsicBase virtual interface.
+struct ViewResidualsVisitor
+{
+  const geometry::Pose3& pose;
+  const Mat3X& X;
+  const Mat2X& x;
+  Mat2X& residuals;
+
+  template <class CameraT>
+  void operator()(const CameraT& camera) const
+  {
+    residuals = camera.residualsMany(pose, X, x);
+  }
+};
+
+} // namespace
+
 IndexT RemoveOutliers_PixelResidualError
 (
   SfMData & sfm_data,
   const double dThresholdPixel,
-  const unsigned int minTrackLength
+  const unsigned int minTrackLength,
+  ResidualHistogram* residualHistogram,
+  const double adaptivePercentile
 )
 {
+  // tighten the threshold from the residual distribution of the previous
+  // filtering round, when one is maintained
+  double thresholdPixel = dThresholdPixel;
+  if (residualHistogram != NULL &&
+      !residualHistogram->empty() &&
+      adaptivePercentile > 0.0 && adaptivePercentile < 1.0)
+  {
+    thresholdPixel = std::min(dThresholdPixel, residualHistogram->percentile(adaptivePercentile));
+  }
+
+  // Gather the observations in a compact structure-of-arrays form:
+  // the residual scan walks flat records instead of chasing the landmark map.
+  LandmarksData data;
+  data.fromLandmarks(sfm_data.structure);
+
+  // Group the observations per view, so the residuals are computed with one
+  // batched residualsMany call per view instead of one virtual call per
+  // observation.
+  std::map<IndexT, std::vector<std::pair<std::size_t, std::size_t>>> obsPerView; // viewId -> (observation index, landmark index)
+  for (std::size_t i = 0; i < data.nbLandmarks(); ++i)
+    for (std::size_t o = data.obsBegin(i); o < data.obsEnd(i); ++o)
+      obsPerView[data.observation(o).viewId].emplace_back(o, i);
+
+  // index the view blocks so they can be distributed across threads
+  std::vector<const std::pair<const IndexT, std::vector<std::pair<std::size_t, std::size_t>>>*> viewBlocks;
+  viewBlocks.reserve(obsPerView.size());
+  for (const auto& viewObservations : obsPerView)
+    viewBlocks.push_back(&viewObservations);
+
+  std::vector<double> residualNorms(data.nbObservations());
+  std::vector<double> depths(data.nbObservations());
+
+  // each view block writes to disjoint observation slots, so the residual
+  // scoring runs in parallel without synchronization
+#pragma omp parallel for schedule(dynamic)
+  for (std::size_t b = 0; b < viewBlocks.size(); ++b)
+  {
+    const std::pair<const IndexT, std::vector<std::pair<std::size_t, std::size_t>>>& viewObservations = *viewBlocks[b];
+    const View * view = sfm_data.views.at(viewObservations.first).get();
+    const geometry::Pose3 pose = sfm_data.getPose(*view);
+    const camera::IntrinsicBase * intrinsic = sfm_data.intrinsics.at(view->getIntrinsicId()).get();
+
+    const std::size_t nbObs = viewObservations.second.size();
+    Mat3X X(3, nbObs);
+    Mat2X x(2, nbObs);
+    for (std::size_t k = 0; k < nbObs; ++k)
+    {
+      X.col(k) = data.point(viewObservations.second[k].second);
+      const LandmarksData::ObservationRecord& record = data.observation(viewObservations.second[k].first);
+      x.col(k) = Vec2(record.x, record.y);
+    }
+
+    // stamp the residual computation out for the concrete camera model;
+    // unknown models fall back to the virtual interface
+    Mat2X residuals;
+    ViewResidualsVisitor visitor = {pose, X, x, residuals};
+    if (!camera::dispatchIntrinsic(*intrinsic, visitor))
+      residuals = intrinsic->residualsMany(pose, X, x);
+
+    const Mat3X Xcam = pose(X); // depth is the camera frame z coordinate
+
+    for (std::size_t k = 0; k < nbObs; ++k)
+    {
+      const std::size_t o = viewObservations.second[k].first;
+      residualNorms[o] = residuals.col(k).norm();
+      depths[o] = Xcam(2, k);
+    }
+  }
+
   IndexT outlier_count = 0;
-  Landmarks::iterator iterTracks = sfm_data.structure.begin();
-  while (iterTracks != sfm_data.structure.end())
+
+  // the erased markers live in disjoint per-landmark slots, so the outlier
+  // decision is taken in parallel too; only the count is reduced
+#pragma omp parallel for reduction(+:outlier_count)
+  for (std::size_t i = 0; i < data.nbLandmarks(); ++i)
   {
-    Observations & observations = iterTracks->second.observations;
-    Observations::iterator itObs = observations.begin();
-    while (itObs != observations.end())
+    std::size_t nbValidObservations = 0;
+
+    for (std::size_t o = data.obsBegin(i); o < data.obsEnd(i); ++o)
     {
-      const View * view = sfm_data.views.at(itObs->first).get();
-      const geometry::Pose3 pose = sfm_data.getPose(*view);
-      const camera::IntrinsicBase * intrinsic = sfm_data.intrinsics.at(view->getIntrinsicId()).get();
-      const Vec2 residual = intrinsic->residual(pose, iterTracks->second.X, itObs->second.x);
-      if((pose.depth(iterTracks->second.X) < 0) ||
-         (residual.norm() > dThresholdPixel))
+      if((depths[o] < 0) ||
+         (residualNorms[o] > thresholdPixel))
       {
         ++outlier_count;
-        itObs = observations.erase(itObs);
+        data.eraseObservation(o);
       }
       else
-        ++itObs;
+        ++nbValidObservations;
+    }
+
+    if (nbValidObservations == 0 || nbValidObservations < minTrackLength)
+      data.eraseLandmark(i);
+  }
+
+  // Refresh the maintained histogram with the residuals of the surviving
+  // observations, they are already computed
+  if (residualHistogram != NULL)
+  {
+    residualHistogram->clear();
+    for (std::size_t i = 0; i < data.nbLandmarks(); ++i)
+    {
+      if (data.isLandmarkErased(i))
+        continue;
+      for (std::size_t o = data.obsBegin(i); o < data.obsEnd(i); ++o)
+      {
+        if (!data.isObservationErased(o))
+          residualHistogram->add(residualNorms[o]);
+      }
+    }
+  }
+
+  // Apply the erasures to the map form, touching only the modified landmarks
+  // so the surviving ones keep their storage.
+  for (std::size_t i = 0; i < data.nbLandmarks(); ++i)
+  {
+    if (data.isLandmarkErased(i))
+    {
+      sfm_data.structure.erase(data.landmarkId(i));
+      continue;
+    }
+
+    bool landmarkModified = false;
+    for (std::size_t o = data.obsBegin(i); o < data.obsEnd(i); ++o)
+    {
+      if (data.isObservationErased(o))
+      {
+        landmarkModified = true;
+        break;
+      }
+    }
+
+    if (!landmarkModified)
+      continue;
+
+    // rebuild the observations of the landmark in one pass instead of
+    // erasing the outliers one by one from the flat_map
+    Observations observations;
+    for (std::size_t o = data.obsBegin(i); o < data.obsEnd(i); ++o)
+    {
+      if (data.isObservationErased(o))
+        continue;
+
+      const LandmarksData::ObservationRecord& record = data.observation(o);
+      observations.emplace_hint(observations.end(),
+                                record.viewId,
+                                Observation(Vec2(record.x, record.y), record.featId));
     }
-    if (observations.empty() || observations.size() < minTrackLength)
-      iterTracks = sfm_data.structure.erase(iterTracks);
-    else
-      ++iterTracks;
+    sfm_data.structure.at(data.landmarkId(i)).observations.swap(observations);
   }
   return outlier_count;
 }
 
 IndexT RemoveOutliers_AngleError(SfMData& sfm_data, const double dMinAcceptedAngle)
 {
+  // scan the observations through the compact structure-of-arrays form
+  LandmarksData data;
+  data.fromLandmarks(sfm_data.structure);
+
   IndexT removedTrack_count = 0;
-  Landmarks::iterator iterTracks = sfm_data.structure.begin();
-  while (iterTracks != sfm_data.structure.end())
+
+  // score the landmarks in parallel, recording the rejections in the
+  // per-landmark erased markers; the map is compacted in one pass afterwards
+#pragma omp parallel for schedule(dynamic) reduction(+:removedTrack_count)
+  for (std::size_t i = 0; i < data.nbLandmarks(); ++i)
   {
-    Observations & observations = iterTracks->second.observations;
     double max_angle = 0.0;
-    for (Observations::const_iterator itObs1 = observations.begin();
-      itObs1 != observations.end(); ++itObs1)
+    for (std::size_t o1 = data.obsBegin(i); o1 < data.obsEnd(i); ++o1)
     {
-      const View * view1 = sfm_data.views.at(itObs1->first).get();
+      const LandmarksData::ObservationRecord& record1 = data.observation(o1);
+      const View * view1 = sfm_data.views.at(record1.viewId).get();
       const geometry::Pose3 pose1 = sfm_data.getPose(*view1);
       const camera::IntrinsicBase * intrinsic1 = sfm_data.intrinsics.at(view1->getIntrinsicId()).get();
 
-      Observations::const_iterator itObs2 = itObs1;
-      ++itObs2;
-      for (; itObs2 != observations.end(); ++itObs2)
+      for (std::size_t o2 = o1 + 1; o2 < data.obsEnd(i); ++o2)
       {
-        const View * view2 = sfm_data.views.at(itObs2->first).get();
+        const LandmarksData::ObservationRecord& record2 = data.observation(o2);
+        const View * view2 = sfm_data.views.at(record2.viewId).get();
         const geometry::Pose3 pose2 = sfm_data.getPose(*view2);
         const camera::IntrinsicBase * intrinsic2 = sfm_data.intrinsics.at(view2->getIntrinsicId()).get();
 
         const double angle = AngleBetweenRays(
           pose1, intrinsic1, pose2, intrinsic2,
-          itObs1->second.x, itObs2->second.x);
+          Vec2(record1.x, record1.y), Vec2(record2.x, record2.y));
         max_angle = std::max(angle, max_angle);
       }
     }
     if (max_angle < dMinAcceptedAngle)
     {
-      iterTracks = sfm_data.structure.erase(iterTracks);
+      data.eraseLandmark(i);
       ++removedTrack_count;
     }
-    else
-      ++iterTracks;
+  }
+
+  for (std::size_t i = 0; i < data.nbLandmarks(); ++i)
+  {
+    if (data.isLandmarkErased(i))
+      sfm_data.structure.erase(data.landmarkId(i));
   }
   return removedTrack_count;
 }
@@ -143,30 +300,23 @@ bool eraseObservationsWithMissingPoses(SfMData& sfm_data, const IndexT min_point
   std::transform(sfm_data.GetPoses().begin(), sfm_data.GetPoses().end(),
     std::inserter(reconstructedPoseIndexes, reconstructedPoseIndexes.begin()), stl::RetrieveKey());
 
-  // For each landmark:
-  //  - Check if we need to keep the observations & the track
-  Landmarks::iterator itLandmarks = sfm_data.structure.begin();
-  while (itLandmarks != sfm_data.structure.end())
-  {
-    Observations & observations = itLandmarks->second.observations;
-    Observations::iterator itObs = observations.begin();
-    while (itObs != observations.end())
+  // Drop the observations of the unposed views, compacting each modified
+  // landmark in one pass instead of erasing entry by entry from the flat_map
+  removed_elements = sfm_data.eraseObservationsIf(
+    [&](IndexT viewId, const Observation&)
     {
-      const IndexT ViewId = itObs->first;
-      const View * v = sfm_data.GetViews().at(ViewId).get();
-      if (reconstructedPoseIndexes.count(v->getPoseId()) == 0)
-      {
-        itObs = observations.erase(itObs);
-        ++removed_elements;
-      }
-      else
-        ++itObs;
-    }
-    if (observations.empty() || observations.size() < min_points_per_landmark)
-      itLandmarks = sfm_data.structure.erase(itLandmarks);
-    else
-      ++itLandmarks;
-  }
+      const View * v = sfm_data.GetViews().at(viewId).get();
+      return reconstructedPoseIndexes.count(v->getPoseId()) == 0;
+    });
+
+  // then remove the landmarks left with too few observations
+  sfm_data.eraseLandmarksIf(
+    [min_points_per_landmark](IndexT, const Landmark& landmark)
+    {
+      return landmark.observations.empty() ||
+             landmark.observations.size() < min_points_per_landmark;
+    });
+
   return removed_elements > 0;
 }
 
@@ -7,6 +7,7 @@
 
 #include <aliceVision/types.hpp>
 #include <aliceVision/sfm/SfMData.hpp>
+#include <aliceVision/sfm/ResidualHistogram.hpp>
 
 namespace aliceVision {
 namespace sfm {
@@ -26,9 +27,15 @@ inline PairSet Pair_filter(const IterablePairs& pairs, const IterableIndex& inde
 
 /// Remove observations with too large reprojection error.
 /// Return the number of removed tracks.
+/// If a residual histogram is given it is refreshed with the residuals of the
+/// kept observations (the scan computes them anyway), and when
+/// adaptivePercentile is in ]0, 1[ the histogram content of the previous call
+/// tightens the pixel threshold down to that percentile of the residuals.
 IndexT RemoveOutliers_PixelResidualError(SfMData& sfm_data,
                                          const double dThresholdPixel,
-                                         const unsigned int minTrackLength = 2);
+                                         const unsigned int minTrackLength = 2,
+                                         ResidualHistogram* residualHistogram = NULL,
+                                         const double adaptivePercentile = 0.0);
 
 // Remove tracks that have a small angle (tracks with tiny angle leads to instable 3D points)
 // Return the number of removed tracks
@@ -9,6 +9,7 @@
 #include "aliceVision/stl/mapUtils.hpp"
 #include "aliceVision/sfm/sfmDataIO_json.hpp"
 #include "aliceVision/sfm/sfmDataIO_cereal.hpp"
+#include "aliceVision/sfm/sfmDataIO_chunked.hpp"
 #include "aliceVision/sfm/sfmDataIO_ply.hpp"
 #include "aliceVision/sfm/sfmDataIO_baf.hpp"
 #include "aliceVision/sfm/sfmDataIO_gt.hpp"
@@ -100,6 +101,8 @@ bool Load(SfMData& sfmData, const std::string& filename, ESfMData partFlag)
     bStatus = Load_Cereal<cereal::JSONInputArchive>(sfmData, filename, partFlag);
   else if (ext == "bin")
     bStatus = Load_Cereal<cereal::PortableBinaryInputArchive>(sfmData, filename, partFlag);
+  else if (ext == "sbin")
+    bStatus = loadChunkedBinary(sfmData, filename, partFlag);
   else if (ext == "xml")
     bStatus = Load_Cereal<cereal::XMLInputArchive>(sfmData, filename, partFlag);
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ALEMBIC)
@@ -138,6 +141,8 @@ bool Save(const SfMData& sfmData, const std::string& filename, ESfMData partFlag
     return Save_Cereal<cereal::JSONOutputArchive>(sfmData, filename, partFlag);
   else if (ext == "bin")
     return Save_Cereal<cereal::PortableBinaryOutputArchive>(sfmData, filename, partFlag);
+  else if (ext == "sbin")
+    return saveChunkedBinary(sfmData, filename, partFlag);
   else if (ext == "xml")
     return Save_Cereal<cereal::XMLOutputArchive>(sfmData, filename, partFlag);
   else if (ext == "ply")
@@ -156,6 +161,42 @@ bool Save(const SfMData& sfmData, const std::string& filename, ESfMData partFlag
   return false;
 }
 
+AsyncSaver::~AsyncSaver()
+{
+  if(!wait())
+    ALICEVISION_LOG_WARNING("Background SfMData save failed.");
+}
+
+void AsyncSaver::save(const SfMData& sfmData, const std::string& filename, ESfMData partFlag)
+{
+  // Snapshot the scene: the containers are copied by value, the shared views and
+  // intrinsics are deep copied, so the caller can keep modifying its own scene
+  // while the background thread serializes the snapshot.
+  std::shared_ptr<SfMData> snapshot = std::make_shared<SfMData>(sfmData);
+  for(auto& viewPair : snapshot->views)
+    viewPair.second = std::make_shared<View>(*viewPair.second);
+  for(auto& intrinsicPair : snapshot->intrinsics)
+    intrinsicPair.second.reset(intrinsicPair.second->clone());
+
+  std::atomic<bool>* success = &_success;
+  _threads.emplace_back([snapshot, filename, partFlag, success]
+    {
+      if(!Save(*snapshot, filename, partFlag))
+        *success = false;
+    });
+}
+
+bool AsyncSaver::wait()
+{
+  for(std::thread& thread : _threads)
+  {
+    if(thread.joinable())
+      thread.join();
+  }
+  _threads.clear();
+  return _success;
+}
+
 } // namespace sfm
 } // namespace aliceVision
 
@@ -7,6 +7,11 @@
 
 #include "aliceVision/sfm/SfMData.hpp"
 
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
 namespace aliceVision {
 namespace sfm {
 
@@ -30,5 +35,32 @@ bool Load(SfMData & sfm_data, const std::string & filename, ESfMData flags_part)
 /// Save SfMData SfM scene to a file
 bool Save(const SfMData & sfm_data, const std::string & filename, ESfMData flags_part);
 
+/**
+ * @brief Save SfMData SfM scenes to files on background threads.
+ *
+ * save() takes a snapshot of the scene (shared views and intrinsics are deep copied)
+ * and writes the file from a background thread, so the caller can keep working on its
+ * own scene while the export runs. Each save gets its own thread, wait() (or the
+ * destruction of the saver) blocks until every pending save completes.
+ */
+class AsyncSaver
+{
+public:
+  AsyncSaver() = default;
+
+  /// Wait for the pending saves to complete
+  ~AsyncSaver();
+
+  /// Snapshot the scene and save it to the given file on a background thread
+  void save(const SfMData & sfm_data, const std::string & filename, ESfMData flags_part);
+
+  /// Wait for the pending saves, return false if any of them failed
+  bool wait();
+
+private:
+  std::vector<std::thread> _threads;
+  std::atomic<bool> _success{true};
+};
+
 } // namespace sfm
 } // namespace aliceVision
@@ -0,0 +1,580 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "sfmDataIO_chunked.hpp"
+
+#include <aliceVision/sfm/sfmDataIO_cereal.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <cereal/archives/portable_binary.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define ALICEVISION_HAVE_MMAP_SFM
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace aliceVision {
+namespace sfm {
+
+namespace {
+
+// Chunked binary SfMData file (.sbin):
+// - header : magic "AVSFMBIN", format version (uint32), nbSections (uint32)
+// - table  : nbSections entries { id (uint32), offset (uint64), size (uint64) }
+// - payload: one independent chunk per section, so a consumer can seek to and
+//   read only the sections requested by its ESfMData flags.
+// Views, intrinsics (polymorphic), poses/rigs and control points reuse the
+// cereal portable binary serialization as self-contained sub-archives.
+// Landmarks and their observations are flat fixed-size record arrays:
+// - STRUCTURE    : count, then { id(u32), descType(i32), X(3xf64), rgb(3xu8) }
+// - OBSERVATIONS : count, then { landmarkId(u32), viewId(u32), featId(u32),
+//                                x(f64), y(f64) }
+// The landmark and observation arrays are parsed in-place from a
+// memory-mapped file when possible, sharded across the available worker
+// threads: no per-element stream deserialization happens on the critical
+// path.
+
+const char SBIN_MAGIC[8] = {'A','V','S','F','M','B','I','N'};
+const std::uint32_t SBIN_VERSION = 1;
+
+enum ESection : std::uint32_t
+{
+  SECTION_FOLDERS        = 1,
+  SECTION_VIEWS          = 2,
+  SECTION_INTRINSICS     = 3,
+  SECTION_EXTRINSICS     = 4,
+  SECTION_STRUCTURE      = 5,
+  SECTION_OBSERVATIONS   = 6,
+  SECTION_CONTROL_POINTS = 7
+};
+
+struct SectionEntry
+{
+  std::uint32_t id = 0;
+  std::uint64_t offset = 0;
+  std::uint64_t size = 0;
+};
+
+template<typename T>
+inline void writePod(std::ostream& stream, const T& value)
+{
+  stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+inline bool readPod(std::istream& stream, T& value)
+{
+  stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+  return bool(stream);
+}
+
+template<typename T>
+inline const char* readPodFrom(const char* data, T& value)
+{
+  std::memcpy(&value, data, sizeof(T));
+  return data + sizeof(T);
+}
+
+// One landmark record in the STRUCTURE section
+const std::size_t kLandmarkRecordSize = sizeof(std::uint32_t) + sizeof(std::int32_t) + 3 * sizeof(double) + 3;
+// One observation record in the OBSERVATIONS section
+const std::size_t kObservationRecordSize = 3 * sizeof(std::uint32_t) + 2 * sizeof(double);
+
+/// Read access to one section payload: the file is memory-mapped when
+/// possible, with a seek + bulk read fallback.
+class SectionData
+{
+public:
+  ~SectionData()
+  {
+#ifdef ALICEVISION_HAVE_MMAP_SFM
+    if(_mapped != nullptr)
+      ::munmap(_mapped, _mappedSize);
+#endif
+  }
+
+  bool open(const std::string& filename, const SectionEntry& section)
+  {
+#ifdef ALICEVISION_HAVE_MMAP_SFM
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if(fd >= 0)
+    {
+      struct stat fileStat;
+      if(::fstat(fd, &fileStat) == 0 &&
+         std::uint64_t(fileStat.st_size) >= section.offset + section.size)
+      {
+        void* mapped = ::mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if(mapped != MAP_FAILED)
+        {
+          _mapped = mapped;
+          _mappedSize = fileStat.st_size;
+          _data = static_cast<const char*>(mapped) + section.offset;
+          return true;
+        }
+      }
+      else
+      {
+        ::close(fd);
+      }
+    }
+    // fall through to the bulk read on any mapping failure
+#endif
+
+    std::ifstream stream(filename.c_str(), std::ios::in | std::ios::binary);
+    if(!stream.is_open())
+      return false;
+    stream.seekg(section.offset);
+    _buffer.resize(section.size);
+    stream.read(&_buffer[0], section.size);
+    if(!stream)
+      return false;
+    _data = &_buffer[0];
+    return true;
+  }
+
+  const char* data() const { return _data; }
+
+private:
+  const char* _data = nullptr;
+  std::vector<char> _buffer;
+#ifdef ALICEVISION_HAVE_MMAP_SFM
+  void* _mapped = nullptr;
+  std::size_t _mappedSize = 0;
+#endif
+};
+
+/// The ESfMData flag of a section, 0 for the sections saved unconditionally
+ESfMData sectionPartFlag(std::uint32_t sectionId)
+{
+  switch(sectionId)
+  {
+    case SECTION_VIEWS:          return VIEWS;
+    case SECTION_INTRINSICS:     return INTRINSICS;
+    case SECTION_EXTRINSICS:     return EXTRINSICS;
+    case SECTION_STRUCTURE:      return STRUCTURE;
+    case SECTION_OBSERVATIONS:   return OBSERVATIONS;
+    case SECTION_CONTROL_POINTS: return CONTROL_POINTS;
+    default:                     return ESfMData(0);
+  }
+}
+
+/// Read and check the header and section table of a chunked binary file.
+/// The stream is left right after the table.
+bool readSectionTable(std::istream& stream, const std::string& filename,
+                      std::map<std::uint32_t, SectionEntry>& toc)
+{
+  char magic[8];
+  stream.read(magic, sizeof(magic));
+  if(!stream || !std::equal(magic, magic + sizeof(magic), SBIN_MAGIC))
+  {
+    ALICEVISION_LOG_WARNING("Invalid chunked binary SfMData file: " << filename);
+    return false;
+  }
+
+  std::uint32_t version = 0;
+  std::uint32_t nbSections = 0;
+  readPod(stream, version);
+  if(!readPod(stream, nbSections))
+    return false;
+  if(version != SBIN_VERSION)
+  {
+    ALICEVISION_LOG_WARNING("Unsupported chunked binary SfMData version "
+                            << version << ": " << filename);
+    return false;
+  }
+
+  for(std::uint32_t i = 0; i < nbSections; ++i)
+  {
+    SectionEntry entry;
+    readPod(stream, entry.id);
+    readPod(stream, entry.offset);
+    if(!readPod(stream, entry.size))
+      return false;
+    toc[entry.id] = entry;
+  }
+  return true;
+}
+
+/// Copy one section payload verbatim from \p source to \p dest
+bool copySectionPayload(std::istream& source, const SectionEntry& section, std::ostream& dest)
+{
+  source.seekg(section.offset);
+  std::vector<char> buffer(std::size_t(std::min<std::uint64_t>(section.size, 1 << 20)));
+  std::uint64_t remaining = section.size;
+  while(remaining > 0)
+  {
+    const std::size_t chunkSize = std::size_t(std::min<std::uint64_t>(remaining, buffer.size()));
+    source.read(&buffer[0], chunkSize);
+    if(!source)
+      return false;
+    dest.write(&buffer[0], chunkSize);
+    remaining -= chunkSize;
+  }
+  return bool(dest);
+}
+
+void writeStructureSection(std::ostream& stream, const Landmarks& landmarks)
+{
+  writePod(stream, std::uint64_t(landmarks.size()));
+  for(const auto& landmarkPair: landmarks)
+  {
+    const Landmark& landmark = landmarkPair.second;
+    writePod(stream, std::uint32_t(landmarkPair.first));
+    writePod(stream, std::int32_t(landmark.descType));
+    writePod(stream, double(landmark.X(0)));
+    writePod(stream, double(landmark.X(1)));
+    writePod(stream, double(landmark.X(2)));
+    writePod(stream, landmark.rgb.r());
+    writePod(stream, landmark.rgb.g());
+    writePod(stream, landmark.rgb.b());
+  }
+}
+
+/// Parse the flat landmark records. The records are written in container
+/// order, so every shard covers a disjoint increasing key range: the shards
+/// are deserialized into local containers on worker threads and spliced back
+/// in order with an end hint, without rehashing the merged elements.
+bool parseStructure(const char* data, std::uint64_t sectionSize, Landmarks& landmarks)
+{
+  std::uint64_t nbLandmarks = 0;
+  if(sectionSize < sizeof(nbLandmarks))
+    return false;
+  data = readPodFrom(data, nbLandmarks);
+  if(sectionSize < sizeof(nbLandmarks) + nbLandmarks * kLandmarkRecordSize)
+    return false;
+
+  const int nbShards = std::max(1, omp_get_max_threads());
+  std::vector<Landmarks> shards(nbShards);
+
+  #pragma omp parallel for schedule(static, 1)
+  for(int shardIndex = 0; shardIndex < nbShards; ++shardIndex)
+  {
+    const std::uint64_t begin = nbLandmarks * shardIndex / nbShards;
+    const std::uint64_t end = nbLandmarks * (shardIndex + 1) / nbShards;
+
+    Landmarks& shard = shards[shardIndex];
+    Landmarks::iterator hint = shard.begin();
+    const char* record = data + begin * kLandmarkRecordSize;
+    for(std::uint64_t i = begin; i < end; ++i)
+    {
+      std::uint32_t id = 0;
+      std::int32_t descType = 0;
+      double x = 0, y = 0, z = 0;
+      unsigned char r = 0, g = 0, b = 0;
+      record = readPodFrom(record, id);
+      record = readPodFrom(record, descType);
+      record = readPodFrom(record, x);
+      record = readPodFrom(record, y);
+      record = readPodFrom(record, z);
+      record = readPodFrom(record, r);
+      record = readPodFrom(record, g);
+      record = readPodFrom(record, b);
+
+      Landmark landmark(Vec3(x, y, z), feature::EImageDescriberType(descType));
+      landmark.rgb = image::RGBColor(r, g, b);
+      hint = shard.emplace_hint(hint, IndexT(id), std::move(landmark));
+    }
+  }
+
+  for(Landmarks& shard: shards)
+  {
+    for(auto& landmarkPair: shard)
+      landmarks.emplace_hint(landmarks.end(), landmarkPair.first, std::move(landmarkPair.second));
+  }
+  return true;
+}
+
+void writeObservationsSection(std::ostream& stream, const Landmarks& landmarks)
+{
+  std::uint64_t nbObservations = 0;
+  for(const auto& landmarkPair: landmarks)
+    nbObservations += landmarkPair.second.observations.size();
+
+  writePod(stream, nbObservations);
+  for(const auto& landmarkPair: landmarks)
+  {
+    for(const auto& observationPair: landmarkPair.second.observations)
+    {
+      const Observation& observation = observationPair.second;
+      writePod(stream, std::uint32_t(landmarkPair.first));
+      writePod(stream, std::uint32_t(observationPair.first));
+      writePod(stream, std::uint32_t(observation.id_feat));
+      writePod(stream, double(observation.x(0)));
+      writePod(stream, double(observation.x(1)));
+    }
+  }
+}
+
+/// Attach the observation records [begin, end) to the landmarks they belong
+/// to. The records were written grouped by landmark and sorted by view id, so
+/// the flat_map insertions stay at the end of each container.
+bool attachObservations(const char* records, std::uint64_t begin, std::uint64_t end, Landmarks& landmarks)
+{
+  const char* data = records + begin * kObservationRecordSize;
+  Landmarks::iterator landmarkIt = landmarks.end();
+  for(std::uint64_t i = begin; i < end; ++i)
+  {
+    std::uint32_t landmarkId = 0, viewId = 0, featId = 0;
+    double x = 0, y = 0;
+    data = readPodFrom(data, landmarkId);
+    data = readPodFrom(data, viewId);
+    data = readPodFrom(data, featId);
+    data = readPodFrom(data, x);
+    data = readPodFrom(data, y);
+
+    if(landmarkIt == landmarks.end() || landmarkIt->first != IndexT(landmarkId))
+    {
+      landmarkIt = landmarks.find(IndexT(landmarkId));
+      if(landmarkIt == landmarks.end())
+        return false; // observation without its landmark: corrupted file
+    }
+    landmarkIt->second.observations.emplace_hint(
+      landmarkIt->second.observations.end(),
+      IndexT(viewId), Observation(Vec2(x, y), IndexT(featId)));
+  }
+  return true;
+}
+
+/// Parse the flat observation records and attach them to the landmarks.
+/// The shard boundaries are aligned on the landmark grouping, so every worker
+/// thread fills a disjoint subset of the landmarks and the only shared state,
+/// the landmarks container itself, is read-only during the parallel section.
+bool parseObservations(const char* data, std::uint64_t sectionSize, Landmarks& landmarks)
+{
+  std::uint64_t nbObservations = 0;
+  if(sectionSize < sizeof(nbObservations))
+    return false;
+  const char* records = readPodFrom(data, nbObservations);
+  if(sectionSize < sizeof(nbObservations) + nbObservations * kObservationRecordSize)
+    return false;
+
+  const auto landmarkIdAt = [records](std::uint64_t i) -> std::uint32_t
+  {
+    std::uint32_t id = 0;
+    std::memcpy(&id, records + i * kObservationRecordSize, sizeof(id));
+    return id;
+  };
+
+  const int nbShards = std::max(1, omp_get_max_threads());
+  std::vector<std::uint64_t> bounds(nbShards + 1, 0);
+  bounds[nbShards] = nbObservations;
+  for(int shardIndex = 1; shardIndex < nbShards; ++shardIndex)
+  {
+    std::uint64_t bound = std::max(bounds[shardIndex - 1], nbObservations * shardIndex / nbShards);
+    while(bound > 0 && bound < nbObservations && landmarkIdAt(bound) == landmarkIdAt(bound - 1))
+      ++bound;
+    bounds[shardIndex] = bound;
+  }
+
+  std::vector<char> shardOk(nbShards, 1);
+  #pragma omp parallel for schedule(static, 1)
+  for(int shardIndex = 0; shardIndex < nbShards; ++shardIndex)
+    shardOk[shardIndex] = attachObservations(records, bounds[shardIndex], bounds[shardIndex + 1], landmarks);
+  return std::find(shardOk.begin(), shardOk.end(), char(0)) == shardOk.end();
+}
+
+} // namespace
+
+bool saveChunkedBinary(const SfMData& sfmData, const std::string& filename, ESfMData partFlag)
+{
+  return saveChunkedBinary(sfmData, filename, partFlag, std::string(), ESfMData(0));
+}
+
+bool saveChunkedBinary(const SfMData& sfmData, const std::string& filename, ESfMData partFlag,
+                       const std::string& passThroughFilename, ESfMData passThroughFlags)
+{
+  // Section table of the pass-through source
+  std::ifstream passThroughStream;
+  std::map<std::uint32_t, SectionEntry> passThroughToc;
+  if(passThroughFlags != 0)
+  {
+    passThroughStream.open(passThroughFilename.c_str(), std::ios::in | std::ios::binary);
+    if(!passThroughStream.is_open() ||
+       !readSectionTable(passThroughStream, passThroughFilename, passThroughToc))
+      return false;
+  }
+
+  std::ofstream stream(filename.c_str(), std::ios::out | std::ios::binary);
+  if(!stream.is_open())
+    return false;
+
+  // List the sections to write
+  std::vector<std::uint32_t> sectionIds;
+  sectionIds.push_back(SECTION_FOLDERS);
+  if(partFlag & VIEWS)
+    sectionIds.push_back(SECTION_VIEWS);
+  if(partFlag & INTRINSICS)
+    sectionIds.push_back(SECTION_INTRINSICS);
+  if(partFlag & EXTRINSICS)
+    sectionIds.push_back(SECTION_EXTRINSICS);
+  if(partFlag & STRUCTURE)
+    sectionIds.push_back(SECTION_STRUCTURE);
+  if((partFlag & STRUCTURE) && (partFlag & OBSERVATIONS))
+    sectionIds.push_back(SECTION_OBSERVATIONS);
+  if(partFlag & CONTROL_POINTS)
+    sectionIds.push_back(SECTION_CONTROL_POINTS);
+
+  // Header and a placeholder section table, rewritten once the offsets are known
+  stream.write(SBIN_MAGIC, sizeof(SBIN_MAGIC));
+  writePod(stream, SBIN_VERSION);
+  writePod(stream, std::uint32_t(sectionIds.size()));
+  const std::streampos tocPos = stream.tellp();
+  std::vector<SectionEntry> toc(sectionIds.size());
+  for(const SectionEntry& entry: toc)
+  {
+    writePod(stream, entry.id);
+    writePod(stream, entry.offset);
+    writePod(stream, entry.size);
+  }
+
+  for(std::size_t i = 0; i < sectionIds.size(); ++i)
+  {
+    toc[i].id = sectionIds[i];
+    toc[i].offset = std::uint64_t(stream.tellp());
+
+    const ESfMData sectionFlag = sectionPartFlag(sectionIds[i]);
+    if(sectionFlag != 0 && (passThroughFlags & sectionFlag) && passThroughToc.count(sectionIds[i]))
+    {
+      // Copy the section payload verbatim from the source file
+      if(!copySectionPayload(passThroughStream, passThroughToc.at(sectionIds[i]), stream))
+        return false;
+    }
+    else
+    switch(sectionIds[i])
+    {
+      case SECTION_FOLDERS:
+      {
+        cereal::PortableBinaryOutputArchive archive(stream);
+        archive(sfmData._featuresFolders, sfmData._matchesFolders);
+      }
+      break;
+      case SECTION_VIEWS:
+      {
+        cereal::PortableBinaryOutputArchive archive(stream);
+        archive(sfmData.views);
+      }
+      break;
+      case SECTION_INTRINSICS:
+      {
+        cereal::PortableBinaryOutputArchive archive(stream);
+        archive(sfmData.intrinsics);
+      }
+      break;
+      case SECTION_EXTRINSICS:
+      {
+        cereal::PortableBinaryOutputArchive archive(stream);
+        archive(sfmData.GetPoses(), sfmData.getRigs());
+      }
+      break;
+      case SECTION_STRUCTURE:
+        writeStructureSection(stream, sfmData.structure);
+      break;
+      case SECTION_OBSERVATIONS:
+        writeObservationsSection(stream, sfmData.structure);
+      break;
+      case SECTION_CONTROL_POINTS:
+      {
+        cereal::PortableBinaryOutputArchive archive(stream);
+        archive(sfmData.control_points);
+      }
+      break;
+    }
+
+    toc[i].size = std::uint64_t(stream.tellp()) - toc[i].offset;
+  }
+
+  // Rewrite the section table with the final offsets
+  stream.seekp(tocPos);
+  for(const SectionEntry& entry: toc)
+  {
+    writePod(stream, entry.id);
+    writePod(stream, entry.offset);
+    writePod(stream, entry.size);
+  }
+  return bool(stream);
+}
+
+bool loadChunkedBinary(SfMData& sfmData, const std::string& filename, ESfMData partFlag)
+{
+  std::ifstream stream(filename.c_str(), std::ios::in | std::ios::binary);
+  if(!stream.is_open())
+    return false;
+
+  std::map<std::uint32_t, SectionEntry> toc;
+  if(!readSectionTable(stream, filename, toc))
+    return false;
+
+  try
+  {
+    if(toc.count(SECTION_FOLDERS))
+    {
+      stream.seekg(toc.at(SECTION_FOLDERS).offset);
+      cereal::PortableBinaryInputArchive archive(stream);
+      archive(sfmData._featuresFolders, sfmData._matchesFolders);
+    }
+    if((partFlag & VIEWS) && toc.count(SECTION_VIEWS))
+    {
+      stream.seekg(toc.at(SECTION_VIEWS).offset);
+      cereal::PortableBinaryInputArchive archive(stream);
+      archive(sfmData.views);
+    }
+    if((partFlag & INTRINSICS) && toc.count(SECTION_INTRINSICS))
+    {
+      stream.seekg(toc.at(SECTION_INTRINSICS).offset);
+      cereal::PortableBinaryInputArchive archive(stream);
+      archive(sfmData.intrinsics);
+    }
+    if((partFlag & EXTRINSICS) && toc.count(SECTION_EXTRINSICS))
+    {
+      stream.seekg(toc.at(SECTION_EXTRINSICS).offset);
+      cereal::PortableBinaryInputArchive archive(stream);
+      archive(sfmData.GetPoses(), sfmData.getRigs());
+    }
+    if((partFlag & STRUCTURE) && toc.count(SECTION_STRUCTURE))
+    {
+      const SectionEntry& structureEntry = toc.at(SECTION_STRUCTURE);
+      SectionData structureData;
+      if(!structureData.open(filename, structureEntry) ||
+         !parseStructure(structureData.data(), structureEntry.size, sfmData.structure))
+        return false;
+
+      if((partFlag & OBSERVATIONS) && toc.count(SECTION_OBSERVATIONS))
+      {
+        const SectionEntry& observationsEntry = toc.at(SECTION_OBSERVATIONS);
+        SectionData observationsData;
+        if(!observationsData.open(filename, observationsEntry) ||
+           !parseObservations(observationsData.data(), observationsEntry.size, sfmData.structure))
+          return false;
+      }
+    }
+    if((partFlag & CONTROL_POINTS) && toc.count(SECTION_CONTROL_POINTS))
+    {
+      stream.seekg(toc.at(SECTION_CONTROL_POINTS).offset);
+      cereal::PortableBinaryInputArchive archive(stream);
+      archive(sfmData.control_points);
+    }
+  }
+  catch(const cereal::Exception& e)
+  {
+    ALICEVISION_LOG_WARNING(e.what());
+    return false;
+  }
+  return true;
+}
+
+} // namespace sfm
+} // namespace aliceVision
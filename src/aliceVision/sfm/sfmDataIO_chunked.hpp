@@ -0,0 +1,66 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/sfm/sfmDataIO.hpp>
+
+#include <string>
+
+namespace aliceVision {
+namespace sfm {
+
+/**
+ * @brief Load a chunked binary SfMData file (.sbin).
+ *
+ * The file starts with a versioned section table, so only the sections
+ * matching \p partFlag are read: loading the views of a large scene does not
+ * pay for its landmarks. The landmarks and their observations are stored as
+ * flat fixed-size record arrays, parsed in-place from a memory-mapped file on
+ * POSIX systems (bulk-read otherwise) and sharded across the available worker
+ * threads instead of being deserialized one element at a time.
+ *
+ * @param[out] sfmData The output SfMData
+ * @param[in] filename The input filename
+ * @param[in] partFlag The ESfMData sections to load
+ * @return true if completed
+ */
+bool loadChunkedBinary(SfMData& sfmData, const std::string& filename, ESfMData partFlag);
+
+/**
+ * @brief Save a SfMData to a chunked binary file (.sbin).
+ * @param[in] sfmData The input SfMData
+ * @param[in] filename The output filename
+ * @param[in] partFlag The ESfMData sections to save
+ * @return true if completed
+ */
+bool saveChunkedBinary(const SfMData& sfmData, const std::string& filename, ESfMData partFlag);
+
+/**
+ * @brief Save a SfMData to a chunked binary file (.sbin), copying some
+ * sections verbatim from another chunked binary file.
+ *
+ * The sections selected by \p passThroughFlags are not serialized from
+ * \p sfmData: their payload bytes are copied as-is from \p passThroughFilename.
+ * This lets a tool that only edits the cameras of a large scene skip both the
+ * loading and the re-serialization of the sections it does not touch (e.g.
+ * 50M observation records). The caller must guarantee that the copied
+ * sections are still consistent with the serialized ones: e.g. observations
+ * can only pass through if the landmark keys are unchanged.
+ * A pass-through section missing from the source file is written from
+ * \p sfmData as usual.
+ *
+ * @param[in] sfmData The input SfMData
+ * @param[in] filename The output filename
+ * @param[in] partFlag The ESfMData sections to save
+ * @param[in] passThroughFilename The chunked binary file to copy from
+ * @param[in] passThroughFlags The ESfMData sections to copy verbatim
+ * @return true if completed
+ */
+bool saveChunkedBinary(const SfMData& sfmData, const std::string& filename, ESfMData partFlag,
+                       const std::string& passThroughFilename, ESfMData passThroughFlags);
+
+} // namespace sfm
+} // namespace aliceVision
@@ -0,0 +1,511 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "sfmDataIO_delta.hpp"
+#include "sfmDataIO_json.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/property_tree/json_parser.hpp>
+
+#include <iomanip>
+#include <sstream>
+
+namespace aliceVision {
+namespace sfm {
+
+namespace {
+
+// FNV-1a, enough to detect modified elements between two snapshots
+std::uint64_t hashBytes(const void* data, std::size_t size, std::uint64_t hash)
+{
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  for(std::size_t i = 0; i < size; ++i)
+  {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+const std::uint64_t hashSeed = 14695981039346656037ULL;
+
+template<typename T>
+std::uint64_t hashValue(const T& value, std::uint64_t hash)
+{
+  return hashBytes(&value, sizeof(T), hash);
+}
+
+std::uint64_t hashString(const std::string& value, std::uint64_t hash)
+{
+  return hashBytes(value.data(), value.size(), hashValue(value.size(), hash));
+}
+
+std::uint64_t hashPose(const geometry::Pose3& pose, std::uint64_t hash)
+{
+  hash = hashBytes(pose.rotation().data(), 9 * sizeof(double), hash);
+  return hashBytes(pose.center().data(), 3 * sizeof(double), hash);
+}
+
+std::uint64_t hashView(const View& view)
+{
+  std::uint64_t hash = hashSeed;
+  hash = hashValue(view.getViewId(), hash);
+  hash = hashValue(view.getPoseId(), hash);
+  hash = hashValue(view.getIntrinsicId(), hash);
+  hash = hashValue(view.getResectionId(), hash);
+  if(view.isPartOfRig())
+  {
+    hash = hashValue(view.getRigId(), hash);
+    hash = hashValue(view.getSubPoseId(), hash);
+  }
+  hash = hashString(view.getImagePath(), hash);
+  hash = hashValue(view.getWidth(), hash);
+  hash = hashValue(view.getHeight(), hash);
+  for(const auto& metadataPair : view.getMetadata())
+  {
+    hash = hashString(metadataPair.first, hash);
+    hash = hashString(metadataPair.second, hash);
+  }
+  return hash;
+}
+
+std::uint64_t hashIntrinsic(const camera::IntrinsicBase& intrinsic)
+{
+  std::uint64_t hash = hashSeed;
+  hash = hashValue(intrinsic.getType(), hash);
+  hash = hashValue(intrinsic.w(), hash);
+  hash = hashValue(intrinsic.h(), hash);
+  hash = hashString(intrinsic.serialNumber(), hash);
+  hash = hashValue(intrinsic.initialFocalLengthPix(), hash);
+  const std::vector<double> params = intrinsic.getParams();
+  return hashBytes(params.data(), params.size() * sizeof(double), hash);
+}
+
+std::uint64_t hashRig(const Rig& rig)
+{
+  std::uint64_t hash = hashSeed;
+  for(const RigSubPose& subPose : rig.getSubPoses())
+  {
+    hash = hashValue(subPose.status, hash);
+    hash = hashPose(subPose.pose, hash);
+  }
+  return hash;
+}
+
+std::uint64_t hashLandmark(const Landmark& landmark)
+{
+  std::uint64_t hash = hashSeed;
+  hash = hashValue(landmark.descType, hash);
+  hash = hashBytes(landmark.X.data(), 3 * sizeof(double), hash);
+  hash = hashValue(landmark.rgb.r(), hash);
+  hash = hashValue(landmark.rgb.g(), hash);
+  hash = hashValue(landmark.rgb.b(), hash);
+  for(const auto& obsPair : landmark.observations)
+  {
+    hash = hashValue(obsPair.first, hash);
+    hash = hashValue(obsPair.second.id_feat, hash);
+    hash = hashBytes(obsPair.second.x.data(), 2 * sizeof(double), hash);
+  }
+  return hash;
+}
+
+/// Ids present in the previous snapshot but absent from the current elements.
+template<typename MapT>
+std::vector<IndexT> removedIds(const std::map<IndexT, std::uint64_t>& hashes, const MapT& elements)
+{
+  std::vector<IndexT> removed;
+  for(const auto& hashPair : hashes)
+  {
+    if(elements.count(hashPair.first) == 0)
+      removed.push_back(hashPair.first);
+  }
+  return removed;
+}
+
+/// Write a list of removed ids as a JSON array.
+void saveRemovedIds(const std::string& name, const std::vector<IndexT>& removed, bpt::ptree& parentTree)
+{
+  if(removed.empty())
+    return;
+
+  bpt::ptree removedTree;
+  for(IndexT id : removed)
+  {
+    bpt::ptree idTree;
+    idTree.put("", id);
+    removedTree.push_back(std::make_pair("", idTree));
+  }
+  parentTree.add_child(name, removedTree);
+}
+
+} // namespace
+
+std::string deltaFilename(const std::string& baseFilename, std::size_t sequence)
+{
+  const boost::filesystem::path basePath(baseFilename);
+
+  std::ostringstream os;
+  os << basePath.stem().string() << "_delta_" << std::setw(4) << std::setfill('0') << sequence << ".json";
+
+  return (basePath.parent_path() / os.str()).string();
+}
+
+DeltaSaver::DeltaSaver(const std::string& baseFilename, ESfMData partFlag)
+  : _baseFilename(baseFilename)
+  , _partFlag(partFlag)
+{}
+
+bool DeltaSaver::save(const SfMData& sfmData)
+{
+  const bool saveViews = (_partFlag & VIEWS) == VIEWS;
+  const bool saveIntrinsics = (_partFlag & INTRINSICS) == INTRINSICS;
+  const bool saveExtrinsics = (_partFlag & EXTRINSICS) == EXTRINSICS;
+  const bool saveStructure = (_partFlag & STRUCTURE) == STRUCTURE;
+  const bool saveControlPoints = (_partFlag & CONTROL_POINTS) == CONTROL_POINTS;
+
+  const bool isBase = (_sequence == 0);
+
+  bpt::ptree fileTree;
+  bool anyChange = false;
+
+  if(!isBase)
+  {
+    saveMatrix("deltaVersion", Vec3(1, 0, 0), fileTree);
+    fileTree.put("sequence", _sequence);
+  }
+
+  // views
+  if(saveViews)
+  {
+    bpt::ptree viewsTree;
+    for(const auto& viewPair : sfmData.GetViews())
+    {
+      const std::uint64_t hash = hashView(*(viewPair.second));
+      auto it = _viewHashes.find(viewPair.first);
+      const bool changed = (it == _viewHashes.end() || it->second != hash);
+      if(changed)
+      {
+        if(!isBase)
+          saveView("", *(viewPair.second), viewsTree);
+        _viewHashes[viewPair.first] = hash;
+        anyChange = true;
+      }
+    }
+    if(!isBase && !viewsTree.empty())
+      fileTree.add_child("views", viewsTree);
+
+    const std::vector<IndexT> removed = removedIds(_viewHashes, sfmData.GetViews());
+    for(IndexT id : removed)
+      _viewHashes.erase(id);
+    anyChange |= !removed.empty();
+    if(!isBase)
+      saveRemovedIds("removedViews", removed, fileTree);
+  }
+
+  // intrinsics
+  if(saveIntrinsics)
+  {
+    bpt::ptree intrinsicsTree;
+    for(const auto& intrinsicPair : sfmData.GetIntrinsics())
+    {
+      const std::uint64_t hash = hashIntrinsic(*(intrinsicPair.second));
+      auto it = _intrinsicHashes.find(intrinsicPair.first);
+      if(it == _intrinsicHashes.end() || it->second != hash)
+      {
+        if(!isBase)
+          saveIntrinsic("", intrinsicPair.first, intrinsicPair.second, intrinsicsTree);
+        _intrinsicHashes[intrinsicPair.first] = hash;
+        anyChange = true;
+      }
+    }
+    if(!isBase && !intrinsicsTree.empty())
+      fileTree.add_child("intrinsics", intrinsicsTree);
+
+    const std::vector<IndexT> removed = removedIds(_intrinsicHashes, sfmData.GetIntrinsics());
+    for(IndexT id : removed)
+      _intrinsicHashes.erase(id);
+    anyChange |= !removed.empty();
+    if(!isBase)
+      saveRemovedIds("removedIntrinsics", removed, fileTree);
+  }
+
+  // extrinsics
+  if(saveExtrinsics)
+  {
+    // poses
+    bpt::ptree posesTree;
+    for(const auto& posePair : sfmData.GetPoses())
+    {
+      const std::uint64_t hash = hashPose(posePair.second, hashSeed);
+      auto it = _poseHashes.find(posePair.first);
+      if(it == _poseHashes.end() || it->second != hash)
+      {
+        if(!isBase)
+        {
+          bpt::ptree poseTree;
+          poseTree.put("poseId", posePair.first);
+          savePose3("pose", posePair.second, poseTree);
+          posesTree.push_back(std::make_pair("", poseTree));
+        }
+        _poseHashes[posePair.first] = hash;
+        anyChange = true;
+      }
+    }
+    if(!isBase && !posesTree.empty())
+      fileTree.add_child("poses", posesTree);
+
+    const std::vector<IndexT> removedPoses = removedIds(_poseHashes, sfmData.GetPoses());
+    for(IndexT id : removedPoses)
+      _poseHashes.erase(id);
+    anyChange |= !removedPoses.empty();
+    if(!isBase)
+      saveRemovedIds("removedPoses", removedPoses, fileTree);
+
+    // rigs
+    bpt::ptree rigsTree;
+    for(const auto& rigPair : sfmData.getRigs())
+    {
+      const std::uint64_t hash = hashRig(rigPair.second);
+      auto it = _rigHashes.find(rigPair.first);
+      if(it == _rigHashes.end() || it->second != hash)
+      {
+        if(!isBase)
+          saveRig("", rigPair.first, rigPair.second, rigsTree);
+        _rigHashes[rigPair.first] = hash;
+        anyChange = true;
+      }
+    }
+    if(!isBase && !rigsTree.empty())
+      fileTree.add_child("rigs", rigsTree);
+
+    const std::vector<IndexT> removedRigs = removedIds(_rigHashes, sfmData.getRigs());
+    for(IndexT id : removedRigs)
+      _rigHashes.erase(id);
+    anyChange |= !removedRigs.empty();
+    if(!isBase)
+      saveRemovedIds("removedRigs", removedRigs, fileTree);
+  }
+
+  // structure
+  if(saveStructure)
+  {
+    bpt::ptree structureTree;
+    for(const auto& landmarkPair : sfmData.GetLandmarks())
+    {
+      const std::uint64_t hash = hashLandmark(landmarkPair.second);
+      auto it = _landmarkHashes.find(landmarkPair.first);
+      if(it == _landmarkHashes.end() || it->second != hash)
+      {
+        if(!isBase)
+          saveLandmark("", landmarkPair.first, landmarkPair.second, structureTree);
+        _landmarkHashes[landmarkPair.first] = hash;
+        anyChange = true;
+      }
+    }
+    if(!isBase && !structureTree.empty())
+      fileTree.add_child("structure", structureTree);
+
+    const std::vector<IndexT> removed = removedIds(_landmarkHashes, sfmData.GetLandmarks());
+    for(IndexT id : removed)
+      _landmarkHashes.erase(id);
+    anyChange |= !removed.empty();
+    if(!isBase)
+      saveRemovedIds("removedStructure", removed, fileTree);
+  }
+
+  // control points
+  if(saveControlPoints)
+  {
+    bpt::ptree controlPointsTree;
+    for(const auto& controlPointPair : sfmData.GetControl_Points())
+    {
+      const std::uint64_t hash = hashLandmark(controlPointPair.second);
+      auto it = _controlPointHashes.find(controlPointPair.first);
+      if(it == _controlPointHashes.end() || it->second != hash)
+      {
+        if(!isBase)
+          saveLandmark("", controlPointPair.first, controlPointPair.second, controlPointsTree);
+        _controlPointHashes[controlPointPair.first] = hash;
+        anyChange = true;
+      }
+    }
+    if(!isBase && !controlPointsTree.empty())
+      fileTree.add_child("controlPoints", controlPointsTree);
+
+    const std::vector<IndexT> removed = removedIds(_controlPointHashes, sfmData.GetControl_Points());
+    for(IndexT id : removed)
+      _controlPointHashes.erase(id);
+    anyChange |= !removed.empty();
+    if(!isBase)
+      saveRemovedIds("removedControlPoints", removed, fileTree);
+  }
+
+  if(isBase)
+  {
+    // the first snapshot is a regular scene file, loadable on its own
+    if(!saveJSON(sfmData, _baseFilename, _partFlag))
+      return false;
+    ++_sequence;
+    return true;
+  }
+
+  if(!anyChange)
+  {
+    // nothing to write, the next delta keeps the sequence contiguous
+    ALICEVISION_LOG_DEBUG("DeltaSaver: no change since the previous snapshot, skip delta " << _sequence);
+    return true;
+  }
+
+  bpt::write_json(deltaFilename(_baseFilename, _sequence), fileTree);
+  ++_sequence;
+  return true;
+}
+
+namespace {
+
+bool applyDelta(SfMData& sfmData, const std::string& filename)
+{
+  bpt::ptree fileTree;
+
+  try
+  {
+    bpt::read_json(filename, fileTree);
+  }
+  catch(const bpt::json_parser::json_parser_error& e)
+  {
+    ALICEVISION_LOG_ERROR("Failed to read delta file '" << filename << "': " << e.what());
+    return false;
+  }
+
+  // changed or added elements replace the current ones
+  if(fileTree.count("views"))
+  {
+    for(bpt::ptree::value_type& viewNode : fileTree.get_child("views"))
+    {
+      View view;
+      loadView(view, viewNode.second);
+      sfmData.GetViews()[view.getViewId()] = std::make_shared<View>(view);
+    }
+  }
+
+  if(fileTree.count("intrinsics"))
+  {
+    for(bpt::ptree::value_type& intrinsicNode : fileTree.get_child("intrinsics"))
+    {
+      IndexT intrinsicId;
+      std::shared_ptr<camera::IntrinsicBase> intrinsic;
+      loadIntrinsic(intrinsicId, intrinsic, intrinsicNode.second);
+      sfmData.GetIntrinsics()[intrinsicId] = intrinsic;
+    }
+  }
+
+  if(fileTree.count("poses"))
+  {
+    for(bpt::ptree::value_type& poseNode : fileTree.get_child("poses"))
+    {
+      geometry::Pose3 pose;
+      loadPose3("pose", pose, poseNode.second);
+      sfmData.GetPoses()[poseNode.second.get<IndexT>("poseId")] = pose;
+    }
+  }
+
+  if(fileTree.count("rigs"))
+  {
+    for(bpt::ptree::value_type& rigNode : fileTree.get_child("rigs"))
+    {
+      IndexT rigId;
+      Rig rig;
+      loadRig(rigId, rig, rigNode.second);
+      sfmData.getRigs()[rigId] = rig;
+    }
+  }
+
+  if(fileTree.count("structure"))
+  {
+    for(bpt::ptree::value_type& landmarkNode : fileTree.get_child("structure"))
+    {
+      IndexT landmarkId;
+      Landmark landmark;
+      loadLandmark(landmarkId, landmark, landmarkNode.second);
+      sfmData.GetLandmarks()[landmarkId] = landmark;
+    }
+  }
+
+  if(fileTree.count("controlPoints"))
+  {
+    for(bpt::ptree::value_type& controlPointNode : fileTree.get_child("controlPoints"))
+    {
+      IndexT controlPointId;
+      Landmark controlPoint;
+      loadLandmark(controlPointId, controlPoint, controlPointNode.second);
+      sfmData.GetControl_Points()[controlPointId] = controlPoint;
+    }
+  }
+
+  // removed elements
+  if(fileTree.count("removedViews"))
+    for(bpt::ptree::value_type& idNode : fileTree.get_child("removedViews"))
+      sfmData.GetViews().erase(idNode.second.get_value<IndexT>());
+
+  if(fileTree.count("removedIntrinsics"))
+    for(bpt::ptree::value_type& idNode : fileTree.get_child("removedIntrinsics"))
+      sfmData.GetIntrinsics().erase(idNode.second.get_value<IndexT>());
+
+  if(fileTree.count("removedPoses"))
+    for(bpt::ptree::value_type& idNode : fileTree.get_child("removedPoses"))
+      sfmData.GetPoses().erase(idNode.second.get_value<IndexT>());
+
+  if(fileTree.count("removedRigs"))
+    for(bpt::ptree::value_type& idNode : fileTree.get_child("removedRigs"))
+      sfmData.getRigs().erase(idNode.second.get_value<IndexT>());
+
+  if(fileTree.count("removedStructure"))
+    for(bpt::ptree::value_type& idNode : fileTree.get_child("removedStructure"))
+      sfmData.GetLandmarks().erase(idNode.second.get_value<IndexT>());
+
+  if(fileTree.count("removedControlPoints"))
+    for(bpt::ptree::value_type& idNode : fileTree.get_child("removedControlPoints"))
+      sfmData.GetControl_Points().erase(idNode.second.get_value<IndexT>());
+
+  return true;
+}
+
+} // namespace
+
+bool materializeDeltaSequence(SfMData& sfmData, const std::string& baseFilename, std::size_t lastSequence)
+{
+  if(!loadJSON(sfmData, baseFilename, ESfMData::ALL))
+  {
+    ALICEVISION_LOG_ERROR("Failed to load delta base file '" << baseFilename << "'");
+    return false;
+  }
+
+  for(std::size_t sequence = 1; sequence <= lastSequence; ++sequence)
+  {
+    const std::string filename = deltaFilename(baseFilename, sequence);
+
+    if(!boost::filesystem::exists(filename))
+    {
+      // an explicitly requested snapshot must exist, a default request stops
+      // at the last delta found
+      if(lastSequence != std::numeric_limits<std::size_t>::max())
+      {
+        ALICEVISION_LOG_ERROR("Missing delta file '" << filename << "'");
+        return false;
+      }
+      break;
+    }
+
+    if(!applyDelta(sfmData, filename))
+      return false;
+  }
+
+  return true;
+}
+
+} // namespace sfm
+} // namespace aliceVision
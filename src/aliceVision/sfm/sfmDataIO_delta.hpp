@@ -0,0 +1,92 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/sfm/sfmDataIO.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <string>
+
+namespace aliceVision {
+namespace sfm {
+
+/**
+ * @brief Incremental JSON writer for intermediate SfMData snapshots.
+ *
+ * The first save() writes the whole scene as a regular JSON file; every
+ * following call writes only the views, intrinsics, poses, rigs and landmarks
+ * that changed since the previous call, plus the ids of the removed ones.
+ * During an incremental reconstruction the unchanged history dominates the
+ * scene, so each delta costs I/O proportional to the latest resection group
+ * instead of the whole reconstruction.
+ *
+ * The writer keeps a 64 bit fingerprint per element to detect changes, not a
+ * copy of the scene. Delta files are written next to the base file as
+ * "<base>_delta_NNNN.json"; a snapshot is materialized back into a SfMData
+ * with materializeDeltaSequence() or the sfmDeltaCompaction tool.
+ */
+class DeltaSaver
+{
+public:
+  /**
+   * @param[in] baseFilename The JSON file holding the full initial snapshot
+   * @param[in] partFlag The ESfMData sections to track and save
+   */
+  DeltaSaver(const std::string& baseFilename, ESfMData partFlag);
+
+  /**
+   * @brief Save the changes of the scene since the previous call.
+   *
+   * The first call writes the full scene to the base file; later calls write
+   * a delta file, or nothing at all when the tracked sections are unchanged.
+   *
+   * @param[in] sfmData The scene to snapshot
+   * @return true if completed
+   */
+  bool save(const SfMData& sfmData);
+
+  /// Number of snapshots taken so far (the base counts as the first one).
+  std::size_t sequence() const
+  {
+    return _sequence;
+  }
+
+private:
+  std::string _baseFilename;
+  ESfMData _partFlag;
+  std::size_t _sequence = 0;
+
+  // fingerprint of every element as it was last written
+  std::map<IndexT, std::uint64_t> _viewHashes;
+  std::map<IndexT, std::uint64_t> _intrinsicHashes;
+  std::map<IndexT, std::uint64_t> _poseHashes;
+  std::map<IndexT, std::uint64_t> _rigHashes;
+  std::map<IndexT, std::uint64_t> _landmarkHashes;
+  std::map<IndexT, std::uint64_t> _controlPointHashes;
+};
+
+/**
+ * @brief Rebuild a scene from a delta sequence written by DeltaSaver.
+ *
+ * Loads the base file, then applies the delta files in order up to
+ * \p lastSequence (by default, every delta found next to the base file).
+ *
+ * @param[out] sfmData The output SfMData
+ * @param[in] baseFilename The base JSON file of the sequence
+ * @param[in] lastSequence Index of the last delta to apply, 1 being the first one
+ * @return true if completed
+ */
+bool materializeDeltaSequence(SfMData& sfmData,
+                              const std::string& baseFilename,
+                              std::size_t lastSequence = std::numeric_limits<std::size_t>::max());
+
+/// Path of the \p sequence -th delta file of the sequence based at \p baseFilename.
+std::string deltaFilename(const std::string& baseFilename, std::size_t sequence);
+
+} // namespace sfm
+} // namespace aliceVision
@@ -5,16 +5,43 @@
 
 #include "sfmDataIO_ply.hpp"
 
+#include <algorithm>
+#include <cstring>
 #include <fstream>
+#include <vector>
 
 namespace aliceVision {
 namespace sfm {
 
-/// Save the structure and camera positions of a SfMData container as 3D points in a PLY ASCII file.
+namespace {
+
+/// one binary PLY vertex record: 3 little-endian floats + rgb
+const std::size_t PLY_VERTEX_SIZE = 3 * sizeof(float) + 3;
+
+/// number of vertex records per buffered write
+const std::size_t PLY_CHUNK_SIZE = 1 << 20;
+
+/// Pack one vertex record at dst
+inline void packPlyVertex(char* dst, const Vec3& X, const image::RGBColor& rgb)
+{
+  const float xyz[3] = {
+    static_cast<float>(X(0)),
+    static_cast<float>(X(1)),
+    static_cast<float>(X(2))};
+  std::memcpy(dst, xyz, sizeof(xyz));
+  dst[12] = static_cast<char>(rgb.r());
+  dst[13] = static_cast<char>(rgb.g());
+  dst[14] = static_cast<char>(rgb.b());
+}
+
+} // namespace
+
+/// Save the structure and camera positions of a SfMData container as 3D points in a PLY file.
  bool Save_PLY(
   const SfMData & sfm_data,
   const std::string & filename,
-  ESfMData flags_part)
+  ESfMData flags_part,
+  bool binary)
 {
   const bool b_structure = (flags_part & STRUCTURE) == STRUCTURE;
   const bool b_extrinsics = (flags_part & EXTRINSICS) == EXTRINSICS;
@@ -22,8 +49,13 @@ namespace sfm {
   if (!(b_structure || b_extrinsics))
     return false;
 
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+  // the binary writer packs the host float representation directly
+  binary = false;
+#endif
+
   //Create the stream and check it is ok
-  std::ofstream stream(filename.c_str());
+  std::ofstream stream(filename.c_str(), binary ? (std::ios::out | std::ios::binary) : std::ios::out);
   if (!stream.is_open())
     return false;
 
@@ -39,7 +71,7 @@ namespace sfm {
       }
     }
     stream << "ply"
-      << '\n' << "format ascii 1.0"
+      << '\n' << (binary ? "format binary_little_endian 1.0" : "format ascii 1.0")
       << '\n' << "element vertex "
         // Vertex count: (#landmark + #view_with_valid_pose)
         << ((b_structure ? sfm_data.GetLandmarks().size() : 0) +
@@ -54,13 +86,23 @@ namespace sfm {
 
       if (b_extrinsics)
       {
+        const image::RGBColor cameraColor(0, 255, 0);
+        char record[PLY_VERTEX_SIZE];
         for (const auto & view : sfm_data.GetViews())
         {
           if (sfm_data.IsPoseAndIntrinsicDefined(view.second.get()))
           {
             const geometry::Pose3 pose = sfm_data.getPose(*(view.second.get()));
-            stream << pose.center().transpose()
-              << " 0 255 0" << "\n";
+            if (binary)
+            {
+              packPlyVertex(record, pose.center(), cameraColor);
+              stream.write(record, PLY_VERTEX_SIZE);
+            }
+            else
+            {
+              stream << pose.center().transpose()
+                << " 0 255 0" << "\n";
+            }
           }
         }
       }
@@ -68,13 +110,43 @@ namespace sfm {
       if (b_structure)
       {
         const Landmarks & landmarks = sfm_data.GetLandmarks();
-        for (Landmarks::const_iterator iterLandmarks = landmarks.begin();
-          iterLandmarks != landmarks.end();
-          ++iterLandmarks)  {
-          stream << iterLandmarks->second.X.transpose() << " "
-                 << (int)iterLandmarks->second.rgb.r() << " "
-                 << (int)iterLandmarks->second.rgb.g() << " "
-                 << (int)iterLandmarks->second.rgb.b() << "\n";
+        if (binary)
+        {
+          // snapshot the landmark addresses so the chunks can be indexed,
+          // the colors are read in place (no copy of the point cloud)
+          std::vector<const Landmark*> landmarkPtrs;
+          landmarkPtrs.reserve(landmarks.size());
+          for (Landmarks::const_iterator iterLandmarks = landmarks.begin();
+            iterLandmarks != landmarks.end();
+            ++iterLandmarks)
+            landmarkPtrs.push_back(&iterLandmarks->second);
+
+          // serialize fixed-size chunks: the records of a chunk are packed
+          // in parallel into disjoint buffer slots, then written in one call
+          std::vector<char> buffer(PLY_CHUNK_SIZE * PLY_VERTEX_SIZE);
+          for (std::size_t begin = 0; begin < landmarkPtrs.size(); begin += PLY_CHUNK_SIZE)
+          {
+            const std::size_t nbRecords = std::min(PLY_CHUNK_SIZE, landmarkPtrs.size() - begin);
+
+#pragma omp parallel for
+            for (std::size_t k = 0; k < nbRecords; ++k)
+            {
+              const Landmark& landmark = *landmarkPtrs[begin + k];
+              packPlyVertex(&buffer[k * PLY_VERTEX_SIZE], landmark.X, landmark.rgb);
+            }
+            stream.write(&buffer[0], nbRecords * PLY_VERTEX_SIZE);
+          }
+        }
+        else
+        {
+          for (Landmarks::const_iterator iterLandmarks = landmarks.begin();
+            iterLandmarks != landmarks.end();
+            ++iterLandmarks)  {
+            stream << iterLandmarks->second.X.transpose() << " "
+                   << (int)iterLandmarks->second.rgb.r() << " "
+                   << (int)iterLandmarks->second.rgb.g() << " "
+                   << (int)iterLandmarks->second.rgb.b() << "\n";
+          }
         }
       }
       stream.flush();
@@ -10,10 +10,14 @@
 namespace aliceVision {
 namespace sfm {
 
-/// Save the structure and camera positions of a SfMData container as 3D points in a PLY ASCII file.
+/// Save the structure and camera positions of a SfMData container as 3D points in a PLY file.
+/// Binary little-endian output (the default) serializes the landmark records
+/// in parallel chunks with buffered writes; ASCII output is kept for
+/// readability of small scenes.
 bool Save_PLY(const SfMData & sfm_data,
               const std::string & filename,
-              ESfMData flags_part);
+              ESfMData flags_part,
+              bool binary = true);
 
 } // namespace sfm
 } // namespace aliceVision
@@ -5,6 +5,7 @@
 
 #include "aliceVision/system/Timer.hpp"
 #include "aliceVision/sfm/sfm.hpp"
+#include "aliceVision/sfm/sfmDataIO_delta.hpp"
 #include "dependencies/stlplus3/filesystemSimplified/file_system.hpp"
 #include <sstream>
 
@@ -205,6 +206,52 @@ BOOST_AUTO_TEST_CASE(SfMData_IO_BigFile) {
 }
 */
 
+BOOST_AUTO_TEST_CASE(SfMData_IO_DeltaSequence) {
+
+  const std::string baseFilename = "delta_base.json";
+
+  SfMData sfmData = createTestScene(3, 2, true);
+
+  DeltaSaver deltaSaver(baseFilename, ESfMData::ALL);
+
+  // the first save writes the full scene
+  BOOST_CHECK( deltaSaver.save(sfmData) );
+  BOOST_CHECK( stlplus::is_file(baseFilename) );
+
+  // an unchanged scene produces no delta file
+  BOOST_CHECK( deltaSaver.save(sfmData) );
+  BOOST_CHECK( !stlplus::is_file(deltaFilename(baseFilename, 1)) );
+
+  // move a pose and add a landmark
+  sfmData.GetPoses()[1] = Pose3(Mat3::Identity(), Vec3(1, 2, 3));
+  Landmark landmark(Vec3(4, 5, 6), feature::EImageDescriberType::SIFT);
+  landmark.observations[0] = Observation(Vec2(7, 8), 9);
+  sfmData.structure[42] = landmark;
+  BOOST_CHECK( deltaSaver.save(sfmData) );
+  BOOST_CHECK( stlplus::is_file(deltaFilename(baseFilename, 1)) );
+
+  // remove a landmark
+  sfmData.structure.erase(0);
+  BOOST_CHECK( deltaSaver.save(sfmData) );
+  BOOST_CHECK( stlplus::is_file(deltaFilename(baseFilename, 2)) );
+
+  // materializing the whole sequence rebuilds the current scene
+  {
+    SfMData materialized;
+    BOOST_CHECK( materializeDeltaSequence(materialized, baseFilename) );
+    BOOST_CHECK( materialized == sfmData );
+  }
+
+  // materializing an earlier snapshot stops at the requested delta
+  {
+    SfMData materialized;
+    BOOST_CHECK( materializeDeltaSequence(materialized, baseFilename, 1) );
+    BOOST_CHECK_EQUAL( materialized.structure.size(), 2 );
+    BOOST_CHECK_EQUAL( materialized.structure.count(0), 1 );
+    BOOST_CHECK_EQUAL( materialized.structure.count(42), 1 );
+  }
+}
+
 BOOST_AUTO_TEST_CASE(SfMData_IO_SAVE_PLY) {
 
   // SAVE as PLY
@@ -11,8 +11,8 @@
 
 #include <boost/progress.hpp>
 
-#include <deque>
 #include <memory>
+#include <vector>
 
 namespace aliceVision {
 namespace sfm {
@@ -32,27 +32,42 @@ StructureComputation_blind::StructureComputation_blind(bool bConsoleVerbose)
 
 void StructureComputation_blind::triangulate(SfMData & sfm_data) const
 {
-  std::deque<IndexT> rejectedId;
   std::unique_ptr<boost::progress_display> my_progress_bar;
   if (_bConsoleVerbose)
     my_progress_bar.reset( new boost::progress_display(
     sfm_data.structure.size(),
     std::cout,
     "Blind triangulation progress:\n" ));
-  #pragma omp parallel
+
+  // index the landmarks so they can be partitioned across threads
+  std::vector<Landmarks::iterator> landmarksIt;
+  landmarksIt.reserve(sfm_data.structure.size());
   for(Landmarks::iterator iterTracks = sfm_data.structure.begin();
     iterTracks != sfm_data.structure.end();
     ++iterTracks)
   {
-    #pragma omp single nowait
+    landmarksIt.push_back(iterTracks);
+  }
+
+  std::vector<char> rejected(landmarksIt.size(), 0);
+
+  #pragma omp parallel
+  {
+    // thread-local triangulation object, its buffer is reused across landmarks
+    Triangulation trianObj;
+
+    #pragma omp for schedule(dynamic)
+    for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(landmarksIt.size()); ++i)
     {
+      Landmarks::iterator iterTracks = landmarksIt[i];
+
       if (_bConsoleVerbose)
       {
         #pragma omp critical
         ++(*my_progress_bar);
       }
       // Triangulate each landmark
-      Triangulation trianObj;
+      trianObj.clear();
       const Observations & observations = iterTracks->second.observations;
       for(const auto& itObs : observations)
       {
@@ -68,10 +83,7 @@ void StructureComputation_blind::triangulate(SfMData & sfm_data) const
       }
       if (trianObj.size() < 2)
       {
-        #pragma omp critical
-        {
-          rejectedId.push_front(iterTracks->first);
-        }
+        rejected[i] = 1;
       }
       else
       {
@@ -83,18 +95,16 @@ void StructureComputation_blind::triangulate(SfMData & sfm_data) const
         }
         else
         {
-          #pragma omp critical
-          {
-            rejectedId.push_front(iterTracks->first);
-          }
+          rejected[i] = 1;
         }
       }
     }
   }
   // Erase the unsuccessful triangulated tracks
-  for (auto& it : rejectedId)
+  for (std::size_t i = 0; i < landmarksIt.size(); ++i)
   {
-    sfm_data.structure.erase(it);
+    if (rejected[i])
+      sfm_data.structure.erase(landmarksIt[i]);
   }
 }
 
@@ -113,42 +123,49 @@ void StructureComputation_robust::triangulate(SfMData & sfm_data) const
 /// Invalid landmark are removed.
 void StructureComputation_robust::robust_triangulation(SfMData & sfm_data) const
 {
-  std::deque<IndexT> rejectedId;
   std::unique_ptr<boost::progress_display> my_progress_bar;
   if (_bConsoleVerbose)
     my_progress_bar.reset( new boost::progress_display(
     sfm_data.structure.size(),
     std::cout,
     "Robust triangulation progress:\n" ));
-  #pragma omp parallel
+
+  // index the landmarks so they can be partitioned across threads
+  std::vector<Landmarks::iterator> landmarksIt;
+  landmarksIt.reserve(sfm_data.structure.size());
   for(Landmarks::iterator iterTracks = sfm_data.structure.begin();
     iterTracks != sfm_data.structure.end();
     ++iterTracks)
   {
-    #pragma omp single nowait
+    landmarksIt.push_back(iterTracks);
+  }
+
+  std::vector<char> rejected(landmarksIt.size(), 0);
+
+  #pragma omp parallel for schedule(dynamic)
+  for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(landmarksIt.size()); ++i)
+  {
+    Landmarks::iterator iterTracks = landmarksIt[i];
+
+    if (_bConsoleVerbose)
     {
-      if (_bConsoleVerbose)
-      {
-        #pragma omp critical
-        ++(*my_progress_bar);
-      }
-      Vec3 X;
-      if (robust_triangulation(sfm_data, iterTracks->second.observations, X)) {
-        iterTracks->second.X = X;
-      }
-      else {
-        iterTracks->second.X = Vec3::Zero();
-        #pragma omp critical
-        {
-          rejectedId.push_front(iterTracks->first);
-        }
-      }
+      #pragma omp critical
+      ++(*my_progress_bar);
+    }
+    Vec3 X;
+    if (robust_triangulation(sfm_data, iterTracks->second.observations, X)) {
+      iterTracks->second.X = X;
+    }
+    else {
+      iterTracks->second.X = Vec3::Zero();
+      rejected[i] = 1;
     }
   }
   // Erase the unsuccessful triangulated tracks
-  for (auto& it : rejectedId)
+  for (std::size_t i = 0; i < landmarksIt.size(); ++i)
   {
-    sfm_data.structure.erase(it);
+    if (rejected[i])
+      sfm_data.structure.erase(landmarksIt[i]);
   }
 }
 
@@ -0,0 +1,83 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfm/SfMData.hpp>
+
+#define BOOST_TEST_MODULE sfmDataViews
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::sfm;
+
+namespace {
+
+// Build a scene with 5 views: views 0,1 share intrinsic 0, views 2,3 use
+// intrinsic 1; view 1 has no pose and view 4 has neither pose nor intrinsic.
+SfMData buildTestScene()
+{
+  SfMData sfmData;
+  sfmData.views[0] = std::make_shared<View>("view0.jpg", 0, 0, 0);
+  sfmData.views[1] = std::make_shared<View>("view1.jpg", 1, 0, 1);
+  sfmData.views[2] = std::make_shared<View>("view2.jpg", 2, 1, 2);
+  sfmData.views[3] = std::make_shared<View>("view3.jpg", 3, 1, 3);
+  sfmData.views[4] = std::make_shared<View>("view4.jpg", 4);
+
+  sfmData.intrinsics[0] = std::make_shared<camera::Pinhole>();
+  sfmData.intrinsics[1] = std::make_shared<camera::Pinhole>();
+
+  sfmData.setAbsolutePose(0, geometry::Pose3());
+  sfmData.setAbsolutePose(2, geometry::Pose3());
+  sfmData.setAbsolutePose(3, geometry::Pose3());
+
+  return sfmData;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(SfMDataViews_ValidViewsRange)
+{
+  const SfMData sfmData = buildTestScene();
+
+  // the range must list exactly the views returned by getValidViews
+  const std::set<IndexT> expected = sfmData.getValidViews();
+  std::set<IndexT> visited;
+  for(const Views::value_type& viewPair : sfmData.validViews())
+  {
+    BOOST_CHECK(sfmData.IsPoseAndIntrinsicDefined(viewPair.second.get()));
+    visited.insert(viewPair.first);
+  }
+  BOOST_CHECK(expected == visited);
+  BOOST_CHECK_EQUAL(expected.size(), sfmData.nbValidViews());
+  BOOST_CHECK(!sfmData.validViews().empty());
+
+  // an empty scene gives an empty range
+  const SfMData emptyScene;
+  BOOST_CHECK(emptyScene.validViews().empty());
+  BOOST_CHECK_EQUAL(0, emptyScene.nbValidViews());
+}
+
+BOOST_AUTO_TEST_CASE(SfMDataViews_ViewsWithIntrinsic)
+{
+  const SfMData sfmData = buildTestScene();
+
+  // intrinsic 0: only view 0 is valid (view 1 has no pose)
+  std::set<IndexT> group0;
+  for(const Views::value_type& viewPair : sfmData.viewsWithIntrinsic(0))
+    group0.insert(viewPair.first);
+  BOOST_CHECK_EQUAL(1, group0.size());
+  BOOST_CHECK(group0.count(0));
+
+  // intrinsic 1: views 2 and 3
+  std::set<IndexT> group1;
+  for(const Views::value_type& viewPair : sfmData.viewsWithIntrinsic(1))
+    group1.insert(viewPair.first);
+  BOOST_CHECK_EQUAL(2, group1.size());
+  BOOST_CHECK(group1.count(2));
+  BOOST_CHECK(group1.count(3));
+
+  // unknown intrinsic: empty group
+  BOOST_CHECK(sfmData.viewsWithIntrinsic(42).empty());
+  BOOST_CHECK_EQUAL(0, sfmData.viewsWithIntrinsic(42).size());
+}
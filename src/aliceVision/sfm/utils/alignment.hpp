@@ -74,14 +74,22 @@ inline void applyTransform(SfMData & sfmData,
     sfmData.setPose(view, pose);
   }
   
+  // move the whole point cloud through one vectorized pass
+  // instead of one small matrix product per landmark
+  Mat3X points(3, sfmData.structure.size());
+  std::size_t i = 0;
+  for(const auto& landmark: sfmData.structure)
+    points.col(i++) = landmark.second.X;
+
+  points = (S * R * points).colwise() + t;
+
+  i = 0;
   for(auto& landmark: sfmData.structure)
-  {
-    landmark.second.X = S * R * landmark.second.X + t;
-  }
-  
+    landmark.second.X = points.col(i++);
+
   if(!transformControlPoints)
     return;
-  
+
   for(auto& controlPts: sfmData.control_points)
   {
     controlPts.second.X = S * R * controlPts.second.X + t;
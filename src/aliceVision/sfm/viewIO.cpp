@@ -9,12 +9,117 @@
 #include <aliceVision/camera/camera.hpp>
 #include <aliceVision/image/io.hpp>
 
+#include <dependencies/stlplus3/filesystemSimplified/file_system.hpp>
+
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/json_parser.hpp>
+
 #include <stdexcept>
 
+namespace bpt = boost::property_tree;
+
 namespace aliceVision {
 namespace sfm {
 
-void updateIncompleteView(View& view)
+bool ImageMetadataCache::load(const std::string& cacheFilePath)
+{
+  if(!stlplus::file_exists(cacheFilePath))
+    return false;
+
+  bpt::ptree fileTree;
+  try
+  {
+    bpt::read_json(cacheFilePath, fileTree);
+  }
+  catch(const bpt::json_parser::json_parser_error&)
+  {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  for(bpt::ptree::value_type& entryNode : fileTree)
+  {
+    Entry entry;
+    entry.modificationTime = entryNode.second.get<std::time_t>("modificationTime", 0);
+    entry.fileSize = entryNode.second.get<std::size_t>("fileSize", 0);
+    entry.width = entryNode.second.get<int>("width", 0);
+    entry.height = entryNode.second.get<int>("height", 0);
+
+    if(entryNode.second.count("metadata"))
+      for(bpt::ptree::value_type& metadataNode : entryNode.second.get_child("metadata"))
+        entry.metadata.emplace(metadataNode.first, metadataNode.second.get_value<std::string>());
+
+    _entries[entryNode.second.get<std::string>("imagePath", entryNode.first)] = entry;
+  }
+  return true;
+}
+
+bool ImageMetadataCache::save(const std::string& cacheFilePath) const
+{
+  bpt::ptree fileTree;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for(const auto& entryIt : _entries)
+    {
+      bpt::ptree entryTree;
+      entryTree.put("imagePath", entryIt.first);
+      entryTree.put("modificationTime", entryIt.second.modificationTime);
+      entryTree.put("fileSize", entryIt.second.fileSize);
+      entryTree.put("width", entryIt.second.width);
+      entryTree.put("height", entryIt.second.height);
+
+      bpt::ptree metadataTree;
+      for(const auto& metadataIt : entryIt.second.metadata)
+        metadataTree.put(bpt::ptree::path_type(metadataIt.first, '\1'), metadataIt.second);
+      entryTree.add_child("metadata", metadataTree);
+
+      fileTree.push_back(std::make_pair("", entryTree));
+    }
+  }
+
+  try
+  {
+    bpt::write_json(cacheFilePath, fileTree);
+  }
+  catch(const bpt::json_parser::json_parser_error&)
+  {
+    return false;
+  }
+  return true;
+}
+
+bool ImageMetadataCache::get(const std::string& imagePath, int& width, int& height, std::map<std::string, std::string>& metadata) const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  const std::map<std::string, Entry>::const_iterator it = _entries.find(imagePath);
+  if(it == _entries.end())
+    return false;
+
+  // stale if the file changed since caching
+  if(it->second.modificationTime != stlplus::file_modified(imagePath) ||
+     it->second.fileSize != stlplus::file_size(imagePath))
+    return false;
+
+  width = it->second.width;
+  height = it->second.height;
+  metadata = it->second.metadata;
+  return true;
+}
+
+void ImageMetadataCache::put(const std::string& imagePath, int width, int height, const std::map<std::string, std::string>& metadata)
+{
+  Entry entry;
+  entry.modificationTime = stlplus::file_modified(imagePath);
+  entry.fileSize = stlplus::file_size(imagePath);
+  entry.width = width;
+  entry.height = height;
+  entry.metadata = metadata;
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  _entries[imagePath] = entry;
+}
+
+void updateIncompleteView(View& view, ImageMetadataCache* metadataCache)
 {
   // check if the view is complete
   if(view.getViewId() != UndefinedIndexT &&
@@ -27,7 +132,13 @@ void updateIncompleteView(View& view)
   int width, height;
   std::map<std::string, std::string> metadata;
 
-  image::readImageMetadata(view.getImagePath(), width, height, metadata);
+  if(metadataCache == nullptr || !metadataCache->get(view.getImagePath(), width, height, metadata))
+  {
+    image::readImageMetadata(view.getImagePath(), width, height, metadata);
+
+    if(metadataCache != nullptr)
+      metadataCache->put(view.getImagePath(), width, height, metadata);
+  }
 
   view.setWidth(width);
   view.setHeight(height);
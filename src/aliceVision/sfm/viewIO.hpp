@@ -9,16 +9,83 @@
 #include <aliceVision/camera/cameraCommon.hpp>
 #include <aliceVision/camera/IntrinsicBase.hpp>
 
+#include <ctime>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <string>
 
 namespace aliceVision {
 namespace sfm {
 
+/**
+ * @brief Disk cache of the image metadata extracted by updateIncompleteView.
+ *
+ * Each entry stores the image size and metadata keyed by the image path and
+ * is validated against the file modification time and size, so a re-run over
+ * unchanged images skips the per-image header reads entirely (a full OIIO
+ * open per image is expensive on network storage). Thread-safe, the cache can
+ * be filled from a parallel metadata pass.
+ */
+class ImageMetadataCache
+{
+public:
+  /**
+   * @brief Load the cache from the given file
+   * @param[in] cacheFilePath The cache file path
+   * @return False if the file doesn't exist or can't be parsed
+   */
+  bool load(const std::string& cacheFilePath);
+
+  /**
+   * @brief Save the cache to the given file
+   * @param[in] cacheFilePath The cache file path
+   * @return True if ok
+   */
+  bool save(const std::string& cacheFilePath) const;
+
+  /**
+   * @brief Retrieve the cached metadata of the given image, if up to date
+   * @param[in] imagePath The image path
+   * @param[out] width The image width
+   * @param[out] height The image height
+   * @param[out] metadata The image metadata
+   * @return False if not cached or if the file changed since caching
+   */
+  bool get(const std::string& imagePath, int& width, int& height, std::map<std::string, std::string>& metadata) const;
+
+  /**
+   * @brief Store the metadata of the given image
+   * @param[in] imagePath The image path
+   * @param[in] width The image width
+   * @param[in] height The image height
+   * @param[in] metadata The image metadata
+   */
+  void put(const std::string& imagePath, int width, int height, const std::map<std::string, std::string>& metadata);
+
+private:
+  struct Entry
+  {
+    std::time_t modificationTime = 0;
+    std::size_t fileSize = 0;
+    int width = 0;
+    int height = 0;
+    std::map<std::string, std::string> metadata;
+  };
+
+  /// Image path to cached metadata
+  std::map<std::string, Entry> _entries;
+  /// Guards the entries
+  mutable std::mutex _mutex;
+};
+
 /**
  * @brief update an incomplete view (at least only the image path)
  * @param view The given incomplete view
+ * @param metadataCache If not null, the image metadata are looked up in (and
+ *        stored into) this cache instead of re-reading unchanged image headers
  */
-void updateIncompleteView(View& view);
+void updateIncompleteView(View& view, ImageMetadataCache* metadataCache = nullptr);
 
 /**
  * @brief creat an intrinsic for the given View
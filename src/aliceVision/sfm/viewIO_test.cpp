@@ -0,0 +1,90 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "aliceVision/sfm/viewIO.hpp"
+#include "dependencies/stlplus3/filesystemSimplified/file_system.hpp"
+
+#include <fstream>
+#include <map>
+#include <string>
+
+#define BOOST_TEST_MODULE viewIO
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::sfm;
+
+BOOST_AUTO_TEST_CASE(ImageMetadataCache_PutGetSaveLoad)
+{
+  // the cache validates the entries against the file on disk
+  const std::string imagePath = "cached_image.jpg";
+  {
+    std::ofstream file(imagePath.c_str());
+    file << "not really an image";
+  }
+
+  std::map<std::string, std::string> metadata;
+  metadata["Make"] = "Canon";
+  metadata["Model"] = "Canon EOS 5D Mark II";
+  metadata["Exif:FocalLength"] = "50";
+
+  ImageMetadataCache cache;
+  cache.put(imagePath, 640, 480, metadata);
+
+  int width = 0, height = 0;
+  std::map<std::string, std::string> cachedMetadata;
+  BOOST_CHECK(cache.get(imagePath, width, height, cachedMetadata));
+  BOOST_CHECK_EQUAL(640, width);
+  BOOST_CHECK_EQUAL(480, height);
+  BOOST_CHECK(metadata == cachedMetadata);
+
+  // unknown image
+  BOOST_CHECK(!cache.get("unknown_image.jpg", width, height, cachedMetadata));
+
+  // save / load round trip
+  const std::string cacheFilePath = "imageMetadata.cache.json";
+  BOOST_CHECK(cache.save(cacheFilePath));
+
+  ImageMetadataCache loadedCache;
+  BOOST_CHECK(loadedCache.load(cacheFilePath));
+
+  cachedMetadata.clear();
+  width = height = 0;
+  BOOST_CHECK(loadedCache.get(imagePath, width, height, cachedMetadata));
+  BOOST_CHECK_EQUAL(640, width);
+  BOOST_CHECK_EQUAL(480, height);
+  BOOST_CHECK(metadata == cachedMetadata);
+
+  // missing cache file
+  ImageMetadataCache emptyCache;
+  BOOST_CHECK(!emptyCache.load("not_a_cache_file.json"));
+
+  stlplus::file_delete(cacheFilePath);
+  stlplus::file_delete(imagePath);
+}
+
+BOOST_AUTO_TEST_CASE(ImageMetadataCache_StaleEntry)
+{
+  const std::string imagePath = "modified_image.jpg";
+  {
+    std::ofstream file(imagePath.c_str());
+    file << "original content";
+  }
+
+  ImageMetadataCache cache;
+  cache.put(imagePath, 640, 480, std::map<std::string, std::string>());
+
+  // growing the file invalidates the entry
+  {
+    std::ofstream file(imagePath.c_str());
+    file << "modified content of a different size";
+  }
+
+  int width = 0, height = 0;
+  std::map<std::string, std::string> cachedMetadata;
+  BOOST_CHECK(!cache.get(imagePath, width, height, cachedMetadata));
+
+  stlplus::file_delete(imagePath);
+}
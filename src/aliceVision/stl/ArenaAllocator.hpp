@@ -0,0 +1,160 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace stl
+{
+
+  /**
+   * Bump (arena) allocator backing short-lived scratch containers.
+   *
+   * Memory is carved from geometrically growing blocks with a pointer bump,
+   * deallocation is a no-op, and reset() rewinds every block without
+   * returning it to the system. A container built on an arena_allocator
+   * below pays one pointer increment per node instead of one global
+   * allocator round-trip, and an iteration that resets its arena reuses the
+   * same memory over and over instead of fragmenting the heap.
+   *
+   * The arena itself is not thread-safe: use one arena per thread (or per
+   * loop iteration), never share one between concurrent containers.
+   */
+  class arena
+  {
+  public:
+    explicit arena(std::size_t firstBlockSize = 64 * 1024)
+      : _firstBlockSize(firstBlockSize)
+    {}
+
+    arena(const arena&) = delete;
+    arena& operator=(const arena&) = delete;
+
+    /// Carve nbBytes from the current block, growing the arena if needed
+    void* allocate(std::size_t nbBytes, std::size_t alignment)
+    {
+      assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+      while (_current < _blocks.size())
+      {
+        Block& block = _blocks[_current];
+        const std::size_t aligned = (block.used + alignment - 1) & ~(alignment - 1);
+        if (aligned + nbBytes <= block.size)
+        {
+          block.used = aligned + nbBytes;
+          return block.data.get() + aligned;
+        }
+        ++_current;
+      }
+
+      // every block is full: add one, at least doubling the arena
+      std::size_t blockSize = _blocks.empty() ? _firstBlockSize : 2 * _blocks.back().size;
+      if (blockSize < nbBytes + alignment)
+        blockSize = nbBytes + alignment;
+      _blocks.emplace_back(blockSize);
+
+      // block starts are new[] allocations, aligned for any fundamental type
+      Block& block = _blocks.back();
+      block.used = nbBytes;
+      return block.data.get();
+    }
+
+    /// Rewind the arena, keeping the memory for reuse.
+    /// Everything previously allocated from it becomes invalid.
+    void reset()
+    {
+      for (Block& block : _blocks)
+        block.used = 0;
+      _current = 0;
+    }
+
+    /// Memory held by the arena blocks, in bytes
+    std::size_t capacity() const
+    {
+      std::size_t total = 0;
+      for (const Block& block : _blocks)
+        total += block.size;
+      return total;
+    }
+
+  private:
+    struct Block
+    {
+      explicit Block(std::size_t blockSize)
+        : data(new char[blockSize])
+        , size(blockSize)
+      {}
+
+      std::unique_ptr<char[]> data;
+      std::size_t size;
+      std::size_t used = 0;
+    };
+
+    std::vector<Block> _blocks;
+    std::size_t _current = 0;
+    std::size_t _firstBlockSize;
+  };
+
+  /**
+   * std allocator adapter over an arena, for node-based scratch containers
+   * (std::set, std::map, ...) living shorter than the arena:
+   *
+   *   stl::arena scratch;
+   *   std::set<int, std::less<int>, stl::arena_allocator<int>>
+   *     mySet{std::less<int>(), stl::arena_allocator<int>(scratch)};
+   *
+   * deallocate is a no-op: the memory comes back when the arena is reset
+   * or destroyed, so the container must not outlive either event.
+   */
+  template <class T>
+  class arena_allocator
+  {
+  public:
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+
+    template <class U>
+    struct rebind
+    {
+      typedef arena_allocator<U> other;
+    };
+
+    explicit arena_allocator(arena& a)
+      : _arena(&a)
+    {}
+
+    template <class U>
+    arena_allocator(const arena_allocator<U>& other)
+      : _arena(other._arena)
+    {}
+
+    T* allocate(std::size_t n)
+    {
+      return static_cast<T*>(_arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, std::size_t)
+    {
+      // reclaimed all at once by arena::reset or the arena destructor
+    }
+
+    template <class U>
+    bool operator==(const arena_allocator<U>& other) const { return _arena == other._arena; }
+    template <class U>
+    bool operator!=(const arena_allocator<U>& other) const { return _arena != other._arena; }
+
+    // shared by the rebound copies of the allocator
+    arena* _arena;
+  };
+
+} // namespace stl
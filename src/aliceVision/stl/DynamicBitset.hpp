@@ -7,10 +7,15 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <limits>
 #include <vector>
 #include <cassert>
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
 namespace stl
 {
 
@@ -23,6 +28,9 @@ namespace stl
   {
     typedef unsigned char BlockType;
     static const int bits_per_block = (std::numeric_limits<BlockType>::digits);
+    // returned by find_first/find_next when no set bit is left
+    // (an enum so that the header stays self-contained, no out-of-line definition)
+    enum : size_t { npos = static_cast<size_t>(-1) };
 
     // Reference over a single bit of a sub-block
     class reference
@@ -74,7 +82,144 @@ namespace stl
 
     const BlockType * data() const { return &vec_bits[0]; }
 
+    // --- Bulk operations ---
+    // The per-block loops below compile to SIMD code (the byte-wise and/or/xor
+    // loops auto-vectorize), count and intersects work one 64 bit word at a
+    // time, so set algebra over two bitsets never touches individual bits.
+    // Both operands must have the same size.
+
+    dynamic_bitset& operator&=(const dynamic_bitset& rhs)
+    {
+      assert(size() == rhs.size());
+      for (size_t i = 0; i < vec_bits.size(); ++i)
+        vec_bits[i] &= rhs.vec_bits[i];
+      return *this;
+    }
+
+    dynamic_bitset& operator|=(const dynamic_bitset& rhs)
+    {
+      assert(size() == rhs.size());
+      for (size_t i = 0; i < vec_bits.size(); ++i)
+        vec_bits[i] |= rhs.vec_bits[i];
+      return *this;
+    }
+
+    dynamic_bitset& operator^=(const dynamic_bitset& rhs)
+    {
+      assert(size() == rhs.size());
+      for (size_t i = 0; i < vec_bits.size(); ++i)
+        vec_bits[i] ^= rhs.vec_bits[i];
+      return *this;
+    }
+
+    // return the number of bits set to 1
+    size_t count() const
+    {
+      size_t result = 0;
+      size_t i = 0;
+      for (; i + sizeof(uint64_t) <= vec_bits.size(); i += sizeof(uint64_t))
+        result += popcnt64(load_word(i));
+      for (; i < vec_bits.size(); ++i)
+        result += popcnt64(vec_bits[i]);
+      return result;
+    }
+
+    bool any() const
+    {
+      for (size_t i = 0; i < vec_bits.size(); ++i)
+        if (vec_bits[i] != 0)
+          return true;
+      return false;
+    }
+
+    bool none() const { return !any(); }
+
+    // return true if at least one bit is set in both bitsets
+    bool intersects(const dynamic_bitset& rhs) const
+    {
+      assert(size() == rhs.size());
+      size_t i = 0;
+      for (; i + sizeof(uint64_t) <= vec_bits.size(); i += sizeof(uint64_t))
+        if ((load_word(i) & rhs.load_word(i)) != 0)
+          return true;
+      for (; i < vec_bits.size(); ++i)
+        if ((vec_bits[i] & rhs.vec_bits[i]) != 0)
+          return true;
+      return false;
+    }
+
+    // return the position of the first bit set to 1, npos if none.
+    // Iterating the set bits is:
+    //   for (size_t i = b.find_first(); i != b.npos; i = b.find_next(i)) ...
+    size_t find_first() const { return find_from_block(0); }
+
+    // return the position of the first bit set to 1 after pos, npos if none
+    size_t find_next(size_t pos) const
+    {
+      ++pos;
+      if (pos >= m_num_bits)
+        return npos;
+      const size_t block = block_index(pos);
+      const BlockType masked = BlockType(vec_bits[block] & (BlockType(~BlockType(0)) << bit_index(pos)));
+      if (masked != 0)
+        return block * bits_per_block + ctz(masked);
+      return find_from_block(block + 1);
+    }
+
   private:
+    // load 8 consecutive blocks as one little-endian-agnostic word
+    // (only used for popcount and zero tests, where byte order is irrelevant)
+    uint64_t load_word(size_t blockIndex) const
+    {
+      uint64_t word;
+      std::memcpy(&word, &vec_bits[blockIndex], sizeof(word));
+      return word;
+    }
+
+    static inline unsigned int popcnt64(uint64_t n)
+    {
+#if defined _MSC_VER && defined PLATFORM_64_BIT
+      return __popcnt64(n);
+#else
+#if (defined __GNUC__ || defined __clang__)
+      return __builtin_popcountll(n);
+#endif
+      n -= ((n >> 1) & 0x5555555555555555LL);
+      n = (n & 0x3333333333333333LL) + ((n >> 2) & 0x3333333333333333LL);
+      return (((n + (n >> 4))& 0x0f0f0f0f0f0f0f0fLL)* 0x0101010101010101LL) >> 56;
+#endif
+    }
+
+    // index of the lowest bit set in a non-zero block
+    static inline unsigned int ctz(BlockType n)
+    {
+      assert(n != 0);
+#ifdef _MSC_VER
+      unsigned long index;
+      _BitScanForward(&index, n);
+      return static_cast<unsigned int>(index);
+#elif (defined __GNUC__ || defined __clang__)
+      return __builtin_ctz(n);
+#else
+      unsigned int index = 0;
+      while ((n & 1) == 0)
+      {
+        n >>= 1;
+        ++index;
+      }
+      return index;
+#endif
+    }
+
+    // first set bit at or after the given block, npos if none
+    size_t find_from_block(size_t block) const
+    {
+      for (; block < vec_bits.size(); ++block)
+        if (vec_bits[block] != 0)
+          return block * bits_per_block + ctz(vec_bits[block]);
+      return npos;
+    }
+
     inline size_t calc_num_blocks(size_t num_bits)
     {
       return num_bits / bits_per_block
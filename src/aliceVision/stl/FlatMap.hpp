@@ -9,6 +9,10 @@
 
 #include <cereal/types/map.hpp>
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 // Add serialization for boost flat_map
 namespace cereal
 {
@@ -34,4 +38,43 @@ namespace stl
          ,class Compare = std::less<Key>
          ,class Allocator = std::allocator<std::pair<Key, T> > >
   using flat_map = boost::container::flat_map<Key, T, Compare, Allocator>;
+
+  /// Build a flat_map in a single allocation from a range of (key, value)
+  /// pairs already sorted by strictly increasing key, instead of one binary
+  /// search plus element shifting per insertion.
+  template <class Key, class T, class InputIterator>
+  flat_map<Key, T> flat_map_from_sorted_unique(InputIterator first, InputIterator last)
+  {
+    return flat_map<Key, T>(boost::container::ordered_unique_range, first, last);
+  }
+
+  /// Merge a batch of (key, value) pairs into the map with one sort and one
+  /// merge pass. The batch is sorted in place; for duplicate keys inside the
+  /// batch the last value wins, matching repeated map[key] = value
+  /// assignments. Keys already present in the map keep their current value.
+  template <class Key, class T, class Compare, class Allocator>
+  void flat_map_bulk_insert(flat_map<Key, T, Compare, Allocator>& map,
+                            std::vector<std::pair<Key, T> >& batch)
+  {
+    const Compare comp = Compare();
+    std::stable_sort(batch.begin(), batch.end(),
+                     [&comp](const std::pair<Key, T>& lhs, const std::pair<Key, T>& rhs)
+                     {
+                       return comp(lhs.first, rhs.first);
+                     });
+
+    // keep the last value of each equal-key run
+    std::size_t out = 0;
+    for (std::size_t i = 0; i < batch.size(); ++i)
+    {
+      if (i + 1 < batch.size() && !comp(batch[i].first, batch[i + 1].first))
+        continue;
+      if (out != i)
+        batch[out] = std::move(batch[i]);
+      ++out;
+    }
+    batch.resize(out);
+
+    map.insert(boost::container::ordered_unique_range, batch.begin(), batch.end());
+  }
 }
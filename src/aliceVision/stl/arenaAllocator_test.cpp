@@ -0,0 +1,79 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "ArenaAllocator.hpp"
+
+#define BOOST_TEST_MODULE stlArenaAllocator
+#include <boost/test/included/unit_test.hpp>
+
+#include <cstdint>
+#include <map>
+#include <set>
+#include <vector>
+
+BOOST_AUTO_TEST_CASE(ARENA_ALLOCATOR_BumpAndGrow)
+{
+  using namespace stl;
+
+  arena myArena(64); // tiny first block to force growth
+
+  // successive allocations bump inside the same block
+  char* a = static_cast<char*>(myArena.allocate(16, 1));
+  char* b = static_cast<char*>(myArena.allocate(16, 1));
+  BOOST_CHECK_EQUAL(16, b - a);
+
+  // a request bigger than any block grows the arena
+  void* big = myArena.allocate(1000, 8);
+  BOOST_CHECK(big != nullptr);
+  BOOST_CHECK(myArena.capacity() >= 1000 + 64);
+
+  // alignment is honoured
+  myArena.allocate(1, 1);
+  void* aligned = myArena.allocate(8, 8);
+  BOOST_CHECK_EQUAL(0, reinterpret_cast<std::uintptr_t>(aligned) % 8);
+
+  // reset keeps the memory: the first block is handed out again
+  const std::size_t capacityBefore = myArena.capacity();
+  myArena.reset();
+  char* afterReset = static_cast<char*>(myArena.allocate(16, 1));
+  BOOST_CHECK(static_cast<void*>(a) == static_cast<void*>(afterReset));
+  BOOST_CHECK_EQUAL(capacityBefore, myArena.capacity());
+}
+
+BOOST_AUTO_TEST_CASE(ARENA_ALLOCATOR_BacksNodeContainers)
+{
+  using namespace stl;
+
+  arena myArena;
+  typedef std::set<int, std::less<int>, arena_allocator<int> > ArenaSet;
+  typedef std::map<int, double, std::less<int>, arena_allocator<std::pair<const int, double> > > ArenaMap;
+
+  {
+    ArenaSet mySet{std::less<int>(), arena_allocator<int>(myArena)};
+    for (int i = 999; i >= 0; --i)
+      mySet.insert(i);
+    BOOST_CHECK_EQUAL(1000, mySet.size());
+    int expected = 0;
+    for (const int value : mySet)
+      BOOST_CHECK_EQUAL(expected++, value);
+
+    ArenaMap myMap{std::less<int>(), arena_allocator<std::pair<const int, double> >(myArena)};
+    for (int i = 0; i < 100; ++i)
+      myMap[i] = 0.5 * i;
+    BOOST_CHECK_EQUAL(100, myMap.size());
+    BOOST_CHECK_EQUAL(0.5 * 42, myMap.at(42));
+  }
+
+  // the containers are gone: reuse the same memory for the next iteration
+  const std::size_t capacityAfterFirstUse = myArena.capacity();
+  myArena.reset();
+  {
+    ArenaSet mySet{std::less<int>(), arena_allocator<int>(myArena)};
+    for (int i = 0; i < 1000; ++i)
+      mySet.insert(i);
+    BOOST_CHECK_EQUAL(1000, mySet.size());
+  }
+  BOOST_CHECK_EQUAL(capacityAfterFirstUse, myArena.capacity());
+}
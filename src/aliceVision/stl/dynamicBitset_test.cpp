@@ -39,6 +39,80 @@ BOOST_AUTO_TEST_CASE(DYNAMIC_BITSET_InitAndReset_64)
   }
 }
 
+BOOST_AUTO_TEST_CASE(DYNAMIC_BITSET_BulkOperations)
+{
+  using namespace stl;
+
+  // 100 bits: not a multiple of the 64 bit words used internally,
+  // so both the word loop and the per-block tail are exercised
+  const int nbBits = 100;
+  dynamic_bitset even(nbBits), multiple3(nbBits);
+
+  for (int i = 0; i < nbBits; i += 2)
+    even[i] = true;
+  for (int i = 0; i < nbBits; i += 3)
+    multiple3[i] = true;
+
+  BOOST_CHECK_EQUAL(50, even.count());
+  BOOST_CHECK_EQUAL(34, multiple3.count());
+  BOOST_CHECK(even.any());
+  BOOST_CHECK(!even.none());
+  BOOST_CHECK(even.intersects(multiple3));
+
+  // AND keeps the multiples of 6
+  dynamic_bitset intersection = even;
+  intersection &= multiple3;
+  for (int i = 0; i < nbBits; ++i)
+    BOOST_CHECK_EQUAL(i % 6 == 0, intersection[i]);
+
+  // OR keeps the union
+  dynamic_bitset both = even;
+  both |= multiple3;
+  for (int i = 0; i < nbBits; ++i)
+    BOOST_CHECK_EQUAL(i % 2 == 0 || i % 3 == 0, both[i]);
+
+  // XOR keeps the symmetric difference
+  dynamic_bitset either = even;
+  either ^= multiple3;
+  for (int i = 0; i < nbBits; ++i)
+    BOOST_CHECK_EQUAL((i % 2 == 0) != (i % 3 == 0), either[i]);
+
+  // disjoint sets do not intersect
+  dynamic_bitset empty(nbBits);
+  BOOST_CHECK(!empty.intersects(even));
+  BOOST_CHECK(empty.none());
+  BOOST_CHECK_EQUAL(0, empty.count());
+}
+
+BOOST_AUTO_TEST_CASE(DYNAMIC_BITSET_FindSetBits)
+{
+  using namespace stl;
+
+  const int nbBits = 100;
+  dynamic_bitset mybitset(nbBits);
+
+  BOOST_CHECK_EQUAL(dynamic_bitset::npos, mybitset.find_first());
+
+  mybitset[3] = true;
+  mybitset[64] = true;
+  mybitset[99] = true;
+
+  // iterate the set bits
+  std::vector<size_t> positions;
+  for (size_t i = mybitset.find_first(); i != dynamic_bitset::npos; i = mybitset.find_next(i))
+    positions.push_back(i);
+
+  BOOST_CHECK_EQUAL(3, positions.size());
+  BOOST_CHECK_EQUAL(3, positions[0]);
+  BOOST_CHECK_EQUAL(64, positions[1]);
+  BOOST_CHECK_EQUAL(99, positions[2]);
+
+  // find_next skips unset bits inside a block too
+  mybitset[5] = true;
+  BOOST_CHECK_EQUAL(5, mybitset.find_next(3));
+  BOOST_CHECK_EQUAL(64, mybitset.find_next(5));
+}
+
 // Create a dynamic_bitset that is shorter than the internal used bit container
 BOOST_AUTO_TEST_CASE(DYNAMIC_BITSET_InitAndReset_4)
 {
@@ -9,7 +9,9 @@
 #include <boost/log/core.hpp>
 #include <boost/log/trivial.hpp>
 #include <boost/log/expressions.hpp>
-#include <boost/log/sinks/sync_frontend.hpp>
+#include <boost/log/sinks/async_frontend.hpp>
+#include <boost/log/sinks/bounded_fifo_queue.hpp>
+#include <boost/log/sinks/block_on_overflow.hpp>
 #include <boost/log/sinks/text_ostream_backend.hpp>
 #include <boost/log/sources/severity_logger.hpp>
 #include <boost/log/sources/record_ostream.hpp>
@@ -25,16 +27,30 @@
 #include <boost/log/utility/empty_deleter.hpp>
 #endif
 
+#include <cstdlib>
+
 namespace aliceVision {
 namespace system {
 
 std::shared_ptr<Logger> Logger::_instance = nullptr;
 
+// Asynchronous frontend: the emitting threads only enqueue the formatted
+// record into a bounded queue, a dedicated writer thread inside the sink does
+// the stream output and the flushes. The queue blocks on overflow so records
+// are never dropped, the bound only caps the memory of a logging burst.
+using sink_t = boost::log::sinks::asynchronous_sink<
+    boost::log::sinks::text_ostream_backend,
+    boost::log::sinks::bounded_fifo_queue<4096, boost::log::sinks::block_on_overflow> >;
+
+struct Logger::SinkHolder
+{
+  boost::shared_ptr<sink_t> sink;
+};
+
 Logger::Logger()
 {
   namespace expr = boost::log::expressions;
   namespace sinks = boost::log::sinks;
-  using sink_t = sinks::synchronous_sink<boost::log::sinks::text_ostream_backend>;
 
 #if BOOST_VERSION >= 105500
   using boost::empty_deleter;
@@ -66,6 +82,8 @@ Logger::Logger()
 
   // register the sink in the logging core
   boost::log::core::get()->add_sink(sink);
+  _sinkHolder.reset(new SinkHolder());
+  _sinkHolder->sink = sink;
 
   boost::log::add_common_attributes();
 
@@ -75,6 +93,10 @@ Logger::Logger()
     setLogLevel(getDefaultVerboseLevel());
   else
     setLogLevel(envLevel);
+
+  // Make sure the writer thread is stopped and drained before the static
+  // destructors of the logging internals run.
+  std::atexit(&Logger::shutdownSink);
 }
 
 std::shared_ptr<Logger> Logger::get()
@@ -84,6 +106,34 @@ std::shared_ptr<Logger> Logger::get()
   return _instance;
 }
 
+Logger::~Logger()
+{
+  if(_sinkHolder == nullptr || _sinkHolder->sink == nullptr)
+    return;
+  boost::log::core::get()->remove_sink(_sinkHolder->sink);
+  _sinkHolder->sink->stop();
+  _sinkHolder->sink->flush();
+  _sinkHolder->sink.reset();
+}
+
+void Logger::shutdownSink()
+{
+  if(_instance == nullptr || _instance->_sinkHolder == nullptr || _instance->_sinkHolder->sink == nullptr)
+    return;
+  // Stop feeding the writer thread and write out the pending records before
+  // the streams go away.
+  boost::log::core::get()->remove_sink(_instance->_sinkHolder->sink);
+  _instance->_sinkHolder->sink->stop();
+  _instance->_sinkHolder->sink->flush();
+  _instance->_sinkHolder->sink.reset();
+}
+
+void Logger::flush()
+{
+  if(_sinkHolder != nullptr && _sinkHolder->sink != nullptr)
+    _sinkHolder->sink->flush();
+}
+
 EVerboseLevel Logger::getDefaultVerboseLevel()
 {
   return EVerboseLevel::Info;
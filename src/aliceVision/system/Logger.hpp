@@ -25,10 +25,50 @@
 #define ALICEVISION_LOG_FATAL_OBJ BOOST_LOG_TRIVIAL(fatal)
 #define ALICEVISION_LOG(MODE, ...) MODE << __VA_ARGS__
 
+// Numeric log levels, used to elide statements at compile time.
+#define ALICEVISION_LOG_LEVEL_FATAL   0
+#define ALICEVISION_LOG_LEVEL_ERROR   1
+#define ALICEVISION_LOG_LEVEL_WARNING 2
+#define ALICEVISION_LOG_LEVEL_INFO    3
+#define ALICEVISION_LOG_LEVEL_DEBUG   4
+#define ALICEVISION_LOG_LEVEL_TRACE   5
+
+// Statements above this threshold compile to nothing: their arguments are
+// never evaluated, so debug logging in hot loops costs zero when disabled at
+// build time (eg. -DALICEVISION_LOG_COMPILETIME_LEVEL=ALICEVISION_LOG_LEVEL_INFO).
+// All levels are compiled in by default and filtered at runtime as before.
+// Note: this only covers the ALICEVISION_LOG_<LEVEL>(...) statement macros,
+// direct uses of the *_OBJ streams are always compiled.
+#ifndef ALICEVISION_LOG_COMPILETIME_LEVEL
+#define ALICEVISION_LOG_COMPILETIME_LEVEL ALICEVISION_LOG_LEVEL_TRACE
+#endif
+
+#define ALICEVISION_LOG_ELIDED(...) do {} while(false)
+
+#if ALICEVISION_LOG_COMPILETIME_LEVEL >= ALICEVISION_LOG_LEVEL_TRACE
 #define ALICEVISION_LOG_TRACE(...) ALICEVISION_LOG(ALICEVISION_LOG_TRACE_OBJ, __VA_ARGS__)
+#else
+#define ALICEVISION_LOG_TRACE(...) ALICEVISION_LOG_ELIDED(__VA_ARGS__)
+#endif
+
+#if ALICEVISION_LOG_COMPILETIME_LEVEL >= ALICEVISION_LOG_LEVEL_DEBUG
 #define ALICEVISION_LOG_DEBUG(...) ALICEVISION_LOG(ALICEVISION_LOG_DEBUG_OBJ, __VA_ARGS__)
+#else
+#define ALICEVISION_LOG_DEBUG(...) ALICEVISION_LOG_ELIDED(__VA_ARGS__)
+#endif
+
+#if ALICEVISION_LOG_COMPILETIME_LEVEL >= ALICEVISION_LOG_LEVEL_INFO
 #define ALICEVISION_LOG_INFO(...) ALICEVISION_LOG(ALICEVISION_LOG_INFO_OBJ, __VA_ARGS__)
+#else
+#define ALICEVISION_LOG_INFO(...) ALICEVISION_LOG_ELIDED(__VA_ARGS__)
+#endif
+
+#if ALICEVISION_LOG_COMPILETIME_LEVEL >= ALICEVISION_LOG_LEVEL_WARNING
 #define ALICEVISION_LOG_WARNING(...) ALICEVISION_LOG(ALICEVISION_LOG_WARNING_OBJ, __VA_ARGS__)
+#else
+#define ALICEVISION_LOG_WARNING(...) ALICEVISION_LOG_ELIDED(__VA_ARGS__)
+#endif
+
 #define ALICEVISION_LOG_ERROR(...) ALICEVISION_LOG(ALICEVISION_LOG_ERROR_OBJ, __VA_ARGS__)
 #define ALICEVISION_LOG_FATAL(...) ALICEVISION_LOG(ALICEVISION_LOG_FATAL_OBJ, __VA_ARGS__)
 
@@ -109,6 +149,16 @@ public:
    */
   static std::shared_ptr<Logger> get();
 
+  /**
+   * @brief Logger destructor, flushes the pending asynchronous records
+   */
+  ~Logger();
+
+  /**
+   * @brief block until every record emitted so far has been written out
+   */
+  void flush();
+
   /**
    * @brief get default verbose level
    * @return default verbose level
@@ -140,7 +190,19 @@ private:
    */
   void setLogLevel(const boost::log::trivial::severity_level level);
 
+  /**
+   * @brief stop the writer thread and flush the pending records
+   *
+   * Registered with atexit so that it runs before the static destructors of
+   * the logging internals.
+   */
+  static void shutdownSink();
+
   static std::shared_ptr<Logger> _instance;
+
+  /// Holds the asynchronous sink, its concrete type stays in the .cpp
+  struct SinkHolder;
+  std::shared_ptr<SinkHolder> _sinkHolder;
 };
 
 } // namespace system
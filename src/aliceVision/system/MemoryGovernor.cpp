@@ -0,0 +1,146 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "MemoryGovernor.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/MemoryInfo.hpp>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace aliceVision {
+namespace system {
+
+const MemoryGovernor::ClientId MemoryGovernor::kNoClient;
+
+MemoryGovernor& MemoryGovernor::instance()
+{
+  static MemoryGovernor governor;
+  return governor;
+}
+
+MemoryGovernor::MemoryGovernor()
+{
+  // Automatic budget: leave a quarter of the currently free RAM to the
+  // non-governed allocations (IO buffers, solver workspaces, ...).
+  const MemoryInfo memoryInfo = getMemoryInfo();
+  _memoryBudget = static_cast<std::size_t>(memoryInfo.freeRam - memoryInfo.freeRam / 4);
+}
+
+void MemoryGovernor::setMemoryBudget(std::size_t nbBytes)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  if(nbBytes == 0)
+  {
+    const MemoryInfo memoryInfo = getMemoryInfo();
+    _memoryBudget = static_cast<std::size_t>(memoryInfo.freeRam - memoryInfo.freeRam / 4);
+  }
+  else
+  {
+    _memoryBudget = nbBytes;
+  }
+}
+
+std::size_t MemoryGovernor::memoryBudget() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _memoryBudget;
+}
+
+MemoryGovernor::ClientId MemoryGovernor::registerClient(const std::string& name, UsageFunc usage, ReclaimFunc reclaim)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  const ClientId clientId = _nextClientId++;
+  Client& client = _clients[clientId];
+  client.name = name;
+  client.usage = std::move(usage);
+  client.reclaim = std::move(reclaim);
+  return clientId;
+}
+
+void MemoryGovernor::unregisterClient(ClientId clientId)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _clients.erase(clientId);
+}
+
+std::size_t MemoryGovernor::usedMemoryLocked() const
+{
+  std::size_t used = 0;
+  for(std::map<ClientId, Client>::const_iterator it = _clients.begin(); it != _clients.end(); ++it)
+    used += it->second.usage();
+  return used;
+}
+
+std::size_t MemoryGovernor::usedMemory() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return usedMemoryLocked();
+}
+
+std::size_t MemoryGovernor::availableMemory() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  const std::size_t used = usedMemoryLocked();
+  return (used < _memoryBudget) ? _memoryBudget - used : 0;
+}
+
+bool MemoryGovernor::requestMemory(std::size_t nbBytes, ClientId requester)
+{
+  // Copy the clients so that the reclaim callbacks run without the governor
+  // lock: a reclaiming cache may take its own lock, or call back into the
+  // governor to unregister.
+  std::size_t budget = 0;
+  std::vector<std::pair<ClientId, Client> > clients;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const std::size_t used = usedMemoryLocked();
+    if(used + nbBytes <= _memoryBudget)
+      return true;
+    budget = _memoryBudget;
+    clients.reserve(_clients.size());
+    for(std::map<ClientId, Client>::const_iterator it = _clients.begin(); it != _clients.end(); ++it)
+    {
+      if(it->first != requester)
+        clients.push_back(*it);
+    }
+  }
+
+  for(std::size_t i = 0; i < clients.size(); ++i)
+  {
+    const std::size_t used = usedMemory();
+    if(used + nbBytes <= budget)
+      return true;
+    const std::size_t toFree = used + nbBytes - budget;
+    const std::size_t freed = clients[i].second.reclaim(toFree);
+    if(freed > 0)
+    {
+      ALICEVISION_LOG_DEBUG("Memory governor: reclaimed " << freed << " / " << toFree
+                            << " bytes from '" << clients[i].second.name << "'.");
+    }
+  }
+
+  const bool fits = usedMemory() + nbBytes <= budget;
+  if(!fits)
+  {
+    ALICEVISION_LOG_WARNING("Memory governor: cannot fit an allocation of " << nbBytes
+                            << " bytes in the " << budget << " bytes budget after reclaim.");
+  }
+  return fits;
+}
+
+std::size_t MemoryGovernor::recommendedBatchSize(std::size_t itemBytes, std::size_t maxBatchSize) const
+{
+  if(itemBytes == 0 || maxBatchSize == 0)
+    return std::max<std::size_t>(maxBatchSize, 1);
+  const std::size_t available = availableMemory();
+  const std::size_t nbItems = available / itemBytes;
+  return std::max<std::size_t>(1, std::min(nbItems, maxBatchSize));
+}
+
+} // namespace system
+} // namespace aliceVision
@@ -0,0 +1,126 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace aliceVision {
+namespace system {
+
+/**
+ * @brief Process-wide memory budget governor.
+ *
+ * Modules holding reclaimable memory (region caches, image caches, pyramid
+ * caches) register a usage probe and a reclaim function. Allocating code asks
+ * the governor for headroom before a large allocation: when the registered
+ * usage approaches the budget, the governor triggers eviction in the
+ * registered caches, so the process stays within a predictable footprint
+ * instead of relying on each tool's own heuristics.
+ *
+ * The budget defaults to three quarters of the RAM free at first use and can
+ * be overridden (typically from a command line option) to co-locate several
+ * jobs on one node.
+ */
+class MemoryGovernor
+{
+public:
+  typedef std::size_t ClientId;
+  static const ClientId kNoClient = ~ClientId(0);
+
+  /// Returns the number of bytes currently held by the client.
+  typedef std::function<std::size_t()> UsageFunc;
+  /// Asked to free up to the given number of bytes, returns the bytes freed.
+  typedef std::function<std::size_t(std::size_t)> ReclaimFunc;
+
+  /// @return The governor shared by the whole process.
+  static MemoryGovernor& instance();
+
+  MemoryGovernor(const MemoryGovernor&) = delete;
+  MemoryGovernor& operator=(const MemoryGovernor&) = delete;
+
+  /**
+   * @brief Set the memory budget of the process.
+   * @param[in] nbBytes Budget in bytes (0 restores the automatic budget).
+   */
+  void setMemoryBudget(std::size_t nbBytes);
+
+  /// @return The current memory budget in bytes.
+  std::size_t memoryBudget() const;
+
+  /**
+   * @brief Register a reclaimable cache.
+   *
+   * The functions are called with the governor lock released, but a reclaim
+   * can be triggered from any thread calling requestMemory: both functions
+   * must be thread-safe.
+   *
+   * @param[in] name Client name, used in the logs.
+   * @param[in] usage Probe of the memory currently held.
+   * @param[in] reclaim Eviction entry point.
+   * @return Identifier of the client, to unregister and to self-exclude.
+   */
+  ClientId registerClient(const std::string& name, UsageFunc usage, ReclaimFunc reclaim);
+
+  /**
+   * @brief Unregister a reclaimable cache.
+   * @param[in] clientId Identifier returned by registerClient.
+   */
+  void unregisterClient(ClientId clientId);
+
+  /// @return The memory held by all the registered clients, in bytes.
+  std::size_t usedMemory() const;
+
+  /// @return The budget headroom left, in bytes.
+  std::size_t availableMemory() const;
+
+  /**
+   * @brief Make room for an upcoming allocation.
+   *
+   * When the headroom is too small, the registered clients are asked to
+   * reclaim, in registration order, until the allocation fits.
+   * A cache calling this must pass its own identifier so that it is not asked
+   * to reclaim from itself (which would self-deadlock), and must not hold its
+   * own lock while calling.
+   *
+   * @param[in] nbBytes Size of the upcoming allocation.
+   * @param[in] requester Client to exclude from the reclaim, if any.
+   * @return True if the allocation fits in the budget after reclaim.
+   */
+  bool requestMemory(std::size_t nbBytes, ClientId requester = kNoClient);
+
+  /**
+   * @brief Size a processing batch from the available headroom.
+   * @param[in] itemBytes Memory footprint of one batch item.
+   * @param[in] maxBatchSize Upper bound on the batch size.
+   * @return Batch size in [1, maxBatchSize] fitting in the headroom.
+   */
+  std::size_t recommendedBatchSize(std::size_t itemBytes, std::size_t maxBatchSize) const;
+
+private:
+  MemoryGovernor();
+
+  struct Client
+  {
+    std::string name;
+    UsageFunc usage;
+    ReclaimFunc reclaim;
+  };
+
+  /// Sum the client usages (the governor mutex must be held).
+  std::size_t usedMemoryLocked() const;
+
+  mutable std::mutex _mutex;
+  std::map<ClientId, Client> _clients;
+  ClientId _nextClientId = 0;
+  std::size_t _memoryBudget = 0;
+};
+
+} // namespace system
+} // namespace aliceVision
@@ -0,0 +1,171 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "ProgressReporter.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+
+namespace aliceVision {
+namespace system {
+
+namespace {
+
+// Minimum delay between two periodic emissions
+const std::int64_t emitPeriodUs = 2 * 1000 * 1000;
+
+std::mutex statusFileMutex;
+std::string statusFilepath;
+bool statusFilepathInitialized = false;
+
+// The status file of the process: the explicit setting wins over the
+// ALICEVISION_PROGRESS_FILE environment variable.
+std::string getStatusFilepath()
+{
+  std::lock_guard<std::mutex> lock(statusFileMutex);
+  if(!statusFilepathInitialized)
+  {
+    const char* env = std::getenv("ALICEVISION_PROGRESS_FILE");
+    if(env != nullptr)
+      statusFilepath = env;
+    statusFilepathInitialized = true;
+  }
+  return statusFilepath;
+}
+
+// Escape the characters not allowed in a JSON string
+std::string jsonEscape(const std::string& text)
+{
+  std::string escaped;
+  escaped.reserve(text.size());
+  for(const char c : text)
+  {
+    if(c == '"' || c == '\\')
+      escaped += '\\';
+    if(static_cast<unsigned char>(c) < 0x20)
+      escaped += ' ';
+    else
+      escaped += c;
+  }
+  return escaped;
+}
+
+} // namespace
+
+ProgressReporter::ProgressReporter(std::size_t totalItems, const std::string& label)
+  : _label(label)
+  , _totalItems(totalItems)
+  , _startTime(std::chrono::steady_clock::now())
+{
+}
+
+ProgressReporter::~ProgressReporter()
+{
+  finish();
+}
+
+void ProgressReporter::advance(std::size_t items, std::size_t bytes)
+{
+  const std::size_t doneItems = _doneItems.fetch_add(items, std::memory_order_relaxed) + items;
+  if(bytes != 0)
+    _doneBytes.fetch_add(bytes, std::memory_order_relaxed);
+
+  if(_finished.load(std::memory_order_relaxed))
+    return;
+
+  // Elect at most one emitting worker per period: the winner of the
+  // compare-exchange pushes the deadline forward and reports, the others
+  // return immediately.
+  const std::int64_t nowUs = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - _startTime).count();
+  std::int64_t deadlineUs = _nextEmitUs.load(std::memory_order_relaxed);
+  if(nowUs < deadlineUs)
+    return;
+  if(_nextEmitUs.compare_exchange_strong(deadlineUs, nowUs + emitPeriodUs,
+                                         std::memory_order_relaxed))
+  {
+    emitStatus(doneItems, false);
+  }
+}
+
+void ProgressReporter::finish()
+{
+  bool expected = false;
+  if(!_finished.compare_exchange_strong(expected, true))
+    return;
+  emitStatus(_doneItems.load(std::memory_order_relaxed), true);
+}
+
+void ProgressReporter::setStatusFilepath(const std::string& filepath)
+{
+  std::lock_guard<std::mutex> lock(statusFileMutex);
+  statusFilepath = filepath;
+  statusFilepathInitialized = true;
+}
+
+void ProgressReporter::emitStatus(std::size_t doneItems, bool finished)
+{
+  const double elapsedSeconds = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - _startTime).count();
+  const std::size_t doneBytes = _doneBytes.load(std::memory_order_relaxed);
+
+  const double itemsPerSecond = (elapsedSeconds > 0.0) ? doneItems / elapsedSeconds : 0.0;
+  const double bytesPerSecond = (elapsedSeconds > 0.0) ? doneBytes / elapsedSeconds : 0.0;
+  const double etaSeconds = (itemsPerSecond > 0.0 && doneItems < _totalItems)
+      ? (_totalItems - doneItems) / itemsPerSecond
+      : 0.0;
+
+  {
+    std::ostringstream line;
+    line << _label << ": " << doneItems << "/" << _totalItems;
+    if(_totalItems > 0)
+      line << " (" << std::size_t(100.0 * doneItems / _totalItems) << "%)";
+    line << ", " << std::size_t(itemsPerSecond) << " items/s";
+    if(doneBytes != 0)
+      line << ", " << std::size_t(bytesPerSecond / (1024.0 * 1024.0)) << " MB/s";
+    if(finished)
+      line << ", done in " << std::size_t(elapsedSeconds) << "s";
+    else
+      line << ", ETA " << std::size_t(etaSeconds) << "s";
+    ALICEVISION_LOG_INFO(line.str());
+  }
+
+  const std::string filepath = getStatusFilepath();
+  if(filepath.empty())
+    return;
+
+  // Write to a temporary file and rename it over the status file, so a
+  // concurrent reader always sees a complete JSON document.
+  const std::string tmpFilepath = filepath + ".tmp";
+  {
+    std::ofstream file(tmpFilepath.c_str());
+    if(!file.is_open())
+    {
+      ALICEVISION_LOG_DEBUG("Unable to write the progress status file: " << tmpFilepath);
+      return;
+    }
+    file << "{"
+         << "\"label\": \"" << jsonEscape(_label) << "\", "
+         << "\"done\": " << doneItems << ", "
+         << "\"total\": " << _totalItems << ", "
+         << "\"bytes\": " << doneBytes << ", "
+         << "\"itemsPerSecond\": " << itemsPerSecond << ", "
+         << "\"bytesPerSecond\": " << bytesPerSecond << ", "
+         << "\"elapsedSeconds\": " << elapsedSeconds << ", "
+         << "\"etaSeconds\": " << etaSeconds << ", "
+         << "\"finished\": " << (finished ? "true" : "false")
+         << "}\n";
+  }
+  if(std::rename(tmpFilepath.c_str(), filepath.c_str()) != 0)
+    ALICEVISION_LOG_DEBUG("Unable to replace the progress status file: " << filepath);
+}
+
+} // namespace system
+} // namespace aliceVision
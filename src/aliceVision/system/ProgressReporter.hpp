@@ -0,0 +1,83 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace aliceVision {
+namespace system {
+
+/**
+ * @brief Lightweight progress reporter for long pipeline stages.
+ *
+ * Counts processed items (and optionally bytes) with relaxed atomic
+ * increments, so workers in tight parallel loops never take a lock, unlike
+ * boost::progress_display. One worker at a time, throttled to a fixed
+ * period, additionally logs a human readable line with the throughput and
+ * the remaining time, and rewrites a machine readable JSON status file when
+ * one is configured (ALICEVISION_PROGRESS_FILE environment variable or
+ * setStatusFilepath). The status file is replaced atomically with a rename,
+ * so a poller never reads a partial document.
+ */
+class ProgressReporter
+{
+public:
+  /**
+   * @param[in] totalItems The number of items the stage will process.
+   * @param[in] label Short stage name, logged and written to the status file.
+   */
+  ProgressReporter(std::size_t totalItems, const std::string& label);
+
+  /// Emits the final report if finish() has not been called.
+  ~ProgressReporter();
+
+  ProgressReporter(const ProgressReporter&) = delete;
+  ProgressReporter& operator=(const ProgressReporter&) = delete;
+
+  /**
+   * @brief Record processed work, callable concurrently from any thread.
+   * @param[in] items The number of items processed.
+   * @param[in] bytes The number of bytes processed, if meaningful.
+   */
+  void advance(std::size_t items = 1, std::size_t bytes = 0);
+
+  /// Shorthand for advance(1), mirroring the boost::progress_display usage.
+  ProgressReporter& operator++() { advance(); return *this; }
+
+  /// The number of items reported so far.
+  std::size_t done() const { return _doneItems.load(std::memory_order_relaxed); }
+
+  /// Log the final line and write the final status; further advances are ignored.
+  void finish();
+
+  /**
+   * @brief Set the JSON status file written by all the reporters of the
+   * process, overriding the ALICEVISION_PROGRESS_FILE environment variable.
+   * An empty path disables the file output.
+   */
+  static void setStatusFilepath(const std::string& filepath);
+
+private:
+  /// Write the log line and the status file for the given item count.
+  void emitStatus(std::size_t doneItems, bool finished);
+
+  const std::string _label;
+  const std::size_t _totalItems;
+  std::atomic<std::size_t> _doneItems{0};
+  std::atomic<std::size_t> _doneBytes{0};
+  /// Elapsed time (us) after which the next periodic emission happens;
+  /// the emitting worker is elected with a compare-exchange on this value.
+  std::atomic<std::int64_t> _nextEmitUs{0};
+  std::atomic<bool> _finished{false};
+  std::chrono::steady_clock::time_point _startTime;
+};
+
+} // namespace system
+} // namespace aliceVision
@@ -0,0 +1,420 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "TaskScheduler.hpp"
+#include "numa.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+
+namespace aliceVision {
+namespace system {
+
+namespace {
+// Index of the worker owning the current thread, -1 on external threads.
+thread_local int tlsWorkerIndex = -1;
+}
+
+TaskScheduler& TaskScheduler::instance()
+{
+  static TaskScheduler scheduler;
+  return scheduler;
+}
+
+TaskScheduler::TaskScheduler()
+{
+  std::size_t nbThreads = std::thread::hardware_concurrency();
+  if(nbThreads == 0)
+    nbThreads = 1;
+  startWorkers(nbThreads);
+}
+
+TaskScheduler::~TaskScheduler()
+{
+  stopWorkers();
+}
+
+void TaskScheduler::setNbThreads(std::size_t nbThreads)
+{
+  if(nbThreads == 0)
+  {
+    nbThreads = std::thread::hardware_concurrency();
+    if(nbThreads == 0)
+      nbThreads = 1;
+  }
+  if(nbThreads == _workers.size())
+    return;
+
+  stopWorkers();
+
+  // Keep the tasks that were still queued and redistribute them.
+  std::deque<std::shared_ptr<Task> > pendingTasks;
+  for(const auto& queue : _workerQueues)
+    pendingTasks.insert(pendingTasks.end(), queue->tasks.begin(), queue->tasks.end());
+
+  startWorkers(nbThreads);
+  for(const std::shared_ptr<Task>& task : pendingTasks)
+    enqueueReady(task);
+}
+
+std::size_t TaskScheduler::nbThreads() const
+{
+  return _workers.size();
+}
+
+void TaskScheduler::setNumaPinning(bool enable)
+{
+  if(enable == _numaPinning)
+    return;
+  if(enable && getNbNumaNodes() <= 1)
+    return; // nothing to pin on a single-node machine
+
+  const std::size_t nbThreads = _workers.size();
+  stopWorkers();
+
+  std::deque<std::shared_ptr<Task> > pendingTasks;
+  for(const auto& queue : _workerQueues)
+    pendingTasks.insert(pendingTasks.end(), queue->tasks.begin(), queue->tasks.end());
+
+  _numaPinning = enable;
+  startWorkers(nbThreads);
+  for(const std::shared_ptr<Task>& task : pendingTasks)
+    enqueueReady(task);
+}
+
+void TaskScheduler::startWorkers(std::size_t nbThreads)
+{
+  assert(_workers.empty());
+  _stopFlag = false;
+  _nbReadyTasks = 0;
+  _nextPushIndex = 0;
+  _workerQueues.clear();
+  for(std::size_t i = 0; i < nbThreads; ++i)
+    _workerQueues.emplace_back(new WorkerQueue());
+
+  // Spread the workers round-robin over the NUMA nodes when pinning is on.
+  const std::size_t nbNodes = _numaPinning ? std::size_t(getNbNumaNodes()) : 1;
+  _workerNodes.assign(nbThreads, -1);
+  _workersPerNode.assign(nbNodes, std::vector<std::size_t>());
+  for(std::size_t i = 0; i < nbThreads; ++i)
+  {
+    const std::size_t node = i % nbNodes;
+    if(_numaPinning)
+      _workerNodes[i] = int(node);
+    _workersPerNode[node].push_back(i);
+  }
+
+  for(std::size_t i = 0; i < nbThreads; ++i)
+    _workers.emplace_back(&TaskScheduler::workerLoop, this, i);
+}
+
+void TaskScheduler::stopWorkers()
+{
+  {
+    std::lock_guard<std::mutex> lock(_sleepMutex);
+    _stopFlag = true;
+  }
+  _workAvailable.notify_all();
+  for(std::thread& worker : _workers)
+    worker.join();
+  _workers.clear();
+}
+
+TaskScheduler::TaskId TaskScheduler::addTask(std::function<void()> task)
+{
+  return addTask(std::move(task), std::vector<TaskId>(), -1);
+}
+
+TaskScheduler::TaskId TaskScheduler::addTask(std::function<void()> task, const std::vector<TaskId>& dependencies)
+{
+  return addTask(std::move(task), dependencies, -1);
+}
+
+TaskScheduler::TaskId TaskScheduler::addTaskOnNumaNode(int numaNode, std::function<void()> task)
+{
+  return addTask(std::move(task), std::vector<TaskId>(), numaNode);
+}
+
+TaskScheduler::TaskId TaskScheduler::addTask(std::function<void()> task, const std::vector<TaskId>& dependencies, int numaNode)
+{
+  std::shared_ptr<Task> newTask(new Task());
+  newTask->function = std::move(task);
+  newTask->numaNode = numaNode;
+
+  TaskId taskId;
+  bool ready;
+  {
+    std::lock_guard<std::mutex> lock(_graphMutex);
+    taskId = _nextTaskId++;
+    newTask->id = taskId;
+    for(const TaskId dependencyId : dependencies)
+    {
+      const auto it = _tasks.find(dependencyId);
+      // An absent or done dependency is already satisfied.
+      if(it == _tasks.end() || it->second->done)
+        continue;
+      it->second->dependents.push_back(taskId);
+      ++newTask->nbRemainingDependencies;
+    }
+    _tasks[taskId] = newTask;
+    ready = (newTask->nbRemainingDependencies == 0);
+  }
+
+  if(ready)
+    enqueueReady(newTask);
+  return taskId;
+}
+
+void TaskScheduler::enqueueReady(const std::shared_ptr<Task>& task)
+{
+  {
+    std::size_t queueIndex;
+    if(_numaPinning && task->numaNode >= 0 && task->numaNode < int(_workersPerNode.size())
+       && !_workersPerNode[task->numaNode].empty())
+    {
+      // push on a queue of the preferred node, round-robin among its workers
+      const std::vector<std::size_t>& nodeWorkers = _workersPerNode[task->numaNode];
+      queueIndex = nodeWorkers[_nextPushIndex++ % nodeWorkers.size()];
+    }
+    else
+    {
+      queueIndex = (tlsWorkerIndex >= 0) ? std::size_t(tlsWorkerIndex)
+                                         : (_nextPushIndex++ % _workerQueues.size());
+    }
+    WorkerQueue& queue = *_workerQueues[queueIndex];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.tasks.push_back(task);
+  }
+  {
+    std::lock_guard<std::mutex> lock(_sleepMutex);
+    ++_nbReadyTasks;
+  }
+  _workAvailable.notify_one();
+  // Wake the threads blocked in wait() so that they can try to steal it.
+  _taskDone.notify_all();
+}
+
+std::shared_ptr<TaskScheduler::Task> TaskScheduler::popOrSteal(std::size_t workerIndex)
+{
+  std::shared_ptr<Task> task;
+  const std::size_t nbQueues = _workerQueues.size();
+
+  // Newest own task first for locality, then the oldest task of the others.
+  {
+    WorkerQueue& ownQueue = *_workerQueues[workerIndex % nbQueues];
+    std::lock_guard<std::mutex> lock(ownQueue.mutex);
+    if(!ownQueue.tasks.empty())
+    {
+      task = ownQueue.tasks.back();
+      ownQueue.tasks.pop_back();
+    }
+  }
+  // Steal from same-node victims first when the workers are pinned, so tasks
+  // keep running on the socket owning their data as long as it has work.
+  const int ownNode = (workerIndex < _workerNodes.size()) ? _workerNodes[workerIndex] : -1;
+  for(int pass = 0; (task == nullptr) && (pass < 2); ++pass)
+  {
+    for(std::size_t i = 1; (task == nullptr) && (i < nbQueues); ++i)
+    {
+      const std::size_t victimIndex = (workerIndex + i) % nbQueues;
+      if(ownNode >= 0)
+      {
+        const bool sameNode = (_workerNodes[victimIndex] == ownNode);
+        if(sameNode != (pass == 0))
+          continue;
+      }
+      else if(pass == 1)
+        break; // no pinning: a single pass over all the victims
+      WorkerQueue& victimQueue = *_workerQueues[victimIndex];
+      std::lock_guard<std::mutex> lock(victimQueue.mutex);
+      if(!victimQueue.tasks.empty())
+      {
+        task = victimQueue.tasks.front();
+        victimQueue.tasks.pop_front();
+      }
+    }
+  }
+
+  if(task != nullptr)
+  {
+    std::lock_guard<std::mutex> lock(_sleepMutex);
+    --_nbReadyTasks;
+  }
+  return task;
+}
+
+void TaskScheduler::runTask(const std::shared_ptr<Task>& task)
+{
+  std::exception_ptr exception;
+  try
+  {
+    task->function();
+  }
+  catch(...)
+  {
+    exception = std::current_exception();
+  }
+  // The function may own large captures (eg. decoded images), release them now.
+  task->function = nullptr;
+
+  std::vector<std::shared_ptr<Task> > readyDependents;
+  {
+    std::lock_guard<std::mutex> lock(_graphMutex);
+    task->done = true;
+    task->exception = exception;
+    for(const TaskId dependentId : task->dependents)
+    {
+      const auto it = _tasks.find(dependentId);
+      assert(it != _tasks.end());
+      if(--it->second->nbRemainingDependencies == 0)
+        readyDependents.push_back(it->second);
+    }
+    // Completed tasks without an exception to report are forgotten; wait() on
+    // their identifier returns immediately.
+    if(exception == nullptr)
+      _tasks.erase(task->id);
+  }
+  _taskDone.notify_all();
+
+  for(const std::shared_ptr<Task>& dependent : readyDependents)
+    enqueueReady(dependent);
+}
+
+void TaskScheduler::workerLoop(std::size_t workerIndex)
+{
+  tlsWorkerIndex = int(workerIndex);
+  if(_workerNodes[workerIndex] >= 0)
+    bindThreadToNumaNode(_workerNodes[workerIndex]);
+  while(true)
+  {
+    std::shared_ptr<Task> task = popOrSteal(workerIndex);
+    if(task != nullptr)
+    {
+      runTask(task);
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(_sleepMutex);
+    while(!_stopFlag && _nbReadyTasks == 0)
+      _workAvailable.wait(lock);
+    if(_stopFlag)
+      return;
+  }
+}
+
+void TaskScheduler::wait(TaskId taskId)
+{
+  while(true)
+  {
+    {
+      std::exception_ptr exception;
+      bool completed = false;
+      {
+        std::lock_guard<std::mutex> lock(_graphMutex);
+        const auto it = _tasks.find(taskId);
+        if(it == _tasks.end())
+          return; // unknown or already completed without error
+        if(it->second->done)
+        {
+          completed = true;
+          exception = it->second->exception;
+          _tasks.erase(it);
+        }
+      }
+      if(exception != nullptr)
+        std::rethrow_exception(exception);
+      if(completed)
+        return;
+    }
+
+    // Help executing ready tasks instead of just blocking: this makes waiting
+    // from inside a task safe and puts the caller thread to work.
+    std::shared_ptr<Task> task = popOrSteal((tlsWorkerIndex >= 0) ? std::size_t(tlsWorkerIndex) : 0);
+    if(task != nullptr)
+    {
+      runTask(task);
+      continue;
+    }
+
+    // Nothing to execute: the target runs or waits on another thread. Sleep
+    // until a completion or a newly ready task changes the picture.
+    std::unique_lock<std::mutex> lock(_graphMutex);
+    const auto it = _tasks.find(taskId);
+    if(it == _tasks.end() || it->second->done)
+      continue;
+    _taskDone.wait_for(lock, std::chrono::milliseconds(1));
+  }
+}
+
+void TaskScheduler::wait(const std::vector<TaskId>& taskIds)
+{
+  for(const TaskId taskId : taskIds)
+    wait(taskId);
+}
+
+void TaskScheduler::parallelFor(std::size_t begin, std::size_t end, const std::function<void(std::size_t)>& body)
+{
+  if(begin >= end)
+    return;
+
+  const std::size_t nbIterations = end - begin;
+  const std::size_t nbHelpers = std::min(_workers.size(), nbIterations - 1);
+
+  struct LoopState
+  {
+    std::atomic<std::size_t> nextIndex;
+    std::size_t end;
+    std::size_t chunkSize;
+    const std::function<void(std::size_t)>* body;
+    std::mutex exceptionMutex;
+    std::exception_ptr exception;
+  };
+  std::shared_ptr<LoopState> state(new LoopState());
+  state->nextIndex = begin;
+  state->end = end;
+  state->chunkSize = std::max<std::size_t>(1, nbIterations / ((nbHelpers + 1) * 8));
+  state->body = &body;
+
+  // Chunked dynamic distribution, equivalent to an OpenMP dynamic schedule.
+  // On error the remaining iterations are skipped and the first exception is
+  // rethrown once every participant has drained.
+  const auto runChunks = [state]()
+  {
+    while(true)
+    {
+      const std::size_t chunkBegin = state->nextIndex.fetch_add(state->chunkSize);
+      if(chunkBegin >= state->end)
+        break;
+      const std::size_t chunkEnd = std::min(state->end, chunkBegin + state->chunkSize);
+      try
+      {
+        for(std::size_t i = chunkBegin; i < chunkEnd; ++i)
+          (*state->body)(i);
+      }
+      catch(...)
+      {
+        std::lock_guard<std::mutex> lock(state->exceptionMutex);
+        if(state->exception == nullptr)
+          state->exception = std::current_exception();
+        state->nextIndex = state->end; // skip the remaining iterations
+      }
+    }
+  };
+
+  std::vector<TaskId> helperIds;
+  helperIds.reserve(nbHelpers);
+  for(std::size_t i = 0; i < nbHelpers; ++i)
+    helperIds.push_back(addTask(runChunks));
+
+  runChunks();
+  wait(helperIds);
+
+  if(state->exception != nullptr)
+    std::rethrow_exception(state->exception);
+}
+
+} // namespace system
+} // namespace aliceVision
@@ -0,0 +1,193 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace aliceVision {
+namespace system {
+
+/**
+ * @brief Process-wide work-stealing thread pool with task dependencies.
+ *
+ * Unlike the OpenMP pragmas used inside the algorithmic modules, the scheduler
+ * owns a single pool of threads for the whole process, so independent stages
+ * of a pipeline binary share one core budget instead of oversubscribing each
+ * other. Each worker owns a double-ended task queue: it executes its own tasks
+ * in LIFO order for locality and steals the oldest task of another worker when
+ * it runs dry.
+ *
+ * A task is a void() function, optionally ordered after other tasks. A task
+ * body must not block on external events produced by other tasks of the pool
+ * (use dependencies for that); waiting threads help executing ready tasks, so
+ * waiting from inside a task is safe.
+ */
+class TaskScheduler
+{
+public:
+  /// Identifier of a submitted task, used to declare dependencies and to wait.
+  typedef std::size_t TaskId;
+
+  /// @return The scheduler shared by the whole process.
+  static TaskScheduler& instance();
+
+  TaskScheduler(const TaskScheduler&) = delete;
+  TaskScheduler& operator=(const TaskScheduler&) = delete;
+  ~TaskScheduler();
+
+  /**
+   * @brief Set the number of worker threads.
+   *
+   * Pending tasks are kept; the pool is restarted with the new size.
+   *
+   * @param[in] nbThreads Number of workers (0 restores the hardware default).
+   */
+  void setNbThreads(std::size_t nbThreads);
+
+  /// @return The current number of worker threads.
+  std::size_t nbThreads() const;
+
+  /**
+   * @brief Pin the workers to the NUMA nodes of the machine.
+   *
+   * Workers are spread round-robin over the nodes and bound to the CPUs of
+   * their node, so the memory they first-touch is node-local and the tasks
+   * submitted with addTaskOnNumaNode() run on the socket owning their data.
+   * Work stealing then prefers same-node victims; a cross-node steal remains
+   * possible when a node runs dry, so the affinity is a preference, not a
+   * guarantee. The pool is restarted; pending tasks are kept. No effect on
+   * machines with a single node.
+   *
+   * @param[in] enable Whether to pin the workers.
+   */
+  void setNumaPinning(bool enable);
+
+  /**
+   * @brief Submit a task preferring the workers of a NUMA node.
+   *
+   * Without NUMA pinning this behaves like addTask().
+   *
+   * @param[in] numaNode The node owning the data of the task.
+   * @param[in] task The function to execute.
+   * @return Identifier of the task.
+   */
+  TaskId addTaskOnNumaNode(int numaNode, std::function<void()> task);
+
+  /**
+   * @brief Submit a task with no dependency.
+   *
+   * @param[in] task The function to execute.
+   * @return Identifier of the task.
+   */
+  TaskId addTask(std::function<void()> task);
+
+  /**
+   * @brief Submit a task ordered after other tasks.
+   *
+   * The task becomes ready once all its dependencies have completed.
+   * Dependencies must be identifiers returned by a previous addTask call.
+   *
+   * @param[in] task The function to execute.
+   * @param[in] dependencies Tasks that must complete before this one starts.
+   * @return Identifier of the task.
+   */
+  TaskId addTask(std::function<void()> task, const std::vector<TaskId>& dependencies);
+
+  /**
+   * @brief Wait until a task has completed.
+   *
+   * The calling thread executes ready tasks while waiting. If the task threw,
+   * the exception is rethrown here.
+   *
+   * @param[in] taskId The task to wait for.
+   */
+  void wait(TaskId taskId);
+
+  /**
+   * @brief Wait until all the given tasks have completed.
+   *
+   * @param[in] taskIds The tasks to wait for.
+   */
+  void wait(const std::vector<TaskId>& taskIds);
+
+  /**
+   * @brief Execute body(i) for each i in [begin, end) on the pool.
+   *
+   * The calling thread participates. Iterations are distributed dynamically
+   * in small chunks, like an OpenMP dynamic schedule. The first exception
+   * thrown by an iteration is rethrown here once all workers have drained.
+   *
+   * @param[in] begin First index.
+   * @param[in] end Past-the-end index.
+   * @param[in] body The function to call for each index.
+   */
+  void parallelFor(std::size_t begin, std::size_t end, const std::function<void(std::size_t)>& body);
+
+private:
+  struct Task
+  {
+    TaskId id = 0;
+    std::function<void()> function;
+    std::vector<TaskId> dependents;
+    std::size_t nbRemainingDependencies = 0;
+    bool done = false;
+    std::exception_ptr exception;
+    int numaNode = -1; // preferred NUMA node, -1 for no preference
+  };
+
+  struct WorkerQueue
+  {
+    std::mutex mutex;
+    std::deque<std::shared_ptr<Task> > tasks;
+  };
+
+  TaskScheduler();
+
+  TaskId addTask(std::function<void()> task, const std::vector<TaskId>& dependencies, int numaNode);
+
+  void startWorkers(std::size_t nbThreads);
+  void stopWorkers();
+  void workerLoop(std::size_t workerIndex);
+
+  /// Push a ready task on a worker queue and wake a sleeping worker.
+  void enqueueReady(const std::shared_ptr<Task>& task);
+  /// Pop a task from the current worker queue, or steal one from another.
+  std::shared_ptr<Task> popOrSteal(std::size_t workerIndex);
+  /// Run a ready task and release its dependents.
+  void runTask(const std::shared_ptr<Task>& task);
+
+  /// Guards the task graph (_tasks, dependents, done flags).
+  mutable std::mutex _graphMutex;
+  std::condition_variable _taskDone;
+  std::map<TaskId, std::shared_ptr<Task> > _tasks;
+  TaskId _nextTaskId = 0;
+
+  /// Guards _nbReadyTasks and the workers sleep/wake handshake.
+  std::mutex _sleepMutex;
+  std::condition_variable _workAvailable;
+  std::size_t _nbReadyTasks = 0;
+  bool _stopFlag = false;
+
+  std::vector<std::unique_ptr<WorkerQueue> > _workerQueues;
+  std::vector<std::thread> _workers;
+  std::atomic<std::size_t> _nextPushIndex;
+
+  // NUMA pinning (see setNumaPinning)
+  bool _numaPinning = false;
+  std::vector<int> _workerNodes; // NUMA node of each worker, -1 when not pinned
+  std::vector<std::vector<std::size_t> > _workersPerNode;
+};
+
+} // namespace system
+} // namespace aliceVision
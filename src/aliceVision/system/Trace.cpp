@@ -0,0 +1,74 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "Trace.hpp"
+
+#include <fstream>
+
+namespace aliceVision {
+namespace system {
+
+Trace& Trace::instance()
+{
+  static Trace trace;
+  return trace;
+}
+
+void Trace::setOutputFilepath(const std::string& filepath)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _filepath = filepath;
+  _origin = std::chrono::high_resolution_clock::now();
+  _enabled = true;
+}
+
+void Trace::addSpan(const std::string& name, double start_us, double duration_us)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  const std::thread::id threadId = std::this_thread::get_id();
+  std::map<std::thread::id, int>::const_iterator itThread = _threadIds.find(threadId);
+  if(itThread == _threadIds.end())
+    itThread = _threadIds.insert(std::make_pair(threadId, static_cast<int>(_threadIds.size()))).first;
+  _spans.push_back(Span{name, start_us, duration_us, itThread->second});
+}
+
+double Trace::now_us() const
+{
+  return std::chrono::duration_cast<std::chrono::duration<double, std::micro>>(
+    std::chrono::high_resolution_clock::now() - _origin).count();
+}
+
+bool Trace::save() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  if(_filepath.empty())
+    return false;
+
+  std::ofstream of(_filepath.c_str());
+  if(!of.is_open())
+    return false;
+
+  // Chrome trace-event format: an array of complete ("ph":"X") events
+  of << "{\"traceEvents\":[";
+  for(std::size_t i = 0; i < _spans.size(); ++i)
+  {
+    const Span& span = _spans[i];
+    if(i != 0)
+      of << ",";
+    of << "\n{\"name\":\"" << span.name << "\","
+       << "\"cat\":\"aliceVision\",\"ph\":\"X\",\"pid\":0,"
+       << "\"tid\":" << span.threadId << ","
+       << "\"ts\":" << span.start_us << ","
+       << "\"dur\":" << span.duration_us << "}";
+  }
+  of << "\n]}\n";
+  of.flush();
+  const bool bOk = of.good();
+  of.close();
+  return bOk;
+}
+
+} // namespace system
+} // namespace aliceVision
@@ -0,0 +1,100 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace aliceVision {
+namespace system {
+
+/**
+ * @brief Low overhead structured performance trace.
+ *
+ * Collects named spans (see TraceSpan) and writes them as a Chrome trace-event JSON
+ * file, viewable in chrome://tracing or Perfetto. The collector stays disabled until
+ * an output file is set: disabled probes only test an atomic flag, so they can be
+ * left in production code.
+ */
+class Trace
+{
+public:
+  /// Access the process-wide trace collector
+  static Trace& instance();
+
+  /// Set the output file and enable the span collection
+  void setOutputFilepath(const std::string& filepath);
+
+  /// Return true if the span collection is enabled
+  bool isEnabled() const { return _enabled; }
+
+  /// Record a complete span, timestamp and duration in microseconds (see now_us())
+  void addSpan(const std::string& name, double start_us, double duration_us);
+
+  /// Timestamp in microseconds since the span collection was enabled
+  double now_us() const;
+
+  /// Write the collected spans to the output file, return false on failure
+  bool save() const;
+
+private:
+  Trace() = default;
+
+  struct Span
+  {
+    std::string name;
+    double start_us;
+    double duration_us;
+    int threadId;
+  };
+
+  mutable std::mutex _mutex;
+  std::string _filepath;
+  std::vector<Span> _spans;
+  std::map<std::thread::id, int> _threadIds; // small contiguous ids for the trace viewer
+  std::chrono::high_resolution_clock::time_point _origin;
+  std::atomic<bool> _enabled{false};
+};
+
+/**
+ * @brief Scoped probe: records a named span covering its own lifetime into Trace.
+ * Probes opened within each other on the same thread nest in the trace viewer.
+ */
+class TraceSpan
+{
+public:
+  explicit TraceSpan(const std::string& name)
+  {
+    if(Trace::instance().isEnabled())
+    {
+      _name = name;
+      _start_us = Trace::instance().now_us();
+      _active = true;
+    }
+  }
+
+  ~TraceSpan()
+  {
+    if(_active)
+      Trace::instance().addSpan(_name, _start_us, Trace::instance().now_us() - _start_us);
+  }
+
+  TraceSpan(const TraceSpan&) = delete;
+  TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+  std::string _name;
+  double _start_us = 0.0;
+  bool _active = false;
+};
+
+} // namespace system
+} // namespace aliceVision
@@ -0,0 +1,170 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "TuningProfile.hpp"
+#include "Logger.hpp"
+#include "Trace.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <sys/stat.h>
+
+namespace aliceVision {
+namespace system {
+
+namespace {
+
+std::string trim(const std::string& s)
+{
+  const std::size_t first = s.find_first_not_of(" \t\r");
+  if(first == std::string::npos)
+    return std::string();
+  const std::size_t last = s.find_last_not_of(" \t\r");
+  return s.substr(first, last - first + 1);
+}
+
+std::time_t fileMTime(const std::string& filepath)
+{
+  struct stat fileStat;
+  if(stat(filepath.c_str(), &fileStat) != 0)
+    return 0;
+  return fileStat.st_mtime;
+}
+
+} // namespace
+
+TuningProfile& TuningProfile::instance()
+{
+  static TuningProfile profile;
+  return profile;
+}
+
+bool TuningProfile::load(const std::string& filepath)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return loadLocked(filepath);
+}
+
+bool TuningProfile::loadLocked(const std::string& filepath)
+{
+  std::ifstream file(filepath);
+  if(!file)
+  {
+    ALICEVISION_LOG_ERROR("Unable to read the tuning profile file: " << filepath);
+    return false;
+  }
+
+  std::map<std::string, std::map<std::string, std::string> > stages;
+  std::string line;
+  std::string currentStage;
+  std::size_t lineNumber = 0;
+
+  while(std::getline(file, line))
+  {
+    ++lineNumber;
+    line = trim(line);
+    if(line.empty() || line[0] == '#' || line[0] == ';')
+      continue;
+
+    if(line[0] == '[')
+    {
+      const std::size_t closing = line.find(']');
+      if(closing == std::string::npos)
+      {
+        ALICEVISION_LOG_ERROR("Tuning profile parse error (" << filepath << ":" << lineNumber
+                              << "): unterminated section name");
+        return false;
+      }
+      currentStage = trim(line.substr(1, closing - 1));
+      stages[currentStage]; // a stage can be declared empty
+      continue;
+    }
+
+    const std::size_t equal = line.find('=');
+    if(equal == std::string::npos || currentStage.empty())
+    {
+      ALICEVISION_LOG_ERROR("Tuning profile parse error (" << filepath << ":" << lineNumber
+                            << "): expected 'key = value' inside a [stage] section");
+      return false;
+    }
+    const std::string key = trim(line.substr(0, equal));
+    const std::string value = trim(line.substr(equal + 1));
+    stages[currentStage][key] = value;
+  }
+
+  _stages.swap(stages);
+  _filepath = filepath;
+  _loadedMTime = fileMTime(filepath);
+
+  // Log the profile and surface it in the performance trace, so a captured
+  // trace always records the tuning it was produced with.
+  for(const auto& stage : _stages)
+  {
+    for(const auto& keyValue : stage.second)
+    {
+      const std::string description = "tuning/" + stage.first + "." + keyValue.first + "=" + keyValue.second;
+      ALICEVISION_LOG_INFO("Tuning profile: " << stage.first << "." << keyValue.first << " = " << keyValue.second);
+      if(Trace::instance().isEnabled())
+        Trace::instance().addSpan(description, Trace::instance().now_us(), 0.0);
+    }
+  }
+  return true;
+}
+
+bool TuningProfile::reloadIfChanged()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  if(_filepath.empty())
+    return false;
+  const std::time_t mTime = fileMTime(_filepath);
+  if(mTime == 0 || mTime == _loadedMTime)
+    return false;
+  return loadLocked(_filepath);
+}
+
+bool TuningProfile::isLoaded() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return !_filepath.empty();
+}
+
+bool TuningProfile::hasStage(const std::string& stage) const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _stages.count(stage) > 0;
+}
+
+std::size_t TuningProfile::nbThreads(const std::string& stage, std::size_t defaultValue) const
+{
+  return value(stage, "threads", defaultValue);
+}
+
+std::size_t TuningProfile::queueDepth(const std::string& stage, std::size_t defaultValue) const
+{
+  return value(stage, "queueDepth", defaultValue);
+}
+
+std::size_t TuningProfile::memoryBudgetBytes(const std::string& stage, std::size_t defaultValue) const
+{
+  const std::size_t megaBytes = value(stage, "memoryBudgetMb", 0);
+  if(megaBytes == 0)
+    return defaultValue;
+  return megaBytes * 1024 * 1024;
+}
+
+std::size_t TuningProfile::value(const std::string& stage, const std::string& key, std::size_t defaultValue) const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  const auto stageIt = _stages.find(stage);
+  if(stageIt == _stages.end())
+    return defaultValue;
+  const auto keyIt = stageIt->second.find(key);
+  if(keyIt == stageIt->second.end())
+    return defaultValue;
+  return std::size_t(std::atoll(keyIt->second.c_str()));
+}
+
+} // namespace system
+} // namespace aliceVision
@@ -0,0 +1,96 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace aliceVision {
+namespace system {
+
+/**
+ * @brief Per-stage tuning profile of a pipeline tool.
+ *
+ * A profile is an INI-style file with one section per pipeline stage,
+ * overriding the thread count, queue depth and memory budget that the tools
+ * otherwise derive from the machine:
+ *
+ *   # mixed node: keep decode light, give the cores to the matcher
+ *   [decode]
+ *   threads = 4
+ *   queueDepth = 8
+ *
+ *   [matching]
+ *   threads = 56
+ *   memoryBudgetMb = 40960
+ *
+ * Unknown stages and keys are kept and queryable through value(), so a tool
+ * can expose its own knobs without touching this class. The loaded values are
+ * logged and emitted as zero-duration spans into the performance trace (see
+ * Trace.hpp), so a trace always records the tuning it was captured with.
+ *
+ * The profile is hot-reloadable: reloadIfChanged() re-reads the file when its
+ * modification time changed, and the tools re-apply the values they can at
+ * their next convenient point (eg. between two batches).
+ */
+class TuningProfile
+{
+public:
+  /// Access the process-wide tuning profile
+  static TuningProfile& instance();
+
+  /**
+   * @brief Load a profile file, replacing the current values.
+   * @param[in] filepath Path to the profile file
+   * @return false if the file cannot be read or parsed
+   */
+  bool load(const std::string& filepath);
+
+  /**
+   * @brief Re-read the profile file if it changed on disk since the last load.
+   * @return true if the profile has been reloaded
+   */
+  bool reloadIfChanged();
+
+  /// Return true if a profile file has been loaded
+  bool isLoaded() const;
+
+  /// Return true if the loaded profile defines the given stage
+  bool hasStage(const std::string& stage) const;
+
+  /// Thread count of a stage, or \p defaultValue if not set ("threads" key)
+  std::size_t nbThreads(const std::string& stage, std::size_t defaultValue) const;
+
+  /// Queue depth of a stage, or \p defaultValue if not set ("queueDepth" key)
+  std::size_t queueDepth(const std::string& stage, std::size_t defaultValue) const;
+
+  /// Memory budget of a stage in bytes, or \p defaultValue if not set ("memoryBudgetMb" key)
+  std::size_t memoryBudgetBytes(const std::string& stage, std::size_t defaultValue) const;
+
+  /**
+   * @brief Generic numeric access to any key of a stage.
+   * @param[in] stage The stage (section) name
+   * @param[in] key The key name
+   * @param[in] defaultValue Returned when the stage or the key is absent
+   * @return the value of the key, or \p defaultValue
+   */
+  std::size_t value(const std::string& stage, const std::string& key, std::size_t defaultValue) const;
+
+private:
+  TuningProfile() = default;
+
+  bool loadLocked(const std::string& filepath);
+
+  mutable std::mutex _mutex;
+  std::string _filepath;
+  std::time_t _loadedMTime = 0;
+  std::map<std::string, std::map<std::string, std::string> > _stages;
+};
+
+} // namespace system
+} // namespace aliceVision
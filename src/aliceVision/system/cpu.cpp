@@ -163,3 +163,97 @@ int get_total_cpus(void)
 
 #endif /* GET_TOTAL_CPUS_DEFINED */
 
+
+
+/* cpu_support_sse41() / cpu_support_avx2() / cpu_support_avx512(): CPUID based x86 feature detection */
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+namespace aliceVision {
+namespace system {
+
+namespace {
+
+void run_cpuid(int leaf, int subleaf, unsigned int regs[4])
+{
+#ifdef _MSC_VER
+	int cpuInfo[4];
+	__cpuidex(cpuInfo, leaf, subleaf);
+	for (int i = 0; i < 4; ++i) regs[i] = (unsigned int)cpuInfo[i];
+#else
+	__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+unsigned long long run_xgetbv()
+{
+#ifdef _MSC_VER
+	return _xgetbv(0);
+#else
+	unsigned int eax, edx;
+	__asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+	return ((unsigned long long)edx << 32) | eax;
+#endif
+}
+
+/* OSXSAVE set and the OS saves/restores the requested register state */
+bool os_supports_state(unsigned long long stateMask)
+{
+	unsigned int regs[4];
+	run_cpuid(1, 0, regs);
+	if (!(regs[2] & (1u << 27))) /* OSXSAVE */
+		return false;
+	return (run_xgetbv() & stateMask) == stateMask;
+}
+
+} // namespace
+
+bool cpu_support_sse41()
+{
+	unsigned int regs[4];
+	run_cpuid(1, 0, regs);
+	return (regs[2] & (1u << 19)) != 0; /* SSE4.1 */
+}
+
+bool cpu_support_avx2()
+{
+	unsigned int regs[4];
+	run_cpuid(0, 0, regs);
+	if (regs[0] < 7) return false;
+	run_cpuid(7, 0, regs);
+	if (!(regs[1] & (1u << 5))) /* AVX2 */
+		return false;
+	return os_supports_state(0x6); /* XMM + YMM */
+}
+
+bool cpu_support_avx512()
+{
+	unsigned int regs[4];
+	run_cpuid(0, 0, regs);
+	if (regs[0] < 7) return false;
+	run_cpuid(7, 0, regs);
+	if (!(regs[1] & (1u << 16))) /* AVX512F */
+		return false;
+	if (!(regs[1] & (1u << 30))) /* AVX512BW */
+		return false;
+	return os_supports_state(0xE6); /* XMM + YMM + ZMM + opmask */
+}
+}}
+
+#else
+
+namespace aliceVision {
+namespace system {
+
+bool cpu_support_sse41() { return false; }
+bool cpu_support_avx2() { return false; }
+bool cpu_support_avx512() { return false; }
+}}
+
+#endif
@@ -21,6 +21,24 @@ int cpu_clock_by_os();
  */
 int get_total_cpus();
 
+/**
+ * @brief Runtime check (CPUID) for SSE4.1 support.
+ * Always false on non-x86 targets.
+ */
+bool cpu_support_sse41();
+
+/**
+ * @brief Runtime check (CPUID + OS state) for AVX2 support.
+ * Always false on non-x86 targets.
+ */
+bool cpu_support_avx2();
+
+/**
+ * @brief Runtime check (CPUID + OS state) for AVX-512F/BW support.
+ * Always false on non-x86 targets.
+ */
+bool cpu_support_avx512();
+
 }
 }
 
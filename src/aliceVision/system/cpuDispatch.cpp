@@ -0,0 +1,33 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "cpuDispatch.hpp"
+
+namespace aliceVision {
+namespace system {
+
+namespace {
+
+ECpuLevel detectBestLevel()
+{
+  if(cpu_support_avx512())
+    return CPU_LEVEL_AVX512;
+  if(cpu_support_avx2())
+    return CPU_LEVEL_AVX2;
+  if(cpu_support_sse41())
+    return CPU_LEVEL_SSE4;
+  return CPU_LEVEL_SCALAR;
+}
+
+} // namespace
+
+ECpuLevel cpuBestLevel()
+{
+  static const ECpuLevel level = detectBestLevel();
+  return level;
+}
+
+}
+}
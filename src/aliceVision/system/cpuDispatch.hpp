@@ -0,0 +1,96 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/system/cpu.hpp>
+
+// Function multiversioning support.
+// On x86 GCC/Clang a kernel marked with one of the ALICEVISION_TARGET_* macros
+// may use instructions wider than the baseline build flags; the binary stays
+// runnable everywhere as long as the variant is only reached through
+// CpuDispatch. MSVC allows any intrinsic regardless of /arch, so the macros
+// expand to nothing there.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ALICEVISION_CPU_DISPATCH_X86
+#define ALICEVISION_TARGET_SSE4   __attribute__((target("sse4.1")))
+#define ALICEVISION_TARGET_AVX2   __attribute__((target("avx2,fma")))
+// F16C (half precision conversions) ships on every AVX2 capable CPU, so the
+// half precision kernels are registered at the AVX2 dispatch level
+#define ALICEVISION_TARGET_AVX2_F16C __attribute__((target("avx2,fma,f16c")))
+#define ALICEVISION_TARGET_AVX512 __attribute__((target("avx512f,avx512bw")))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define ALICEVISION_CPU_DISPATCH_X86
+#define ALICEVISION_TARGET_SSE4
+#define ALICEVISION_TARGET_AVX2
+#define ALICEVISION_TARGET_AVX2_F16C
+#define ALICEVISION_TARGET_AVX512
+#endif
+
+namespace aliceVision {
+namespace system {
+
+/// Instruction sets usable for runtime kernel dispatch, from narrowest to widest
+enum ECpuLevel
+{
+  CPU_LEVEL_SCALAR = 0,
+  CPU_LEVEL_SSE4 = 1,
+  CPU_LEVEL_AVX2 = 2,
+  CPU_LEVEL_AVX512 = 3
+};
+
+/**
+ * @brief Widest level supported by the host CPU and OS, evaluated once per process.
+ */
+ECpuLevel cpuBestLevel();
+
+/**
+ * @brief Small function-multiversioning helper: register one variant of a
+ * kernel per instruction set and resolve the widest one the host supports.
+ *
+ * Variants share the scalar signature and must be registered from narrowest
+ * to widest; unregistered levels inherit the widest variant below them.
+ * The resolved pointer is typically cached in a function-local static so the
+ * selection runs once per process:
+ * @code
+ * static const KernelT kernel = system::CpuDispatch<KernelT>(&kernelScalar)
+ *                                 .avx2(&kernelAvx2)
+ *                                 .avx512(&kernelAvx512)
+ *                                 .resolve();
+ * @endcode
+ */
+template<typename FuncT>
+class CpuDispatch
+{
+public:
+  explicit CpuDispatch(FuncT scalarVariant)
+  {
+    for(int level = CPU_LEVEL_SCALAR; level <= CPU_LEVEL_AVX512; ++level)
+      _variants[level] = scalarVariant;
+  }
+
+  CpuDispatch& sse4(FuncT variant)   { return set(CPU_LEVEL_SSE4, variant); }
+  CpuDispatch& avx2(FuncT variant)   { return set(CPU_LEVEL_AVX2, variant); }
+  CpuDispatch& avx512(FuncT variant) { return set(CPU_LEVEL_AVX512, variant); }
+
+  /// Variant matching the widest instruction set of the host
+  FuncT resolve() const
+  {
+    return _variants[cpuBestLevel()];
+  }
+
+private:
+  CpuDispatch& set(ECpuLevel level, FuncT variant)
+  {
+    for(int l = level; l <= CPU_LEVEL_AVX512; ++l)
+      _variants[l] = variant;
+    return *this;
+  }
+
+  FuncT _variants[CPU_LEVEL_AVX512 + 1];
+};
+
+}
+}
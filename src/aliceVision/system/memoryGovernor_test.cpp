@@ -0,0 +1,122 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "MemoryGovernor.hpp"
+
+#define BOOST_TEST_MODULE systemMemoryGovernor
+#include <boost/test/included/unit_test.hpp>
+
+#include <algorithm>
+
+using namespace aliceVision::system;
+
+/// Simple reclaimable client: a counter of held bytes that can give them back
+struct FakeCache
+{
+  std::size_t held = 0;
+  std::size_t nbReclaimCalls = 0;
+
+  std::size_t reclaim(std::size_t nbBytes)
+  {
+    ++nbReclaimCalls;
+    const std::size_t freed = std::min(nbBytes, held);
+    held -= freed;
+    return freed;
+  }
+};
+
+BOOST_AUTO_TEST_CASE(MEMORY_GOVERNOR_BudgetAndAccounting)
+{
+  MemoryGovernor& governor = MemoryGovernor::instance();
+  governor.setMemoryBudget(1000);
+  BOOST_CHECK_EQUAL(governor.memoryBudget(), 1000);
+
+  FakeCache cache;
+  cache.held = 300;
+  const MemoryGovernor::ClientId id = governor.registerClient("cache",
+      [&]() { return cache.held; },
+      [&](std::size_t nbBytes) { return cache.reclaim(nbBytes); });
+
+  BOOST_CHECK_EQUAL(governor.usedMemory(), 300);
+  BOOST_CHECK_EQUAL(governor.availableMemory(), 700);
+
+  governor.unregisterClient(id);
+  BOOST_CHECK_EQUAL(governor.usedMemory(), 0);
+
+  // restore the automatic budget for the other tests / users
+  governor.setMemoryBudget(0);
+  BOOST_CHECK(governor.memoryBudget() > 0);
+}
+
+BOOST_AUTO_TEST_CASE(MEMORY_GOVERNOR_RequestTriggersReclaim)
+{
+  MemoryGovernor& governor = MemoryGovernor::instance();
+  governor.setMemoryBudget(1000);
+
+  FakeCache cache;
+  cache.held = 900;
+  const MemoryGovernor::ClientId id = governor.registerClient("cache",
+      [&]() { return cache.held; },
+      [&](std::size_t nbBytes) { return cache.reclaim(nbBytes); });
+
+  // fits in the headroom: no reclaim
+  BOOST_CHECK(governor.requestMemory(100));
+  BOOST_CHECK_EQUAL(cache.nbReclaimCalls, 0);
+
+  // does not fit: the cache is asked to give back exactly the overshoot
+  BOOST_CHECK(governor.requestMemory(400));
+  BOOST_CHECK_EQUAL(cache.nbReclaimCalls, 1);
+  BOOST_CHECK_EQUAL(cache.held, 600);
+
+  // more than the cache can ever free
+  BOOST_CHECK(!governor.requestMemory(2000));
+  BOOST_CHECK_EQUAL(cache.held, 0);
+
+  governor.unregisterClient(id);
+  governor.setMemoryBudget(0);
+}
+
+BOOST_AUTO_TEST_CASE(MEMORY_GOVERNOR_RequesterIsNotAskedToReclaimItself)
+{
+  MemoryGovernor& governor = MemoryGovernor::instance();
+  governor.setMemoryBudget(1000);
+
+  FakeCache self;
+  self.held = 600;
+  FakeCache other;
+  other.held = 300;
+
+  const MemoryGovernor::ClientId selfId = governor.registerClient("self",
+      [&]() { return self.held; },
+      [&](std::size_t nbBytes) { return self.reclaim(nbBytes); });
+  const MemoryGovernor::ClientId otherId = governor.registerClient("other",
+      [&]() { return other.held; },
+      [&](std::size_t nbBytes) { return other.reclaim(nbBytes); });
+
+  // 900 held, a 300 bytes allocation only fits if 'other' gives back 200
+  BOOST_CHECK(governor.requestMemory(300, selfId));
+  BOOST_CHECK_EQUAL(self.nbReclaimCalls, 0);
+  BOOST_CHECK_EQUAL(self.held, 600);
+  BOOST_CHECK_EQUAL(other.held, 100);
+
+  governor.unregisterClient(selfId);
+  governor.unregisterClient(otherId);
+  governor.setMemoryBudget(0);
+}
+
+BOOST_AUTO_TEST_CASE(MEMORY_GOVERNOR_RecommendedBatchSize)
+{
+  MemoryGovernor& governor = MemoryGovernor::instance();
+  governor.setMemoryBudget(1000);
+
+  // 1000 bytes of headroom, 100 bytes per item
+  BOOST_CHECK_EQUAL(governor.recommendedBatchSize(100, 50), 10);
+  // capped by the caller bound
+  BOOST_CHECK_EQUAL(governor.recommendedBatchSize(100, 4), 4);
+  // always at least one item, even over budget
+  BOOST_CHECK_EQUAL(governor.recommendedBatchSize(5000, 50), 1);
+
+  governor.setMemoryBudget(0);
+}
@@ -0,0 +1,175 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "numa.hpp"
+#include "cpu.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace aliceVision {
+namespace system {
+
+namespace {
+
+struct NumaTopology
+{
+  std::vector<std::vector<int>> cpusPerNode;
+  std::vector<int> nodeOfCpu; // indexed by cpu, 0 for unknown cpus
+};
+
+#ifdef __linux__
+// Parse a sysfs cpulist, eg. "0-7,16-23", into cpu indices.
+std::vector<int> parseCpuList(const std::string& cpuList)
+{
+  std::vector<int> cpus;
+  std::istringstream stream(cpuList);
+  std::string range;
+  while(std::getline(stream, range, ','))
+  {
+    const std::size_t dash = range.find('-');
+    const int first = std::atoi(range.c_str());
+    const int last = (dash == std::string::npos) ? first : std::atoi(range.c_str() + dash + 1);
+    for(int cpu = first; cpu <= last; ++cpu)
+      cpus.push_back(cpu);
+  }
+  return cpus;
+}
+#endif
+
+NumaTopology detectTopology()
+{
+  NumaTopology topology;
+
+#ifdef __linux__
+  for(int node = 0;; ++node)
+  {
+    std::ifstream cpuListFile("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    if(!cpuListFile)
+      break;
+    std::string cpuList;
+    std::getline(cpuListFile, cpuList);
+    std::vector<int> cpus = parseCpuList(cpuList);
+    if(cpus.empty())
+      continue; // memory-only node, no CPU can run there
+    topology.cpusPerNode.push_back(cpus);
+  }
+#endif
+
+  if(topology.cpusPerNode.empty())
+  {
+    // no NUMA information: a single node owning all the CPUs
+    std::vector<int> allCpus;
+    const int nbCpus = std::max(get_total_cpus(), 1);
+    for(int cpu = 0; cpu < nbCpus; ++cpu)
+      allCpus.push_back(cpu);
+    topology.cpusPerNode.push_back(allCpus);
+  }
+
+  int maxCpu = 0;
+  for(const std::vector<int>& cpus : topology.cpusPerNode)
+    for(const int cpu : cpus)
+      maxCpu = std::max(maxCpu, cpu);
+  topology.nodeOfCpu.assign(maxCpu + 1, 0);
+  for(std::size_t node = 0; node < topology.cpusPerNode.size(); ++node)
+    for(const int cpu : topology.cpusPerNode[node])
+      topology.nodeOfCpu[cpu] = int(node);
+
+  return topology;
+}
+
+const NumaTopology& topology()
+{
+  static const NumaTopology instance = detectTopology();
+  return instance;
+}
+
+} // namespace
+
+int getNbNumaNodes()
+{
+  return int(topology().cpusPerNode.size());
+}
+
+const std::vector<int>& getNumaNodeCpus(int node)
+{
+  static const std::vector<int> empty;
+  const NumaTopology& topo = topology();
+  if(node < 0 || node >= int(topo.cpusPerNode.size()))
+    return empty;
+  return topo.cpusPerNode[node];
+}
+
+int getNumaNodeOfCpu(int cpu)
+{
+  const NumaTopology& topo = topology();
+  if(cpu < 0 || cpu >= int(topo.nodeOfCpu.size()))
+    return 0;
+  return topo.nodeOfCpu[cpu];
+}
+
+int getCurrentNumaNode()
+{
+#ifdef __linux__
+  const int cpu = sched_getcpu();
+  if(cpu >= 0)
+    return getNumaNodeOfCpu(cpu);
+#endif
+  return 0;
+}
+
+bool bindThreadToNumaNode(int node)
+{
+#ifdef __linux__
+  const std::vector<int>& cpus = getNumaNodeCpus(node);
+  if(cpus.empty())
+    return false;
+  cpu_set_t cpuSet;
+  CPU_ZERO(&cpuSet);
+  for(const int cpu : cpus)
+    CPU_SET(cpu, &cpuSet);
+  return pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) == 0;
+#else
+  (void)node;
+  return false;
+#endif
+}
+
+NumaNodeScope::NumaNodeScope(int node)
+{
+#ifdef __linux__
+  cpu_set_t previous;
+  CPU_ZERO(&previous);
+  if(pthread_getaffinity_np(pthread_self(), sizeof(previous), &previous) == 0)
+  {
+    _previousAffinity.resize(sizeof(previous));
+    std::memcpy(_previousAffinity.data(), &previous, sizeof(previous));
+  }
+#endif
+  _bound = bindThreadToNumaNode(node);
+}
+
+NumaNodeScope::~NumaNodeScope()
+{
+#ifdef __linux__
+  if(!_previousAffinity.empty())
+  {
+    cpu_set_t previous;
+    std::memcpy(&previous, _previousAffinity.data(), sizeof(previous));
+    pthread_setaffinity_np(pthread_self(), sizeof(previous), &previous);
+  }
+#endif
+}
+
+} // namespace system
+} // namespace aliceVision
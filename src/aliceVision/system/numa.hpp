@@ -0,0 +1,93 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <vector>
+
+namespace aliceVision {
+namespace system {
+
+/**
+ * @brief NUMA topology of the machine, detected once at first use.
+ *
+ * On Linux the topology is read from /sys/devices/system/node, avoiding a
+ * dependency on libnuma; on the other platforms (and on machines without NUMA
+ * information) a single node owning all the CPUs is reported, so callers can
+ * use these helpers unconditionally.
+ *
+ * Memory placement relies on the first-touch policy of the OS: memory is
+ * allocated on the node of the thread that first writes it. Binding a thread
+ * to a node before it fills a buffer (see bindThreadToNumaNode and the worker
+ * pinning of TaskScheduler) is therefore enough to get node-local storage
+ * without explicit page binding.
+ */
+
+/**
+ * @brief Number of NUMA nodes of the machine, at least 1.
+ */
+int getNbNumaNodes();
+
+/**
+ * @brief The CPUs belonging to the given NUMA node.
+ * @param[in] node The node index, in [0, getNbNumaNodes())
+ * @return the CPU indices of the node, empty if the node is out of range
+ */
+const std::vector<int>& getNumaNodeCpus(int node);
+
+/**
+ * @brief The NUMA node owning the given CPU.
+ * @param[in] cpu The CPU index
+ * @return the node index, 0 if the CPU is unknown
+ */
+int getNumaNodeOfCpu(int cpu);
+
+/**
+ * @brief The NUMA node the calling thread is currently running on.
+ * @return the node index, 0 when it cannot be determined
+ */
+int getCurrentNumaNode();
+
+/**
+ * @brief Restrict the calling thread to the CPUs of the given NUMA node.
+ *
+ * Memory first touched by the thread afterwards is allocated on that node.
+ *
+ * @param[in] node The node index
+ * @return false if the node is out of range or the platform does not support
+ * thread affinity
+ */
+bool bindThreadToNumaNode(int node);
+
+/**
+ * @brief Scoped NUMA binding of the calling thread.
+ *
+ * Binds the thread to a node for the lifetime of the object and restores the
+ * previous affinity on destruction. Typical use: bind while filling a large
+ * descriptor or regions buffer, so the first-touch policy places it on the
+ * node of the workers that will read it.
+ */
+class NumaNodeScope
+{
+public:
+  explicit NumaNodeScope(int node);
+  ~NumaNodeScope();
+
+  NumaNodeScope(const NumaNodeScope&) = delete;
+  NumaNodeScope& operator=(const NumaNodeScope&) = delete;
+
+  /// @return true if the thread is effectively bound to the requested node
+  bool isBound() const
+  {
+    return _bound;
+  }
+
+private:
+  std::vector<char> _previousAffinity; // opaque saved cpu_set_t, empty if unsupported
+  bool _bound = false;
+};
+
+} // namespace system
+} // namespace aliceVision
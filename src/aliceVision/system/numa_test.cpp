@@ -0,0 +1,72 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/system/numa.hpp>
+#include <aliceVision/system/TaskScheduler.hpp>
+
+#include <atomic>
+#include <set>
+
+#define BOOST_TEST_MODULE numa
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision::system;
+
+BOOST_AUTO_TEST_CASE(Numa_Topology)
+{
+  const int nbNodes = getNbNumaNodes();
+  BOOST_CHECK_GE(nbNodes, 1);
+
+  // every node owns at least one CPU and every CPU maps back to its node
+  std::set<int> seenCpus;
+  for(int node = 0; node < nbNodes; ++node)
+  {
+    const std::vector<int>& cpus = getNumaNodeCpus(node);
+    BOOST_CHECK(!cpus.empty());
+    for(const int cpu : cpus)
+    {
+      BOOST_CHECK_EQUAL(getNumaNodeOfCpu(cpu), node);
+      BOOST_CHECK(seenCpus.insert(cpu).second); // no cpu on two nodes
+    }
+  }
+
+  // out-of-range queries are harmless
+  BOOST_CHECK(getNumaNodeCpus(-1).empty());
+  BOOST_CHECK(getNumaNodeCpus(nbNodes).empty());
+  BOOST_CHECK_EQUAL(getNumaNodeOfCpu(-1), 0);
+
+  const int currentNode = getCurrentNumaNode();
+  BOOST_CHECK_GE(currentNode, 0);
+  BOOST_CHECK_LT(currentNode, nbNodes);
+}
+
+BOOST_AUTO_TEST_CASE(Numa_ThreadBinding)
+{
+  // binding to every existing node succeeds on platforms with affinity
+  // support; the scope restores the previous affinity on destruction
+  for(int node = 0; node < getNbNumaNodes(); ++node)
+  {
+    NumaNodeScope scope(node);
+    if(scope.isBound())
+      BOOST_CHECK_EQUAL(getCurrentNumaNode(), node);
+  }
+  BOOST_CHECK(!bindThreadToNumaNode(getNbNumaNodes()));
+}
+
+BOOST_AUTO_TEST_CASE(Numa_SchedulerPinning)
+{
+  TaskScheduler& scheduler = TaskScheduler::instance();
+  scheduler.setNumaPinning(true); // no effect on single-node machines
+
+  // node-affine tasks run to completion whatever the topology
+  std::atomic<int> counter(0);
+  std::vector<TaskScheduler::TaskId> taskIds;
+  for(int i = 0; i < 64; ++i)
+    taskIds.push_back(scheduler.addTaskOnNumaNode(i % getNbNumaNodes(), [&counter]{ ++counter; }));
+  scheduler.wait(taskIds);
+  BOOST_CHECK_EQUAL(counter, 64);
+
+  scheduler.setNumaPinning(false);
+}
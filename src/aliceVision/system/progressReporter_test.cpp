@@ -0,0 +1,69 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "aliceVision/system/ProgressReporter.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define BOOST_TEST_MODULE progressReporter
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision::system;
+
+BOOST_AUTO_TEST_CASE(ProgressReporter_concurrentCounting)
+{
+  const std::size_t nbThreads = 4;
+  const std::size_t itemsPerThread = 10000;
+
+  ProgressReporter progress(nbThreads * itemsPerThread, "concurrent counting");
+
+  std::vector<std::thread> threads;
+  for(std::size_t t = 0; t < nbThreads; ++t)
+  {
+    threads.emplace_back([&]()
+    {
+      for(std::size_t i = 0; i < itemsPerThread; ++i)
+        progress.advance(1, 10);
+    });
+  }
+  for(std::thread& thread: threads)
+    thread.join();
+
+  // no increment is lost
+  BOOST_CHECK_EQUAL(progress.done(), nbThreads * itemsPerThread);
+}
+
+BOOST_AUTO_TEST_CASE(ProgressReporter_statusFile)
+{
+  const std::string statusFilepath = "progressReporterStatus.json";
+  ProgressReporter::setStatusFilepath(statusFilepath);
+
+  {
+    ProgressReporter progress(4, "status file");
+    progress.advance(1, 100);
+    progress.advance(3, 300);
+  } // the destructor emits the final status
+
+  std::ifstream file(statusFilepath.c_str());
+  BOOST_REQUIRE(file.is_open());
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  const std::string status = buffer.str();
+
+  // complete JSON document with the final counters
+  BOOST_CHECK(status.find("\"label\": \"status file\"") != std::string::npos);
+  BOOST_CHECK(status.find("\"done\": 4") != std::string::npos);
+  BOOST_CHECK(status.find("\"total\": 4") != std::string::npos);
+  BOOST_CHECK(status.find("\"bytes\": 400") != std::string::npos);
+  BOOST_CHECK(status.find("\"finished\": true") != std::string::npos);
+
+  ProgressReporter::setStatusFilepath("");
+  std::remove(statusFilepath.c_str());
+}
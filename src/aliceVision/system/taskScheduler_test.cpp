@@ -0,0 +1,145 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "TaskScheduler.hpp"
+
+#define BOOST_TEST_MODULE systemTaskScheduler
+#include <boost/test/included/unit_test.hpp>
+
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+using namespace aliceVision::system;
+
+BOOST_AUTO_TEST_CASE(TASK_SCHEDULER_ParallelForCoversAllIterations)
+{
+  TaskScheduler& scheduler = TaskScheduler::instance();
+
+  const std::size_t nbIterations = 10000;
+  std::vector<int> visited(nbIterations, 0);
+
+  scheduler.parallelFor(0, nbIterations, [&](std::size_t i)
+  {
+    ++visited[i];
+  });
+
+  // Each iteration executed exactly once
+  BOOST_CHECK_EQUAL(std::accumulate(visited.begin(), visited.end(), 0), int(nbIterations));
+
+  // An empty range is a no-op
+  scheduler.parallelFor(5, 5, [&](std::size_t i)
+  {
+    ++visited[0];
+  });
+  BOOST_CHECK_EQUAL(visited[0], 1);
+}
+
+BOOST_AUTO_TEST_CASE(TASK_SCHEDULER_DependenciesAreOrdered)
+{
+  TaskScheduler& scheduler = TaskScheduler::instance();
+
+  // Build a diamond: a -> (b, c) -> d, repeated to exercise the stealing.
+  for(int run = 0; run < 100; ++run)
+  {
+    std::atomic<int> stage(0);
+    std::atomic<bool> orderViolated(false);
+
+    const TaskScheduler::TaskId a = scheduler.addTask([&]()
+    {
+      stage = 1;
+    });
+    const std::vector<TaskScheduler::TaskId> afterA(1, a);
+    const TaskScheduler::TaskId b = scheduler.addTask([&]()
+    {
+      if(stage < 1)
+        orderViolated = true;
+    }, afterA);
+    const TaskScheduler::TaskId c = scheduler.addTask([&]()
+    {
+      if(stage < 1)
+        orderViolated = true;
+    }, afterA);
+    std::vector<TaskScheduler::TaskId> afterBC;
+    afterBC.push_back(b);
+    afterBC.push_back(c);
+    const TaskScheduler::TaskId d = scheduler.addTask([&]()
+    {
+      stage = 2;
+    }, afterBC);
+
+    scheduler.wait(d);
+    BOOST_CHECK(!orderViolated);
+    BOOST_CHECK_EQUAL(stage.load(), 2);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TASK_SCHEDULER_ExceptionsAreRethrownToTheWaiter)
+{
+  TaskScheduler& scheduler = TaskScheduler::instance();
+
+  const TaskScheduler::TaskId failing = scheduler.addTask([]()
+  {
+    throw std::runtime_error("task failure");
+  });
+  BOOST_CHECK_THROW(scheduler.wait(failing), std::runtime_error);
+
+  BOOST_CHECK_THROW(
+    scheduler.parallelFor(0, 100, [](std::size_t i)
+    {
+      if(i == 42)
+        throw std::runtime_error("iteration failure");
+    }), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(TASK_SCHEDULER_ResizeKeepsPendingTasks)
+{
+  TaskScheduler& scheduler = TaskScheduler::instance();
+
+  scheduler.setNbThreads(2);
+  BOOST_CHECK_EQUAL(scheduler.nbThreads(), 2);
+
+  std::atomic<int> nbExecuted(0);
+  std::vector<TaskScheduler::TaskId> taskIds;
+  for(int i = 0; i < 200; ++i)
+  {
+    taskIds.push_back(scheduler.addTask([&]()
+    {
+      ++nbExecuted;
+    }));
+  }
+  scheduler.setNbThreads(4);
+  BOOST_CHECK_EQUAL(scheduler.nbThreads(), 4);
+
+  scheduler.wait(taskIds);
+  BOOST_CHECK_EQUAL(nbExecuted.load(), 200);
+
+  scheduler.setNbThreads(0); // restore the hardware default
+}
+
+BOOST_AUTO_TEST_CASE(TASK_SCHEDULER_WaitingInsideATaskIsSafe)
+{
+  TaskScheduler& scheduler = TaskScheduler::instance();
+  scheduler.setNbThreads(1); // a single worker must not deadlock on nested waits
+
+  std::atomic<int> total(0);
+  const TaskScheduler::TaskId outer = scheduler.addTask([&]()
+  {
+    const TaskScheduler::TaskId inner = scheduler.addTask([&]()
+    {
+      ++total;
+    });
+    scheduler.wait(inner);
+    scheduler.parallelFor(0, 10, [&](std::size_t)
+    {
+      ++total;
+    });
+  });
+  scheduler.wait(outer);
+  BOOST_CHECK_EQUAL(total.load(), 11);
+
+  scheduler.setNbThreads(0);
+}
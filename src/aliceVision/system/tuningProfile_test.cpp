@@ -0,0 +1,75 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/system/TuningProfile.hpp>
+
+#include <cstdio>
+#include <fstream>
+
+#define BOOST_TEST_MODULE tuningProfile
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision::system;
+
+namespace {
+
+void writeFile(const std::string& filepath, const std::string& content)
+{
+  std::ofstream file(filepath);
+  file << content;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(TuningProfile_LoadAndQuery)
+{
+  const std::string filepath = "tuningProfile_test.ini";
+  writeFile(filepath,
+            "# mixed node profile\n"
+            "[decode]\n"
+            "threads = 4\n"
+            "queueDepth = 8\n"
+            "\n"
+            "[matching]\n"
+            "threads = 56\n"
+            "memoryBudgetMb = 2\n"
+            "customKnob = 17\n");
+
+  TuningProfile& profile = TuningProfile::instance();
+  BOOST_CHECK(profile.load(filepath));
+  BOOST_CHECK(profile.isLoaded());
+
+  BOOST_CHECK(profile.hasStage("decode"));
+  BOOST_CHECK(profile.hasStage("matching"));
+  BOOST_CHECK(!profile.hasStage("describe"));
+
+  BOOST_CHECK_EQUAL(profile.nbThreads("decode", 1), 4);
+  BOOST_CHECK_EQUAL(profile.queueDepth("decode", 1), 8);
+  BOOST_CHECK_EQUAL(profile.nbThreads("matching", 1), 56);
+  BOOST_CHECK_EQUAL(profile.memoryBudgetBytes("matching", 0), std::size_t(2) * 1024 * 1024);
+  BOOST_CHECK_EQUAL(profile.value("matching", "customKnob", 0), 17);
+
+  // absent stages and keys fall back to the given default
+  BOOST_CHECK_EQUAL(profile.nbThreads("describe", 12), 12);
+  BOOST_CHECK_EQUAL(profile.value("decode", "unknown", 3), 3);
+  BOOST_CHECK_EQUAL(profile.memoryBudgetBytes("decode", 42), 42);
+
+  std::remove(filepath.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(TuningProfile_ParseErrors)
+{
+  const std::string filepath = "tuningProfile_badtest.ini";
+
+  writeFile(filepath, "threads = 4\n"); // key outside of any section
+  BOOST_CHECK(!TuningProfile::instance().load(filepath));
+
+  writeFile(filepath, "[decode\nthreads = 4\n"); // unterminated section
+  BOOST_CHECK(!TuningProfile::instance().load(filepath));
+
+  BOOST_CHECK(!TuningProfile::instance().load("does_not_exist.ini"));
+
+  std::remove(filepath.c_str());
+}
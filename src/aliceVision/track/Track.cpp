@@ -41,25 +41,7 @@ bool TracksBuilder::Build( const PairwiseMatches &  pairwiseMatches)
     }
   }
 
-  // Build the node indirection for each referenced feature
-  MapIndexToNode map_indexToNode;
-  map_indexToNode.reserve(allFeatures.size());
-  _map_nodeToIndex.reserve(allFeatures.size());
-
-  for (const IndexedFeaturePair& featPair: allFeatures)
-  {
-    lemon::ListDigraph::Node node = _graph.addNode();
-    map_indexToNode.insert(std::make_pair(featPair, node));
-    _map_nodeToIndex.insert(std::make_pair(node, featPair));
-  }
-
-  // Add the element of myset to the UnionFind insert method.
-  _index = std::unique_ptr<IndexMap>( new IndexMap(_graph) );
-  _tracksUF = std::unique_ptr<UnionFindObject>( new UnionFindObject(*_index));
-  for(ListDigraph::NodeIt it(_graph); it != INVALID; ++it)
-  {
-    _tracksUF->insert(it);
-  }
+  MapIndexToNode map_indexToNode = createUnionFind(allFeatures);
 
   // Make the union according the pair matches
   for(const auto& matchesPerDescIt: pairwiseMatches)
@@ -84,6 +66,65 @@ bool TracksBuilder::Build( const PairwiseMatches &  pairwiseMatches)
   return false;
 }
 
+/// Build tracks from the compact structure-of-arrays match storage
+bool TracksBuilder::Build(const CompactPairwiseMatches& pairwiseMatches)
+{
+  const std::vector<CompactPairwiseMatches::MatchRange>& ranges = pairwiseMatches.getRanges();
+  const std::vector<std::uint32_t>& left = pairwiseMatches.getLeftFeatures();
+  const std::vector<std::uint32_t>& right = pairwiseMatches.getRightFeatures();
+
+  typedef std::set<IndexedFeaturePair> SetIndexedPair;
+  // Set of all features of all images: (imageIndex, featureIndex)
+  SetIndexedPair allFeatures;
+
+  for(const CompactPairwiseMatches::MatchRange& range: ranges)
+  {
+    for(std::size_t k = range.begin; k < range.begin + range.size; ++k)
+    {
+      allFeatures.insert(IndexedFeaturePair(range.imagePair.first, KeypointId(range.descType, left[k])));
+      allFeatures.insert(IndexedFeaturePair(range.imagePair.second, KeypointId(range.descType, right[k])));
+    }
+  }
+
+  const MapIndexToNode map_indexToNode = createUnionFind(allFeatures);
+
+  // Make the union according the pair matches
+  for(const CompactPairwiseMatches::MatchRange& range: ranges)
+  {
+    for(std::size_t k = range.begin; k < range.begin + range.size; ++k)
+    {
+      const IndexedFeaturePair pairI(range.imagePair.first, KeypointId(range.descType, left[k]));
+      const IndexedFeaturePair pairJ(range.imagePair.second, KeypointId(range.descType, right[k]));
+      _tracksUF->join(map_indexToNode.at(pairI), map_indexToNode.at(pairJ));
+    }
+  }
+  return false;
+}
+
+TracksBuilder::MapIndexToNode TracksBuilder::createUnionFind(const std::set<IndexedFeaturePair>& allFeatures)
+{
+  // Build the node indirection for each referenced feature
+  MapIndexToNode map_indexToNode;
+  map_indexToNode.reserve(allFeatures.size());
+  _map_nodeToIndex.reserve(allFeatures.size());
+
+  for (const IndexedFeaturePair& featPair: allFeatures)
+  {
+    lemon::ListDigraph::Node node = _graph.addNode();
+    map_indexToNode.insert(std::make_pair(featPair, node));
+    _map_nodeToIndex.insert(std::make_pair(node, featPair));
+  }
+
+  // Add the element of myset to the UnionFind insert method.
+  _index = std::unique_ptr<IndexMap>( new IndexMap(_graph) );
+  _tracksUF = std::unique_ptr<UnionFindObject>( new UnionFindObject(*_index));
+  for(ListDigraph::NodeIt it(_graph); it != INVALID; ++it)
+  {
+    _tracksUF->insert(it);
+  }
+  return map_indexToNode;
+}
+
 bool TracksBuilder::Filter(size_t nLengthSupTo, bool bMultithread)
 {
   // Remove bad tracks:
@@ -136,22 +177,290 @@ bool TracksBuilder::ExportToStream(std::ostream & os)
 void TracksBuilder::ExportToSTL(TracksMap & allTracks) const
 {
   allTracks.clear();
+  allTracks.reserve(NbTracks());
+
+  // counting pre-pass: the length of every track, so that each observation
+  // flat map and the scratch batch are allocated exactly once below
+  std::vector<std::size_t> trackLengths;
+  trackLengths.reserve(NbTracks());
+  std::size_t maxTrackLength = 0;
+  for(lemon::UnionFindEnum< IndexMap >::ClassIt cit(*_tracksUF); cit != INVALID; ++cit)
+  {
+    std::size_t length = 0;
+    for(lemon::UnionFindEnum< IndexMap >::ItemIt iit(*_tracksUF, cit); iit != INVALID; ++iit)
+      ++length;
+    trackLengths.push_back(length);
+    maxTrackLength = std::max(maxTrackLength, length);
+  }
+
+  // (viewId, featureId) batch of the current track, reused across tracks
+  std::vector<std::pair<std::size_t, std::size_t> > trackFeatures;
+  trackFeatures.reserve(maxTrackLength);
 
   size_t trackIndex = 0;
   for(lemon::UnionFindEnum< IndexMap >::ClassIt cit(*_tracksUF); cit != INVALID; ++cit, ++trackIndex)
   {
-    // Create the output track
-    std::pair<TracksMap::iterator, bool> ret = allTracks.insert(std::make_pair(trackIndex, Track()));
-
-    Track& outTrack = ret.first->second;
+    // Create the output track; the indexes are strictly increasing,
+    // so this is an append at the end of the flat map
+    Track& outTrack = allTracks.emplace_hint(allTracks.end(), trackIndex, Track())->second;
+    outTrack.featPerView.reserve(trackLengths[trackIndex]);
 
+    trackFeatures.clear();
     for(lemon::UnionFindEnum< IndexMap >::ItemIt iit(*_tracksUF, cit); iit != INVALID; ++iit)
     {
       const IndexedFeaturePair & currentPair = _map_nodeToIndex.at(iit);
       // all descType inside the track will be the same
       outTrack.descType = currentPair.second.descType;
-      outTrack.featPerView[currentPair.first] = currentPair.second.featIndex;
+      trackFeatures.emplace_back(currentPair.first, currentPair.second.featIndex);
+    }
+    // one sort and one merge instead of one shifting insertion per feature
+    stl::flat_map_bulk_insert(outTrack.featPerView, trackFeatures);
+  }
+}
+
+namespace {
+
+/// Union-find root lookup with path halving
+inline std::uint32_t findRoot(std::vector<std::uint32_t>& parent, std::uint32_t i)
+{
+  while(parent[i] != i)
+  {
+    parent[i] = parent[parent[i]];
+    i = parent[i];
+  }
+  return i;
+}
+
+} // namespace
+
+bool FlatTracksBuilder::Build(const PairwiseMatches& pairwiseMatches)
+{
+  // Set of all features of all images: (imageIndex, featureIndex),
+  // gathered in a flat vector and deduplicated by sorting
+  _features.clear();
+  {
+    std::size_t nbMatches = 0;
+    for(const auto& matchesPerDescIt: pairwiseMatches)
+      for(const auto& matchesIt: matchesPerDescIt.second)
+        nbMatches += matchesIt.second.size();
+    _features.reserve(2 * nbMatches);
+  }
+
+  for(const auto& matchesPerDescIt: pairwiseMatches)
+  {
+    const std::size_t I = matchesPerDescIt.first.first;
+    const std::size_t J = matchesPerDescIt.first.second;
+
+    for(const auto& matchesIt: matchesPerDescIt.second)
+    {
+      const feature::EImageDescriberType descType = matchesIt.first;
+      for(const IndMatch& m: matchesIt.second)
+      {
+        _features.emplace_back(I, KeypointId(descType, m._i));
+        _features.emplace_back(J, KeypointId(descType, m._j));
+      }
+    }
+  }
+  std::sort(_features.begin(), _features.end());
+  _features.erase(std::unique(_features.begin(), _features.end()), _features.end());
+  _features.shrink_to_fit();
+
+  // The union-find index of a feature is its position in the sorted vector
+  const auto indexOf = [this](const IndexedFeaturePair& featPair) -> std::uint32_t
+  {
+    return std::lower_bound(_features.begin(), _features.end(), featPair) - _features.begin();
+  };
+
+  _parent.resize(_features.size());
+  for(std::uint32_t i = 0; i < _parent.size(); ++i)
+    _parent[i] = i;
+  std::vector<std::uint32_t> treeSize(_features.size(), 1);
+
+  // Make the union according the pair matches
+  for(const auto& matchesPerDescIt: pairwiseMatches)
+  {
+    const std::size_t I = matchesPerDescIt.first.first;
+    const std::size_t J = matchesPerDescIt.first.second;
+
+    for(const auto& matchesIt: matchesPerDescIt.second)
+    {
+      const feature::EImageDescriberType descType = matchesIt.first;
+      for(const IndMatch& m: matchesIt.second)
+      {
+        std::uint32_t rootI = findRoot(_parent, indexOf(IndexedFeaturePair(I, KeypointId(descType, m._i))));
+        std::uint32_t rootJ = findRoot(_parent, indexOf(IndexedFeaturePair(J, KeypointId(descType, m._j))));
+        if(rootI == rootJ)
+          continue;
+        // Union by size: attach the smaller tree below the bigger one
+        if(treeSize[rootI] < treeSize[rootJ])
+          std::swap(rootI, rootJ);
+        _parent[rootJ] = rootI;
+        treeSize[rootI] += treeSize[rootJ];
+      }
+    }
+  }
+
+  buildTrackRuns(treeSize);
+  return false;
+}
+
+/// Build tracks from the compact structure-of-arrays match storage
+bool FlatTracksBuilder::Build(const CompactPairwiseMatches& pairwiseMatches)
+{
+  const std::vector<CompactPairwiseMatches::MatchRange>& ranges = pairwiseMatches.getRanges();
+  const std::vector<std::uint32_t>& left = pairwiseMatches.getLeftFeatures();
+  const std::vector<std::uint32_t>& right = pairwiseMatches.getRightFeatures();
+
+  // Set of all features of all images: (imageIndex, featureIndex),
+  // gathered in a flat vector and deduplicated by sorting
+  _features.clear();
+  _features.reserve(2 * pairwiseMatches.getNbAllMatches());
+
+  for(const CompactPairwiseMatches::MatchRange& range: ranges)
+  {
+    for(std::size_t k = range.begin; k < range.begin + range.size; ++k)
+    {
+      _features.emplace_back(range.imagePair.first, KeypointId(range.descType, left[k]));
+      _features.emplace_back(range.imagePair.second, KeypointId(range.descType, right[k]));
+    }
+  }
+  std::sort(_features.begin(), _features.end());
+  _features.erase(std::unique(_features.begin(), _features.end()), _features.end());
+  _features.shrink_to_fit();
+
+  // The union-find index of a feature is its position in the sorted vector
+  const auto indexOf = [this](const IndexedFeaturePair& featPair) -> std::uint32_t
+  {
+    return std::lower_bound(_features.begin(), _features.end(), featPair) - _features.begin();
+  };
+
+  _parent.resize(_features.size());
+  for(std::uint32_t i = 0; i < _parent.size(); ++i)
+    _parent[i] = i;
+  std::vector<std::uint32_t> treeSize(_features.size(), 1);
+
+  // Make the union according the pair matches
+  for(const CompactPairwiseMatches::MatchRange& range: ranges)
+  {
+    for(std::size_t k = range.begin; k < range.begin + range.size; ++k)
+    {
+      std::uint32_t rootI = findRoot(_parent, indexOf(IndexedFeaturePair(range.imagePair.first, KeypointId(range.descType, left[k]))));
+      std::uint32_t rootJ = findRoot(_parent, indexOf(IndexedFeaturePair(range.imagePair.second, KeypointId(range.descType, right[k]))));
+      if(rootI == rootJ)
+        continue;
+      // Union by size: attach the smaller tree below the bigger one
+      if(treeSize[rootI] < treeSize[rootJ])
+        std::swap(rootI, rootJ);
+      _parent[rootJ] = rootI;
+      treeSize[rootI] += treeSize[rootJ];
+    }
+  }
+
+  buildTrackRuns(treeSize);
+  return false;
+}
+
+void FlatTracksBuilder::buildTrackRuns(std::vector<std::uint32_t>& scratch)
+{
+  // Fully compress the forest: _parent[i] becomes the root of i
+  for(std::uint32_t i = 0; i < _parent.size(); ++i)
+    _parent[i] = findRoot(_parent, i);
+
+  // Order the features by track with a counting sort on the root index,
+  // so each track is one contiguous run of _orderedFeatures
+  std::vector<std::uint32_t>& cursor = scratch; // recycle the allocation
+  std::fill(cursor.begin(), cursor.end(), 0);
+  for(const std::uint32_t root: _parent)
+    ++cursor[root];
+  std::uint32_t sum = 0;
+  for(std::uint32_t& c: cursor)
+  {
+    const std::uint32_t count = c;
+    c = sum;
+    sum += count;
+  }
+  _orderedFeatures.resize(_features.size());
+  for(std::uint32_t i = 0; i < _parent.size(); ++i)
+    _orderedFeatures[cursor[_parent[i]]++] = i;
+
+  _trackStarts.clear();
+  for(std::uint32_t k = 0; k < _orderedFeatures.size(); ++k)
+  {
+    if(k == 0 || _parent[_orderedFeatures[k]] != _parent[_orderedFeatures[k - 1]])
+      _trackStarts.push_back(k);
+  }
+  _trackStarts.push_back(_orderedFeatures.size());
+
+  _erased.assign(_trackStarts.empty() ? 0 : _trackStarts.size() - 1, 0);
+}
+
+bool FlatTracksBuilder::Filter(std::size_t nLengthSupTo, bool bMultithread)
+{
+  // Remove bad tracks:
+  // - track that are too short,
+  // - track with id conflicts (many times the same image index)
+
+  const int nbTracks = static_cast<int>(_erased.size());
+
+  #pragma omp parallel for if(bMultithread)
+  for(int t = 0; t < nbTracks; ++t)
+  {
+    std::vector<std::size_t> viewIds;
+    viewIds.reserve(_trackStarts[t + 1] - _trackStarts[t]);
+    for(std::uint32_t k = _trackStarts[t]; k < _trackStarts[t + 1]; ++k)
+      viewIds.push_back(_features[_orderedFeatures[k]].first);
+    std::sort(viewIds.begin(), viewIds.end());
+    const std::size_t nbDistinctViews = std::unique(viewIds.begin(), viewIds.end()) - viewIds.begin();
+    if(nbDistinctViews != viewIds.size() || nbDistinctViews < nLengthSupTo)
+      _erased[t] = 1;
+  }
+  return false;
+}
+
+std::size_t FlatTracksBuilder::NbTracks() const
+{
+  return std::count(_erased.begin(), _erased.end(), char(0));
+}
+
+void FlatTracksBuilder::ExportToSTL(TracksMap& allTracks) const
+{
+  allTracks.clear();
+  allTracks.reserve(NbTracks());
+
+  // (viewId, featureId) batch of the current track, reused across tracks;
+  // the runs are already ordered by view id so the batch sort is one pass.
+  // The run bounds give the exact track lengths, size the batch once.
+  std::size_t maxTrackLength = 0;
+  for(std::size_t t = 0; t < _erased.size(); ++t)
+  {
+    if(!_erased[t])
+      maxTrackLength = std::max<std::size_t>(maxTrackLength, _trackStarts[t + 1] - _trackStarts[t]);
+  }
+  std::vector<std::pair<std::size_t, std::size_t> > trackFeatures;
+  trackFeatures.reserve(maxTrackLength);
+
+  std::size_t trackIndex = 0;
+  for(std::size_t t = 0; t < _erased.size(); ++t)
+  {
+    if(_erased[t])
+      continue;
+
+    // Create the output track; the indexes are strictly increasing,
+    // so this is an append at the end of the flat map
+    Track& outTrack = allTracks.emplace_hint(allTracks.end(), trackIndex, Track())->second;
+    outTrack.featPerView.reserve(_trackStarts[t + 1] - _trackStarts[t]);
+    ++trackIndex;
+
+    trackFeatures.clear();
+    // The run is ordered by feature index, hence by ascending view id
+    for(std::uint32_t k = _trackStarts[t]; k < _trackStarts[t + 1]; ++k)
+    {
+      const IndexedFeaturePair& currentPair = _features[_orderedFeatures[k]];
+      // all descType inside the track will be the same
+      outTrack.descType = currentPair.second.descType;
+      trackFeatures.emplace_back(currentPair.first, currentPair.second.featIndex);
     }
+    stl::flat_map_bulk_insert(outTrack.featPerView, trackFeatures);
   }
 }
 
@@ -293,15 +602,28 @@ void TracksUtilsMap::GetTracksInImagesFast(
   
 void TracksUtilsMap::computeTracksPerView(const TracksMap & map_tracks, TracksPerView& map_tracksPerView)
 {
+  // counting pre-pass: number of tracks observed by each view, so that the
+  // per-view lists and the outer map are allocated exactly once
+  stl::flat_map<std::size_t, std::size_t> nbTracksPerView;
   for (const auto& track: map_tracks)
   {
     for (const auto& feat: track.second.featPerView)
-    {
-      TrackIdSet& tracksSet = map_tracksPerView[feat.first];
-      if(tracksSet.empty())
-        tracksSet.reserve(1000);
-      tracksSet.push_back(track.first);
-    }
+      ++nbTracksPerView[feat.first];
+  }
+
+  // the counting map iterates in ascending view id order, so each entry is
+  // an append at the end of the output flat map
+  map_tracksPerView.reserve(map_tracksPerView.size() + nbTracksPerView.size());
+  for (const auto& viewCount: nbTracksPerView)
+  {
+    TrackIdSet& tracksSet = map_tracksPerView[viewCount.first];
+    tracksSet.reserve(tracksSet.size() + viewCount.second);
+  }
+
+  for (const auto& track: map_tracks)
+  {
+    for (const auto& feat: track.second.featPerView)
+      map_tracksPerView[feat.first].push_back(track.first);
   }
   // sort tracks Ids in each view
 
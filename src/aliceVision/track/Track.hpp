@@ -7,6 +7,7 @@
 
 #include <aliceVision/config.hpp>
 #include <aliceVision/feature/imageDescriberCommon.hpp>
+#include <aliceVision/matching/CompactPairwiseMatches.hpp>
 #include <aliceVision/matching/IndMatch.hpp>
 #include <aliceVision/stl/FlatMap.hpp>
 #include <aliceVision/stl/FlatSet.hpp>
@@ -16,6 +17,7 @@
 #include <lemon/unionfind.h>
 
 #include <algorithm>
+#include <cstdint>
 #include <iostream>
 #include <functional>
 #include <vector>
@@ -74,6 +76,78 @@ typedef stl::flat_map<std::size_t, stl::flat_map<std::size_t, std::size_t> > Tra
  */
 typedef stl::flat_map<std::size_t, TrackIdSet > TracksPerView;
 
+/**
+ * @brief Bitset over dense track ids.
+ *
+ * The track ids exported by the track builders are dense, so a whole set of
+ * tracks (e.g. the reconstructed ones) fits in one bit per track. Intersecting
+ * the sorted per-view track lists against it is a O(1) membership test per
+ * track instead of a sorted-range intersection with a node-based set, and the
+ * set can be updated incrementally as the reconstruction grows.
+ */
+class TrackIdBitset
+{
+public:
+  /// Reset the set to empty, with capacity for nbTrackIds dense ids
+  void reset(std::size_t nbTrackIds)
+  {
+    _bits.assign((nbTrackIds + 63) / 64, 0);
+  }
+
+  void insert(std::size_t trackId)
+  {
+    const std::size_t word = trackId >> 6;
+    if(word >= _bits.size())
+      _bits.resize(word + 1, 0);
+    _bits[word] |= std::uint64_t(1) << (trackId & 63);
+  }
+
+  void erase(std::size_t trackId)
+  {
+    const std::size_t word = trackId >> 6;
+    if(word < _bits.size())
+      _bits[word] &= ~(std::uint64_t(1) << (trackId & 63));
+  }
+
+  bool count(std::size_t trackId) const
+  {
+    const std::size_t word = trackId >> 6;
+    return word < _bits.size() && ((_bits[word] >> (trackId & 63)) & 1);
+  }
+
+  /// Keep the tracks of the sorted list that belong to the set
+  void intersect(const TrackIdSet& tracks, std::vector<std::size_t>& out_commonTracks) const
+  {
+    out_commonTracks.clear();
+    out_commonTracks.reserve(tracks.size());
+    for(const std::size_t trackId: tracks)
+    {
+      if(count(trackId))
+        out_commonTracks.push_back(trackId);
+    }
+  }
+
+  /// Collect the ids present in this set but not in the other one
+  void difference(const TrackIdBitset& other, std::vector<std::size_t>& out_onlyInThis) const
+  {
+    out_onlyInThis.clear();
+    for(std::size_t word = 0; word < _bits.size(); ++word)
+    {
+      std::uint64_t onlyInThis = _bits[word];
+      if(word < other._bits.size())
+        onlyInThis &= ~other._bits[word];
+      for(std::size_t bit = 0; onlyInThis != 0; ++bit, onlyInThis >>= 1)
+      {
+        if(onlyInThis & 1)
+          out_onlyInThis.push_back((word << 6) + bit);
+      }
+    }
+  }
+
+private:
+  std::vector<std::uint64_t> _bits;
+};
+
 /**
  * @brief KeypointId is a unique ID for a feature in a view.
  */
@@ -92,6 +166,11 @@ struct KeypointId
     return descType < other.descType;
   }
 
+  bool operator==(const KeypointId& other) const
+  {
+    return descType == other.descType && featIndex == other.featIndex;
+  }
+
   feature::EImageDescriberType descType = feature::EImageDescriberType::UNINITIALIZED;
   std::size_t featIndex = 0;
 };
@@ -151,6 +230,9 @@ struct TracksBuilder
   /// Build tracks for a given series of pairWise matches
   bool Build(const PairwiseMatches&  pairwiseMatches);
 
+  /// Same, from the compact structure-of-arrays match storage
+  bool Build(const CompactPairwiseMatches& pairwiseMatches);
+
   /// Remove bad tracks (too short or track with ids collision)
   bool Filter(size_t nLengthSupTo = 2, bool bMultithread = true);
 
@@ -170,6 +252,62 @@ struct TracksBuilder
    *        {TrackIndex => {(imageIndex, keypointId), ... ,(imageIndex, keypointId)}
    */
   void ExportToSTL(TracksMap & allTracks) const;
+
+private:
+  /// Create one graph node per referenced feature and fill the union-find,
+  /// shared by the two Build overloads
+  MapIndexToNode createUnionFind(const std::set<IndexedFeaturePair>& allFeatures);
+};
+
+/**
+ * @brief Cache-friendly variant of TracksBuilder.
+ *
+ * Implements the same fusion algorithm [1] but with an index-based union-find
+ * (path compression + union by size) stored in flat arrays, instead of a lemon
+ * graph allocating one node per feature occurrence. The memory footprint is a
+ * few words per referenced feature, which makes the track fusion of very large
+ * match sets tractable.
+ */
+struct FlatTracksBuilder
+{
+  /// IndexedFeaturePair is: pair<viewId, keypointId>
+  typedef TracksBuilder::IndexedFeaturePair IndexedFeaturePair;
+
+  /// Build tracks for a given series of pairWise matches
+  bool Build(const PairwiseMatches& pairwiseMatches);
+
+  /// Same, from the compact structure-of-arrays match storage
+  bool Build(const CompactPairwiseMatches& pairwiseMatches);
+
+  /// Remove bad tracks (too short or track with ids collision)
+  bool Filter(std::size_t nLengthSupTo = 2, bool bMultithread = true);
+
+  /// Return the number of tracks (after the Filter removals)
+  std::size_t NbTracks() const;
+
+  /**
+   * @brief Export tracks as a map (each entry is a sequence of imageId and keypointId):
+   *        {TrackIndex => {(imageIndex, keypointId), ... ,(imageIndex, keypointId)}
+   */
+  void ExportToSTL(TracksMap& allTracks) const;
+
+private:
+  /// Compress the forest and order the features by track (the contiguous
+  /// runs of _orderedFeatures), shared by the two Build overloads.
+  /// scratch is a feature-sized buffer recycled as the counting sort cursors.
+  void buildTrackRuns(std::vector<std::uint32_t>& scratch);
+
+  /// All the referenced features, sorted: the position of a feature in this
+  /// vector is its union-find index
+  std::vector<IndexedFeaturePair> _features;
+  /// Union-find parent of each feature, fully compressed at the end of Build
+  std::vector<std::uint32_t> _parent;
+  /// Feature indices ordered by their union-find root: one contiguous run per track
+  std::vector<std::uint32_t> _orderedFeatures;
+  /// Start of each track run in _orderedFeatures, terminated by _features.size()
+  std::vector<std::uint32_t> _trackStarts;
+  /// One flag per track run, raised by Filter
+  std::vector<char> _erased;
 };
 
 struct TracksUtilsMap
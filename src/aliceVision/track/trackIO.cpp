@@ -0,0 +1,222 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "trackIO.hpp"
+
+#include <algorithm>
+#include <fstream>
+
+namespace aliceVision {
+namespace track {
+
+namespace {
+
+// Binary track cache file:
+// - header  : magic "ALVTRCKS", version byte, matches hash (uint64)
+// - tracks  : nbTracks (uint64), then per track
+//             trackId (uint64), descType (int32), nbObservations (uint64),
+//             (viewId, featureIndex) pairs (uint64 each)
+// - perView : nbViews (uint64), then per view
+//             viewId (uint64), nbTracks (uint64), trackIds (uint64 each)
+// - pyramid : nbViews (uint64), then per view
+//             viewId (uint64), nbCells (uint64), (key, cellId) pairs (uint64 each)
+// The maps are written in key order, so loading can append at the end of the
+// flat containers without re-sorting.
+
+const char TRACK_CACHE_MAGIC[8] = {'A','L','V','T','R','C','K','S'};
+const unsigned char TRACK_CACHE_VERSION = 1;
+
+template<typename T>
+inline void writePod(std::ostream& stream, const T& value)
+{
+  stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+inline bool readPod(std::istream& stream, T& value)
+{
+  stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+  return bool(stream);
+}
+
+} // namespace
+
+std::uint64_t hashPairwiseMatches(const matching::PairwiseMatches& matches, std::uint64_t seed)
+{
+  std::uint64_t hash = seed;
+  for(const auto& pairMatches: matches)
+  {
+    hash = hashCombine(hash, pairMatches.first.first);
+    hash = hashCombine(hash, pairMatches.first.second);
+    for(const auto& descMatches: pairMatches.second)
+    {
+      hash = hashCombine(hash, static_cast<std::uint64_t>(descMatches.first));
+      hash = hashCombine(hash, descMatches.second.size());
+      for(const matching::IndMatch& match: descMatches.second)
+      {
+        hash = hashCombine(hash, match._i);
+        hash = hashCombine(hash, match._j);
+      }
+    }
+  }
+  return hash;
+}
+
+bool saveTracksCache(const std::string& filename,
+                     std::uint64_t matchesHash,
+                     const TracksMap& tracks,
+                     const TracksPerView& tracksPerView,
+                     const TracksPyramidPerView& tracksPyramidPerView)
+{
+  std::ofstream stream(filename.c_str(), std::ios::out | std::ios::binary);
+  if(!stream.is_open())
+    return false;
+
+  stream.write(TRACK_CACHE_MAGIC, sizeof(TRACK_CACHE_MAGIC));
+  writePod(stream, TRACK_CACHE_VERSION);
+  writePod(stream, matchesHash);
+
+  writePod(stream, std::uint64_t(tracks.size()));
+  for(const auto& trackIt: tracks)
+  {
+    writePod(stream, std::uint64_t(trackIt.first));
+    writePod(stream, std::int32_t(trackIt.second.descType));
+    writePod(stream, std::uint64_t(trackIt.second.featPerView.size()));
+    for(const auto& obsIt: trackIt.second.featPerView)
+    {
+      writePod(stream, std::uint64_t(obsIt.first));
+      writePod(stream, std::uint64_t(obsIt.second));
+    }
+  }
+
+  writePod(stream, std::uint64_t(tracksPerView.size()));
+  for(const auto& viewIt: tracksPerView)
+  {
+    writePod(stream, std::uint64_t(viewIt.first));
+    writePod(stream, std::uint64_t(viewIt.second.size()));
+    for(const std::size_t trackId: viewIt.second)
+      writePod(stream, std::uint64_t(trackId));
+  }
+
+  writePod(stream, std::uint64_t(tracksPyramidPerView.size()));
+  for(const auto& viewIt: tracksPyramidPerView)
+  {
+    writePod(stream, std::uint64_t(viewIt.first));
+    writePod(stream, std::uint64_t(viewIt.second.size()));
+    for(const auto& cellIt: viewIt.second)
+    {
+      writePod(stream, std::uint64_t(cellIt.first));
+      writePod(stream, std::uint64_t(cellIt.second));
+    }
+  }
+
+  return bool(stream);
+}
+
+bool loadTracksCache(const std::string& filename,
+                     std::uint64_t matchesHash,
+                     TracksMap& tracks,
+                     TracksPerView& tracksPerView,
+                     TracksPyramidPerView& tracksPyramidPerView)
+{
+  tracks.clear();
+  tracksPerView.clear();
+  tracksPyramidPerView.clear();
+
+  std::ifstream stream(filename.c_str(), std::ios::in | std::ios::binary);
+  if(!stream.is_open())
+    return false;
+
+  char magic[sizeof(TRACK_CACHE_MAGIC)];
+  stream.read(magic, sizeof(magic));
+  if(!stream || !std::equal(magic, magic + sizeof(magic), TRACK_CACHE_MAGIC))
+    return false;
+
+  unsigned char version = 0;
+  std::uint64_t storedHash = 0;
+  if(!readPod(stream, version) || version != TRACK_CACHE_VERSION)
+    return false;
+  if(!readPod(stream, storedHash) || storedHash != matchesHash)
+    return false;
+
+  const auto clearOutputs = [&tracks, &tracksPerView, &tracksPyramidPerView]()
+  {
+    tracks.clear();
+    tracksPerView.clear();
+    tracksPyramidPerView.clear();
+    return false;
+  };
+
+  std::uint64_t nbTracks = 0;
+  if(!readPod(stream, nbTracks))
+    return false;
+  tracks.reserve(nbTracks);
+  for(std::uint64_t i = 0; i < nbTracks; ++i)
+  {
+    std::uint64_t trackId = 0, nbObservations = 0;
+    std::int32_t descType = 0;
+    if(!readPod(stream, trackId) || !readPod(stream, descType) || !readPod(stream, nbObservations))
+      return clearOutputs();
+    Track& track = tracks.insert(tracks.end(),
+        std::make_pair(std::size_t(trackId), Track()))->second;
+    track.descType = feature::EImageDescriberType(descType);
+    track.featPerView.reserve(nbObservations);
+    for(std::uint64_t obs = 0; obs < nbObservations; ++obs)
+    {
+      std::uint64_t viewId = 0, featureIndex = 0;
+      if(!readPod(stream, viewId) || !readPod(stream, featureIndex))
+        return clearOutputs();
+      track.featPerView.insert(track.featPerView.end(),
+          std::make_pair(std::size_t(viewId), std::size_t(featureIndex)));
+    }
+  }
+
+  std::uint64_t nbViews = 0;
+  if(!readPod(stream, nbViews))
+    return clearOutputs();
+  tracksPerView.reserve(nbViews);
+  for(std::uint64_t i = 0; i < nbViews; ++i)
+  {
+    std::uint64_t viewId = 0, nbViewTracks = 0;
+    if(!readPod(stream, viewId) || !readPod(stream, nbViewTracks))
+      return clearOutputs();
+    TrackIdSet& viewTracks = tracksPerView.insert(tracksPerView.end(),
+        std::make_pair(std::size_t(viewId), TrackIdSet()))->second;
+    viewTracks.resize(nbViewTracks);
+    for(std::uint64_t t = 0; t < nbViewTracks; ++t)
+    {
+      std::uint64_t trackId = 0;
+      if(!readPod(stream, trackId))
+        return clearOutputs();
+      viewTracks[t] = std::size_t(trackId);
+    }
+  }
+
+  std::uint64_t nbPyramidViews = 0;
+  if(!readPod(stream, nbPyramidViews))
+    return clearOutputs();
+  tracksPyramidPerView.reserve(nbPyramidViews);
+  for(std::uint64_t i = 0; i < nbPyramidViews; ++i)
+  {
+    std::uint64_t viewId = 0, nbCells = 0;
+    if(!readPod(stream, viewId) || !readPod(stream, nbCells))
+      return clearOutputs();
+    auto& viewPyramid = tracksPyramidPerView.insert(tracksPyramidPerView.end(),
+        std::make_pair(std::size_t(viewId), TracksPyramidPerView::mapped_type()))->second;
+    viewPyramid.reserve(nbCells);
+    for(std::uint64_t c = 0; c < nbCells; ++c)
+    {
+      std::uint64_t key = 0, cellId = 0;
+      if(!readPod(stream, key) || !readPod(stream, cellId))
+        return clearOutputs();
+      viewPyramid.insert(viewPyramid.end(), std::make_pair(std::size_t(key), std::size_t(cellId)));
+    }
+  }
+
+  return true;
+}
+
+} // namespace track
+} // namespace aliceVision
@@ -0,0 +1,78 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/track/Track.hpp>
+#include <aliceVision/matching/IndMatch.hpp>
+
+#include <cstdint>
+#include <string>
+
+namespace aliceVision {
+namespace track {
+
+/// Fold one value into a 64 bits FNV-1a style hash
+inline std::uint64_t hashCombine(std::uint64_t hash, std::uint64_t value)
+{
+  hash ^= value;
+  hash *= 1099511628211ULL; // FNV prime
+  return hash;
+}
+
+/**
+ * @brief Hash the content of the pairwise matches.
+ *
+ * The hash keys the track cache: two runs fed with the same matches (and the
+ * same fusion parameters, folded in with hashCombine) produce the same key and
+ * can share the fused tracks.
+ *
+ * @param[in] matches: the pairwise matches to hash
+ * @param[in] seed: initial hash value (FNV-1a offset basis by default)
+ * @return a 64 bits hash of the matches content
+ */
+std::uint64_t hashPairwiseMatches(const matching::PairwiseMatches& matches,
+                                  std::uint64_t seed = 14695981039346656037ULL);
+
+/**
+ * @brief Save the fused tracks to a versioned binary cache file.
+ *
+ * The cache stores the tracks, the per-view track lists and the per-view
+ * pyramid cell assignments, together with the hash of the matches they were
+ * fused from, so a later run can validate the cache before reloading it.
+ *
+ * @param[in] filename: path of the cache file to write
+ * @param[in] matchesHash: hash of the matches (and fusion parameters) the tracks were built from
+ * @param[in] tracks: the fused tracks
+ * @param[in] tracksPerView: the list of visible tracks of each view
+ * @param[in] tracksPyramidPerView: the pyramid cell assignments of each view
+ * @return false if the file cannot be written
+ */
+bool saveTracksCache(const std::string& filename,
+                     std::uint64_t matchesHash,
+                     const TracksMap& tracks,
+                     const TracksPerView& tracksPerView,
+                     const TracksPyramidPerView& tracksPyramidPerView);
+
+/**
+ * @brief Reload the fused tracks from a binary cache file.
+ *
+ * @param[in] filename: path of the cache file to read
+ * @param[in] matchesHash: expected hash of the matches (and fusion parameters)
+ * @param[out] tracks: the fused tracks
+ * @param[out] tracksPerView: the list of visible tracks of each view
+ * @param[out] tracksPyramidPerView: the pyramid cell assignments of each view
+ * @return false if the cache is missing, corrupted, from another format
+ *         version or built from different matches; the outputs are left empty
+ *         and the tracks must be rebuilt.
+ */
+bool loadTracksCache(const std::string& filename,
+                     std::uint64_t matchesHash,
+                     TracksMap& tracks,
+                     TracksPerView& tracksPerView,
+                     TracksPyramidPerView& tracksPyramidPerView);
+
+} // namespace track
+} // namespace aliceVision
@@ -0,0 +1,143 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "aliceVision/track/trackIO.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#define BOOST_TEST_MODULE trackIO
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::track;
+
+namespace {
+
+void buildTestTracks(TracksMap& tracks,
+                     TracksPerView& tracksPerView,
+                     TracksPyramidPerView& tracksPyramidPerView)
+{
+  Track track0;
+  track0.descType = feature::EImageDescriberType::SIFT;
+  track0.featPerView[0] = 5;
+  track0.featPerView[1] = 7;
+  track0.featPerView[2] = 1;
+
+  Track track1;
+  track1.descType = feature::EImageDescriberType::AKAZE;
+  track1.featPerView[0] = 2;
+  track1.featPerView[2] = 8;
+
+  tracks[0] = track0;
+  tracks[4] = track1;
+
+  tracksPerView[0] = {0, 4};
+  tracksPerView[1] = {0};
+  tracksPerView[2] = {0, 4};
+
+  tracksPyramidPerView[0][0 * 2 + 0] = 1;
+  tracksPyramidPerView[0][0 * 2 + 1] = 6;
+  tracksPyramidPerView[0][4 * 2 + 0] = 2;
+  tracksPyramidPerView[0][4 * 2 + 1] = 9;
+  tracksPyramidPerView[2][0 * 2 + 0] = 3;
+  tracksPyramidPerView[2][0 * 2 + 1] = 4;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(TrackIO_CacheRoundTrip)
+{
+  TracksMap tracks;
+  TracksPerView tracksPerView;
+  TracksPyramidPerView tracksPyramidPerView;
+  buildTestTracks(tracks, tracksPerView, tracksPyramidPerView);
+
+  const std::string filename = "trackCache_roundTrip.bin";
+  const std::uint64_t matchesHash = hashCombine(14695981039346656037ULL, 42);
+
+  BOOST_CHECK(saveTracksCache(filename, matchesHash, tracks, tracksPerView, tracksPyramidPerView));
+
+  TracksMap loadedTracks;
+  TracksPerView loadedTracksPerView;
+  TracksPyramidPerView loadedTracksPyramidPerView;
+  BOOST_CHECK(loadTracksCache(filename, matchesHash,
+                              loadedTracks, loadedTracksPerView, loadedTracksPyramidPerView));
+
+  BOOST_CHECK_EQUAL(tracks.size(), loadedTracks.size());
+  for(const auto& trackIt: tracks)
+  {
+    const Track& loaded = loadedTracks.at(trackIt.first);
+    BOOST_CHECK(trackIt.second.descType == loaded.descType);
+    BOOST_CHECK(trackIt.second.featPerView == loaded.featPerView);
+  }
+  BOOST_CHECK(tracksPerView == loadedTracksPerView);
+  BOOST_CHECK(tracksPyramidPerView == loadedTracksPyramidPerView);
+
+  std::remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(TrackIO_CacheRejectsStaleAndCorrupt)
+{
+  TracksMap tracks;
+  TracksPerView tracksPerView;
+  TracksPyramidPerView tracksPyramidPerView;
+  buildTestTracks(tracks, tracksPerView, tracksPyramidPerView);
+
+  const std::string filename = "trackCache_stale.bin";
+  const std::uint64_t matchesHash = hashCombine(14695981039346656037ULL, 42);
+
+  BOOST_CHECK(saveTracksCache(filename, matchesHash, tracks, tracksPerView, tracksPyramidPerView));
+
+  // a different matches hash must invalidate the cache
+  TracksMap loadedTracks;
+  TracksPerView loadedTracksPerView;
+  TracksPyramidPerView loadedTracksPyramidPerView;
+  BOOST_CHECK(!loadTracksCache(filename, matchesHash + 1,
+                               loadedTracks, loadedTracksPerView, loadedTracksPyramidPerView));
+  BOOST_CHECK(loadedTracks.empty());
+
+  // a truncated file must be rejected and leave the outputs empty
+  {
+    std::ifstream input(filename.c_str(), std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    input.close();
+    std::ofstream output(filename.c_str(), std::ios::binary | std::ios::trunc);
+    output.write(content.data(), content.size() / 2);
+  }
+  BOOST_CHECK(!loadTracksCache(filename, matchesHash,
+                               loadedTracks, loadedTracksPerView, loadedTracksPyramidPerView));
+  BOOST_CHECK(loadedTracks.empty());
+  BOOST_CHECK(loadedTracksPerView.empty());
+  BOOST_CHECK(loadedTracksPyramidPerView.empty());
+
+  // a missing file is not an error, just a cache miss
+  std::remove(filename.c_str());
+  BOOST_CHECK(!loadTracksCache(filename, matchesHash,
+                               loadedTracks, loadedTracksPerView, loadedTracksPyramidPerView));
+}
+
+BOOST_AUTO_TEST_CASE(TrackIO_MatchesHashIsContentSensitive)
+{
+  matching::PairwiseMatches matches;
+  matches[Pair(0, 1)][feature::EImageDescriberType::SIFT].emplace_back(1, 2);
+  matches[Pair(0, 1)][feature::EImageDescriberType::SIFT].emplace_back(3, 4);
+  matches[Pair(1, 2)][feature::EImageDescriberType::SIFT].emplace_back(5, 6);
+
+  const std::uint64_t reference = hashPairwiseMatches(matches);
+
+  // same content hashes to the same key
+  BOOST_CHECK_EQUAL(reference, hashPairwiseMatches(matches));
+
+  // any content change produces another key
+  matches[Pair(1, 2)][feature::EImageDescriberType::SIFT].back()._j = 7;
+  BOOST_CHECK(reference != hashPairwiseMatches(matches));
+
+  matches[Pair(1, 2)][feature::EImageDescriberType::SIFT].back()._j = 6;
+  BOOST_CHECK_EQUAL(reference, hashPairwiseMatches(matches));
+  matches[Pair(2, 3)][feature::EImageDescriberType::SIFT].emplace_back(8, 9);
+  BOOST_CHECK(reference != hashPairwiseMatches(matches));
+}
@@ -176,6 +176,178 @@ BOOST_AUTO_TEST_CASE(Track_Conflict) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(Track_FlatBuilder_MatchesLegacyBuilder) {
+
+  // Same data as Track_Conflict: the flat union-find builder must produce
+  // the same tracks as the lemon-based one, before and after filtering.
+
+  // Create the input pairwise correspondences
+  PairwiseMatches map_pairwisematches;
+
+  const IndMatch testAB[] = {IndMatch(0,0), IndMatch(1,1), IndMatch(2,3)};
+  const IndMatch testBC[] = {IndMatch(0,0), IndMatch(1,6), IndMatch(3,2), IndMatch(3,8)};
+
+  std::vector<IndMatch> ab(testAB, testAB+3);
+  std::vector<IndMatch> bc(testBC, testBC+4);
+  const int A = 0;
+  const int B = 1;
+  const int C = 2;
+  map_pairwisematches[ std::make_pair(A,B) ][EImageDescriberType::UNKNOWN] = ab;
+  map_pairwisematches[ std::make_pair(B,C) ][EImageDescriberType::UNKNOWN] = bc;
+
+  FlatTracksBuilder flatTrackBuilder;
+  flatTrackBuilder.Build( map_pairwisematches );
+  BOOST_CHECK_EQUAL(3, flatTrackBuilder.NbTracks());
+  flatTrackBuilder.Filter(); // kill the conflicted track
+  BOOST_CHECK_EQUAL(2, flatTrackBuilder.NbTracks());
+
+  TracksBuilder trackBuilder;
+  trackBuilder.Build( map_pairwisematches );
+  trackBuilder.Filter();
+
+  TracksMap map_tracks, map_flatTracks;
+  trackBuilder.ExportToSTL(map_tracks);
+  flatTrackBuilder.ExportToSTL(map_flatTracks);
+
+  BOOST_CHECK_EQUAL(map_tracks.size(), map_flatTracks.size());
+
+  // The track ids are dense in both builders but the enumeration order is an
+  // implementation detail: compare the tracks content regardless of their id.
+  typedef std::map<std::size_t, std::size_t> TrackContent;
+  std::set<TrackContent> tracksContent, flatTracksContent;
+  for (const auto& track: map_tracks)
+    tracksContent.insert(TrackContent(track.second.featPerView.begin(), track.second.featPerView.end()));
+  for (const auto& track: map_flatTracks)
+    flatTracksContent.insert(TrackContent(track.second.featPerView.begin(), track.second.featPerView.end()));
+  BOOST_CHECK(tracksContent == flatTracksContent);
+}
+
+BOOST_AUTO_TEST_CASE(Track_CompactMatches_MatchesMapForm) {
+
+  // Building from the compact structure-of-arrays storage must produce
+  // exactly the same tracks as building from the map form.
+
+  // Create the input pairwise correspondences
+  PairwiseMatches map_pairwisematches;
+
+  const IndMatch testAB[] = {IndMatch(0,0), IndMatch(1,1), IndMatch(2,3)};
+  const IndMatch testBC[] = {IndMatch(0,0), IndMatch(1,6), IndMatch(3,2), IndMatch(3,8)};
+
+  std::vector<IndMatch> ab(testAB, testAB+3);
+  std::vector<IndMatch> bc(testBC, testBC+4);
+  const int A = 0;
+  const int B = 1;
+  const int C = 2;
+  map_pairwisematches[ std::make_pair(A,B) ][EImageDescriberType::UNKNOWN] = ab;
+  map_pairwisematches[ std::make_pair(B,C) ][EImageDescriberType::UNKNOWN] = bc;
+
+  const CompactPairwiseMatches compactMatches(map_pairwisematches);
+
+  // tracks content regardless of the track ids, as in the test above
+  typedef std::map<std::size_t, std::size_t> TrackContent;
+  const auto contentOf = [](const TracksMap& tracks)
+  {
+    std::set<TrackContent> content;
+    for (const auto& track: tracks)
+      content.insert(TrackContent(track.second.featPerView.begin(), track.second.featPerView.end()));
+    return content;
+  };
+
+  // same checks for both builders: map form and compact form are equivalent
+  {
+    TracksBuilder trackBuilder, compactTrackBuilder;
+    trackBuilder.Build( map_pairwisematches );
+    compactTrackBuilder.Build( compactMatches );
+    trackBuilder.Filter();
+    compactTrackBuilder.Filter();
+
+    TracksMap map_tracks, map_compactTracks;
+    trackBuilder.ExportToSTL(map_tracks);
+    compactTrackBuilder.ExportToSTL(map_compactTracks);
+    BOOST_CHECK_EQUAL(map_tracks.size(), map_compactTracks.size());
+    BOOST_CHECK(contentOf(map_tracks) == contentOf(map_compactTracks));
+  }
+  {
+    FlatTracksBuilder flatTrackBuilder, compactTrackBuilder;
+    flatTrackBuilder.Build( map_pairwisematches );
+    compactTrackBuilder.Build( compactMatches );
+    flatTrackBuilder.Filter();
+    compactTrackBuilder.Filter();
+
+    TracksMap map_tracks, map_compactTracks;
+    flatTrackBuilder.ExportToSTL(map_tracks);
+    compactTrackBuilder.ExportToSTL(map_compactTracks);
+    BOOST_CHECK_EQUAL(map_tracks.size(), map_compactTracks.size());
+    BOOST_CHECK(contentOf(map_tracks) == contentOf(map_compactTracks));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Track_TrackIdBitset_Intersection) {
+
+  // The bitset intersection must behave like std::set_intersection
+  // over the sorted per-view track lists.
+  TrackIdBitset reconstructedTracks;
+  reconstructedTracks.reset(200);
+  const std::size_t reconstructed[] = {0, 3, 63, 64, 65, 127, 128, 199};
+  for (const std::size_t trackId: reconstructed)
+    reconstructedTracks.insert(trackId);
+
+  BOOST_CHECK(reconstructedTracks.count(64));
+  BOOST_CHECK(!reconstructedTracks.count(66));
+  BOOST_CHECK(!reconstructedTracks.count(4000)); // out of capacity
+
+  const TrackIdSet viewTracks = {1, 3, 64, 66, 127, 150, 199};
+  std::vector<std::size_t> common;
+  reconstructedTracks.intersect(viewTracks, common);
+
+  std::vector<std::size_t> expected;
+  std::set_intersection(viewTracks.begin(), viewTracks.end(),
+                        reconstructed, reconstructed + 8,
+                        std::back_inserter(expected));
+  BOOST_CHECK(common == expected);
+
+  // incremental updates
+  reconstructedTracks.erase(3);
+  reconstructedTracks.insert(66);
+  reconstructedTracks.intersect(viewTracks, common);
+  BOOST_CHECK_EQUAL(4, common.size());
+  BOOST_CHECK(!reconstructedTracks.count(3));
+  BOOST_CHECK(reconstructedTracks.count(66));
+}
+
+BOOST_AUTO_TEST_CASE(Track_TrackIdBitset_Difference) {
+
+  // The set difference in both directions must enumerate the tracks
+  // added and removed between two snapshots of the reconstruction.
+  TrackIdBitset previousTracks;
+  previousTracks.reset(200);
+  for (const std::size_t trackId: {3, 64, 127, 199})
+    previousTracks.insert(trackId);
+
+  TrackIdBitset currentTracks = previousTracks;
+  currentTracks.erase(64);
+  currentTracks.insert(0);
+  currentTracks.insert(128);
+
+  std::vector<std::size_t> addedTracks;
+  currentTracks.difference(previousTracks, addedTracks);
+  const std::vector<std::size_t> expectedAdded = {0, 128};
+  BOOST_CHECK(addedTracks == expectedAdded);
+
+  std::vector<std::size_t> removedTracks;
+  previousTracks.difference(currentTracks, removedTracks);
+  const std::vector<std::size_t> expectedRemoved = {64};
+  BOOST_CHECK(removedTracks == expectedRemoved);
+
+  // identical sets produce an empty delta, even with different capacities
+  TrackIdBitset emptyTracks;
+  emptyTracks.reset(0);
+  previousTracks.difference(previousTracks, removedTracks);
+  BOOST_CHECK(removedTracks.empty());
+  emptyTracks.difference(previousTracks, removedTracks);
+  BOOST_CHECK(removedTracks.empty());
+}
+
 BOOST_AUTO_TEST_CASE(Track_GetCommonTracksInImages)
 {
   {
@@ -0,0 +1,64 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "aliceVision/track/Track.hpp"
+#include "aliceVision/matching/IndMatch.hpp"
+
+#include <benchmark/benchmark.h>
+
+using namespace aliceVision;
+using namespace aliceVision::track;
+using namespace aliceVision::matching;
+
+/// Sequential capture style match graph: each view is matched with its
+/// 3 following views, features matched index to index so tracks chain up.
+static PairwiseMatches syntheticMatches(std::size_t nbViews, std::size_t nbMatchesPerPair)
+{
+  PairwiseMatches pairwiseMatches;
+  for(std::size_t i = 0; i < nbViews; ++i)
+  {
+    for(std::size_t gap = 1; gap <= 3; ++gap)
+    {
+      const std::size_t j = i + gap;
+      if(j >= nbViews)
+        continue;
+      IndMatches& matches = pairwiseMatches[Pair(i, j)][feature::EImageDescriberType::SIFT];
+      matches.reserve(nbMatchesPerPair);
+      for(std::size_t m = 0; m < nbMatchesPerPair; ++m)
+        matches.emplace_back(m, m);
+    }
+  }
+  return pairwiseMatches;
+}
+
+static void BM_TracksBuilder_Build(benchmark::State& state)
+{
+  const PairwiseMatches pairwiseMatches = syntheticMatches(state.range(0), 2000);
+
+  for(auto _ : state)
+  {
+    TracksBuilder tracksBuilder;
+    tracksBuilder.Build(pairwiseMatches);
+    tracksBuilder.Filter(3);
+    benchmark::DoNotOptimize(tracksBuilder.NbTracks());
+  }
+}
+BENCHMARK(BM_TracksBuilder_Build)->Arg(30)->Arg(100)->Unit(benchmark::kMillisecond);
+
+static void BM_FlatTracksBuilder_Build(benchmark::State& state)
+{
+  const PairwiseMatches pairwiseMatches = syntheticMatches(state.range(0), 2000);
+
+  for(auto _ : state)
+  {
+    FlatTracksBuilder tracksBuilder;
+    tracksBuilder.Build(pairwiseMatches);
+    tracksBuilder.Filter(3);
+    benchmark::DoNotOptimize(tracksBuilder.NbTracks());
+  }
+}
+BENCHMARK(BM_FlatTracksBuilder_Build)->Arg(30)->Arg(100)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
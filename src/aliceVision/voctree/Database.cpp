@@ -7,15 +7,88 @@
 #include <boost/accumulators/accumulators.hpp>
 #include <boost/accumulators/statistics/tail.hpp>
 #include <boost/progress.hpp>
+#include <algorithm>
 #include <cmath>
 #include <fstream>
+#include <functional>
 #include <stdexcept>
 #include <boost/format.hpp>
 
 namespace aliceVision{
 namespace voctree{
 
-std::ostream& operator<<(std::ostream& os, const SparseHistogram &dv)	
+namespace {
+
+// LEB128-style varint: 7 bits per byte, high bit marks continuation.
+
+void encodeVarint(uint32_t value, std::vector<uint8_t>& out)
+{
+  while(value >= 0x80)
+  {
+    out.push_back(static_cast<uint8_t>(value) | 0x80);
+    value >>= 7;
+  }
+  out.push_back(static_cast<uint8_t>(value));
+}
+
+uint32_t decodeVarint(const uint8_t*& pos)
+{
+  uint32_t value = 0;
+  unsigned shift = 0;
+  while(*pos & 0x80)
+  {
+    value |= static_cast<uint32_t>(*pos++ & 0x7f) << shift;
+    shift += 7;
+  }
+  value |= static_cast<uint32_t>(*pos++) << shift;
+  return value;
+}
+
+// Zigzag keeps deltas of unsorted input encodable; sorted input stays small.
+
+uint32_t zigzagEncode(int32_t value)
+{
+  return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+int32_t zigzagDecode(uint32_t value)
+{
+  return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+}
+
+} //namespace
+
+void CompressedIdCountList::append(uint32_t id, uint32_t count)
+{
+  encodeVarint(zigzagEncode(static_cast<int32_t>(id - last_id_)), data_);
+  encodeVarint(count, data_);
+  last_id_ = id;
+  ++entries_;
+}
+
+CompressedIdCountList::Cursor::Cursor(const CompressedIdCountList& list)
+: pos_(list.data_.data()),
+end_(list.data_.data() + list.data_.size()),
+id_(0),
+count_(0),
+valid_(false)
+{
+  next();
+}
+
+void CompressedIdCountList::Cursor::next()
+{
+  if(pos_ == end_)
+  {
+    valid_ = false;
+    return;
+  }
+  id_ += static_cast<uint32_t>(zigzagDecode(decodeVarint(pos_)));
+  count_ = decodeVarint(pos_);
+  valid_ = true;
+}
+
+std::ostream& operator<<(std::ostream& os, const SparseHistogram &dv)
 {
 	for( const auto &e : dv )
 	{
@@ -27,22 +100,20 @@ std::ostream& operator<<(std::ostream& os, const SparseHistogram &dv)
 
 Database::Database(uint32_t num_words)
 : word_files_(num_words),
-word_weights_( num_words, 1.0f ) { }
+word_weights_( num_words, 1.0f ),
+weights_corpus_size_(0),
+default_weight_(1.0f) { }
 
 DocId Database::insert(DocId doc_id, const SparseHistogram& document)
 {
   // Ensure that the new document to insert is not already there.
   assert(database_.find(doc_id) == database_.end());
 
-  // For each word, retrieve its inverted file and increment the count for doc_id.
+  // For each word, append the count for doc_id to its inverted file.
+  // Each word appears at most once per document, so no merging is needed.
   for(SparseHistogram::const_iterator it = document.begin(), end = document.end(); it != end; ++it)
   {
-    Word word = it->first;
-    InvertedFile& file = word_files_[word];
-    if(file.empty() || file.back().id != doc_id)
-      file.push_back(WordFrequency(doc_id, it->second.size()));
-    else
-      file.back().count += it->second.size();
+    word_files_[it->first].append(doc_id, it->second.size());
   }
 
   database_[doc_id] = document;
@@ -50,6 +121,26 @@ DocId Database::insert(DocId doc_id, const SparseHistogram& document)
   return doc_id;
 }
 
+DocId Database::insertAndUpdateWeights(DocId doc_id, const SparseHistogram& document, float drift_threshold)
+{
+  insert(doc_id, document);
+
+  const float N = (float) this->size();
+
+  // Exact update for the words of the new document, the only ones whose
+  // document frequency changed.
+  for(const auto& word: document)
+    word_weights_[word.first] = std::log(N / word_files_[word.first].entries());
+
+  // All other weights still carry the corpus size of the last full
+  // recomputation; their common error is the drift of the log(N) term.
+  if(weights_corpus_size_ == 0 ||
+     std::log(N / weights_corpus_size_) > drift_threshold)
+    computeTfIdfWeights(default_weight_);
+
+  return doc_id;
+}
+
 void Database::sanityCheck(size_t N, std::map<size_t, DocMatches>& matches) const
 {
   // if N is equal to zero
@@ -116,18 +207,137 @@ void Database::find( const SparseHistogram& query, size_t N, std::vector<DocMatc
   /// @todo Try only computing distances against documents sharing at least one word
   for(const auto& document: database_)
   {
-    // for each document/image in the database compute the distance between the 
+    // for each document/image in the database compute the distance between the
     // histograms of the query image and the others
     float distance = sparseDistance(query, document.second, distanceMethod, word_weights_);
     acc(DocMatch(document.first, distance));
   }
 
+  if(!compact_database_.empty())
+  {
+    WordCountList queryCounts;
+    queryCounts.reserve(query.size());
+    for(const auto& word: query)
+      queryCounts.push_back(std::make_pair(word.first, word.second.size()));
+
+    // Compacted documents are decoded on the fly into a reused scratch buffer.
+    WordCountList documentCounts;
+    for(const auto& document: compact_database_)
+    {
+      documentCounts.clear();
+      for(CompressedIdCountList::Cursor cursor = document.second.cursor(); cursor.valid(); cursor.next())
+        documentCounts.push_back(std::make_pair(static_cast<Word>(cursor.id()), static_cast<std::size_t>(cursor.count())));
+
+      float distance = sparseDistance(queryCounts, documentCounts, distanceMethod, word_weights_);
+      acc(DocMatch(document.first, distance));
+    }
+  }
+
   // extract the best N
   boost::accumulators::extractor<bestN_tag> bestN;
-  matches.resize(std::min(N, database_.size()));
+  matches.resize(std::min(N, this->size()));
   std::copy(bestN(acc).begin(), bestN(acc).end(), matches.begin());
 }
 
+void Database::findApproximate(const SparseHistogram& query, size_t N, std::vector<DocMatch>& matches, const std::string &distanceMethod) const
+{
+  // "classic" accumulates over the non-shared words as well, so it cannot be
+  // driven by the inverted files of the query words alone.
+  if(distanceMethod.compare("classic") == 0)
+  {
+    find(query, N, matches, distanceMethod);
+    return;
+  }
+
+  const bool commonPoints = (distanceMethod.compare("commonPoints") == 0);
+  const bool strongCommonPoints = (distanceMethod.compare("strongCommonPoints") == 0);
+  const bool weightedStrongCommonPoints = (distanceMethod.compare("weightedStrongCommonPoints") == 0);
+  const bool inversedWeightedCommonPoints = (distanceMethod.compare("inversedWeightedCommonPoints") == 0);
+  if(!commonPoints && !strongCommonPoints && !weightedStrongCommonPoints && !inversedWeightedCommonPoints)
+    throw std::invalid_argument("distance method "+ distanceMethod +" unknown!");
+
+  // One entry per query word: word, count in the query and the upper bound of
+  // the score contribution of any single document for that word.
+  struct QueryWord
+  {
+    Word word;
+    std::size_t count;
+    double bound;
+  };
+
+  std::vector<QueryWord> queryWords;
+  queryWords.reserve(query.size());
+  for(const auto& word: query)
+  {
+    QueryWord q;
+    q.word = word.first;
+    q.count = word.second.size();
+    if(commonPoints)
+      q.bound = q.count;
+    else if(strongCommonPoints)
+      q.bound = (q.count == 1) ? 1.0 : 0.0;
+    else if(weightedStrongCommonPoints)
+      q.bound = (q.count == 1) ? word_weights_[q.word] : 0.0;
+    else // inversedWeightedCommonPoints
+      q.bound = word_weights_[q.word];
+    queryWords.push_back(q);
+  }
+
+  // Impact order: the words able to contribute the most come first, so the
+  // early-exit threshold rises as fast as possible.
+  std::sort(queryWords.begin(), queryWords.end(),
+            [](const QueryWord& a, const QueryWord& b) { return a.bound > b.bound; });
+
+  // remaining[i]: what an unseen document could still score from word i on.
+  std::vector<double> remaining(queryWords.size() + 1, 0.0);
+  for(std::ptrdiff_t i = queryWords.size() - 1; i >= 0; --i)
+    remaining[i] = remaining[i + 1] + queryWords[i].bound;
+
+  std::map<DocId, double> scores;
+  std::vector<double> scratch;
+
+  for(std::size_t i = 0; i < queryWords.size(); ++i)
+  {
+    const QueryWord& q = queryWords[i];
+    for(CompressedIdCountList::Cursor cursor = word_files_[q.word].cursor(); cursor.valid(); cursor.next())
+    {
+      const std::size_t docCount = cursor.count();
+      double contribution = 0.0;
+      if(commonPoints)
+        contribution = std::min(q.count, docCount);
+      else if(strongCommonPoints)
+        contribution = (q.count == 1 && docCount == 1) ? 1.0 : 0.0;
+      else if(weightedStrongCommonPoints)
+        contribution = (q.count == 1 && docCount == 1) ? word_weights_[q.word] : 0.0;
+      else // inversedWeightedCommonPoints
+        contribution = (1.0 / std::min(q.count, docCount)) * word_weights_[q.word];
+
+      if(contribution != 0.0)
+        scores[cursor.id()] += contribution;
+    }
+
+    // Stop once no unseen document can reach the current top N anymore.
+    if(N != 0 && scores.size() >= N && remaining[i + 1] > 0.0)
+    {
+      scratch.clear();
+      for(const auto& score: scores)
+        scratch.push_back(score.second);
+      std::nth_element(scratch.begin(), scratch.begin() + (N - 1), scratch.end(), std::greater<double>());
+      if(scratch[N - 1] >= remaining[i + 1])
+        break;
+    }
+  }
+
+  // Distances are negated scores, like the commonPoints family of find().
+  matches.clear();
+  matches.reserve(scores.size());
+  for(const auto& score: scores)
+    matches.push_back(DocMatch(score.first, -score.second));
+  const std::size_t n = std::min(N, matches.size());
+  std::partial_sort(matches.begin(), matches.begin() + n, matches.end());
+  matches.resize(n);
+}
+
 /**
  * @brief Compute the TF-IDF weights of all the words. To be called after inserting a corpus of
  * training examples into the database.
@@ -136,11 +346,13 @@ void Database::find( const SparseHistogram& query, size_t N, std::vector<DocMatc
  */
 void Database::computeTfIdfWeights(float default_weight)
 {
-  float N = (float) database_.size();
+  float N = (float) this->size();
   size_t num_words = word_files_.size();
+  weights_corpus_size_ = this->size();
+  default_weight_ = default_weight;
   for(size_t i = 0; i < num_words; ++i)
   {
-    size_t Ni = word_files_[i].size();
+    size_t Ni = word_files_[i].entries();
     if(Ni != 0)
       word_weights_[i] = std::log(N / Ni);
     else
@@ -148,6 +360,26 @@ void Database::computeTfIdfWeights(float default_weight)
   }
 }
 
+/**
+ * @brief Re-encode the inserted documents into the compressed word-count
+ * form and drop the per-document histograms.
+ */
+void Database::compact()
+{
+  for(const auto& document: database_)
+  {
+    CompressedIdCountList& compressed = compact_database_[document.first];
+    for(const auto& word: document.second)
+      compressed.append(word.first, word.second.size());
+    compressed.shrink();
+  }
+  database_.clear();
+
+  // Release the growth slack of the inverted files as well.
+  for(InvertedFile& file: word_files_)
+    file.shrink();
+}
+
 void Database::saveWeights(const std::string& file) const
 {
   std::ofstream out(file.c_str(), std::ios_base::binary);
@@ -197,7 +429,7 @@ void Database::loadWeights(const std::string& file)
  */
 size_t Database::size() const
 {
-  return database_.size();
+  return database_.size() + compact_database_.size();
 }
 
 } //namespace voctree
@@ -63,6 +63,85 @@ struct DocMatch
 
 typedef std::vector<DocMatch> DocMatches;
 
+/**
+ * @brief Compressed list of (id, count) pairs.
+ *
+ * Ids are delta-encoded against the previously appended id (zigzag, so any
+ * insertion order stays valid, but sorted input compresses best) and both
+ * fields are stored as varints. A sorted posting list costs 2-3 bytes per
+ * entry instead of the 8 bytes of an uncompressed (id, count) pair, without
+ * counting the vector bookkeeping. Decoding is forward-only through a Cursor.
+ */
+class CompressedIdCountList
+{
+public:
+  CompressedIdCountList() : last_id_(0), entries_(0) { }
+
+  /// Append an entry; ids should be non-decreasing for best compression.
+  void append(uint32_t id, uint32_t count);
+
+  /// Number of (id, count) entries in the list.
+  std::size_t entries() const
+  {
+    return entries_;
+  }
+
+  /// Release the growth slack of the underlying buffer.
+  void shrink()
+  {
+    data_.shrink_to_fit();
+  }
+
+  /// Forward iterator decoding the list entry by entry.
+  class Cursor
+  {
+  public:
+    explicit Cursor(const CompressedIdCountList& list);
+
+    bool valid() const
+    {
+      return valid_;
+    }
+
+    uint32_t id() const
+    {
+      return id_;
+    }
+
+    uint32_t count() const
+    {
+      return count_;
+    }
+
+    /// Decode the next entry; invalidates the cursor at the end of the list.
+    void next();
+
+  private:
+    const uint8_t* pos_;
+    const uint8_t* end_;
+    uint32_t id_;
+    uint32_t count_;
+    bool valid_;
+  };
+
+  Cursor cursor() const
+  {
+    return Cursor(*this);
+  }
+
+  // Cereal serialize method
+  template<class Archive>
+  void serialize(Archive& archive)
+  {
+    archive(data_, last_id_, entries_);
+  }
+
+private:
+  std::vector<uint8_t> data_;
+  uint32_t last_id_;
+  std::size_t entries_;
+};
+
 /**
  * @brief Class for efficiently matching a bag-of-words representation of a document (image) against
  * a database of known documents.
@@ -87,6 +166,25 @@ public:
    */
   DocId insert(DocId doc_id, const SparseHistogram& document);
 
+  /**
+   * @brief Insert a new document into a live index and incrementally adjust
+   * the TF-IDF weights.
+   *
+   * The weights of the words present in the new document are recomputed
+   * exactly. All other weights keep the corpus size of the last full
+   * computeTfIdfWeights() call, an approximation whose error is the shared
+   * log(N / N0) term; once that drift exceeds \p drift_threshold the full
+   * recomputation is run again. This turns the nightly full re-index of a
+   * growing database into cheap per-document updates.
+   *
+   * @param doc_id Unique ID of the new document to insert
+   * @param document The set of quantized words in a document/image.
+   * @param drift_threshold Tolerated drift of the stale weights before a full
+   *        recomputation; 0 recomputes on every insertion.
+   * @return An ID representing the inserted document.
+   */
+  DocId insertAndUpdateWeights(DocId doc_id, const SparseHistogram& document, float drift_threshold = 0.1f);
+
   /**
    * @brief Perform a sanity check of the database by querying each document
    * of the database and finding its top N matches
@@ -116,6 +214,30 @@ public:
    */
   void find(const SparseHistogram& query, std::size_t N, std::vector<DocMatch>& matches, const std::string &distanceMethod = "strongCommonPoints") const;
 
+  /**
+   * @brief Approximate top-N retrieval driven by the inverted files.
+   *
+   * Instead of scoring every document, the query words are processed in
+   * decreasing order of their maximum possible score contribution and their
+   * inverted files accumulate scores document-at-a-time; once the N-th best
+   * score can no longer be beaten by the remaining words the scan stops
+   * early (WAND-style upper-bound pruning). Results are as if the query were
+   * truncated to its highest-impact words: every processed word contributes
+   * exactly its find() score, the pruned low-impact tail contributes nothing.
+   * Documents sharing no processed word are never visited, so fewer than N
+   * matches can be returned and border-line orderings can differ. Cost scales
+   * with the posting lists touched rather than the corpus size.
+   *
+   * Not available for the "classic" distance, which accumulates over
+   * non-shared words; it falls back to the exhaustive find().
+   *
+   * @param[in] query The query document, a set of quantized words.
+   * @param[in] N        The number of matches to return.
+   * @param[out] matches IDs and scores for the top N matching database documents.
+   * @param[in] distanceMethod distance method (norm L1, etc.)
+   */
+  void findApproximate(const SparseHistogram& query, std::size_t N, std::vector<DocMatch>& matches, const std::string &distanceMethod = "strongCommonPoints") const;
+
   /**
    * @brief Compute the TF-IDF weights of all the words. To be called after inserting a corpus of
    * training examples into the database.
@@ -124,6 +246,18 @@ public:
    */
   void computeTfIdfWeights(float default_weight = 1.0f);
 
+  /**
+   * @brief Re-encode the inserted documents into the compressed word-count
+   * form and drop the per-document histograms.
+   *
+   * find() keeps working on the compressed documents, decoding them on the
+   * fly, but the per-feature information is gone: getSparseHistogramPerImage()
+   * returns an empty map for the compacted documents. To be called after the
+   * last insert() and computeTfIdfWeights(), when only queries remain; on a
+   * large index this releases most of the database memory.
+   */
+  void compact();
+
   /**
    * @brief Return the size of the database in terms of number of documents
    * @return the number of documents
@@ -144,7 +278,7 @@ public:
   template<class Archive>
   void serialize(Archive & archive)
   {
-    archive(word_files_, word_weights_, database_);
+    archive(word_files_, word_weights_, database_, compact_database_, weights_corpus_size_, default_weight_);
   }
 
   const SparseHistogramPerImage& getSparseHistogramPerImage() const
@@ -154,38 +288,23 @@ public:
   
 private:
 
-  struct WordFrequency
-  {
-    DocId id;
-    uint32_t count;
+  // Compressed list of (DocId, count) postings, in insertion (DocId) order
+  typedef CompressedIdCountList InvertedFile;
 
-    WordFrequency()
-    {
-    }
-
-    WordFrequency(DocId _id, uint32_t _count) : id(_id), count(_count)
-    {
-    }
-
-    // Cereal serialize method
-    template<class Archive>
-    void serialize(Archive & archive)
-    {
-      archive(id, count);
-    }
-  };
-
-  // Stored in increasing order by DocId
-  typedef std::vector<WordFrequency> InvertedFile;
+  // Compressed (Word, count) histograms of compacted documents
+  typedef std::map<DocId, CompressedIdCountList> CompressedHistogramPerImage;
 
   /// @todo Use sorted vector?
   // typedef std::vector< std::pair<Word, float> > DocumentVector;
-  
-  friend std::ostream& operator<<(std::ostream& os, const SparseHistogram &dv);	
+
+  friend std::ostream& operator<<(std::ostream& os, const SparseHistogram &dv);
 
   std::vector<InvertedFile> word_files_;
   std::vector<float> word_weights_;
   SparseHistogramPerImage database_; // Precomputed for inserted documents
+  CompressedHistogramPerImage compact_database_; // Documents re-encoded by compact()
+  std::size_t weights_corpus_size_; // Corpus size at the last full computeTfIdfWeights()
+  float default_weight_; // Default weight of the last full computeTfIdfWeights()
 
   /**
    * Normalize a document vector representing the histogram of visual words for a given image
@@ -58,6 +58,14 @@ public:
   {
     return this->valid_centers_;
   }
+
+protected:
+  /// The accessors above expose the canonical level order with implicit child
+  /// addressing to the builder, so loaded trees must keep that layout.
+  bool allowNodeReordering() const override
+  {
+    return false;
+  }
 };
 
 }
@@ -303,6 +303,21 @@ public:
     restarts_ = restarts;
   }
 
+  size_t getMiniBatchSize() const
+  {
+    return mini_batch_size_;
+  }
+
+  /**
+   * @brief Enable the mini-batch variant: each iteration assigns only a random
+   * batch of the given size and updates the centers with a per-center running
+   * mean. 0 (the default) keeps full Lloyd passes over all the points.
+   */
+  void setMiniBatchSize(size_t batchSize)
+  {
+    mini_batch_size_ = batchSize;
+  }
+
   int getVerbose() const
   {
     return verbose_;
@@ -346,11 +361,16 @@ private:
                                     std::vector<Feature, FeatureAllocator>& centers,
                                     std::vector<unsigned int>& membership) const;
 
+  squared_distance_type clusterMiniBatch(const std::vector<Feature*>& features, size_t k,
+                                         std::vector<Feature, FeatureAllocator>& centers,
+                                         std::vector<unsigned int>& membership) const;
+
   Feature zero_;
   Distance distance_;
   Initializer choose_centers_;
   size_t max_iterations_;
   size_t restarts_;
+  size_t mini_batch_size_;
   int verbose_;
 };
 
@@ -362,7 +382,8 @@ distance_(d),
 choose_centers_(InitKmeanspp()),
 max_iterations_(100),
 verbose_(verbose),
-restarts_(1)
+restarts_(1),
+mini_batch_size_(0)
 {
 }
 
@@ -419,6 +440,10 @@ SimpleKmeans<Feature, Distance, FeatureAllocator>::clusterOnce(const std::vector
   typedef typename std::vector<Feature, FeatureAllocator>::value_type centerType;
   typedef typename Distance::value_type feature_value_type;
 
+  // Mini-batch variant: only worth it when the subset is larger than a batch
+  if(mini_batch_size_ > 0 && features.size() > mini_batch_size_)
+    return clusterMiniBatch(features, k, centers, membership);
+
   std::vector<size_t> new_center_counts(k);
   std::vector<Feature, FeatureAllocator> new_centers(k);
   squared_distance_type max_center_shift = std::numeric_limits<squared_distance_type>::max();
@@ -436,50 +461,61 @@ SimpleKmeans<Feature, Distance, FeatureAllocator>::clusterOnce(const std::vector
     bool is_stable = true;
 
 
-    // Assign data objects to current centers
-    #pragma omp parallel for shared( new_centers, new_center_counts, features, centers, membership)
-    for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(features.size()); ++i)
+    // Assign data objects to current centers.
+    // Each thread accumulates into its own partial centers and counts, merged
+    // once per thread afterwards, so the hot loop has no critical section.
+    #pragma omp parallel shared( new_centers, new_center_counts, features, centers, membership)
     {
-      squared_distance_type d_min = std::numeric_limits<squared_distance_type>::max();
-      unsigned int nearest = 0;
-      bool found = false;
-
-      // @todo if k is large, let's say k>100 use FLAAN to retrieve the 
-      // cluster center
+      std::vector<Feature, FeatureAllocator> local_centers(k, zero_);
+      std::vector<size_t> local_center_counts(k, 0);
+      bool local_stable = true;
 
-      // Find the nearest cluster center to feature i
-      for(unsigned int j = 0; j < k; ++j)
+      #pragma omp for nowait
+      for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(features.size()); ++i)
       {
-        squared_distance_type distance = distance_(*features[i], centers[j]);
-        //		printf("\t\tdistance %f\n", (float)distance);
-        //		PrintFeat(*features[i] );
-        if(distance < d_min)
+        squared_distance_type d_min = std::numeric_limits<squared_distance_type>::max();
+        unsigned int nearest = 0;
+        bool found = false;
+
+        // @todo if k is large, let's say k>100 use FLAAN to retrieve the
+        // cluster center
+
+        // Find the nearest cluster center to feature i
+        for(unsigned int j = 0; j < k; ++j)
         {
-          d_min = distance;
-          nearest = j;
-          found = true;
+          squared_distance_type distance = distance_(*features[i], centers[j]);
+          if(distance < d_min)
+          {
+            d_min = distance;
+            nearest = j;
+            found = true;
+          }
         }
-        //		 printf("\t distance %f %f\n", (double)distance, (double)d_min);
-      }
-      assert(found);
-      // Assign feature i to the cluster it is nearest to
-      if(membership[i] != nearest)
-      {
-        is_stable = false;
-        membership[i] = nearest;
-      }
-      // Accumulate the cluster center and its membership count
-      //	  printf("\t nearest %d\n", nearest);
-      //			checkElements(*features[i], "feat");
+        assert(found);
+        // Assign feature i to the cluster it is nearest to
+        if(membership[i] != nearest)
+        {
+          local_stable = false;
+          membership[i] = nearest;
+        }
+        // Accumulate the cluster center and its membership count
+        local_centers[nearest] += *features[i];
+        ++local_center_counts[nearest];
+      }//for
+
       #pragma omp critical
       {
-        new_centers[nearest] += *features[i];
-        //			checkElements(new_centers[nearest], "sum");
-        //	  printf("\t new_centers[nearest] += *features[i];\n");
-        ++new_center_counts[nearest];
-        //	  printf("\taccumulate\n");
+        for(size_t j = 0; j < k; ++j)
+        {
+          if(local_center_counts[j] == 0)
+            continue;
+          new_centers[j] += local_centers[j];
+          new_center_counts[j] += local_center_counts[j];
+        }
+        if(!local_stable)
+          is_stable = false;
       }
-    }//for
+    }//parallel
 
     if(is_stable) break;
 
@@ -529,5 +565,86 @@ SimpleKmeans<Feature, Distance, FeatureAllocator>::clusterOnce(const std::vector
   return sse;
 }
 
+template < class Feature, class Distance, class FeatureAllocator >
+typename SimpleKmeans<Feature, Distance, FeatureAllocator>::squared_distance_type
+SimpleKmeans<Feature, Distance, FeatureAllocator>::clusterMiniBatch(const std::vector<Feature*>& features, size_t k,
+                                                                    std::vector<Feature, FeatureAllocator>& centers,
+                                                                    std::vector<unsigned int>& membership) const
+{
+  // Mini-batch k-means (Sculley, "Web-scale k-means clustering", WWW 2010):
+  // each iteration assigns only a sampled batch to the current centers and
+  // moves each touched center to the running mean of the samples it received.
+  const size_t batchSize = mini_batch_size_;
+  std::vector<Feature, FeatureAllocator> center_sums(centers.begin(), centers.end());
+  std::vector<size_t> center_counts(k, 1); // the initial center counts as one sample
+  std::vector<size_t> batch(batchSize);
+  std::vector<unsigned int> batch_membership(batchSize);
+
+  // Cheap deterministic LCG so the batches do not depend on the rand() state
+  unsigned long long sampleState = 87654321ULL + features.size();
+
+  if(verbose_ > 0) ALICEVISION_LOG_DEBUG("Mini-batch iterations");
+  for(size_t iter = 0; iter < max_iterations_; ++iter)
+  {
+    if(verbose_ > 0) ALICEVISION_LOG_DEBUG("*");
+    // Draw the batch
+    for(size_t b = 0; b < batchSize; ++b)
+    {
+      sampleState = sampleState * 6364136223846793005ULL + 1442695040888963407ULL;
+      batch[b] = static_cast<size_t>((sampleState >> 32) % features.size());
+    }
+
+    // Parallel assignment of the batch to the nearest centers
+    #pragma omp parallel for
+    for(ptrdiff_t b = 0; b < static_cast<ptrdiff_t>(batchSize); ++b)
+    {
+      squared_distance_type d_min = std::numeric_limits<squared_distance_type>::max();
+      unsigned int nearest = 0;
+      for(unsigned int j = 0; j < k; ++j)
+      {
+        const squared_distance_type distance = distance_(*features[batch[b]], centers[j]);
+        if(distance < d_min)
+        {
+          d_min = distance;
+          nearest = j;
+        }
+      }
+      batch_membership[b] = nearest;
+    }
+
+    // Sequential center update with a per-center learning rate of 1/count
+    for(size_t b = 0; b < batchSize; ++b)
+    {
+      const unsigned int c = batch_membership[b];
+      center_sums[c] += *features[batch[b]];
+      ++center_counts[c];
+      centers[c] = center_sums[c] / center_counts[c];
+    }
+  }
+  if(verbose_ > 0) ALICEVISION_LOG_DEBUG("");
+
+  // One full pass to produce the final membership and the sum squared error
+  squared_distance_type sse = squared_distance_type(0);
+  assert(features.size() > 0);
+  #pragma omp parallel for reduction(+:sse)
+  for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(features.size()); ++i)
+  {
+    squared_distance_type d_min = std::numeric_limits<squared_distance_type>::max();
+    unsigned int nearest = 0;
+    for(unsigned int j = 0; j < k; ++j)
+    {
+      const squared_distance_type distance = distance_(*features[i], centers[j]);
+      if(distance < d_min)
+      {
+        d_min = distance;
+        nearest = j;
+      }
+    }
+    membership[i] = nearest;
+    sse += d_min;
+  }
+  return sse;
+}
+
 }
 }
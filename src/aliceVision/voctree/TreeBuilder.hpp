@@ -8,6 +8,9 @@
 #include "MutableVocabularyTree.hpp"
 #include "SimpleKmeans.hpp"
 #include <deque>
+#include <functional>
+#include <future>
+#include <string>
 //#include <cstdio> //DEBUG
 
 namespace aliceVision {
@@ -47,6 +50,29 @@ public:
    */
   void build(const FeatureVector& training_features, uint32_t k, uint32_t levels);
 
+  /**
+   * @brief Build a new vocabulary tree from descriptor shards on disk.
+   *
+   * Same tree structure as build(), but the descriptor collection never has
+   * to fit in memory. Every level streams the shard files from disk, loading
+   * the next shard asynchronously while the current one is routed through the
+   * partial tree, and only the points of the nodes currently being clustered
+   * stay resident: nodes are grouped into batches whose point counts fit
+   * \p maxResidentFeatures, and a node with more points than the budget is
+   * clustered on a uniform reservoir sample of that size instead.
+   *
+   * \c FileDescriptorT is the descriptor type stored in the shard files, as
+   * in feature::loadDescsFromBinFile().
+   *
+   * @param shardFiles          Descriptor files (.desc) forming the training set.
+   * @param k                   The branching factor, or max children of any node.
+   * @param levels              The number of levels in the tree.
+   * @param maxResidentFeatures Maximum number of training descriptors kept in
+   *                            memory for clustering at any time.
+   */
+  template<class FileDescriptorT>
+  void buildOutOfCore(const std::vector<std::string>& shardFiles, uint32_t k, uint32_t levels, std::size_t maxResidentFeatures);
+
   /// Get the built vocabulary tree.
 
   const Tree& tree() const
@@ -83,6 +109,13 @@ protected:
   Kmeans kmeans_;
   Feature zero_;
 private:
+  /**
+   * Descend \p depth levels of the partially built tree and return the node
+   * the feature falls into, or -1 for depth 0 (the virtual root) and -2 when
+   * a node on the path has no valid children.
+   */
+  int32_t routeToNode(const Feature& f, uint32_t depth) const;
+
   unsigned char verbose_;
 };
 
@@ -117,56 +150,273 @@ void TreeBuilder<Feature, DistanceT, FeatureAllocator>::build(const FeatureVecto
       feature_ptrs.push_back(const_cast<Feature*> (&f));
     }
   }
-  FeatureVector centers; // always size k
   for(uint32_t level = 0; level < levels; ++level)
   {
     if(verbose_) printf("# Level %u\n", level);
-    std::vector<unsigned int> membership;
 
-    for(size_t i = 0, ie = subset_queue.size(); i < ie; ++i)
+    // Move the whole level out of the queue: the sibling subsets are disjoint
+    // so they can be clustered in parallel, as long as the results are merged
+    // back in queue order. At the top levels the few big subsets keep the
+    // parallelism inside k-means (OpenMP does not nest by default); deeper
+    // down the many small subsets saturate the threads here instead.
+    std::vector< std::vector<Feature*> > subsets(subset_queue.begin(), subset_queue.end());
+    subset_queue.clear();
+
+    std::vector<FeatureVector> subset_centers(subsets.size());
+    std::vector<size_t> subset_valid(subsets.size(), 0);
+    std::vector< std::vector< std::vector<Feature*> > > subset_children(subsets.size());
+
+    #pragma omp parallel for schedule(dynamic)
+    for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(subsets.size()); ++i)
     {
-      std::vector<Feature*> &subset = subset_queue.front();
-      if(verbose_ > 1) printf("#\tClustering subset %lu/%lu of size %lu\n", i + 1, ie, subset.size());
+      std::vector<Feature*> &subset = subsets[i];
+      if(verbose_ > 1) printf("#\tClustering subset %lu/%lu of size %lu\n", static_cast<size_t>(i + 1), subsets.size(), subset.size());
 
       // If the subset already has k or fewer elements, just use those as the centers.
       if(subset.size() <= k)
       {
         if(verbose_ > 2) printf("#\tno need to cluster %lu elements\n", subset.size());
+        subset_centers[i].assign(subset.size(), zero_);
         for(size_t j = 0; j < subset.size(); ++j)
-        {
-          tree_.centers().push_back(*subset[j]);
-          tree_.validCenters().push_back(1);
-        }
-        // Mark non-existent centers as invalid.
-        tree_.centers().insert(tree_.centers().end(), k - subset.size(), zero_);
-        tree_.validCenters().insert(tree_.validCenters().end(), k - subset.size(), 0);
+          subset_centers[i][j] = *subset[j];
+        subset_valid[i] = subset.size();
 
-        // Push k empty subsets into the queue so all children get marked invalid.
-        subset_queue.pop_front();
-        subset_queue.insert(subset_queue.end(), k, std::vector<Feature*>());
+        // k empty children so all of them get marked invalid below.
+        subset_children[i].resize(k);
       }
       else
       {
         // Cluster the current subset into k centers.
         if(verbose_ > 2) printf("#\tclustering the current subset of %lu elements into %d centers\n", subset.size(), k);
-        kmeans_.clusterPointers(subset, k, centers, membership);
-        // Add the centers and mark them as valid.
-        tree_.centers().insert(tree_.centers().end(), centers.begin(), centers.end());
-        tree_.validCenters().insert(tree_.validCenters().end(), k, 1);
+        std::vector<unsigned int> membership;
+        kmeans_.clusterPointers(subset, k, subset_centers[i], membership);
+        subset_valid[i] = k;
         // Partition the current subset into k new subsets based on the cluster assignments.
-        std::vector< std::vector<Feature*> > new_subsets(k);
+        subset_children[i].resize(k);
         assert(membership.size() >= subset.size());
         for(size_t j = 0; j < subset.size(); ++j)
         {
           assert(membership[j] < k);
-          assert(membership[j] < new_subsets.size());
-          new_subsets[ membership[j] ].push_back(subset[j]);
+          assert(membership[j] < subset_children[i].size());
+          subset_children[i][ membership[j] ].push_back(subset[j]);
+        }
+      }
+    }
+
+    // Merge the level back in queue order
+    for(size_t i = 0; i < subsets.size(); ++i)
+    {
+      tree_.centers().insert(tree_.centers().end(), subset_centers[i].begin(), subset_centers[i].end());
+      tree_.validCenters().insert(tree_.validCenters().end(), subset_valid[i], 1);
+      // Mark non-existent centers as invalid.
+      tree_.centers().insert(tree_.centers().end(), k - subset_valid[i], zero_);
+      tree_.validCenters().insert(tree_.validCenters().end(), k - subset_valid[i], 0);
+
+      for(size_t j = 0; j < subset_children[i].size(); ++j)
+      {
+        subset_queue.push_back(std::vector<Feature*>());
+        subset_queue.back().swap(subset_children[i][j]);
+      }
+    }
+    if(verbose_) printf("# centers so far = %lu\n", tree_.centers().size());
+  }
+}
+
+template<class Feature, template<typename, typename> class DistanceT, class FeatureAllocator>
+int32_t TreeBuilder<Feature, DistanceT, FeatureAllocator>::routeToNode(const Feature& f, uint32_t depth) const
+{
+  typedef typename Distance::result_type distance_type;
+
+  int32_t index = -1; // virtual "root" index, as in VocabularyTree::quantize()
+  for(uint32_t level = 0; level < depth; ++level)
+  {
+    const int32_t first_child = (index + 1) * (int32_t) tree_.splits();
+    if(!tree_.validCenters()[first_child])
+      return -2; // No valid children, the feature cannot descend further.
+    int32_t best_child = first_child;
+    distance_type best_distance = std::numeric_limits<distance_type>::max();
+    for(int32_t child = first_child; child < first_child + (int32_t) tree_.splits(); ++child)
+    {
+      if(!tree_.validCenters()[child])
+        break; // Fewer than splits() children.
+      const distance_type child_distance = Distance()(f, tree_.centers()[child]);
+      if(child_distance < best_distance)
+      {
+        best_child = child;
+        best_distance = child_distance;
+      }
+    }
+    index = best_child;
+  }
+  return index;
+}
+
+template<class Feature, template<typename, typename> class DistanceT, class FeatureAllocator>
+template<class FileDescriptorT>
+void TreeBuilder<Feature, DistanceT, FeatureAllocator>::buildOutOfCore(const std::vector<std::string>& shardFiles,
+                                                                      uint32_t k, uint32_t levels,
+                                                                      std::size_t maxResidentFeatures)
+{
+  assert(maxResidentFeatures > 0);
+
+  // Initial setup and memory allocation for the tree
+  tree_.clear();
+  tree_.setSize(levels, k);
+  tree_.centers().reserve(tree_.nodes());
+  tree_.validCenters().reserve(tree_.nodes());
+
+  // Loads one shard; run through std::async so the next shard is read from
+  // disk while the current one is routed and clustered.
+  auto loadShard = [](const std::string& file)
+  {
+    FeatureVector shard;
+    feature::loadDescsFromBinFile<Feature, FileDescriptorT>(file, shard, false);
+    return shard;
+  };
+
+  // Streams all shards through the given function, prefetching one ahead.
+  auto forEachShard = [&](const std::function<void(const FeatureVector&)>& process)
+  {
+    if(shardFiles.empty()) return;
+    std::future<FeatureVector> next = std::async(std::launch::async, loadShard, shardFiles[0]);
+    for(std::size_t i = 0; i < shardFiles.size(); ++i)
+    {
+      const FeatureVector shard = next.get();
+      if(i + 1 < shardFiles.size())
+        next = std::async(std::launch::async, loadShard, shardFiles[i + 1]);
+      process(shard);
+    }
+  };
+
+  std::vector<int32_t> routed;
+  // Routes a whole shard to the parent slots of the current level; -1 marks
+  // features falling under an invalid or childless node.
+  auto routeShard = [&](const FeatureVector& shard, uint32_t level, int32_t parent_start)
+  {
+    routed.resize(shard.size());
+    #pragma omp parallel for
+    for(ptrdiff_t j = 0; j < static_cast<ptrdiff_t>(shard.size()); ++j)
+    {
+      if(level == 0)
+      {
+        routed[j] = 0; // single virtual root slot
+        continue;
+      }
+      const int32_t parent = routeToNode(shard[j], level);
+      routed[j] = (parent >= 0 && tree_.validCenters()[parent]) ? (parent - parent_start) : -1;
+    }
+  };
+
+  int32_t parent_start = 0; // first node id of the parent level (unused at level 0)
+  std::size_t num_parents = 1;
+
+  for(uint32_t level = 0; level < levels; ++level)
+  {
+    if(verbose_) printf("# Level %u (out-of-core, %lu parent nodes)\n", level, num_parents);
+
+    // First streaming pass: count the points of every parent node.
+    std::vector<uint64_t> counts(num_parents, 0);
+    forEachShard([&](const FeatureVector& shard)
+    {
+      routeShard(shard, level, parent_start);
+      for(std::size_t j = 0; j < shard.size(); ++j)
+        if(routed[j] >= 0)
+          ++counts[routed[j]];
+    });
+
+    // Results of this level, per parent slot
+    std::vector<FeatureVector> subset_centers(num_parents);
+    std::vector<size_t> subset_valid(num_parents, 0);
+
+    // Group the parents into batches whose resident points fit the budget and
+    // stream the shards once per batch. A parent over the budget gets its own
+    // batch and a uniform reservoir sample of the budget size.
+    std::size_t batch_begin = 0;
+    while(batch_begin < num_parents)
+    {
+      if(counts[batch_begin] == 0)
+      {
+        ++batch_begin; // no points: k invalid children, like an empty subset in build()
+        continue;
+      }
+      std::size_t batch_end = batch_begin;
+      uint64_t resident = 0;
+      while(batch_end < num_parents)
+      {
+        const uint64_t points = std::min<uint64_t>(counts[batch_end], maxResidentFeatures);
+        if(batch_end > batch_begin && resident + points > maxResidentFeatures)
+          break;
+        resident += points;
+        ++batch_end;
+      }
+      if(verbose_ > 1) printf("#\tBatch of parents [%lu, %lu) holding %lu resident points\n", batch_begin, batch_end, (size_t) resident);
+
+      // Collect the resident points of the batch
+      std::vector<FeatureVector> buffers(batch_end - batch_begin);
+      std::vector<uint64_t> seen(batch_end - batch_begin, 0);
+      for(std::size_t b = 0; b < buffers.size(); ++b)
+        buffers[b].reserve(std::min<uint64_t>(counts[batch_begin + b], maxResidentFeatures));
+
+      forEachShard([&](const FeatureVector& shard)
+      {
+        routeShard(shard, level, parent_start);
+        for(std::size_t j = 0; j < shard.size(); ++j)
+        {
+          if(routed[j] < (int32_t) batch_begin || routed[j] >= (int32_t) batch_end)
+            continue;
+          FeatureVector& buffer = buffers[routed[j] - batch_begin];
+          const uint64_t n = ++seen[routed[j] - batch_begin];
+          if(buffer.size() < maxResidentFeatures)
+            buffer.push_back(shard[j]);
+          else
+          {
+            // Reservoir sampling keeps the resident points a uniform sample.
+            const uint64_t r = rand() % n;
+            if(r < maxResidentFeatures)
+              buffer[r] = shard[j];
+          }
+        }
+      });
+
+      // Cluster each parent of the batch; clusterPointers parallelizes inside.
+      for(std::size_t b = 0; b < buffers.size(); ++b)
+      {
+        const std::size_t slot = batch_begin + b;
+        FeatureVector& points = buffers[b];
+        if(points.size() <= k)
+        {
+          // Use the points themselves as the centers.
+          subset_centers[slot].assign(points.begin(), points.end());
+          subset_valid[slot] = points.size();
+        }
+        else
+        {
+          std::vector<Feature*> ptrs;
+          ptrs.reserve(points.size());
+          for(Feature& p: points)
+            ptrs.push_back(&p);
+          std::vector<unsigned int> membership;
+          kmeans_.clusterPointers(ptrs, k, subset_centers[slot], membership);
+          subset_valid[slot] = k;
         }
-        // Update the queue
-        subset_queue.pop_front();
-        subset_queue.insert(subset_queue.end(), new_subsets.begin(), new_subsets.end());
       }
+
+      batch_begin = batch_end;
     }
+
+    // Merge the level into the tree in node order, like build()
+    for(std::size_t slot = 0; slot < num_parents; ++slot)
+    {
+      tree_.centers().insert(tree_.centers().end(), subset_centers[slot].begin(), subset_centers[slot].end());
+      tree_.validCenters().insert(tree_.validCenters().end(), subset_valid[slot], 1);
+      tree_.centers().insert(tree_.centers().end(), k - subset_valid[slot], zero_);
+      tree_.validCenters().insert(tree_.validCenters().end(), k - subset_valid[slot], 0);
+    }
+
+    // Advance to the next level's parent range.
+    parent_start = (level == 0) ? 0 : (parent_start + 1) * (int32_t) k;
+    num_parents *= k;
+
     if(verbose_) printf("# centers so far = %lu\n", tree_.centers().size());
   }
 }
@@ -16,14 +16,24 @@
 #include <aliceVision/system/Logger.hpp>
 
 #include <stdint.h>
+#include <algorithm>
+#include <cstring>
 #include <vector>
 #include <map>
+#include <memory>
 #include <cassert>
 #include <limits>
 #include <fstream>
 #include <stdexcept>
 #include <iostream>
 
+#if !defined(_MSC_VER)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 
 namespace aliceVision {
 namespace voctree {
@@ -36,6 +46,10 @@ typedef std::vector<Word> Document;
 typedef std::map<Word, std::vector<IndexT> > SparseHistogram;
 typedef std::map<DocId, SparseHistogram> SparseHistogramPerImage;
 
+/// Word histogram reduced to sorted (word, count) pairs, without the
+/// per-feature indices of a SparseHistogram.
+typedef std::vector<std::pair<Word, std::size_t> > WordCountList;
+
 /**
  * Given a list of visual words associated to the features of a document it computes the 
  * vector of unique weighted visual words
@@ -56,6 +70,29 @@ inline void computeSparseHistogram(const std::vector<Word>& document, SparseHist
   }
 }
 
+/**
+ * @brief On-disk header of the memory-mappable tree format.
+ *
+ * The header is padded to 64 bytes so the level-ordered node array that
+ * follows it is aligned for any vectorized feature type; the validity bytes
+ * come right after the node array. A mapped tree file is read-only and its
+ * pages are shared between all processes mapping it on the same host.
+ */
+struct MappedTreeHeader
+{
+  char magic[8];        // MAPPED_TREE_MAGIC
+  uint32_t version;     // layout version, currently 1
+  uint32_t k;           // branching factor
+  uint32_t levels;      // depth of the tree
+  uint32_t featureSize; // sizeof(Feature), guards against type mismatches
+  uint32_t nodes;       // number of centers
+  uint8_t padding[36];  // node array starts at offset 64
+};
+
+static_assert(sizeof(MappedTreeHeader) == 64, "Mapped tree node array must stay 64-byte aligned");
+
+const char MAPPED_TREE_MAGIC[8] = {'A', 'L', 'V', 'O', 'C', 'T', 'R', 'E'};
+
 class IVocabularyTree
 {
 public:
@@ -87,6 +124,49 @@ public:
 
 inline IVocabularyTree::~IVocabularyTree() {}
 
+/**
+ * @brief Append the sibling blocks of a complete k-ary subtree in van Emde Boas order.
+ *
+ * A sibling block groups the k children of one node and is the unit read at each
+ * level of a quantization descent. Splitting the levels in half recursively packs
+ * the top of the tree contiguously and clusters every deeper subtree next to its
+ * root, so the blocks touched by a descent stay local at every scale of the
+ * cache hierarchy.
+ *
+ * @param[in] block canonical index of the subtree root block
+ * @param[in] height number of levels spanned by the subtree
+ * @param[in] k branching factor
+ * @param[in,out] order storage order of the blocks; one canonical block index is appended per block
+ */
+inline void appendVebBlockOrder(uint32_t block, uint32_t height, uint32_t k, std::vector<uint32_t>& order)
+{
+  if(height <= 1)
+  {
+    order.push_back(block);
+    return;
+  }
+  const uint32_t topHeight = height / 2;
+  appendVebBlockOrder(block, topHeight, k, order);
+
+  // the bottom subtrees are rooted at every block topHeight levels below
+  std::vector<uint32_t> frontier(1, block);
+  for(uint32_t h = 0; h < topHeight; ++h)
+  {
+    std::vector<uint32_t> children;
+    children.reserve(frontier.size() * k);
+    for(std::size_t i = 0; i < frontier.size(); ++i)
+    {
+      // the child block of node n is block n + 1, nodes of block b start at b * k
+      const uint32_t firstChildBlock = frontier[i] * k + 1;
+      for(uint32_t c = 0; c < k; ++c)
+        children.push_back(firstChildBlock + c);
+    }
+    frontier.swap(children);
+  }
+  for(std::size_t i = 0; i < frontier.size(); ++i)
+    appendVebBlockOrder(frontier[i], height - topHeight, k, order);
+}
+
 /**
  * @brief Optimized vocabulary tree quantizer, templated on feature type and distance metric
  * for maximum efficiency.
@@ -120,6 +200,16 @@ public:
   template<class DescriptorT>
   std::vector<Word> quantize(const std::vector<DescriptorT>& features) const;
 
+  /**
+   * @brief Quantizes a whole block of features into visual words.
+   *
+   * Same result as calling quantize() per feature, but the traversal runs in
+   * one loop and prefetches the children of the current best candidate so the
+   * next tree level is likely in cache when descending.
+   */
+  template<class DescriptorT>
+  void quantizeMultiple(const std::vector<DescriptorT>& features, std::vector<Word>& words) const;
+
   /// Quantizes a set of features into sparse histogram of visual words.
   template<class DescriptorT>
   SparseHistogram quantizeToSparse(const std::vector<DescriptorT>& features) const;
@@ -142,23 +232,54 @@ public:
 
   /// Save vocabulary to a file.
   void save(const std::string& file) const override;
-  /// Load vocabulary from a file.
+  /// Save vocabulary to a file in the memory-mappable format.
+  void saveMapped(const std::string& file) const;
+  /// Load vocabulary from a file; mapped-format files are mmap'ed instead of copied.
   void load(const std::string& file) override;
+  /// Map a vocabulary file written by saveMapped() without copying the nodes.
+  void loadMapped(const std::string& file);
 
   bool operator==(const VocabularyTree& other) const
   {
-    return (centers_ == other.centers_) &&
-        (valid_centers_ == other.valid_centers_) &&
-        (k_ == other.k_) &&
-        (levels_ == other.levels_) &&
-        (num_words_ == other.num_words_) &&
-        (word_start_ == other.word_start_);
+    if(k_ != other.k_ || levels_ != other.levels_ ||
+       num_words_ != other.num_words_ || word_start_ != other.word_start_)
+      return false;
+    if(!initialized())
+      return true;
+    // compare block by block in canonical order: the in-memory layouts may differ
+    const uint32_t nbBlocks = (num_words_ + word_start_) / k_;
+    for(uint32_t b = 0; b < nbBlocks; ++b)
+    {
+      const Feature* centers = centersData() + storageBlock(b) * k_;
+      const Feature* otherCenters = other.centersData() + other.storageBlock(b) * k_;
+      const uint8_t* valid = validCentersData() + storageBlock(b) * k_;
+      const uint8_t* otherValid = other.validCentersData() + other.storageBlock(b) * k_;
+      if(!std::equal(centers, centers + k_, otherCenters) ||
+         !std::equal(valid, valid + k_, otherValid))
+        return false;
+    }
+    return true;
   }
 
 protected:
   std::vector<Feature, FeatureAllocator> centers_;
   std::vector<uint8_t> valid_centers_; /// @todo Consider bit-vector
 
+  // Cache-optimized node layout, built by optimizeNodeLayout() at load time.
+  // When storage_block_ is non-empty the node arrays are stored in van Emde
+  // Boas block order and first_child_ holds, for every stored node, the
+  // storage index of its first child -- or the visual word for leaf nodes.
+  // When empty the arrays are in canonical level order and the implicit
+  // (index + 1) * k_ child addressing applies.
+  std::vector<int32_t> first_child_;
+  std::vector<uint32_t> storage_block_; // canonical block -> storage block
+
+  // Set when the tree is a read-only view into a mapped file; the region is
+  // shared so copies of the tree keep it alive.
+  std::shared_ptr<const void> mapped_region_;
+  const Feature* mapped_centers_;
+  const uint8_t* mapped_valid_centers_;
+
   uint32_t k_; // splits, or branching factor
   uint32_t levels_;
   uint32_t num_words_; // number of leaf nodes
@@ -169,18 +290,43 @@ protected:
     return num_words_ != 0;
   }
 
+  /// Level-ordered node array, owned or mapped.
+  const Feature* centersData() const
+  {
+    return mapped_centers_ ? mapped_centers_ : centers_.data();
+  }
+
+  /// Validity byte per node, owned or mapped.
+  const uint8_t* validCentersData() const
+  {
+    return mapped_valid_centers_ ? mapped_valid_centers_ : valid_centers_.data();
+  }
+
+  /// Storage block holding a canonical sibling block (identity for canonical layouts).
+  uint32_t storageBlock(uint32_t block) const
+  {
+    return storage_block_.empty() ? block : storage_block_[block];
+  }
+
+  /// Whether load() may reorder the node arrays for cache locality.
+  virtual bool allowNodeReordering() const
+  {
+    return true;
+  }
+
   void setNodeCounts();
+  void optimizeNodeLayout();
 };
 
 template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
 VocabularyTree<Feature, Distance, FeatureAllocator>::VocabularyTree()
-: k_(0), levels_(0), num_words_(0), word_start_(0)
+: mapped_centers_(nullptr), mapped_valid_centers_(nullptr), k_(0), levels_(0), num_words_(0), word_start_(0)
 {
 }
 
 template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
 VocabularyTree<Feature, Distance, FeatureAllocator>::VocabularyTree(const std::string& file)
-: k_(0), levels_(0), num_words_(0), word_start_(0)
+: mapped_centers_(nullptr), mapped_valid_centers_(nullptr), k_(0), levels_(0), num_words_(0), word_start_(0)
 {
   load(file);
 }
@@ -194,29 +340,35 @@ Word VocabularyTree<Feature, Distance, FeatureAllocator>::quantize(const Descrip
   //	printf("asserting\n");
   assert(initialized());
   //	printf("initialized\n");
-  int32_t index = -1; // virtual "root" index, which has no associated center.
+  const Feature* const centers = centersData();
+  const uint8_t* const valid_centers = validCentersData();
+  // With a reordered layout the jump table gives the next sibling block (and
+  // directly the word at the leaves), otherwise the implicit level-order
+  // addressing applies. The root block is always stored first.
+  const int32_t* const jump = first_child_.empty() ? nullptr : first_child_.data();
+  int32_t first_child = 0;
+  int32_t best_child = 0;
   for(unsigned level = 0; level < levels_; ++level)
   {
-    // Calculate the offset to the first child of the current index.
-    int32_t first_child = (index + 1) * splits();
     // Find the child center closest to the query.
-    int32_t best_child = first_child;
+    best_child = first_child;
     distance_type best_distance = std::numeric_limits<distance_type>::max();
     for(int32_t child = first_child; child < first_child + (int32_t) splits(); ++child)
     {
-      if(!valid_centers_[child])
+      if(!valid_centers[child])
         break; // Fewer than splits() children.
-      distance_type child_distance = Distance<DescriptorT, Feature>()(feature, centers_[child]);
+      distance_type child_distance = Distance<DescriptorT, Feature>()(feature, centers[child]);
       if(child_distance < best_distance)
       {
         best_child = child;
         best_distance = child_distance;
       }
     }
-    index = best_child;
+    first_child = jump ? jump[best_child] : (best_child + 1) * (int32_t) splits();
   }
 
-  return index - word_start_;
+  // past the last level the jump table already resolved the leaf to its word
+  return jump ? first_child : best_child - (int32_t) word_start_;
 }
 
 template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
@@ -224,18 +376,61 @@ template<class DescriptorT>
 std::vector<Word> VocabularyTree<Feature, Distance, FeatureAllocator>::quantize(const std::vector<DescriptorT>& features) const
 {
   // ALICEVISION_LOG_DEBUG("VocabularyTree quantize: " << features.size());
-  std::vector<Word> imgVisualWords(features.size(), 0);
+  std::vector<Word> imgVisualWords;
 
   // quantize the features
+  quantizeMultiple(features, imgVisualWords);
+
+  // add the vector to the documents
+  return imgVisualWords;
+}
+
+template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
+template<class DescriptorT>
+void VocabularyTree<Feature, Distance, FeatureAllocator>::quantizeMultiple(const std::vector<DescriptorT>& features, std::vector<Word>& words) const
+{
+  typedef typename Distance<DescriptorT, Feature>::result_type distance_type;
+
+  assert(initialized());
+  words.resize(features.size());
+
+  const Feature* const centers = centersData();
+  const uint8_t* const valid_centers = validCentersData();
+  // see quantize() for the two traversal layouts
+  const int32_t* const jump = first_child_.empty() ? nullptr : first_child_.data();
+
   #pragma omp parallel for
   for(ptrdiff_t j = 0; j < static_cast<ptrdiff_t>(features.size()); ++j)
   {
-    // store the visual word associated to the feature in the temporary list
-    imgVisualWords[j] = quantize<DescriptorT>(features[j]);
+    const DescriptorT& feature = features[j];
+    int32_t first_child = 0; // the root block is always stored first
+    int32_t best_child = 0;
+    for(unsigned level = 0; level < levels_; ++level)
+    {
+      // Find the child center closest to the query.
+      best_child = first_child;
+      distance_type best_distance = std::numeric_limits<distance_type>::max();
+      for(int32_t child = first_child; child < first_child + (int32_t) k_; ++child)
+      {
+        if(!valid_centers[child])
+          break; // Fewer than splits() children.
+        const distance_type child_distance = Distance<DescriptorT, Feature>()(feature, centers[child]);
+        if(child_distance < best_distance)
+        {
+          best_child = child;
+          best_distance = child_distance;
+#if defined(__GNUC__)
+          // Start pulling the children of the current best candidate so the
+          // next level is likely in cache when we descend.
+          if(level + 1 < levels_)
+            __builtin_prefetch(&centers[jump ? jump[best_child] : (best_child + 1) * (int32_t) k_]);
+#endif
+        }
+      }
+      first_child = jump ? jump[best_child] : (best_child + 1) * (int32_t) k_;
+    }
+    words[j] = jump ? first_child : best_child - (int32_t) word_start_;
   }
-
-  // add the vector to the documents
-  return imgVisualWords;
 }
 
 template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
@@ -271,6 +466,11 @@ void VocabularyTree<Feature, Distance, FeatureAllocator>::clear()
 {
   centers_.clear();
   valid_centers_.clear();
+  first_child_.clear();
+  storage_block_.clear();
+  mapped_region_.reset();
+  mapped_centers_ = nullptr;
+  mapped_valid_centers_ = nullptr;
   k_ = levels_ = num_words_ = word_start_ = 0;
 }
 
@@ -284,15 +484,56 @@ void VocabularyTree<Feature, Distance, FeatureAllocator>::save(const std::string
   std::ofstream out(file.c_str(), std::ios_base::binary);
   out.write((char*) (&k_), sizeof (uint32_t));
   out.write((char*) (&levels_), sizeof (uint32_t));
-  uint32_t size = centers_.size();
+  uint32_t size = num_words_ + word_start_;
   out.write((char*) (&size), sizeof (uint32_t));
-  out.write((char*) (&centers_[0]), centers_.size() * sizeof (Feature));
-  out.write((char*) (&valid_centers_[0]), valid_centers_.size());
+  // the nodes are written in canonical level order whatever the in-memory layout
+  const uint32_t nbBlocks = size / k_;
+  for(uint32_t b = 0; b < nbBlocks; ++b)
+    out.write((char*) (centersData() + storageBlock(b) * k_), k_ * sizeof (Feature));
+  for(uint32_t b = 0; b < nbBlocks; ++b)
+    out.write((char*) (validCentersData() + storageBlock(b) * k_), k_);
+}
+
+template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
+void VocabularyTree<Feature, Distance, FeatureAllocator>::saveMapped(const std::string& file) const
+{
+  assert(initialized());
+
+  MappedTreeHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, MAPPED_TREE_MAGIC, sizeof(header.magic));
+  header.version = 1;
+  header.k = k_;
+  header.levels = levels_;
+  header.featureSize = sizeof(Feature);
+  header.nodes = num_words_ + word_start_;
+
+  std::ofstream out(file.c_str(), std::ios_base::binary);
+  out.write((char*) (&header), sizeof(header));
+  // mapped files always hold the canonical level order, see optimizeNodeLayout()
+  const uint32_t nbBlocks = header.nodes / k_;
+  for(uint32_t b = 0; b < nbBlocks; ++b)
+    out.write((char*) (centersData() + storageBlock(b) * k_), k_ * sizeof (Feature));
+  for(uint32_t b = 0; b < nbBlocks; ++b)
+    out.write((char*) (validCentersData() + storageBlock(b) * k_), k_);
 }
 
 template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
 void VocabularyTree<Feature, Distance, FeatureAllocator>::load(const std::string& file)
 {
+  // Mapped-format files are recognized by their magic and mmap'ed instead of
+  // copied, so startup cost is a single map operation whatever the tree size.
+  {
+    char magic[8] = {0};
+    std::ifstream peek(file.c_str(), std::ios_base::binary);
+    peek.read(magic, sizeof(magic));
+    if(peek && std::memcmp(magic, MAPPED_TREE_MAGIC, sizeof(magic)) == 0)
+    {
+      loadMapped(file);
+      return;
+    }
+  }
+
   clear();
 
   std::ifstream in;
@@ -317,6 +558,81 @@ void VocabularyTree<Feature, Distance, FeatureAllocator>::load(const std::string
 
   setNodeCounts();
   assert(size == num_words_ + word_start_);
+  optimizeNodeLayout();
+}
+
+template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
+void VocabularyTree<Feature, Distance, FeatureAllocator>::loadMapped(const std::string& file)
+{
+  clear();
+
+  MappedTreeHeader header;
+
+#if !defined(_MSC_VER)
+  const int fd = ::open(file.c_str(), O_RDONLY);
+  if(fd < 0)
+    throw std::runtime_error("Failed to open mapped vocabulary tree file " + file);
+
+  struct stat fileStat;
+  if(::fstat(fd, &fileStat) != 0)
+  {
+    ::close(fd);
+    throw std::runtime_error("Failed to stat mapped vocabulary tree file " + file);
+  }
+  const std::size_t fileSize = fileStat.st_size;
+
+  void* base = ::mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if(base == MAP_FAILED)
+    throw std::runtime_error("Failed to map vocabulary tree file " + file);
+
+  // The region outlives every copy of this tree.
+  mapped_region_ = std::shared_ptr<const void>(base, [fileSize](const void* p)
+  {
+    ::munmap(const_cast<void*>(p), fileSize);
+  });
+
+  if(fileSize < sizeof(MappedTreeHeader))
+    throw std::runtime_error("Mapped vocabulary tree file " + file + " is truncated");
+  std::memcpy(&header, base, sizeof(header));
+  if(std::memcmp(header.magic, MAPPED_TREE_MAGIC, sizeof(header.magic)) != 0 || header.version != 1)
+    throw std::runtime_error("File " + file + " is not a mapped vocabulary tree");
+  if(header.featureSize != sizeof(Feature))
+    throw std::runtime_error("Mapped vocabulary tree file " + file + " was built for another descriptor type");
+  if(fileSize < sizeof(MappedTreeHeader) + header.nodes * (sizeof(Feature) + 1))
+    throw std::runtime_error("Mapped vocabulary tree file " + file + " is truncated");
+
+  const uint8_t* data = static_cast<const uint8_t*>(base) + sizeof(MappedTreeHeader);
+  mapped_centers_ = reinterpret_cast<const Feature*>(data);
+  mapped_valid_centers_ = data + header.nodes * sizeof(Feature);
+#else
+  // No mmap on MSVC: fall back to reading the arrays, without page sharing.
+  std::ifstream in;
+  in.exceptions(std::ifstream::eofbit | std::ifstream::failbit | std::ifstream::badbit);
+  try
+  {
+    in.open(file.c_str(), std::ios_base::binary);
+    in.read((char*) (&header), sizeof(header));
+    if(std::memcmp(header.magic, MAPPED_TREE_MAGIC, sizeof(header.magic)) != 0 || header.version != 1)
+      throw std::runtime_error("File " + file + " is not a mapped vocabulary tree");
+    if(header.featureSize != sizeof(Feature))
+      throw std::runtime_error("Mapped vocabulary tree file " + file + " was built for another descriptor type");
+    centers_.resize(header.nodes);
+    valid_centers_.resize(header.nodes);
+    in.read((char*) (&centers_[0]), centers_.size() * sizeof (Feature));
+    in.read((char*) (&valid_centers_[0]), valid_centers_.size());
+  }
+  catch(std::ifstream::failure& e)
+  {
+    throw std::runtime_error("Failed to load mapped vocabulary tree file " + file);
+  }
+#endif
+
+  k_ = header.k;
+  levels_ = header.levels;
+  setNodeCounts();
+  assert(header.nodes == num_words_ + word_start_);
+  optimizeNodeLayout();
 }
 
 template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
@@ -331,6 +647,64 @@ void VocabularyTree<Feature, Distance, FeatureAllocator>::setNodeCounts()
   }
 }
 
+template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
+void VocabularyTree<Feature, Distance, FeatureAllocator>::optimizeNodeLayout()
+{
+  first_child_.clear();
+  storage_block_.clear();
+
+  // A mapped tree is a read-only view shared between processes, so it keeps
+  // the canonical level order of the file, which already packs the top levels
+  // contiguously at its front. The mutable tree keeps it too, since its
+  // accessors expose the implicit child addressing to the builder.
+  if(mapped_centers_ != nullptr || !allowNodeReordering())
+    return;
+
+  const uint32_t nbNodes = num_words_ + word_start_;
+  const uint32_t nbBlocks = nbNodes / k_;
+
+  // Storage order of the sibling blocks: van Emde Boas over the block tree,
+  // so the first levels -- read by every single descent -- stay resident in a
+  // few cache lines worth of pages, and every deep subtree sits next to its
+  // root instead of being spread across the whole level.
+  std::vector<uint32_t> blockOrder; // storage block -> canonical block
+  blockOrder.reserve(nbBlocks);
+  appendVebBlockOrder(0, levels_, k_, blockOrder);
+  assert(blockOrder.size() == nbBlocks);
+
+  storage_block_.resize(nbBlocks);
+  for(uint32_t sb = 0; sb < nbBlocks; ++sb)
+    storage_block_[blockOrder[sb]] = sb;
+
+  // permute the node arrays into the storage order, block by block
+  std::vector<Feature, FeatureAllocator> centers(nbNodes);
+  std::vector<uint8_t> valid(nbNodes);
+  for(uint32_t sb = 0; sb < nbBlocks; ++sb)
+  {
+    const uint32_t cb = blockOrder[sb];
+    std::copy(centers_.begin() + cb * k_, centers_.begin() + (cb + 1) * k_, centers.begin() + sb * k_);
+    std::copy(valid_centers_.begin() + cb * k_, valid_centers_.begin() + (cb + 1) * k_, valid.begin() + sb * k_);
+  }
+  centers_.swap(centers);
+  valid_centers_.swap(valid);
+
+  // Per-node jump table: the storage index of the first child for inner
+  // nodes, the visual word for leaf nodes.
+  first_child_.resize(nbNodes);
+  for(uint32_t cb = 0; cb < nbBlocks; ++cb)
+  {
+    const uint32_t sb = storage_block_[cb];
+    for(uint32_t i = 0; i < k_; ++i)
+    {
+      const uint32_t node = cb * k_ + i; // canonical node index
+      if(node < word_start_)
+        first_child_[sb * k_ + i] = (int32_t)(storage_block_[node + 1] * k_);
+      else
+        first_child_[sb * k_ + i] = (int32_t)(node - word_start_);
+    }
+  }
+}
+
 /**
  * @brief compute the sparse distance between two histograms according to the chosen distance method.
  * 
@@ -342,6 +716,17 @@ void VocabularyTree<Feature, Distance, FeatureAllocator>::setNodeCounts()
  */
 float sparseDistance(const SparseHistogram& v1, const SparseHistogram& v2, const std::string &distanceMethod = "classic", const std::vector<float>& word_weights = std::vector<float>());
 
+/**
+ * @brief compute the sparse distance between two word-count histograms according to the chosen distance method.
+ *
+ * @param v1 The first histogram, as sorted (word, count) pairs
+ * @param v2 The second histogram, as sorted (word, count) pairs
+ * @param distanceMethod distance method (norm L1, etc.)
+ * @param word_weights
+ * @return the distance of the two histograms
+ */
+float sparseDistance(const WordCountList& v1, const WordCountList& v2, const std::string &distanceMethod = "classic", const std::vector<float>& word_weights = std::vector<float>());
+
 inline std::unique_ptr<IVocabularyTree> createVoctreeForDescriberType(feature::EImageDescriberType imageDescriberType)
 {
   using namespace aliceVision::feature;
@@ -349,7 +734,8 @@ inline std::unique_ptr<IVocabularyTree> createVoctreeForDescriberType(feature::E
 
   switch(imageDescriberType)
   {
-    case EImageDescriberType::SIFT:       res.reset(new VocabularyTree<SIFT_Regions::DescriptorT>); break;
+    case EImageDescriberType::SIFT:
+    case EImageDescriberType::SIFT_UPRIGHT: res.reset(new VocabularyTree<SIFT_Regions::DescriptorT>); break;
     case EImageDescriberType::SIFT_FLOAT: res.reset(new VocabularyTree<SIFT_Float_Regions::DescriptorT>); break;
     case EImageDescriberType::AKAZE:      res.reset(new VocabularyTree<AKAZE_Float_Regions::DescriptorT>); break;
     case EImageDescriberType::AKAZE_MLDB: res.reset(new VocabularyTree<AKAZE_BinaryRegions::DescriptorT>); break;
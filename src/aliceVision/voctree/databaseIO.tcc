@@ -6,12 +6,12 @@
 #include "descriptorLoader.hpp"
 
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/ProgressReporter.hpp>
 #include <aliceVision/sfm/sfmDataIO.hpp>
 #include <aliceVision/config.hpp>
 
 #include <boost/filesystem.hpp>
 #include <boost/algorithm/string/case_conv.hpp>
-#include <boost/progress.hpp>
 
 #include <exception>
 #include <iostream>
@@ -33,27 +33,36 @@ std::size_t populateDatabase(const sfm::SfMData &sfmData,
   
   // Read the descriptors
   ALICEVISION_LOG_DEBUG("Reading the descriptors from " << descriptorsFiles.size() <<" files...");
-  boost::progress_display display(descriptorsFiles.size());
+  system::ProgressReporter progress(descriptorsFiles.size(), "Populate voctree database");
 
-  // Run through the path vector and read the descriptors
+  // Snapshot the entries so the parallel loop can index them directly
+  std::vector<const std::pair<const IndexT, std::string>*> fileEntries;
+  fileEntries.reserve(descriptorsFiles.size());
   for(const auto &currentFile : descriptorsFiles)
+    fileEntries.push_back(&currentFile);
+
+  // Load and quantize the descriptors in parallel, only the database
+  // insertion is serialized
+  #pragma omp parallel for schedule(dynamic) reduction(+:numDescriptors)
+  for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(fileEntries.size()); ++i)
   {
-    
+    const std::pair<const IndexT, std::string> &currentFile = *fileEntries[i];
     std::vector<DescriptorT> descriptors;
 
     // Read the descriptors
     loadDescsFromBinFile(currentFile.second, descriptors, false, Nmax);
-    size_t result = descriptors.size();
-    
-    SparseHistogram newDoc =  tree.quantizeToSparse(descriptors);
 
-    // Insert document in database
-    db.insert(currentFile.first, newDoc);
+    SparseHistogram newDoc =  tree.quantizeToSparse(descriptors);
 
     // Update the overall counter
-    numDescriptors += result;
-    
-    ++display;
+    numDescriptors += descriptors.size();
+
+    #pragma omp critical
+    {
+      // Insert document in database
+      db.insert(currentFile.first, newDoc);
+    }
+    progress.advance(1, descriptors.size() * sizeof(DescriptorT));
   }
 
   // Return the result
@@ -74,28 +83,39 @@ std::size_t populateDatabase(const sfm::SfMData &sfmData,
 
   // Read the descriptors
   ALICEVISION_LOG_DEBUG("Reading the descriptors from " << descriptorsFiles.size() <<" files...");
-  boost::progress_display display(descriptorsFiles.size());
+  system::ProgressReporter progress(descriptorsFiles.size(), "Populate voctree database");
 
-  // Run through the path vector and read the descriptors
+  // Snapshot the entries so the parallel loop can index them directly
+  std::vector<const std::pair<const IndexT, std::string>*> fileEntries;
+  fileEntries.reserve(descriptorsFiles.size());
   for(const auto &currentFile : descriptorsFiles)
+    fileEntries.push_back(&currentFile);
+
+  // Load and quantize the descriptors in parallel, only the database
+  // insertion is serialized
+  #pragma omp parallel for schedule(dynamic) reduction(+:numDescriptors)
+  for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(fileEntries.size()); ++i)
   {
+    const std::pair<const IndexT, std::string> &currentFile = *fileEntries[i];
     std::vector<DescriptorT> descriptors;
 
     // Read the descriptors
     loadDescsFromBinFile(currentFile.second, descriptors, false, Nmax);
-    size_t result = descriptors.size();
-    
-    allDescriptors[currentFile.first] = descriptors;
-    
+
     SparseHistogram newDoc = tree.quantizeToSparse(descriptors);
-    
-    // Insert document in database
-    db.insert(currentFile.first, newDoc);
 
     // Update the overall counter
-    numDescriptors += result;
+    numDescriptors += descriptors.size();
+
+    const std::size_t descriptorBytes = descriptors.size() * sizeof(DescriptorT);
+    #pragma omp critical
+    {
+      allDescriptors[currentFile.first].swap(descriptors);
 
-    ++display;
+      // Insert document in database
+      db.insert(currentFile.first, newDoc);
+    }
+    progress.advance(1, descriptorBytes);
   }
 
   // Return the result
@@ -146,18 +166,25 @@ void queryDatabase(const sfm::SfMData &sfmData,
   
   // Read the descriptors
   ALICEVISION_LOG_DEBUG("queryDatabase: Reading the descriptors from " << descriptorsFiles.size() << " files...");
-  boost::progress_display display(descriptorsFiles.size());
+  system::ProgressReporter progress(descriptorsFiles.size(), "Query voctree database");
+
+  // Snapshot the entries so the parallel loop can index them directly,
+  // instead of advancing a map iterator by i every iteration (quadratic on
+  // large image sets)
+  std::vector<const std::pair<const IndexT, std::string>*> fileEntries;
+  fileEntries.reserve(descriptorsFiles.size());
+  for(const auto &currentFile : descriptorsFiles)
+    fileEntries.push_back(&currentFile);
 
-  #pragma omp parallel for
+  #pragma omp parallel for schedule(dynamic)
   // Run through the path vector and read the descriptors
-  for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(descriptorsFiles.size()); ++i)
+  for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(fileEntries.size()); ++i)
   {
-    std::map<IndexT, std::string>::const_iterator currentFileIt = descriptorsFiles.cbegin();
-    std::advance(currentFileIt, i);
+    const std::pair<const IndexT, std::string> &currentFile = *fileEntries[i];
     std::vector<DescriptorT> descriptors;
 
     // Read the descriptors
-    loadDescsFromBinFile(currentFileIt->second, descriptors, false, Nmax);
+    loadDescsFromBinFile(currentFile.second, descriptors, false, Nmax);
 
     // quantize the descriptors
     SparseHistogram query = tree.quantizeToSparse(descriptors);
@@ -168,13 +195,12 @@ void queryDatabase(const sfm::SfMData &sfmData,
     #pragma omp critical
     {
       // add the vector to the documents
-      documents[currentFileIt->first] = query;
+      documents[currentFile.first].swap(query);
 
       // add the matches to the result vector
-      allDocMatches[currentFileIt->first] = docMatches;
-
-      ++display;
+      allDocMatches[currentFile.first].swap(docMatches);
     }
+    progress.advance(1, descriptors.size() * sizeof(DescriptorT));
   }
 }
 
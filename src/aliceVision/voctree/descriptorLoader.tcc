@@ -5,10 +5,10 @@
 
 #include <aliceVision/feature/Descriptor.hpp>
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/ProgressReporter.hpp>
 
 #include <boost/filesystem.hpp>
 #include <boost/algorithm/string/case_conv.hpp>
-#include <boost/progress.hpp>
 
 #include <iostream>
 #include <fstream>
@@ -28,9 +28,9 @@ size_t readDescFromFiles(const sfm::SfMData &sfmData, const std::string &descFol
   // of descriptors
   int bytesPerElement = 0;
 
-  // Display infos and progress bar
+  // Display infos and progress
   ALICEVISION_LOG_DEBUG("Pre-computing the memory needed...");
-  boost::progress_display display(descriptorsFiles.size());
+  system::ProgressReporter sizingProgress(descriptorsFiles.size(), "Sizing descriptor files");
 
   // Read all files and get the number of descriptors to load
   for(const auto &currentFile : descriptorsFiles)
@@ -46,8 +46,9 @@ size_t readDescFromFiles(const sfm::SfMData &sfmData, const std::string &descFol
       // get the file size in byte and estimate the number of features without opening the file
       numDescriptors += (bfs::file_size(currentFile.second) / bytesPerElement) / DescriptorT::static_size;
     }
-    ++display;
+    sizingProgress.advance();
   }
+  sizingProgress.finish();
   ALICEVISION_LOG_DEBUG("Found " << numDescriptors << " descriptors overall, allocating memory...");
   if(bytesPerElement == 0)
   {
@@ -62,7 +63,7 @@ size_t readDescFromFiles(const sfm::SfMData &sfmData, const std::string &descFol
 
   // Read the descriptors
   ALICEVISION_LOG_DEBUG("Reading the descriptors...");
-  display.restart(descriptorsFiles.size());
+  system::ProgressReporter progress(descriptorsFiles.size(), "Loading descriptor files");
 
   // Run through the path vector and read the descriptors
   for(const auto &currentFile : descriptorsFiles)
@@ -77,7 +78,7 @@ size_t readDescFromFiles(const sfm::SfMData &sfmData, const std::string &descFol
     // Update the overall counter
     numDescriptors = result;
 
-    ++display;
+    progress.advance(1, numFeatures.back() * sizeof(DescriptorT));
   }
   assert(numDescriptors == numDescriptorsCheck);
 
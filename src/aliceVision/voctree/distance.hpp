@@ -5,6 +5,9 @@
 
 #pragma once
 
+#include <aliceVision/feature/Descriptor.hpp>
+#include <aliceVision/matching/metric.hpp>
+
 #include <stdint.h>
 //#include <iostream>
 #include <Eigen/Core>
@@ -56,5 +59,31 @@ struct L2< Eigen::Matrix<Scalar, Rows, Cols, Options, MaxRows, MaxCols>, Eigen::
   }
 };
 
+/// Specialization for float feature::Descriptor: map the raw storage to Eigen
+/// so the accumulation is vectorized instead of the scalar fallback.
+
+template<std::size_t N>
+struct L2< feature::Descriptor<float, N>, feature::Descriptor<float, N> >
+{
+  typedef feature::Descriptor<float, N> feature_type;
+  typedef float value_type;
+  typedef double result_type;
+
+  typedef Eigen::Matrix<float, 1, static_cast<int>(N)> map_type;
+
+  result_type operator()(const feature_type& a, const feature_type& b) const
+  {
+#if defined(ALICEVISION_CPU_DISPATCH_X86)
+    // Header-only reuse of the runtime-dispatched matching kernels, so the
+    // distance runs with the widest instruction set of the host.
+    return matching::optim_dispatch::l2Dispatch(a.getData(), b.getData(), static_cast<int>(N));
+#else
+    const Eigen::Map<const map_type> va(a.getData());
+    const Eigen::Map<const map_type> vb(b.getData());
+    return (va - vb).squaredNorm();
+#endif
+  }
+};
+
 }
 }
@@ -80,5 +80,65 @@ BOOST_AUTO_TEST_CASE(voctreeBuilder)
   {
     BOOST_CHECK_SMALL(distance(centerOrig[i],centerLoad[i]), kepsf);
   }
-//  voctree::printFeatVector( features ); 
+//  voctree::printFeatVector( features );
+}
+
+BOOST_AUTO_TEST_CASE(voctreeNodeLayout)
+{
+  using namespace aliceVision;
+
+  const std::string treeName = "test_layout.tree";
+  const std::string resavedTreeName = "test_layout_resaved.tree";
+
+  const std::size_t DIMENSION = 3;
+  const std::size_t FEATURENUMBER = 50;
+  const std::size_t K = 4;
+  const std::size_t LEVELS = 3;
+  const std::size_t LEAVESNUMBER = std::pow(K, LEVELS);
+  const std::size_t STEP = 1;
+
+  typedef Eigen::Matrix<float, 1, DIMENSION> FeatureFloat;
+  typedef std::vector<FeatureFloat, Eigen::aligned_allocator<FeatureFloat> > FeatureFloatVector;
+
+  // generate a random vector of features, one cluster per leaf
+  FeatureFloatVector features;
+  features.reserve(FEATURENUMBER * LEAVESNUMBER);
+  for(std::size_t i = 0; i < LEAVESNUMBER; ++i)
+  {
+    for(std::size_t j = 0; j < FEATURENUMBER; ++j)
+    {
+      features.push_back((FeatureFloat::Random(1, DIMENSION) + Eigen::MatrixXf::Constant(1, DIMENSION, STEP * i) - Eigen::MatrixXf::Constant(1, DIMENSION, STEP * (LEAVESNUMBER - 1) / 2)) / ((STEP * (LEAVESNUMBER - 1) / 2) * sqrt(DIMENSION)));
+    }
+  }
+
+  voctree::TreeBuilder<FeatureFloat> builder(FeatureFloat::Zero());
+  builder.setVerbose(0);
+  builder.kmeans().setRestarts(5);
+  builder.build(features, K, LEVELS);
+  builder.tree().save(treeName);
+
+  // the read-only tree reorders its nodes at load time for cache locality,
+  // the mutable tree keeps the canonical level order
+  voctree::VocabularyTree<FeatureFloat> reordered(treeName);
+  voctree::MutableVocabularyTree<FeatureFloat> canonical;
+  canonical.load(treeName);
+
+  BOOST_CHECK(reordered == canonical);
+
+  // both layouts must quantize every feature to the same word
+  const std::vector<FeatureFloat> queries(features.begin(), features.end());
+  const std::vector<voctree::Word> reorderedWords = reordered.quantize(queries);
+  const std::vector<voctree::Word> canonicalWords = canonical.quantize(queries);
+  BOOST_REQUIRE_EQUAL(reorderedWords.size(), canonicalWords.size());
+  for(std::size_t i = 0; i < reorderedWords.size(); ++i)
+  {
+    BOOST_CHECK_EQUAL(reorderedWords[i], canonicalWords[i]);
+    BOOST_CHECK_EQUAL(reordered.quantize(queries[i]), canonicalWords[i]);
+  }
+
+  // saving a reordered tree writes the canonical order back
+  reordered.save(resavedTreeName);
+  voctree::MutableVocabularyTree<FeatureFloat> resaved;
+  resaved.load(resavedTreeName);
+  BOOST_CHECK(resaved == canonical);
 }
@@ -0,0 +1,62 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/voctree/TreeBuilder.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <Eigen/Core>
+
+#include <cmath>
+#include <vector>
+
+using namespace aliceVision;
+
+// SIFT-like descriptor layout: 128 float dimensions
+static const std::size_t DIMENSION = 128;
+
+typedef Eigen::Matrix<float, 1, DIMENSION> FeatureFloat;
+typedef std::vector<FeatureFloat, Eigen::aligned_allocator<FeatureFloat> > FeatureFloatVector;
+
+/// Clustered random features, one cluster per leaf, like a captured distribution
+static FeatureFloatVector randomFeatures(std::size_t nbClusters, std::size_t nbFeaturesPerCluster)
+{
+  // FeatureFloat::Random() is deterministic (no seeding), so runs stay comparable
+  FeatureFloatVector features;
+  features.reserve(nbClusters * nbFeaturesPerCluster);
+  for(std::size_t i = 0; i < nbClusters; ++i)
+  {
+    const FeatureFloat center = FeatureFloat::Random() * static_cast<float>(nbClusters);
+    for(std::size_t j = 0; j < nbFeaturesPerCluster; ++j)
+      features.push_back(center + FeatureFloat::Random());
+  }
+  return features;
+}
+
+static void BM_VocabularyTree_Quantize(benchmark::State& state)
+{
+  const std::size_t K = 8;
+  const std::size_t LEVELS = 3;
+  const std::size_t NB_LEAVES = std::pow(K, LEVELS);
+
+  // Build a vocabulary from clustered training features, once
+  const FeatureFloatVector trainingFeatures = randomFeatures(NB_LEAVES, 10);
+  voctree::TreeBuilder<FeatureFloat> builder(FeatureFloat::Zero());
+  builder.build(trainingFeatures, K, LEVELS);
+
+  const FeatureFloatVector queryFeatures = randomFeatures(NB_LEAVES, state.range(0) / NB_LEAVES + 1);
+
+  for(auto _ : state)
+  {
+    voctree::Word wordSum = 0;
+    for(std::size_t i = 0; i < queryFeatures.size(); ++i)
+      wordSum += builder.tree().quantize(queryFeatures[i]);
+    benchmark::DoNotOptimize(wordSum);
+  }
+  state.SetItemsProcessed(state.iterations() * queryFeatures.size());
+}
+BENCHMARK(BM_VocabularyTree_Quantize)->Arg(10000);
+
+BENCHMARK_MAIN();
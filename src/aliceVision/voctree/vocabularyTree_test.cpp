@@ -78,3 +78,138 @@ BOOST_AUTO_TEST_CASE(database_databaseIO) {
     BOOST_CHECK_SMALL(static_cast<double>(reload_match[0].score), 0.001);
   }
 }
+
+BOOST_AUTO_TEST_CASE(database_compact) {
+
+  // Create a documents vector, with some words shared between documents
+  vector< vector<Word> > documents_to_insert;
+  documents_to_insert.resize(card_documents);
+  for(int i = 0; i < documents_to_insert.size(); ++i)
+  {
+    documents_to_insert[i].resize(card_words);
+    for(int j = 0; j < card_words; ++j)
+    {
+      documents_to_insert[i][j] = (card_words / 2) * i + j;
+    }
+  }
+
+  // Create the database
+  Database db( documents_to_insert.size() * documents_to_insert[0].size() ) ;
+  for(int i = 0; i < documents_to_insert.size(); ++i)
+  {
+    SparseHistogram histo;
+    computeSparseHistogram(documents_to_insert[i], histo);
+    db.insert(i, histo);
+  }
+  db.computeTfIdfWeights( );
+
+  // Query every document before compacting
+  vector<DocMatches> full_matches(card_documents);
+  for(int i = 0; i < documents_to_insert.size(); i++)
+    db.find(documents_to_insert[i], 3, full_matches[i], "classic");
+
+  // Compacting must not change the database size nor any query result
+  db.compact();
+  BOOST_CHECK_EQUAL(db.size(), card_documents);
+
+  for(int i = 0; i < documents_to_insert.size(); i++)
+  {
+    DocMatches compact_matches;
+    db.find(documents_to_insert[i], 3, compact_matches, "classic");
+    BOOST_CHECK_EQUAL(full_matches[i].size(), compact_matches.size());
+    for(int j = 0; j < full_matches[i].size(); ++j)
+    {
+      BOOST_CHECK_EQUAL(full_matches[i][j].id, compact_matches[j].id);
+      BOOST_CHECK_EQUAL(full_matches[i][j].score, compact_matches[j].score);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(database_find_approximate) {
+
+  // Create a documents vector, with some words shared between documents
+  vector< vector<Word> > documents_to_insert;
+  documents_to_insert.resize(card_documents);
+  for(int i = 0; i < documents_to_insert.size(); ++i)
+  {
+    documents_to_insert[i].resize(card_words);
+    for(int j = 0; j < card_words; ++j)
+    {
+      documents_to_insert[i][j] = (card_words / 2) * i + j;
+    }
+  }
+
+  // Create the database
+  Database db( documents_to_insert.size() * documents_to_insert[0].size() ) ;
+  for(int i = 0; i < documents_to_insert.size(); ++i)
+  {
+    SparseHistogram histo;
+    computeSparseHistogram(documents_to_insert[i], histo);
+    db.insert(i, histo);
+  }
+  db.computeTfIdfWeights( );
+
+  for(int i = 0; i < documents_to_insert.size(); i++)
+  {
+    SparseHistogram query;
+    computeSparseHistogram(documents_to_insert[i], query);
+
+    // With N above the corpus size the early exit cannot trigger and the
+    // scores must be identical to the exhaustive scan
+    DocMatches exact, approximate;
+    db.find(query, card_documents, exact, "strongCommonPoints");
+    db.findApproximate(query, 2 * card_documents, approximate, "strongCommonPoints");
+    BOOST_CHECK_EQUAL(approximate[0].id, exact[0].id);
+    BOOST_CHECK_EQUAL(approximate[0].score, exact[0].score);
+
+    // The early-terminating top-N query must still rank the document itself first
+    DocMatches top;
+    db.findApproximate(query, 2, top, "strongCommonPoints");
+    BOOST_CHECK(!top.empty());
+    BOOST_CHECK_EQUAL(top[0].id, i);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(database_incremental_weights) {
+
+  // Create a documents vector, with some words shared between documents
+  vector< vector<Word> > documents_to_insert;
+  documents_to_insert.resize(card_documents);
+  for(int i = 0; i < documents_to_insert.size(); ++i)
+  {
+    documents_to_insert[i].resize(card_words);
+    for(int j = 0; j < card_words; ++j)
+    {
+      documents_to_insert[i][j] = (card_words / 2) * i + j;
+    }
+  }
+
+  // Build one database with a final full weight computation and one
+  // incrementally, with a zero drift threshold so weights stay exact
+  Database full_db( documents_to_insert.size() * documents_to_insert[0].size() ) ;
+  Database incremental_db( documents_to_insert.size() * documents_to_insert[0].size() ) ;
+  for(int i = 0; i < documents_to_insert.size(); ++i)
+  {
+    SparseHistogram histo;
+    computeSparseHistogram(documents_to_insert[i], histo);
+    full_db.insert(i, histo);
+    incremental_db.insertAndUpdateWeights(i, histo, 0.f);
+  }
+  full_db.computeTfIdfWeights( );
+
+  BOOST_CHECK_EQUAL(full_db.size(), incremental_db.size());
+
+  // Weighted queries must give the same results in both databases
+  for(int i = 0; i < documents_to_insert.size(); i++)
+  {
+    DocMatches full_matches, incremental_matches;
+    full_db.find(documents_to_insert[i], 3, full_matches, "weightedStrongCommonPoints");
+    incremental_db.find(documents_to_insert[i], 3, incremental_matches, "weightedStrongCommonPoints");
+    BOOST_CHECK_EQUAL(full_matches.size(), incremental_matches.size());
+    for(int j = 0; j < full_matches.size(); ++j)
+    {
+      BOOST_CHECK_EQUAL(full_matches[j].id, incremental_matches[j].id);
+      BOOST_CHECK_EQUAL(full_matches[j].score, incremental_matches[j].score);
+    }
+  }
+}
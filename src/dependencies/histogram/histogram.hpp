@@ -86,6 +86,24 @@ public:
       ++freq[std::min(i, nBins-1)];
     }
   }
+  // Increase the count for the bin that holds the given
+  // value (or the under-/overflow count) by the given amount.
+  // Equivalent to calling Add(x) count times.
+  void Add(const T& x, const size_t count)
+  {
+    if( x < Start )
+      underflow += count;
+    else if( x > End )
+      overflow += count;
+    else
+    {
+      const size_t i(
+        static_cast<size_t>(
+        (x-Start)*nBins_by_interval) );
+      // clamp for the particular case when (x == End)
+      freq[std::min(i, nBins-1)] += count;
+    }
+  }
   // Get the sum of all counts in the histogram.
   size_t GetTotalCount() const
   {
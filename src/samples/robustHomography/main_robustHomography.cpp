@@ -190,7 +190,7 @@ int main() {
 
       // Create and fill the output image
       Image<RGBColor> imaOut(imageL.Width(), imageL.Height());
-      image::Warp(image, H, imaOut);
+      image::WarpTiled(image, H, imaOut);
       const std::string imageNameOut = "query_warped.png";
       writeImage(imageNameOut, imaOut);
     }
@@ -6,18 +6,171 @@
 #include <aliceVision/feature/Descriptor.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/cmdline.hpp>
+#include <aliceVision/system/cpuDispatch.hpp>
 
 #include <boost/progress.hpp>
 #include <boost/filesystem.hpp>
-#include <boost/program_options.hpp> 
-#include <boost/algorithm/string/case_conv.hpp> 
+#include <boost/program_options.hpp>
+#include <boost/algorithm/string/case_conv.hpp>
 
+#include <algorithm>
+#include <cassert>
 #include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(ALICEVISION_CPU_DISPATCH_X86)
+#include <immintrin.h>
+#endif
 
 using namespace aliceVision;
 namespace po = boost::program_options;
 namespace fs = boost::filesystem;
 
+namespace {
+
+// Saturating float to unsigned char conversion of one chunk:
+// out[i] = (unsigned char)clamp(in[i], 0, 255)
+
+void convertChunk_scalar(const float* in, unsigned char* out, std::size_t size)
+{
+  for(std::size_t i = 0; i < size; ++i)
+    out[i] = static_cast<unsigned char>(std::min(std::max(in[i], 0.f), 255.f));
+}
+
+#if defined(ALICEVISION_CPU_DISPATCH_X86)
+
+ALICEVISION_TARGET_SSE4
+void convertChunk_sse4(const float* in, unsigned char* out, std::size_t size)
+{
+  const __m128 lo = _mm_setzero_ps();
+  const __m128 hi = _mm_set1_ps(255.f);
+  std::size_t i = 0;
+  for(; i + 16 <= size; i += 16)
+  {
+    const __m128i v0 = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i), lo), hi));
+    const __m128i v1 = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i + 4), lo), hi));
+    const __m128i v2 = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i + 8), lo), hi));
+    const __m128i v3 = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i + 12), lo), hi));
+    const __m128i w0 = _mm_packs_epi32(v0, v1);
+    const __m128i w1 = _mm_packs_epi32(v2, v3);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(w0, w1));
+  }
+  if(i < size)
+    convertChunk_scalar(in + i, out + i, size - i);
+}
+
+ALICEVISION_TARGET_AVX2
+void convertChunk_avx2(const float* in, unsigned char* out, std::size_t size)
+{
+  const __m256 lo = _mm256_setzero_ps();
+  const __m256 hi = _mm256_set1_ps(255.f);
+  // the 128-bit lane packing shuffles the dwords, permute them back in order
+  const __m256i perm = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+  std::size_t i = 0;
+  for(; i + 32 <= size; i += 32)
+  {
+    const __m256i v0 = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(in + i), lo), hi));
+    const __m256i v1 = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(in + i + 8), lo), hi));
+    const __m256i v2 = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(in + i + 16), lo), hi));
+    const __m256i v3 = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(in + i + 24), lo), hi));
+    const __m256i w0 = _mm256_packs_epi32(v0, v1);
+    const __m256i w1 = _mm256_packs_epi32(v2, v3);
+    const __m256i u = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(w0, w1), perm);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), u);
+  }
+  if(i < size)
+    convertChunk_scalar(in + i, out + i, size - i);
+}
+
+#endif // ALICEVISION_CPU_DISPATCH_X86
+
+typedef void (*ConvertChunkKernel)(const float*, unsigned char*, std::size_t);
+
+void convertChunk(const float* in, unsigned char* out, std::size_t size)
+{
+#if defined(ALICEVISION_CPU_DISPATCH_X86)
+  static const ConvertChunkKernel kernelFn =
+    system::CpuDispatch<ConvertChunkKernel>(&convertChunk_scalar)
+      .sse4(&convertChunk_sse4)
+      .avx2(&convertChunk_avx2)
+      .resolve();
+  kernelFn(in, out, size);
+#else
+  convertChunk_scalar(in, out, size);
+#endif
+}
+
+/**
+ * @brief Convert one .desc file from float to unsigned char by streaming
+ * fixed-size chunks: only one chunk of floats and its converted output are
+ * resident at a time, whatever the file size.
+ * @param[in] inputPath The float descriptor file
+ * @param[in] outputPath The unsigned char descriptor file to write
+ * @param[in] descSize Number of elements of one descriptor
+ * @param[in] doSanityCheck Re-check every chunk against the scalar conversion
+ * @return The number of descriptors converted
+ */
+std::size_t convertDescFileStreaming(const std::string& inputPath,
+                                     const std::string& outputPath,
+                                     std::size_t descSize,
+                                     bool doSanityCheck)
+{
+  std::ifstream fileIn(inputPath.c_str(), std::ios::in | std::ios::binary);
+  if(!fileIn.is_open())
+    throw std::runtime_error("Can't load descriptor binary file, can't open '" + inputPath + "' !");
+
+  std::ofstream fileOut(outputPath.c_str(), std::ios::out | std::ios::binary);
+  if(!fileOut.is_open())
+    throw std::runtime_error("Can't save descriptor binary file, can't open '" + outputPath + "' !");
+
+  std::size_t cardDesc = 0;
+  fileIn.read(reinterpret_cast<char*>(&cardDesc), sizeof(std::size_t));
+  if(!fileIn.good())
+    throw std::runtime_error("Can't load descriptor binary file, '" + inputPath + "' is incorrect !");
+  fileOut.write(reinterpret_cast<const char*>(&cardDesc), sizeof(std::size_t));
+
+  // 4096 descriptors per chunk: ~2MB of floats in flight per thread
+  const std::size_t chunkDescCount = 4096;
+  std::vector<float> floatChunk(chunkDescCount * descSize);
+  std::vector<unsigned char> ucharChunk(chunkDescCount * descSize);
+
+  for(std::size_t remaining = cardDesc; remaining > 0;)
+  {
+    const std::size_t nbDesc = std::min(remaining, chunkDescCount);
+    const std::size_t nbValues = nbDesc * descSize;
+
+    fileIn.read(reinterpret_cast<char*>(&floatChunk[0]), nbValues * sizeof(float));
+    if(!fileIn.good())
+      throw std::runtime_error("Can't load descriptor binary file, '" + inputPath + "' is incorrect !");
+
+    convertChunk(&floatChunk[0], &ucharChunk[0], nbValues);
+
+    if(doSanityCheck)
+    {
+      // check that the vectorized conversion matches the scalar one
+      for(std::size_t i = 0; i < nbValues; ++i)
+      {
+        const unsigned char compare =
+          static_cast<unsigned char>(std::min(std::max(floatChunk[i], 0.f), 255.f));
+        assert(compare == ucharChunk[i]);
+      }
+    }
+
+    fileOut.write(reinterpret_cast<const char*>(&ucharChunk[0]), nbValues);
+    remaining -= nbDesc;
+  }
+
+  if(!fileOut.good())
+    throw std::runtime_error("Can't save descriptor binary file, '" + outputPath + "' is incorrect !");
+
+  return cardDesc;
+}
+
+} // namespace
+
 int main( int argc, char** argv )
 {
   std::string verboseLevel = system::EVerboseLevel_enumToString(system::Logger::getDefaultVerboseLevel());
@@ -94,7 +247,10 @@ int main( int argc, char** argv )
   }
   
   size_t countFeat = 0;
-  size_t countDesc = 0;
+
+  // scan the folder first: the .feat copies are cheap and stay serial, the
+  // .desc conversions are collected so they can run in parallel below
+  std::vector<std::string> descFilenames;
 
   fs::directory_iterator iterator(inputFolder);
   for(; iterator != fs::directory_iterator(); ++iterator)
@@ -108,70 +264,123 @@ int main( int argc, char** argv )
     {
       // just copy the file into the output folder
       fs::copy_file(iterator->path(), fs::path(outputFolder)/fs::path(filename), fs::copy_option::overwrite_if_exists);
-      
+
       ++countFeat;
     }
     else if(ext == ".desc")
     {
-      const std::string outpath = (fs::path(outputFolder)/fs::path(filename)).string();
-      std::vector<feature::Descriptor<float, siftSize> > floatDescriptors;
-      
-      // load the float descriptors
-      feature::loadDescsFromBinFile(iterator->path().string(), floatDescriptors, false);
-      
-      const size_t numDesc = floatDescriptors.size();
-      
-      std::vector<feature::Descriptor<unsigned char, siftSize> > charDescriptors(numDesc);
- 
-      for(std::size_t i = 0; i < numDesc; ++i)
+      descFilenames.push_back(filename);
+    }
+  }
+
+  std::string firstError;
+
+  #pragma omp parallel for schedule(dynamic)
+  for(int f = 0; f < static_cast<int>(descFilenames.size()); ++f)
+  {
+    {
+      bool skip;
+      #pragma omp critical
+      skip = !firstError.empty();
+      if(skip)
+        continue;
+    }
+
+    const std::string inpath = (fs::path(inputFolder)/fs::path(descFilenames[f])).string();
+    const std::string outpath = (fs::path(outputFolder)/fs::path(descFilenames[f])).string();
+
+    try
+    {
+      // sniff the file: a zstd compressed descriptor file can't be converted
+      // chunk by chunk, it keeps the in-memory path below
+      unsigned char magic[4] = {0, 0, 0, 0};
+      {
+        std::ifstream fileIn(inpath.c_str(), std::ios::in | std::ios::binary);
+        if(!fileIn.is_open())
+          throw std::runtime_error("Can't load descriptor binary file, can't open '" + inpath + "' !");
+        fileIn.read(reinterpret_cast<char*>(magic), sizeof(magic));
+      }
+
+      if(!feature::isZstdFrame(magic))
+      {
+        // stream fixed-size chunks through the vectorized conversion, so the
+        // file is never fully resident in either representation
+        convertDescFileStreaming(inpath, outpath, siftSize, doSanityCheck);
+      }
+      else
       {
-        float* fptr = floatDescriptors[i].getData();
-        assert(fptr!=nullptr);
-        unsigned char* uptr = charDescriptors[i].getData();
-        assert(uptr!=nullptr);
-      
-        std::copy(fptr, fptr+siftSize, uptr);
-      
-        if(!doSanityCheck)
-          continue;    
-        // check that they are actually the same
-        for(std::size_t j = 0; j < siftSize; ++j)
-        {      
-          const unsigned char compare = (unsigned char) fptr[j];
-          assert(compare == uptr[j]);
+        std::vector<feature::Descriptor<float, siftSize> > floatDescriptors;
+
+        // load the float descriptors
+        feature::loadDescsFromBinFile(inpath, floatDescriptors, false);
+
+        const size_t numDesc = floatDescriptors.size();
+
+        std::vector<feature::Descriptor<unsigned char, siftSize> > charDescriptors(numDesc);
+
+        for(std::size_t i = 0; i < numDesc; ++i)
+        {
+          float* fptr = floatDescriptors[i].getData();
+          assert(fptr!=nullptr);
+          unsigned char* uptr = charDescriptors[i].getData();
+          assert(uptr!=nullptr);
+
+          convertChunk(fptr, uptr, siftSize);
+
+          if(!doSanityCheck)
+            continue;
+          // check that they are actually the same
+          for(std::size_t j = 0; j < siftSize; ++j)
+          {
+            const unsigned char compare =
+              static_cast<unsigned char>(std::min(std::max(fptr[j], 0.f), 255.f));
+            assert(compare == uptr[j]);
+          }
         }
-      }    
-      
-      assert(charDescriptors.size() == floatDescriptors.size());
-      
-      // save the unsigned char
-      feature::saveDescsToBinFile(outpath, charDescriptors);
-      
+
+        assert(charDescriptors.size() == floatDescriptors.size());
+
+        // save the unsigned char
+        feature::saveDescsToBinFile(outpath, charDescriptors);
+      }
+
       if(doSanityCheck)
       {
-        // sanity check 
+        // sanity check
         // reload everything and compare
-        floatDescriptors.clear();
-        charDescriptors.clear();
-        feature::loadDescsFromBinFile(iterator->path().string(), floatDescriptors, false);
+        std::vector<feature::Descriptor<float, siftSize> > floatDescriptors;
+        std::vector<feature::Descriptor<unsigned char, siftSize> > charDescriptors;
+        feature::loadDescsFromBinFile(inpath, floatDescriptors, false);
         feature::loadDescsFromBinFile(outpath, charDescriptors, false);
 
-        assert(charDescriptors.size() == numDesc);
         assert(charDescriptors.size() == floatDescriptors.size());
 
-        for(std::size_t i = 0; i < numDesc; ++i)
+        for(std::size_t i = 0; i < floatDescriptors.size(); ++i)
         {
           const feature::Descriptor<float, siftSize> &currFloat = floatDescriptors[i];
           const feature::Descriptor<unsigned char, siftSize> &currUchar = charDescriptors[i];
           for(std::size_t j = 0; j < siftSize; ++j)
           {
-            const unsigned char compare = (unsigned char) currFloat[j];
+            const unsigned char compare =
+              static_cast<unsigned char>(std::min(std::max(currFloat[j], 0.f), 255.f));
             assert(compare == currUchar[j]);
           }
         }
       }
-      ++countDesc;
+    }
+    catch(std::exception& e)
+    {
+      #pragma omp critical
+      if(firstError.empty())
+        firstError = e.what();
     }
   }
-  ALICEVISION_LOG_INFO("Converted " << countDesc << " files .desc and copied " << countFeat << " files .feat");
+
+  if(!firstError.empty())
+  {
+    ALICEVISION_LOG_ERROR(std::string("Error: ") + firstError);
+    return EXIT_FAILURE;
+  }
+
+  ALICEVISION_LOG_INFO("Converted " << descFilenames.size() << " files .desc and copied " << countFeat << " files .feat");
 }
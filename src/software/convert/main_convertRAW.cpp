@@ -13,6 +13,8 @@
 
 #include <cstdlib>
 #include <string>
+#include <utility>
+#include <vector>
 
 using namespace aliceVision;
 namespace po = boost::program_options;
@@ -86,6 +88,10 @@ int main(int argc, char** argv)
   if(!fs::is_directory(outputFolder))
     fs::create_directory(outputFolder);
 
+  // check all the input and output paths before any conversion starts, so
+  // the errors abort the batch up front like in the serial version
+  std::vector<std::string> outputPaths;
+  outputPaths.reserve(imagePaths.size());
   for(const std::string& path : imagePaths)
   {
     // check input path
@@ -104,30 +110,62 @@ int main(int argc, char** argv)
       return EXIT_FAILURE;
     }
 
+    outputPaths.push_back(outputPath);
+  }
+
+  // decode in parallel and hand the decoded frames to the asynchronous
+  // writer: the RAW demosaicing runs on the OpenMP threads while the
+  // encoding and disk writes run on the writer threads, with a bounded
+  // queue capping the number of frames held in memory
+  image::AsyncImageWriter writer(2, 8);
+  std::string firstError;
+
+  #pragma omp parallel for schedule(dynamic)
+  for(int i = 0; i < static_cast<int>(imagePaths.size()); ++i)
+  {
+    {
+      bool skip;
+      #pragma omp critical
+      skip = !firstError.empty();
+      if(skip)
+        continue;
+    }
+
     // read input image
     // only read the 3 first channels
     image::Image<image::RGBColor> image;
 
     try
     {
-      image::readImage(path, image);
+      image::readImage(imagePaths[i], image);
     }
     catch(std::exception& e)
     {
-      ALICEVISION_LOG_ERROR(std::string("Error: ") + e.what());
-      return EXIT_FAILURE;
+      #pragma omp critical
+      if(firstError.empty())
+        firstError = e.what();
+      continue;
     }
 
-    // write output image
-    try
-    {
-      image::writeImage(outputPath, image);
-    }
-    catch(std::exception& e)
-    {
-      ALICEVISION_LOG_ERROR(std::string("Error: ") + e.what());
-      return EXIT_FAILURE;
-    }
+    // queue the output image write
+    writer.write(outputPaths[i], std::move(image));
+  }
+
+  // wait for the pending writes; the writer reports the first failed one
+  try
+  {
+    writer.waitAll();
+  }
+  catch(std::exception& e)
+  {
+    if(firstError.empty())
+      firstError = e.what();
+  }
+
+  if(!firstError.empty())
+  {
+    ALICEVISION_LOG_ERROR(std::string("Error: ") + firstError);
+    return EXIT_FAILURE;
   }
   return EXIT_SUCCESS;
 }
@@ -117,8 +117,11 @@ int main(int argc, char **argv)
   flags = (flags) ? flags : ALL;
 
   // load input SfMData scene
+  // only the requested sections are loaded: the flags reach the section
+  // table of the chunked binary format, so converting the views of a large
+  // scene never parses its landmarks
   SfMData sfm_data;
-  if (!Load(sfm_data, sfmDataFilename, ESfMData(ALL)))
+  if (!Load(sfm_data, sfmDataFilename, ESfMData(flags)))
   {
     ALICEVISION_LOG_ERROR("The input SfMData file '" << sfmDataFilename << "' cannot be read");
     return EXIT_FAILURE;
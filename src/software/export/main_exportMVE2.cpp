@@ -93,61 +93,41 @@ bool exportToMVE2Format(
     out << "drews 1.0\n";  // MVE expects this header
     out << cameraCount << " " << featureCount << "\n";
 
-    // Export (calibrated) views as undistorted images
-    boost::progress_display my_progress_bar(sfm_data.GetViews().size());
-    std::pair<int,int> w_h_image_size;
-    Image<RGBColor> image, image_ud, thumbnail;
-    std::string sOutViewIteratorDirectory;
-    std::size_t view_index = 0;
+    // First pass, serial: assign contiguous view indexes, batch-create the
+    // per-view folders and write all the camera metadata (meta.ini and the
+    // bundle camera blocks, each buffered before its single write), so the
+    // deterministic naming and bundle ordering do not depend on the
+    // parallel image pass below.
     std::map<std::size_t, IndexT> viewIdToviewIndex;
+    std::vector<const View*> validViews;
+    std::vector<std::string> viewDirectories;
     for(Views::const_iterator iter = sfm_data.GetViews().begin();
-      iter != sfm_data.GetViews().end(); ++iter, ++my_progress_bar)
+      iter != sfm_data.GetViews().end(); ++iter)
     {
       const View * view = iter->second.get();
 
       if (!sfm_data.IsPoseAndIntrinsicDefined(view))
         continue;
 
+      const std::size_t view_index = validViews.size();
       viewIdToviewIndex[view->getViewId()] = view_index;
       // Create current view subfolder 'view_xxxx.mve'
       std::ostringstream padding;
       // Warning: We use view_index instead of view->getViewId() because MVE use indexes instead of IDs.
       padding << std::setw(4) << std::setfill('0') << view_index;
 
-      sOutViewIteratorDirectory = stlplus::folder_append_separator(sOutViewsDirectory) + "view_" + padding.str() + ".mve";
+      const std::string sOutViewIteratorDirectory =
+        stlplus::folder_append_separator(sOutViewsDirectory) + "view_" + padding.str() + ".mve";
       if (!stlplus::folder_exists(sOutViewIteratorDirectory))
       {
         stlplus::folder_create(sOutViewIteratorDirectory);
       }
+      validViews.push_back(view);
+      viewDirectories.push_back(sOutViewIteratorDirectory);
 
-      // We have a valid view with a corresponding camera & pose
       const std::string srcImage = view->getImagePath();
-      const std::string dstImage =
-        stlplus::create_filespec(stlplus::folder_append_separator(sOutViewIteratorDirectory), "undistorted","png");
-
       Intrinsics::const_iterator iterIntrinsic = sfm_data.GetIntrinsics().find(view->getIntrinsicId());
       const IntrinsicBase * cam = iterIntrinsic->second.get();
-      if (cam->isValid() && cam->have_disto())
-      {
-        // Undistort and save the image
-        readImage(srcImage, image);
-        UndistortImage(image, cam, image_ud, BLACK);
-        writeImage(dstImage, image_ud);
-      }
-      else // (no distortion)
-      {
-        // If extensions match, copy the PNG image
-        if (stlplus::extension_part(srcImage) == "PNG" ||
-          stlplus::extension_part(srcImage) == "png")
-        {
-          stlplus::file_copy(srcImage, dstImage);
-        }
-        else
-        {
-          readImage( srcImage, image);
-          writeImage( dstImage, image);
-        }
-      }
 
       // Prepare to write an MVE 'meta.ini' file for the current view
       const Pose3 pose = sfm_data.getPose(*view);
@@ -196,14 +176,76 @@ bool exportToMVE2Format(
         << rotation(1, 0) << " " << rotation(1, 1) << " " << rotation(1, 2) << "\n"
         << rotation(2, 0) << " " << rotation(2, 1) << " " << rotation(2, 2) << "\n"
         << translation[0] << " " << translation[1] << " " << translation[2] << "\n";
+    }
+
+    // Second pass, parallel: export the (calibrated) views as undistorted
+    // images and thumbnails, sharing one undistortion map per intrinsic and
+    // overlapping the PNG encoding with the asynchronous writer
+    {
+      boost::progress_display my_progress_bar(validViews.size());
+      UndistortionMapCache undistortionMapCache;
+      AsyncImageWriter writer;
+
+      #pragma omp parallel for schedule(dynamic)
+      for(int v = 0; v < static_cast<int>(validViews.size()); ++v)
+      {
+        const View * view = validViews[v];
+        const std::string & sOutViewIteratorDirectory = viewDirectories[v];
+
+        // We have a valid view with a corresponding camera & pose
+        const std::string srcImage = view->getImagePath();
+        const std::string dstImage =
+          stlplus::create_filespec(stlplus::folder_append_separator(sOutViewIteratorDirectory), "undistorted","png");
 
-      // Save a thumbnail image "thumbnail.png", 50x50 pixels
-      thumbnail = create_thumbnail(image, 50, 50);
-      const std::string dstThumbnailImage =
-        stlplus::create_filespec(stlplus::folder_append_separator(sOutViewIteratorDirectory), "thumbnail","png");
-      writeImage(dstThumbnailImage, thumbnail);
-      
-      ++view_index;
+        Intrinsics::const_iterator iterIntrinsic = sfm_data.GetIntrinsics().find(view->getIntrinsicId());
+        const IntrinsicBase * cam = iterIntrinsic->second.get();
+
+        // the thumbnail is generated from the source image in every branch
+        Image<RGBColor> image;
+        readImage(srcImage, image);
+
+        if (cam->isValid() && cam->have_disto())
+        {
+          // Undistort the image through the shared map and queue it
+          Image<RGBColor> image_ud;
+          const auto undistortionMap = undistortionMapCache.get(cam, image.Width(), image.Height());
+          UndistortImage(image, *undistortionMap, image_ud, BLACK);
+          writer.write(dstImage, std::move(image_ud));
+        }
+        else // (no distortion)
+        {
+          // If extensions match, copy the PNG image
+          if (stlplus::extension_part(srcImage) == "PNG" ||
+            stlplus::extension_part(srcImage) == "png")
+          {
+            stlplus::file_copy(srcImage, dstImage);
+          }
+          else
+          {
+            Image<RGBColor> imageCopy(image);
+            writer.write(dstImage, std::move(imageCopy));
+          }
+        }
+
+        // Save a thumbnail image "thumbnail.png", 50x50 pixels
+        Image<RGBColor> thumbnail = create_thumbnail(image, 50, 50);
+        const std::string dstThumbnailImage =
+          stlplus::create_filespec(stlplus::folder_append_separator(sOutViewIteratorDirectory), "thumbnail","png");
+        writer.write(dstThumbnailImage, std::move(thumbnail));
+
+        #pragma omp critical
+        ++my_progress_bar;
+      }
+
+      try
+      {
+        writer.waitAll();
+      }
+      catch(const std::exception& e)
+      {
+        std::cerr << "Failed to write an undistorted image: " << e.what() << std::endl;
+        bOk = false;
+      }
     }
 
     // For each feature, write to bundle:  position XYZ[0-3], color RGB[0-2], all ref.view_id & ref.feature_id
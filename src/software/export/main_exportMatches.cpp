@@ -18,8 +18,12 @@
 #include <boost/filesystem.hpp>
 #include <boost/progress.hpp>
 
+#include <cmath>
 #include <cstdlib>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 #include <fstream>
 #include <map>
@@ -61,6 +65,181 @@ void hslToRgb(float h, float s, float l,
   }
 }
 
+// Raster counterpart of feature::describerTypeColor
+image::RGBColor describerTypeRGBColor(const feature::EImageDescriberType descType)
+{
+  switch(descType)
+  {
+    case feature::EImageDescriberType::SIFT:           return image::YELLOW;
+    case feature::EImageDescriberType::SIFT_FLOAT:     return image::YELLOW;
+    case feature::EImageDescriberType::SIFT_UPRIGHT:   return image::YELLOW;
+    case feature::EImageDescriberType::AKAZE:          return image::RGBColor(128, 0, 128); // purple
+    case feature::EImageDescriberType::AKAZE_LIOP:     return image::RGBColor(128, 0, 128);
+    case feature::EImageDescriberType::AKAZE_MLDB:     return image::RGBColor(128, 0, 128);
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CCTAG)
+    case feature::EImageDescriberType::CCTAG3:         return image::BLUE;
+    case feature::EImageDescriberType::CCTAG4:         return image::BLUE;
+#endif
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_OPENCV)
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_OCVSIFT)
+    case feature::EImageDescriberType::SIFT_OCV:       return image::RGBColor(255, 165, 0); // orange
+#endif
+    case feature::EImageDescriberType::AKAZE_OCV:      return image::RGBColor(75, 0, 130); // indigo
+#endif
+
+    case feature::EImageDescriberType::UNKNOWN:        return image::RED;
+    case feature::EImageDescriberType::UNINITIALIZED:  return image::MAGENTA;
+  }
+  return image::MAGENTA;
+}
+
+/**
+ * @brief Bounded cache of the downscaled views, shared by the drawing threads.
+ * Consecutive pairs reuse the same views, so caching avoids most of the
+ * redundant image loads while the eviction keeps the memory flat on large
+ * datasets.
+ */
+class ScaledImageCache
+{
+public:
+  ScaledImageCache(int maxSideLength, std::size_t maxImages)
+    : _maxSideLength(maxSideLength)
+    , _maxImages(maxImages)
+  {}
+
+  std::shared_ptr<const image::Image<image::RGBColor>> get(IndexT viewId, const std::string& imagePath)
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      const auto it = _cache.find(viewId);
+      if(it != _cache.end())
+        return it->second;
+    }
+
+    // load outside the lock so that different views load in parallel; two
+    // threads may load the same view concurrently, the second insert wins
+    auto img = std::make_shared<image::Image<image::RGBColor>>();
+    image::readImageScaled(imagePath, _maxSideLength, *img);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if(_cache.size() >= _maxImages)
+      _cache.erase(_cache.begin());
+    _cache[viewId] = img;
+    return img;
+  }
+
+private:
+  const int _maxSideLength;
+  const std::size_t _maxImages;
+  std::mutex _mutex;
+  std::map<IndexT, std::shared_ptr<const image::Image<image::RGBColor>>> _cache;
+};
+
+/**
+ * @brief Rasterized batch export: draw every pair into a downscaled
+ * side-by-side image with the drawing primitives, in parallel across pairs,
+ * and write the results through an asynchronous writer.
+ */
+bool exportRasterMatches(const SfMData& sfmData,
+                         const feature::FeaturesPerView& featuresPerView,
+                         const matching::PairwiseMatches& pairwiseMatches,
+                         const PairSet& pairs,
+                         const std::string& outputFolder,
+                         int maxSideLength)
+{
+  const std::vector<Pair> pairVec(pairs.begin(), pairs.end());
+  ScaledImageCache cache(maxSideLength, 64);
+  image::AsyncImageWriter writer;
+  boost::progress_display myProgressBar(pairVec.size());
+
+#pragma omp parallel for schedule(dynamic)
+  for(int p = 0; p < static_cast<int>(pairVec.size()); ++p)
+  {
+    const std::size_t I = pairVec[p].first;
+    const std::size_t J = pairVec[p].second;
+
+    const View* viewI = sfmData.GetViews().at(I).get();
+    const View* viewJ = sfmData.GetViews().at(J).get();
+
+    const matching::MatchesPerDescType& filteredMatches = pairwiseMatches.at(pairVec[p]);
+    if(filteredMatches.empty())
+    {
+#pragma omp critical
+      ++myProgressBar;
+      continue;
+    }
+
+    const auto imageI = cache.get(viewI->getViewId(), viewI->getImagePath());
+    const auto imageJ = cache.get(viewJ->getViewId(), viewJ->getImagePath());
+
+    const int wI = imageI->Width(), hI = imageI->Height();
+    const int wJ = imageJ->Width(), hJ = imageJ->Height();
+    const double scaleI = static_cast<double>(wI) / viewI->getWidth();
+    const double scaleJ = static_cast<double>(wJ) / viewJ->getWidth();
+
+    image::Image<image::RGBColor> canvas(wI + wJ, std::max(hI, hJ), true, image::BLACK);
+    canvas.block(0, 0, hI, wI) = imageI->GetMat();
+    canvas.block(0, wI, hJ, wJ) = imageJ->GetMat();
+
+    std::size_t matchIndex = 0;
+    for(const auto& matchesIt: filteredMatches)
+    {
+      const feature::EImageDescriberType descType = matchesIt.first;
+      assert(descType != feature::EImageDescriberType::UNINITIALIZED);
+      const matching::IndMatches& matches = matchesIt.second;
+
+      const PointFeatures& featuresI = featuresPerView.getFeatures(viewI->getViewId(), descType);
+      const PointFeatures& featuresJ = featuresPerView.getFeatures(viewJ->getViewId(), descType);
+
+      // draw link between features
+      for(std::size_t i = 0; i < matches.size(); ++i, ++matchIndex)
+      {
+        const PointFeature& imaA = featuresI[matches[i]._i];
+        const PointFeature& imaB = featuresJ[matches[i]._j];
+
+        // flashy and deterministic colour: golden ratio hue sequence
+        unsigned char r, g, b;
+        hslToRgb(std::fmod(matchIndex * 0.618034f, 1.f), 1.f, .5f, r, g, b);
+        const image::RGBColor col(r, g, b);
+        image::DrawLineThickness(static_cast<int>(imaA.x() * scaleI), static_cast<int>(imaA.y() * scaleI),
+                                 static_cast<int>(imaB.x() * scaleJ) + wI, static_cast<int>(imaB.y() * scaleJ),
+                                 col, 2, &canvas);
+      }
+
+      // draw features over the links
+      const image::RGBColor featColor = describerTypeRGBColor(descType);
+      for(std::size_t i = 0; i < matches.size(); ++i)
+      {
+        const PointFeature& imaA = featuresI[matches[i]._i];
+        const PointFeature& imaB = featuresJ[matches[i]._j];
+        image::DrawCircle(static_cast<int>(imaA.x() * scaleI), static_cast<int>(imaA.y() * scaleI),
+                          3, featColor, &canvas);
+        image::DrawCircle(static_cast<int>(imaB.x() * scaleJ) + wI, static_cast<int>(imaB.y() * scaleJ),
+                          3, featColor, &canvas);
+      }
+    }
+
+    const fs::path outputFilename = fs::path(outputFolder) /
+      std::string(std::to_string(I) + "_" + std::to_string(J) + "_" + std::to_string(filteredMatches.getNbAllMatches()) + ".png");
+    writer.write(outputFilename.string(), std::move(canvas));
+
+#pragma omp critical
+    ++myProgressBar;
+  }
+
+  try
+  {
+    writer.waitAll();
+  }
+  catch(const std::exception& e)
+  {
+    ALICEVISION_LOG_ERROR("Failed to write a match visualization: " << e.what());
+    return false;
+  }
+  return true;
+}
+
 int main(int argc, char ** argv)
 {
   // command-line parameters
@@ -72,6 +251,8 @@ int main(int argc, char ** argv)
   std::string featuresFolder;
   std::string describerTypesName = EImageDescriberType_enumToString(EImageDescriberType::SIFT);
   std::string matchesGeometricModel = "f";
+  std::string exportFormat = "svg";
+  int rasterMaxSideLength = 1024;
 
   po::options_description allParams("AliceVision exportMatches");
 
@@ -89,12 +270,18 @@ int main(int argc, char ** argv)
   po::options_description optionalParams("Optional parameters");
   optionalParams.add_options()
     ("describerTypes,d", po::value<std::string>(&describerTypesName)->default_value(describerTypesName),
-      EImageDescriberType_informations().c_str());
+      EImageDescriberType_informations().c_str())
     ("matchesGeometricModel,g", po::value<std::string>(&matchesGeometricModel)->default_value(matchesGeometricModel),
       "Matches geometric Model :\n"
       "- f: fundamental matrix\n"
       "- e: essential matrix\n"
-      "- h: homography matrix");
+      "- h: homography matrix")
+    ("exportFormat,e", po::value<std::string>(&exportFormat)->default_value(exportFormat),
+      "Export format:\n"
+      "- svg: one vector graphics file per pair, full resolution\n"
+      "- png: rasterized downscaled images, drawn in parallel with an asynchronous writer")
+    ("rasterMaxSideLength", po::value<int>(&rasterMaxSideLength)->default_value(rasterMaxSideLength),
+      "Maximum side length of each view in the rasterized export (png format only).");
 
   po::options_description logParams("Log parameters");
   logParams.add_options()
@@ -169,11 +356,40 @@ int main(int argc, char ** argv)
     return EXIT_FAILURE;
   }
 
+  // the sidecar statistics index gives the putative counts and inlier ratios
+  // of every pair without parsing the matches files
+  matching::PairwiseMatchesStats matchesStats;
+  if(matching::LoadStats(matchesStats, {matchesFolder}))
+  {
+    std::size_t nbPutative = 0;
+    std::size_t nbGeometric = 0;
+    for(const auto& statsPair: matchesStats)
+    {
+      nbPutative += statsPair.second.nbPutativeMatches;
+      nbGeometric += statsPair.second.nbGeometricMatches;
+    }
+    ALICEVISION_LOG_INFO("Matches statistics index: " << matchesStats.size() << " pairs, "
+      << nbPutative << " putative matches, " << nbGeometric << " geometric matches"
+      << (nbPutative != 0 ? ", inlier ratio: " + std::to_string(nbGeometric / double(nbPutative)) : ""));
+  }
+
   // for each pair, export the matches
 
   fs::create_directory(outputFolder);
   ALICEVISION_LOG_INFO("Export pairwise matches");
   const PairSet pairs = matching::getImagePairs(pairwiseMatches);
+
+  if(exportFormat == "png")
+  {
+    return exportRasterMatches(sfmData, featuresPerView, pairwiseMatches, pairs, outputFolder, rasterMaxSideLength)
+      ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+  if(exportFormat != "svg")
+  {
+    ALICEVISION_LOG_ERROR("Unknown export format '" << exportFormat << "'");
+    return EXIT_FAILURE;
+  }
+
   boost::progress_display myProgressBar(pairs.size());
   for (PairSet::const_iterator iter = pairs.begin(); iter != pairs.end(); ++iter, ++myProgressBar)
   {
@@ -198,6 +414,14 @@ int main(int argc, char ** argv)
 
     ALICEVISION_LOG_INFO("nb describer: " << filteredMatches.size());
 
+    const matching::PairwiseMatchesStats::const_iterator statsIt = matchesStats.find(*iter);
+    if(statsIt != matchesStats.end() && statsIt->second.nbPutativeMatches != 0)
+    {
+      ALICEVISION_LOG_INFO("pair (" << I << ", " << J << "): "
+        << statsIt->second.nbGeometricMatches << "/" << statsIt->second.nbPutativeMatches
+        << " inliers (model '" << statsIt->second.geometricModel << "')");
+    }
+
     if(filteredMatches.empty())
       continue;
 
@@ -56,77 +56,103 @@ bool exportToPMVSFormat(
 
   if (bOk)
   {
-    boost::progress_display my_progress_bar( sfm_data.GetViews().size()*2 );
-
     // Since PMVS requires contiguous camera index, and that some views can have some missing poses,
     // we reindex the poses to ensure a contiguous pose list.
     HashMap<IndexT, IndexT> map_viewIdToContiguous;
 
-    // Export valid views as Projective Cameras:
-    for(Views::const_iterator iter = sfm_data.GetViews().begin();
-      iter != sfm_data.GetViews().end(); ++iter, ++my_progress_bar)
+    // Export valid views as Projective Cameras, buffering each projection
+    // matrix file before its single write:
+    std::vector<const View*> validViews;
     {
-      const View * view = iter->second.get();
-      if (!sfm_data.IsPoseAndIntrinsicDefined(view))
-        continue;
-
-      const Pose3 pose = sfm_data.getPose(*view);
-      Intrinsics::const_iterator iterIntrinsic = sfm_data.GetIntrinsics().find(view->getIntrinsicId());
-
-      // View Id re-indexing
-      map_viewIdToContiguous.insert(std::make_pair(view->getViewId(), map_viewIdToContiguous.size()));
-
-      // We have a valid view with a corresponding camera & pose
-      const Mat34 P = iterIntrinsic->second.get()->get_projective_equivalent(pose);
-      std::ostringstream os;
-      os << std::setw(8) << std::setfill('0') << map_viewIdToContiguous[view->getViewId()];
-      std::ofstream file(
-        stlplus::create_filespec(stlplus::folder_append_separator(sOutDirectory) + "txt",
-        os.str() ,"txt").c_str());
-      file << "CONTOUR" << os.widen('\n')
-        << P.row(0) <<"\n"<< P.row(1) <<"\n"<< P.row(2) << os.widen('\n');
-      file.close();
+      boost::progress_display my_progress_bar(sfm_data.GetViews().size());
+      for(Views::const_iterator iter = sfm_data.GetViews().begin();
+        iter != sfm_data.GetViews().end(); ++iter, ++my_progress_bar)
+      {
+        const View * view = iter->second.get();
+        if (!sfm_data.IsPoseAndIntrinsicDefined(view))
+          continue;
+
+        const Pose3 pose = sfm_data.getPose(*view);
+        Intrinsics::const_iterator iterIntrinsic = sfm_data.GetIntrinsics().find(view->getIntrinsicId());
+
+        // View Id re-indexing
+        map_viewIdToContiguous.insert(std::make_pair(view->getViewId(), map_viewIdToContiguous.size()));
+        validViews.push_back(view);
+
+        // We have a valid view with a corresponding camera & pose
+        const Mat34 P = iterIntrinsic->second.get()->get_projective_equivalent(pose);
+        std::ostringstream os;
+        os << std::setw(8) << std::setfill('0') << map_viewIdToContiguous[view->getViewId()];
+        std::ostringstream osP;
+        osP << "CONTOUR" << osP.widen('\n')
+          << P.row(0) <<"\n"<< P.row(1) <<"\n"<< P.row(2) << osP.widen('\n');
+        std::ofstream file(
+          stlplus::create_filespec(stlplus::folder_append_separator(sOutDirectory) + "txt",
+          os.str() ,"txt").c_str());
+        file << osP.str();
+        file.close();
+      }
     }
 
-    // Export (calibrated) views as undistorted images
-    Image<RGBColor> image, image_ud;
-    for(Views::const_iterator iter = sfm_data.GetViews().begin();
-      iter != sfm_data.GetViews().end(); ++iter, ++my_progress_bar)
+    // Export (calibrated) views as undistorted images, in parallel: the views
+    // sharing an intrinsic run on the same precomputed undistortion map and
+    // the encoding goes through the asynchronous writer
     {
-      const View * view = iter->second.get();
-      if (!sfm_data.IsPoseAndIntrinsicDefined(view))
-        continue;
-
-      Intrinsics::const_iterator iterIntrinsic = sfm_data.GetIntrinsics().find(view->getIntrinsicId());
-
-      // We have a valid view with a corresponding camera & pose
-      const std::string srcImage = view->getImagePath();
-      std::ostringstream os;
-      os << std::setw(8) << std::setfill('0') << map_viewIdToContiguous[view->getViewId()];
-      const std::string dstImage = stlplus::create_filespec(
-        stlplus::folder_append_separator(sOutDirectory) + "visualize", os.str(),"jpg");
+      boost::progress_display my_progress_bar(validViews.size());
+      UndistortionMapCache undistortionMapCache;
+      AsyncImageWriter writer;
 
-      const IntrinsicBase * cam = iterIntrinsic->second.get();
-      if (cam->isValid() && cam->have_disto())
+      #pragma omp parallel for schedule(dynamic)
+      for(int v = 0; v < static_cast<int>(validViews.size()); ++v)
       {
-        // undistort the image and save it
-        readImage( srcImage, image);
-        UndistortImage(image, cam, image_ud, BLACK);
-        writeImage(dstImage, image_ud);
-      }
-      else // (no distortion)
-      {
-        // copy the image if extension match
-        if (stlplus::extension_part(srcImage) == "JPG" ||
-          stlplus::extension_part(srcImage) == "jpg")
+        const View * view = validViews[v];
+        Intrinsics::const_iterator iterIntrinsic = sfm_data.GetIntrinsics().find(view->getIntrinsicId());
+
+        // We have a valid view with a corresponding camera & pose
+        const std::string srcImage = view->getImagePath();
+        std::ostringstream os;
+        os << std::setw(8) << std::setfill('0') << map_viewIdToContiguous.at(view->getViewId());
+        const std::string dstImage = stlplus::create_filespec(
+          stlplus::folder_append_separator(sOutDirectory) + "visualize", os.str(),"jpg");
+
+        const IntrinsicBase * cam = iterIntrinsic->second.get();
+        if (cam->isValid() && cam->have_disto())
         {
-          stlplus::file_copy(srcImage, dstImage);
+          // undistort the image through the shared map and queue it
+          Image<RGBColor> image, image_ud;
+          readImage( srcImage, image);
+          const auto undistortionMap = undistortionMapCache.get(cam, image.Width(), image.Height());
+          UndistortImage(image, *undistortionMap, image_ud, BLACK);
+          writer.write(dstImage, std::move(image_ud));
         }
-        else
+        else // (no distortion)
         {
-          readImage(srcImage, image);
-          writeImage(dstImage, image);
+          // copy the image if extension match
+          if (stlplus::extension_part(srcImage) == "JPG" ||
+            stlplus::extension_part(srcImage) == "jpg")
+          {
+            stlplus::file_copy(srcImage, dstImage);
+          }
+          else
+          {
+            Image<RGBColor> image;
+            readImage(srcImage, image);
+            writer.write(dstImage, std::move(image));
+          }
         }
+
+        #pragma omp critical
+        ++my_progress_bar;
+      }
+
+      try
+      {
+        writer.waitAll();
+      }
+      catch(const std::exception& e)
+      {
+        std::cerr << "Failed to write an undistorted image: " << e.what() << std::endl;
+        bOk = false;
       }
     }
 
@@ -11,6 +11,10 @@
 
 #include <stdlib.h>
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 using namespace aliceVision;
 using namespace aliceVision::camera;
 using namespace aliceVision::geometry;
@@ -93,33 +97,61 @@ int main(int argc, char *argv[])
   }
 
   // Export views as undistorted images (those with valid Intrinsics)
-  Image<RGBfColor> image, image_ud;
-  boost::progress_display my_progress_bar( sfmData.GetViews().size() );
-  for(Views::const_iterator iter = sfmData.GetViews().begin();
-    iter != sfmData.GetViews().end(); ++iter, ++my_progress_bar)
+
+  // process the views sorted by intrinsic so that all the images sharing an
+  // intrinsic run back to back on the same precomputed undistortion map
+  std::vector<const View*> views;
+  views.reserve(sfmData.GetViews().size());
+  for(Views::const_iterator iter = sfmData.GetViews().begin(); iter != sfmData.GetViews().end(); ++iter)
+    views.push_back(iter->second.get());
+  std::sort(views.begin(), views.end(),
+    [](const View* a, const View* b) { return a->getIntrinsicId() < b->getIntrinsicId(); });
+
+  UndistortionMapCache undistortionMapCache;
+  // the EXR/JPEG encoding and disk latency overlap with the remapping of the
+  // next views through the asynchronous writer
+  AsyncImageWriter writer;
+  boost::progress_display my_progress_bar(views.size());
+
+  #pragma omp parallel for schedule(dynamic)
+  for(int v = 0; v < static_cast<int>(views.size()); ++v)
   {
-    const View* view = iter->second.get();
-    bool bIntrinsicDefined = view->getIntrinsicId() != UndefinedIndexT &&
+    const View* view = views[v];
+    const bool bIntrinsicDefined = view->getIntrinsicId() != UndefinedIndexT &&
       sfmData.GetIntrinsics().find(view->getIntrinsicId()) != sfmData.GetIntrinsics().end();
 
-    Intrinsics::const_iterator iterIntrinsic = sfmData.GetIntrinsics().find(view->getIntrinsicId());
-
     const std::string srcImage = view->getImagePath();
     const std::string dstImage = stlplus::create_filespec(outDirectory, stlplus::basename_part(srcImage) + "." + image::EImageFileType_enumToString(outputFileType));
 
-    const IntrinsicBase * cam = iterIntrinsic->second.get();
-    if (cam->isValid() && cam->have_disto())
+    const IntrinsicBase* cam = bIntrinsicDefined ? sfmData.GetIntrinsics().at(view->getIntrinsicId()).get() : nullptr;
+    if (cam != nullptr && cam->isValid() && cam->have_disto())
     {
-      // undistort the image and save it
+      // undistort the image through the map shared by the intrinsic group
+      // and queue it for the background writer
+      Image<RGBfColor> image, image_ud;
       readImage(srcImage, image);
-      UndistortImage(image, cam, image_ud, FBLACK);
-      writeImage(dstImage, image_ud);
+      const auto undistortionMap = undistortionMapCache.get(cam, image.Width(), image.Height());
+      UndistortImage(image, *undistortionMap, image_ud, FBLACK);
+      writer.write(dstImage, std::move(image_ud));
     }
     else // (no distortion)
     {
       // copy the image since there is no distortion
       stlplus::file_copy(srcImage, dstImage);
     }
+
+    #pragma omp critical
+    ++my_progress_bar;
+  }
+
+  try
+  {
+    writer.waitAll();
+  }
+  catch(const std::exception& e)
+  {
+    ALICEVISION_LOG_ERROR("Failed to write an undistorted image: " << e.what());
+    return EXIT_FAILURE;
   }
 
   return EXIT_SUCCESS ;
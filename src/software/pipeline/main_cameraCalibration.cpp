@@ -15,6 +15,7 @@
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/cmdline.hpp>
 #include <aliceVision/config.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <boost/program_options.hpp>
 #include <boost/filesystem.hpp>
@@ -32,10 +33,14 @@
 #include <cstdio>
 #include <string>
 #include <cctype>
+#include <condition_variable>
+#include <deque>
 #include <fstream>
 #include <iostream>
+#include <mutex>
 #include <stdexcept>
 #include <exception>
+#include <thread>
 #include <map>
 #include <limits>
 
@@ -56,8 +61,10 @@ int main(int argc, char** argv)
   std::size_t calibGridSize = 10;
   std::size_t nbDistortionCoef = 3;
   std::size_t minInputFrames = 10;
+  std::size_t precheckDownscale = 4;
   double squareSize = 1.0;
   double maxTotalAvgErr = 0.1;
+  std::string cellIndexesCacheFile;
 
 
   po::options_description desc("\n\nThis program is used to calibrate a camera from a dataset of images.\n");
@@ -92,6 +99,10 @@ int main(int argc, char** argv)
            "Minimal number of frames to limit the refinement loop.\n")
           ("maxTotalAvgErr,e", po::value<double>(&maxTotalAvgErr)->default_value(maxTotalAvgErr),
            "Max Total Average Error.\n")
+          ("precheckDownscale", po::value<std::size_t>(&precheckDownscale)->default_value(precheckDownscale),
+           "Downscale factor of the early-reject detection pre-pass (0 or 1 to disable).\n")
+          ("cellIndexesCacheFile", po::value<std::string>(&cellIndexesCacheFile)->default_value(""),
+           "File used to cache the per-frame scoring data of the best images selection between runs (empty to disable).\n")
           ("debugRejectedImgFolder", po::value<std::string>(&debugRejectedImgFolder)->default_value(""),
            "Folder to export delete images during the refinement loop.\n")
           ("debugSelectedImgFolder,d", po::value<std::string>(&debugSelectedImgFolder)->default_value(""),
@@ -185,50 +196,150 @@ int main(int argc, char** argv)
 
   aliceVision::system::Timer durationAlgo;
   aliceVision::system::Timer duration;
-  
-  std::size_t currentFrame = 0;
-  while (feed.readImage(imageGrey, queryIntrinsics, currentImgName, hasIntrinsics))
+
+  // The frames are read serially from the feed, the pattern detection itself
+  // runs on a pool of workers fed through a bounded task queue.
+  struct DetectionTask
   {
+    std::size_t taskIndex = 0;
+    std::size_t frameNumber = 0;
     cv::Mat viewGray;
-    cv::eigen2cv(imageGrey.GetMat(), viewGray);
+  };
+
+  struct DetectionResult
+  {
+    std::size_t frameNumber = 0;
+    bool found = false;
+    std::vector<int> detectedId;
+    std::vector<cv::Point2f> pointbuf;
+  };
 
-    // Check image is correctly loaded
-    if (viewGray.size() == cv::Size(0, 0))
+  std::deque<DetectionTask> taskQueue;
+  std::mutex taskMutex;
+  std::condition_variable taskNotEmpty;
+  std::condition_variable taskNotFull;
+  bool readingDone = false;
+
+  std::map<std::size_t, DetectionResult> detectionResults; // ordered by task index
+  std::mutex resultsMutex;
+
+  const std::size_t nbDetectionThreads = std::max(1, omp_get_max_threads());
+  const std::size_t taskQueueCapacity = 2 * nbDetectionThreads;
+
+  auto detectionTask = [&]()
+  {
+    while (true)
     {
-      throw std::runtime_error(std::string("Invalid image: ") + currentImgName);
+      DetectionTask task;
+      {
+        std::unique_lock<std::mutex> lock(taskMutex);
+        while (taskQueue.empty() && !readingDone)
+          taskNotEmpty.wait(lock);
+        if (taskQueue.empty())
+          break;
+        task = std::move(taskQueue.front());
+        taskQueue.pop_front();
+      }
+      taskNotFull.notify_one();
+
+      DetectionResult result;
+      result.frameNumber = task.frameNumber;
+      try
+      {
+        // Early-reject pre-pass on a downscaled image, then find the chosen pattern
+        if (aliceVision::calibration::precheckPattern(patternType, task.viewGray, boardSize, precheckDownscale))
+          result.found = aliceVision::calibration::findPattern(patternType, task.viewGray, boardSize, result.detectedId, result.pointbuf);
+      }
+      catch (const std::exception& e)
+      {
+        ALICEVISION_CERR("Pattern detection failed on frame " << task.frameNumber << ": " << e.what());
+        result.found = false;
+      }
+
+      std::lock_guard<std::mutex> lock(resultsMutex);
+      detectionResults[task.taskIndex] = std::move(result);
     }
-    // Check image size is always the same
-    if (imageSize == cv::Size(0, 0))
+  };
+
+  std::vector<std::thread> detectionThreads;
+  for (std::size_t i = 0; i < nbDetectionThreads; ++i)
+    detectionThreads.emplace_back(detectionTask);
+
+  auto stopDetectionThreads = [&]()
+  {
     {
-      // First image: initialize the image size.
-      imageSize = viewGray.size();
+      std::lock_guard<std::mutex> lock(taskMutex);
+      readingDone = true;
     }
-    // Check image resolutions are always the same
-    else if (imageSize != viewGray.size())
+    taskNotEmpty.notify_all();
+    for (std::thread& thread : detectionThreads)
+      thread.join();
+  };
+
+  std::size_t currentFrame = 0;
+  try
+  {
+    while (feed.readImage(imageGrey, queryIntrinsics, currentImgName, hasIntrinsics))
     {
-      throw std::runtime_error(std::string("You cannot mix multiple image resolutions during the camera calibration. See image file: ") + currentImgName);
-    }
+      cv::Mat viewGray;
+      cv::eigen2cv(imageGrey.GetMat(), viewGray);
 
-    std::vector<cv::Point2f> pointbuf;
-    std::vector<int> detectedId;
-    ALICEVISION_CERR("[" << currentFrame << "/" << nbFrames << "] (" << iInputFrame << "/" << nbFramesToProcess << ")");
+      // Check image is correctly loaded
+      if (viewGray.size() == cv::Size(0, 0))
+      {
+        throw std::runtime_error(std::string("Invalid image: ") + currentImgName);
+      }
+      // Check image size is always the same
+      if (imageSize == cv::Size(0, 0))
+      {
+        // First image: initialize the image size.
+        imageSize = viewGray.size();
+      }
+      // Check image resolutions are always the same
+      else if (imageSize != viewGray.size())
+      {
+        throw std::runtime_error(std::string("You cannot mix multiple image resolutions during the camera calibration. See image file: ") + currentImgName);
+      }
 
-    // Find the chosen pattern in images
-    const bool found = aliceVision::calibration::findPattern(patternType, viewGray, boardSize, detectedId, pointbuf);
-    
-    if (found)
-    {
-      validFrames.push_back(currentFrame);
-      detectedIdPerFrame.push_back(detectedId);
-      imagePoints.push_back(pointbuf);
+      ALICEVISION_CERR("[" << currentFrame << "/" << nbFrames << "] (" << iInputFrame << "/" << nbFramesToProcess << ")");
+
+      {
+        std::unique_lock<std::mutex> lock(taskMutex);
+        while (taskQueue.size() >= taskQueueCapacity)
+          taskNotFull.wait(lock);
+        DetectionTask task;
+        task.taskIndex = iInputFrame;
+        task.frameNumber = currentFrame;
+        task.viewGray = viewGray;
+        taskQueue.push_back(std::move(task));
+      }
+      taskNotEmpty.notify_one();
+
+      ++iInputFrame;
+      currentFrame = std::floor(iInputFrame * step);
+      feed.goToFrame(currentFrame);
     }
+  }
+  catch (...)
+  {
+    stopDetectionThreads();
+    throw;
+  }
+  stopDetectionThreads();
 
-    ++iInputFrame;
-    currentFrame = std::floor(iInputFrame * step);
-    feed.goToFrame(currentFrame);
+  // Collect the detections in input frame order
+  for (const auto& indexedResult : detectionResults)
+  {
+    const DetectionResult& result = indexedResult.second;
+    if (result.found)
+    {
+      validFrames.push_back(result.frameNumber);
+      detectedIdPerFrame.push_back(result.detectedId);
+      imagePoints.push_back(result.pointbuf);
+    }
   }
 
-  
+
   ALICEVISION_CERR("find points duration: " << aliceVision::system::prettyTime(duration.elapsedMs()));
   ALICEVISION_CERR("Grid detected in " << imagePoints.size() << " images on " << iInputFrame << " input images.");
 
@@ -241,10 +352,18 @@ int main(int argc, char** argv)
   std::vector<std::vector<cv::Point2f> > calibImagePoints;
 
   // Select best images based on repartition in images of the calibration landmarks
+  aliceVision::calibration::CellIndexesCache cellIndexesCache;
+  if (!cellIndexesCacheFile.empty())
+    cellIndexesCache.load(cellIndexesCacheFile); // a miss only costs the recomputation
+
   aliceVision::calibration::selectBestImages(
       imagePoints, imageSize, maxCalibFrames, calibGridSize,
       calibImageScore, calibInputFrames, calibImagePoints,
-      remainingImagesIndexes);
+      remainingImagesIndexes,
+      cellIndexesCacheFile.empty() ? nullptr : &cellIndexesCache);
+
+  if (!cellIndexesCacheFile.empty() && !cellIndexesCache.save(cellIndexesCacheFile))
+    ALICEVISION_CERR("Warning: unable to save the cell indexes cache file: " << cellIndexesCacheFile);
 
   start = std::clock();
   // Create an object which stores all the checker points of the images
@@ -9,6 +9,7 @@
 #include <aliceVision/sensorDB/parseDatabase.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/cmdline.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <dependencies/stlplus3/filesystemSimplified/file_system.hpp>
 
@@ -287,6 +288,8 @@ int main(int argc, char **argv)
       return EXIT_FAILURE;
     }
   }
+  // hashed index for the per view lookups
+  const sensorDB::DatasheetIndex sensorDatabaseIndex(sensorDatabase);
 
   // use current time as seed for random generator for intrinsic Id without metadata
   std::srand(std::time(0));
@@ -315,14 +318,27 @@ int main(int argc, char **argv)
     {
       std::vector<View> incompleteViews(imagePaths.size());
 
-      #pragma omp parallel for
+      // metadata cache, makes the pass free on re-runs over unchanged images
+      const std::string metadataCacheFilePath =
+        stlplus::create_filespec(stlplus::folder_part(outputFilePath), "imageMetadata.cache.json");
+      sfm::ImageMetadataCache metadataCache;
+      metadataCache.load(metadataCacheFilePath);
+
+      // the pass is I/O bound (one header read per image), oversubscribe the
+      // cores so the threads can wait on the storage concurrently
+      const int nbIoThreads = std::min(64, 8 * omp_get_max_threads());
+
+      #pragma omp parallel for schedule(dynamic) num_threads(nbIoThreads)
       for(int i = 0; i < incompleteViews.size(); ++i)
       {
         View& view = incompleteViews.at(i);
         view.setImagePath(imagePaths.at(i));
-        sfm::updateIncompleteView(view);
+        sfm::updateIncompleteView(view, &metadataCache);
       }
 
+      if(!metadataCache.save(metadataCacheFilePath))
+        ALICEVISION_LOG_WARNING("Warning: Can't write the metadata cache file '" << metadataCacheFilePath << "'.");
+
       for(const auto& view : incompleteViews)
         views.emplace(view.getViewId(), std::make_shared<View>(view));
     }
@@ -365,7 +381,7 @@ int main(int argc, char **argv)
     if(hasCameraMetadata)
     {
       aliceVision::sensorDB::Datasheet datasheet;
-      if(getInfo(view.getMetadata("Make"), view.getMetadata("Model"), sensorDatabase, datasheet))
+      if(sensorDatabaseIndex.getInfo(view.getMetadata("Make"), view.getMetadata("Model"), datasheet))
         sensorWidth = datasheet._sensorSize;
       else
       {
@@ -36,6 +36,13 @@
 #include <vector>
 #include <chrono>
 #include <memory>
+#include <sstream>
+#include <cstring>
+#include <cerrno>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
 
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ALEMBIC)
 #include <aliceVision/sfm/AlembicExporter.hpp>
@@ -97,6 +104,254 @@ bool checkRobustEstimator(robustEstimation::ERobustEstimator e, double &value)
   return true;
 }
 
+/**
+ * @brief Localize every frame of a media with an already initialized localizer
+ * and save the raw localization results. Used by the daemon mode, where the
+ * scene loading has been paid once at startup.
+ *
+ * @param[in,out] localizer The resident localizer; its sequence state is reset
+ * before the first frame, as consecutive requests are unrelated takes.
+ * @param[in] param The localization parameters.
+ * @param[in] mediaFilepath The media (image, image sequence, video) to localize.
+ * @param[in] calibFile Optional calibration file for the media.
+ * @param[in] outputBin Filename for the localization results (raw data) as .bin.
+ * @param[out] nbLocalized Number of successfully localized frames.
+ * @param[out] nbFrames Number of processed frames.
+ * @param[out] errorMessage Filled with the failure reason when returning false.
+ * @return true if the media could be opened and processed.
+ */
+bool localizeMediaForDaemon(localization::ILocalizer *localizer,
+                            const localization::LocalizerParameters *param,
+                            const std::string &mediaFilepath,
+                            const std::string &calibFile,
+                            const std::string &outputBin,
+                            std::size_t &nbLocalized,
+                            std::size_t &nbFrames,
+                            std::string &errorMessage)
+{
+  nbLocalized = 0;
+  nbFrames = 0;
+  try
+  {
+    dataio::FeedProvider feed(mediaFilepath, calibFile);
+    if(!feed.isInit())
+    {
+      errorMessage = "cannot open the media " + mediaFilepath;
+      return false;
+    }
+
+    // each request is an unrelated take, start from a clean sequence state
+    localizer->resetSequence();
+
+    image::Image<unsigned char> imageGrey;
+    camera::PinholeRadialK3 queryIntrinsics;
+    bool hasIntrinsics = false;
+    std::string currentImgName;
+    std::vector<localization::LocalizationResult> vec_localizationResults;
+
+    while(feed.readImage(imageGrey, queryIntrinsics, currentImgName, hasIntrinsics))
+    {
+      localization::LocalizationResult localizationResult;
+      localizer->localize(imageGrey,
+                          param,
+                          hasIntrinsics /*useInputIntrinsics*/,
+                          queryIntrinsics,
+                          localizationResult,
+                          currentImgName);
+      vec_localizationResults.emplace_back(localizationResult);
+      if(localizationResult.isValid())
+        ++nbLocalized;
+      ++nbFrames;
+      feed.goToNextFrame();
+    }
+
+    localization::save(vec_localizationResults, outputBin);
+  }
+  catch(const std::exception &e)
+  {
+    errorMessage = e.what();
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Serve localization requests over a local unix socket, keeping the
+ * localizer (SfMData, regions, vocabulary tree and database) resident, so
+ * short clips and interactive sessions skip the scene initialization.
+ *
+ * The protocol is one request line per connection, fields separated by tabs:
+ *   LOCALIZE \t mediaFile [\t calibFile [\t outputBin]]
+ *   PING
+ *   QUIT
+ * and the reply is a single line: "OK \t nbLocalized/nbFrames \t outputBin",
+ * "PONG", "BYE" or "ERROR \t message". When no outputBin is given the results
+ * are saved as <mediaFile>.localization.bin.
+ */
+int runLocalizationDaemon(localization::ILocalizer *localizer,
+                          const localization::LocalizerParameters *param,
+                          const std::string &socketPath)
+{
+  // remove a possibly stale socket from a previous run
+  ::unlink(socketPath.c_str());
+
+  const int server = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if(server < 0)
+  {
+    ALICEVISION_CERR("ERROR: cannot create the daemon socket: " << strerror(errno));
+    return EXIT_FAILURE;
+  }
+
+  sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if(socketPath.size() >= sizeof(address.sun_path))
+  {
+    ALICEVISION_CERR("ERROR: socket path too long: " << socketPath);
+    ::close(server);
+    return EXIT_FAILURE;
+  }
+  std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+  if(::bind(server, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+     ::listen(server, 4) < 0)
+  {
+    ALICEVISION_CERR("ERROR: cannot bind the daemon socket " << socketPath
+                     << ": " << strerror(errno));
+    ::close(server);
+    return EXIT_FAILURE;
+  }
+
+  ALICEVISION_COUT("Localization daemon ready on " << socketPath);
+
+  bool running = true;
+  while(running)
+  {
+    const int client = ::accept(server, NULL, NULL);
+    if(client < 0)
+      continue;
+
+    // read the request line
+    std::string request;
+    char c;
+    while(::read(client, &c, 1) == 1 && c != '\n')
+      request.push_back(c);
+
+    // split the tab-separated fields
+    std::vector<std::string> fields;
+    std::stringstream ss(request);
+    std::string field;
+    while(std::getline(ss, field, '\t'))
+      fields.push_back(field);
+
+    std::string reply;
+    if(fields.empty())
+    {
+      reply = "ERROR\tempty request";
+    }
+    else if(fields[0] == "PING")
+    {
+      reply = "PONG";
+    }
+    else if(fields[0] == "QUIT")
+    {
+      reply = "BYE";
+      running = false;
+    }
+    else if(fields[0] == "LOCALIZE" && fields.size() >= 2)
+    {
+      const std::string &mediaFilepath = fields[1];
+      const std::string calibFile = (fields.size() > 2) ? fields[2] : std::string();
+      const std::string outputBin = (fields.size() > 3 && !fields[3].empty()) ?
+          fields[3] : mediaFilepath + ".localization.bin";
+
+      ALICEVISION_COUT("Localizing " << mediaFilepath);
+      std::size_t nbLocalized = 0;
+      std::size_t nbFrames = 0;
+      std::string errorMessage;
+      if(localizeMediaForDaemon(localizer, param, mediaFilepath, calibFile,
+                                outputBin, nbLocalized, nbFrames, errorMessage))
+      {
+        ALICEVISION_COUT("Localized " << nbLocalized << "/" << nbFrames << " images");
+        reply = "OK\t" + std::to_string(nbLocalized) + "/" + std::to_string(nbFrames)
+                + "\t" + outputBin;
+      }
+      else
+      {
+        ALICEVISION_CERR("Localization request failed: " << errorMessage);
+        reply = "ERROR\t" + errorMessage;
+      }
+    }
+    else
+    {
+      reply = "ERROR\tunknown command";
+    }
+
+    reply += '\n';
+    if(::write(client, reply.c_str(), reply.size()) < 0)
+      ALICEVISION_CERR("WARNING: cannot send the reply: " << strerror(errno));
+    ::close(client);
+  }
+
+  ::close(server);
+  ::unlink(socketPath.c_str());
+  return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Send a LOCALIZE request for a media to an already running daemon and
+ * print its reply, skipping any scene loading in this process.
+ */
+int queryLocalizationDaemon(const std::string &socketPath,
+                            const std::string &mediaFilepath,
+                            const std::string &calibFile,
+                            const std::string &outputBin)
+{
+  const int client = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if(client < 0)
+  {
+    ALICEVISION_CERR("ERROR: cannot create the socket: " << strerror(errno));
+    return EXIT_FAILURE;
+  }
+
+  sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if(socketPath.size() >= sizeof(address.sun_path))
+  {
+    ALICEVISION_CERR("ERROR: socket path too long: " << socketPath);
+    ::close(client);
+    return EXIT_FAILURE;
+  }
+  std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+  if(::connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0)
+  {
+    ALICEVISION_CERR("ERROR: cannot connect to the daemon on " << socketPath
+                     << ": " << strerror(errno) << ". Is the daemon running?");
+    ::close(client);
+    return EXIT_FAILURE;
+  }
+
+  const std::string request = "LOCALIZE\t" + mediaFilepath + "\t" + calibFile
+                              + "\t" + outputBin + "\n";
+  if(::write(client, request.c_str(), request.size()) < 0)
+  {
+    ALICEVISION_CERR("ERROR: cannot send the request: " << strerror(errno));
+    ::close(client);
+    return EXIT_FAILURE;
+  }
+
+  std::string reply;
+  char c;
+  while(::read(client, &c, 1) == 1 && c != '\n')
+    reply.push_back(c);
+  ::close(client);
+
+  ALICEVISION_COUT(reply);
+  return (reply.compare(0, 2, "OK") == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
 int main(int argc, char** argv)
 {
   /// the calibration file
@@ -145,6 +400,7 @@ int main(int argc, char** argv)
   /// enable/disable the robust matching (geometric validation) when matching query image
   /// and databases images
   bool robustMatching = true;
+  bool useMotionPrior = false;
   
   /// the Alembic export file
   std::string exportAlembicFile = "trackedcameras.abc";
@@ -165,10 +421,19 @@ int main(int argc, char** argv)
   /// remove the points that does not have a minimum visibility over the sequence
   /// ie that are seen at least by minPointVisibility frames of the sequence
   std::size_t minPointVisibility = 0;
-  
+  /// if > 0 refine the sequence with overlapping windows of this many frames
+  std::size_t bundleWindowSize = 0;
+  /// number of boundary frames shared by two consecutive windows
+  std::size_t bundleWindowOverlap = 50;
+
   /// whether to save visual debug info
   std::string visualDebug = "";
 
+  /// if not empty, run as a daemon serving localization requests on this socket
+  std::string daemonSocket;
+  /// send the media to an already running daemon instead of localizing here
+  bool daemonQuery = false;
+
   po::options_description allParams(
       "This program takes as input a media (image, image sequence, video) and a database (vocabulary tree, 3D scene data) \n"
       "and returns for each frame a pose estimation for the camera.");
@@ -176,11 +441,26 @@ int main(int argc, char** argv)
   po::options_description inputParams("Required input parameters");
   
   inputParams.add_options()
-      ("sfmdata", po::value<std::string>(&sfmFilePath)->required(), 
-          "The sfm_data.json kind of file generated by AliceVision.")
-      ("mediafile", po::value<std::string>(&mediaFilepath)->required(), 
-          "The folder path or the filename for the media to track");
-  
+      ("sfmdata", po::value<std::string>(&sfmFilePath),
+          "The sfm_data.json kind of file generated by AliceVision. "
+          "Required, except with --daemonQuery.")
+      ("mediafile", po::value<std::string>(&mediaFilepath),
+          "The folder path or the filename for the media to track. "
+          "Required, except when running as a daemon.");
+
+  po::options_description daemonParams(
+      "Parameters for the daemon mode: a resident localizer keeping the scene "
+      "loaded and serving localization requests over a local socket");
+  daemonParams.add_options()
+      ("daemonSocket", po::value<std::string>(&daemonSocket),
+          "Path of the local unix socket. Without --daemonQuery the program "
+          "loads the scene once and serves LOCALIZE requests on this socket; "
+          "with --daemonQuery it sends --mediafile to an already running "
+          "daemon, skipping any scene loading.")
+      ("daemonQuery", po::value<bool>(&daemonQuery)->default_value(daemonQuery),
+          "Send the media to the daemon listening on --daemonSocket and print "
+          "its reply instead of localizing in this process.");
+
   po::options_description commonParams(
       "Common optional parameters for the localizer");
   commonParams.add_options()
@@ -229,9 +509,13 @@ int main(int argc, char** argv)
       ("nbFrameBufferMatching", po::value<std::size_t>(&nbFrameBufferMatching)->default_value(nbFrameBufferMatching),
           "[voctree] Number of previous frame of the sequence to use for matching "
           "(0 = Disable)")
-      ("robustMatching", po::value<bool>(&robustMatching)->default_value(robustMatching), 
+      ("robustMatching", po::value<bool>(&robustMatching)->default_value(robustMatching),
           "[voctree] Enable/Disable the robust matching between query and database images, "
           "all putative matches will be considered.")
+      ("useMotionPrior", po::value<bool>(&useMotionPrior)->default_value(useMotionPrior),
+          "[voctree] During sequence tracking, select the candidate views from the "
+          "frustum of the last localized pose instead of querying the vocabulary "
+          "tree, falling back to the voctree retrieval on tracking loss.")
 // cctag specific options
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CCTAG)
       ("nNearestKeyFrames", po::value<size_t>(&nNearestKeyFrames)->default_value(nNearestKeyFrames), 
@@ -250,9 +534,16 @@ int main(int argc, char** argv)
           "the BA, it consider the distortion coefficients all equal to 0")
       ("noBArefineIntrinsics", po::value<bool>(&noBArefineIntrinsics), 
           "[bundle adjustment] It does not refine intrinsics during BA")
-      ("minPointVisibility", po::value<size_t>(&minPointVisibility)->default_value(minPointVisibility), 
+      ("minPointVisibility", po::value<size_t>(&minPointVisibility)->default_value(minPointVisibility),
           "[bundle adjustment] Minimum number of observation that a point must "
-          "have in order to be considered for bundle adjustment");
+          "have in order to be considered for bundle adjustment")
+      ("bundleWindowSize", po::value<size_t>(&bundleWindowSize)->default_value(bundleWindowSize),
+          "[bundle adjustment] If > 0, refine the sequence with overlapping "
+          "windows of this many frames instead of one problem over the whole "
+          "sequence, bounding the peak memory for long captures")
+      ("bundleWindowOverlap", po::value<size_t>(&bundleWindowOverlap)->default_value(bundleWindowOverlap),
+          "[bundle adjustment] Number of boundary frames shared by two "
+          "consecutive windows when --bundleWindowSize is used");
   
 // output options
   po::options_description outputParams("Options for the output of the localizer");
@@ -272,7 +563,7 @@ int main(int argc, char** argv)
 
       ;
   
-  allParams.add(inputParams).add(outputParams).add(commonParams).add(voctreeParams).add(bundleParams);
+  allParams.add(inputParams).add(outputParams).add(commonParams).add(voctreeParams).add(bundleParams).add(daemonParams);
 
   po::variables_map vm;
 
@@ -301,7 +592,31 @@ int main(int argc, char** argv)
     return EXIT_FAILURE;
   }
   
-  if(!checkRobustEstimator(matchingEstimator, matchingErrorMax) || 
+  // client mode: hand the media over to a running daemon, nothing to load here
+  if(daemonQuery)
+  {
+    if(daemonSocket.empty() || mediaFilepath.empty())
+    {
+      ALICEVISION_CERR("ERROR: --daemonQuery requires --daemonSocket and --mediafile." << std::endl);
+      return EXIT_FAILURE;
+    }
+    return queryLocalizationDaemon(daemonSocket, mediaFilepath, calibFile, exportBinaryFile);
+  }
+
+  if(sfmFilePath.empty())
+  {
+    ALICEVISION_CERR("ERROR: the option '--sfmdata' is required." << std::endl);
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+  if(daemonSocket.empty() && mediaFilepath.empty())
+  {
+    ALICEVISION_CERR("ERROR: the option '--mediafile' is required." << std::endl);
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+
+  if(!checkRobustEstimator(matchingEstimator, matchingErrorMax) ||
      !checkRobustEstimator(resectionEstimator, resectionErrorMax))
   {
     return EXIT_FAILURE;
@@ -390,6 +705,7 @@ int main(int argc, char** argv)
     tmpParam->_matchingError = matchingErrorMax;
     tmpParam->_nbFrameBufferMatching = nbFrameBufferMatching;
     tmpParam->_useRobustMatching = robustMatching;
+    tmpParam->_useMotionPrior = useMotionPrior;
   }
   
   assert(localizer);
@@ -409,7 +725,13 @@ int main(int argc, char** argv)
     ALICEVISION_CERR("ERROR while initializing the localizer!");
     return EXIT_FAILURE;
   }
-  
+
+  // daemon mode: keep the loaded scene resident and serve requests until QUIT
+  if(!daemonSocket.empty())
+  {
+    return runLocalizationDaemon(localizer.get(), param.get(), daemonSocket);
+  }
+
   // create the feedProvider
   dataio::FeedProvider feed(mediaFilepath, calibFile);
   if(!feed.isInit())
@@ -502,14 +824,24 @@ int main(int argc, char** argv)
     const bool b_allTheSame = true;
     const bool b_refineStructure = false;
     const bool b_refinePose = true;
-    const bool BAresult = localization::refineSequence(vec_localizationResults,
-                                                       b_allTheSame, 
-                                                       !noBArefineIntrinsics, 
-                                                       noDistortion, 
-                                                       b_refinePose,
-                                                       b_refineStructure,
-                                                       basenameBinary + ".sfmdata.BUNDLE",
-                                                       minPointVisibility);
+    const bool BAresult = (bundleWindowSize > 0) ?
+        localization::refineSequenceSlidingWindow(vec_localizationResults,
+                                                  bundleWindowSize,
+                                                  bundleWindowOverlap,
+                                                  b_allTheSame,
+                                                  !noBArefineIntrinsics,
+                                                  noDistortion,
+                                                  b_refinePose,
+                                                  basenameBinary + ".sfmdata.BUNDLE",
+                                                  minPointVisibility) :
+        localization::refineSequence(vec_localizationResults,
+                                     b_allTheSame,
+                                     !noBArefineIntrinsics,
+                                     noDistortion,
+                                     b_refinePose,
+                                     b_refineStructure,
+                                     basenameBinary + ".sfmdata.BUNDLE",
+                                     minPointVisibility);
     if(!BAresult)
     {
       ALICEVISION_CERR("Bundle Adjustment failed!");
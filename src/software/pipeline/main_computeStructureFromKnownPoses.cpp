@@ -141,9 +141,18 @@ int main(int argc, char **argv)
       return EXIT_FAILURE;
 
     pairs = matching::getImagePairs(matches);
-    // Keep only Pairs that belong to valid view indexes.
-    const std::set<IndexT> valid_viewIdx = sfm_data.getValidViews();
-    pairs = Pair_filter(pairs, valid_viewIdx);
+    // Keep only Pairs that belong to valid view indexes, checking each view
+    // directly instead of materializing the valid view index set.
+    PairSet validPairs;
+    for(const Pair& pair : pairs)
+    {
+      if(sfm_data.GetViews().count(pair.first) &&
+         sfm_data.GetViews().count(pair.second) &&
+         sfm_data.IsPoseAndIntrinsicDefined(pair.first) &&
+         sfm_data.IsPoseAndIntrinsicDefined(pair.second))
+        validPairs.insert(pair);
+    }
+    pairs.swap(validPairs);
   }
 
   aliceVision::system::Timer timer;
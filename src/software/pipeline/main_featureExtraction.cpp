@@ -4,27 +4,41 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include <aliceVision/config.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 #include <aliceVision/image/all.hpp>
 #include <aliceVision/sfm/sfm.hpp>
 #include <aliceVision/feature/imageDescriberCommon.hpp>
 #include <aliceVision/feature/feature.hpp>
+#include <aliceVision/feature/presetSelection.hpp>
+#include <aliceVision/feature/RegionsPack.hpp>
+#include <aliceVision/feature/SharedRegionsStore.hpp>
 #include <aliceVision/system/Timer.hpp>
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/MemoryGovernor.hpp>
+#include <aliceVision/system/TaskScheduler.hpp>
+#include <aliceVision/system/TuningProfile.hpp>
 #include <aliceVision/system/cmdline.hpp>
 
 #include <dependencies/stlplus3/filesystemSimplified/file_system.hpp>
 
-#include <boost/progress.hpp>
+#include <aliceVision/system/ProgressReporter.hpp>
 #include <boost/program_options.hpp>
 
 #include <cereal/archives/json.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <map>
 #include <cstdlib>
+#include <deque>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <functional>
 #include <limits>
+#include <mutex>
+#include <thread>
 
 using namespace aliceVision;
 using namespace aliceVision::image;
@@ -33,174 +47,100 @@ using namespace aliceVision::sfm;
 using namespace std;
 namespace po = boost::program_options;
 
-// ----------
-// Dispatcher
-// ----------
-
-#ifdef __linux__
-#include <unistd.h>
-#include <sys/wait.h>
-
-// Returns a map containing information about the memory usage o
-// of the system, it basically reads /proc/meminfo  
-std::map<std::string, unsigned long> memInfos()
+// ------------------
+// Streaming pipeline
+// ------------------
+// The extraction is organized as a 3 stage producer/consumer pipeline:
+//   [decode threads] -> decoded image queue -> [describer stage] -> save queue -> [writer thread]
+// so that image loading, description and regions serialization overlap
+// instead of being serialized per view.
+
+/// Blocking bounded FIFO connecting two pipeline stages.
+template<class T>
+class JobQueue
 {
-  std::map<std::string, unsigned long> memoryInfos;
-  std::ifstream meminfoFile("/proc/meminfo");
-  if (meminfoFile.is_open())
-  {
-    std::string line;
-    while(getline(meminfoFile, line))
-    {
-      auto separator = line.find(":"); 
-      if (separator!=std::string::npos)
-      {
-        const std::string key = line.substr(0, separator);
-        const std::string value = line.substr(separator+1);
-        memoryInfos[key] = std::strtoul(value.c_str(), nullptr, 10);
-      }
-    }
-  }
-  return memoryInfos;
-}
+public:
+  explicit JobQueue(std::size_t maxSize)
+    : _maxSize(std::max<std::size_t>(maxSize, 1))
+  {}
 
-
-// Count the number of processors of the machine using /proc/cpuinfo
-unsigned int countProcessors()
-{
-  unsigned int nprocessors = 0;
-  std::ifstream cpuinfoFile("/proc/cpuinfo");
-  if (cpuinfoFile.is_open())
+  /// Blocks while the queue is full, returns false if the queue has been closed.
+  bool push(T&& item)
   {
-    std::string line;
-    while(getline(cpuinfoFile, line))
-    {
-        // The line must start with the word "processor"
-        if (line.compare(0, std::strlen("processor"), "processor") == 0)
-            nprocessors++;
-    }
+    std::unique_lock<std::mutex> lock(_mutex);
+    _notFull.wait(lock, [this]{ return _queue.size() < _maxSize || _closed; });
+    if(_closed)
+      return false;
+    _queue.emplace_back(std::move(item));
+    _notEmpty.notify_one();
+    return true;
   }
-  return nprocessors; 
-}
-
-// Returns the number of jobs to run simultaneously if one job should 
-// run with jobMemoryRequirement Kb 
-int remainingJobSlots(unsigned long jobMemoryRequirement)
-{
-  assert(jobMemoryRequirement!=0);
-  auto meminfos = memInfos();
-  const unsigned long available = meminfos["MemFree"] + meminfos["Buffers"] + meminfos["Cached"]; 
-  const unsigned int memSlots = static_cast<unsigned int>(available/jobMemoryRequirement); 
-  const unsigned int cpuSlots = countProcessors(); 
-  return std::max(std::min(memSlots, cpuSlots), 1u);
-}
 
-// Returns the peak virtual memory of the process processID
-// returns 0 if the process is not alive anymore, ie the 
-// /proc/pid/status can't be opened
-unsigned long peakMemory(pid_t processID)
-{  
-  char processStatusFileName[256];
-  snprintf(processStatusFileName, 256, "/proc/%d/status", processID);
-  std::ifstream processStatusFile(processStatusFileName);
-  if (processStatusFile.is_open())
+  /// Blocks while the queue is empty, returns false once closed and drained.
+  bool pop(T& item)
   {
-    std::string line;
-    constexpr const char *peakString = "VmPeak:";
-    constexpr size_t peakStringLen = std::strlen(peakString);
-    while(getline(processStatusFile, line))
-    {
-      if (line.compare(0, peakStringLen, peakString) == 0)
-      {
-        const std::string value = line.substr(peakStringLen);
-        return std::strtoul(value.c_str(), nullptr, 10);  
-      }
-    }
+    std::unique_lock<std::mutex> lock(_mutex);
+    _notEmpty.wait(lock, [this]{ return !_queue.empty() || _closed; });
+    if(_queue.empty())
+      return false;
+    item = std::move(_queue.front());
+    _queue.pop_front();
+    _notFull.notify_one();
+    return true;
   }
-  return 0ul;
-}
 
-// This function dispatch the compute function on several sub processes
-// keeping the maximum number of subprocesses under maxJobs
-void dispatch(const int maxJobs, std::function<void()> compute)
-{
-  static int nbJobs;
-  static unsigned int subProcessPeakMemory = 0;
-  static int possibleJobs=0;
-  pid_t pid = fork();
-  if (pid < 0)           
-  {                      
-    // Something bad happened
-    std::cerr << "fork failed\n";
-    _exit(EXIT_FAILURE);
-  }
-  else if(pid == 0)
+  /// Non-blocking pop, returns false if the queue is currently empty.
+  bool tryPop(T& item)
   {
-    // Disable OpenMP as we dispatch the work on multiple sub processes
-    // and we don't want that each subprocess use all the cpu ressource
-    omp_set_num_threads(1); 
-    compute();
-    _exit(EXIT_SUCCESS);
+    std::lock_guard<std::mutex> lock(_mutex);
+    if(_queue.empty())
+      return false;
+    item = std::move(_queue.front());
+    _queue.pop_front();
+    _notFull.notify_one();
+    return true;
   }
-  else 
+
+  /// No more push will be accepted, pending items can still be popped.
+  void close()
   {
-    nbJobs++;
-    // Use subprocess peak memory and assume the next job will use the 
-    // same amount of memory. It allows to roughly determine the number 
-    // of possible jobs running simultaneously
-    if (subProcessPeakMemory==0)
-    {
-      unsigned int readPeak = peakMemory(pid);
-      while(readPeak != 0) 
-      { // sample memory of the first job 
-        sleep(0.2); // sample every 0.2 seconds;
-        if( subProcessPeakMemory < readPeak )
-        {
-          subProcessPeakMemory = readPeak;
-        }  
-        readPeak = peakMemory(pid);
-      } 
-      possibleJobs = remainingJobSlots(subProcessPeakMemory);
-    }
-    
-    // Wait for a subprocess to stop when no more job slots are available
-    if (nbJobs >= possibleJobs || (maxJobs != 0 && nbJobs >= maxJobs))
-    {
-      pid_t pids;
-      while(pids = waitpid(-1, NULL, 0)) 
-      {
-        nbJobs--;
-        break;
-      }
-    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    _closed = true;
+    _notEmpty.notify_all();
+    _notFull.notify_all();
   }
-}
 
-// Waits for all subprocesses to terminate 
-void waitForCompletion()
+private:
+  std::deque<T> _queue;
+  std::mutex _mutex;
+  std::condition_variable _notEmpty;
+  std::condition_variable _notFull;
+  std::size_t _maxSize;
+  bool _closed = false;
+};
+
+/// Compute the number of decoded images that can be buffered ahead of the
+/// describer stage within the process memory budget.
+std::size_t computeDecodeQueueSize(const SfMData& sfmData)
 {
-  pid_t pids;
-  while(pids = waitpid(-1, NULL, 0)) 
+  // Estimate the decoded size of the biggest view (float gray buffer),
+  // fallback to a 36 Mpix estimate when the view size is unknown.
+  std::size_t maxImageSize = 0;
+  for(const auto& viewPair : sfmData.GetViews())
   {
-    if (errno == ECHILD)
-        break;
+    const View& view = *viewPair.second;
+    maxImageSize = std::max(maxImageSize, view.getWidth() * view.getHeight() * sizeof(float));
   }
+  if(maxImageSize == 0)
+    maxImageSize = std::size_t(36000000) * sizeof(float);
+
+  // Ask the memory governor how many decoded images fit in the headroom,
+  // leaving half of it for the describers themselves.
+  const std::size_t queueSize =
+      system::MemoryGovernor::instance().recommendedBatchSize(maxImageSize * 2, 16);
+  return std::max<std::size_t>(queueSize, 2);
 }
 
-
-#else // __linux__
-
-void dispatch(const int maxJobs, std::function<void()> compute)
-{
-  if(maxJobs != 0)
-    omp_set_num_threads(maxJobs);
-  compute();
-}
-void waitForCompletion() {}
-int remainingJobSlots(unsigned long jobMemoryRequirement) {return 1;}  
-
-#endif // __linux__
-
 /// - Compute view image description (feature & descriptor extraction)
 /// - Export computed data
 int main(int argc, char **argv)
@@ -216,8 +156,13 @@ int main(int argc, char **argv)
   std::string describerTypesName = EImageDescriberType_enumToString(EImageDescriberType::SIFT);
   std::string describerPreset = EImageDescriberPreset_enumToString(EImageDescriberPreset::NORMAL);
   bool describersAreUpRight = false;
+  bool adaptivePreset = false;
   int rangeStart = -1;
   int rangeSize = 1;
+  bool writePackFiles = false;
+  bool preFilterGrid = false;
+  std::string sharedRegionsStoreName;
+  std::string tuningProfileFilepath;
   int maxJobs = 0;
 
   po::options_description allParams("AliceVision featureExtraction");
@@ -237,13 +182,34 @@ int main(int argc, char **argv)
       "Control the ImageDescriber configuration (low, medium, normal, high, ultra).\n"
       "Configuration 'ultra' can take long time !")
     ("upright,u", po::value<bool>(&describersAreUpRight)->default_value(describersAreUpRight),
-      "Use Upright feature.")
+      "Use Upright feature (skip the orientation estimation, SIFT descriptors are exported as SIFT_UPRIGHT).")
+    ("adaptivePreset", po::value<bool>(&adaptivePreset)->default_value(adaptivePreset),
+      "Select the describer preset per image from a cheap downscaled saliency probe, using\n"
+      "'--describerPreset' as the ceiling: texture-poor images are extracted with a lighter\n"
+      "preset (and keypoint budget) instead of wasting a demanding preset for no features.\n"
+      "The decision of each view is recorded in its metadata and in a\n"
+      "features_presets_<rangeStart>.json file next to the features.")
+    ("preFilterGrid", po::value<bool>(&preFilterGrid)->default_value(preFilterGrid),
+      "Apply the keypoint grid filtering on a detection-only first pass, ranked by response,\n"
+      "so descriptors are only computed for the kept keypoints (SIFT describers only).")
+    ("packOutput", po::value<bool>(&writePackFiles)->default_value(writePackFiles),
+      "Write the regions of all the views of this job into a single pack file per describer type\n"
+      "(features_<rangeStart>.<describerType>.pack) instead of one .feat/.desc file pair per view.\n"
+      "Avoids creating many small files on large datasets.")
+    ("sharedRegionsStore", po::value<std::string>(&sharedRegionsStoreName)->default_value(sharedRegionsStoreName),
+      "Also publish the regions of each finished view into POSIX shared memory under this\n"
+      "store name, so a matcher running on the same node with the same store name attaches\n"
+      "them without reading the files back (see SharedRegionsStore.hpp).")
     ("rangeStart", po::value<int>(&rangeStart)->default_value(rangeStart),
       "Range image index start.")
     ("rangeSize", po::value<int>(&rangeSize)->default_value(rangeSize),
       "Range size.")
     ("jobs", po::value<int>(&maxJobs)->default_value(maxJobs),
-      "Specifies the number of jobs to run simultaneously (0 for automatic mode).");
+      "Specifies the number of threads used by the describer stage (0 for automatic mode).")
+    ("tuningProfile", po::value<std::string>(&tuningProfileFilepath)->default_value(tuningProfileFilepath),
+      "Path to a tuning profile file overriding the per-stage parallelism of this tool\n"
+      "(see system/TuningProfile.hpp). Stages: [decode] queueDepth, [describe] threads,\n"
+      "[process] memoryBudgetMb. The file is re-read between batches when it changes.");
 
   po::options_description logParams("Log parameters");
   logParams.add_options()
@@ -283,6 +249,19 @@ int main(int argc, char **argv)
   // set verbose level
   system::Logger::get()->setLogLevel(verboseLevel);
 
+  // load the per-stage tuning profile
+  system::TuningProfile& tuningProfile = system::TuningProfile::instance();
+  if(!tuningProfileFilepath.empty())
+  {
+    if(!tuningProfile.load(tuningProfileFilepath))
+      return EXIT_FAILURE;
+    const std::size_t memoryBudget = tuningProfile.memoryBudgetBytes("process", 0);
+    if(memoryBudget > 0)
+      system::MemoryGovernor::instance().setMemoryBudget(memoryBudget);
+    if(maxJobs == 0)
+      maxJobs = int(tuningProfile.nbThreads("describe", 0));
+  }
+
   if (outputFolder.empty())
   {
     ALICEVISION_LOG_ERROR("Error: It is an invalid output folder");
@@ -343,6 +322,7 @@ int main(int argc, char **argv)
       method.describer = createImageDescriber(method.type);
       method.describer->Set_configuration_preset(describerPreset);
       method.describer->setUpRight(describersAreUpRight);
+      method.describer->setPreFilterGrid(preFilterGrid);
       imageDescribers.push_back(method);
     }
   }
@@ -355,7 +335,7 @@ int main(int argc, char **argv)
   // - if no file, compute features
   {
     system::Timer timer;
-    boost::progress_display my_progress_bar( sfmData.GetViews().size(), std::cout, "Extract features\n" );
+    system::ProgressReporter progress(sfmData.GetViews().size(), "Extract features");
 
     Views::const_iterator iterViews = sfmData.views.begin();
     Views::const_iterator iterViewsEnd = sfmData.views.end();
@@ -381,82 +361,349 @@ int main(int argc, char **argv)
       std::advance(iterViewsEnd, rangeSize);
     }
     
+    // In pack mode every job writes its own append-able pack file pair per
+    // describer type, so concurrent jobs on a shared filesystem never touch
+    // the same files. Re-running a job resumes its packs.
+    std::vector<std::shared_ptr<feature::RegionsPackWriter>> packWriters(imageDescribers.size());
+    std::vector<std::unique_ptr<feature::RegionsPackSet>> existingPacks(imageDescribers.size());
+
+    if(writePackFiles)
+    {
+      const std::string packBasename = "features_" + std::to_string(std::max(rangeStart, 0));
+      for(std::size_t i = 0; i < imageDescribers.size(); ++i)
+      {
+        const std::string packPath = stlplus::create_filespec(outputFolder,
+              feature::getRegionsPackFilename(packBasename, imageDescribers[i].typeName));
+
+        // views already present in any pack of the output folder are skipped
+        existingPacks[i].reset(new feature::RegionsPackSet());
+        existingPacks[i]->open({outputFolder}, imageDescribers[i].typeName);
+
+        packWriters[i].reset(new feature::RegionsPackWriter(packPath));
+      }
+    }
+
+    // Optional shared memory publication of the finished views, for a
+    // matcher co-scheduled on the same node (see SharedRegionsStore.hpp).
+    std::unique_ptr<feature::SharedRegionsStore> sharedStore;
+    if(!sharedRegionsStoreName.empty())
+    {
+      if(feature::SharedRegionsStore::isSupported())
+        sharedStore.reset(new feature::SharedRegionsStore(sharedRegionsStoreName));
+      else
+        ALICEVISION_LOG_WARNING("Shared memory regions are not supported on this platform, '--sharedRegionsStore' is ignored.");
+    }
+    feature::SharedRegionsStore* sharedStorePtr = sharedStore.get();
+
     struct DescriberComputeMethod
     {
       std::size_t methodIndex;
       std::string featFilename;
       std::string descFilename;
     };
-    
-    for(; iterViews != iterViewsEnd; ++iterViews, ++my_progress_bar)
+
+    struct ViewJob
     {
-      const View* view = iterViews->second.get();
-      const std::string viewFilename = view->getImagePath();
-      ALICEVISION_LOG_INFO("Extract features in view : " << viewFilename);
-      
+      const View* view;
       std::vector<DescriberComputeMethod> computeMethods;
-      
+    };
+
+    struct DecodedViewJob
+    {
+      ViewJob job;
+      Image<float> imageGrayFloat;
+    };
+
+    struct SaveJob
+    {
+      std::size_t methodIndex;
+      IndexT viewId;
+      std::unique_ptr<Regions> regions;
+      std::string featFilename;
+      std::string descFilename;
+    };
+
+    // Pass 1: collect the views whose features or descriptors files are missing
+    std::vector<ViewJob> viewJobs;
+
+    for(; iterViews != iterViewsEnd; ++iterViews)
+    {
+      const View* view = iterViews->second.get();
+      ViewJob job;
+      job.view = view;
+
       for(std::size_t i = 0; i < imageDescribers.size(); ++i)
       {
         DescriberComputeMethod computeMethod;
-        
+
         computeMethod.featFilename = stlplus::create_filespec(outputFolder,
               stlplus::basename_part(std::to_string(view->getViewId())), imageDescribers[i].typeName + ".feat");
         computeMethod.descFilename = stlplus::create_filespec(outputFolder,
               stlplus::basename_part(std::to_string(view->getViewId())), imageDescribers[i].typeName + ".desc");
-      
+
         if (stlplus::file_exists(computeMethod.featFilename) &&
             stlplus::file_exists(computeMethod.descFilename))
         {
           // Skip the feature extraction as the results are already computed.
           continue;
         }
-        
+
+        if (writePackFiles && existingPacks[i]->hasView(view->getViewId()))
+        {
+          // Skip the feature extraction as the view is already packed.
+          continue;
+        }
+
         computeMethod.methodIndex = i;
-        
+
         // If features or descriptors file are missing, compute and export them
-        computeMethods.push_back(computeMethod);
+        job.computeMethods.push_back(computeMethod);
       }
-      
-      if(!computeMethods.empty())
+
+      if(job.computeMethods.empty())
+        progress.advance(); // already computed
+      else
+        viewJobs.push_back(job);
+    }
+
+    system::TaskScheduler& scheduler = system::TaskScheduler::instance();
+    if (maxJobs != 0)
+    {
+      omp_set_num_threads(maxJobs);
+      scheduler.setNbThreads(maxJobs);
+    }
+
+    // Pass 2: run the staged pipeline over the remaining views.
+    // The prefetch/decode and regions writing stages run as tasks on the
+    // process-wide scheduler instead of dedicated threads, so they share one
+    // core budget with the rest of the process.
+    const std::size_t queueSize = tuningProfile.queueDepth("decode", computeDecodeQueueSize(sfmData));
+    JobQueue<DecodedViewJob> decodedQueue(queueSize);
+
+    // Stage 1: image prefetch and decode. At most queueSize decodes are in
+    // flight, so a decode task never blocks inside the pool: the next one is
+    // submitted when the describer stage consumes a decoded image.
+    std::size_t nextDecodeSubmit = 0;
+    std::vector<system::TaskScheduler::TaskId> decodeTaskIds;
+    const auto submitDecodeTask = [&]()
+    {
+      if(nextDecodeSubmit >= viewJobs.size())
+        return;
+      const std::size_t jobIndex = nextDecodeSubmit++;
+      decodeTaskIds.push_back(scheduler.addTask([&, jobIndex]()
+      {
+        DecodedViewJob decoded;
+        decoded.job = viewJobs[jobIndex];
+        const std::string viewFilename = decoded.job.view->getImagePath();
+        ALICEVISION_LOG_INFO("Extract features in view : " << viewFilename);
+        try
+        {
+          readImage(viewFilename, decoded.imageGrayFloat);
+        }
+        catch(const std::exception& e)
+        {
+          ALICEVISION_LOG_ERROR("Unable to decode view '" << viewFilename << "': " << e.what());
+          decodedQueue.close(); // unblocks the describer stage
+          return;
+        }
+        decodedQueue.push(std::move(decoded));
+      }));
+    };
+    for(std::size_t i = 0; i < queueSize; ++i)
+      submitDecodeTask();
+
+    // Stage 3: regions writers. The number of unfinished saves is bounded to
+    // keep the pending regions memory in check.
+    std::vector<system::TaskScheduler::TaskId> saveTaskIds;
+    const auto submitSaveTask = [&](SaveJob&& saveJob)
+    {
+      std::shared_ptr<SaveJob> job(new SaveJob(std::move(saveJob)));
+      if(saveTaskIds.size() >= queueSize)
+        scheduler.wait(saveTaskIds[saveTaskIds.size() - queueSize]);
+      saveTaskIds.push_back(scheduler.addTask([&imageDescribers, &packWriters, writePackFiles, sharedStorePtr, job]()
+      {
+        if(writePackFiles)
+          packWriters[job->methodIndex]->append(job->viewId, *job->regions);
+        else
+          imageDescribers[job->methodIndex].describer->Save(job->regions.get(), job->featFilename, job->descFilename);
+
+        if(sharedStorePtr != nullptr)
+          sharedStorePtr->publish(job->viewId, imageDescribers[job->methodIndex].typeName, *job->regions);
+      }));
+    };
+
+    // Stage 2: describers, running on this thread (OpenMP is used internally).
+    // The decoded images are drained in small batches so that GPU describers
+    // (e.g. PopSIFT) can pipeline several images across their CUDA streams.
+    const EImageDescriberPreset requestedPreset = EImageDescriberPreset_stringToEnum(describerPreset);
+    std::map<IndexT, std::string> presetDecisions;
+    std::size_t nbProcessedJobs = 0;
+    {
+      const std::size_t describerBatchSize = 4;
+      std::vector<DecodedViewJob> batch;
+      std::vector<Image<unsigned char>> batchGrayUChar;
+      std::vector<EImageDescriberPreset> batchPresets;
+      DecodedViewJob decoded;
+      nbProcessedJobs = 0;
+
+      while(nbProcessedJobs < viewJobs.size() && decodedQueue.pop(decoded))
       {
-        auto computeFunction = [&]() {
-            Image<float> imageGrayFloat;
-            Image<unsigned char> imageGrayUChar;
+        // hot reload: re-apply the thread budget of the describer stage when
+        // the tuning profile changed on disk
+        if(tuningProfile.reloadIfChanged())
+        {
+          const std::size_t nbDescribeThreads = tuningProfile.nbThreads("describe", 0);
+          if(nbDescribeThreads > 0)
+          {
+            omp_set_num_threads(int(nbDescribeThreads));
+            scheduler.setNbThreads(nbDescribeThreads);
+          }
+        }
 
-            readImage(viewFilename, imageGrayFloat);
+        batch.clear();
+        batch.emplace_back(std::move(decoded));
+        while(batch.size() < describerBatchSize && decodedQueue.tryPop(decoded))
+          batch.emplace_back(std::move(decoded));
 
-            for(auto& compute : computeMethods)
+        // Consumed slots free up decode capacity: keep the window full.
+        for(std::size_t b = 0; b < batch.size(); ++b)
+          submitDecodeTask();
+
+        batchGrayUChar.clear();
+        batchGrayUChar.resize(batch.size());
+
+        // Adaptive mode: probe the texture content of each decoded image and
+        // select its preset, with the requested preset as the ceiling.
+        // The decision is recorded in the view metadata for reproducibility.
+        if(adaptivePreset)
+        {
+          batchPresets.resize(batch.size());
+          for(std::size_t b = 0; b < batch.size(); ++b)
+          {
+            const SaliencyProbe probe = computeSaliencyProbe(batch[b].imageGrayFloat);
+            batchPresets[b] = selectDescriberPreset(probe, requestedPreset);
+
+            const IndexT viewId = batch[b].job.view->getViewId();
+            const std::string presetName = EImageDescriberPreset_enumToString(batchPresets[b]);
+            ALICEVISION_LOG_INFO("Adaptive preset for view " << viewId << ": " << presetName
+                                 << " (texture coverage: " << probe.textureCoverage << ")");
+
+            View& view = *sfmData.views.at(viewId);
+            view.addMetadata("AliceVision:describerPreset", presetName);
+            view.addMetadata("AliceVision:textureCoverage", std::to_string(probe.textureCoverage));
+            presetDecisions[viewId] = presetName;
+          }
+        }
+
+        for(std::size_t methodIndex = 0; methodIndex < imageDescribers.size(); ++methodIndex)
+        {
+          const auto& method = imageDescribers[methodIndex];
+
+          // gather the images of the batch requiring this describer
+          std::vector<std::size_t> batchIndexes;
+          std::vector<const DescriberComputeMethod*> batchComputes;
+          for(std::size_t b = 0; b < batch.size(); ++b)
+          {
+            for(const auto& compute : batch[b].job.computeMethods)
+            {
+              if(compute.methodIndex != methodIndex)
+                continue;
+              const View* view = batch[b].job.view;
+              ALICEVISION_LOG_INFO("Extracting " + method.typeName  + " features from view " + std::to_string(view->getViewId()) + " : '" + view->getImagePath() +"'");
+              batchIndexes.push_back(b);
+              batchComputes.push_back(&compute);
+            }
+          }
+
+          if(batchIndexes.empty())
+            continue;
+
+          // Group the images of the batch by preset: one group with the
+          // requested preset normally, one group per selected preset in
+          // adaptive mode, so the describer is reconfigured once per group.
+          std::vector<std::pair<EImageDescriberPreset, std::vector<std::size_t>>> describeGroups;
+          for(std::size_t k = 0; k < batchIndexes.size(); ++k)
+          {
+            const EImageDescriberPreset preset = adaptivePreset ? batchPresets[batchIndexes[k]] : requestedPreset;
+            auto groupIt = std::find_if(describeGroups.begin(), describeGroups.end(),
+                [preset](const std::pair<EImageDescriberPreset, std::vector<std::size_t>>& group)
+                { return group.first == preset; });
+            if(groupIt == describeGroups.end())
             {
-              // Compute features and descriptors and export them to files
-              ALICEVISION_LOG_INFO("Extracting " + imageDescribers[compute.methodIndex].typeName  + " features from view " + std::to_string(view->getViewId()) + " : '" + view->getImagePath() +"'");
-              std::unique_ptr<Regions> regions;
+              describeGroups.emplace_back(preset, std::vector<std::size_t>());
+              groupIt = describeGroups.end() - 1;
+            }
+            groupIt->second.push_back(k);
+          }
 
-              if(imageDescribers[compute.methodIndex].describer->useFloatImage())
-              {
-                // image buffer use float image, use the read buffer
-                imageDescribers[compute.methodIndex].describer->Describe(imageGrayFloat, regions);
-              }
-              else
+          for(const auto& group : describeGroups)
+          {
+            if(adaptivePreset)
+              method.describer->Set_configuration_preset(group.first);
+
+            std::vector<std::unique_ptr<Regions>> regionsPerImage;
+
+            if(method.describer->useFloatImage())
+            {
+              // image buffer use float image, use the read buffer
+              std::vector<const Image<float>*> images;
+              for(std::size_t k : group.second)
+                images.push_back(&batch[batchIndexes[k]].imageGrayFloat);
+              method.describer->DescribeBatch(images, regionsPerImage);
+            }
+            else
+            {
+              // image buffer can't use float image
+              std::vector<const Image<unsigned char>*> images;
+              for(std::size_t k : group.second)
               {
-                // image buffer can't use float image
-                if(imageGrayUChar.Width() == 0) // the first time, convert the float buffer to uchar
-                  imageGrayUChar = imageGrayFloat.GetMat().cast<unsigned char>() * 255;
-                imageDescribers[compute.methodIndex].describer->Describe(imageGrayUChar, regions);
+                const std::size_t b = batchIndexes[k];
+                if(batchGrayUChar[b].Width() == 0) // the first time, convert the float buffer to uchar
+                  batchGrayUChar[b] = batch[b].imageGrayFloat.GetMat().cast<unsigned char>() * 255;
+                images.push_back(&batchGrayUChar[b]);
               }
+              method.describer->DescribeBatch(images, regionsPerImage);
+            }
 
-              imageDescribers[compute.methodIndex].describer->Save(regions.get(), compute.featFilename, compute.descFilename);
+            for(std::size_t j = 0; j < group.second.size(); ++j)
+            {
+              const std::size_t k = group.second[j];
+              SaveJob saveJob;
+              saveJob.methodIndex = methodIndex;
+              saveJob.viewId = batch[batchIndexes[k]].job.view->getViewId();
+              saveJob.regions = std::move(regionsPerImage[j]);
+              saveJob.featFilename = batchComputes[k]->featFilename;
+              saveJob.descFilename = batchComputes[k]->descFilename;
+              submitSaveTask(std::move(saveJob));
             }
-        };
-        
-        if (maxJobs == 1)
-          computeFunction();
-        else
-          dispatch(maxJobs, computeFunction);
+          }
+        }
+
+        nbProcessedJobs += batch.size();
+        progress.advance(batch.size());
       }
     }
 
-    if (maxJobs != 1) waitForCompletion();
+    decodedQueue.close();
+    scheduler.wait(decodeTaskIds);
+    scheduler.wait(saveTaskIds); // rethrows the first writer failure, if any
+
+    // The extraction does not write the SfMData back, so the per-view preset
+    // decisions are also saved next to the features for reproducibility.
+    if(adaptivePreset && !presetDecisions.empty())
+    {
+      const std::string decisionsPath = stlplus::create_filespec(outputFolder,
+            "features_presets_" + std::to_string(std::max(rangeStart, 0)), "json");
+      std::ofstream decisionsFile(decisionsPath);
+      cereal::JSONOutputArchive archive(decisionsFile);
+      archive(cereal::make_nvp("describerPresetPerView", presetDecisions));
+    }
+
+    if(nbProcessedJobs < viewJobs.size())
+    {
+      ALICEVISION_LOG_ERROR("Feature extraction stopped after " << nbProcessedJobs << " of " << viewJobs.size() << " views.");
+      return EXIT_FAILURE;
+    }
 
     std::cout << "Task done in (s): " << timer.elapsed() << std::endl;
   }
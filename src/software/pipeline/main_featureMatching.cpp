@@ -11,7 +11,9 @@
 #include <aliceVision/feature/RegionsPerView.hpp>
 #include <aliceVision/feature/ImageDescriber.hpp>
 #include <aliceVision/feature/imageDescriberCommon.hpp>
+#include <aliceVision/feature/SharedRegionsStore.hpp>
 #include <aliceVision/matchingImageCollection/matchingCommon.hpp>
+#include <aliceVision/matchingImageCollection/pairBuilder.hpp>
 #include <aliceVision/matchingImageCollection/ImageCollectionMatcher_generic.hpp>
 #include <aliceVision/matchingImageCollection/ImageCollectionMatcher_cascadeHashing.hpp>
 #include <aliceVision/matchingImageCollection/GeometricFilter.hpp>
@@ -20,7 +22,9 @@
 #include <aliceVision/matchingImageCollection/GeometricFilterMatrix_H_AC.hpp>
 #include <aliceVision/matching/pairwiseAdjacencyDisplay.hpp>
 #include <aliceVision/matching/io.hpp>
+#include <aliceVision/system/TaskScheduler.hpp>
 #include <aliceVision/system/Timer.hpp>
+#include <aliceVision/system/TuningProfile.hpp>
 #include <aliceVision/system/cmdline.hpp>
 #include <aliceVision/feature/selection.hpp>
 #include <aliceVision/graph/graph.hpp>
@@ -32,6 +36,7 @@
 
 #include <cstdlib>
 #include <fstream>
+#include <sstream>
 #include <cctype>
 
 using namespace aliceVision;
@@ -98,16 +103,29 @@ int main(int argc, char **argv)
   std::string predefinedPairList;
   int rangeStart = -1;
   int rangeSize = 0;
+  std::string shard;
+  std::string exportShardManifestsFolder;
   std::string nearestMatchingMethod = "ANN_L2";
   std::string geometricEstimatorName = robustEstimation::ERobustEstimator_enumToString(robustEstimation::ERobustEstimator::ACRANSAC);
   bool savePutativeMatches = false;
   bool guidedMatching = false;
   int maxIteration = 2048;
+  double ransacConfidence = 0.999;
+  double geometricFilteringTimeout = 0.0;
   bool matchFilePerImage = true;
+  bool incrementalMode = false;
+  bool cacheMode = false;
   size_t numMatchesToKeep = 0;
   bool useGridSort = true;
+  bool quantizeDescriptors = false;
+  bool halfDescriptors = false;
+  std::string sharedRegionsStoreName;
+  bool crossMatching = false;
+  bool cascadeMatching = false;
   bool exportDebugFiles = false;
   std::string fileExtension = "bin";
+  std::string tuningProfileFilepath;
+  int maxThreads = 0;
 
   po::options_description allParams(
      "Compute corresponding features between a series of views:\n"
@@ -144,6 +162,8 @@ int main(int argc, char **argv)
       "* CASCADE_HASHING_L2: L2 Cascade Hashing matching\n"
       "* FAST_CASCADE_HASHING_L2: L2 Cascade Hashing with precomputed hashed regions\n"
       "(faster than CASCADE_HASHING_L2 but use more memory)\n"
+      "* HNSW_L2: L2 approximate matching with Hierarchical Navigable Small World graphs\n"
+      "* BRUTE_FORCE_CUDA_L2: L2 BruteForce matching on the GPU (requires a CUDA build)\n"
       "For Binary based descriptor:\n"
       "* BRUTE_FORCE_HAMMING: BruteForce Hamming matching")
     ("geometricEstimator", po::value<std::string>(&geometricEstimatorName)->default_value(geometricEstimatorName),
@@ -160,18 +180,74 @@ int main(int argc, char **argv)
       "Distance ratio to discard non meaningful matches.")
     ("maxIteration", po::value<int>(&maxIteration)->default_value(maxIteration),
       "Maximum number of iterations allowed in ransac step.")
+    ("ransacConfidence", po::value<double>(&ransacConfidence)->default_value(ransacConfidence),
+      "Stop the ransac sampling of a pair as soon as this confidence of having drawn an\n"
+      "all-inlier sample is reached, instead of always spending the maxIteration budget\n"
+      "(0: disable the adaptive termination).")
+    ("geometricFilteringTimeout", po::value<double>(&geometricFilteringTimeout)->default_value(geometricFilteringTimeout),
+      "Global time budget in seconds for the geometric filtering step. The image pairs are\n"
+      "filtered by decreasing putative match support, so the pairs dropped when the budget\n"
+      "is spent are the weakly supported ones (0: no limit).")
     ("useGridSort", po::value<bool>(&useGridSort)->default_value(useGridSort),
       "Use matching grid sort.")
+    ("quantizeDescriptors", po::value<bool>(&quantizeDescriptors)->default_value(quantizeDescriptors),
+      "Quantize float descriptors (SIFT_FLOAT) to 8 bits on load, so they are matched\n"
+      "with the unsigned char kernels (a quarter of the memory bandwidth).")
+    ("halfDescriptors", po::value<bool>(&halfDescriptors)->default_value(halfDescriptors),
+      "Convert float descriptors (SIFT_FLOAT) to half precision on load, so they are\n"
+      "matched with the half precision kernels (half of the memory bandwidth, the\n"
+      "distances are still accumulated in single precision). Only supported by the\n"
+      "BRUTE_FORCE_L2 and cascade hashing matchers; ignored with --quantizeDescriptors.")
+    ("sharedRegionsStore", po::value<std::string>(&sharedRegionsStoreName)->default_value(sharedRegionsStoreName),
+      "Attach the regions published in POSIX shared memory under this store name by a feature\n"
+      "extraction running on the same node (see SharedRegionsStore.hpp). Views not published\n"
+      "there are read from the features folder as usual.")
+    ("crossMatching", po::value<bool>(&crossMatching)->default_value(crossMatching),
+      "Make sure that the matching process is symmetric: each feature of the first image is\n"
+      "matched at most once (one-to-one matches). The cross-check reuses the distances of the\n"
+      "forward search, so it does not add a second matching pass.")
+    ("cascadeMatching", po::value<bool>(&cascadeMatching)->default_value(cascadeMatching),
+      "Match a subset of the strongest features of each pair first and run the full matching\n"
+      "only for the pairs that cannot be decided from the subset. Clearly connected pairs keep\n"
+      "their subset matches and clearly unconnected pairs are discarded, which cuts the\n"
+      "matching compute on large exhaustive pair lists at the price of sparser matches on the\n"
+      "strongest pairs.")
     ("exportDebugFiles", po::value<bool>(&exportDebugFiles)->default_value(exportDebugFiles),
       "Export debug files (svg, dot).")
     ("fileExtension", po::value<std::string>(&fileExtension)->default_value(fileExtension),
-      "File extension to store matches (bin or txt).")
+      "File extension to store matches (bin, txt or cbin).")
+    ("incrementalMode", po::value<bool>(&incrementalMode)->default_value(incrementalMode),
+      "Reuse the matches already present in the output folder:\n"
+      "only the image pairs without a previous result are computed and the\n"
+      "outputs are merged. Useful when adding images to an already matched dataset.")
+    ("cacheMode", po::value<bool>(&cacheMode)->default_value(cacheMode),
+      "Reuse the saved result of every image pair whose inputs are unchanged:\n"
+      "the descriptor files of both views and the matching parameters are\n"
+      "content-hashed and compared against the cache index recorded with the\n"
+      "saved matches, so only the affected pairs are recomputed and the outputs\n"
+      "are merged. Generalizes --incrementalMode to descriptor and parameter changes.")
     ("maxMatches", po::value<std::size_t>(&numMatchesToKeep)->default_value(numMatchesToKeep),
       "Maximum number pf matches to keep.")
     ("rangeStart", po::value<int>(&rangeStart)->default_value(rangeStart),
       "Range image index start.")
     ("rangeSize", po::value<int>(&rangeSize)->default_value(rangeSize),
-      "Range size.");
+      "Range size.")
+    ("shard", po::value<std::string>(&shard)->default_value(shard),
+      "Process only shard i of N (\"i/N\", i in [0, N-1]) of the pair list.\n"
+      "The pairs are partitioned into N shards of balanced matching cost\n"
+      "(weighted by the feature counts of the views), deterministically, so\n"
+      "each machine of a farm recomputes its own shard independently.\n"
+      "Partial outputs are merged with aliceVision_utils_mergeMatches.")
+    ("exportShardManifests", po::value<std::string>(&exportShardManifestsFolder)->default_value(exportShardManifestsFolder),
+      "Write one pair-list file per shard (pairs.shard_<i>_of_<N>.txt,\n"
+      "loadable with --imagePairsList) in the given folder and exit.\n"
+      "Requires --shard for the shard count, e.g. \"0/40\".")
+    ("maxThreads", po::value<int>(&maxThreads)->default_value(maxThreads),
+      "Maximum number of threads (0: automatic).")
+    ("tuningProfile", po::value<std::string>(&tuningProfileFilepath)->default_value(tuningProfileFilepath),
+      "Path to a tuning profile file overriding the per-stage parallelism of this tool\n"
+      "(see system/TuningProfile.hpp): [matching] threads takes over --maxThreads when\n"
+      "the latter is left automatic.");
 
   po::options_description logParams("Log parameters");
   logParams.add_options()
@@ -211,6 +287,19 @@ int main(int argc, char **argv)
   // set verbose level
   system::Logger::get()->setLogLevel(verboseLevel);
 
+  // load the per-stage tuning profile
+  if(!tuningProfileFilepath.empty())
+  {
+    if(!system::TuningProfile::instance().load(tuningProfileFilepath))
+      return EXIT_FAILURE;
+    if(maxThreads == 0)
+      maxThreads = int(system::TuningProfile::instance().nbThreads("matching", 0));
+  }
+
+  // set the core budget of the process-wide task scheduler
+  if(maxThreads > 0)
+    system::TaskScheduler::instance().setNbThreads(maxThreads);
+
   // check and set input options
   if(matchesFolder.empty() || !stlplus::is_folder(matchesFolder))
   {
@@ -290,6 +379,246 @@ int main(int argc, char **argv)
         return EXIT_FAILURE;
   }
 
+  // sharding: keep only a balanced fraction of the pair list, so that the
+  // matching of a dataset can be split across several machines
+  if(!shard.empty())
+  {
+    std::size_t shardIndex = 0;
+    std::size_t nbShards = 0;
+    {
+      const std::size_t sep = shard.find('/');
+      if(sep != std::string::npos)
+      {
+        std::istringstream iss(shard.substr(0, sep) + " " + shard.substr(sep + 1));
+        iss >> shardIndex >> nbShards;
+      }
+      if(sep == std::string::npos || nbShards == 0 || shardIndex >= nbShards)
+      {
+        ALICEVISION_LOG_ERROR("Invalid --shard value: '" + shard + "', expected \"i/N\" with i in [0, N-1].");
+        return EXIT_FAILURE;
+      }
+    }
+
+    // prefer the measured putative counts of a previous run, read from the
+    // sidecar statistics index, over the feature count estimate
+    std::map<Pair, std::size_t> pairWeights;
+    {
+      matching::PairwiseMatchesStats previousStats;
+      if(matching::LoadStats(previousStats, {matchesFolder}))
+      {
+        for(const auto& statsPair : previousStats)
+        {
+          if(pairs.count(statsPair.first))
+            pairWeights[statsPair.first] = statsPair.second.nbPutativeMatches + 1;
+        }
+        // a partial index would mix measured and estimated scales: only use
+        // the measured weights when every pair is covered
+        if(pairWeights.size() < pairs.size())
+          pairWeights.clear();
+        else
+          ALICEVISION_LOG_INFO("Shard balancing uses the measured match counts of a previous run.");
+      }
+    }
+
+    // weight each view by its feature count, approximated by the size of the
+    // features file on disk (every feature has the same footprint); not
+    // needed when every pair has a measured weight
+    std::map<IndexT, std::size_t> viewWeights;
+    if(pairWeights.empty())
+    {
+      for(const auto& pair : pairs)
+      {
+        for(const IndexT viewId : {pair.first, pair.second})
+        {
+          if(viewWeights.count(viewId))
+            continue;
+          std::size_t& weight = viewWeights[viewId];
+          for(const feature::EImageDescriberType descType : feature::EImageDescriberType_stringToEnums(describerTypesName))
+          {
+            const std::string featFilename = stlplus::create_filespec(featuresFolder,
+              std::to_string(viewId) + "." + feature::EImageDescriberType_enumToString(descType), "feat");
+            if(stlplus::is_file(featFilename))
+              weight += stlplus::file_size(featFilename);
+          }
+        }
+      }
+    }
+
+    const std::vector<PairSet> shards = buildBalancedShards(pairs, nbShards, viewWeights, pairWeights);
+
+    // manifest generation mode: write one pair-list file per shard and exit
+    if(!exportShardManifestsFolder.empty())
+    {
+      if(!stlplus::is_folder(exportShardManifestsFolder))
+      {
+        ALICEVISION_LOG_ERROR("Invalid shard manifests folder: " + exportShardManifestsFolder);
+        return EXIT_FAILURE;
+      }
+      for(std::size_t i = 0; i < nbShards; ++i)
+      {
+        const std::string manifestFilename = stlplus::create_filespec(exportShardManifestsFolder,
+          "pairs.shard_" + std::to_string(i) + "_of_" + std::to_string(nbShards), "txt");
+        if(!savePairs(manifestFilename, shards[i]))
+          return EXIT_FAILURE;
+        ALICEVISION_LOG_INFO("Shard manifest " + std::to_string(i) + "/" + std::to_string(nbShards) + ": "
+          + std::to_string(shards[i].size()) + " pairs written to " + manifestFilename);
+      }
+      return EXIT_SUCCESS;
+    }
+
+    pairs = shards[shardIndex];
+    ALICEVISION_LOG_INFO("Shard " + std::to_string(shardIndex) + "/" + std::to_string(nbShards) + ": "
+      + std::to_string(pairs.size()) + " image pairs to match.");
+
+    if(pairs.empty())
+    {
+      ALICEVISION_LOG_INFO("Empty shard, nothing to compute.");
+      return EXIT_SUCCESS;
+    }
+  }
+  else if(!exportShardManifestsFolder.empty())
+  {
+    ALICEVISION_LOG_ERROR("--exportShardManifests requires --shard for the shard count.");
+    return EXIT_FAILURE;
+  }
+
+  // incremental mode: reuse the matches already computed in the output folder
+  // and keep only the pairs without a previous result
+  PairwiseMatches previousMatches;
+  if(incrementalMode)
+  {
+    if(Load(previousMatches, std::set<IndexT>(), {matchesFolder}, std::vector<feature::EImageDescriberType>(), geometricMode))
+    {
+      std::size_t nbReusedPairs = 0;
+      for(PairSet::iterator iterPair = pairs.begin(); iterPair != pairs.end();)
+      {
+        if(previousMatches.count(*iterPair) ||
+           previousMatches.count(Pair(iterPair->second, iterPair->first)))
+        {
+          iterPair = pairs.erase(iterPair);
+          ++nbReusedPairs;
+        }
+        else
+        {
+          ++iterPair;
+        }
+      }
+      ALICEVISION_LOG_INFO("Incremental mode: " + std::to_string(nbReusedPairs) + " image pairs reused from previous matches, " + std::to_string(pairs.size()) + " left to compute.");
+
+      if(pairs.empty())
+      {
+        ALICEVISION_LOG_INFO("All image pairs are already matched, nothing to compute.");
+        return EXIT_SUCCESS;
+      }
+    }
+    else
+    {
+      ALICEVISION_LOG_INFO("Incremental mode: no previous matches found in '" + matchesFolder + "', all image pairs will be computed.");
+    }
+  }
+
+  // cache mode: reuse the saved result of every pair whose inputs (descriptor
+  // files of both views and matching parameters) are unchanged since the run
+  // recorded in the cache index
+  matching::PairwiseMatchesCache cacheRecords; // records of the pairs computed by this run
+  PairwiseMatches cachedMatches;
+  if(cacheMode)
+  {
+    // hash of every parameter influencing the saved matches
+    std::ostringstream parameters;
+    parameters << nearestMatchingMethod << ' ' << distRatio << ' ' << crossMatching << ' '
+               << cascadeMatching << ' '
+               << describerTypesName << ' ' << quantizeDescriptors << ' '
+               << geometricMode << ' ' << geometricEstimatorName << ' '
+               << maxIteration << ' ' << ransacConfidence << ' ' << geometricFilteringTimeout << ' '
+               << guidedMatching << ' ' << useGridSort << ' ' << numMatchesToKeep;
+    const std::string parametersDesc = parameters.str();
+    const std::uint64_t parametersHash = matching::HashContent(parametersDesc.data(), parametersDesc.size());
+
+    // per-view content hash, chained over the descriptor files of every
+    // describer type; 0 when a file is missing, which disables the caching of
+    // the pairs of that view
+    std::map<IndexT, std::uint64_t> viewHashes;
+    for(const auto& pair : pairs)
+    {
+      for(const IndexT viewId : {pair.first, pair.second})
+      {
+        if(viewHashes.count(viewId))
+          continue;
+        std::uint64_t viewHash = matching::HashContent(&viewId, sizeof(viewId));
+        for(const feature::EImageDescriberType descType : feature::EImageDescriberType_stringToEnums(describerTypesName))
+        {
+          const std::string basename = std::to_string(viewId) + "." + feature::EImageDescriberType_enumToString(descType);
+          viewHash = matching::HashFileContent(stlplus::create_filespec(featuresFolder, basename, "feat"), viewHash);
+          if(viewHash != 0)
+            viewHash = matching::HashFileContent(stlplus::create_filespec(featuresFolder, basename, "desc"), viewHash);
+          if(viewHash == 0)
+            break;
+        }
+        viewHashes[viewId] = viewHash;
+      }
+    }
+
+    // keep only the pairs whose recorded input hashes differ from the current ones
+    matching::PairwiseMatchesCache previousCache;
+    if(matching::LoadCache(previousCache, {matchesFolder}))
+    {
+      PairwiseMatches previousResult;
+      Load(previousResult, std::set<IndexT>(), {matchesFolder}, std::vector<feature::EImageDescriberType>(), geometricMode);
+
+      std::size_t nbCachedPairs = 0;
+      for(PairSet::iterator iterPair = pairs.begin(); iterPair != pairs.end();)
+      {
+        matching::PairCacheRecord current;
+        current.contentHashI = viewHashes.at(iterPair->first);
+        current.contentHashJ = viewHashes.at(iterPair->second);
+        current.parametersHash = parametersHash;
+
+        const matching::PairwiseMatchesCache::const_iterator record = previousCache.find(*iterPair);
+        if(current.contentHashI != 0 && current.contentHashJ != 0 &&
+           record != previousCache.end() && record->second == current)
+        {
+          // the saved result of the pair is still valid; a recorded pair
+          // without a saved matches entry is a cached empty result
+          const PairwiseMatches::const_iterator found = previousResult.find(*iterPair);
+          if(found != previousResult.end())
+            cachedMatches.insert(*found);
+          cacheRecords[*iterPair] = current;
+          iterPair = pairs.erase(iterPair);
+          ++nbCachedPairs;
+        }
+        else
+        {
+          ++iterPair;
+        }
+      }
+      ALICEVISION_LOG_INFO("Cache mode: " + std::to_string(nbCachedPairs) + " image pairs reused from the cache, " + std::to_string(pairs.size()) + " left to compute.");
+    }
+    else
+    {
+      ALICEVISION_LOG_INFO("Cache mode: no cache index found in '" + matchesFolder + "', all image pairs will be computed.");
+    }
+
+    // record the pairs this run is about to compute, under the current hashes
+    for(const auto& pair : pairs)
+    {
+      const std::uint64_t hashI = viewHashes.at(pair.first);
+      const std::uint64_t hashJ = viewHashes.at(pair.second);
+      if(hashI == 0 || hashJ == 0)
+        continue;
+      matching::PairCacheRecord& record = cacheRecords[pair];
+      record.contentHashI = hashI;
+      record.contentHashJ = hashJ;
+      record.parametersHash = parametersHash;
+    }
+
+    if(pairs.empty())
+    {
+      ALICEVISION_LOG_INFO("All image pairs are up to date in the cache, nothing to compute.");
+      return EXIT_SUCCESS;
+    }
+  }
+
   if(pairs.empty())
   {
     ALICEVISION_LOG_INFO("No image pair to match.");
@@ -312,15 +641,35 @@ int main(int argc, char **argv)
 
   // allocate the right Matcher according the Matching requested method
   EMatcherType collectionMatcherType = EMatcherType_stringToEnum(nearestMatchingMethod);
-  std::unique_ptr<IImageCollectionMatcher> imageCollectionMatcher = createImageCollectionMatcher(collectionMatcherType, distRatio);
+
+  // the half precision path only exists for the matchers with dedicated kernels
+  if(halfDescriptors && quantizeDescriptors)
+  {
+    ALICEVISION_LOG_WARNING("--halfDescriptors is ignored with --quantizeDescriptors: the descriptors are quantized to 8 bits.");
+    halfDescriptors = false;
+  }
+  if(halfDescriptors &&
+     collectionMatcherType != BRUTE_FORCE_L2 &&
+     collectionMatcherType != CASCADE_HASHING_L2 &&
+     collectionMatcherType != FAST_CASCADE_HASHING_L2)
+  {
+    ALICEVISION_LOG_WARNING("--halfDescriptors is not supported by " + nearestMatchingMethod + ", matching in full precision.");
+    halfDescriptors = false;
+  }
+  std::unique_ptr<IImageCollectionMatcher> imageCollectionMatcher = createImageCollectionMatcher(collectionMatcherType, distRatio, crossMatching, cascadeMatching);
 
   const std::vector<feature::EImageDescriberType> describerTypes = feature::EImageDescriberType_stringToEnums(describerTypesName);
 
   ALICEVISION_LOG_INFO("There are " + std::to_string(sfmData.GetViews().size()) + " views and " + std::to_string(pairs.size()) + " image pairs.");
 
   // load the corresponding view regions
-  RegionsPerView regionPerView;;
-  if(!sfm::loadRegionsPerView(regionPerView, sfmData, featuresFolder, describerTypes, filter))
+  // the descriptors are memory-mapped from the .desc files: loading is
+  // near-instant and the OS page cache shares them across concurrent jobs
+  RegionsPerView regionPerView;
+  std::unique_ptr<feature::SharedRegionsStore> sharedStore;
+  if(!sharedRegionsStoreName.empty() && feature::SharedRegionsStore::isSupported())
+    sharedStore.reset(new feature::SharedRegionsStore(sharedRegionsStoreName));
+  if(!sfm::loadRegionsPerView(regionPerView, sfmData, featuresFolder, describerTypes, filter, true, quantizeDescriptors, sharedStore.get(), halfDescriptors))
   {
     ALICEVISION_LOG_ERROR("Invalid regions in '" + sfmDataFilename + "'");
     return EXIT_FAILURE;
@@ -345,7 +694,7 @@ int main(int argc, char **argv)
   {
     ALICEVISION_LOG_INFO("No putative matches.");
     // If we only compute a selection of matches, we may have no match.
-    return rangeSize ? EXIT_SUCCESS : EXIT_FAILURE;
+    return (rangeSize || !shard.empty()) ? EXIT_SUCCESS : EXIT_FAILURE;
   }
 
   ALICEVISION_LOG_INFO(std::to_string(mapPutativesMatches.size()) << " putative image pair matches");
@@ -405,23 +754,24 @@ int main(int argc, char **argv)
     case HOMOGRAPHY_MATRIX:
     {
       const bool bGeometric_only_guided_matching = true;
-      geometricFilter.Robust_model_estimation(GeometricFilterMatrix_H_AC(std::numeric_limits<double>::infinity(), maxIteration),
+      geometricFilter.Robust_model_estimation(GeometricFilterMatrix_H_AC(std::numeric_limits<double>::infinity(), maxIteration, false, ransacConfidence),
         mapPutativesMatches, guidedMatching,
-        bGeometric_only_guided_matching ? -1.0 : 0.6);
+        bGeometric_only_guided_matching ? -1.0 : 0.6,
+        geometricFilteringTimeout);
       map_GeometricMatches = geometricFilter.Get_geometric_matches();
     }
     break;
     case FUNDAMENTAL_MATRIX:
     {
-      geometricFilter.Robust_model_estimation(GeometricFilterMatrix_F_AC(std::numeric_limits<double>::infinity(), maxIteration, geometricEstimator),
-        mapPutativesMatches, guidedMatching);
+      geometricFilter.Robust_model_estimation(GeometricFilterMatrix_F_AC(std::numeric_limits<double>::infinity(), maxIteration, geometricEstimator, false, ransacConfidence),
+        mapPutativesMatches, guidedMatching, 0.6, geometricFilteringTimeout);
       map_GeometricMatches = geometricFilter.Get_geometric_matches();
     }
     break;
     case ESSENTIAL_MATRIX:
     {
-      geometricFilter.Robust_model_estimation(GeometricFilterMatrix_E_AC(std::numeric_limits<double>::infinity(), maxIteration),
-        mapPutativesMatches, guidedMatching);
+      geometricFilter.Robust_model_estimation(GeometricFilterMatrix_E_AC(std::numeric_limits<double>::infinity(), maxIteration, false, ransacConfidence),
+        mapPutativesMatches, guidedMatching, 0.6, geometricFilteringTimeout);
       map_GeometricMatches = geometricFilter.Get_geometric_matches();
 
       // perform an additional check to remove pairs with poor overlap
@@ -469,8 +819,10 @@ int main(int argc, char **argv)
         assert(descType != feature::EImageDescriberType::UNINITIALIZED);
         const aliceVision::matching::IndMatches& inputMatches = match.second;
 
-        const feature::FeatRegions<feature::SIOPointFeature>* rRegions = dynamic_cast<const feature::FeatRegions<feature::SIOPointFeature>*>(&regionPerView.getRegions(indexImagePair.second, descType));
-        const feature::FeatRegions<feature::SIOPointFeature>* lRegions = dynamic_cast<const feature::FeatRegions<feature::SIOPointFeature>*>(&regionPerView.getRegions(indexImagePair.first, descType));
+        const feature::RegionsHandle rRegionsHandle = regionPerView.getRegions(indexImagePair.second, descType);
+        const feature::RegionsHandle lRegionsHandle = regionPerView.getRegions(indexImagePair.first, descType);
+        const feature::FeatRegions<feature::SIOPointFeature>* rRegions = dynamic_cast<const feature::FeatRegions<feature::SIOPointFeature>*>(rRegionsHandle.get());
+        const feature::FeatRegions<feature::SIOPointFeature>* lRegions = dynamic_cast<const feature::FeatRegions<feature::SIOPointFeature>*>(lRegionsHandle.get());
 
         // get the regions for the current view pair:
         if(rRegions && lRegions)
@@ -508,8 +860,49 @@ int main(int argc, char **argv)
 
   // export geometric filtered matches
 
+  // merge the previous results with the newly computed pairs:
+  // insert keeps the new result when a pair was recomputed
+  if(incrementalMode && !previousMatches.empty())
+  {
+    finalMatches.insert(previousMatches.begin(), previousMatches.end());
+    ALICEVISION_LOG_INFO("Incremental mode: " + std::to_string(finalMatches.size()) + " image pair matches after merging with previous results.");
+  }
+
+  // merge the results reused from the cache with the recomputed pairs
+  if(cacheMode && !cachedMatches.empty())
+  {
+    finalMatches.insert(cachedMatches.begin(), cachedMatches.end());
+    ALICEVISION_LOG_INFO("Cache mode: " + std::to_string(finalMatches.size()) + " image pair matches after merging with the cached results.");
+  }
+
   ALICEVISION_LOG_INFO("Save geometric matches.");
   Save(finalMatches, matchesFolder, geometricMode, fileExtension, matchFilePerImage);
+
+  // export the per-pair estimated models so that the SfM pipeline can reuse
+  // them as relative pose priors, keep only the pairs that survived the
+  // post-estimation filtering steps
+  {
+    PairwiseGeometries pairwiseGeometries;
+    for(const auto& geometry: geometricFilter.Get_geometric_models())
+    {
+      if(finalMatches.count(geometry.first))
+        pairwiseGeometries.insert(geometry);
+    }
+    if(incrementalMode || cacheMode)
+    {
+      // as for the matches, merge with the previous results: insert keeps
+      // the new model when a pair was recomputed
+      PairwiseGeometries previousGeometries;
+      if(loadPairwiseGeometries(previousGeometries, matchesFolder, geometricMode))
+        pairwiseGeometries.insert(previousGeometries.begin(), previousGeometries.end());
+    }
+    savePairwiseGeometries(pairwiseGeometries, matchesFolder, geometricMode);
+  }
+
+  // record the input hashes of the computed pairs, so the next cache mode
+  // runs can skip them while their inputs stay unchanged
+  if(cacheMode)
+    matching::UpdateCache(cacheRecords, matchesFolder);
   ALICEVISION_LOG_INFO("Task done in (s): " + std::to_string(timer.elapsed()));
 
   // d. Export some statistics
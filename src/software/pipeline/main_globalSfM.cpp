@@ -65,7 +65,8 @@ int main(int argc, char **argv)
       feature::EImageDescriberType_informations().c_str())
     ("rotationAveraging", po::value<int>(&rotationAveragingMethod)->default_value(rotationAveragingMethod),
       "* 1: L1 minimization\n"
-      "* 2: L2 minimization")
+      "* 2: L2 minimization\n"
+      "* 3: L1 minimization, multithreaded IRLS with a sparse solver")
     ("translationAveraging", po::value<int>(&translationAveragingMethod)->default_value(translationAveragingMethod),
       "* 1: L1 minimization\n"
       "* 2: L2 minimization of sum of squared Chordal distances")
@@ -111,7 +112,7 @@ int main(int argc, char **argv)
   system::Logger::get()->setLogLevel(verboseLevel);
 
   if (rotationAveragingMethod < ROTATION_AVERAGING_L1 ||
-      rotationAveragingMethod > ROTATION_AVERAGING_L2 )
+      rotationAveragingMethod > ROTATION_AVERAGING_L1_MT )
   {
     ALICEVISION_LOG_ERROR("Rotation averaging method is invalid");
     return EXIT_FAILURE;
@@ -0,0 +1,348 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/feature/ImageDescriber.hpp>
+#include <aliceVision/feature/imageDescriberCommon.hpp>
+#include <aliceVision/feature/FeaturesPerView.hpp>
+#include <aliceVision/feature/RegionsPerView.hpp>
+#include <aliceVision/image/all.hpp>
+#include <aliceVision/matching/io.hpp>
+#include <aliceVision/matchingImageCollection/matchingCommon.hpp>
+#include <aliceVision/matchingImageCollection/pairBuilder.hpp>
+#include <aliceVision/matchingImageCollection/GeometricFilter.hpp>
+#include <aliceVision/matchingImageCollection/GeometricFilterMatrix_F_AC.hpp>
+#include <aliceVision/matchingImageCollection/GeometricFilterMatrix_E_AC.hpp>
+#include <aliceVision/matchingImageCollection/GeometricFilterMatrix_H_AC.hpp>
+#include <aliceVision/sfm/sfm.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/cmdline.hpp>
+
+#include <dependencies/stlplus3/filesystemSimplified/file_system.hpp>
+
+#include <boost/program_options.hpp>
+#include <boost/filesystem.hpp>
+
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Combined in-process pipeline: feature extraction, matching and incremental
+// SfM chained in a single process. The regions and the matches are handed
+// from one stage to the next in memory, so no intermediate file is written
+// unless an export folder is explicitly requested. For small scenes the
+// serialization of the intermediate artifacts dominates the end-to-end
+// latency of the file-based tools; this driver trades their restartability
+// for turnaround.
+
+using namespace aliceVision;
+using namespace aliceVision::sfm;
+using namespace aliceVision::matching;
+using namespace aliceVision::matchingImageCollection;
+
+namespace po = boost::program_options;
+
+int main(int argc, char** argv)
+{
+  // command-line parameters
+
+  std::string verboseLevel = system::EVerboseLevel_enumToString(system::Logger::getDefaultVerboseLevel());
+  std::string sfmDataFilename;
+  std::string outputSfM;
+
+  // user optional parameters
+
+  std::string describerTypesName = feature::EImageDescriberType_enumToString(feature::EImageDescriberType::SIFT);
+  std::string describerPreset = feature::EImageDescriberPreset_enumToString(feature::EImageDescriberPreset::NORMAL);
+  std::string nearestMatchingMethod = "ANN_L2";
+  std::string geometricModel = "f";
+  float distRatio = 0.8f;
+  int maxIteration = 2048;
+  int minInputTrackLength = 2;
+  bool refineIntrinsics = true;
+  std::string extraInfoFolder;
+  std::string exportFeaturesFolder;
+  std::string exportMatchesFolder;
+
+  po::options_description allParams(
+    "In-memory pipeline: feature extraction, matching and incremental SfM in one process.\n"
+    "The intermediate artifacts stay in memory, optional folders allow to dump them for debugging.\n"
+    "AliceVision inMemoryPipeline");
+
+  po::options_description requiredParams("Required parameters");
+  requiredParams.add_options()
+    ("input,i", po::value<std::string>(&sfmDataFilename)->required(),
+      "SfMData file.")
+    ("output,o", po::value<std::string>(&outputSfM)->required(),
+      "Path to the output SfMData file.");
+
+  po::options_description optionalParams("Optional parameters");
+  optionalParams.add_options()
+    ("describerTypes,d", po::value<std::string>(&describerTypesName)->default_value(describerTypesName),
+      feature::EImageDescriberType_informations().c_str())
+    ("describerPreset,p", po::value<std::string>(&describerPreset)->default_value(describerPreset),
+      "Control the ImageDescriber configuration (low, medium, normal, high, ultra).")
+    ("photometricMatchingMethod,P", po::value<std::string>(&nearestMatchingMethod)->default_value(nearestMatchingMethod),
+      "Photometric matching method.")
+    ("geometricModel,g", po::value<std::string>(&geometricModel)->default_value(geometricModel),
+      "Geometric model used by the matches filtering:\n"
+      "- f: fundamental matrix\n"
+      "- e: essential matrix\n"
+      "- h: homography matrix")
+    ("distanceRatio", po::value<float>(&distRatio)->default_value(distRatio),
+      "Distance ratio to discard non meaningful matches.")
+    ("maxIteration", po::value<int>(&maxIteration)->default_value(maxIteration),
+      "Maximum number of iterations allowed in the ransac step.")
+    ("minInputTrackLength", po::value<int>(&minInputTrackLength)->default_value(minInputTrackLength),
+      "Minimum track length in input of SfM.")
+    ("refineIntrinsics", po::value<bool>(&refineIntrinsics)->default_value(refineIntrinsics),
+      "Refine intrinsic parameters.")
+    ("extraInfoFolder", po::value<std::string>(&extraInfoFolder)->default_value(extraInfoFolder),
+      "Folder for intermediate reconstruction files and additional reconstruction information files.")
+    ("exportFeaturesFolder", po::value<std::string>(&exportFeaturesFolder)->default_value(exportFeaturesFolder),
+      "If set, dump the extracted features and descriptors to this folder (debugging).")
+    ("exportMatchesFolder", po::value<std::string>(&exportMatchesFolder)->default_value(exportMatchesFolder),
+      "If set, dump the putative and geometric matches to this folder (debugging).");
+
+  po::options_description logParams("Log parameters");
+  logParams.add_options()
+    ("verboseLevel,v", po::value<std::string>(&verboseLevel)->default_value(verboseLevel),
+      "verbosity level (fatal, error, warning, info, debug, trace).");
+
+  allParams.add(requiredParams).add(optionalParams).add(logParams);
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, allParams), vm);
+
+    if(vm.count("help") || (argc == 1))
+    {
+      ALICEVISION_COUT(allParams);
+      return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+  }
+  catch(boost::program_options::required_option& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+  catch(boost::program_options::error& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+
+  ALICEVISION_COUT("Program called with the following parameters:");
+  ALICEVISION_COUT(vm);
+
+  // set verbose level
+  system::Logger::get()->setLogLevel(verboseLevel);
+
+  if(geometricModel.size() != 1 || std::string("feh").find(geometricModel[0]) == std::string::npos)
+  {
+    ALICEVISION_LOG_ERROR("Unknown geometric model: " + geometricModel);
+    return EXIT_FAILURE;
+  }
+
+  // load input SfMData scene (from cameraInit: views & intrinsics)
+  SfMData sfmData;
+  if(!Load(sfmData, sfmDataFilename, ESfMData(VIEWS|INTRINSICS)))
+  {
+    ALICEVISION_LOG_ERROR("The input SfMData file '" + sfmDataFilename + "' cannot be read.");
+    return EXIT_FAILURE;
+  }
+
+  const std::vector<feature::EImageDescriberType> describerTypes =
+    feature::EImageDescriberType_stringToEnums(describerTypesName);
+
+  system::Timer totalTimer;
+
+  // a. Feature extraction
+  //    The regions go straight into the RegionsPerView container of the
+  //    matcher, the positions into the FeaturesPerView container of the SfM.
+
+  feature::RegionsPerView regionsPerView;
+  feature::FeaturesPerView featuresPerView;
+  {
+    system::Timer timer;
+
+    std::vector<std::shared_ptr<feature::ImageDescriber>> imageDescribers;
+    for(const feature::EImageDescriberType descType: describerTypes)
+    {
+      std::shared_ptr<feature::ImageDescriber> describer = feature::createImageDescriber(descType);
+      describer->Set_configuration_preset(describerPreset);
+      imageDescribers.push_back(describer);
+    }
+
+    for(const auto& viewPair: sfmData.GetViews())
+    {
+      const View& view = *viewPair.second;
+      ALICEVISION_LOG_INFO("Extract features in view: " << view.getImagePath());
+
+      image::Image<float> imageGrayFloat;
+      image::Image<unsigned char> imageGrayUChar; // conversion done on demand
+      try
+      {
+        image::readImage(view.getImagePath(), imageGrayFloat);
+      }
+      catch(const std::exception& e)
+      {
+        ALICEVISION_LOG_ERROR("Unable to decode view '" << view.getImagePath() << "': " << e.what());
+        return EXIT_FAILURE;
+      }
+
+      for(std::size_t i = 0; i < imageDescribers.size(); ++i)
+      {
+        feature::ImageDescriber& describer = *imageDescribers[i];
+        std::unique_ptr<feature::Regions> regions;
+
+        if(describer.useFloatImage())
+        {
+          describer.Describe(imageGrayFloat, regions);
+        }
+        else
+        {
+          if(imageGrayUChar.Width() == 0)
+            imageGrayUChar = imageGrayFloat.GetMat().cast<unsigned char>() * 255;
+          describer.Describe(imageGrayUChar, regions);
+        }
+
+        // optional artifact dump for debugging
+        if(!exportFeaturesFolder.empty())
+        {
+          const std::string basename = std::to_string(view.getViewId()) + "." +
+            feature::EImageDescriberType_enumToString(describerTypes[i]);
+          describer.Save(regions.get(),
+            stlplus::create_filespec(exportFeaturesFolder, basename, "feat"),
+            stlplus::create_filespec(exportFeaturesFolder, basename, "desc"));
+        }
+
+        featuresPerView.addFeatures(view.getViewId(), describerTypes[i], regions->GetRegionsPositions());
+        regionsPerView.addRegions(view.getViewId(), describerTypes[i], regions.release());
+      }
+    }
+    ALICEVISION_LOG_INFO("Task (Feature extraction) done in (s): " + std::to_string(timer.elapsed()));
+  }
+
+  // b. Putative matching
+
+  PairwiseMatches putativeMatches;
+  {
+    system::Timer timer;
+
+    const PairSet pairs = exhaustivePairs(sfmData.GetViews());
+    const EMatcherType collectionMatcherType = EMatcherType_stringToEnum(nearestMatchingMethod);
+    std::unique_ptr<IImageCollectionMatcher> imageCollectionMatcher =
+      createImageCollectionMatcher(collectionMatcherType, distRatio);
+
+    for(const feature::EImageDescriberType descType: describerTypes)
+      imageCollectionMatcher->Match(regionsPerView, pairs, descType, putativeMatches);
+
+    if(putativeMatches.empty())
+    {
+      ALICEVISION_LOG_ERROR("No putative matches.");
+      return EXIT_FAILURE;
+    }
+    ALICEVISION_LOG_INFO(std::to_string(putativeMatches.size()) + " putative image pair matches");
+    ALICEVISION_LOG_INFO("Task (Regions Matching) done in (s): " + std::to_string(timer.elapsed()));
+  }
+
+  // c. Geometric filtering
+
+  PairwiseMatches geometricMatches;
+  PairwiseGeometries pairwiseGeometries;
+  {
+    system::Timer timer;
+
+    GeometricFilter geometricFilter(&sfmData, regionsPerView);
+    switch(geometricModel[0])
+    {
+      case 'f':
+        geometricFilter.Robust_model_estimation(
+          GeometricFilterMatrix_F_AC(std::numeric_limits<double>::infinity(), maxIteration),
+          putativeMatches);
+      break;
+      case 'e':
+        geometricFilter.Robust_model_estimation(
+          GeometricFilterMatrix_E_AC(std::numeric_limits<double>::infinity(), maxIteration),
+          putativeMatches);
+      break;
+      case 'h':
+        geometricFilter.Robust_model_estimation(
+          GeometricFilterMatrix_H_AC(std::numeric_limits<double>::infinity(), maxIteration),
+          putativeMatches);
+      break;
+    }
+    geometricMatches = geometricFilter.Get_geometric_matches();
+    pairwiseGeometries = geometricFilter.Get_geometric_models();
+
+    if(geometricMatches.empty())
+    {
+      ALICEVISION_LOG_ERROR("No geometric matches.");
+      return EXIT_FAILURE;
+    }
+    ALICEVISION_LOG_INFO(std::to_string(geometricMatches.size()) + " geometric image pair matches");
+    ALICEVISION_LOG_INFO("Task (Geometric filtering) done in (s): " + std::to_string(timer.elapsed()));
+  }
+
+  // optional artifact dump for debugging; also updates the statistics index
+  if(!exportMatchesFolder.empty())
+  {
+    Save(putativeMatches, exportMatchesFolder, "putative", "txt", false);
+    Save(geometricMatches, exportMatchesFolder, geometricModel, "txt", false);
+  }
+
+  // the putative matches are no longer needed
+  putativeMatches = PairwiseMatches();
+
+  // d. Incremental reconstruction
+
+  if(extraInfoFolder.empty())
+  {
+    namespace bfs = boost::filesystem;
+    extraInfoFolder = bfs::path(outputSfM).parent_path().string();
+  }
+  if(!stlplus::folder_exists(extraInfoFolder))
+    stlplus::folder_create(extraInfoFolder);
+
+  ReconstructionEngine_sequentialSfM sfmEngine(
+    sfmData,
+    extraInfoFolder,
+    stlplus::create_filespec(extraInfoFolder, "sfm_log.html"));
+
+  sfmEngine.setFeatures(&featuresPerView);
+  sfmEngine.setMatches(&geometricMatches);
+  if(!pairwiseGeometries.empty())
+    sfmEngine.setPairwiseGeometries(&pairwiseGeometries);
+
+  sfmEngine.Set_bFixedIntrinsics(!refineIntrinsics);
+  sfmEngine.setMinInputTrackLength(minInputTrackLength);
+
+  if(!sfmEngine.Process())
+    return EXIT_FAILURE;
+
+  if(!sfmEngine.Colorize())
+    ALICEVISION_LOG_ERROR("Colorize failed !");
+
+  ALICEVISION_LOG_INFO("Total pipeline took (s): " + std::to_string(totalTimer.elapsed()));
+
+  ALICEVISION_LOG_INFO("Export SfMData to disk: " + outputSfM);
+  if(!Save(sfmEngine.Get_SfMData(), outputSfM, ESfMData(ALL)))
+  {
+    ALICEVISION_LOG_ERROR("Export SfMData failed !");
+    return EXIT_FAILURE;
+  }
+
+  Generate_SfM_Report(sfmEngine.Get_SfMData(),
+    stlplus::create_filespec(extraInfoFolder, "sfm_report.html"));
+
+  return EXIT_SUCCESS;
+}
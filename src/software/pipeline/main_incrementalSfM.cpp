@@ -83,13 +83,18 @@ int main(int argc, char **argv)
   std::string extraInfoFolder;
   std::string describerTypesName = feature::EImageDescriberType_enumToString(feature::EImageDescriberType::SIFT);
   std::string outInterFileExtension = ".ply";
+  bool interFileDeltaSave = false;
   std::pair<std::string,std::string> initialPairString("","");
   int minInputTrackLength = 2;
   int maxNbMatches = 0;
   std::size_t minNbObservationsForTriangulation = 2;
   bool refineIntrinsics = true;
+  bool resume = false;
+  std::size_t checkpointInterval = 3;
   bool useLocalBundleAdjustment = false;
   std::size_t localBundelAdjustementGraphDistanceLimit = 1;
+  bool useAdaptiveBundleAdjustment = false;
+  double adaptiveBAMaxGrowth = 0.1;
   std::string localizerEstimatorName = robustEstimation::ERobustEstimator_enumToString(robustEstimation::ERobustEstimator::ACRANSAC);
 
   po::options_description allParams(
@@ -118,6 +123,9 @@ int main(int argc, char **argv)
       feature::EImageDescriberType_informations().c_str())
     ("interFileExtension", po::value<std::string>(&outInterFileExtension)->default_value(outInterFileExtension),
       "Extension of the intermediate file export.")
+    ("interFileDeltaSave", po::value<bool>(&interFileDeltaSave)->default_value(interFileDeltaSave),
+      "Save the intermediate reconstructions as JSON deltas (only the changes since the previous save) "
+      "instead of full scene files. Snapshots can be rebuilt with the sfmDeltaCompaction tool.")
     ("minInputTrackLength", po::value<int>(&minInputTrackLength)->default_value(minInputTrackLength),
       "Minimum track length in input of SfM.")
     ("maxNumberOfMatches", po::value<int>(&maxNbMatches)->default_value(maxNbMatches),
@@ -133,11 +141,21 @@ int main(int argc, char **argv)
       "filename of the second image (without path).")
     ("refineIntrinsics", po::value<bool>(&refineIntrinsics)->default_value(refineIntrinsics),
       "Refine intrinsic parameters.")
+    ("resume", po::value<bool>(&resume)->default_value(resume),
+      "Resume the reconstruction from the last checkpoint found in the extraInfoFolder.\n"
+      "If no checkpoint exists, the reconstruction starts from scratch.")
+    ("checkpointInterval", po::value<std::size_t>(&checkpointInterval)->default_value(checkpointInterval),
+      "Interval, in number of resection groups, between two resumable checkpoints of the reconstruction. 0 means no checkpoint.")
     ("useLocalBA,l", po::value<bool>(&useLocalBundleAdjustment)->default_value(useLocalBundleAdjustment),
       "Enable/Disable the Local bundle adjustment strategy.\n"
       "It reduces the reconstruction time, especially for big datasets (500+ images).")
     ("localBAGraphDistance", po::value<std::size_t>(&localBundelAdjustementGraphDistanceLimit)->default_value(localBundelAdjustementGraphDistanceLimit),
       "Graph-distance limit setting the Active region in the Local Bundle Adjustment strategy.")
+    ("useAdaptiveBA", po::value<bool>(&useAdaptiveBundleAdjustment)->default_value(useAdaptiveBundleAdjustment),
+      "Enable/Disable the adaptive bundle adjustment scheduling.\n"
+      "The bundle adjustment of a resection group is skipped while few observations have been added and the residuals have not drifted since the last adjustment.")
+    ("adaptiveBAMaxGrowth", po::value<double>(&adaptiveBAMaxGrowth)->default_value(adaptiveBAMaxGrowth),
+      "Cost/quality trade-off of the adaptive bundle adjustment scheduling: tolerated fraction of new observations (and of residual RMSE drift) between two adjustments. Lower values adjust more often.")
     ("localizerEstimator", po::value<std::string>(&localizerEstimatorName)->default_value(localizerEstimatorName),
       "Estimator type used to localize cameras (acransac (default), ransac, lsmeds, loransac, maxconsensus)");
 
@@ -206,6 +224,12 @@ int main(int argc, char **argv)
     return EXIT_FAILURE;
   }
 
+  // per-pair geometric models, saved by the matching step along the matches.
+  // optional: when present they are reused as relative pose priors.
+  matching::PairwiseGeometries pairwiseGeometries;
+  if(matching::loadPairwiseGeometries(pairwiseGeometries, matchesFolder, "f"))
+    ALICEVISION_LOG_INFO("Loaded " + std::to_string(pairwiseGeometries.size()) + " cached pairwise geometric models.");
+
   if(extraInfoFolder.empty())
   {
     namespace bfs = boost::filesystem;
@@ -215,6 +239,29 @@ int main(int argc, char **argv)
   if (!stlplus::folder_exists(extraInfoFolder))
     stlplus::folder_create(extraInfoFolder);
 
+  // resume an interrupted reconstruction from the last checkpoint
+  if(resume)
+  {
+    const std::string checkpointFilepath = ReconstructionEngine_sequentialSfM::getCheckpointFilepath(extraInfoFolder);
+
+    if(stlplus::file_exists(checkpointFilepath))
+    {
+      ALICEVISION_LOG_INFO("Resume reconstruction from checkpoint: " + checkpointFilepath);
+
+      SfMData checkpointData;
+      if(!Load(checkpointData, checkpointFilepath, ESfMData::ALL))
+      {
+        ALICEVISION_LOG_ERROR("Error: The checkpoint file '" + checkpointFilepath + "' cannot be read.");
+        return EXIT_FAILURE;
+      }
+      sfmData = checkpointData;
+    }
+    else
+    {
+      ALICEVISION_LOG_WARNING("No checkpoint file found in '" + extraInfoFolder + "', start the reconstruction from scratch.");
+    }
+  }
+
   // sequential reconstruction process
   
   aliceVision::system::Timer timer;
@@ -226,13 +273,19 @@ int main(int argc, char **argv)
   // configure the featuresPerView & the matches_provider
   sfmEngine.setFeatures(&featuresPerView);
   sfmEngine.setMatches(&pairwiseMatches);
+  if(!pairwiseGeometries.empty())
+    sfmEngine.setPairwiseGeometries(&pairwiseGeometries);
 
   // configure reconstruction parameters
   sfmEngine.Set_bFixedIntrinsics(!refineIntrinsics);
   sfmEngine.setMinInputTrackLength(minInputTrackLength);
   sfmEngine.setIntermediateFileExtension(outInterFileExtension);
+  sfmEngine.setIntermediateFileDeltaSave(interFileDeltaSave);
+  sfmEngine.setCheckpointInterval(checkpointInterval);
   sfmEngine.setUseLocalBundleAdjustmentStrategy(useLocalBundleAdjustment);
   sfmEngine.setLocalBundleAdjustmentGraphDistance(localBundelAdjustementGraphDistanceLimit);
+  sfmEngine.setUseAdaptiveBundleAdjustmentStrategy(useAdaptiveBundleAdjustment);
+  sfmEngine.setAdaptiveBundleAdjustmentMaxGrowth(adaptiveBAMaxGrowth);
   sfmEngine.setLocalizerEstimator(robustEstimation::ERobustEstimator_stringToEnum(localizerEstimatorName));
   if(minNbObservationsForTriangulation < 2)
   {
@@ -273,18 +326,27 @@ int main(int argc, char **argv)
   sfmEngine.Get_SfMData().addMatchesFolder(matchesFolder);
 
   ALICEVISION_LOG_INFO("Structure from motion took (s): " + std::to_string(timer.elapsed()));
-  ALICEVISION_LOG_INFO("Generating HTML report...");
-
-  Generate_SfM_Report(sfmEngine.Get_SfMData(), stlplus::create_filespec(extraInfoFolder, "sfm_report.html"));
 
   // export to disk computed scene (data & visualizable results)
+  // saved on background threads, to overlap the exports with the report generation
   ALICEVISION_LOG_INFO("Export SfMData to disk: " + outputSfM);
 
-  Save(sfmEngine.Get_SfMData(), stlplus::create_filespec(extraInfoFolder, "cloud_and_poses", outInterFileExtension), ESfMData(VIEWS | EXTRINSICS | INTRINSICS | STRUCTURE));
-  Save(sfmEngine.Get_SfMData(), outputSfM, ESfMData(ALL));
+  AsyncSaver asyncSaver;
+  asyncSaver.save(sfmEngine.Get_SfMData(), stlplus::create_filespec(extraInfoFolder, "cloud_and_poses", outInterFileExtension), ESfMData(VIEWS | EXTRINSICS | INTRINSICS | STRUCTURE));
+  asyncSaver.save(sfmEngine.Get_SfMData(), outputSfM, ESfMData(ALL));
 
   if(!outputSfMViewsAndPoses.empty())
-    Save(sfmEngine.Get_SfMData(), outputSfMViewsAndPoses, ESfMData(VIEWS | EXTRINSICS | INTRINSICS));
+    asyncSaver.save(sfmEngine.Get_SfMData(), outputSfMViewsAndPoses, ESfMData(VIEWS | EXTRINSICS | INTRINSICS));
+
+  ALICEVISION_LOG_INFO("Generating HTML report...");
+
+  Generate_SfM_Report(sfmEngine.Get_SfMData(), stlplus::create_filespec(extraInfoFolder, "sfm_report.html"));
+
+  if(!asyncSaver.wait())
+  {
+    ALICEVISION_LOG_ERROR("Export SfMData failed !");
+    return EXIT_FAILURE;
+  }
 
   return EXIT_SUCCESS;
 }
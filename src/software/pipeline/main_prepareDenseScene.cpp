@@ -186,6 +186,14 @@ bool prepareDenseScene(
   boost::progress_display my_progress_bar(map_viewIdToContiguous.size(),
                                      std::cout, "\n- Exporting Data -\n");
 
+  // Undistorted images are encoded and written on dedicated I/O threads, so
+  // the compute threads move on to the next image instead of waiting on disk
+  image::AsyncImageWriter imageWriter(2);
+
+  // Undistortion maps are computed once and shared between all the images
+  // with the same intrinsic
+  camera::UndistortionMapCache undistortionMapCache;
+
   // Export views:
   //   - 00001_P.txt (Pose of the reconstructed camera)
   //   - 00001.exr (undistorted & scaled colored image)
@@ -256,7 +264,9 @@ bool prepareDenseScene(
       if (cam->isValid() && cam->have_disto())
       {
         // undistort the image and save it
-        UndistortImage(image, cam, image_ud, FBLACK);
+        const std::shared_ptr<const camera::UndistortionMap> undistortionMap =
+          undistortionMapCache.get(cam, image.Width(), image.Height());
+        UndistortImage(image, *undistortionMap, image_ud, FBLACK);
       }
       else
       {
@@ -297,7 +307,7 @@ bool prepareDenseScene(
         std::cerr << "Rescale not implemented." << std::endl;
         image_ud_scaled = image_ud;
       }
-      writeImage(dstColorImage, image_ud_scaled);
+      imageWriter.write(dstColorImage, std::move(image_ud_scaled));
     }
     
     // Export Seeds
@@ -319,6 +329,9 @@ bool prepareDenseScene(
     ++my_progress_bar;
   }
 
+  // Wait for the pending image writes
+  imageWriter.waitAll();
+
   // Write the mvs ini file
   std::ostringstream os;
   os << "[global]" << os.widen('\n')
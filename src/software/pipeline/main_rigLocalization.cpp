@@ -11,6 +11,7 @@
 #include <aliceVision/rig/Rig.hpp>
 #include <aliceVision/image/io.hpp>
 #include <aliceVision/dataio/FeedProvider.hpp>
+#include <aliceVision/localization/BoundedBuffer.hpp>
 #include <aliceVision/feature/ImageDescriber.hpp>
 #include <aliceVision/sfm/SfMData.hpp>
 #include <aliceVision/sfm/sfmDataIO.hpp>
@@ -29,8 +30,10 @@
 #include <boost/accumulators/statistics/sum.hpp>
 #include <boost/ptr_container/ptr_vector.hpp>
 
+#include <atomic>
 #include <iostream>
 #include <string>
+#include <thread>
 #include <vector>
 #include <chrono>
 #include <memory>
@@ -53,6 +56,14 @@ std::string myToString(std::size_t i, std::size_t zeroPadding)
   return ss.str();
 }
 
+/// A rig frame after decode and feature extraction, ready for resection
+struct ExtractedRigFrame
+{
+  std::vector<feature::MapRegionsPerDesc> regions;
+  std::vector<std::pair<std::size_t, std::size_t>> imageSizes;
+  std::vector<camera::PinholeRadialK3> queryIntrinsics;
+};
+
 /**
  * @brief It checks if the value for the reprojection error or the matching error
  * is compatible with the given robust estimator. The value cannot be 0 for 
@@ -393,10 +404,9 @@ int main(int argc, char** argv)
   }
 
   
-  bool haveImage = true;
   std::size_t frameCounter = 0;
   std::size_t numLocalizedFrames = 0;
-  
+
   // load the subposes
   std::vector<geometry::Pose3> vec_subPoses;
   if(numCameras > 1)
@@ -410,61 +420,99 @@ int main(int argc, char** argv)
 
   // store the result
   std::vector< std::vector<localization::LocalizationResult> > rigResultPerFrame;
-  
-  while(haveImage)
+
+  // The frames go through a 2 stage pipeline: a fetch thread decodes the
+  // cameras of a frame in parallel and extracts their features, the main
+  // thread runs the joint rig resection. The queue keeps one frame in
+  // flight, so frame N+1 is decoded and described while frame N is resected.
+  localization::LockFreeSpscQueue<ExtractedRigFrame> extractedFrames(2);
+  std::atomic<bool> fetchFailed(false);
+
+  std::thread fetchThread([&]()
   {
-    // @fixme It's better to have arrays of pointers...
-    std::vector<image::Image<unsigned char> > vec_imageGrey;
-    std::vector<camera::PinholeRadialK3 > vec_queryIntrinsics;
-    vec_imageGrey.reserve(numCameras);
-    vec_queryIntrinsics.reserve(numCameras);
-           
-    // for each camera get the image and the associated internal parameters
-    for(std::size_t idCamera = 0; idCamera < numCameras; ++idCamera)
+    while(true)
     {
-      image::Image<unsigned char> imageGrey;
-      camera::PinholeRadialK3 queryIntrinsics;
-      bool hasIntrinsics = false;
-      std::string currentImgName;
-      haveImage = feeders[idCamera]->readImage(imageGrey, queryIntrinsics, currentImgName, hasIntrinsics);
-      feeders[idCamera]->goToNextFrame();
-
-      if(!haveImage)
+      ExtractedRigFrame frame;
+      std::vector<image::Image<unsigned char> > vec_imageGrey(numCameras);
+      frame.queryIntrinsics.resize(numCameras);
+      std::vector<char> cameraHasImage(numCameras, 0);
+      std::vector<char> cameraHasIntrinsics(numCameras, 0);
+      std::vector<std::string> imageNames(numCameras);
+
+      // decode all the cameras of the frame in parallel
+#pragma omp parallel for
+      for(std::size_t idCamera = 0; idCamera < numCameras; ++idCamera)
+      {
+        image::Image<unsigned char> imageGrey;
+        bool hasIntrinsics = false;
+        cameraHasImage[idCamera] = feeders[idCamera]->readImage(imageGrey,
+                                                               frame.queryIntrinsics[idCamera],
+                                                               imageNames[idCamera],
+                                                               hasIntrinsics);
+        cameraHasIntrinsics[idCamera] = hasIntrinsics;
+        feeders[idCamera]->goToNextFrame();
+        vec_imageGrey[idCamera] = imageGrey;
+      }
+
+      if(!cameraHasImage[0])
+      {
+        // no more images are available
+        break;
+      }
+
+      for(std::size_t idCamera = 1; idCamera < numCameras; ++idCamera)
       {
-        if(idCamera > 0)
+        if(!cameraHasImage[idCamera])
         {
           // this is quite odd, it means that eg the fist camera has an image but
           // one of the others has not image
           ALICEVISION_CERR("This is weird... Camera " << idCamera << " seems not to have any available images while some other cameras do...");
-          return EXIT_FAILURE;  // a bit harsh but if we are here it's cheesy to say the less
+          fetchFailed = true;
+          break;
         }
-        break;
       }
-      
+      if(fetchFailed)
+        break;
+
       // for now let's suppose that the cameras are calibrated internally too
-      if(!hasIntrinsics)
+      for(std::size_t idCamera = 0; idCamera < numCameras; ++idCamera)
       {
-        ALICEVISION_CERR("For now only internally calibrated cameras are supported!"
-                << "\nCamera " << idCamera << " does not have calibration for image " << currentImgName);
-        return EXIT_FAILURE;  // a bit harsh but if we are here it's cheesy to say the less
+        if(!cameraHasIntrinsics[idCamera])
+        {
+          ALICEVISION_CERR("For now only internally calibrated cameras are supported!"
+                  << "\nCamera " << idCamera << " does not have calibration for image " << imageNames[idCamera]);
+          fetchFailed = true;
+          break;
+        }
       }
-      
-      vec_imageGrey.push_back(imageGrey);
-      vec_queryIntrinsics.push_back(queryIntrinsics);
-    }
-    
-    if(!haveImage)
-    {
-      // no more images are available
-      break;
+      if(fetchFailed)
+        break;
+
+      // extract the features and descriptors of each camera
+      if(!localizer->extractRigRegions(vec_imageGrey, param.get(), frame.regions, frame.imageSizes))
+      {
+        ALICEVISION_CERR("Feature extraction failed for frame with image " << imageNames[0]);
+        fetchFailed = true;
+        break;
+      }
+
+      extractedFrames.push(std::move(frame));
     }
-    
+    extractedFrames.close();
+  });
+
+  ExtractedRigFrame frame;
+  while(extractedFrames.pop(frame))
+  {
+    std::vector<camera::PinholeRadialK3 >& vec_queryIntrinsics = frame.queryIntrinsics;
+
     ALICEVISION_COUT("******************************");
     ALICEVISION_COUT("FRAME " << myToString(frameCounter, 4));
     ALICEVISION_COUT("******************************");
     auto detect_start = std::chrono::steady_clock::now();
     std::vector<localization::LocalizationResult> localizationResults;
-    const bool isLocalized = localizer->localizeRig(vec_imageGrey,
+    const bool isLocalized = localizer->localizeRig(frame.regions,
+                                                    frame.imageSizes,
                                                     param.get(),
                                                     vec_queryIntrinsics,
                                                     vec_subPoses,
@@ -511,7 +559,11 @@ int main(int argc, char** argv)
 
     ++frameCounter;
   }
-  
+
+  fetchThread.join();
+  if(fetchFailed)
+    return EXIT_FAILURE;  // a bit harsh but if we are here it's cheesy to say the less
+
   // print out some time stats
   ALICEVISION_COUT("\n\n******************************");
   ALICEVISION_COUT("Localized " << numLocalizedFrames << " / " << frameCounter << " images");
@@ -36,6 +36,8 @@ int main(int argc, char** argv)
   unsigned int minFrameStep = 12;
   unsigned int maxFrameStep = 36;
   unsigned int maxNbOutFrame = 0;
+  bool useFlowEstimation = false;
+  float flowMinMagnitude = 2.0f;
 
   po::options_description allParams("This program is used to extract keyframes from single camera or a camera rig");
 
@@ -72,8 +74,12 @@ int main(int argc, char** argv)
         "minimum number of frames between two keyframes")
       ("maxFrameStep", po::value<unsigned int>(&maxFrameStep)->default_value(maxFrameStep), 
         "maximum number of frames after which a keyframe can be taken")
-      ("maxNbOutFrame", po::value<unsigned int>(&maxNbOutFrame)->default_value(maxNbOutFrame), 
-        "maximum number of output frames (0 = no limit)");
+      ("maxNbOutFrame", po::value<unsigned int>(&maxNbOutFrame)->default_value(maxNbOutFrame),
+        "maximum number of output frames (0 = no limit)")
+      ("useFlowEstimation", po::value<bool>(&useFlowEstimation)->default_value(useFlowEstimation),
+        "reject frames with too little estimated optical flow")
+      ("flowMinMagnitude", po::value<float>(&flowMinMagnitude)->default_value(flowMinMagnitude),
+        "minimum mean displacement in pixels between two consecutive frames");
 
   allParams.add(inputParams).add(metadataParams).add(algorithmParams);
 
@@ -150,7 +156,9 @@ int main(int argc, char** argv)
                  << "\tsharp subset : "               << sharpSubset     << std::endl
                  << "\tmin frame step : "             << minFrameStep    << std::endl
                  << "\tmax frame step : "             << maxFrameStep    << std::endl
-                 << "\tmax nb out frame : "           << maxNbOutFrame   << std::endl);
+                 << "\tmax nb out frame : "           << maxNbOutFrame   << std::endl
+                 << "\tuse flow estimation : "        << useFlowEstimation << std::endl
+                 << "\tflow min magnitude : "         << flowMinMagnitude  << std::endl);
   }
 
   // initialize KeyframeSelector
@@ -188,7 +196,9 @@ int main(int argc, char** argv)
   selector.setMinFrameStep(minFrameStep);
   selector.setMaxFrameStep(maxFrameStep);
   selector.setMaxOutFrame(maxNbOutFrame);
-  
+  selector.setFlowEstimationMode(useFlowEstimation);
+  selector.setFlowMinMagnitude(flowMinMagnitude);
+
   // process
   selector.process();        
           
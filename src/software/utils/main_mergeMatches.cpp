@@ -0,0 +1,167 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfm/SfMData.hpp>
+#include <aliceVision/sfm/sfmDataIO.hpp>
+#include <aliceVision/matching/io.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/cmdline.hpp>
+
+#include <dependencies/stlplus3/filesystemSimplified/file_system.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace aliceVision;
+using namespace aliceVision::matching;
+using namespace aliceVision::sfm;
+namespace po = boost::program_options;
+
+/// Merge the partial matches of several folders (e.g. the outputs of sharded
+/// featureMatching jobs, @see the --shard option) into a unified matches file
+/// directly usable by the SfM pipelines.
+int main(int argc, char **argv)
+{
+  // command-line parameters
+
+  std::string verboseLevel = system::EVerboseLevel_enumToString(system::Logger::getDefaultVerboseLevel());
+  std::string sfmDataFilename;
+  std::vector<std::string> matchesFolders;
+  std::string outputFolder;
+
+  // user optional parameters
+
+  std::string geometricModel = "f";
+  std::string fileExtension = "bin";
+  bool matchFilePerImage = false;
+
+  po::options_description allParams(
+    "Merge the partial matches of several folders into a unified matches file.\n"
+    "Typically used to gather the outputs of featureMatching jobs sharded\n"
+    "with --shard across several machines.\n"
+    "AliceVision mergeMatches");
+
+  po::options_description requiredParams("Required parameters");
+  requiredParams.add_options()
+    ("input,i", po::value<std::string>(&sfmDataFilename)->required(),
+      "SfMData file.")
+    ("matchesFolders,m", po::value<std::vector<std::string> >(&matchesFolders)->multitoken()->required(),
+      "Folders containing the partial matches to merge.")
+    ("output,o", po::value<std::string>(&outputFolder)->required(),
+      "Path to a folder in which the merged matches will be stored.");
+
+  po::options_description optionalParams("Optional parameters");
+  optionalParams.add_options()
+    ("geometricModel,g", po::value<std::string>(&geometricModel)->default_value(geometricModel),
+      "Type of the matches to merge:\n"
+      "* f: fundamental matrix\n"
+      "* e: essential matrix\n"
+      "* h: homography matrix\n"
+      "* putative: putative matches")
+    ("fileExtension", po::value<std::string>(&fileExtension)->default_value(fileExtension),
+      "File extension to store the merged matches (bin, txt or cbin).")
+    ("matchFilePerImage", po::value<bool>(&matchFilePerImage)->default_value(matchFilePerImage),
+      "Save the merged matches in a separate file per image.");
+
+  po::options_description logParams("Log parameters");
+  logParams.add_options()
+    ("verboseLevel,v", po::value<std::string>(&verboseLevel)->default_value(verboseLevel),
+      "verbosity level (fatal, error, warning, info, debug, trace).");
+
+  allParams.add(requiredParams).add(optionalParams).add(logParams);
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, allParams), vm);
+
+    if(vm.count("help") || (argc == 1))
+    {
+      ALICEVISION_COUT(allParams);
+      return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+  }
+  catch(boost::program_options::required_option& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+  catch(boost::program_options::error& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+
+  ALICEVISION_COUT("Program called with the following parameters:");
+  ALICEVISION_COUT(vm);
+
+  // set verbose level
+  system::Logger::get()->setLogLevel(verboseLevel);
+
+  if(outputFolder.empty() || !stlplus::is_folder(outputFolder))
+  {
+    ALICEVISION_LOG_ERROR("Invalid output folder: " + outputFolder);
+    return EXIT_FAILURE;
+  }
+
+  // load the view ids, needed to discover per-image match files
+  SfMData sfmData;
+  if(!Load(sfmData, sfmDataFilename, ESfMData(VIEWS)))
+  {
+    ALICEVISION_LOG_ERROR("The input SfMData file '" << sfmDataFilename << "' cannot be read.");
+    return EXIT_FAILURE;
+  }
+
+  std::set<IndexT> viewsKeys;
+  for(const auto& view : sfmData.GetViews())
+    viewsKeys.insert(view.first);
+
+  system::Timer timer;
+
+  // merge: the folders are loaded in order and a pair present in several
+  // folders keeps the result of the last one. Disjoint shards never overlap,
+  // so with shard outputs this is a plain union.
+  PairwiseMatches mergedMatches;
+  std::size_t nbLoadedFolders = 0;
+  for(const std::string& matchesFolder : matchesFolders)
+  {
+    PairwiseMatches folderMatches;
+    if(!Load(folderMatches, viewsKeys, {matchesFolder}, std::vector<feature::EImageDescriberType>(), geometricModel))
+    {
+      ALICEVISION_LOG_WARNING("No matches found in folder: " + matchesFolder);
+      continue;
+    }
+    ++nbLoadedFolders;
+    ALICEVISION_LOG_INFO(matchesFolder + ": " + std::to_string(folderMatches.size()) + " image pair matches.");
+    for(const auto& pairMatches : folderMatches)
+      mergedMatches[pairMatches.first] = pairMatches.second;
+  }
+
+  if(nbLoadedFolders == 0)
+  {
+    ALICEVISION_LOG_ERROR("No matches loaded from the given folders.");
+    return EXIT_FAILURE;
+  }
+
+  ALICEVISION_LOG_INFO("Merged " + std::to_string(nbLoadedFolders) + " folders into "
+    + std::to_string(mergedMatches.size()) + " image pair matches.");
+
+  ALICEVISION_LOG_INFO("Save merged matches.");
+  if(!Save(mergedMatches, outputFolder, geometricModel, fileExtension, matchFilePerImage))
+  {
+    ALICEVISION_LOG_ERROR("Unable to save the merged matches in: " + outputFolder);
+    return EXIT_FAILURE;
+  }
+
+  ALICEVISION_LOG_INFO("Task done in (s): " + std::to_string(timer.elapsed()));
+  return EXIT_SUCCESS;
+}
@@ -93,9 +93,11 @@ int main(int argc, char **argv)
     fs::create_directory(outputFolder);
 
   // load GT camera rotations & positions [R|C]:
+  // only the views and poses are compared, skip the intrinsics, structure and
+  // observations so large regression scenes load quickly
   SfMData sfmData_gt;
 
-  if (!Load(sfmData_gt, gtFilename, ESfMData(VIEWS|INTRINSICS|EXTRINSICS)))
+  if (!Load(sfmData_gt, gtFilename, ESfMData(VIEWS|EXTRINSICS)))
   {
     ALICEVISION_LOG_ERROR("The input SfMData file '"<< gtFilename << "' cannot be read");
     return EXIT_FAILURE;
@@ -104,7 +106,7 @@ int main(int argc, char **argv)
 
   // load the camera that we have to evaluate
   SfMData sfmData;
-  if (!Load(sfmData, sfmDataFilename, ESfMData(VIEWS|INTRINSICS|EXTRINSICS)))
+  if (!Load(sfmData, sfmDataFilename, ESfMData(VIEWS|EXTRINSICS)))
   {
     ALICEVISION_LOG_ERROR("The input SfMData file '"<< sfmDataFilename << "' cannot be read");
     return EXIT_FAILURE;
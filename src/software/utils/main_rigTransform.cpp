@@ -108,9 +108,11 @@ int main(int argc, char** argv)
   }
   assert(!extrinsics.empty());
 
-  // import sfm data
+  // import sfm data: only the poses and landmarks are exported, the views and
+  // intrinsics of the scene are never read (the intrinsics come from the
+  // calibration file)
   SfMData sfmData;
-  if(!Load(sfmData, importFile, ESfMData::ALL))
+  if(!Load(sfmData, importFile, ESfMData(EXTRINSICS|STRUCTURE|OBSERVATIONS)))
   {
     ALICEVISION_LOG_ERROR("The input SfMData file '"<< importFile << "' cannot be read");
     return EXIT_FAILURE;
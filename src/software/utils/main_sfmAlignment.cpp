@@ -4,11 +4,14 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include <aliceVision/sfm/sfm.hpp>
+#include <aliceVision/sfm/sfmDataIO_chunked.hpp>
 #include <aliceVision/sfm/utils/alignment.hpp>
 #include <aliceVision/config.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/cmdline.hpp>
 
+#include <dependencies/stlplus3/filesystemSimplified/file_system.hpp>
+
 #include <boost/program_options.hpp>
 
 #include <string>
@@ -131,9 +134,20 @@ int main(int argc, char **argv)
     return EXIT_FAILURE;
   }
 
-  // Load input scene
+  // The observations are untouched by the similarity transformation: when
+  // both scenes use the chunked binary format they are copied verbatim from
+  // input to output instead of being deserialized and reserialized.
+  const bool passThroughObservations =
+    stlplus::extension_part(sfmDataFilename) == "sbin" &&
+    stlplus::extension_part(outSfMDataFilename) == "sbin";
+
+  // Load input scene (the landmark positions are transformed, so the
+  // structure is always needed)
   SfMData sfm_data_in;
-  if (!Load(sfm_data_in, sfmDataFilename, ESfMData(ALL)))
+  const ESfMData loadFlags = passThroughObservations
+    ? ESfMData(VIEWS|EXTRINSICS|INTRINSICS|STRUCTURE|CONTROL_POINTS)
+    : ESfMData(ALL);
+  if (!Load(sfm_data_in, sfmDataFilename, loadFlags))
   {
     ALICEVISION_LOG_ERROR("The input SfMData file '" << sfmDataFilename << "' cannot be read");
     return EXIT_FAILURE;
@@ -145,9 +159,10 @@ int main(int argc, char **argv)
 
   if (!sfmDataReferenceFilename.empty())
   {
-    // Load reference scene
+    // Load reference scene: the similarity is estimated from the common
+    // camera positions only
     SfMData sfm_data_inRef;
-    if (!Load(sfm_data_inRef, sfmDataReferenceFilename, ESfMData(ALL)))
+    if (!Load(sfm_data_inRef, sfmDataReferenceFilename, ESfMData(VIEWS|EXTRINSICS|INTRINSICS)))
     {
       ALICEVISION_LOG_ERROR("The reference SfMData file '" << sfmDataReferenceFilename << "' cannot be read");
       return EXIT_FAILURE;
@@ -185,7 +200,10 @@ int main(int argc, char **argv)
   ALICEVISION_LOG_INFO("Save into '" << outSfMDataFilename << "'");
   
   // Export the SfMData scene in the expected format
-  if (!Save(sfm_data_in, outSfMDataFilename, ESfMData::ALL))
+  const bool saveOk = passThroughObservations
+    ? saveChunkedBinary(sfm_data_in, outSfMDataFilename, ESfMData::ALL, sfmDataFilename, ESfMData(OBSERVATIONS))
+    : Save(sfm_data_in, outSfMDataFilename, ESfMData::ALL);
+  if (!saveOk)
   {
     ALICEVISION_LOG_ERROR("An error occurred while trying to save '" << outSfMDataFilename << "'");
     return EXIT_FAILURE;
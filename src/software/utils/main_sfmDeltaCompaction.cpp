@@ -0,0 +1,105 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfm/sfm.hpp>
+#include <aliceVision/sfm/sfmDataIO_delta.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/cmdline.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <cstdlib>
+#include <limits>
+
+using namespace aliceVision;
+using namespace aliceVision::sfm;
+namespace po = boost::program_options;
+
+int main(int argc, char **argv)
+{
+  // command-line parameters
+
+  std::string verboseLevel = system::EVerboseLevel_enumToString(system::Logger::getDefaultVerboseLevel());
+  std::string baseFilename;
+  std::string outputFilename;
+  std::size_t sequence = std::numeric_limits<std::size_t>::max();
+
+  po::options_description allParams(
+    "Materialize a SfMData snapshot from a delta sequence written during an\n"
+    "incremental reconstruction (see the interFileDeltaSave option of incrementalSfM).\n"
+    "AliceVision sfmDeltaCompaction");
+
+  po::options_description requiredParams("Required parameters");
+  requiredParams.add_options()
+    ("input,i", po::value<std::string>(&baseFilename)->required(),
+      "Base JSON file of the delta sequence.")
+    ("output,o", po::value<std::string>(&outputFilename)->required(),
+      "Path to the output SfMData file.");
+
+  po::options_description optionalParams("Optional parameters");
+  optionalParams.add_options()
+    ("sequence", po::value<std::size_t>(&sequence)->default_value(sequence),
+      "Index of the last delta to apply, 1 being the first one. "
+      "By default every delta found next to the base file is applied.");
+
+  po::options_description logParams("Log parameters");
+  logParams.add_options()
+    ("verboseLevel,v", po::value<std::string>(&verboseLevel)->default_value(verboseLevel),
+      "verbosity level (fatal,  error, warning, info, debug, trace).");
+
+  allParams.add(requiredParams).add(optionalParams).add(logParams);
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, allParams), vm);
+
+    if(vm.count("help") || (argc == 1))
+    {
+      ALICEVISION_COUT(allParams);
+      return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+  }
+  catch(boost::program_options::required_option& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+  catch(boost::program_options::error& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+
+  ALICEVISION_COUT("Program called with the following parameters:");
+  ALICEVISION_COUT(vm);
+
+  // set verbose level
+  system::Logger::get()->setLogLevel(verboseLevel);
+
+  aliceVision::system::Timer timer;
+
+  // rebuild the scene from the base file and its deltas
+  SfMData sfmData;
+  if(!materializeDeltaSequence(sfmData, baseFilename, sequence))
+  {
+    ALICEVISION_LOG_ERROR("The delta sequence based at '" << baseFilename << "' cannot be materialized");
+    return EXIT_FAILURE;
+  }
+
+  ALICEVISION_LOG_INFO("Snapshot materialized: " << timer.elapsedMs() << " msec.");
+
+  if(!Save(sfmData, outputFilename, ESfMData::ALL))
+  {
+    ALICEVISION_LOG_ERROR("The output SfMData file '" << outputFilename << "' cannot be written");
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
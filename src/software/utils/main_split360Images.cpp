@@ -169,7 +169,67 @@ bool splitDualFisheye(const std::string& imagePath, const std::string& outputFol
   return true;
 }
 
-bool splitEquirectangular(const std::string& imagePath, const std::string& outputFolder, std::size_t nbSplits, std::size_t splitResolution)
+/**
+ * @brief Precomputed backward mapping of the equirectangular splits: for each
+ * output pixel of each split, the source coordinates in the panoramic image.
+ *
+ * The mapping only depends on the input dimensions and the split
+ * configuration, not on the pixel content, so it is computed once and reused
+ * for every image of a capture session instead of tracing the rays again per
+ * image.
+ */
+struct EquirectangularSplitLUT
+{
+  int inWidth = 0;
+  int inHeight = 0;
+  std::size_t nbSplits = 0;
+  std::size_t splitResolution = 0;
+  double focal = 0.0;
+  /// per split, per output pixel in row major order, the source (x, y)
+  std::vector<std::vector<Vec2f>> map;
+};
+
+/**
+ * @brief Rebuild the look-up table if the input dimensions or the split
+ * configuration changed since the last call; no-op otherwise.
+ */
+void buildEquirectangularSplitLUT(EquirectangularSplitLUT& lut, int inWidth, int inHeight,
+                                  std::size_t nbSplits, std::size_t splitResolution)
+{
+  if(lut.inWidth == inWidth && lut.inHeight == inHeight &&
+     lut.nbSplits == nbSplits && lut.splitResolution == splitResolution)
+    return;
+
+  const double alpha = (M_PI * 2.0) / static_cast<double>(nbSplits);
+  const double focal = focalFromPinholeHeight(inHeight, degreeToRadian(60.0));
+
+  lut.inWidth = inWidth;
+  lut.inHeight = inHeight;
+  lut.nbSplits = nbSplits;
+  lut.splitResolution = splitResolution;
+  lut.focal = focal;
+  lut.map.assign(nbSplits, std::vector<Vec2f>(splitResolution * splitResolution));
+
+  for(std::size_t s = 0; s < nbSplits; ++s)
+  {
+    const PinholeCameraR camera(focal, splitResolution, splitResolution, RotationAroundY(alpha * s));
+    std::vector<Vec2f>& splitMap = lut.map[s];
+
+    #pragma omp parallel for
+    for(int j = 0; j < static_cast<int>(splitResolution); ++j)
+    {
+      for(int i = 0; i < static_cast<int>(splitResolution); ++i)
+      {
+        const Vec3 ray = camera.getRay(i, j);
+        const Vec2 x = SphericalMapping::get2DPoint(ray, inWidth, inHeight);
+        splitMap[j * splitResolution + i] = x.cast<float>();
+      }
+    }
+  }
+}
+
+bool splitEquirectangular(const std::string& imagePath, const std::string& outputFolder, std::size_t nbSplits, std::size_t splitResolution,
+                          EquirectangularSplitLUT& lut)
 {
   oiio::ImageBuf inBuffer(imagePath);
 
@@ -184,35 +244,24 @@ bool splitEquirectangular(const std::string& imagePath, const std::string& outpu
   const int inWidth = imageSource.Width();
   const int inHeight = imageSource.Height();
 
-  std::vector<PinholeCameraR> cameras;
-
-  const double twoPi = M_PI * 2.0;
-  const double alpha = twoPi / static_cast<double>(nbSplits);
-  const double focal = focalFromPinholeHeight(inHeight, degreeToRadian(60.0));
-
-  double angle = 0.0;
-  for(std::size_t i = 0; i < nbSplits; ++i)
-  {
-    cameras.emplace_back(focal, splitResolution, splitResolution, RotationAroundY(angle));
-    angle += alpha;
-  }
+  buildEquirectangularSplitLUT(lut, inWidth, inHeight, nbSplits, splitResolution);
+  const double focal = lut.focal;
 
   const image::Sampler2d<image::SamplerLinear> sampler;
   image::Image<image::RGBColor> imaOut(splitResolution, splitResolution, image::BLACK);
 
-  size_t index = 0;
-  for(const PinholeCameraR& camera : cameras)
+  for(std::size_t index = 0; index < nbSplits; ++index)
   {
-    imaOut.fill(image::BLACK);
+    const std::vector<Vec2f>& splitMap = lut.map[index];
 
     // Backward mapping:
     // - Find for each pixels of the pinhole image where it comes from the panoramic image
-    for(int j = 0; j < splitResolution; ++j)
+    #pragma omp parallel for
+    for(int j = 0; j < static_cast<int>(splitResolution); ++j)
     {
-      for(int i = 0; i < splitResolution; ++i)
+      for(int i = 0; i < static_cast<int>(splitResolution); ++i)
       {
-        const Vec3 ray = camera.getRay(i, j);
-        const Vec2 x = SphericalMapping::get2DPoint(ray, inWidth, inHeight);
+        const Vec2f& x = splitMap[j * splitResolution + i];
         imaOut(j,i) = sampler(imageSource, x(1), x(0));
       }
     }
@@ -229,8 +278,6 @@ bool splitEquirectangular(const std::string& imagePath, const std::string& outpu
 
     boost::filesystem::path path(imagePath);
     outBuffer.write(outputFolder + std::string("/") + path.stem().string() + std::string("_") + std::to_string(index) + path.extension().string());
-
-    ++index;
   }
   ALICEVISION_LOG_INFO(imagePath + " successfully split");
   return true;
@@ -442,6 +489,9 @@ int main(int argc, char** argv)
     }
   }
 
+  // remap look-up table shared by all the images of the batch
+  EquirectangularSplitLUT equirectangularLUT;
+
   for(const std::string& imagePath : imagePaths)
   {
     bool hasCorrectPath = true;
@@ -451,7 +501,7 @@ int main(int argc, char** argv)
       if(equirectangularDemoMode)
         hasCorrectPath = splitEquirectangularDemo(imagePath, outputFolder, equirectangularNbSplits, equirectangularSplitResolution);
       else
-        hasCorrectPath = splitEquirectangular(imagePath, outputFolder, equirectangularNbSplits, equirectangularSplitResolution);
+        hasCorrectPath = splitEquirectangular(imagePath, outputFolder, equirectangularNbSplits, equirectangularSplitResolution, equirectangularLUT);
     }
     else if(splitMode == "dualfisheye")
     {
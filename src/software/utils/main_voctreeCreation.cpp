@@ -47,6 +47,9 @@ int main(int argc, char** argv)
   uint32_t K = 10;
   uint32_t restart = 5;
   uint32_t LEVELS = 6;
+  uint32_t miniBatchSize = 0;
+  std::size_t maxDescriptorsInMemory = 0;
+  bool mappedFormat = false;
   bool sanityCheck = true;
 
   po::options_description allParams("This program is used to load the sift descriptors from a SfMData file and create a vocabulary tree\n"
@@ -66,6 +69,9 @@ int main(int argc, char** argv)
     (",k", po::value<uint32_t>(&K)->default_value(10), "The branching factor of the tree")
     ("restart,r", po::value<uint32_t>(&restart)->default_value(5), "Number of times that the kmean is launched for each cluster, the best solution is kept")
     (",L", po::value<uint32_t>(&LEVELS)->default_value(6), "Number of levels of the tree")
+    ("miniBatchSize,b", po::value<uint32_t>(&miniBatchSize)->default_value(0), "If not 0, cluster with mini-batch kmeans using batches of the given size instead of full passes over all the descriptors. Much faster on large datasets for a small loss in quantization quality, 16384-65536 are reasonable values")
+    ("maxDescriptorsInMemory", po::value<std::size_t>(&maxDescriptorsInMemory)->default_value(0), "If not 0, train out-of-core: the descriptor files are streamed from disk per level and at most the given number of descriptors is kept in memory for clustering, so the training set can be larger than RAM")
+    ("mapped,m", po::value<bool>(&mappedFormat)->default_value(mappedFormat), "Save the tree in the memory-mappable format: loading it is a single map operation and the tree pages are shared between processes on the same host")
     ("sanitycheck,s", po::value<bool>(&sanityCheck)->default_value(sanityCheck), "Perform a sanity check at the end of the creation of the vocabulary tree. The sanity check is a query to the database with the same documents/images useed to train the vocabulary tree");
 
   po::options_description logParams("Log parameters");
@@ -116,35 +122,63 @@ int main(int argc, char** argv)
   }
 
   std::vector<DescriptorFloat> descriptors;
+  std::map<IndexT, std::string> descriptorsFiles;
 
   std::vector<size_t> descRead;
   ALICEVISION_COUT("Reading descriptors from " << sfmDataFilename);
   auto detect_start = std::chrono::steady_clock::now();
-  size_t numTotDescriptors = aliceVision::voctree::readDescFromFiles<DescriptorFloat, DescriptorUChar>(sfmData, featuresFolder, descriptors, descRead);
-  auto detect_end = std::chrono::steady_clock::now();
-  auto detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
-  if(descriptors.size() == 0)
+  if(maxDescriptorsInMemory != 0)
   {
-    ALICEVISION_CERR("No descriptors loaded!!");
-    return EXIT_FAILURE;
+    // out-of-core: only list the descriptor files, they are streamed later
+    aliceVision::voctree::getListOfDescriptorFiles(sfmData, featuresFolder, descriptorsFiles);
+    if(descriptorsFiles.empty())
+    {
+      ALICEVISION_CERR("No descriptors found!!");
+      return EXIT_FAILURE;
+    }
   }
-
-  ALICEVISION_COUT("Done! " << descRead.size() << " sets of descriptors read for a total of " << numTotDescriptors << " features");
+  else
+  {
+    size_t numTotDescriptors = aliceVision::voctree::readDescFromFiles<DescriptorFloat, DescriptorUChar>(sfmData, featuresFolder, descriptors, descRead);
+    if(descriptors.size() == 0)
+    {
+      ALICEVISION_CERR("No descriptors loaded!!");
+      return EXIT_FAILURE;
+    }
+    ALICEVISION_COUT("Done! " << descRead.size() << " sets of descriptors read for a total of " << numTotDescriptors << " features");
+  }
+  auto detect_end = std::chrono::steady_clock::now();
+  auto detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
   ALICEVISION_COUT("Reading took " << detect_elapsed.count() << " sec");
 
   // Create tree
   aliceVision::voctree::TreeBuilder<DescriptorFloat> builder(DescriptorFloat(0));
   builder.setVerbose(tbVerbosity);
   builder.kmeans().setRestarts(restart);
+  builder.kmeans().setMiniBatchSize(miniBatchSize);
   ALICEVISION_COUT("Building a tree of L=" << LEVELS << " levels with a branching factor of k=" << K);
   detect_start = std::chrono::steady_clock::now();
-  builder.build(descriptors, K, LEVELS);
+  if(maxDescriptorsInMemory != 0)
+  {
+    std::vector<std::string> shardFiles;
+    shardFiles.reserve(descriptorsFiles.size());
+    for(const auto& currentFile : descriptorsFiles)
+      shardFiles.push_back(currentFile.second);
+    builder.buildOutOfCore<DescriptorUChar>(shardFiles, K, LEVELS, maxDescriptorsInMemory);
+  }
+  else
+  {
+    builder.build(descriptors, K, LEVELS);
+  }
   detect_end = std::chrono::steady_clock::now();
   detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
   ALICEVISION_COUT("Tree created in " << ((float) detect_elapsed.count()) / 1000 << " sec");
   ALICEVISION_COUT(builder.tree().centers().size() << " centers");
   ALICEVISION_COUT("Saving vocabulary tree as " << treeName);
-  builder.tree().save(treeName);
+  if(mappedFormat)
+    builder.tree().saveMapped(treeName);
+  else
+    builder.tree().save(treeName);
 
   aliceVision::voctree::SparseHistogramPerImage allSparseHistograms;
   // temporary vector used to save all the visual word for each image before adding them to documents
@@ -152,6 +186,22 @@ int main(int argc, char** argv)
   ALICEVISION_COUT("Quantizing the features");
   size_t offset = 0; ///< this is used to align to the features of a given image in 'feature'
   detect_start = std::chrono::steady_clock::now();
+  if(maxDescriptorsInMemory != 0)
+  {
+    // out-of-core: reload the descriptors of one image at a time
+    size_t i = 0;
+    std::vector<DescriptorFloat> imgDescriptors;
+    for(const auto& currentFile : descriptorsFiles)
+    {
+      feature::loadDescsFromBinFile<DescriptorFloat, DescriptorUChar>(currentFile.second, imgDescriptors, false);
+      builder.tree().quantizeMultiple(imgDescriptors, imgVisualWords);
+      aliceVision::voctree::SparseHistogram histo;
+      aliceVision::voctree::computeSparseHistogram(imgVisualWords, histo);
+      allSparseHistograms[i] = histo;
+      ++i;
+    }
+  }
+  else
   // pass each feature through the vocabulary tree to get the associated visual word
   // for each read images, recover the number of features in it from descRead and loop over the features
   for(size_t i = 0; i < descRead.size(); ++i)
@@ -376,7 +376,8 @@ int main(int argc, char** argv)
   EImageDescriberType describerType = EImageDescriberType_stringToEnum(describerMethod);
   
   if((describerType != EImageDescriberType::SIFT) &&
-      (describerType != EImageDescriberType::SIFT_FLOAT))
+      (describerType != EImageDescriberType::SIFT_FLOAT) &&
+      (describerType != EImageDescriberType::SIFT_UPRIGHT))
   {
     ALICEVISION_LOG_ERROR("Invalid describer method." << std::endl);
     return EXIT_FAILURE;
@@ -461,8 +462,10 @@ int main(int argc, char** argv)
             if(leafRightIt->second.size() != 1)
               continue;
 
-            const Regions& siftRegionsLeft = regionsPerView.getRegions(docMatches.first, describerType);
-            const Regions& siftRegionsRight = regionsPerView.getRegions(comparedPicture.id, describerType);
+            const RegionsHandle siftRegionsLeftHandle = regionsPerView.getRegions(docMatches.first, describerType);
+            const RegionsHandle siftRegionsRightHandle = regionsPerView.getRegions(comparedPicture.id, describerType);
+            const Regions& siftRegionsLeft = *siftRegionsLeftHandle;
+            const Regions& siftRegionsRight = *siftRegionsRightHandle;
 
             double dist = siftRegionsLeft.SquaredDescriptorDistance(currentLeaf.second[0], &siftRegionsRight, leafRightIt->second[0]);
             aliceVision::matching::IndMatch currentMatch = aliceVision::matching::IndMatch( currentLeaf.second[0], leafRightIt->second[0]
@@ -48,13 +48,10 @@ bool computeSimilarity(
     return false;
 
   vec_camPosComputed_T.resize(vec_camPosGT.size());
-  // std::vector<double> vec_residualErrors(vec_camPosGT.size());
-  for(size_t i = 0; i < vec_camPosGT.size(); ++i)
+  #pragma omp parallel for
+  for(int i = 0; i < static_cast<int>(vec_camPosGT.size()); ++i)
   {
-    Vec3 newPos = S * R * (vec_camPosComputed[i]) + t;
-    vec_camPosComputed_T[i] = newPos;
-    // const double dResidual = (newPos - vec_camPosGT[i]).norm();
-    // vec_residualErrors[i] = dResidual;
+    vec_camPosComputed_T[i] = S * R * (vec_camPosComputed[i]) + t;
   }
 
   *Sout = S;
@@ -131,30 +128,34 @@ void EvaluteToGT(
   // -a. distance between camera center
   // -b. angle between rotation matrix
 
+  // The per camera residuals are independent: each iteration writes its own
+  // slot of the pre-sized error vectors, so the cameras are processed on all
+  // the cores.
+
   // -a. distance between camera center
   double trajectoryLength = 0;
-  std::vector<double> vec_baselineErrors;
-  for(std::size_t i = 0; i < numCameras; ++i)
+  std::vector<double> vec_baselineErrors(numCameras);
+  #pragma omp parallel for reduction(+:trajectoryLength)
+  for(int i = 0; i < static_cast<int>(numCameras); ++i)
   {
-    const double dResidual = (vec_camCenterGT[i] - vec_camPosComputed_T[i]).norm();
-    vec_baselineErrors.push_back(dResidual);
-    if(i > 0 && i < numCameras-2)
+    vec_baselineErrors[i] = (vec_camCenterGT[i] - vec_camPosComputed_T[i]).norm();
+    if(i > 0 && i < static_cast<int>(numCameras)-2)
       trajectoryLength += (vec_camCenterGT[i] - vec_camCenterGT[i+1]).norm();
   }
-  
+
   std::cout << std::endl << "\nTrajectory length: " << trajectoryLength ;
 
   // -b. angle between rotation matrix
-  std::vector<double> vec_angularErrors;
+  std::vector<double> vec_angularErrors(numCameras);
   {
-    std::vector<Mat3>::const_iterator iter1 = vec_camRotGT.begin();
-    for (std::vector<Mat3>::const_iterator iter2 = vec_camRotComputed.begin();
-      iter2 != vec_camRotComputed.end(); ++iter2, ++iter1) {
-        const Mat3 R1 = *iter1; //GT
-        const Mat3 R2T = *iter2 * R.transpose(); // Computed
-
-        const double angularErrorDegree = radianToDegree(getRotationMagnitude(R1 * R2T.transpose()));
-        vec_angularErrors.push_back(angularErrorDegree);
+    const Mat3 Rt = R.transpose();
+    #pragma omp parallel for
+    for(int i = 0; i < static_cast<int>(numCameras); ++i)
+    {
+      const Mat3 & R1 = vec_camRotGT[i]; //GT
+      const Mat3 R2T = vec_camRotComputed[i] * Rt; // Computed
+
+      vec_angularErrors[i] = radianToDegree(getRotationMagnitude(R1 * R2T.transpose()));
     }
   }
 
@@ -194,13 +194,75 @@ bool ColorHarmonizationEngineGlobal::Process()
   double minvalue = 0.0;
   double maxvalue = 255.0;
 
-  // For each edge computes the selection masks and histograms (for the RGB channels)
+  if (_selectionMethod != eHistogramHarmonizeFullFrame &&
+      _selectionMethod != eHistogramHarmonizeMatchedPoints &&
+      _selectionMethod != eHistogramHarmonizeVLDSegment)
+  {
+    std::cout << "Selection method unsupported" << std::endl;
+    return false;
+  }
+
+  // For each edge computes the selection masks and histograms (for the RGB channels).
+  // The edges are independent (each iteration writes its own slot of the
+  // histogram arrays), so they are processed on all the cores.
   std::vector<relativeColorHistogramEdge> map_relativeHistograms[3];
   map_relativeHistograms[0].resize(_pairwiseMatches.size());
   map_relativeHistograms[1].resize(_pairwiseMatches.size());
   map_relativeHistograms[2].resize(_pairwiseMatches.size());
 
-  for (size_t i = 0; i < _pairwiseMatches.size(); ++i)
+  if (_selectionMethod == eHistogramHarmonizeFullFrame)
+  {
+    // Full frame selection: the mask covers the whole image, so the histogram
+    // of a view does not depend on the pair it appears in. Compute it once per
+    // view and share it across all its edges; an image appearing in N pairs
+    // was previously read and accumulated N times.
+    const std::vector<size_t> viewIds(set_indeximage.begin(), set_indeximage.end());
+    std::vector<std::vector<Histogram<double> > > histogramsPerView(
+      viewIds.size(), std::vector<Histogram<double> >(3, Histogram<double>(minvalue, maxvalue, bin)));
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int v = 0; v < static_cast<int>(viewIds.size()); ++v)
+    {
+      const size_t viewId = viewIds[v];
+
+      Image< RGBColor > image;
+      readImage(_vec_fileNames[viewId], image);
+
+      Image< unsigned char > mask(_vec_imageSize[viewId].first, _vec_imageSize[viewId].second);
+      mask.fill(image::WHITE);
+
+      // Downscaled sampling: gain/offset estimation does not need every pixel,
+      // aim for about one million samples per image.
+      const size_t step = std::max<size_t>(1, std::sqrt(double(image.Width()) * image.Height() / 1.0e6));
+
+      for (size_t channelIndex = 0; channelIndex < 3; ++channelIndex)
+        colorHarmonization::CommonDataByPair::computeHisto(
+          histogramsPerView[v][channelIndex], mask, channelIndex, image, step);
+    }
+
+    // map_cameraNodeToCameraIndex enumerates set_indeximage in order, so the
+    // camera index of a view is also its position in viewIds.
+    for (size_t i = 0; i < _pairwiseMatches.size(); ++i)
+    {
+      matching::PairwiseMatches::const_iterator iter = _pairwiseMatches.begin();
+      std::advance(iter, i);
+
+      const size_t cameraIndexI = map_cameraNodeToCameraIndex.at(iter->first.first);
+      const size_t cameraIndexJ = map_cameraNodeToCameraIndex.at(iter->first.second);
+
+      for (size_t channelIndex = 0; channelIndex < 3; ++channelIndex)
+      {
+        map_relativeHistograms[channelIndex][i] = relativeColorHistogramEdge(
+          cameraIndexI, cameraIndexJ,
+          histogramsPerView[cameraIndexI][channelIndex].GetHist(),
+          histogramsPerView[cameraIndexJ][channelIndex].GetHist());
+      }
+    }
+  }
+  else
+  {
+  #pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < static_cast<int>(_pairwiseMatches.size()); ++i)
   {
     matching::PairwiseMatches::const_iterator iter = _pairwiseMatches.begin();
     std::advance(iter, i);
@@ -214,6 +276,7 @@ bool ColorHarmonizationEngineGlobal::Process()
     //-- Edges names:
     std::pair< std::string, std::string > p_imaNames;
     p_imaNames = make_pair( _vec_fileNames[ viewI ], _vec_fileNames[ viewJ ] );
+    #pragma omp critical
     std::cout << "Current edge : "
       << stlplus::filename_part(p_imaNames.first) << "\t"
       << stlplus::filename_part(p_imaNames.second) << std::endl;
@@ -224,23 +287,17 @@ bool ColorHarmonizationEngineGlobal::Process()
 
     switch(_selectionMethod)
     {
-      case eHistogramHarmonizeFullFrame:
-      {
-        colorHarmonization::CommonDataByPair_fullFrame  dataSelector(
-          p_imaNames.first,
-          p_imaNames.second);
-        dataSelector.computeMask( maskI, maskJ );
-      }
-      break;
       case eHistogramHarmonizeMatchedPoints:
       {
         int circleSize = 10;
+        const feature::RegionsPerDescHandle regionsI = _regionsPerView.getRegionsPerDesc(viewI);
+        const feature::RegionsPerDescHandle regionsJ = _regionsPerView.getRegionsPerDesc(viewJ);
         colorHarmonization::CommonDataByPair_matchedPoints dataSelector(
           p_imaNames.first,
           p_imaNames.second,
           matchesPerDesc,
-          _regionsPerView.getRegionsPerDesc(viewI),
-          _regionsPerView.getRegionsPerDesc(viewJ),
+          *regionsI,
+          *regionsJ,
           circleSize);
         dataSelector.computeMask( maskI, maskJ );
       }
@@ -254,20 +311,21 @@ bool ColorHarmonizationEngineGlobal::Process()
         {
           const feature::EImageDescriberType descType = matchesIt.first;
           const IndMatches& matches = matchesIt.second;
+          const feature::RegionsHandle regionsI = _regionsPerView.getRegions(viewI, descType);
+          const feature::RegionsHandle regionsJ = _regionsPerView.getRegions(viewJ, descType);
           colorHarmonization::CommonDataByPair_vldSegment dataSelector(
             p_imaNames.first,
             p_imaNames.second,
             matches,
-            feature::getSIOPointFeatures(_regionsPerView.getRegions(viewI, descType)),
-            feature::getSIOPointFeatures(_regionsPerView.getRegions(viewJ, descType)));
+            feature::getSIOPointFeatures(*regionsI),
+            feature::getSIOPointFeatures(*regionsJ));
 
           dataSelector.computeMask( maskI, maskJ );
         }
       }
       break;
       default:
-        std::cout << "Selection method unsupported" << std::endl;
-        return false;
+        break; // full frame is handled above, other methods are rejected before the loop
     }
 
     //-- Export the masks
@@ -294,32 +352,40 @@ bool ColorHarmonizationEngineGlobal::Process()
     readImage(p_imaNames.first, imageI);
     readImage(p_imaNames.second, imageJ);
 
+    // The sparse selections (matched points, VLD segments) are kept complete:
+    // only the full frame selection above uses downscaled sampling.
+    const size_t stepI = 1, stepJ = 1;
+
+    const size_t cameraIndexI = map_cameraNodeToCameraIndex.at(viewI);
+    const size_t cameraIndexJ = map_cameraNodeToCameraIndex.at(viewJ);
+
     Histogram< double > histoI( minvalue, maxvalue, bin);
     Histogram< double > histoJ( minvalue, maxvalue, bin);
 
     int channelIndex = 0; // RED channel
-    colorHarmonization::CommonDataByPair::computeHisto( histoI, maskI, channelIndex, imageI );
-    colorHarmonization::CommonDataByPair::computeHisto( histoJ, maskJ, channelIndex, imageJ );
+    colorHarmonization::CommonDataByPair::computeHisto( histoI, maskI, channelIndex, imageI, stepI );
+    colorHarmonization::CommonDataByPair::computeHisto( histoJ, maskJ, channelIndex, imageJ, stepJ );
     relativeColorHistogramEdge & edgeR = map_relativeHistograms[channelIndex][i];
-    edgeR = relativeColorHistogramEdge(map_cameraNodeToCameraIndex[viewI], map_cameraNodeToCameraIndex[viewJ],
+    edgeR = relativeColorHistogramEdge(cameraIndexI, cameraIndexJ,
       histoI.GetHist(), histoJ.GetHist());
 
     histoI = histoJ = Histogram< double >( minvalue, maxvalue, bin);
     channelIndex = 1; // GREEN channel
-    colorHarmonization::CommonDataByPair::computeHisto( histoI, maskI, channelIndex, imageI );
-    colorHarmonization::CommonDataByPair::computeHisto( histoJ, maskJ, channelIndex, imageJ );
+    colorHarmonization::CommonDataByPair::computeHisto( histoI, maskI, channelIndex, imageI, stepI );
+    colorHarmonization::CommonDataByPair::computeHisto( histoJ, maskJ, channelIndex, imageJ, stepJ );
     relativeColorHistogramEdge & edgeG = map_relativeHistograms[channelIndex][i];
-    edgeG = relativeColorHistogramEdge(map_cameraNodeToCameraIndex[viewI], map_cameraNodeToCameraIndex[viewJ],
+    edgeG = relativeColorHistogramEdge(cameraIndexI, cameraIndexJ,
       histoI.GetHist(), histoJ.GetHist());
 
     histoI = histoJ = Histogram< double >( minvalue, maxvalue, bin);
     channelIndex = 2; // BLUE channel
-    colorHarmonization::CommonDataByPair::computeHisto( histoI, maskI, channelIndex, imageI );
-    colorHarmonization::CommonDataByPair::computeHisto( histoJ, maskJ, channelIndex, imageJ );
+    colorHarmonization::CommonDataByPair::computeHisto( histoI, maskI, channelIndex, imageI, stepI );
+    colorHarmonization::CommonDataByPair::computeHisto( histoJ, maskJ, channelIndex, imageJ, stepJ );
     relativeColorHistogramEdge & edgeB = map_relativeHistograms[channelIndex][i];
-    edgeB = relativeColorHistogramEdge(map_cameraNodeToCameraIndex[viewI], map_cameraNodeToCameraIndex[viewJ],
+    edgeB = relativeColorHistogramEdge(cameraIndexI, cameraIndexJ,
       histoI.GetHist(), histoJ.GetHist());
   }
+  }
 
   std::cout << "\n -- \n SOLVE for color consistency with linear programming\n --" << std::endl;
   //-- Solve for the gains and offsets: